@@ -0,0 +1,65 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Depth map estimation compute backend.
+ */
+enum class EDepthMapComputeBackend
+{
+  AUTO = 0,   //< CUDA if a compatible GPU is available, CPU otherwise.
+  CUDA,       //< CUDA only, fails without compatible GPU.
+  CPU         //< CPU only.
+};
+
+inline std::string EDepthMapComputeBackend_enumToString(EDepthMapComputeBackend backend)
+{
+  switch(backend)
+  {
+    case EDepthMapComputeBackend::AUTO:
+      return "auto";
+    case EDepthMapComputeBackend::CUDA:
+      return "cuda";
+    case EDepthMapComputeBackend::CPU:
+      return "cpu";
+  }
+  throw std::out_of_range("Invalid depth map compute backend enum");
+}
+
+inline EDepthMapComputeBackend EDepthMapComputeBackend_stringToEnum(const std::string& backend)
+{
+  if(backend == "auto")
+    return EDepthMapComputeBackend::AUTO;
+  if(backend == "cuda")
+    return EDepthMapComputeBackend::CUDA;
+  if(backend == "cpu")
+    return EDepthMapComputeBackend::CPU;
+  throw std::out_of_range("Invalid depth map compute backend string " + backend);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EDepthMapComputeBackend e)
+{
+    return os << EDepthMapComputeBackend_enumToString(e);
+}
+
+inline std::istream& operator>>(std::istream& in, EDepthMapComputeBackend& backend)
+{
+    std::string token;
+    in >> token;
+    backend = EDepthMapComputeBackend_stringToEnum(token);
+    return in;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,260 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthMapEstimatorCpu.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/depthMap/depthMapUtils.hpp>
+#include <aliceVision/depthMap/SgmDepthList.hpp>
+#include <aliceVision/depthMap/cpu/HostLabImage.hpp>
+#include <aliceVision/depthMap/cpu/SgmCpu.hpp>
+#include <aliceVision/depthMap/cpu/RefineCpu.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+DepthMapEstimatorCpu::DepthMapEstimatorCpu(const mvsUtils::MultiViewParams& mp,
+                                           const mvsUtils::TileParams& tileParams,
+                                           const DepthMapParams& depthMapParams,
+                                           const SgmParams& sgmParams,
+                                           const RefineParams& refineParams)
+  : _mp(mp)
+  , _tileParams(tileParams)
+  , _depthMapParams(depthMapParams)
+  , _sgmParams(sgmParams)
+  , _refineParams(refineParams)
+{
+    // compute maximum downscale (scaleStep)
+    const int maxDownscale = std::max(_sgmParams.scale * _sgmParams.stepXY, _refineParams.scale * _refineParams.stepXY);
+
+    // compute tile ROI list
+    getTileRoiList(_tileParams, _mp.getMaxImageWidth(), _mp.getMaxImageHeight(), maxDownscale, _tileRoiList);
+
+    // log tiling information and ROI list
+    logTileRoiList(_tileParams, _mp.getMaxImageWidth(), _mp.getMaxImageHeight(), maxDownscale, _tileRoiList);
+
+    // log SGM downscale & stepXY
+    ALICEVISION_LOG_INFO("SGM parameters:" << std::endl
+                         << "\t- scale: " << _sgmParams.scale << std::endl
+                         << "\t- stepXY: " <<_sgmParams.stepXY);
+
+    // log Refine downscale & stepXY
+    ALICEVISION_LOG_INFO("Refine parameters:" << std::endl
+                         << "\t- scale: " << _refineParams.scale << std::endl
+                         << "\t- stepXY: " <<_refineParams.stepXY);
+
+    // log CPU limitations
+    if(_sgmParams.useCustomPatchPattern || _refineParams.useCustomPatchPattern)
+        ALICEVISION_LOG_WARNING("Custom patch pattern is not supported on CPU, the square patch is used.");
+
+    if(_sgmParams.useConsistentScale || _refineParams.useConsistentScale)
+        ALICEVISION_LOG_WARNING("Consistent scale is not supported on CPU, the option is ignored.");
+
+    if(_sgmParams.exportIntermediateNormalMaps || _refineParams.exportIntermediateNormalMaps)
+        ALICEVISION_LOG_WARNING("Intermediate normal maps export is not supported on CPU, the option is ignored.");
+
+    if(_sgmParams.exportIntermediateVolumes || _sgmParams.exportIntermediateCrossVolumes || _sgmParams.exportIntermediateTopographicCutVolumes || _sgmParams.exportIntermediateVolume9pCsv ||
+       _refineParams.exportIntermediateCrossVolumes || _refineParams.exportIntermediateTopographicCutVolumes || _refineParams.exportIntermediateVolume9pCsv)
+        ALICEVISION_LOG_WARNING("Intermediate volumes export is not supported on CPU, the option is ignored.");
+
+    ALICEVISION_LOG_INFO("Depth map estimation on CPU:" << std::endl
+                         << "\t- # threads: " << omp_get_max_threads() << std::endl
+                         << "\t- # tiles per image: " << _tileRoiList.size());
+}
+
+void DepthMapEstimatorCpu::getTilesList(const std::vector<int>& cams, std::vector<Tile>& tiles) const
+{
+    const int nbTilesPerCamera = _tileRoiList.size();
+
+    // tiles list should be empty
+    assert(tiles.empty());
+
+    // reserve memory
+    tiles.reserve(cams.size() * nbTilesPerCamera);
+
+    for(int rc : cams)
+    {
+        // get R camera Tcs list
+        const std::vector<int> tCams = _mp.findNearestCamsFromLandmarks(rc, _depthMapParams.maxTCams).getDataWritable();
+
+        // get R camera ROI
+        const ROI rcImageRoi(Range(0, _mp.getWidth(rc)), Range(0, _mp.getHeight(rc)));
+
+        for(std::size_t i = 0;  i < nbTilesPerCamera; ++i)
+        {
+            Tile t;
+
+            t.id = i;
+            t.nbTiles = nbTilesPerCamera;
+            t.rc = rc;
+            t.roi = intersect(_tileRoiList.at(i), rcImageRoi);
+
+            if(t.roi.isEmpty())
+            {
+              // do nothing, this ROI cannot intersect the R camera ROI.
+            }
+            else if(_depthMapParams.chooseTCamsPerTile)
+            {
+              // find nearest T cameras per tile
+              t.sgmTCams = _mp.findTileNearestCams(rc, _sgmParams.maxTCamsPerTile, tCams, t.roi);
+
+              if(_depthMapParams.useRefine)
+                t.refineTCams = _mp.findTileNearestCams(rc, _refineParams.maxTCamsPerTile, tCams, t.roi);
+            }
+            else
+            {
+              // use previously selected T cameras from the entire image
+              t.sgmTCams = tCams;
+              t.refineTCams = tCams;
+            }
+
+            tiles.push_back(t);
+        }
+    }
+}
+
+void DepthMapEstimatorCpu::compute(const std::vector<int>& cams)
+{
+    // initialize RAM image cache
+    mvsUtils::ImagesCache<image::Image<image::RGBAfColor>> ic(_mp, image::EImageColorSpace::LINEAR);
+
+    // initialize CIELAB image cache
+    // R camera and T cameras at SGM and Refine scales
+    const int nbLabImages = 2 * (1 + _depthMapParams.maxTCams);
+    HostLabImageCache labImageCache(nbLabImages, ic, _mp);
+
+    // build tile list order by R camera
+    std::vector<Tile> tiles;
+    getTilesList(cams, tiles);
+
+    // final depth/similarity map scale and step
+    const int finalScale = _depthMapParams.useRefine ? _refineParams.scale : _sgmParams.scale;
+    const int finalStep  = _depthMapParams.useRefine ? _refineParams.stepXY : _sgmParams.stepXY;
+    const int finalScaleStep = finalScale * finalStep;
+
+    // initialize Sgm and Refine objects
+    // note: computation buffers are reused from one tile to the next
+    const bool sgmComputeDepthSimMap = !_depthMapParams.useRefine;
+    SgmCpu sgm(_mp, _tileParams, _sgmParams, sgmComputeDepthSimMap);
+    RefineCpu refine(_mp, _tileParams, _refineParams);
+
+    const int nbTilesPerCamera = _tileRoiList.size();
+
+    for(std::size_t firstTileIndex = 0; firstTileIndex < tiles.size(); firstTileIndex += nbTilesPerCamera)
+    {
+        const int rc = tiles.at(firstTileIndex).rc;
+
+        // full-size depth/similarity maps, should be initialized, additive process
+        const int width  = divideRoundUp(_mp.getWidth(rc),  finalScaleStep);
+        const int height = divideRoundUp(_mp.getHeight(rc), finalScaleStep);
+
+        image::Image<float> depthMap(width, height, true, 0.0f);
+        image::Image<float> simMap(width, height, true, 0.0f);
+
+        std::vector<std::pair<float, float>> depthMinMaxTiles(nbTilesPerCamera, {0.f, 0.f});
+
+        for(int i = 0; i < nbTilesPerCamera; ++i)
+        {
+            const Tile& tile = tiles.at(firstTileIndex + i);
+
+            // do not compute empty ROI
+            // some images in the dataset may be smaller than others
+            if(tile.roi.isEmpty())
+                continue;
+
+            const ROI downscaledRoi = downscaleROI(tile.roi, finalScaleStep);
+
+            image::Image<float> tileDepthMap;
+            image::Image<float> tileSimMap;
+
+            // build tile SGM depth list
+            SgmDepthList sgmDepthList(_mp, _sgmParams, tile);
+
+            // check T cameras and compute the R camera depth list
+            const bool hasTCams = !(tile.sgmTCams.empty() || (_depthMapParams.useRefine && tile.refineTCams.empty()));
+
+            if(hasTCams)
+                sgmDepthList.computeListRc();
+
+            if(!hasTCams || sgmDepthList.getDepths().empty()) // no T camera or no depth found
+            {
+                tileDepthMap.resize(int(downscaledRoi.width()), int(downscaledRoi.height()), true, -1.f);
+                tileSimMap.resize(int(downscaledRoi.width()), int(downscaledRoi.height()), true, 1.f);
+            }
+            else
+            {
+                // remove T cameras with no depth found.
+                Tile validTile = tile;
+                sgmDepthList.removeTcWithNoDepth(validTile);
+
+                // store min/max depth
+                depthMinMaxTiles.at(i) = sgmDepthList.getMinMaxDepths();
+
+                // log debug camera / depth information
+                sgmDepthList.logRcTcDepthInformation();
+
+                // check if starting and stopping depth are valid
+                sgmDepthList.checkStartingAndStoppingDepth();
+
+                // compute Semi-Global Matching
+                sgm.sgmRc(validTile, sgmDepthList, labImageCache);
+
+                if(_depthMapParams.useRefine)
+                {
+                    // smooth SGM thickness map
+                    // in order to be a proper Refine input parameter
+                    sgm.smoothThicknessMap(validTile, _refineParams);
+
+                    // compute Refine
+                    refine.refineRc(validTile, sgm.getDepthMap(), sgm.getThicknessMap(), labImageCache);
+
+                    tileDepthMap = refine.getDepthMap();
+                    tileSimMap = refine.getSimMap();
+                }
+                else
+                {
+                    tileDepthMap = sgm.getDepthMap();
+                    tileSimMap = sgm.getSimMap();
+                }
+            }
+
+            // add tile maps to the full-size maps with weighting
+            mvsUtils::addTileMapWeighted(rc, _mp, _tileParams, tile.roi, finalScaleStep, tileDepthMap, depthMap);
+            mvsUtils::addTileMapWeighted(rc, _mp, _tileParams, tile.roi, finalScaleStep, tileSimMap, simMap);
+        }
+
+        // write depth/sim map result
+        mvsUtils::writeMap(rc, _mp, mvsUtils::EFileType::depthMap, depthMap, finalScale, finalStep);
+        mvsUtils::writeMap(rc, _mp, mvsUtils::EFileType::simMap, simMap, finalScale, finalStep);
+
+        if(_depthMapParams.exportTilePattern)
+            exportDepthSimMapTilePatternObj(rc, _mp, _tileRoiList, depthMinMaxTiles);
+    }
+
+    // merge intermediate results tiles if needed and desired
+    if(tiles.size() > cams.size())
+    {
+        for(int rc : cams)
+        {
+            if(_sgmParams.exportIntermediateDepthSimMaps)
+            {
+                mergeDepthSimMapTiles(rc, _mp, _sgmParams.scale, _sgmParams.stepXY, "sgm");
+            }
+
+            if(_depthMapParams.useRefine && _refineParams.exportIntermediateDepthSimMaps)
+            {
+                mergeDepthPixSizeMapTiles(rc, _mp, _refineParams.scale, _refineParams.stepXY, "sgmUpscaled");
+                mergeDepthSimMapTiles(rc, _mp, _refineParams.scale, _refineParams.stepXY, "refinedFused");
+            }
+        }
+    }
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,82 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/depthMap/DepthMapParams.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/Tile.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class Depth Map Estimator on CPU
+ * @brief Wrap depth maps estimation computation without GPU.
+ * @note CPU counterpart of DepthMapEstimator, same tiling, same outputs.
+ *       Tiles are computed one after the other, each step is parallelized over the tile pixels.
+ */
+class DepthMapEstimatorCpu
+{
+public:
+
+    /**
+     * @brief Depth Map Estimator on CPU constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] tileParams tile workflow parameters
+     * @param[in] depthMapParams the depth map estimation parameters
+     * @param[in] sgmParams the Semi Global Matching parameters
+     * @param[in] refineParams the Refine parameters
+     */
+    DepthMapEstimatorCpu(const mvsUtils::MultiViewParams& mp,
+                         const mvsUtils::TileParams& tileParams,
+                         const DepthMapParams& depthMapParams,
+                         const SgmParams& sgmParams,
+                         const RefineParams& refineParams);
+
+    // no copy constructor
+    DepthMapEstimatorCpu(DepthMapEstimatorCpu const&) = delete;
+
+    // no copy operator
+    void operator=(DepthMapEstimatorCpu const&) = delete;
+
+    // destructor
+    ~DepthMapEstimatorCpu() = default;
+
+    /**
+     * @brief Compute depth/similarity maps of the given cameras.
+     * @param[in] cams the list of cameras
+     */
+    void compute(const std::vector<int>& cams);
+
+private:
+
+    // private methods
+
+    /**
+     * @brief Build tile list from the given cameras.
+     * @param[in] cams the list of cameras
+     * @param[in,out] tiles the output tiles list
+     */
+    void getTilesList(const std::vector<int>& cams, std::vector<Tile>& tiles) const;
+
+    // private members
+
+    const mvsUtils::MultiViewParams& _mp;      //< multi-view parameters
+    const mvsUtils::TileParams& _tileParams;   //< tiling parameters
+    const DepthMapParams& _depthMapParams;     //< depth map estimation parameters
+    const SgmParams& _sgmParams;               //< parameters of Sgm process
+    const RefineParams& _refineParams;         //< parameters of Refine process
+    std::vector<ROI> _tileRoiList;             //< depth maps region-of-interest list
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,92 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <cmath>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @struct HostCameraParams
+ * @brief Camera parameters used by the CPU depth map estimation.
+ * @note Host counterpart of DeviceCameraParams, same conventions (downscaled K, float precision).
+ */
+struct HostCameraParams
+{
+    Eigen::Matrix<float, 3, 4> P;  //< projection matrix (downscaled)
+    Eigen::Matrix3f iP;            //< inverse of the rotation / calibration part of P
+    Vec3f C;                       //< camera center
+    Vec3f ZVect;                   //< camera z axis
+};
+
+/**
+ * @brief Fill the host camera parameters of the given camera at the given downscale.
+ * @param[out] cameraParams the output camera parameters
+ * @param[in] camId the camera index in the MultiViewParams
+ * @param[in] downscale the camera downscale factor
+ * @param[in] mp the multi-view parameters
+ */
+void fillHostCameraParams(HostCameraParams& cameraParams, int camId, int downscale, const mvsUtils::MultiViewParams& mp);
+
+/**
+ * @brief Project a 3d point.
+ * @return the 2d image coordinates
+ */
+inline Vec2f project3DPoint(const HostCameraParams& cam, const Vec3f& p)
+{
+    const Vec3f pp = cam.P.leftCols<3>() * p + cam.P.col(3);
+    const float pzInv = 1.0f / pp.z();
+    return Vec2f(pp.x() * pzInv, pp.y() * pzInv);
+}
+
+/**
+ * @brief Get the normalized direction of the ray going through the given pixel.
+ */
+inline Vec3f pixelRay(const HostCameraParams& cam, float x, float y)
+{
+    return (cam.iP * Vec3f(x, y, 1.0f)).normalized();
+}
+
+inline Vec3f linePlaneIntersect(const Vec3f& linePoint, const Vec3f& lineVect, const Vec3f& planePoint, const Vec3f& planeNormal)
+{
+    const float k = (planePoint.dot(planeNormal) - planeNormal.dot(linePoint)) / planeNormal.dot(lineVect);
+    return linePoint + lineVect * k;
+}
+
+inline Vec3f get3DPointForPixelAndFrontoParellePlaneRC(const HostCameraParams& cam, float x, float y, float fpPlaneDepth)
+{
+    const Vec3f planep = cam.C + cam.ZVect * fpPlaneDepth;
+    return linePlaneIntersect(cam.C, pixelRay(cam, x, y), planep, cam.ZVect);
+}
+
+inline Vec3f get3DPointForPixelAndDepthFromRC(const HostCameraParams& cam, float x, float y, float depth)
+{
+    return cam.C + pixelRay(cam, x, y) * depth;
+}
+
+inline float depthPlaneToDepth(const HostCameraParams& cam, float fpPlaneDepth, float x, float y)
+{
+    return (cam.C - get3DPointForPixelAndFrontoParellePlaneRC(cam, x, y, fpPlaneDepth)).norm();
+}
+
+/**
+ * @brief Compute the size of one pixel of the given camera at the given 3d point.
+ */
+inline float computePixSize(const HostCameraParams& cam, const Vec3f& p)
+{
+    const Vec2f rp = project3DPoint(cam, p);
+    const Vec3f refvect = pixelRay(cam, rp.x() + 1.0f, rp.y());
+    // point to line distance
+    return (cam.C - p).cross(refvect).norm();
+}
+
+} // namespace depthMap
+} // namespace aliceVision
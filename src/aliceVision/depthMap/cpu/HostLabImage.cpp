@@ -0,0 +1,106 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "HostLabImage.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Linear RGB (0..1) to CIELAB (0..255) assuming D65 whitepoint.
+ * @note Same conversion as the CUDA rgb2lab kernel (rgb2xyz + xyz2lab).
+ */
+inline void rgb2lab(float r, float g, float b, float& l, float& la, float& lb)
+{
+    const float x = (0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / 0.95047f;
+    const float y = (0.2126729f * r + 0.7151522f * g + 0.0721750f * b);
+    const float z = (0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / 1.08883f;
+
+    const auto f = [](float t) { return (t > 216.0f / 24389.0f) ? std::cbrt(t) : (24389.0f / 27.0f * t + 16.0f) / 116.0f; };
+
+    const float fx = f(x);
+    const float fy = f(y);
+    const float fz = f(z);
+
+    // convert values to fit into 0..255 (could be out-of-range)
+    l  = (116.0f * fy - 16.0f) * 2.55f;
+    la = (500.0f * (fx - fy)) * 2.55f;
+    lb = (200.0f * (fy - fz)) * 2.55f;
+}
+
+} // namespace
+
+void HostLabImage::fill(const image::Image<image::RGBAfColor>& img, int downscale)
+{
+    const int width  = divideRoundUp(img.Width(), downscale);
+    const int height = divideRoundUp(img.Height(), downscale);
+
+    _img.resize(width, height);
+
+#pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            // box filter downscale
+            const int xBegin = x * downscale;
+            const int yBegin = y * downscale;
+            const int xEnd = std::min(xBegin + downscale, img.Width());
+            const int yEnd = std::min(yBegin + downscale, img.Height());
+
+            image::RGBAfColor sum(0.f, 0.f, 0.f, 0.f);
+            for(int yi = yBegin; yi < yEnd; ++yi)
+                for(int xi = xBegin; xi < xEnd; ++xi)
+                    sum = sum + img(yi, xi);
+
+            const float invNbPixels = 1.f / float((xEnd - xBegin) * (yEnd - yBegin));
+
+            float l, la, lb;
+            rgb2lab(sum.r() * invNbPixels, sum.g() * invNbPixels, sum.b() * invNbPixels, l, la, lb);
+
+            _img(y, x) = image::RGBAfColor(l, la, lb, sum.a() * invNbPixels * 255.f);
+        }
+    }
+}
+
+std::shared_ptr<const HostLabImage> HostLabImageCache::request(int camId, int downscale)
+{
+    const Key key(camId, downscale);
+
+    for(auto it = _images.begin(); it != _images.end(); ++it)
+    {
+        if(it->first == key)
+        {
+            // move to front (most recently used)
+            _images.splice(_images.begin(), _images, it);
+            return _images.front().second;
+        }
+    }
+
+    ALICEVISION_LOG_TRACE("Add CIELAB image on host cache (id: " << camId << ", view id: " << _mp.getViewId(camId) << ", downscale: " << downscale << ").");
+
+    auto labImage = std::make_shared<HostLabImage>();
+    {
+        const mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>::ImgSharedPtr img = _imagesCache.getImg_sync(camId);
+        labImage->fill(*img, downscale);
+    }
+
+    _images.emplace_front(key, labImage);
+
+    if(int(_images.size()) > _maxNbImages)
+        _images.pop_back();
+
+    return labImage;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
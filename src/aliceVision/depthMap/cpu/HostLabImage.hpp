@@ -0,0 +1,124 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/pixelTypes.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <utility>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class HostLabImage
+ * @brief Downscaled CIELAB image used by the CPU depth map estimation.
+ * @note Host counterpart of one DeviceMipmapImage level:
+ *       - L, a, b and alpha channels in range (0, 255)
+ *       - bilinear sampling with pixel centers at integer coordinates and clamped borders
+ */
+class HostLabImage
+{
+public:
+
+    /**
+     * @brief Fill the image from a full-size linear RGBA image.
+     * @param[in] img the full-size input image, RGBA in range (0, 1)
+     * @param[in] downscale the downscale factor (box filter)
+     */
+    void fill(const image::Image<image::RGBAfColor>& img, int downscale);
+
+    inline int width() const { return _img.Width(); }
+    inline int height() const { return _img.Height(); }
+
+    inline const image::RGBAfColor& at(int x, int y) const
+    {
+        return _img(std::min(std::max(y, 0), height() - 1), std::min(std::max(x, 0), width() - 1));
+    }
+
+    /**
+     * @brief Bilinear sampling of the image at the given coordinates.
+     */
+    inline image::RGBAfColor sample(float x, float y) const
+    {
+        const float fx = std::floor(x);
+        const float fy = std::floor(y);
+        const float dx = x - fx;
+        const float dy = y - fy;
+        const int ix = int(fx);
+        const int iy = int(fy);
+
+        const image::RGBAfColor top = at(ix, iy) * (1.f - dx) + at(ix + 1, iy) * dx;
+        const image::RGBAfColor bottom = at(ix, iy + 1) * (1.f - dx) + at(ix + 1, iy + 1) * dx;
+        return top * (1.f - dy) + bottom * dy;
+    }
+
+    /**
+     * @brief Bilinear sampling of the L channel only.
+     */
+    inline float sampleL(float x, float y) const
+    {
+        const float fx = std::floor(x);
+        const float fy = std::floor(y);
+        const float dx = x - fx;
+        const float dy = y - fy;
+        const int ix = int(fx);
+        const int iy = int(fy);
+
+        const float top = at(ix, iy).r() * (1.f - dx) + at(ix + 1, iy).r() * dx;
+        const float bottom = at(ix, iy + 1).r() * (1.f - dx) + at(ix + 1, iy + 1).r() * dx;
+        return top * (1.f - dy) + bottom * dy;
+    }
+
+private:
+    image::Image<image::RGBAfColor> _img;
+};
+
+/**
+ * @class HostLabImageCache
+ * @brief Small LRU cache of downscaled CIELAB images, keyed by (camera, downscale).
+ */
+class HostLabImageCache
+{
+public:
+
+    /**
+     * @param[in] maxNbImages the maximum number of images kept in memory
+     * @param[in] imagesCache the full-size images cache
+     * @param[in] mp the multi-view parameters
+     */
+    HostLabImageCache(int maxNbImages,
+                      mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>& imagesCache,
+                      const mvsUtils::MultiViewParams& mp)
+      : _maxNbImages(maxNbImages)
+      , _imagesCache(imagesCache)
+      , _mp(mp)
+    {}
+
+    /**
+     * @brief Get the given camera image at the given downscale, load it if needed.
+     * @note Not thread-safe, should be called outside of parallel sections.
+     */
+    std::shared_ptr<const HostLabImage> request(int camId, int downscale);
+
+private:
+    using Key = std::pair<int, int>;
+
+    const int _maxNbImages;
+    mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>& _imagesCache;
+    const mvsUtils::MultiViewParams& _mp;
+    std::list<std::pair<Key, std::shared_ptr<const HostLabImage>>> _images; //< most recently used first
+};
+
+} // namespace depthMap
+} // namespace aliceVision
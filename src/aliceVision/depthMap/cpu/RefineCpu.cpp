@@ -0,0 +1,551 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RefineCpu.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/depthMap/cpu/HostCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/patchSimilarity.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <memory>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Angle (in degrees) between AB and AC.
+ */
+inline float angleBetwABandAC(const Vec3f& A, const Vec3f& B, const Vec3f& C)
+{
+    const Vec3f V1 = (B - A).normalized();
+    const Vec3f V2 = (C - A).normalized();
+
+    double a = std::acos(double(V1.dot(V2)));
+    a = std::isinf(a) ? 0.0 : a;
+    return float(std::abs(a) / (boost::math::constants::pi<double>() / 180.0));
+}
+
+/**
+ * @brief Get the smoothing step and the energy of the given cell.
+ * @note Host counterpart of the CUDA getCellSmoothStepEnergy function.
+ * @return (smoothStep, energy)
+ */
+inline Vec2f getCellSmoothStepEnergy(const HostCameraParams& rcCam,
+                                     const image::Image<float>& depthMap,
+                                     int cellX,
+                                     int cellY,
+                                     const ROI& roi,
+                                     int stepXY)
+{
+    Vec2f out(0.0f, 180.0f);
+
+    const auto depthAt = [&](int x, int y)
+    {
+        return depthMap(std::min(std::max(y, 0), depthMap.Height() - 1), std::min(std::max(x, 0), depthMap.Width() - 1));
+    };
+
+    const auto pointAt = [&](int x, int y, float depth)
+    {
+        return get3DPointForPixelAndDepthFromRC(rcCam, float((roi.x.begin + x) * stepXY), float((roi.y.begin + y) * stepXY), depth);
+    };
+
+    // get pixel depth
+    const float d0 = depthAt(cellX, cellY);
+
+    // early exit: depth is <= 0
+    if(d0 <= 0.0f)
+        return out;
+
+    // consider the neighbor pixels
+    // note: same neighbor convention as the CUDA implementation
+    const float dL = depthAt(cellX, cellY - 1);
+    const float dR = depthAt(cellX, cellY + 1);
+    const float dU = depthAt(cellX - 1, cellY);
+    const float dB = depthAt(cellX + 1, cellY);
+
+    // get associated 3D points
+    const Vec3f p0 = pointAt(cellX, cellY, d0);
+    const Vec3f pL = pointAt(cellX, cellY - 1, dL);
+    const Vec3f pR = pointAt(cellX, cellY + 1, dR);
+    const Vec3f pU = pointAt(cellX - 1, cellY, dU);
+    const Vec3f pB = pointAt(cellX + 1, cellY, dB);
+
+    // compute the average point based on neighbors (cg)
+    Vec3f cg(0.0f, 0.0f, 0.0f);
+    float n = 0.0f;
+
+    if(dL > 0.0f) { cg += pL; n++; }
+    if(dR > 0.0f) { cg += pR; n++; }
+    if(dU > 0.0f) { cg += pU; n++; }
+    if(dB > 0.0f) { cg += pB; n++; }
+
+    // if we have at least one valid depth
+    if(n > 1.0f)
+    {
+        cg /= n; // average of x, y, depth
+        const Vec3f vcn = (rcCam.C - p0).normalized();
+        // pS: projection of cg on the line from p0 to camera
+        const Vec3f pS = p0 + vcn * vcn.dot(cg - p0);
+        // keep the depth difference between pS and p0 as the smoothing step
+        out.x() = (rcCam.C - pS).norm() - d0;
+    }
+
+    float e = 0.0f;
+    n = 0.0f;
+
+    if(dL > 0.0f && dR > 0.0f)
+    {
+        // large angle between neighbors == flat area => low energy
+        // small angle between neighbors == non-flat area => high energy
+        e = std::max(e, (180.0f - angleBetwABandAC(p0, pL, pR)));
+        n++;
+    }
+    if(dU > 0.0f && dB > 0.0f)
+    {
+        e = std::max(e, (180.0f - angleBetwABandAC(p0, pU, pB)));
+        n++;
+    }
+    // the higher the energy, the less flat the area
+    if(n > 0.0f)
+        out.y() = e;
+
+    return out;
+}
+
+} // namespace
+
+RefineCpu::RefineCpu(const mvsUtils::MultiViewParams& mp,
+                     const mvsUtils::TileParams& tileParams,
+                     const RefineParams& refineParams)
+    : _mp(mp)
+    , _tileParams(tileParams)
+    , _refineParams(refineParams)
+{}
+
+void RefineCpu::refineRc(const Tile& tile,
+                         const image::Image<float>& sgmDepthMap,
+                         const image::Image<float>& sgmThicknessMap,
+                         HostLabImageCache& imageCache)
+{
+    const IndexT viewId = _mp.getViewId(tile.rc);
+
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) depth/sim map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / " << _mp.ncams << ").");
+
+    const std::shared_ptr<const HostLabImage> rcImage = imageCache.request(tile.rc, _refineParams.scale);
+
+    // compute upscaled SGM depth/pixSize map
+    // - upscale SGM depth/thickness map
+    // - filter masked pixels (alpha)
+    // - compute pixSize from SGM thickness
+    computeSgmUpscaledDepthPixSizeMap(tile, sgmDepthMap, sgmThicknessMap, *rcImage);
+
+    // export intermediate depth/pixSize map (if requested by user)
+    if(_refineParams.exportIntermediateDepthSimMaps)
+    {
+        mvsUtils::writeMap(tile.rc, _mp, mvsUtils::EFileType::depthMap, _tileParams, tile.roi, _sgmDepthMap, _refineParams.scale, _refineParams.stepXY, "_sgmUpscaled");
+        mvsUtils::writeMap(tile.rc, _mp, mvsUtils::EFileType::pixSizeMap, _tileParams, tile.roi, _sgmPixSizeMap, _refineParams.scale, _refineParams.stepXY, "_sgmUpscaled");
+    }
+
+    // refine and fuse depth/sim map
+    if(_refineParams.useRefineFuse)
+    {
+        // refine and fuse with volume strategy
+        refineAndFuseDepthSimMap(tile, imageCache);
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO(tile << "Refine and fuse depth/sim map volume disabled.");
+        _refinedDepthMap = _sgmDepthMap;
+        _refinedSimMap.resize(_sgmDepthMap.Width(), _sgmDepthMap.Height(), true, 1.0f);
+    }
+
+    // export intermediate depth/sim map (if requested by user)
+    if(_refineParams.exportIntermediateDepthSimMaps)
+    {
+        mvsUtils::writeMap(tile.rc, _mp, mvsUtils::EFileType::depthMap, _tileParams, tile.roi, _refinedDepthMap, _refineParams.scale, _refineParams.stepXY, "_refinedFused");
+        mvsUtils::writeMap(tile.rc, _mp, mvsUtils::EFileType::simMap, _tileParams, tile.roi, _refinedSimMap, _refineParams.scale, _refineParams.stepXY, "_refinedFused");
+    }
+
+    // optimize depth/sim map
+    if(_refineParams.useColorOptimization && _refineParams.optimizationNbIterations > 0)
+    {
+        optimizeDepthSimMap(tile, *rcImage);
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO(tile << "Color optimize depth/sim map disabled.");
+        _optimizedDepthMap = _refinedDepthMap;
+        _optimizedSimMap = _refinedSimMap;
+    }
+
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) depth/sim map done.");
+}
+
+void RefineCpu::computeSgmUpscaledDepthPixSizeMap(const Tile& tile,
+                                                  const image::Image<float>& sgmDepthMap,
+                                                  const image::Image<float>& sgmThicknessMap,
+                                                  const HostLabImage& rcImage)
+{
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+    const int width = int(downscaledRoi.width());
+    const int height = int(downscaledRoi.height());
+    const int stepXY = _refineParams.stepXY;
+    const float halfNbDepths = float(_refineParams.halfNbDepths);
+
+    // compute upscale ratio
+    const float ratio = float(sgmDepthMap.Width()) / float(width);
+
+    // last valid SGM map indexes
+    const int sgmLastX = std::min(int(float(width) * ratio), sgmDepthMap.Width()) - 1;
+    const int sgmLastY = std::min(int(float(height) * ratio), sgmDepthMap.Height()) - 1;
+
+    _sgmDepthMap.resize(width, height);
+    _sgmPixSizeMap.resize(width, height);
+
+    #pragma omp parallel for
+    for(int roiY = 0; roiY < height; ++roiY)
+    {
+        for(int roiX = 0; roiX < width; ++roiX)
+        {
+            // corresponding image coordinates
+            const int x = (downscaledRoi.x.begin + roiX) * stepXY;
+            const int y = (downscaledRoi.y.begin + roiY) * stepXY;
+
+            // filter masked pixels with alpha
+            if(rcImage.at(x, y).a() < HOST_DEPTHMAP_RC_MIN_ALPHA)
+            {
+                _sgmDepthMap(roiY, roiX) = -2.f;
+                _sgmPixSizeMap(roiY, roiX) = 0.f;
+                continue;
+            }
+
+            const float oy = (float(roiY) - 0.5f) * ratio;
+            const float ox = (float(roiX) - 0.5f) * ratio;
+
+            float depth;
+            float thickness;
+
+            if(_refineParams.interpolateMiddleDepth && sgmLastX > 0 && sgmLastY > 0)
+            {
+                // find adjacent pixels
+                const int xp = std::max(0, std::min(int(std::floor(ox)), sgmLastX - 1));
+                const int yp = std::max(0, std::min(int(std::floor(oy)), sgmLastY - 1));
+
+                const float luD = sgmDepthMap(yp, xp),         luT = sgmThicknessMap(yp, xp);
+                const float ruD = sgmDepthMap(yp, xp + 1),     ruT = sgmThicknessMap(yp, xp + 1);
+                const float rdD = sgmDepthMap(yp + 1, xp + 1), rdT = sgmThicknessMap(yp + 1, xp + 1);
+                const float ldD = sgmDepthMap(yp + 1, xp),     ldT = sgmThicknessMap(yp + 1, xp);
+
+                if(luD <= 0.0f || ruD <= 0.0f || rdD <= 0.0f || ldD <= 0.0f)
+                {
+                    // at least one corner depth is invalid
+                    // average the other corners to get a proper depth/thickness
+                    float sumDepth = 0.0f;
+                    float sumThickness = 0.0f;
+                    int count = 0;
+
+                    if(luD > 0.0f) { sumDepth += luD; sumThickness += luT; ++count; }
+                    if(ruD > 0.0f) { sumDepth += ruD; sumThickness += ruT; ++count; }
+                    if(rdD > 0.0f) { sumDepth += rdD; sumThickness += rdT; ++count; }
+                    if(ldD > 0.0f) { sumDepth += ldD; sumThickness += ldT; ++count; }
+
+                    if(count == 0)
+                    {
+                        // invalid depth
+                        _sgmDepthMap(roiY, roiX) = -1.f;
+                        _sgmPixSizeMap(roiY, roiX) = 1.f;
+                        continue;
+                    }
+
+                    depth = sumDepth / float(count);
+                    thickness = sumThickness / float(count);
+                }
+                else
+                {
+                    // bilinear interpolation
+                    const float ui = ox - float(xp);
+                    const float vi = oy - float(yp);
+                    const float uD = luD + (ruD - luD) * ui;
+                    const float dD = ldD + (rdD - ldD) * ui;
+                    const float uT = luT + (ruT - luT) * ui;
+                    const float dT = ldT + (rdT - ldT) * ui;
+                    depth = uD + (dD - uD) * vi;
+                    thickness = uT + (dT - uT) * vi;
+                }
+            }
+            else
+            {
+                // nearest neighbor, no interpolation
+                const int xp = std::max(0, std::min(int(std::floor(ox + 0.5f)), sgmLastX));
+                const int yp = std::max(0, std::min(int(std::floor(oy + 0.5f)), sgmLastY));
+
+                depth = sgmDepthMap(yp, xp);
+                thickness = sgmThicknessMap(yp, xp);
+            }
+
+            // compute pixSize from depth thickness
+            _sgmDepthMap(roiY, roiX) = depth;
+            _sgmPixSizeMap(roiY, roiX) = thickness / halfNbDepths;
+        }
+    }
+}
+
+void RefineCpu::refineAndFuseDepthSimMap(const Tile& tile, HostLabImageCache& imageCache)
+{
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) and fuse depth/sim map volume.");
+
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+    const int width = _sgmDepthMap.Width();
+    const int height = _sgmDepthMap.Height();
+    const int volDimZ = _refineParams.halfNbDepths * 2 + 1;
+    const int stepXY = _refineParams.stepXY;
+
+    // initialize the similarity volume at 0
+    // each tc filtered and inverted similarity value will be summed in this volume
+    _volumeRefineSim.assign(std::size_t(width) * std::size_t(height) * std::size_t(volDimZ), 0.f);
+
+    HostCameraParams rcCam;
+    fillHostCameraParams(rcCam, tile.rc, _refineParams.scale, _mp);
+    const std::shared_ptr<const HostLabImage> rcImage = imageCache.request(tile.rc, _refineParams.scale);
+
+    // compute for each RcTc each similarity value for each depth to refine
+    // sum the inverted / filtered similarity value, best value is the HIGHEST
+    for(std::size_t tci = 0; tci < tile.refineTCams.size(); ++tci)
+    {
+        const int tc = tile.refineTCams.at(tci);
+
+        HostCameraParams tcCam;
+        fillHostCameraParams(tcCam, tc, _refineParams.scale, _mp);
+        const std::shared_ptr<const HostLabImage> tcImage = imageCache.request(tc, _refineParams.scale);
+
+        ALICEVISION_LOG_DEBUG(tile << "Refine similarity volume (CPU):" << std::endl
+                                   << "\t- rc: " << tile.rc << std::endl
+                                   << "\t- tc: " << tc << " (" << (tci + 1) << "/" << tile.refineTCams.size() << ")" << std::endl
+                                   << "\t- tile range x: [" << downscaledRoi.x.begin << " - " << downscaledRoi.x.end << "]" << std::endl
+                                   << "\t- tile range y: [" << downscaledRoi.y.begin << " - " << downscaledRoi.y.end << "]" << std::endl);
+
+        #pragma omp parallel
+        {
+            // one patch similarity buffer per thread
+            PatchSimilarity patchSimilarity(_refineParams.wsh, _refineParams.gammaC, _refineParams.gammaP);
+
+            #pragma omp for schedule(dynamic)
+            for(int vy = 0; vy < height; ++vy)
+            {
+                const float y = float((downscaledRoi.y.begin + vy) * stepXY);
+
+                for(int vx = 0; vx < width; ++vx)
+                {
+                    const float x = float((downscaledRoi.x.begin + vx) * stepXY);
+                    const float sgmDepth = _sgmDepthMap(vy, vx);
+                    const float sgmPixSize = _sgmPixSizeMap(vy, vx);
+
+                    // sgm depth (middle depth) invalid or masked
+                    if(sgmDepth <= 0.0f)
+                        continue;
+
+                    // rc 3d point at sgm depth (middle depth) and its ray direction
+                    const Vec3f pMiddle = get3DPointForPixelAndDepthFromRC(rcCam, x, y, sgmDepth);
+                    const Vec3f rayDir = (pMiddle - rcCam.C).normalized();
+
+                    float* volSim = &_volumeRefineSim[(std::size_t(vy) * width + vx) * volDimZ];
+
+                    for(int vz = 0; vz < volDimZ; ++vz)
+                    {
+                        // move rc 3d point by relative depth index offset * sgm pixSize
+                        const int relativeDepthIndexOffset = vz - ((volDimZ - 1) / 2);
+
+                        // compute patch
+                        HostPatch patch;
+                        patch.p = pMiddle + rayDir * (float(relativeDepthIndexOffset) * sgmPixSize);
+                        patch.d = computePixSize(rcCam, patch.p);
+                        computeRotCSEpip(patch, rcCam, tcCam);
+
+                        // we need positive and filtered similarity values
+                        const float fsimInvertedFiltered = patchSimilarity.compute<true>(rcCam, tcCam, *rcImage, *tcImage, patch);
+
+                        if(!std::isfinite(fsimInvertedFiltered)) // invalid similarity
+                            continue;
+
+                        volSim[vz] += fsimInvertedFiltered;
+                    }
+                }
+            }
+        }
+    }
+
+    // retrieve the best depth/sim in the volume
+    // compute sub-pixel sample using a sliding gaussian
+    const int samplesPerPixSize = _refineParams.nbSubsamples;
+    const int halfNbSamples = _refineParams.nbSubsamples * _refineParams.halfNbDepths;
+    const int halfNbDepths = _refineParams.halfNbDepths;
+    const float twoTimesSigmaPowerTwo = float(2.0 * _refineParams.sigma * _refineParams.sigma);
+
+    // gaussian weights only depend on the distance between the depth sample and the subsample
+    std::vector<float> gaussianWeights(2 * (halfNbSamples + halfNbDepths * samplesPerPixSize) + 1);
+    const int gaussianOffset = int(gaussianWeights.size() / 2);
+    for(int i = 0; i < int(gaussianWeights.size()); ++i)
+    {
+        const float dist = float(i - gaussianOffset);
+        gaussianWeights[i] = std::exp(-(dist * dist) / twoTimesSigmaPowerTwo);
+    }
+
+    _refinedDepthMap.resize(width, height);
+    _refinedSimMap.resize(width, height);
+
+    #pragma omp parallel for
+    for(int vy = 0; vy < height; ++vy)
+    {
+        for(int vx = 0; vx < width; ++vx)
+        {
+            const float sgmDepth = _sgmDepthMap(vy, vx);
+
+            // sgm depth (middle depth) invalid or masked
+            if(sgmDepth <= 0.0f)
+            {
+                _refinedDepthMap(vy, vx) = sgmDepth; // -1 (invalid) or -2 (masked)
+                _refinedSimMap(vy, vx) = 1.0f;       // similarity between (-1, +1)
+                continue;
+            }
+
+            const float* volSim = &_volumeRefineSim[(std::size_t(vy) * width + vx) * volDimZ];
+
+            // find best z sample per pixel
+            float bestSampleSim = 0.f;      // all sample sim <= 0.f
+            int bestSampleOffsetIndex = 0;  // default is middle depth (SGM)
+
+            // sliding gaussian window
+            for(int sample = -halfNbSamples; sample <= halfNbSamples; ++sample)
+            {
+                float sampleSim = 0.f;
+
+                for(int vz = 0; vz < volDimZ; ++vz)
+                {
+                    const int zs = (vz - halfNbDepths) * samplesPerPixSize; // relative sample offset
+
+                    // reverse the inverted similarity sum value, best value is the LOWEST
+                    sampleSim += -volSim[vz] * gaussianWeights[zs - sample + gaussianOffset];
+                }
+
+                if(sampleSim < bestSampleSim)
+                {
+                    bestSampleOffsetIndex = sample;
+                    bestSampleSim = sampleSim;
+                }
+            }
+
+            // input sgm depth (middle depth) + sample size offset from z center
+            const float sampleSize = _sgmPixSizeMap(vy, vx) / float(samplesPerPixSize);
+            _refinedDepthMap(vy, vx) = sgmDepth + float(bestSampleOffsetIndex) * sampleSize;
+            _refinedSimMap(vy, vx) = bestSampleSim;
+        }
+    }
+
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) and fuse depth/sim map volume done.");
+}
+
+void RefineCpu::optimizeDepthSimMap(const Tile& tile, const HostLabImage& rcImage)
+{
+    ALICEVISION_LOG_INFO(tile << "Color optimize (CPU) depth/sim map.");
+
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+    const int width = _sgmDepthMap.Width();
+    const int height = _sgmDepthMap.Height();
+    const int stepXY = _refineParams.stepXY;
+
+    HostCameraParams rcCam;
+    fillHostCameraParams(rcCam, tile.rc, _refineParams.scale, _mp);
+
+    // compute image variance map (gradient size of L)
+    image::Image<float> imgVarianceMap(width, height);
+
+    #pragma omp parallel for
+    for(int roiY = 0; roiY < height; ++roiY)
+    {
+        for(int roiX = 0; roiX < width; ++roiX)
+        {
+            const float x = float((downscaledRoi.x.begin + roiX) * stepXY);
+            const float y = float((downscaledRoi.y.begin + roiY) * stepXY);
+
+            const float xM1 = rcImage.sampleL(x - 1.f, y);
+            const float xP1 = rcImage.sampleL(x + 1.f, y);
+            const float yM1 = rcImage.sampleL(x, y - 1.f);
+            const float yP1 = rcImage.sampleL(x, y + 1.f);
+
+            imgVarianceMap(roiY, roiX) = Vec2f(xM1 - xP1, yM1 - yP1).norm();
+        }
+    }
+
+    // initialize depth/sim map optimized with SGM depth and refined similarity
+    _optimizedDepthMap = _sgmDepthMap;
+    _optimizedSimMap = _refinedSimMap;
+
+    image::Image<float> tmpOptDepthMap;
+
+    for(int iter = 0; iter < _refineParams.optimizationNbIterations; ++iter) // default nb iterations is 100
+    {
+        // each iteration reads the depths of the previous iteration
+        tmpOptDepthMap = _optimizedDepthMap;
+
+        #pragma omp parallel for
+        for(int roiY = 0; roiY < height; ++roiY)
+        {
+            for(int roiX = 0; roiX < width; ++roiX)
+            {
+                const float depthOpt = tmpOptDepthMap(roiY, roiX);
+
+                if(depthOpt <= 0.0f)
+                    continue;
+
+                // SGM upscale (rough) depth/pixSize
+                const float sgmDepth = _sgmDepthMap(roiY, roiX);
+                const float sgmPixSize = _sgmPixSizeMap(roiY, roiX);
+
+                // refined and fused (fine) depth/sim
+                const float refineDepth = _refinedDepthMap(roiY, roiX);
+                const float refineSim = _refinedSimMap(roiY, roiX);
+
+                const Vec2f depthSmoothStepEnergy = getCellSmoothStepEnergy(rcCam, tmpOptDepthMap, roiX, roiY, downscaledRoi, stepXY); // (smoothStep, energy)
+                float stepToSmoothDepth = depthSmoothStepEnergy.x();
+                stepToSmoothDepth = std::copysign(std::min(std::abs(stepToSmoothDepth), sgmPixSize / 10.0f), stepToSmoothDepth);
+                const float depthEnergy = depthSmoothStepEnergy.y(); // max angle with neighbors
+                float stepToFineDM = refineDepth - depthOpt; // distance to refined/noisy input depth map
+                stepToFineDM = std::copysign(std::min(std::abs(stepToFineDM), sgmPixSize / 10.0f), stepToFineDM);
+
+                const float stepToRoughDM = sgmDepth - depthOpt; // distance to smooth/robust input depth map
+                const float imgColorVariance = imgVarianceMap(roiY, roiX);
+                const float colorVarianceThresholdForSmoothing = 20.0f;
+                const float angleThresholdForSmoothing = 30.0f;
+
+                const float weightedColorVariance = sigmoid2(5.0f, angleThresholdForSmoothing, 40.0f, colorVarianceThresholdForSmoothing, imgColorVariance);
+                const float fineSimWeight = sigmoid(0.0f, 1.0f, 0.7f, -0.7f, refineSim);
+
+                // if geometry variation is bigger than color variation => the fineDM is considered noisy
+                const float energyLowerThanVarianceWeight = sigmoid(0.0f, 1.0f, 30.0f, weightedColorVariance, depthEnergy);
+                const float closeToRoughWeight = 1.0f - sigmoid(0.0f, 1.0f, 10.0f, 17.0f, std::abs(stepToRoughDM / sgmPixSize));
+
+                const float depthOptStep = closeToRoughWeight * stepToRoughDM + // distance to smooth/robust input depth map
+                                           (1.0f - closeToRoughWeight) * (energyLowerThanVarianceWeight * fineSimWeight * stepToFineDM + // distance to refined/noisy
+                                                                          (1.0f - energyLowerThanVarianceWeight) * stepToSmoothDepth); // max angle in current depthMap
+
+                _optimizedDepthMap(roiY, roiX) = depthOpt + depthOptStep;
+                _optimizedSimMap(roiY, roiX) = (1.0f - closeToRoughWeight) * (energyLowerThanVarianceWeight * fineSimWeight * refineSim + (1.0f - energyLowerThanVarianceWeight) * (depthEnergy / 20.0f));
+            }
+        }
+    }
+
+    ALICEVISION_LOG_INFO(tile << "Color optimize (CPU) depth/sim map done.");
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/Tile.hpp>
+#include <aliceVision/depthMap/cpu/HostLabImage.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class Depth map estimation Refine on CPU
+ * @brief Manages the calculation of the Refine step on CPU.
+ * @note CPU counterpart of Refine.
+ */
+class RefineCpu
+{
+public:
+
+    /**
+     * @brief RefineCpu constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] tileParams tile workflow parameters
+     * @param[in] refineParams the Refine parameters
+     */
+    RefineCpu(const mvsUtils::MultiViewParams& mp,
+              const mvsUtils::TileParams& tileParams,
+              const RefineParams& refineParams);
+
+    // final depth map getter
+    inline const image::Image<float>& getDepthMap() const { return _optimizedDepthMap; }
+
+    // final similarity map getter
+    inline const image::Image<float>& getSimMap() const { return _optimizedSimMap; }
+
+    /**
+     * @brief Refine for a single R camera the Semi-Global Matching depth/thickness map.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in] sgmDepthMap the SGM result depth map
+     * @param[in] sgmThicknessMap the SGM result thickness map
+     * @param[in,out] imageCache the CIELAB images cache
+     */
+    void refineRc(const Tile& tile,
+                  const image::Image<float>& sgmDepthMap,
+                  const image::Image<float>& sgmThicknessMap,
+                  HostLabImageCache& imageCache);
+
+private:
+
+    // private methods
+
+    /**
+     * @brief Compute the upscaled SGM depth/pixSize map.
+     * @note Filter masked pixels and compute the pixSize from the SGM thickness.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in] sgmDepthMap the SGM result depth map
+     * @param[in] sgmThicknessMap the SGM result thickness map
+     * @param[in] rcImage the R camera CIELAB image at Refine scale
+     */
+    void computeSgmUpscaledDepthPixSizeMap(const Tile& tile,
+                                           const image::Image<float>& sgmDepthMap,
+                                           const image::Image<float>& sgmThicknessMap,
+                                           const HostLabImage& rcImage);
+
+    /**
+     * @brief Refine and fuse the upscaled SGM depth map using volume strategy.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in,out] imageCache the CIELAB images cache
+     */
+    void refineAndFuseDepthSimMap(const Tile& tile, HostLabImageCache& imageCache);
+
+    /**
+     * @brief Optimize the refined depth/sim maps.
+     * @note Jacobi iterations, each pixel reads the depths of the previous iteration.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in] rcImage the R camera CIELAB image at Refine scale
+     */
+    void optimizeDepthSimMap(const Tile& tile, const HostLabImage& rcImage);
+
+    // private members
+
+    const mvsUtils::MultiViewParams& _mp;           //< Multi-view parameters
+    const mvsUtils::TileParams& _tileParams;        //< tile workflow parameters
+    const RefineParams& _refineParams;              //< Refine parameters
+
+    image::Image<float> _sgmDepthMap;               //< rc upscaled SGM depth map
+    image::Image<float> _sgmPixSizeMap;             //< rc upscaled SGM pixSize map
+    image::Image<float> _refinedDepthMap;           //< rc refined and fused depth map
+    image::Image<float> _refinedSimMap;             //< rc refined and fused similarity map
+    image::Image<float> _optimizedDepthMap;         //< rc optimized depth map
+    image::Image<float> _optimizedSimMap;           //< rc optimized similarity map
+    std::vector<float> _volumeRefineSim;            //< rc refine similarity volume, depth is the fastest axis
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,440 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "SgmCpu.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/depthMap/cpu/HostCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/patchSimilarity.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <memory>
+
+namespace aliceVision {
+namespace depthMap {
+
+SgmCpu::SgmCpu(const mvsUtils::MultiViewParams& mp,
+               const mvsUtils::TileParams& tileParams,
+               const SgmParams& sgmParams,
+               bool computeDepthSimMap)
+    : _mp(mp)
+    , _tileParams(tileParams)
+    , _sgmParams(sgmParams)
+    , _computeDepthSimMap(computeDepthSimMap || sgmParams.exportIntermediateDepthSimMaps)
+{}
+
+void SgmCpu::sgmRc(const Tile& tile, const SgmDepthList& tileDepthList, HostLabImageCache& imageCache)
+{
+    const IndexT viewId = _mp.getViewId(tile.rc);
+
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) depth/thickness map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / " << _mp.ncams << ").");
+
+    // check SGM depth list and T cameras
+    if(tile.sgmTCams.empty() || tileDepthList.getDepths().empty())
+        ALICEVISION_THROW_ERROR(tile << "Cannot compute Semi-Global Matching, no depths or no T cameras (viewId: " << viewId << ").");
+
+    // resize volumes and maps to the downscaled tile
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+    _volDimX = int(downscaledRoi.width());
+    _volDimY = int(downscaledRoi.height());
+    _volDimZ = int(tileDepthList.getDepths().size());
+
+    const std::size_t volSize = std::size_t(_volDimX) * std::size_t(_volDimY) * std::size_t(_volDimZ);
+    _volumeBestSim.assign(volSize, 255);
+    _volumeSecBestSim.assign(volSize, 255);
+
+    // compute best sim and second best sim volumes
+    computeSimilarityVolumes(tile, tileDepthList, imageCache);
+
+    // this is here for experimental purposes
+    // to show how SGGC work on non optimized depthmaps
+    // it must equals to true in normal case
+    if(_sgmParams.doSgmOptimizeVolume)
+    {
+        const std::shared_ptr<const HostLabImage> rcImage = imageCache.request(tile.rc, _sgmParams.scale);
+        optimizeSimilarityVolume(tile, tileDepthList, *rcImage);
+    }
+    else
+    {
+        // best sim volume is normally reuse to put optimized similarity
+        _volumeBestSim = _volumeSecBestSim;
+    }
+
+    // retrieve best depth
+    retrieveBestDepth(tile, tileDepthList);
+
+    // export intermediate depth/sim map (if requested by user)
+    if(_sgmParams.exportIntermediateDepthSimMaps)
+    {
+        mvsUtils::writeMap(tile.rc, _mp, mvsUtils::EFileType::depthMap, _tileParams, tile.roi, _depthMap, _sgmParams.scale, _sgmParams.stepXY, "_sgm");
+        mvsUtils::writeMap(tile.rc, _mp, mvsUtils::EFileType::simMap, _tileParams, tile.roi, _simMap, _sgmParams.scale, _sgmParams.stepXY, "_sgm");
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) depth/thickness map done.");
+}
+
+void SgmCpu::smoothThicknessMap(const Tile& tile, const RefineParams& refineParams)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Smooth thickness map.");
+
+    const int sgmScaleStep = _sgmParams.scale * _sgmParams.stepXY;
+    const int refineScaleStep = refineParams.scale * refineParams.stepXY;
+
+    // min/max number of Refine samples in SGM thickness area
+    const float minNbRefineSamples = 2.f;
+    const float maxNbRefineSamples = std::max(sgmScaleStep / float(refineScaleStep), minNbRefineSamples);
+
+    // min/max SGM thickness inflate factor
+    const float minThicknessInflate = refineParams.halfNbDepths / maxNbRefineSamples;
+    const float maxThicknessInflate = refineParams.halfNbDepths / minNbRefineSamples;
+
+    // read from a copy of the thickness map, result does not depend on the pixel processing order
+    const image::Image<float> inThicknessMap = _thicknessMap;
+
+    const int width = _depthMap.Width();
+    const int height = _depthMap.Height();
+
+#pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const float depth = _depthMap(y, x);
+
+            // depth invalid or masked
+            if(depth <= 0.0f)
+                continue;
+
+            const float minThickness = minThicknessInflate * inThicknessMap(y, x);
+            const float maxThickness = maxThicknessInflate * inThicknessMap(y, x);
+
+            // compute average depth distance to the center pixel
+            float sumCenterDepthDist = 0.f;
+            int nbValidPatchPixels = 0;
+
+            // patch 3x3
+            for(int yp = -1; yp <= 1; ++yp)
+            {
+                for(int xp = -1; xp <= 1; ++xp)
+                {
+                    const int xi = x + xp;
+                    const int yi = y + yp;
+
+                    if((xp == 0 && yp == 0) || xi < 0 || xi >= width || yi < 0 || yi >= height)
+                        continue;
+
+                    const float depthPatch = _depthMap(yi, xi);
+
+                    if(depthPatch > 0.0f)
+                    {
+                        const float depthDistance = std::abs(depth - depthPatch);
+                        sumCenterDepthDist += std::max(minThickness, std::min(maxThickness, depthDistance));
+                        ++nbValidPatchPixels;
+                    }
+                }
+            }
+
+            // we require at least 3 valid patch pixels (over 8)
+            if(nbValidPatchPixels < 3)
+                continue;
+
+            _thicknessMap(y, x) = sumCenterDepthDist / nbValidPatchPixels;
+        }
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Smooth thickness map done.");
+}
+
+void SgmCpu::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList, HostLabImageCache& imageCache)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Compute similarity volume.");
+
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+    const std::vector<float>& depths = tileDepthList.getDepths();
+
+    HostCameraParams rcCam;
+    fillHostCameraParams(rcCam, tile.rc, _sgmParams.scale, _mp);
+    const std::shared_ptr<const HostLabImage> rcImage = imageCache.request(tile.rc, _sgmParams.scale);
+
+    // compute similarity volume per Rc Tc
+    for(std::size_t tci = 0; tci < tile.sgmTCams.size(); ++tci)
+    {
+        const int tc = tile.sgmTCams.at(tci);
+        const int firstDepth = tileDepthList.getDepthsTcLimits()[tci].x;
+        const int lastDepth  = firstDepth + tileDepthList.getDepthsTcLimits()[tci].y;
+
+        HostCameraParams tcCam;
+        fillHostCameraParams(tcCam, tc, _sgmParams.scale, _mp);
+        const std::shared_ptr<const HostLabImage> tcImage = imageCache.request(tc, _sgmParams.scale);
+
+        ALICEVISION_LOG_DEBUG(tile << "Compute similarity volume (CPU):" << std::endl
+                                   << "\t- rc: " << tile.rc << std::endl
+                                   << "\t- tc: " << tc << " (" << (tci + 1) << "/" << tile.sgmTCams.size() << ")" << std::endl
+                                   << "\t- tc first depth: " << firstDepth << std::endl
+                                   << "\t- tc last depth: " << lastDepth << std::endl);
+
+        #pragma omp parallel
+        {
+            // one patch similarity buffer per thread
+            PatchSimilarity patchSimilarity(_sgmParams.wsh, _sgmParams.gammaC, _sgmParams.gammaP);
+
+            #pragma omp for schedule(dynamic)
+            for(int vy = 0; vy < _volDimY; ++vy)
+            {
+                const float y = float(downscaledRoi.y.begin + vy) * float(_sgmParams.stepXY);
+
+                for(int vx = 0; vx < _volDimX; ++vx)
+                {
+                    const float x = float(downscaledRoi.x.begin + vx) * float(_sgmParams.stepXY);
+                    const std::size_t voxelOffset = (std::size_t(vy) * _volDimX + vx) * _volDimZ;
+
+                    for(int vz = firstDepth; vz < lastDepth; ++vz)
+                    {
+                        // compute patch
+                        HostPatch patch;
+                        patch.p = get3DPointForPixelAndFrontoParellePlaneRC(rcCam, x, y, depths[vz]);
+                        patch.d = computePixSize(rcCam, patch.p);
+                        computeRotCSEpip(patch, rcCam, tcCam);
+
+                        // we do not need positive and filtered similarity values
+                        float fsim = patchSimilarity.compute<false>(rcCam, tcCam, *rcImage, *tcImage, patch);
+
+                        if(!std::isfinite(fsim)) // invalid similarity
+                        {
+                            fsim = 255.0f; // 255 is the invalid similarity value
+                        }
+                        else
+                        {
+                            // remap similarity value from (-1, 1) to (0, 254)
+                            // 255 is reserved for the similarity initialization, i.e. undefined values
+                            fsim = std::min(1.0f, std::max(0.0f, (fsim + 1.0f) * 0.5f)) * 254.0f;
+                        }
+
+                        unsigned char& fsim1st = _volumeBestSim[voxelOffset + vz];
+                        unsigned char& fsim2nd = _volumeSecBestSim[voxelOffset + vz];
+
+                        if(fsim < fsim1st)
+                        {
+                            fsim2nd = fsim1st;
+                            fsim1st = static_cast<unsigned char>(fsim);
+                        }
+                        else if(fsim < fsim2nd)
+                        {
+                            fsim2nd = static_cast<unsigned char>(fsim);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // update second best uninitialized similarity volume values with first best similarity volume values
+    // - allows to avoid the particular case with a single tc (second best volume has no valid similarity values)
+    // - useful if a tc alone contributes to the calculation of a subpart of the similarity volume
+    if(_sgmParams.updateUninitializedSim) // should always be true, false for debug purposes
+    {
+        #pragma omp parallel for
+        for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(_volumeSecBestSim.size()); ++i)
+        {
+            if(_volumeSecBestSim[i] >= 255)
+                _volumeSecBestSim[i] = _volumeBestSim[i];
+        }
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Compute similarity volume done.");
+}
+
+void SgmCpu::optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDepthList, const HostLabImage& rcImage)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Optimizing volume (filtering axes: " << _sgmParams.filteringAxes << ").");
+
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+    const int volDimZ = _volDimZ;
+    const float P1 = float(_sgmParams.p1);
+    const float P2Weighting = float(_sgmParams.p2Weighting);
+    const int stepXY = _sgmParams.stepXY;
+
+    // output volume reuses the best similarity volume
+    std::vector<unsigned char>& volAgr = _volumeBestSim;
+    const std::vector<unsigned char>& volSim = _volumeSecBestSim;
+
+    int filteringIndex = 0;
+
+    const auto aggregatePath = [&](bool alongY, bool invDir)
+    {
+        const int nbLines = alongY ? _volDimX : _volDimY;
+        const int lineLength = alongY ? _volDimY : _volDimX;
+
+        #pragma omp parallel
+        {
+            std::vector<float> pathCostPrev(volDimZ);
+            std::vector<float> pathCostCur(volDimZ);
+
+            #pragma omp for schedule(dynamic)
+            for(int line = 0; line < nbLines; ++line)
+            {
+                const auto voxelOffset = [&](int i)
+                {
+                    const int vx = alongY ? line : i;
+                    const int vy = alongY ? i : line;
+                    return (std::size_t(vy) * _volDimX + vx) * volDimZ;
+                };
+
+                const auto imageColor = [&](int i)
+                {
+                    const int vx = alongY ? line : i;
+                    const int vy = alongY ? i : line;
+                    return rcImage.at((downscaledRoi.x.begin + vx) * stepXY, (downscaledRoi.y.begin + vy) * stepXY);
+                };
+
+                const int iBegin = invDir ? lineLength - 1 : 0;
+                const int iStep = invDir ? -1 : 1;
+
+                // first voxel column of the path: the path cost is the similarity
+                {
+                    const std::size_t offset = voxelOffset(iBegin);
+                    for(int z = 0; z < volDimZ; ++z)
+                    {
+                        pathCostPrev[z] = float(volSim[offset + z]);
+                        const float val = (float(volAgr[offset + z]) * float(filteringIndex) + pathCostPrev[z]) / float(filteringIndex + 1);
+                        volAgr[offset + z] = static_cast<unsigned char>(val);
+                    }
+                }
+
+                for(int n = 1; n < lineLength; ++n)
+                {
+                    const int i = iBegin + n * iStep;
+                    const std::size_t offset = voxelOffset(i);
+
+                    // best path cost of the previous voxel column
+                    const float bestCostPrev = *std::min_element(pathCostPrev.begin(), pathCostPrev.end());
+
+                    float P2 = 0;
+                    if(P2Weighting < 0)
+                    {
+                        // P2 convention: use negative value to skip the use of deltaC.
+                        P2 = std::abs(P2Weighting);
+                    }
+                    else
+                    {
+                        const image::RGBAfColor gcr0 = imageColor(i);
+                        const image::RGBAfColor gcr1 = imageColor(i - iStep);
+                        const float deltaC = (gcr0.head<3>() - gcr1.head<3>()).norm();
+
+                        // sigmoid f(x) = i + (a - i) * (1 / ( 1 + e^(10 * (x - P2) / w)))
+                        // best values found from tests: i = 80, a = 255, w = 80, P2 = 100
+                        P2 = sigmoid(80.f, 255.f, 80.f, P2Weighting, deltaC);
+                    }
+
+                    pathCostCur[0] = 255.f;
+                    pathCostCur[volDimZ - 1] = 255.f;
+
+                    for(int z = 1; z < volDimZ - 1; ++z)
+                    {
+                        const float minCost = std::min(std::min(pathCostPrev[z], bestCostPrev + P2),
+                                                       std::min(pathCostPrev[z - 1], pathCostPrev[z + 1]) + P1);
+
+                        // similarity accumulation type is an unsigned integer
+                        pathCostCur[z] = std::floor(float(volSim[offset + z]) + minCost - bestCostPrev);
+                    }
+
+                    // aggregate into the final output
+                    for(int z = 0; z < volDimZ; ++z)
+                    {
+                        const float pathCost = std::min(255.0f, std::max(0.0f, pathCostCur[z]));
+                        const float val = (float(volAgr[offset + z]) * float(filteringIndex) + pathCost) / float(filteringIndex + 1);
+                        volAgr[offset + z] = static_cast<unsigned char>(val);
+                    }
+
+                    std::swap(pathCostPrev, pathCostCur);
+                }
+            }
+        }
+
+        ++filteringIndex;
+    };
+
+    for(char axis : _sgmParams.filteringAxes)
+    {
+        const bool alongY = (axis == 'Y');
+        aggregatePath(alongY, false);
+        aggregatePath(alongY, true);
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Optimizing volume done.");
+}
+
+void SgmCpu::retrieveBestDepth(const Tile& tile, const SgmDepthList& tileDepthList)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Retrieve best depth in volume.");
+
+    const int scaleStep = _sgmParams.scale * _sgmParams.stepXY;
+    const ROI downscaledRoi = downscaleROI(tile.roi, scaleStep);
+    const std::vector<float>& depths = tileDepthList.getDepths();
+    const float thicknessMultFactor = 1.f + float(_sgmParams.depthThicknessInflate);
+    const float maxSimilarity = float(_sgmParams.maxSimilarity) * 254.f; // convert from (0, 1) to (0, 254)
+
+    // R camera parameters at scale 1
+    HostCameraParams rcCam;
+    fillHostCameraParams(rcCam, tile.rc, 1, _mp);
+
+    _depthMap.resize(_volDimX, _volDimY, true, -1.f);
+    _thicknessMap.resize(_volDimX, _volDimY, true, -1.f);
+    if(_computeDepthSimMap)
+        _simMap.resize(_volDimX, _volDimY, true, 1.f);
+
+    #pragma omp parallel for
+    for(int vy = 0; vy < _volDimY; ++vy)
+    {
+        for(int vx = 0; vx < _volDimX; ++vx)
+        {
+            const float x = float((downscaledRoi.x.begin + vx) * scaleStep);
+            const float y = float((downscaledRoi.y.begin + vy) * scaleStep);
+            const unsigned char* volSim = &_volumeBestSim[(std::size_t(vy) * _volDimX + vx) * _volDimZ];
+
+            // find the best depth plane index for the current pixel
+            // - best possible similarity value is 0
+            // - worst possible similarity value is 254
+            // - invalid similarity value is 255
+            float bestSim = 255.f;
+            int bestZIdx = -1;
+
+            for(int vz = 0; vz < _volDimZ; ++vz)
+            {
+                if(volSim[vz] < bestSim)
+                {
+                    bestSim = volSim[vz];
+                    bestZIdx = vz;
+                }
+            }
+
+            // filtering out invalid values and values with a too bad score (above the user maximum similarity threshold)
+            if((bestZIdx == -1) || (bestSim > maxSimilarity))
+                continue; // maps are initialized as invalid
+
+            const int bestZIdx_m1 = std::max(0, bestZIdx - 1);
+            const int bestZIdx_p1 = std::min(_volDimZ - 1, bestZIdx + 1);
+
+            const float bestDepth    = depthPlaneToDepth(rcCam, depths[bestZIdx], x, y);
+            const float bestDepth_m1 = depthPlaneToDepth(rcCam, depths[bestZIdx_m1], x, y);
+            const float bestDepth_p1 = depthPlaneToDepth(rcCam, depths[bestZIdx_p1], x, y);
+
+            // thickness is the maximum distance between output best depth and previous or next depth
+            _depthMap(vy, vx) = bestDepth;
+            _thicknessMap(vy, vx) = std::max(bestDepth_p1 - bestDepth, bestDepth - bestDepth_m1) * thicknessMultFactor;
+
+            if(_computeDepthSimMap)
+                _simMap(vy, vx) = (bestSim / 255.0f) * 2.0f - 1.0f; // convert from (0, 255) to (-1, +1)
+        }
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM (CPU) Retrieve best depth in volume done.");
+}
+
+} // namespace depthMap
+} // namespace aliceVision
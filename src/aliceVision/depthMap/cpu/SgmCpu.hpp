@@ -0,0 +1,118 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/SgmDepthList.hpp>
+#include <aliceVision/depthMap/Tile.hpp>
+#include <aliceVision/depthMap/cpu/HostLabImage.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class Depth map estimation Semi-Global Matching on CPU
+ * @brief Manages the calculation of the Semi-Global Matching step on CPU.
+ * @note CPU counterpart of Sgm, the similarity volumes are stored with the depth as the fastest axis.
+ */
+class SgmCpu
+{
+public:
+
+    /**
+     * @brief SgmCpu constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] tileParams tile workflow parameters
+     * @param[in] sgmParams the Semi Global Matching parameters
+     * @param[in] computeDepthSimMap Enable final depth/sim map computation
+     */
+    SgmCpu(const mvsUtils::MultiViewParams& mp,
+           const mvsUtils::TileParams& tileParams,
+           const SgmParams& sgmParams,
+           bool computeDepthSimMap);
+
+    // final depth map getter
+    inline const image::Image<float>& getDepthMap() const { return _depthMap; }
+
+    // final thickness map getter
+    inline const image::Image<float>& getThicknessMap() const { return _thicknessMap; }
+
+    // final similarity map getter (optional: could be empty)
+    inline const image::Image<float>& getSimMap() const { return _simMap; }
+
+    /**
+     * @brief Compute for a single R camera the Semi-Global Matching.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     * @param[in,out] imageCache the CIELAB images cache
+     */
+    void sgmRc(const Tile& tile, const SgmDepthList& tileDepthList, HostLabImageCache& imageCache);
+
+    /**
+     * @brief Smooth SGM result thickness map
+     * @note Important to be a proper Refine input parameter.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] refineParams the Refine parameters
+     */
+    void smoothThicknessMap(const Tile& tile, const RefineParams& refineParams);
+
+private:
+
+    // private methods
+
+    /**
+     * @brief Compute for each RcTc the best / second best similarity volumes.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     * @param[in,out] imageCache the CIELAB images cache
+     */
+    void computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList, HostLabImageCache& imageCache);
+
+    /**
+     * @brief Optimize the second best similarity volume into the best similarity volume.
+     * @note  Aggregate the path costs along the filtering axes, both directions.
+     *        Each path line is independent and processed by a single thread.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     * @param[in] rcImage the R camera CIELAB image at SGM scale
+     */
+    void optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDepthList, const HostLabImage& rcImage);
+
+    /**
+     * @brief Retrieve the best depths in the best similarity volume.
+     * @note  For each pixel, choose the voxel with the minimal similarity value.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     */
+    void retrieveBestDepth(const Tile& tile, const SgmDepthList& tileDepthList);
+
+    // private members
+
+    const mvsUtils::MultiViewParams& _mp;       //< Multi-view parameters
+    const mvsUtils::TileParams& _tileParams;    //< tile workflow parameters
+    const SgmParams& _sgmParams;                //< Semi Global Matching parameters
+    const bool _computeDepthSimMap;             //< needs to compute a final depth/sim map
+
+    int _volDimX = 0;                           //< current tile volume width
+    int _volDimY = 0;                           //< current tile volume height
+    int _volDimZ = 0;                           //< current tile volume number of depths
+    std::vector<unsigned char> _volumeBestSim;     //< rc best similarity volume (then optimized similarity volume)
+    std::vector<unsigned char> _volumeSecBestSim;  //< rc second best similarity volume
+    image::Image<float> _depthMap;              //< rc result depth map
+    image::Image<float> _thicknessMap;          //< rc result thickness map
+    image::Image<float> _simMap;                //< rc result similarity map
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,277 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/depthMap/DepthMapParams.hpp>
+#include <aliceVision/depthMap/SgmDepthList.hpp>
+#include <aliceVision/depthMap/cpu/DepthMapEstimatorCpu.hpp>
+#include <aliceVision/depthMap/cpu/HostLabImage.hpp>
+#include <aliceVision/depthMap/cpu/SgmCpu.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthMapCpu
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Synthetic scene: a textured fronto-parallel plane seen by 3 cameras translated along the X axis.
+// The reference is the exact depth of the plane, the R camera is the middle one.
+
+const int imageWidth = 320;
+const int imageHeight = 240;
+const double focal = 300.0;
+const double planeDepth = 5.0;
+const std::vector<double> camerasX = {-1.0, 0.0, 1.0};
+const IndexT rcViewId = 1;
+
+float hashValue(int i, int j, int seed)
+{
+    std::uint32_t h = static_cast<std::uint32_t>(i) * 73856093u ^ static_cast<std::uint32_t>(j) * 19349663u ^ static_cast<std::uint32_t>(seed) * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return static_cast<float>(h & 0xffff) / 65535.f;
+}
+
+/// Bilinear interpolation of random values on a regular grid of the plane
+float valueNoise(double x, double y, double cellSize, int seed)
+{
+    const double gx = x / cellSize;
+    const double gy = y / cellSize;
+    const int i = static_cast<int>(std::floor(gx));
+    const int j = static_cast<int>(std::floor(gy));
+    const float fx = static_cast<float>(gx - i);
+    const float fy = static_cast<float>(gy - j);
+    const float top = hashValue(i, j, seed) * (1.f - fx) + hashValue(i + 1, j, seed) * fx;
+    const float bottom = hashValue(i, j + 1, seed) * (1.f - fx) + hashValue(i + 1, j + 1, seed) * fx;
+    return top * (1.f - fy) + bottom * fy;
+}
+
+image::RGBColor planeColor(double x, double y)
+{
+    image::RGBColor color;
+    for(int c = 0; c < 3; ++c)
+    {
+        const float v = 0.7f * valueNoise(x, y, 0.1, c) + 0.3f * valueNoise(x, y, 0.37, c + 3);
+        color(c) = static_cast<unsigned char>(std::min(255.f, v * 255.f + 0.5f));
+    }
+    return color;
+}
+
+Vec2 project(double cameraX, const Vec3& point)
+{
+    return Vec2(imageWidth * 0.5 + focal * (point.x() - cameraX) / point.z(),
+                imageHeight * 0.5 + focal * point.y() / point.z());
+}
+
+sfmData::SfMData createPlaneScene(const fs::path& folder)
+{
+    sfmData::SfMData sfmData;
+    sfmData.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(imageWidth, imageHeight, focal, focal, 0.0, 0.0));
+
+    for(IndexT viewId = 0; viewId < camerasX.size(); ++viewId)
+    {
+        // render the plane, 2x2 samples per pixel
+        image::Image<image::RGBColor> image(imageWidth, imageHeight);
+        for(int v = 0; v < imageHeight; ++v)
+        {
+            for(int u = 0; u < imageWidth; ++u)
+            {
+                Vec3 sum = Vec3::Zero();
+                for(int s = 0; s < 4; ++s)
+                {
+                    const double su = u - 0.25 + 0.5 * (s % 2);
+                    const double sv = v - 0.25 + 0.5 * (s / 2);
+                    const double x = camerasX[viewId] + (su - imageWidth * 0.5) / focal * planeDepth;
+                    const double y = (sv - imageHeight * 0.5) / focal * planeDepth;
+                    const image::RGBColor c = planeColor(x, y);
+                    sum += Vec3(c.r(), c.g(), c.b());
+                }
+                image(v, u) = image::RGBColor(static_cast<unsigned char>(sum.x() / 4.0 + 0.5),
+                                              static_cast<unsigned char>(sum.y() / 4.0 + 0.5),
+                                              static_cast<unsigned char>(sum.z() / 4.0 + 0.5));
+            }
+        }
+
+        const std::string imagePath = (folder / (std::to_string(viewId) + ".png")).string();
+        image::writeImage(imagePath, image, image::ImageWriteOptions());
+
+        sfmData.getViews().emplace(viewId, std::make_shared<sfmData::View>(imagePath, viewId, 0, viewId, imageWidth, imageHeight));
+        sfmData.getPoses().emplace(viewId, sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(camerasX[viewId], 0.0, 0.0))));
+    }
+
+    // SfM seeds: points on the plane and a few points in front of and behind it to get a depth range
+    std::vector<Vec3> points;
+    for(int j = 0; j < 6; ++j)
+        for(int i = 0; i < 8; ++i)
+            points.emplace_back(-1.4 + 0.4 * i, -1.0 + 0.4 * j, planeDepth);
+    for(int j = 0; j < 3; ++j)
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            points.emplace_back(-0.6 + 0.6 * i, -0.6 + 0.6 * j, 4.0);
+            points.emplace_back(-0.6 + 0.6 * i, -0.6 + 0.6 * j, 6.5);
+        }
+    }
+
+    for(IndexT landmarkId = 0; landmarkId < points.size(); ++landmarkId)
+    {
+        sfmData::Landmark landmark(points[landmarkId], feature::EImageDescriberType::SIFT);
+        for(IndexT viewId = 0; viewId < camerasX.size(); ++viewId)
+            landmark.observations[viewId] = sfmData::Observation(project(camerasX[viewId], points[landmarkId]), landmarkId, 1.0);
+        sfmData.getLandmarks().emplace(landmarkId, landmark);
+    }
+
+    return sfmData;
+}
+
+/**
+ * @brief Compare a depth map of the R camera to the reference plane depth.
+ * @param[in] depthMap the depth map, at the given downscale of the R image
+ * @param[in] downscale the depth map scale * step
+ * @param[out] out_inlierRatio the ratio of valid depths within the tolerance, image borders excluded
+ * @param[out] out_medianError the median relative error of the valid depths, image borders excluded
+ */
+void compareToReference(const image::Image<float>& depthMap, int downscale, double tolerance, double& out_inlierRatio, double& out_medianError)
+{
+    const int border = 16;
+    std::vector<double> errors;
+    int nbPixels = 0;
+    int nbInliers = 0;
+
+    for(int y = 0; y < depthMap.Height(); ++y)
+    {
+        for(int x = 0; x < depthMap.Width(); ++x)
+        {
+            const int u = x * downscale;
+            const int v = y * downscale;
+            if(u < border || v < border || u >= imageWidth - border || v >= imageHeight - border)
+                continue;
+
+            ++nbPixels;
+            const float depth = depthMap(y, x);
+            if(depth <= 0.f)
+                continue;
+
+            const Vec3 ray((u - imageWidth * 0.5) / focal, (v - imageHeight * 0.5) / focal, 1.0);
+            const double referenceDepth = planeDepth * ray.norm();
+            const double error = std::abs(depth - referenceDepth) / referenceDepth;
+            errors.push_back(error);
+            if(error < tolerance)
+                ++nbInliers;
+        }
+    }
+
+    out_inlierRatio = (nbPixels > 0) ? double(nbInliers) / nbPixels : 0.0;
+    out_medianError = 1.0;
+    if(!errors.empty())
+    {
+        std::nth_element(errors.begin(), errors.begin() + errors.size() / 2, errors.end());
+        out_medianError = errors[errors.size() / 2];
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(depthMapCpu_sgm)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMapCpu_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createPlaneScene(folder);
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), "", false);
+    const mvsUtils::TileParams tileParams;
+    const depthMap::SgmParams sgmParams;
+
+    mvsUtils::ImagesCache<image::Image<image::RGBAfColor>> ic(mp, image::EImageColorSpace::LINEAR);
+    depthMap::HostLabImageCache labImageCache(2 * camerasX.size(), ic, mp);
+
+    depthMap::Tile tile;
+    tile.id = 0;
+    tile.nbTiles = 1;
+    tile.rc = mp.getIndexFromViewId(rcViewId);
+    tile.roi = ROI(0, mp.getWidth(tile.rc), 0, mp.getHeight(tile.rc));
+    for(int c = 0; c < mp.getNbCameras(); ++c)
+    {
+        if(c == tile.rc)
+            continue;
+        tile.sgmTCams.push_back(c);
+        tile.refineTCams.push_back(c);
+    }
+
+    depthMap::SgmDepthList sgmDepthList(mp, sgmParams, tile);
+    sgmDepthList.computeListRc();
+    BOOST_REQUIRE(!sgmDepthList.getDepths().empty());
+    sgmDepthList.removeTcWithNoDepth(tile);
+    BOOST_REQUIRE_EQUAL(tile.sgmTCams.size(), 2);
+
+    depthMap::SgmCpu sgm(mp, tileParams, sgmParams, true);
+    sgm.sgmRc(tile, sgmDepthList, labImageCache);
+
+    const int downscale = sgmParams.scale * sgmParams.stepXY;
+    BOOST_CHECK_EQUAL(sgm.getDepthMap().Width(), divideRoundUp(imageWidth, downscale));
+    BOOST_CHECK_EQUAL(sgm.getDepthMap().Height(), divideRoundUp(imageHeight, downscale));
+
+    // SGM depths are discrete, the depth step is about 3% of the plane depth at the SGM scale
+    double inlierRatio, medianError;
+    compareToReference(sgm.getDepthMap(), downscale, 0.05, inlierRatio, medianError);
+    BOOST_TEST_MESSAGE("SGM: " << inlierRatio * 100.0 << "% within 5%, median relative error: " << medianError);
+    BOOST_CHECK_GT(inlierRatio, 0.8);
+    BOOST_CHECK_LT(medianError, 0.03);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(depthMapCpu_sgmRefine)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMapCpu_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createPlaneScene(folder);
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), "", false);
+    const mvsUtils::TileParams tileParams;
+    depthMap::DepthMapParams depthMapParams;
+    const depthMap::SgmParams sgmParams;
+    const depthMap::RefineParams refineParams;
+
+    const int rc = mp.getIndexFromViewId(rcViewId);
+
+    depthMap::DepthMapEstimatorCpu depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
+    depthMapEstimator.compute({rc});
+
+    image::Image<float> depthMap;
+    mvsUtils::readMap(rc, mp, mvsUtils::EFileType::depthMap, depthMap, refineParams.scale, refineParams.stepXY);
+
+    const int downscale = refineParams.scale * refineParams.stepXY;
+    BOOST_CHECK_EQUAL(depthMap.Width(), divideRoundUp(imageWidth, downscale));
+    BOOST_CHECK_EQUAL(depthMap.Height(), divideRoundUp(imageHeight, downscale));
+
+    // Refine depths are continuous
+    double inlierRatio, medianError;
+    compareToReference(depthMap, downscale, 0.02, inlierRatio, medianError);
+    BOOST_TEST_MESSAGE("Refine: " << inlierRatio * 100.0 << "% within 2%, median relative error: " << medianError);
+    BOOST_CHECK_GT(inlierRatio, 0.8);
+    BOOST_CHECK_LT(medianError, 0.01);
+
+    fs::remove_all(folder);
+}
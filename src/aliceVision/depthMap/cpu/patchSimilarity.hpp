@@ -0,0 +1,217 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/depthMap/cpu/HostCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/HostLabImage.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace aliceVision {
+namespace depthMap {
+
+// minimum alpha values of the patch center pixel, image range (0, 255)
+// note: same values as the CUDA implementation
+constexpr float HOST_DEPTHMAP_RC_MIN_ALPHA = 255.f * 0.9f;
+constexpr float HOST_DEPTHMAP_TC_MIN_ALPHA = 255.f * 0.4f;
+
+struct HostPatch
+{
+    Vec3f p; //< 3d point
+    Vec3f n; //< normal
+    Vec3f x; //< x axis
+    Vec3f y; //< y axis
+    float d; //< pixel size
+};
+
+inline float sigmoid(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((xval - sigMid) / sigwidth))));
+}
+
+inline float sigmoid2(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((sigMid - xval) / sigwidth))));
+}
+
+/**
+ * @brief Compute the patch local coordinate system from the epipolar plane.
+ * @note n is initialized as the bisector of the two camera rays, unless a normal is given.
+ */
+inline void computeRotCSEpip(HostPatch& patch, const HostCameraParams& rcCam, const HostCameraParams& tcCam, const Vec3f* normal = nullptr)
+{
+    const Vec3f v1 = (rcCam.C - patch.p).normalized();
+    const Vec3f v2 = (tcCam.C - patch.p).normalized();
+
+    // y has to be ortogonal to the epipolar plane
+    // n has to be on the epipolar plane
+    // x has to be on the epipolar plane
+    patch.y = v1.cross(v2).normalized();
+    patch.n = (normal != nullptr) ? *normal : Vec3f(((v1 + v2) * 0.5f).normalized());
+    patch.x = patch.y.cross(patch.n).normalized();
+}
+
+/**
+ * @class PatchSimilarity
+ * @brief Weighted Normalized Cross-Correlation between the R and T projections of a 3d patch.
+ *
+ * Host counterpart of the CUDA compNCCby3DptsYK function.
+ * The patch is evaluated in two passes:
+ *  - a gather pass that projects the (2*wsh+1)^2 patch points (incrementally, the projection is affine in the patch offsets)
+ *    and samples the R and T images into contiguous arrays,
+ *  - a reduction pass on those arrays (Yoon & Kweon support weights and weighted NCC sums)
+ *    written with Eigen array expressions, vectorized with the widest SIMD instruction set available.
+ *
+ * @note One instance per thread: it owns the sample buffers.
+ */
+class PatchSimilarity
+{
+public:
+
+    /**
+     * @param[in] wsh the half-width of the patch
+     * @param[in] gammaC the color strength (Yoon & Kweon)
+     * @param[in] gammaP the spatial strength (Yoon & Kweon)
+     */
+    PatchSimilarity(int wsh, double gammaC, double gammaP)
+      : _wsh(wsh)
+      , _invGammaC(1.f / float(gammaC))
+    {
+        const int patchWidth = 2 * wsh + 1;
+        const int nbSamples = patchWidth * patchWidth;
+
+        _spatialCost.resize(nbSamples);
+        _rcL.resize(nbSamples);
+        _tcL.resize(nbSamples);
+        _rcDeltaC.resize(nbSamples);
+        _tcDeltaC.resize(nbSamples);
+        _w.resize(nbSamples);
+
+        // spatial distance to the center of the patch is constant per sample
+        // note: the spatial term is applied for both R and T weights
+        const float invGammaP = 1.f / float(gammaP);
+        int i = 0;
+        for(int yp = -wsh; yp <= wsh; ++yp)
+            for(int xp = -wsh; xp <= wsh; ++xp)
+                _spatialCost(i++) = 2.f * std::sqrt(float(xp * xp + yp * yp)) * invGammaP;
+    }
+
+    /**
+     * @brief Compute the patch similarity.
+     * @tparam TInvertAndFilter invert and filter output similarity value
+     * @return similarity value in range (-1, 0) (or (0, 1) if inverted and filtered), infinity if invalid
+     */
+    template<bool TInvertAndFilter>
+    float compute(const HostCameraParams& rcCam,
+                  const HostCameraParams& tcCam,
+                  const HostLabImage& rcImage,
+                  const HostLabImage& tcImage,
+                  const HostPatch& patch)
+    {
+        constexpr float invalid = std::numeric_limits<float>::infinity();
+
+        // get R and T image 2d coordinates from patch center 3d point
+        const Vec2f rp = project3DPoint(rcCam, patch.p);
+        const Vec2f tp = project3DPoint(tcCam, patch.p);
+
+        // image 2d coordinates margin
+        const float dd = _wsh + 2.0f;
+
+        // check R and T image 2d coordinates
+        if((rp.x() < dd) || (rp.x() > float(rcImage.width()  - 1) - dd) ||
+           (tp.x() < dd) || (tp.x() > float(tcImage.width()  - 1) - dd) ||
+           (rp.y() < dd) || (rp.y() > float(rcImage.height() - 1) - dd) ||
+           (tp.y() < dd) || (tp.y() > float(tcImage.height() - 1) - dd))
+        {
+            return invalid; // uninitialized
+        }
+
+        // compute patch center color (CIELAB)
+        const image::RGBAfColor rcCenterColor = rcImage.sample(rp.x(), rp.y());
+        const image::RGBAfColor tcCenterColor = tcImage.sample(tp.x(), tp.y());
+
+        // check the alpha values of the patch pixel center of the R and T cameras
+        if(rcCenterColor.a() < HOST_DEPTHMAP_RC_MIN_ALPHA || tcCenterColor.a() < HOST_DEPTHMAP_TC_MIN_ALPHA)
+            return invalid; // masked
+
+        // homogeneous projections of the patch points are affine in the patch offsets
+        const Vec3f rcH0 = rcCam.P.leftCols<3>() * patch.p + rcCam.P.col(3);
+        const Vec3f tcH0 = tcCam.P.leftCols<3>() * patch.p + tcCam.P.col(3);
+        const Vec3f rcHx = rcCam.P.leftCols<3>() * (patch.x * patch.d);
+        const Vec3f rcHy = rcCam.P.leftCols<3>() * (patch.y * patch.d);
+        const Vec3f tcHx = tcCam.P.leftCols<3>() * (patch.x * patch.d);
+        const Vec3f tcHy = tcCam.P.leftCols<3>() * (patch.y * patch.d);
+
+        // gather pass
+        int i = 0;
+        for(int yp = -_wsh; yp <= _wsh; ++yp)
+        {
+            const Vec3f rcHRow = rcH0 + rcHy * float(yp);
+            const Vec3f tcHRow = tcH0 + tcHy * float(yp);
+
+            for(int xp = -_wsh; xp <= _wsh; ++xp, ++i)
+            {
+                const Vec3f rcH = rcHRow + rcHx * float(xp);
+                const Vec3f tcH = tcHRow + tcHx * float(xp);
+
+                const float rcInvZ = 1.f / rcH.z();
+                const float tcInvZ = 1.f / tcH.z();
+
+                const image::RGBAfColor rcColor = rcImage.sample(rcH.x() * rcInvZ, rcH.y() * rcInvZ);
+                const image::RGBAfColor tcColor = tcImage.sample(tcH.x() * tcInvZ, tcH.y() * tcInvZ);
+
+                _rcL(i) = rcColor.r();
+                _tcL(i) = tcColor.r();
+                _rcDeltaC(i) = (rcColor.head<3>() - rcCenterColor.head<3>()).norm();
+                _tcDeltaC(i) = (tcColor.head<3>() - tcCenterColor.head<3>()).norm();
+            }
+        }
+
+        // reduction pass
+        // weight is the product of the R and T Yoon & Kweon support weights
+        _w = (-((_rcDeltaC + _tcDeltaC) * _invGammaC + _spatialCost)).exp();
+
+        const float wsum  = _w.sum();
+        const float xsum  = (_w * _rcL).sum();
+        const float ysum  = (_w * _tcL).sum();
+        const float xxsum = (_w * _rcL * _rcL).sum();
+        const float yysum = (_w * _tcL * _tcL).sum();
+        const float xysum = (_w * _rcL * _tcL).sum();
+
+        // weighted NCC
+        const float varianceX  = (xxsum - xsum * xsum / wsum) / wsum;
+        const float varianceY  = (yysum - ysum * ysum / wsum) / wsum;
+        const float varianceXY = (xysum - xsum * ysum / wsum) / wsum;
+
+        const float rawSim = varianceXY / std::sqrt(varianceX * varianceY);
+        const float fsim = std::isfinite(rawSim) ? -rawSim : 1.0f;
+
+        if(TInvertAndFilter)
+        {
+            // invert and filter similarity
+            // best similarity value was -1, worst was 0
+            // best similarity value is 1, worst is still 0
+            return sigmoid(0.0f, 1.0f, 0.7f, -0.7f, fsim);
+        }
+
+        return fsim;
+    }
+
+private:
+    const int _wsh;
+    const float _invGammaC;
+    Eigen::ArrayXf _spatialCost;
+    Eigen::ArrayXf _rcL;
+    Eigen::ArrayXf _tcL;
+    Eigen::ArrayXf _rcDeltaC;
+    Eigen::ArrayXf _tcDeltaC;
+    Eigen::ArrayXf _w;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -20,6 +20,8 @@
 namespace aliceVision {
 namespace depthMap {
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+
 void copyFloat2Map(image::Image<float>& out_mapX, image::Image<float>& out_mapY, const CudaHostMemoryHeap<float2, 2>& in_map_hmh, const ROI& roi, int downscale)
 {
     const ROI downscaledROI = downscaleROI(roi, downscale);
@@ -292,6 +294,8 @@ void resetDepthSimMap(CudaHostMemoryHeap<float2, 2>& inout_depthSimMap_hmh, floa
   }
 }
 
+#endif // ALICEVISION_HAVE_CUDA
+
 void mergeNormalMapTiles(int rc,
                          const mvsUtils::MultiViewParams& mp,
                          int scale,
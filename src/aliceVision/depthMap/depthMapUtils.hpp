@@ -6,12 +6,15 @@
 
 #pragma once
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/image/Image.hpp>
 #include <aliceVision/mvsData/ROI.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsUtils/TileParams.hpp>
 #include <aliceVision/depthMap/Tile.hpp>
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
 #include <aliceVision/depthMap/cuda/host/memory.hpp>
+#endif
 
 #include <vector>
 #include <string>
@@ -19,6 +22,8 @@
 namespace aliceVision {
 namespace depthMap {
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+
 /**
  * @brief Copy an image from device memory to host memory and write on disk.
  * @note  This function can be useful for code analysis and debugging. 
@@ -155,6 +160,8 @@ void writeDepthSimMapFromTileList(int rc,
  */
 void resetDepthSimMap(CudaHostMemoryHeap<float2, 2>& inout_depthSimMap_hmh, float depth = -1.f, float sim = 1.f);
 
+#endif // ALICEVISION_HAVE_CUDA
+
 /**
  * @brief Merge normal map tiles on disk.
  * @param[in] rc the related R camera index
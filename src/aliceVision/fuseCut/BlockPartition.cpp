@@ -0,0 +1,724 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "BlockPartition.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <geogram/points/kd_tree.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+struct BorderHalfEdge
+{
+    int from;
+    int to;
+    int tri;
+};
+
+/**
+ * @brief Get the border half-edges of the mesh: oriented edges of a triangle without neighbor triangle.
+ */
+void getBorderHalfEdges(const mesh::Mesh& mesh, std::vector<BorderHalfEdge>& out_halfEdges)
+{
+    // (min vertex, max vertex, start vertex of the oriented edge, triangle)
+    std::vector<std::array<int, 4>> edges;
+    edges.reserve(mesh.tris.size() * 3);
+
+    for(int t = 0; t < mesh.tris.size(); ++t)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = mesh.tris[t].v[k];
+            const int b = mesh.tris[t].v[(k + 1) % 3];
+            edges.push_back({std::min(a, b), std::max(a, b), a, t});
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    out_halfEdges.clear();
+
+    for(std::size_t i = 0; i < edges.size();)
+    {
+        std::size_t j = i + 1;
+        while(j < edges.size() && edges[j][0] == edges[i][0] && edges[j][1] == edges[i][1])
+            ++j;
+
+        if(j - i == 1)
+        {
+            const int a = edges[i][2];
+            const int b = (a == edges[i][0]) ? edges[i][1] : edges[i][0];
+            out_halfEdges.push_back({a, b, edges[i][3]});
+        }
+        i = j;
+    }
+}
+
+/**
+ * @brief Triangulate a hole by clipping the ear with the shortest diagonal first.
+ * @note Thin holes along a seam are zipped from one end to the other.
+ */
+void triangulateHole(const mesh::Mesh& mesh, std::vector<int> loop, StaticVector<mesh::Mesh::triangle>& out_tris)
+{
+    while(loop.size() > 3)
+    {
+        const int n = static_cast<int>(loop.size());
+        int bestEar = 0;
+        double bestDiagonal = std::numeric_limits<double>::max();
+
+        for(int i = 0; i < n; ++i)
+        {
+            const double diagonal = (mesh.pts[loop[(i + n - 1) % n]] - mesh.pts[loop[(i + 1) % n]]).size2();
+            if(diagonal < bestDiagonal)
+            {
+                bestDiagonal = diagonal;
+                bestEar = i;
+            }
+        }
+
+        out_tris.push_back(mesh::Mesh::triangle(loop[(bestEar + n - 1) % n], loop[bestEar], loop[(bestEar + 1) % n]));
+        loop.erase(loop.begin() + bestEar);
+    }
+
+    if(loop.size() == 3)
+        out_tris.push_back(mesh::Mesh::triangle(loop[0], loop[1], loop[2]));
+}
+
+} // namespace
+
+BlockPartition::BlockPartition(const Point3d space[8], double overlapRatio)
+  : _overlapRatio(overlapRatio)
+{
+    initSpace(space);
+    _blocks.push_back({Point3d(0.0, 0.0, 0.0), Point3d(1.0, 1.0, 1.0), 0});
+}
+
+void BlockPartition::initSpace(const Point3d space[8])
+{
+    std::copy(space, space + 8, _space.begin());
+
+    const Point3d vx = _space[1] - _space[0];
+    const Point3d vy = _space[3] - _space[0];
+    const Point3d vz = _space[4] - _space[0];
+
+    // space axes as columns
+    Matrix3x3 normalizedToSpace;
+    normalizedToSpace.m11 = vx.x;
+    normalizedToSpace.m21 = vx.y;
+    normalizedToSpace.m31 = vx.z;
+    normalizedToSpace.m12 = vy.x;
+    normalizedToSpace.m22 = vy.y;
+    normalizedToSpace.m32 = vy.z;
+    normalizedToSpace.m13 = vz.x;
+    normalizedToSpace.m23 = vz.y;
+    normalizedToSpace.m33 = vz.z;
+
+    if(normalizedToSpace.isSingular())
+        throw std::runtime_error("BlockPartition: the space hexahedron is degenerated.");
+
+    _spaceToNormalized = normalizedToSpace.inverse();
+    _spaceSize = Point3d(vx.size(), vy.size(), vz.size());
+}
+
+void BlockPartition::compute(const std::vector<Point3d>& points, std::size_t maxPointsPerBlock)
+{
+    // minimal block size relative to the space, to stop on very dense clusters
+    const double minBlockSize = 1e-4;
+
+    std::vector<Point3d> normalizedPoints;
+    normalizedPoints.reserve(points.size());
+
+    for(const Point3d& p : points)
+    {
+        const Point3d np = getNormalizedCoords(p);
+        if(np.x >= 0.0 && np.x <= 1.0 && np.y >= 0.0 && np.y <= 1.0 && np.z >= 0.0 && np.z <= 1.0)
+            normalizedPoints.push_back(np);
+    }
+
+    struct Node
+    {
+        Block block;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    _blocks.clear();
+
+    std::vector<Node> toDivide;
+    toDivide.push_back({{Point3d(0.0, 0.0, 0.0), Point3d(1.0, 1.0, 1.0), normalizedPoints.size()}, 0, normalizedPoints.size()});
+
+    while(!toDivide.empty())
+    {
+        const Node node = toDivide.back();
+        toDivide.pop_back();
+
+        // split along the longest axis in space units
+        int axis = 0;
+        double axisLength = 0.0;
+        for(int a = 0; a < 3; ++a)
+        {
+            const double length = (node.block.max.m[a] - node.block.min.m[a]) * _spaceSize.m[a];
+            if(length > axisLength)
+            {
+                axisLength = length;
+                axis = a;
+            }
+        }
+
+        const double blockSize = node.block.max.m[axis] - node.block.min.m[axis];
+
+        if(node.end - node.begin <= maxPointsPerBlock || blockSize < 2.0 * minBlockSize)
+        {
+            _blocks.push_back(node.block);
+            continue;
+        }
+
+        // split at the points median, not too close to the block limits
+        const auto begin = normalizedPoints.begin() + node.begin;
+        const auto end = normalizedPoints.begin() + node.end;
+        const auto median = begin + (end - begin) / 2;
+        std::nth_element(begin, median, end, [axis](const Point3d& a, const Point3d& b) { return a.m[axis] < b.m[axis]; });
+
+        const double split = std::min(std::max(median->m[axis], node.block.min.m[axis] + minBlockSize), node.block.max.m[axis] - minBlockSize);
+        const auto middle = std::partition(begin, end, [axis, split](const Point3d& p) { return p.m[axis] < split; });
+
+        Node lower = node;
+        lower.block.max.m[axis] = split;
+        lower.end = node.begin + (middle - begin);
+        lower.block.nbPoints = lower.end - lower.begin;
+
+        Node upper = node;
+        upper.block.min.m[axis] = split;
+        upper.begin = lower.end;
+        upper.block.nbPoints = upper.end - upper.begin;
+
+        // lower block first
+        toDivide.push_back(upper);
+        toDivide.push_back(lower);
+    }
+
+    ALICEVISION_LOG_INFO("Space partitioned in " << _blocks.size() << " blocks (" << normalizedPoints.size() << " sampled points, max " << maxPointsPerBlock << " per block).");
+}
+
+double BlockPartition::getBlockPointsRatio(std::size_t i) const
+{
+    std::size_t nbPoints = 0;
+    for(const Block& block : _blocks)
+        nbPoints += block.nbPoints;
+
+    return (nbPoints == 0) ? 1.0 : static_cast<double>(_blocks.at(i).nbPoints) / static_cast<double>(nbPoints);
+}
+
+Point3d BlockPartition::getNormalizedCoords(const Point3d& p) const
+{
+    return _spaceToNormalized * (p - _space[0]);
+}
+
+void BlockPartition::getHexah(const Point3d& min, const Point3d& max, Point3d out_hexah[8]) const
+{
+    const Point3d vx = _space[1] - _space[0];
+    const Point3d vy = _space[3] - _space[0];
+    const Point3d vz = _space[4] - _space[0];
+
+    const auto toSpace = [&](double x, double y, double z) { return _space[0] + vx * x + vy * y + vz * z; };
+
+    out_hexah[0] = toSpace(min.x, min.y, min.z);
+    out_hexah[1] = toSpace(max.x, min.y, min.z);
+    out_hexah[2] = toSpace(max.x, max.y, min.z);
+    out_hexah[3] = toSpace(min.x, max.y, min.z);
+    out_hexah[4] = toSpace(min.x, min.y, max.z);
+    out_hexah[5] = toSpace(max.x, min.y, max.z);
+    out_hexah[6] = toSpace(max.x, max.y, max.z);
+    out_hexah[7] = toSpace(min.x, max.y, max.z);
+}
+
+void BlockPartition::getBlockHexah(std::size_t i, Point3d out_hexah[8]) const
+{
+    const Block& block = _blocks.at(i);
+    getHexah(block.min, block.max, out_hexah);
+}
+
+void BlockPartition::getBlockOverlapHexah(std::size_t i, Point3d out_hexah[8]) const
+{
+    const Block& block = _blocks.at(i);
+    Point3d min, max;
+
+    for(int a = 0; a < 3; ++a)
+    {
+        const double overlap = (block.max.m[a] - block.min.m[a]) * _overlapRatio;
+        min.m[a] = std::max(0.0, block.min.m[a] - overlap);
+        max.m[a] = std::min(1.0, block.max.m[a] + overlap);
+    }
+
+    getHexah(min, max, out_hexah);
+}
+
+bool BlockPartition::isInBlock(std::size_t i, const Point3d& p) const
+{
+    const Block& block = _blocks.at(i);
+    const Point3d np = getNormalizedCoords(p);
+
+    // no limit on the space borders, to keep the points slightly outside of the space
+    for(int a = 0; a < 3; ++a)
+    {
+        if(block.min.m[a] > 0.0 && np.m[a] < block.min.m[a])
+            return false;
+        if(block.max.m[a] < 1.0 && np.m[a] >= block.max.m[a])
+            return false;
+    }
+    return true;
+}
+
+double BlockPartition::getSeamDistance(std::size_t i, const Point3d& p) const
+{
+    const Block& block = _blocks.at(i);
+    const Point3d np = getNormalizedCoords(p);
+
+    double distance = std::numeric_limits<double>::max();
+
+    for(int a = 0; a < 3; ++a)
+    {
+        if(block.min.m[a] > 0.0)
+            distance = std::min(distance, std::abs(np.m[a] - block.min.m[a]) * _spaceSize.m[a]);
+        if(block.max.m[a] < 1.0)
+            distance = std::min(distance, std::abs(block.max.m[a] - np.m[a]) * _spaceSize.m[a]);
+    }
+    return distance;
+}
+
+void BlockPartition::clipBlockMesh(std::size_t i, mesh::Mesh& inout_mesh, StaticVector<StaticVector<int>>& inout_ptsCams) const
+{
+    StaticVectorBool trisToStay;
+    trisToStay.resize(inout_mesh.tris.size());
+
+#pragma omp parallel for
+    for(int t = 0; t < inout_mesh.tris.size(); ++t)
+    {
+        const mesh::Mesh::triangle& tri = inout_mesh.tris[t];
+        trisToStay[t] = isInBlock(i, inout_mesh.pts[tri.v[0]]) && isInBlock(i, inout_mesh.pts[tri.v[1]]) && isInBlock(i, inout_mesh.pts[tri.v[2]]);
+    }
+
+    inout_mesh.letJustTringlesIdsInMesh(trisToStay);
+
+    StaticVector<int> ptIdToNewPtId;
+    inout_mesh.removeFreePointsFromMesh(ptIdToNewPtId);
+
+    StaticVector<StaticVector<int>> ptsCams;
+    ptsCams.resize(inout_mesh.pts.size());
+
+    for(int p = 0; p < ptIdToNewPtId.size(); ++p)
+    {
+        const int newId = ptIdToNewPtId[p];
+        if(newId > -1 && p < inout_ptsCams.size())
+            ptsCams[newId] = std::move(inout_ptsCams[p]);
+    }
+    inout_ptsCams.swap(ptsCams);
+}
+
+void BlockPartition::stitchSeams(mesh::Mesh& inout_mesh, StaticVector<StaticVector<int>>& inout_ptsCams, const std::vector<int>& ptsBlockIds,
+                                 double weldFactor) const
+{
+    const int nbPts = inout_mesh.pts.size();
+
+    // border vertices close to a seam
+    std::vector<double> localEdgeLength(nbPts, 0.0);
+    std::vector<bool> isSeamPt(nbPts, false);
+    {
+        std::vector<BorderHalfEdge> borderHalfEdges;
+        getBorderHalfEdges(inout_mesh, borderHalfEdges);
+
+        for(const BorderHalfEdge& edge : borderHalfEdges)
+        {
+            const double length = (inout_mesh.pts[edge.from] - inout_mesh.pts[edge.to]).size();
+            localEdgeLength[edge.from] = std::max(localEdgeLength[edge.from], length);
+            localEdgeLength[edge.to] = std::max(localEdgeLength[edge.to], length);
+        }
+
+#pragma omp parallel for
+        for(int p = 0; p < nbPts; ++p)
+        {
+            if(localEdgeLength[p] > 0.0)
+                isSeamPt[p] = getSeamDistance(ptsBlockIds[p], inout_mesh.pts[p]) <= weldFactor * localEdgeLength[p];
+        }
+    }
+
+    std::vector<int> seamPts;
+    for(int p = 0; p < nbPts; ++p)
+    {
+        if(isSeamPt[p])
+            seamPts.push_back(p);
+    }
+
+    // weld seam vertices of different blocks, closest pairs first
+    std::vector<int> parents(nbPts);
+    std::iota(parents.begin(), parents.end(), 0);
+
+    const auto findRoot = [&parents](int p) {
+        while(parents[p] != p)
+        {
+            parents[p] = parents[parents[p]];
+            p = parents[p];
+        }
+        return p;
+    };
+
+    int nbWelded = 0;
+
+    if(seamPts.size() > 1)
+    {
+        std::vector<Point3d> seamCoords(seamPts.size());
+        for(std::size_t s = 0; s < seamPts.size(); ++s)
+            seamCoords[s] = inout_mesh.pts[seamPts[s]];
+
+        GEO::AdaptiveKdTree seamKdTree(3);
+        seamKdTree.set_points(seamCoords.size(), seamCoords.front().m);
+
+        const int nbNeighbors = std::min(8, static_cast<int>(seamPts.size()));
+
+        // (squared distance, seam index, seam index)
+        std::vector<std::vector<std::tuple<double, int, int>>> threadsCandidates(omp_get_max_threads());
+
+#pragma omp parallel for
+        for(int s = 0; s < static_cast<int>(seamPts.size()); ++s)
+        {
+            std::vector<GEO::index_t> neighborsIds(nbNeighbors);
+            std::vector<double> neighborsSqDist(nbNeighbors);
+            seamKdTree.get_nearest_neighbors(nbNeighbors, seamCoords[s].m, neighborsIds.data(), neighborsSqDist.data());
+
+            const int p = seamPts[s];
+
+            for(int n = 0; n < nbNeighbors; ++n)
+            {
+                const int neighbor = static_cast<int>(neighborsIds[n]);
+                if(neighbor <= s || ptsBlockIds[seamPts[neighbor]] == ptsBlockIds[p])
+                    continue;
+
+                const double weldDistance = weldFactor * std::max(localEdgeLength[p], localEdgeLength[seamPts[neighbor]]);
+                if(neighborsSqDist[n] <= weldDistance * weldDistance)
+                    threadsCandidates[omp_get_thread_num()].emplace_back(neighborsSqDist[n], s, neighbor);
+            }
+        }
+
+        std::vector<std::tuple<double, int, int>> candidates;
+        for(auto& threadCandidates : threadsCandidates)
+            candidates.insert(candidates.end(), threadCandidates.begin(), threadCandidates.end());
+        std::sort(candidates.begin(), candidates.end());
+
+        // blocks of the vertices merged in each root, to never merge two vertices of the same block
+        std::unordered_map<int, std::vector<int>> rootsBlocks;
+        for(int p : seamPts)
+            rootsBlocks[p] = {ptsBlockIds[p]};
+
+        for(const auto& candidate : candidates)
+        {
+            const int rootA = findRoot(seamPts[std::get<1>(candidate)]);
+            const int rootB = findRoot(seamPts[std::get<2>(candidate)]);
+            if(rootA == rootB)
+                continue;
+
+            std::vector<int>& blocksA = rootsBlocks[rootA];
+            std::vector<int>& blocksB = rootsBlocks[rootB];
+
+            const bool sharedBlock = std::any_of(blocksA.begin(), blocksA.end(), [&blocksB](int b) {
+                return std::find(blocksB.begin(), blocksB.end(), b) != blocksB.end();
+            });
+            if(sharedBlock)
+                continue;
+
+            const int root = std::min(rootA, rootB);
+            const int child = std::max(rootA, rootB);
+            parents[child] = root;
+
+            std::vector<int>& rootBlocks = rootsBlocks[root];
+            const std::vector<int>& childBlocks = rootsBlocks[child];
+            rootBlocks.insert(rootBlocks.end(), childBlocks.begin(), childBlocks.end());
+            rootsBlocks.erase(child);
+            ++nbWelded;
+        }
+    }
+
+    // merge welded vertices at their mean position with all their visibilities
+    std::vector<int> trisBlockIds;
+    {
+        std::vector<int> ptIdToNewPtId(nbPts, -1);
+        StaticVector<Point3d> pts;
+        StaticVector<StaticVector<int>> ptsCams;
+        std::vector<int> nbMergedPts;
+        std::vector<bool> isNewSeamPt;
+
+        for(int p = 0; p < nbPts; ++p)
+        {
+            const int root = findRoot(p);
+            if(root == p)
+            {
+                ptIdToNewPtId[p] = pts.size();
+                pts.push_back(inout_mesh.pts[p]);
+                ptsCams.push_back(p < inout_ptsCams.size() ? inout_ptsCams[p] : StaticVector<int>());
+                nbMergedPts.push_back(1);
+                isNewSeamPt.push_back(isSeamPt[p]);
+                continue;
+            }
+
+            const int newId = ptIdToNewPtId[root];
+            ptIdToNewPtId[p] = newId;
+            pts[newId] += inout_mesh.pts[p];
+            ++nbMergedPts[newId];
+
+            if(p < inout_ptsCams.size())
+            {
+                for(int cam : inout_ptsCams[p])
+                    ptsCams[newId].push_back_distinct(cam);
+            }
+        }
+
+        for(int p = 0; p < pts.size(); ++p)
+            pts[p] /= static_cast<double>(nbMergedPts[p]);
+
+        // remap triangles, remove degenerated and duplicated ones
+        StaticVector<mesh::Mesh::triangle> tris;
+        tris.reserve(inout_mesh.tris.size());
+        trisBlockIds.reserve(inout_mesh.tris.size());
+
+        std::vector<std::array<int, 3>> trisKeys;
+        trisKeys.reserve(inout_mesh.tris.size());
+
+        for(int t = 0; t < inout_mesh.tris.size(); ++t)
+        {
+            mesh::Mesh::triangle tri = inout_mesh.tris[t];
+            for(int k = 0; k < 3; ++k)
+                tri.v[k] = ptIdToNewPtId[tri.v[k]];
+
+            if(tri.v[0] == tri.v[1] || tri.v[1] == tri.v[2] || tri.v[0] == tri.v[2])
+                continue;
+
+            std::array<int, 3> key = {tri.v[0], tri.v[1], tri.v[2]};
+            std::sort(key.begin(), key.end());
+            trisKeys.push_back(key);
+            tris.push_back(tri);
+            trisBlockIds.push_back(ptsBlockIds[inout_mesh.tris[t].v[0]]);
+        }
+
+        std::vector<int> trisOrder(tris.size());
+        std::iota(trisOrder.begin(), trisOrder.end(), 0);
+        std::sort(trisOrder.begin(), trisOrder.end(), [&trisKeys](int a, int b) { return trisKeys[a] < trisKeys[b] || (trisKeys[a] == trisKeys[b] && a < b); });
+
+        StaticVectorBool trisToStay;
+        trisToStay.resize_with(tris.size(), true);
+        for(std::size_t i = 1; i < trisOrder.size(); ++i)
+        {
+            if(trisKeys[trisOrder[i]] == trisKeys[trisOrder[i - 1]])
+                trisToStay[trisOrder[i]] = false;
+        }
+
+        std::vector<int> keptTrisBlockIds;
+        keptTrisBlockIds.reserve(trisBlockIds.size());
+        for(int t = 0; t < trisToStay.size(); ++t)
+        {
+            if(trisToStay[t])
+                keptTrisBlockIds.push_back(trisBlockIds[t]);
+        }
+        trisBlockIds.swap(keptTrisBlockIds);
+
+        inout_mesh.pts.swap(pts);
+        inout_mesh.tris.swap(tris);
+        inout_mesh.letJustTringlesIdsInMesh(trisToStay);
+        inout_ptsCams.swap(ptsCams);
+        isSeamPt.swap(isNewSeamPt);
+    }
+
+    // close the remaining holes made of seam vertices only
+    int nbFilledHoles = 0;
+    int nbFillingTris = 0;
+    {
+        std::vector<BorderHalfEdge> borderHalfEdges;
+        getBorderHalfEdges(inout_mesh, borderHalfEdges);
+
+        // the hole loop goes along the border half-edges in the opposite direction
+        std::vector<std::vector<int>> ptsHoleEdges(inout_mesh.pts.size());
+        for(int e = 0; e < static_cast<int>(borderHalfEdges.size()); ++e)
+            ptsHoleEdges[borderHalfEdges[e].to].push_back(e);
+
+        std::vector<bool> isUsedEdge(borderHalfEdges.size(), false);
+        std::vector<bool> isInLoop(inout_mesh.pts.size(), false);
+        StaticVector<mesh::Mesh::triangle> fillingTris;
+
+        for(int startEdge = 0; startEdge < static_cast<int>(borderHalfEdges.size()); ++startEdge)
+        {
+            if(isUsedEdge[startEdge])
+                continue;
+
+            const int startPt = borderHalfEdges[startEdge].to;
+            std::vector<int> loop;
+            bool isValid = true;
+            int e = startEdge;
+
+            while(true)
+            {
+                isUsedEdge[e] = true;
+
+                const int p = borderHalfEdges[e].to;
+                if(isInLoop[p])
+                    isValid = false;
+                isInLoop[p] = true;
+                isValid = isValid && isSeamPt[p];
+                loop.push_back(p);
+
+                const int nextPt = borderHalfEdges[e].from;
+                if(nextPt == startPt)
+                    break;
+
+                // on welded vertices, the hole continues on the border of another block
+                const int blockId = trisBlockIds[borderHalfEdges[e].tri];
+                int nextEdge = -1;
+                for(int candidate : ptsHoleEdges[nextPt])
+                {
+                    if(isUsedEdge[candidate])
+                        continue;
+                    if(nextEdge == -1 || (trisBlockIds[borderHalfEdges[nextEdge].tri] == blockId && trisBlockIds[borderHalfEdges[candidate].tri] != blockId))
+                        nextEdge = candidate;
+                }
+
+                if(nextEdge == -1)
+                {
+                    isValid = false;
+                    break;
+                }
+                e = nextEdge;
+            }
+
+            for(int p : loop)
+                isInLoop[p] = false;
+
+            if(!isValid || loop.size() < 3)
+                continue;
+
+            triangulateHole(inout_mesh, loop, fillingTris);
+            ++nbFilledHoles;
+        }
+
+        nbFillingTris = fillingTris.size();
+        inout_mesh.tris.reserveAdd(fillingTris.size());
+        for(int t = 0; t < fillingTris.size(); ++t)
+            inout_mesh.tris.push_back(fillingTris[t]);
+        inout_mesh.invalidateTopology();
+    }
+
+    ALICEVISION_LOG_INFO("Stitch block meshes:" << std::endl
+                         << "\t- seam vertices: " << seamPts.size() << std::endl
+                         << "\t- welded vertices: " << nbWelded << std::endl
+                         << "\t- filled holes: " << nbFilledHoles << " (" << nbFillingTris << " triangles)");
+}
+
+mesh::Mesh* BlockPartition::joinBlockMeshes(const std::vector<std::string>& blocksFolders, StaticVector<StaticVector<int>>& out_ptsCams) const
+{
+    if(blocksFolders.size() != _blocks.size())
+        throw std::invalid_argument("BlockPartition: invalid number of blocks folders.");
+
+    mesh::Mesh* joinedMesh = new mesh::Mesh();
+    std::vector<int> ptsBlockIds;
+    out_ptsCams.clear();
+
+    for(std::size_t i = 0; i < _blocks.size(); ++i)
+    {
+        const std::string meshFilepath = blocksFolders[i] + "mesh.bin";
+        const std::string ptsCamsFilepath = blocksFolders[i] + "meshPtsCamsFromDGC.bin";
+
+        if(!bfs::exists(meshFilepath) || !bfs::exists(ptsCamsFilepath))
+        {
+            delete joinedMesh;
+            throw std::runtime_error("Missing mesh of block " + std::to_string(i) + " in: " + blocksFolders[i]);
+        }
+
+        mesh::Mesh blockMesh;
+        blockMesh.loadFromBin(meshFilepath);
+
+        StaticVector<StaticVector<int>> blockPtsCams;
+        loadArrayOfArraysFromFile<int>(blockPtsCams, ptsCamsFilepath);
+        blockPtsCams.resize(blockMesh.pts.size());
+
+        clipBlockMesh(i, blockMesh, blockPtsCams);
+
+        ALICEVISION_LOG_INFO("Block " << i << ": " << blockMesh.pts.size() << " vertices, " << blockMesh.tris.size() << " triangles.");
+
+        joinedMesh->addMesh(blockMesh);
+        ptsBlockIds.resize(joinedMesh->pts.size(), static_cast<int>(i));
+
+        out_ptsCams.reserveAdd(blockPtsCams.size());
+        for(int p = 0; p < blockPtsCams.size(); ++p)
+            out_ptsCams.push_back(std::move(blockPtsCams[p]));
+    }
+
+    stitchSeams(*joinedMesh, out_ptsCams, ptsBlockIds);
+
+    return joinedMesh;
+}
+
+void BlockPartition::save(const std::string& filepath) const
+{
+    // write in a temporary file first, the partition may be shared by concurrent processes
+    const std::string tmpFilepath = filepath + "." + bfs::unique_path().string();
+    {
+        std::ofstream out(tmpFilepath);
+        if(!out.is_open())
+            throw std::runtime_error("Unable to create the block partition file: " + filepath);
+
+        out << std::setprecision(17);
+
+        for(const Point3d& p : _space)
+            out << p.x << " " << p.y << " " << p.z << "\n";
+
+        out << _overlapRatio << "\n";
+        out << _blocks.size() << "\n";
+
+        for(const Block& block : _blocks)
+            out << block.min.x << " " << block.min.y << " " << block.min.z << " " << block.max.x << " " << block.max.y << " " << block.max.z << " "
+                << block.nbPoints << "\n";
+    }
+    bfs::rename(tmpFilepath, filepath);
+}
+
+void BlockPartition::load(const std::string& filepath)
+{
+    std::ifstream in(filepath);
+    if(!in.is_open())
+        throw std::runtime_error("Unable to read the block partition file: " + filepath);
+
+    Point3d space[8];
+    for(Point3d& p : space)
+        in >> p.x >> p.y >> p.z;
+
+    std::size_t nbBlocks = 0;
+    in >> _overlapRatio >> nbBlocks;
+
+    _blocks.resize(nbBlocks);
+    for(Block& block : _blocks)
+        in >> block.min.x >> block.min.y >> block.min.z >> block.max.x >> block.max.y >> block.max.z >> block.nbPoints;
+
+    if(!in)
+        throw std::runtime_error("Invalid block partition file: " + filepath);
+
+    initSpace(space);
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
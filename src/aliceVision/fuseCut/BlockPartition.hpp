@@ -0,0 +1,141 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @class BlockPartition
+ * @brief Partition of the reconstruction space in blocks meshed independently.
+ *
+ * The blocks are the leaves of a kd-tree splitting the space at the median of the
+ * sampled points, so each block holds a bounded number of points. Each block is
+ * reconstructed in its own overlapping hexahedron, then only the triangles of its
+ * core (non-overlapping) part are kept and the block meshes are stitched along the seams.
+ *
+ * Blocks are stored in the normalized coordinates of the space hexahedron:
+ * (0,0,0) is space[0] and (1,1,1) is space[6].
+ */
+class BlockPartition
+{
+public:
+    struct Block
+    {
+        Point3d min; //< min corner in normalized space coordinates
+        Point3d max; //< max corner in normalized space coordinates
+        std::size_t nbPoints = 0; //< number of sampled points in the block core
+    };
+
+    BlockPartition() = default;
+
+    /**
+     * @param[in] space the reconstruction space hexahedron
+     * @param[in] overlapRatio the block overlap on each side, relative to the block size
+     */
+    BlockPartition(const Point3d space[8], double overlapRatio);
+
+    /**
+     * @brief Split the space until each block contains at most maxPointsPerBlock points.
+     * @param[in] points the points sampled in the space
+     * @param[in] maxPointsPerBlock the maximum number of sampled points per block
+     */
+    void compute(const std::vector<Point3d>& points, std::size_t maxPointsPerBlock);
+
+    const std::array<Point3d, 8>& getSpace() const { return _space; }
+    std::size_t getNbBlocks() const { return _blocks.size(); }
+    const Block& getBlock(std::size_t i) const { return _blocks.at(i); }
+
+    /**
+     * @brief Get the part of the sampled points in the block core.
+     */
+    double getBlockPointsRatio(std::size_t i) const;
+
+    /**
+     * @brief Get the block core hexahedron (blocks cores are a partition of the space).
+     */
+    void getBlockHexah(std::size_t i, Point3d out_hexah[8]) const;
+
+    /**
+     * @brief Get the block hexahedron inflated by the overlap, used for the block reconstruction.
+     */
+    void getBlockOverlapHexah(std::size_t i, Point3d out_hexah[8]) const;
+
+    /**
+     * @brief Get the point coordinates in the normalized space coordinates.
+     */
+    Point3d getNormalizedCoords(const Point3d& p) const;
+
+    /**
+     * @brief Whether the point belongs to the block core.
+     * @note Core limits are half-open, so a point belongs to exactly one block.
+     */
+    bool isInBlock(std::size_t i, const Point3d& p) const;
+
+    /**
+     * @brief Get the distance from the point to the closest face of the block core shared with another block.
+     * @return the distance or std::numeric_limits<double>::max() if the block has no neighbor
+     */
+    double getSeamDistance(std::size_t i, const Point3d& p) const;
+
+    /**
+     * @brief Keep only the triangles of the block mesh with all their vertices in the block core.
+     * @note Neighbor clipped blocks never overlap, the gap between them is closed by stitchSeams.
+     * @param[in] i the block index
+     * @param[in,out] inout_mesh the block mesh
+     * @param[in,out] inout_ptsCams the block mesh points visibilities
+     */
+    void clipBlockMesh(std::size_t i, mesh::Mesh& inout_mesh, StaticVector<StaticVector<int>>& inout_ptsCams) const;
+
+    /**
+     * @brief Stitch the clipped block meshes along the seams.
+     *
+     * Open border vertices close to a seam are welded with the closest border vertex of a neighbor block
+     * (closest pairs first, never two vertices of the same block), then the remaining holes
+     * made of seam vertices only are closed by ear clipping of the shortest diagonals.
+     *
+     * @param[in,out] inout_mesh the concatenation of the clipped block meshes
+     * @param[in,out] inout_ptsCams the mesh points visibilities
+     * @param[in] ptsBlockIds the block index of each mesh point
+     * @param[in] weldFactor the welding distance in local edge length
+     */
+    void stitchSeams(mesh::Mesh& inout_mesh, StaticVector<StaticVector<int>>& inout_ptsCams, const std::vector<int>& ptsBlockIds,
+                     double weldFactor = 1.5) const;
+
+    /**
+     * @brief Load, clip and stitch the block meshes.
+     * @param[in] blocksFolders the folder of each block containing mesh.bin and meshPtsCamsFromDGC.bin
+     * @param[out] out_ptsCams the stitched mesh points visibilities
+     * @return the stitched mesh
+     */
+    mesh::Mesh* joinBlockMeshes(const std::vector<std::string>& blocksFolders, StaticVector<StaticVector<int>>& out_ptsCams) const;
+
+    void save(const std::string& filepath) const;
+    void load(const std::string& filepath);
+
+private:
+    void initSpace(const Point3d space[8]);
+    void getHexah(const Point3d& min, const Point3d& max, Point3d out_hexah[8]) const;
+
+    std::array<Point3d, 8> _space;
+    Matrix3x3 _spaceToNormalized;
+    Point3d _spaceSize; //< length of the space axes
+    double _overlapRatio = 0.0;
+    std::vector<Block> _blocks;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
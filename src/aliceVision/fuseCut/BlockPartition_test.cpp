@@ -0,0 +1,227 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/BlockPartition.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutBlockPartition
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace {
+
+void getUnitCube(Point3d out_space[8])
+{
+    out_space[0] = Point3d(0.0, 0.0, 0.0);
+    out_space[1] = Point3d(1.0, 0.0, 0.0);
+    out_space[2] = Point3d(1.0, 1.0, 0.0);
+    out_space[3] = Point3d(0.0, 1.0, 0.0);
+    out_space[4] = Point3d(0.0, 0.0, 1.0);
+    out_space[5] = Point3d(1.0, 0.0, 1.0);
+    out_space[6] = Point3d(1.0, 1.0, 1.0);
+    out_space[7] = Point3d(0.0, 1.0, 1.0);
+}
+
+/**
+ * @brief Create a regular grid mesh of the plane z=0.5 on [minX, maxX]x[0, 1], all points seen by the given camera.
+ */
+void createPlaneGrid(double minX, double maxX, double step, int cam, mesh::Mesh& out_mesh, StaticVector<StaticVector<int>>& out_ptsCams)
+{
+    const int nx = static_cast<int>(std::round((maxX - minX) / step)) + 1;
+    const int ny = static_cast<int>(std::round(1.0 / step)) + 1;
+
+    for(int y = 0; y < ny; ++y)
+    {
+        for(int x = 0; x < nx; ++x)
+        {
+            out_mesh.pts.push_back(Point3d(minX + x * (maxX - minX) / (nx - 1), y / double(ny - 1), 0.5));
+            StaticVector<int> cams;
+            cams.push_back(cam);
+            out_ptsCams.push_back(cams);
+        }
+    }
+
+    for(int y = 0; y + 1 < ny; ++y)
+    {
+        for(int x = 0; x + 1 < nx; ++x)
+        {
+            const int p = y * nx + x;
+            out_mesh.tris.push_back(mesh::Mesh::triangle(p, p + 1, p + nx + 1));
+            out_mesh.tris.push_back(mesh::Mesh::triangle(p, p + nx + 1, p + nx));
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fuseCut_blockPartition_compute)
+{
+    Point3d space[8];
+    getUnitCube(space);
+
+    // dense cluster and sparse background
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> cluster(0.2, 0.02);
+
+    std::vector<Point3d> points;
+    for(int i = 0; i < 20000; ++i)
+        points.push_back(Point3d(uniform(generator), uniform(generator), uniform(generator)));
+    for(int i = 0; i < 80000; ++i)
+        points.push_back(Point3d(std::clamp(cluster(generator), 0.0, 1.0), std::clamp(cluster(generator), 0.0, 1.0), std::clamp(cluster(generator), 0.0, 1.0)));
+
+    const std::size_t maxPointsPerBlock = 5000;
+
+    BlockPartition partition(space, 0.1);
+    partition.compute(points, maxPointsPerBlock);
+
+    BOOST_CHECK_GT(partition.getNbBlocks(), points.size() / maxPointsPerBlock);
+
+    // each point in exactly one block, blocks within the limit
+    std::vector<std::size_t> blocksNbPoints(partition.getNbBlocks(), 0);
+    for(const Point3d& p : points)
+    {
+        int nbBlocks = 0;
+        for(std::size_t b = 0; b < partition.getNbBlocks(); ++b)
+        {
+            if(partition.isInBlock(b, p))
+            {
+                ++nbBlocks;
+                ++blocksNbPoints[b];
+            }
+        }
+        BOOST_CHECK_EQUAL(nbBlocks, 1);
+    }
+
+    double volume = 0.0;
+    for(std::size_t b = 0; b < partition.getNbBlocks(); ++b)
+    {
+        BOOST_CHECK_LE(blocksNbPoints[b], maxPointsPerBlock);
+        BOOST_CHECK_EQUAL(blocksNbPoints[b], partition.getBlock(b).nbPoints);
+
+        const BlockPartition::Block& block = partition.getBlock(b);
+        volume += (block.max.x - block.min.x) * (block.max.y - block.min.y) * (block.max.z - block.min.z);
+    }
+    BOOST_CHECK_CLOSE(volume, 1.0, 1e-6);
+
+    // the overlap hexahedron contains the block
+    Point3d hexah[8];
+    Point3d overlapHexah[8];
+    for(std::size_t b = 0; b < partition.getNbBlocks(); ++b)
+    {
+        partition.getBlockHexah(b, hexah);
+        partition.getBlockOverlapHexah(b, overlapHexah);
+        for(int k = 0; k < 8; ++k)
+        {
+            const Point3d np = partition.getNormalizedCoords(overlapHexah[k]);
+            BOOST_CHECK(np.x >= -1e-9 && np.x <= 1.0 + 1e-9);
+            BOOST_CHECK(np.y >= -1e-9 && np.y <= 1.0 + 1e-9);
+            BOOST_CHECK(np.z >= -1e-9 && np.z <= 1.0 + 1e-9);
+        }
+        BOOST_CHECK_GE(mvsUtils::computeHexahedronVolume(overlapHexah), mvsUtils::computeHexahedronVolume(hexah));
+    }
+
+    // io
+    partition.save("blockPartition_test.txt");
+    BlockPartition loadedPartition;
+    loadedPartition.load("blockPartition_test.txt");
+
+    BOOST_CHECK_EQUAL(loadedPartition.getNbBlocks(), partition.getNbBlocks());
+    for(std::size_t b = 0; b < partition.getNbBlocks(); ++b)
+    {
+        BOOST_CHECK_EQUAL(loadedPartition.getBlock(b).min, partition.getBlock(b).min);
+        BOOST_CHECK_EQUAL(loadedPartition.getBlock(b).max, partition.getBlock(b).max);
+        BOOST_CHECK_EQUAL(loadedPartition.getBlock(b).nbPoints, partition.getBlock(b).nbPoints);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_blockPartition_stitch)
+{
+    Point3d space[8];
+    getUnitCube(space);
+
+    // split at x=0.5
+    const std::vector<Point3d> points = {Point3d(0.1, 0.5, 0.5), Point3d(0.2, 0.5, 0.5), Point3d(0.5, 0.5, 0.5), Point3d(0.6, 0.5, 0.5)};
+
+    BlockPartition partition(space, 0.2);
+    partition.compute(points, 2);
+    BOOST_REQUIRE_EQUAL(partition.getNbBlocks(), 2);
+    BOOST_REQUIRE_EQUAL(partition.getBlock(0).max.x, 0.5);
+
+    // overlapping block meshes with different resolutions, so the seam vertices do not match
+    mesh::Mesh mesh;
+    StaticVector<StaticVector<int>> ptsCams;
+    std::vector<int> ptsBlockIds;
+
+    const double steps[2] = {0.05, 0.04};
+    const double minX[2] = {0.0, 0.4};
+    const double maxX[2] = {0.6, 1.0};
+
+    for(int b = 0; b < 2; ++b)
+    {
+        mesh::Mesh blockMesh;
+        StaticVector<StaticVector<int>> blockPtsCams;
+        createPlaneGrid(minX[b], maxX[b], steps[b], b, blockMesh, blockPtsCams);
+
+        partition.clipBlockMesh(b, blockMesh, blockPtsCams);
+        BOOST_CHECK_EQUAL(blockPtsCams.size(), blockMesh.pts.size());
+
+        mesh.addMesh(blockMesh);
+        ptsBlockIds.resize(mesh.pts.size(), b);
+        for(int p = 0; p < blockPtsCams.size(); ++p)
+            ptsCams.push_back(blockPtsCams[p]);
+    }
+
+    partition.stitchSeams(mesh, ptsCams, ptsBlockIds);
+
+    BOOST_CHECK_EQUAL(ptsCams.size(), mesh.pts.size());
+
+    // no more open border inside the space and a manifold surface
+    std::map<std::pair<int, int>, int> edges;
+    for(int t = 0; t < mesh.tris.size(); ++t)
+    {
+        const mesh::Mesh::triangle& tri = mesh.tris[t];
+        BOOST_CHECK(tri.v[0] != tri.v[1] && tri.v[1] != tri.v[2] && tri.v[0] != tri.v[2]);
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = tri.v[k];
+            const int b = tri.v[(k + 1) % 3];
+            // consistent orientation: each oriented edge once
+            BOOST_CHECK_EQUAL(++edges[std::make_pair(a, b)], 1);
+        }
+    }
+
+    int nbInnerBorderEdges = 0;
+    for(const auto& edge : edges)
+    {
+        if(edges.count(std::make_pair(edge.first.second, edge.first.first)))
+            continue;
+
+        const Point3d& a = mesh.pts[edge.first.first];
+        const Point3d& b = mesh.pts[edge.first.second];
+        const bool onSpaceBorder = (a.y < 1e-6 && b.y < 1e-6) || (a.y > 1.0 - 1e-6 && b.y > 1.0 - 1e-6) ||
+                                   (a.x < 1e-6 && b.x < 1e-6) || (a.x > 1.0 - 1e-6 && b.x > 1.0 - 1e-6);
+        if(!onSpaceBorder)
+            ++nbInnerBorderEdges;
+    }
+    BOOST_CHECK_EQUAL(nbInnerBorderEdges, 0);
+
+    // welded seam vertices are seen by the cameras of both blocks
+    int nbSharedPts = 0;
+    for(int p = 0; p < ptsCams.size(); ++p)
+    {
+        if(ptsCams[p].size() == 2)
+            ++nbSharedPts;
+    }
+    BOOST_CHECK_GT(nbSharedPts, 0);
+}
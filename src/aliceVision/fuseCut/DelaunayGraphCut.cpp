@@ -10,6 +10,9 @@
 #include "DelaunayGraphCut.hpp"
 // #include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 #include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+#include <aliceVision/fuseCut/MaxFlowAlgorithm.hpp>
+#include <aliceVision/fuseCut/PointsVoxelHash.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
@@ -20,11 +23,13 @@
 #include <aliceVision/mvsUtils/mapIO.hpp>
 #include <aliceVision/image/imageAlgo.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
 
 #include <geogram/points/kd_tree.h>
+#include <geogram/basic/process.h>
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -331,12 +336,16 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
     // std::vector<Point3d> newVerticesCoordsPrepare(verticesCoordsPrepare.size());
     // std::vector<float> newSimScorePrepare(simScorePrepare.size());
     // std::vector<double> newPixSizePrepare(pixSizePrepare.size());
-    std::vector<omp_lock_t> locks(verticesCoordsPrepare.size());
-    for (auto& lock: locks)
-        omp_init_lock(&lock);
+    // Matches of the depth map points with their nearest vertex, found in parallel by blocks of rows and applied
+    // sequentially after each block: no lock per vertex and the result does not depend on the threads scheduling.
+    struct VertexMatch
+    {
+        std::size_t vertexIndex;
+        Point3d point;
+        bool contribute;
+    };
+    const int rowsBlockSize = 64;
 
-    omp_set_nested(1);
-    #pragma omp parallel for num_threads(3)
     for(int c = 0; c < cams.size(); ++c)
     {
         ALICEVISION_LOG_INFO("Create visibilities (" << c << "/" << cams.size() << ")");
@@ -367,72 +376,71 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
             ALICEVISION_LOG_WARNING("Cannot find similarity map file.");
             simMap.resize(width * height, -1);
         }
-        
-        // Add visibility
-        #pragma omp parallel for
-        for (int y = 0; y < depthMap.Height(); ++y)
+
+        std::vector<std::vector<VertexMatch>> rowsMatches(rowsBlockSize);
+
+        for(int yBlock = 0; yBlock < depthMap.Height(); yBlock += rowsBlockSize)
         {
-            for(int x = 0; x < depthMap.Width(); ++x)
+            const int nbRows = std::min(rowsBlockSize, depthMap.Height() - yBlock);
+
+            // Add visibility
+            #pragma omp parallel for
+            for(int r = 0; r < nbRows; ++r)
             {
-                const std::size_t index = y * depthMap.Width() + x;
-                const float depth = depthMap(index);
-                if(depth <= 0.0f)
-                    continue;
+                const int y = yBlock + r;
+                std::vector<VertexMatch>& matches = rowsMatches[r];
+                matches.clear();
+
+                for(int x = 0; x < depthMap.Width(); ++x)
+                {
+                    const std::size_t index = y * depthMap.Width() + x;
+                    const float depth = depthMap(index);
+                    if(depth <= 0.0f)
+                        continue;
 
-                const Point3d p = mp.backproject(c, Point2d(x, y), depth);
-                const double pixSize = mp.getCamPixelSize(p, c);
+                    const Point3d p = mp.backproject(c, Point2d(x, y), depth);
+                    const double pixSize = mp.getCamPixelSize(p, c);
 #ifdef USE_GEOGRAM_KDTREE
-                const std::size_t nearestVertexIndex = kdTree.get_nearest_neighbor(p.m);
-                // NOTE: Could compute the distance between the line (camera to pixel) and the nearestVertex OR
-                //       the distance between the back-projected point and the nearestVertex
-                const double dist = (p - verticesCoordsPrepare[nearestVertexIndex]).size2();
+                    const std::size_t nearestVertexIndex = kdTree.get_nearest_neighbor(p.m);
+                    // NOTE: Could compute the distance between the line (camera to pixel) and the nearestVertex OR
+                    //       the distance between the back-projected point and the nearestVertex
+                    const double dist = (p - verticesCoordsPrepare[nearestVertexIndex]).size2();
 #else
-                nanoflann::KNNResultSet<double, std::size_t> resultSet(1);
-                std::size_t nearestVertexIndex = std::numeric_limits<std::size_t>::max();
-                double dist = std::numeric_limits<double>::max();
-                resultSet.init(&nearestVertexIndex, &dist);
-                if(!kdTree.findNeighbors(resultSet, p.m, nanoflann::SearchParameters()))
-                {
-                    ALICEVISION_LOG_TRACE("Failed to find Neighbors.");
-                    continue;
-                }
+                    nanoflann::KNNResultSet<double, std::size_t> resultSet(1);
+                    std::size_t nearestVertexIndex = std::numeric_limits<std::size_t>::max();
+                    double dist = std::numeric_limits<double>::max();
+                    resultSet.init(&nearestVertexIndex, &dist);
+                    if(!kdTree.findNeighbors(resultSet, p.m, nanoflann::SearchParameters()))
+                    {
+                        ALICEVISION_LOG_TRACE("Failed to find Neighbors.");
+                        continue;
+                    }
 #endif
-                const float pixSizeScoreI = simScorePrepare[nearestVertexIndex] * pixSize * pixSize;
-                const float pixSizeScoreV = simScorePrepare[nearestVertexIndex] * pixSizePrepare[nearestVertexIndex] * pixSizePrepare[nearestVertexIndex];
+                    const float pixSizeScoreI = simScorePrepare[nearestVertexIndex] * pixSize * pixSize;
+                    const float pixSizeScoreV = simScorePrepare[nearestVertexIndex] * pixSizePrepare[nearestVertexIndex] * pixSizePrepare[nearestVertexIndex];
+
+                    if(dist < voteMarginFactor * std::max(pixSizeScoreI, pixSizeScoreV))
+                        matches.push_back({nearestVertexIndex, p, dist < contributeMarginFactor * pixSizeScoreV});
+                }
+            }
 
-                if(dist < voteMarginFactor * std::max(pixSizeScoreI, pixSizeScoreV))
+            for(int r = 0; r < nbRows; ++r)
+            {
+                for(const VertexMatch& match : rowsMatches[r])
                 {
-                    GC_vertexInfo& va = verticesAttrPrepare[nearestVertexIndex];
-                    Point3d& vc = verticesCoordsPrepare[nearestVertexIndex];
-                    const float simValue = simMap(index);
-                    // remap similarity values from [-1;+1] to [+1;+simFactor]
-                    // interpretation is [goodSimilarity;badSimilarity]
-                    const float simScore = simValue < -1.0f ? 1.0f : 1.0f + (1.0f + simValue) * simFactor;
+                    GC_vertexInfo& va = verticesAttrPrepare[match.vertexIndex];
+                    Point3d& vc = verticesCoordsPrepare[match.vertexIndex];
 
-                    // Custom locks to limit it to the index: nearestVertexIndex
-                    // to avoid using "omp critical"
-                    omp_lock_t* lock = &locks[nearestVertexIndex];
-                    omp_set_lock(lock);
+                    va.cams.push_back_distinct(c);
+                    if(match.contribute)
                     {
-                        va.cams.push_back_distinct(c);
-                        if(dist < contributeMarginFactor * pixSizeScoreV)
-                        {
-                            vc = (vc * (double)va.nrc + p) / double(va.nrc + 1);
-//                            newVerticesCoordsPrepare[nearestVertexIndex] = (newVerticesCoordsPrepare[nearestVertexIndex] * double(va.nrc) + p) / double(va.nrc + 1);
-//                            newSimScorePrepare[nearestVertexIndex] = (newSimScorePrepare[nearestVertexIndex] * float(va.nrc) + simScore) / float(va.nrc + 1);
-//                            newPixSizePrepare[nearestVertexIndex] = (newPixSizePrepare[nearestVertexIndex] * double(va.nrc) + pixSize) / double(va.nrc + 1);
-                            va.nrc += 1;
-                        }
+                        vc = (vc * (double)va.nrc + match.point) / double(va.nrc + 1);
+                        va.nrc += 1;
                     }
-                    omp_unset_lock(lock);
                 }
             }
         }
     }
-    omp_set_nested(0);
-
-    for(auto& lock: locks)
-        omp_destroy_lock(&lock);
 
     // compute pixSize
     #pragma omp parallel for
@@ -558,8 +566,51 @@ void DelaunayGraphCut::computeDelaunay()
 
     assert(_verticesCoords.size() == _verticesAttr.size());
 
+    // use the parallel tetrahedralization on large point sets only,
+    // the sequential one is faster on small point sets
+    static const std::size_t minNbVerticesParallelDelaunay = 100000;
+    bool parallelDelaunay = _mp.userParams.get<bool>("delaunaycut.parallelTetrahedralization", false) &&
+                            (_verticesCoords.size() >= minNbVerticesParallelDelaunay);
+
+    // the parallel tetrahedralization cells order depends on the threads scheduling,
+    // keep the sequential one when a seed is set to get reproducible results
+    if(parallelDelaunay && _mp.userParams.get<unsigned int>("delaunaycut.seed", 0) != 0)
+    {
+        ALICEVISION_LOG_INFO("GEOGRAM parallel Delaunay tetrahedralization is not reproducible, use the sequential one as a seed is set.");
+        parallelDelaunay = false;
+    }
+
     long tall = clock();
-    _tetrahedralization->set_vertices(_verticesCoords.size(), _verticesCoords.front().m);
+    bool done = false;
+
+    if(parallelDelaunay)
+    {
+        GEO::Delaunay_var parallelTetrahedralization = GEO::Delaunay::create(3, "PDEL");
+
+        if(parallelTetrahedralization.is_null())
+        {
+            ALICEVISION_LOG_WARNING("GEOGRAM parallel Delaunay tetrahedralization is not available, use the sequential one.");
+        }
+        else
+        {
+            try
+            {
+                parallelTetrahedralization->set_stores_neighbors(true);
+                parallelTetrahedralization->set_vertices(_verticesCoords.size(), _verticesCoords.front().m);
+                _tetrahedralization = parallelTetrahedralization;
+                done = true;
+                ALICEVISION_LOG_INFO("GEOGRAM parallel Delaunay tetrahedralization (" << GEO::Process::maximum_concurrent_threads() << " threads).");
+            }
+            catch(const std::exception& e)
+            {
+                ALICEVISION_LOG_WARNING("GEOGRAM parallel Delaunay tetrahedralization failed, use the sequential one: " << e.what());
+            }
+        }
+    }
+
+    if(!done)
+        _tetrahedralization->set_vertices(_verticesCoords.size(), _verticesCoords.front().m);
+
     mvsUtils::printfElapsedTime(tall, "GEOGRAM Delaunay tetrahedralization ");
 
     initCells();
@@ -569,11 +620,66 @@ void DelaunayGraphCut::computeDelaunay()
     ALICEVISION_LOG_DEBUG("computeDelaunay done\n");
 }
 
+void DelaunayGraphCut::updateVertexToCellsCache()
+{
+    const std::int64_t nbVertices = _verticesCoords.size();
+    const std::int64_t nbCells = _tetrahedralization->nb_cells();
+
+    // count the neighboring cells of each vertex
+    std::vector<int> nbCellsPerVertex(nbVertices, 0);
+    int coutInvalidVertices = 0;
+
+    #pragma omp parallel for reduction(+:coutInvalidVertices)
+    for(std::int64_t ci = 0; ci < nbCells; ++ci)
+    {
+        for(VertexIndex k = 0; k < 4; ++k)
+        {
+            const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
+            if(vi == GEO::NO_VERTEX || vi >= nbVertices)
+            {
+                ++coutInvalidVertices;
+                continue;
+            }
+            ++boost::atomic_ref<int>{nbCellsPerVertex[vi]};
+        }
+    }
+    ALICEVISION_LOG_INFO("coutInvalidVertices: " << coutInvalidVertices);
+
+    _neighboringCellsPerVertex.clear();
+    _neighboringCellsPerVertex.resize(nbVertices);
+    ALICEVISION_LOG_INFO("verticesCoords: " << nbVertices);
+
+    #pragma omp parallel for
+    for(std::int64_t vi = 0; vi < nbVertices; ++vi)
+        _neighboringCellsPerVertex[vi].resize(nbCellsPerVertex[vi]);
+
+    // fill the neighboring cells of each vertex
+    // nbCellsPerVertex is reused as a fill cursor
+    #pragma omp parallel for
+    for(std::int64_t ci = 0; ci < nbCells; ++ci)
+    {
+        for(VertexIndex k = 0; k < 4; ++k)
+        {
+            const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
+            if(vi == GEO::NO_VERTEX || vi >= nbVertices)
+                continue;
+            const int pos = --boost::atomic_ref<int>{nbCellsPerVertex[vi]};
+            _neighboringCellsPerVertex[vi][pos] = CellIndex(ci);
+        }
+    }
+
+    // sorted lists, as expected by getNeighboringCellsByEdge
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(std::int64_t vi = 0; vi < nbVertices; ++vi)
+        std::sort(_neighboringCellsPerVertex[vi].begin(), _neighboringCellsPerVertex[vi].end());
+}
+
 void DelaunayGraphCut::initCells()
 {
     _cellsAttr.resize(_tetrahedralization->nb_cells()); // or nb_finite_cells() if keeps_infinite()
 
     ALICEVISION_LOG_INFO(_cellsAttr.size() << " cells created by tetrahedralization.");
+    #pragma omp parallel for
     for(int i = 0; i < _cellsAttr.size(); ++i)
     {
         GC_cellInfo& c = _cellsAttr[i];
@@ -1109,6 +1215,220 @@ void DelaunayGraphCut::addMaskHelperPoints(const Point3d voxel[8], const StaticV
     ALICEVISION_LOG_INFO("Add Mask Helper Points done.");
 }
 
+/**
+ * @brief Get the image region of a camera covered by the projection of a bounding hexahedron.
+ * @param[in] mp the multi-view parameters
+ * @param[in] c the camera index
+ * @param[in] voxel the bounding hexahedron (nullptr for no bounding)
+ * @return the covered image region, the full image if some hexahedron corners are behind the camera
+ */
+ROI getHexahedronImageRoi(const mvsUtils::MultiViewParams& mp, int c, const Point3d voxel[8])
+{
+    const int width = mp.getWidth(c);
+    const int height = mp.getHeight(c);
+    const ROI imageRoi(0, width, 0, height);
+
+    if(voxel == nullptr)
+        return imageRoi;
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+
+    for(int i = 0; i < 8; ++i)
+    {
+        // the projection of the hexahedron is not bounded by its corners projection
+        if(!mp.is3DPointInFrontOfCam(&voxel[i], c))
+            return imageRoi;
+
+        Point2d pix;
+        mp.getPixelFor3DPoint(&pix, voxel[i], c);
+        minX = std::min(minX, pix.x);
+        minY = std::min(minY, pix.y);
+        maxX = std::max(maxX, pix.x);
+        maxY = std::max(maxY, pix.y);
+    }
+
+    const auto clampCoord = [](double v, int size) { return static_cast<unsigned int>(std::min(std::max(v, 0.0), double(size))); };
+
+    return ROI(clampCoord(std::floor(minX), width), clampCoord(std::ceil(maxX) + 1.0, width),
+               clampCoord(std::floor(minY), height), clampCoord(std::ceil(maxY) + 1.0, height));
+}
+
+/**
+ * @brief Load the depth/similarity/nmod maps of a camera and select the best depth value per tile of step x step pixels.
+ * @note With a bounding hexahedron, only the depth and similarity map region covered by its projection is read.
+ * @param[in] mp the multi-view parameters
+ * @param[in] c the camera index
+ * @param[in] step the tile size in pixels
+ * @param[in] voxel the bounding hexahedron, points outside are discarded (nullptr for no bounding)
+ * @param[in] params the fusion parameters
+ * @param[in] addPoint called for each tile with (tile index, point, pixSize, simScore), pixSize is -1 for discarded tiles
+ */
+template<typename AddPointFunc>
+void selectDepthMapPoints(const mvsUtils::MultiViewParams& mp, int c, int step, const Point3d voxel[8], const FuseParams& params,
+                          AddPointFunc&& addPoint)
+{
+    image::Image<float> depthMap;
+    image::Image<float> simMap;
+    image::Image<unsigned char> numOfModalsMap;
+
+    const int width = mp.getWidth(c);
+    const int height = mp.getHeight(c);
+    const int syMax = divideRoundUp(height, step);
+    const int sxMax = divideRoundUp(width, step);
+
+    // tiles overlapping the hexahedron projection
+    const ROI hexahRoi = getHexahedronImageRoi(mp, c, voxel);
+    const ROI tilesRoi(hexahRoi.x.begin / step, divideRoundUp(int(hexahRoi.x.end), step),
+                       hexahRoi.y.begin / step, divideRoundUp(int(hexahRoi.y.end), step));
+
+    if(hexahRoi.isEmpty())
+    {
+        // the hexahedron is not visible, discard all the tiles
+        for(int index = 0; index < syMax * sxMax; ++index)
+            addPoint(index, Point3d(), -1.0, 0.0f);
+        return;
+    }
+
+    // region of the maps to read: the tiles and a margin for the similarity smoothing and the modals kernel
+    const int margin = static_cast<int>(std::ceil(params.simGaussianSizeInit)) + 1;
+    const ROI readRoi(std::max(int(tilesRoi.x.begin) * step - margin, 0),
+                      std::min(int(tilesRoi.x.end) * step + margin, width),
+                      std::max(int(tilesRoi.y.begin) * step - margin, 0),
+                      std::min(int(tilesRoi.y.end) * step + margin, height));
+    const int readWidth = readRoi.width();
+    const int readHeight = readRoi.height();
+
+    {
+        // read depth map
+        mvsUtils::readMap(c, mp, mvsUtils::EFileType::depthMapFiltered, readRoi, depthMap);
+
+        if(depthMap.size() <= 0)
+        {
+            ALICEVISION_LOG_WARNING("Empty depth map (cam id: " << c << ")");
+            return;
+        }
+
+        // read similarity map
+        try
+        {
+            mvsUtils::readMap(c, mp, mvsUtils::EFileType::simMapFiltered, readRoi, simMap);
+            image::Image<float> simMapTmp;
+            imageAlgo::convolveImage(simMap, simMapTmp, "gaussian",
+                                     params.simGaussianSizeInit,
+                                     params.simGaussianSizeInit);
+            simMap.swap(simMapTmp);
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_WARNING("simMap file can't be found.");
+            simMap.resize(readWidth, readHeight, true, -1);
+        }
+
+        // read nmod map
+        int wTmp, hTmp;
+        const std::string nmodMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::nmodMap);
+        // If we have an nModMap in input (from depthmapfilter) use it,
+        // else init with a constant value.
+        if(boost::filesystem::exists(nmodMapFilepath))
+        {
+            image::readImage(nmodMapFilepath, numOfModalsMap,
+                             image::EImageColorSpace::NO_CONVERSION);
+            if (numOfModalsMap.Width() != width || numOfModalsMap.Height() != height)
+                throw std::runtime_error("Wrong nmod map dimensions: " + nmodMapFilepath);
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("nModMap file can't be found: " << nmodMapFilepath);
+            numOfModalsMap.resize(width, height, true, 1);
+        }
+    }
+
+    // depth and similarity maps are indexed in the read region
+    const auto readIndex = [&](int x, int y) -> std::size_t { return (y - readRoi.y.begin) * readWidth + (x - readRoi.x.begin); };
+
+    for(int sy = 0; sy < syMax; ++sy)
+    {
+        for(int sx = 0; sx < sxMax; ++sx)
+        {
+            const int index = sy * sxMax + sx;
+            if(!tilesRoi.contains(sx, sy))
+            {
+                // the tile is outside of the hexahedron projection, discard the point
+                addPoint(index, Point3d(), -1.0, 0.0f);
+                continue;
+            }
+
+            float bestDepth = std::numeric_limits<float>::max();
+            float bestScore = 0;
+            float bestSimScore = 0;
+            int bestX = 0;
+            int bestY = 0;
+            for(int y = sy * step, ymax = std::min((sy+1) * step, height);
+                y < ymax; ++y)
+            {
+                for(int x = sx * step, xmax = std::min((sx+1) * step, width);
+                    x < xmax; ++x)
+                {
+                    const float depth = depthMap(readIndex(x, y));
+                    if(depth <= 0.0f)
+                        continue;
+
+                    int numOfModals = 0;
+                    const int scoreKernelSize = 1;
+                    for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
+                    {
+                        for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
+                        {
+                            if (depthMap(readIndex(lx, ly)) > 0.0f)
+                            {
+                                numOfModals += 10 + int(numOfModalsMap(ly * width + lx));
+                            }
+                        }
+                    }
+                    float sim = simMap(readIndex(x, y));
+                    sim = sim < 0.0f ?  0.0f : sim; // clamp values < 0
+                    // remap similarity values from [-1;+1] to [+1;+simScale]
+                    // interpretation is [goodSimilarity;badSimilarity]
+                    const float simScore = 1.0f + sim * params.simFactor;
+
+                    const float score = numOfModals + (1.0f / simScore);
+                    if(score > bestScore)
+                    {
+                        bestDepth = depth;
+                        bestScore = score;
+                        bestSimScore = simScore;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+            }
+            if(bestScore < 3*13)
+            {
+                // discard the point
+                addPoint(index, Point3d(), -1.0, 0.0f);
+            }
+            else
+            {
+                const Point3d p = mp.CArr[c] + (mp.iCamArr[c] * Point2d((float)bestX, (float)bestY)).normalize() * bestDepth;
+
+                // TODO: isPointInHexahedron: here or in the previous loop per pixel to not loose point?
+                if(voxel == nullptr || mvsUtils::isPointInHexahedron(p, voxel))
+                {
+                    addPoint(index, p, mp.getCamPixelSize(p, c), bestSimScore);
+                }
+                else
+                {
+                    // discard the point
+                    addPoint(index, p, -1.0, 0.0f);
+                }
+            }
+        }
+    }
+}
+
 void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Point3d voxel[8], const FuseParams& params)
 {
     ALICEVISION_LOG_INFO("fuseFromDepthMaps, maxVertices: " << params.maxPoints);
@@ -1128,18 +1448,10 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     ALICEVISION_LOG_INFO("Number of pixels from all input images: " << nbPixels);
     int step = std::floor(std::sqrt(double(nbPixels) / double(params.maxInputPoints)));
     step = std::max(step, params.minStep);
-    std::size_t realMaxVertices = 0;
-    std::vector<int> startIndex(_mp.getNbCameras(), 0);
-    for(int i = 0; i < _mp.getNbCameras(); ++i)
-    {
-        const auto& imgParams = _mp.getImageParams(i);
-        startIndex[i] = realMaxVertices;
-        realMaxVertices += divideRoundUp(imgParams.width, step) *
-                           divideRoundUp(imgParams.height, step);
-    }
-    std::vector<Point3d> verticesCoordsPrepare(realMaxVertices);
-    std::vector<double> pixSizePrepare(realMaxVertices);
-    std::vector<float> simScorePrepare(realMaxVertices);
+    std::vector<Point3d> verticesCoordsPrepare;
+    std::vector<double> pixSizePrepare;
+    std::vector<float> simScorePrepare;
+    std::vector<GC_vertexInfo> verticesAttrPrepare;
 
     // counter for filtered points
     int minVisCounter = 0;
@@ -1148,159 +1460,84 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     ALICEVISION_LOG_INFO("simFactor: " << params.simFactor);
     ALICEVISION_LOG_INFO("maxVertices: " << params.maxPoints);
     ALICEVISION_LOG_INFO("step: " << step << " (minStep: " << params.minStep << ")");
-    ALICEVISION_LOG_INFO("realMaxVertices: " << realMaxVertices);
     ALICEVISION_LOG_INFO("minVis: " << params.minVis);
 
     ALICEVISION_LOG_INFO("Load depth maps and add points.");
+    if(params.voxelHashFusion)
     {
-        omp_set_nested(1);
-        #pragma omp parallel for num_threads(3)
+        // streaming fusion: points are merged on the fly in a spatial hash,
+        // the points of all the depth maps are never loaded at once
+        PointsVoxelHash pointsVoxelHash(params.pixSizeMarginInitCoef);
+        std::size_t nbInputPoints = 0;
+
+        #pragma omp parallel for schedule(dynamic) reduction(+:nbInputPoints)
         for(int c = 0; c < cams.size(); c++)
         {
-            image::Image<float> depthMap;
-            image::Image<float> simMap;
-            image::Image<unsigned char> numOfModalsMap;
+            std::size_t nbCamPoints = 0;
+            selectDepthMapPoints(_mp, c, step, voxel, params,
+                                 [&](int index, const Point3d& p, double pixSize, float simScore)
+                                 {
+                                     if(pixSize <= 0.0 || params.pixSizeMarginInitCoef * simScore * pixSize * pixSize < std::numeric_limits<double>::epsilon())
+                                         return;
+                                     pointsVoxelHash.addPoint(p, pixSize, simScore, c);
+                                     ++nbCamPoints;
+                                 });
+            nbInputPoints += nbCamPoints;
+        }
 
-            const int width = _mp.getWidth(c);
-            const int height = _mp.getHeight(c);
+        ALICEVISION_LOG_INFO(nbInputPoints << " input points fused on the fly to " << pointsVoxelHash.size() << " points.");
 
-            {
-                // read depth map
-                mvsUtils::readMap(c, _mp, mvsUtils::EFileType::depthMapFiltered, depthMap);
+        pointsVoxelHash.extractPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare, verticesAttrPrepare);
 
-                if(depthMap.size() <= 0)
-                {
-                    ALICEVISION_LOG_WARNING("Empty depth map (cam id: " << c << ")");
-                    continue;
-                }
-
-                // read similarity map
-                try
-                {
-                    mvsUtils::readMap(c, _mp, mvsUtils::EFileType::simMapFiltered, simMap);
-                    image::Image<float> simMapTmp;
-                    imageAlgo::convolveImage(simMap, simMapTmp, "gaussian",
-                                             params.simGaussianSizeInit,
-                                             params.simGaussianSizeInit);
-                    simMap.swap(simMapTmp);
-                }
-                catch(const std::exception& e)
-                {
-                    ALICEVISION_LOG_WARNING("simMap file can't be found.");
-                    simMap.resize(width, height, true, -1);
-                }
+        ALICEVISION_LOG_INFO("Filter initial 3D points by pixel size to remove duplicates.");
 
-                // read nmod map
-                int wTmp, hTmp;
-                const std::string nmodMapFilepath = getFileNameFromIndex(_mp, c, mvsUtils::EFileType::nmodMap);
-                // If we have an nModMap in input (from depthmapfilter) use it,
-                // else init with a constant value.
-                if(boost::filesystem::exists(nmodMapFilepath))
-                {
-                    image::readImage(nmodMapFilepath, numOfModalsMap,
-                                     image::EImageColorSpace::NO_CONVERSION);
-                    if (numOfModalsMap.Width() != width || numOfModalsMap.Height() != height)
-                        throw std::runtime_error("Wrong nmod map dimensions: " + nmodMapFilepath);
-                }
-                else
-                {
-                    ALICEVISION_LOG_WARNING("nModMap file can't be found: " << nmodMapFilepath);
-                    numOfModalsMap.resize(width, height, true, 1);
-                }
-            }
-
-            const int syMax = divideRoundUp(height, step);
-            const int sxMax = divideRoundUp(width, step);
-            #pragma omp parallel for
-            for(int sy = 0; sy < syMax; ++sy)
-            {
-                for(int sx = 0; sx < sxMax; ++sx)
-                {
-                    const int index = startIndex[c] + sy * sxMax + sx;
-                    float bestDepth = std::numeric_limits<float>::max();
-                    float bestScore = 0;
-                    float bestSimScore = 0;
-                    int bestX = 0;
-                    int bestY = 0;
-                    for(int y = sy * step, ymax = std::min((sy+1) * step, height);
-                        y < ymax; ++y)
-                    {
-                        for(int x = sx * step, xmax = std::min((sx+1) * step, width);
-                            x < xmax; ++x)
-                        {
-                            const std::size_t index = y * width + x;
-                            const float depth = depthMap(index);
-                            if(depth <= 0.0f)
-                                continue;
+        filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
+        // remove points if pixSize == -1
+        removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare, verticesAttrPrepare);
+    }
+    else
+    {
+        std::size_t realMaxVertices = 0;
+        std::vector<int> startIndex(_mp.getNbCameras(), 0);
+        for(int i = 0; i < _mp.getNbCameras(); ++i)
+        {
+            const auto& imgParams = _mp.getImageParams(i);
+            startIndex[i] = realMaxVertices;
+            realMaxVertices += divideRoundUp(imgParams.width, step) *
+                               divideRoundUp(imgParams.height, step);
+        }
+        ALICEVISION_LOG_INFO("realMaxVertices: " << realMaxVertices);
 
-                            int numOfModals = 0;
-                            const int scoreKernelSize = 1;
-                            for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
-                            {
-                                for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
-                                {
-                                    if (depthMap(ly * width + lx) > 0.0f)
-                                    {
-                                        numOfModals += 10 + int(numOfModalsMap(ly * width + lx));
-                                    }
-                                }
-                            }
-                            float sim = simMap(index);
-                            sim = sim < 0.0f ?  0.0f : sim; // clamp values < 0
-                            // remap similarity values from [-1;+1] to [+1;+simScale]
-                            // interpretation is [goodSimilarity;badSimilarity]
-                            const float simScore = 1.0f + sim * params.simFactor;
+        verticesCoordsPrepare.resize(realMaxVertices);
+        pixSizePrepare.resize(realMaxVertices);
+        simScorePrepare.resize(realMaxVertices);
 
-                            const float score = numOfModals + (1.0f / simScore);
-                            if(score > bestScore)
-                            {
-                                bestDepth = depth;
-                                bestScore = score;
-                                bestSimScore = simScore;
-                                bestX = x;
-                                bestY = y;
-                            }
-                        }
-                    }
-                    if(bestScore < 3*13)
-                    {
-                        // discard the point
-                        pixSizePrepare[index] = -1.0;
-                    }
-                    else
-                    {
-                        const Point3d p = _mp.CArr[c] + (_mp.iCamArr[c] * Point2d((float)bestX, (float)bestY)).normalize() * bestDepth;
-                        
-                        // TODO: isPointInHexahedron: here or in the previous loop per pixel to not loose point?
-                        if(voxel == nullptr || mvsUtils::isPointInHexahedron(p, voxel)) 
-                        {
-                            verticesCoordsPrepare[index] = p;
-                            simScorePrepare[index] = bestSimScore;
-                            pixSizePrepare[index] = _mp.getCamPixelSize(p, c);
-                        }
-                        else
-                        {
-                            // discard the point
-                            // verticesCoordsPrepare[index] = p;
-                            pixSizePrepare[index] = -1.0;
-                        }
-                    }
-                }
-            }
+        // cameras in parallel, each one writes its own range of points
+        #pragma omp parallel for schedule(dynamic)
+        for(int c = 0; c < cams.size(); c++)
+        {
+            selectDepthMapPoints(_mp, c, step, voxel, params,
+                                 [&](int index, const Point3d& p, double pixSize, float simScore)
+                                 {
+                                     const int vIndex = startIndex[c] + index;
+                                     verticesCoordsPrepare[vIndex] = p;
+                                     pixSizePrepare[vIndex] = pixSize;
+                                     simScorePrepare[vIndex] = simScore;
+                                 });
         }
-        omp_set_nested(0);
-    }
 
-    ALICEVISION_LOG_INFO("Filter initial 3D points by pixel size to remove duplicates.");
+        ALICEVISION_LOG_INFO("Filter initial 3D points by pixel size to remove duplicates.");
 
-    filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
-    // remove points if pixSize == -1
-    removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+        filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
+        // remove points if pixSize == -1
+        removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+
+        verticesAttrPrepare.resize(verticesCoordsPrepare.size());
+    }
 
     ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points.");
 
     ALICEVISION_LOG_INFO("Init visibilities to compute angle scores");
-    std::vector<GC_vertexInfo> verticesAttrPrepare(verticesCoordsPrepare.size());
 
     // Compute the vertices positions and simScore from all input depthMap/simMap images,
     // and declare the visibility information (the cameras indexes seeing the vertex).
@@ -1914,16 +2151,57 @@ float DelaunayGraphCut::weightFcn(float nrc, bool labatutWeights, int  /*ncams*/
     return weight;
 }
 
+/**
+ * @brief Split the ordered vertices in batches of consecutive vertices with about the same number of rays
+ *        (one ray per camera observing the vertex).
+ * @param[in] verticesAttr the vertices information
+ * @param[in] verticesIds the ordered vertices indexes
+ * @param[out] out_nbRays the total number of rays
+ * @return the first index of each batch in verticesIds, followed by verticesIds.size()
+ */
+static std::vector<std::size_t> getRayBatches(const std::vector<GC_vertexInfo>& verticesAttr, const std::vector<int>& verticesIds, std::size_t& out_nbRays)
+{
+    // small enough to balance the load between threads, large enough to limit the scheduling overhead
+    const std::size_t nbRaysPerBatch = 256;
+
+    std::vector<std::size_t> batches;
+    batches.reserve(verticesIds.size() / nbRaysPerBatch + 2);
+    batches.push_back(0);
+
+    std::size_t batchCost = 0;
+    out_nbRays = 0;
+
+    for(std::size_t i = 0; i < verticesIds.size(); ++i)
+    {
+        const std::size_t nbRays = verticesAttr[verticesIds[i]].cams.size();
+        out_nbRays += nbRays;
+        batchCost += 1 + nbRays; // vertices without camera are cheap but not free
+
+        if(batchCost >= nbRaysPerBatch)
+        {
+            batches.push_back(i + 1);
+            batchCost = 0;
+        }
+    }
+
+    if(batches.back() != verticesIds.size())
+        batches.push_back(verticesIds.size());
+
+    return batches;
+}
+
 void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, bool fillOut, float distFcnHeight,
                                  float fullWeight) // nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0
                                                       // labatutWeights=0 fillOut=1 distFcnHeight=0
 {
     ALICEVISION_LOG_INFO("Computing s-t graph weights.");
-    long t1 = clock();
+    const system::Timer timer;
 
     // loop over all cells ... initialize
-    for(GC_cellInfo& c: _cellsAttr)
+#pragma omp parallel for
+    for(std::int64_t ci = 0; ci < _cellsAttr.size(); ++ci)
     {
+        GC_cellInfo& c = _cellsAttr[ci];
         c.cellSWeight = 0.0f;
         c.cellTWeight = 0.0f;
         c.fullnessScore = 0.0f;
@@ -1952,28 +2230,39 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
     GeometriesCount totalGeometriesIntersectedFrontCount;
     GeometriesCount totalGeometriesIntersectedBehindCount;
 
+    // rays are processed by batches of vertices, each batch accumulates its own statistics
+    // and votes are accumulated in the cells with atomic operations
+    std::size_t nbRays = 0;
+    const std::vector<std::size_t> rayBatches = getRayBatches(_verticesAttr, verticesRandIds, nbRays);
+    const int nbRayBatches = rayBatches.size() - 1;
+
+    ALICEVISION_LOG_INFO("Casting " << nbRays << " rays from " << verticesRandIds.size() << " vertices (" << nbRayBatches << " batches).");
+
     auto progressDisplay =
-            system::createConsoleProgressDisplay(std::min(size_t(100), verticesRandIds.size()),
+            system::createConsoleProgressDisplay(std::min(size_t(100), std::size_t(nbRayBatches)),
                                                  std::cout, "fillGraphPartPtRc\n");
 
-    size_t progressStep = verticesRandIds.size() / 100;
+    size_t progressStep = nbRayBatches / 100;
     progressStep = std::max(size_t(1), progressStep);
-#pragma omp parallel for reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalIsRealNrc)
-    for(int i = 0; i < verticesRandIds.size(); i++)
+#pragma omp parallel for schedule(dynamic) reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalIsRealNrc)
+    for(int b = 0; b < nbRayBatches; ++b)
     {
-        if(i % progressStep == 0)
+        if(b % progressStep == 0)
         {
             ++progressDisplay;
         }
 
-        const int vertexIndex = verticesRandIds[i];
-        const GC_vertexInfo& v = _verticesAttr[vertexIndex];
-
         GeometriesCount subTotalGeometriesIntersectedFrontCount;
         GeometriesCount subTotalGeometriesIntersectedBehindCount;
 
-        if(v.isReal())
+        for(std::size_t i = rayBatches[b]; i < rayBatches[b + 1]; ++i)
         {
+            const int vertexIndex = verticesRandIds[i];
+            const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+
+            if(!v.isReal())
+                continue;
+
             ++totalIsRealNrc;
             // "weight" is called alpha(p) in the paper
             const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
@@ -2003,20 +2292,20 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
 
             totalCamHaveVisibilityOnVertex += v.cams.size();
             totalOfVertex += 1;
-
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.facets} +=
-                    subTotalGeometriesIntersectedFrontCount.facets;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.vertices} +=
-                    subTotalGeometriesIntersectedFrontCount.vertices;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.edges} +=
-                    subTotalGeometriesIntersectedFrontCount.edges;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.facets} +=
-                    subTotalGeometriesIntersectedBehindCount.facets;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.vertices} +=
-                    subTotalGeometriesIntersectedBehindCount.vertices;
-            boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} +=
-                    subTotalGeometriesIntersectedBehindCount.edges;
         }
+
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.facets} +=
+                subTotalGeometriesIntersectedFrontCount.facets;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.vertices} +=
+                subTotalGeometriesIntersectedFrontCount.vertices;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.edges} +=
+                subTotalGeometriesIntersectedFrontCount.edges;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.facets} +=
+                subTotalGeometriesIntersectedBehindCount.facets;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.vertices} +=
+                subTotalGeometriesIntersectedBehindCount.vertices;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} +=
+                subTotalGeometriesIntersectedBehindCount.edges;
     }
 
     ALICEVISION_LOG_DEBUG("_verticesAttr.size(): " << _verticesAttr.size() << "(" << verticesRandIds.size() << ")");
@@ -2032,7 +2321,10 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
     totalGeometriesIntersectedBehindCount /= totalCamHaveVisibilityOnVertex;
     ALICEVISION_LOG_DEBUG("Front per vertex: " << totalGeometriesIntersectedFrontCount);
     ALICEVISION_LOG_DEBUG("Behind per vertex: " << totalGeometriesIntersectedBehindCount);
-    mvsUtils::printfElapsedTime(t1, "s-t graph weights computed : ");
+
+    const double elapsed = timer.elapsed();
+    ALICEVISION_LOG_INFO("s-t graph weights computed: " << totalRayFront << " rays, " << (totalStepsFront + totalStepsBehind)
+                         << " steps in " << elapsed << " s (" << std::size_t(totalRayFront / std::max(elapsed, 1e-6)) << " rays/s).");
 }
 
 void DelaunayGraphCut::fillGraphPartPtRc(
@@ -2351,7 +2643,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
 void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
 {
     ALICEVISION_LOG_INFO("Forcing t-edges");
-    long t2 = clock();
+    const system::Timer timer;
 
     const float forceTEdgeDelta = (float)_mp.userParams.get<double>("delaunaycut.forceTEdgeDelta", 0.1f);
     ALICEVISION_LOG_DEBUG("forceTEdgeDelta: " << forceTEdgeDelta);
@@ -2372,9 +2664,10 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
     const float nsigmaBackSilentPart = (float)_mp.userParams.get<double>("delaunaycut.nsigmaBackSilentPart", 2.0f);
     ALICEVISION_LOG_DEBUG("nsigmaBackSilentPart: " << nsigmaBackSilentPart);
 
-    for(GC_cellInfo& c: _cellsAttr)
+#pragma omp parallel for
+    for(std::int64_t ci = 0; ci < _cellsAttr.size(); ++ci)
     {
-        c.on = 0.0f;
+        _cellsAttr[ci].on = 0.0f;
         // WARNING out is not the same as the sum because the sum are counted edges behind as well
         // c.out = c.gEdgeVisWeight[0] + c.gEdgeVisWeight[1] + c.gEdgeVisWeight[2] + c.gEdgeVisWeight[3];
     }
@@ -2398,304 +2691,319 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
     GeometriesCount totalGeometriesIntersectedFrontCount;
     GeometriesCount totalGeometriesIntersectedBehindCount;
 
-#pragma omp parallel for reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind)
-    for(int i = 0; i < verticesRandIds.size(); ++i)
+    // rays are processed by batches of vertices, each batch accumulates its own statistics
+    std::size_t nbRays = 0;
+    const std::vector<std::size_t> rayBatches = getRayBatches(_verticesAttr, verticesRandIds, nbRays);
+    const int nbRayBatches = rayBatches.size() - 1;
+
+    ALICEVISION_LOG_INFO("Casting " << nbRays << " rays from " << verticesRandIds.size() << " vertices (" << nbRayBatches << " batches).");
+
+#pragma omp parallel for schedule(dynamic) reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalVertexIsVirtual)
+    for(int b = 0; b < nbRayBatches; ++b)
     {
-        const int vertexIndex = verticesRandIds[i];
-        const GC_vertexInfo& v = _verticesAttr[vertexIndex];
-        if(v.isVirtual())
-            continue;
+        GeometriesCount batchGeometriesIntersectedFrontCount;
+        GeometriesCount batchGeometriesIntersectedBehindCount;
 
-        ++totalVertexIsVirtual;
-        const Point3d& originPt = _verticesCoords[vertexIndex];
-        // For each camera that has visibility over the vertex v (vertexIndex)
-        for(const int cam : v.cams)
+        for(std::size_t i = rayBatches[b]; i < rayBatches[b + 1]; ++i)
         {
-            GeometriesCount geometriesIntersectedFrontCount;
-            GeometriesCount geometriesIntersectedBehindCount;
+            const int vertexIndex = verticesRandIds[i];
+            const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+            if(v.isVirtual())
+                continue;
 
-            const float maxDist = nPixelSizeBehind * _mp.getCamPixelSize(originPt, cam);
+            ++totalVertexIsVirtual;
+            const Point3d& originPt = _verticesCoords[vertexIndex];
+            // For each camera that has visibility over the vertex v (vertexIndex)
+            for(const int cam : v.cams)
+            {
+                GeometriesCount geometriesIntersectedFrontCount;
+                GeometriesCount geometriesIntersectedBehindCount;
 
-            // float minJump = 10000000.0f;
-            // float minSilent = 10000000.0f;
-            float maxJump = 0.0f;
-            float maxSilent = 0.0f;
-            float midSilent = 10000000.0f;
+                const float maxDist = nPixelSizeBehind * _mp.getCamPixelSize(originPt, cam);
 
-            {
-                // Initialisation
-                GeometryIntersection geometry(vertexIndex); // Starting on global vertex index
-                Point3d intersectPt = originPt;
-                // toTheCam
-                const Point3d dirVect = (_mp.CArr[cam] - originPt).normalize();
+                // float minJump = 10000000.0f;
+                // float minSilent = 10000000.0f;
+                float maxJump = 0.0f;
+                float maxSilent = 0.0f;
+                float midSilent = 10000000.0f;
 
-#ifdef ALICEVISION_DEBUG_VOTE
-                IntersectionHistory history(_mp.CArr[cam], originPt, dirVect);
-#endif
-                // As long as we find a next geometry
-                Point3d lastIntersectPt = originPt;
-                // Iterate on geometries in the direction of camera's vertex within margin defined by maxDist (as long as we find a next geometry)
-                while ((geometry.type != EGeometryType::Vertex || (_mp.CArr[cam] - intersectPt).size() > 1.0e-3) // We reach our camera vertex
-                    && (lastIntersectPt - originPt).size() <= (nsigmaJumpPart + nsigmaFrontSilentPart) * maxDist) // We are to far from the originPt
                 {
-                    // Keep previous informations
-                    const GeometryIntersection previousGeometry = geometry;
-                    lastIntersectPt = intersectPt;
+                    // Initialisation
+                    GeometryIntersection geometry(vertexIndex); // Starting on global vertex index
+                    Point3d intersectPt = originPt;
+                    // toTheCam
+                    const Point3d dirVect = (_mp.CArr[cam] - originPt).normalize();
 
 #ifdef ALICEVISION_DEBUG_VOTE
-                    history.append(geometry, intersectPt);
+                    IntersectionHistory history(_mp.CArr[cam], originPt, dirVect);
 #endif
-                    ++totalStepsFront;
-
-                    geometry = intersectNextGeom(previousGeometry, originPt, dirVect, intersectPt, marginEpsilonFactor, lastIntersectPt);
-
-                    if (geometry.type == EGeometryType::None)
+                    // As long as we find a next geometry
+                    Point3d lastIntersectPt = originPt;
+                    // Iterate on geometries in the direction of camera's vertex within margin defined by maxDist (as long as we find a next geometry)
+                    while ((geometry.type != EGeometryType::Vertex || (_mp.CArr[cam] - intersectPt).size() > 1.0e-3) // We reach our camera vertex
+                        && (lastIntersectPt - originPt).size() <= (nsigmaJumpPart + nsigmaFrontSilentPart) * maxDist) // We are to far from the originPt
                     {
+                        // Keep previous informations
+                        const GeometryIntersection previousGeometry = geometry;
+                        lastIntersectPt = intersectPt;
+
 #ifdef ALICEVISION_DEBUG_VOTE
-                        // exportBackPropagationMesh("forceTedges_ToCam_typeNone", history.geometries, originPt, _mp.CArr[cam]);
+                        history.append(geometry, intersectPt);
 #endif
-                        // ALICEVISION_LOG_DEBUG("[Error]: forceTedges(toTheCam) cause: geometry cannot be found.");
-                        break;
-                    }
+                        ++totalStepsFront;
 
-                    if((intersectPt - originPt).size() <= (lastIntersectPt - originPt).size())
-                    {
-                        // Inverse direction, stop
-                        break;
-                    }
-#ifdef ALICEVISION_DEBUG_VOTE
-                    {
-                        const auto end = history.geometries.end();
-                        auto it = std::find(history.geometries.begin(), end, geometry);
-                        if (it != end)
+                        geometry = intersectNextGeom(previousGeometry, originPt, dirVect, intersectPt, marginEpsilonFactor, lastIntersectPt);
+
+                        if (geometry.type == EGeometryType::None)
                         {
-                            // exportBackPropagationMesh("forceTedges_ToCam_alreadyIntersected", history.geometries, originPt, _mp.CArr[cam]);
-                            ALICEVISION_LOG_DEBUG("[Error]: forceTedges(toTheCam) cause: intersected geometry has already been intersected.");
+#ifdef ALICEVISION_DEBUG_VOTE
+                            // exportBackPropagationMesh("forceTedges_ToCam_typeNone", history.geometries, originPt, _mp.CArr[cam]);
+#endif
+                            // ALICEVISION_LOG_DEBUG("[Error]: forceTedges(toTheCam) cause: geometry cannot be found.");
                             break;
                         }
-                    }
-#endif
 
-                    if (geometry.type == EGeometryType::Facet)
-                    {
-                        ++geometriesIntersectedFrontCount.facets;
-                        const GC_cellInfo& c = _cellsAttr[geometry.facet.cellIndex];
-                        if ((lastIntersectPt - originPt).size() > nsigmaFrontSilentPart * maxDist) // (p-originPt).size() > 2 * sigma
+                        if((intersectPt - originPt).size() <= (lastIntersectPt - originPt).size())
                         {
-                            // minJump = std::min(minJump, c.emptinessScore);
-                            maxJump = std::max(maxJump, c.emptinessScore);
+                            // Inverse direction, stop
+                            break;
                         }
-                        else
+#ifdef ALICEVISION_DEBUG_VOTE
                         {
-                            // minSilent = std::min(minSilent, c.emptinessScore);
-                            maxSilent = std::max(maxSilent, c.emptinessScore);
+                            const auto end = history.geometries.end();
+                            auto it = std::find(history.geometries.begin(), end, geometry);
+                            if (it != end)
+                            {
+                                // exportBackPropagationMesh("forceTedges_ToCam_alreadyIntersected", history.geometries, originPt, _mp.CArr[cam]);
+                                ALICEVISION_LOG_DEBUG("[Error]: forceTedges(toTheCam) cause: intersected geometry has already been intersected.");
+                                break;
+                            }
                         }
+#endif
 
-                        // Take the mirror facet to iterate over the next cell
-                        const Facet mFacet = mirrorFacet(geometry.facet);
-                        if (isInvalidOrInfiniteCell(mFacet.cellIndex))
+                        if (geometry.type == EGeometryType::Facet)
                         {
+                            ++geometriesIntersectedFrontCount.facets;
+                            const GC_cellInfo& c = _cellsAttr[geometry.facet.cellIndex];
+                            if ((lastIntersectPt - originPt).size() > nsigmaFrontSilentPart * maxDist) // (p-originPt).size() > 2 * sigma
+                            {
+                                // minJump = std::min(minJump, c.emptinessScore);
+                                maxJump = std::max(maxJump, c.emptinessScore);
+                            }
+                            else
+                            {
+                                // minSilent = std::min(minSilent, c.emptinessScore);
+                                maxSilent = std::max(maxSilent, c.emptinessScore);
+                            }
+
+                            // Take the mirror facet to iterate over the next cell
+                            const Facet mFacet = mirrorFacet(geometry.facet);
+                            if (isInvalidOrInfiniteCell(mFacet.cellIndex))
+                            {
 #ifdef ALICEVISION_DEBUG_VOTE
-                            // exportBackPropagationMesh("forceTedges_ToCam_invalidMirorFacet", history.geometries, originPt, _mp.CArr[cam]);
+                                // exportBackPropagationMesh("forceTedges_ToCam_invalidMirorFacet", history.geometries, originPt, _mp.CArr[cam]);
 #endif
-                            // ALICEVISION_LOG_DEBUG("[Error]: forceTedges(toTheCam) cause: invalidOrInfinite miror facet.");
-                            break;
-                        }
-                        geometry.facet = mFacet;
-                        if(previousGeometry.type == EGeometryType::Facet && geometriesIntersectedFrontCount.facets > 10000)
-                        {
-                            ALICEVISION_LOG_WARNING("forceTedgesByGradient front: loop on facets. Current landmark index: " << vertexIndex << ", camera: " << cam << ", intersectPt: " << intersectPt << ", lastIntersectPt: " << lastIntersectPt << ", geometriesIntersectedFrontCount: " << geometriesIntersectedFrontCount);
-                            break;
+                                // ALICEVISION_LOG_DEBUG("[Error]: forceTedges(toTheCam) cause: invalidOrInfinite miror facet.");
+                                break;
+                            }
+                            geometry.facet = mFacet;
+                            if(previousGeometry.type == EGeometryType::Facet && geometriesIntersectedFrontCount.facets > 10000)
+                            {
+                                ALICEVISION_LOG_WARNING("forceTedgesByGradient front: loop on facets. Current landmark index: " << vertexIndex << ", camera: " << cam << ", intersectPt: " << intersectPt << ", lastIntersectPt: " << lastIntersectPt << ", geometriesIntersectedFrontCount: " << geometriesIntersectedFrontCount);
+                                break;
+                            }
                         }
-                    }
-                    else if (geometry.type == EGeometryType::Vertex)
-                    {
-                        ++geometriesIntersectedFrontCount.vertices;
-                        if(previousGeometry.type == EGeometryType::Vertex && geometriesIntersectedFrontCount.vertices > 1000)
+                        else if (geometry.type == EGeometryType::Vertex)
                         {
-                            ALICEVISION_LOG_WARNING("forceTedgesByGradient front: loop on edges. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedFrontCount: " << geometriesIntersectedFrontCount);
-                            break;
+                            ++geometriesIntersectedFrontCount.vertices;
+                            if(previousGeometry.type == EGeometryType::Vertex && geometriesIntersectedFrontCount.vertices > 1000)
+                            {
+                                ALICEVISION_LOG_WARNING("forceTedgesByGradient front: loop on edges. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedFrontCount: " << geometriesIntersectedFrontCount);
+                                break;
+                            }
                         }
-                    }
-                    else if (geometry.type == EGeometryType::Edge)
-                    {
-                        ++geometriesIntersectedFrontCount.edges;
-                        if(previousGeometry.type == EGeometryType::Edge && geometriesIntersectedFrontCount.edges > 1000)
+                        else if (geometry.type == EGeometryType::Edge)
                         {
-                            ALICEVISION_LOG_WARNING("forceTedgesByGradient front: loop on edges. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedFrontCount: " << geometriesIntersectedFrontCount);
-                            break;
+                            ++geometriesIntersectedFrontCount.edges;
+                            if(previousGeometry.type == EGeometryType::Edge && geometriesIntersectedFrontCount.edges > 1000)
+                            {
+                                ALICEVISION_LOG_WARNING("forceTedgesByGradient front: loop on edges. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedFrontCount: " << geometriesIntersectedFrontCount);
+                                break;
+                            }
                         }
                     }
+                    ++totalRayFront;
+                    batchGeometriesIntersectedFrontCount += geometriesIntersectedFrontCount;
                 }
-                ++totalRayFront;
-                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.facets} +=
-                        geometriesIntersectedFrontCount.facets;
-                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.vertices} +=
-                        geometriesIntersectedFrontCount.vertices;
-                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.edges} +=
-                        geometriesIntersectedFrontCount.edges;
-            }
-            {
-                // Initialisation
-                GeometryIntersection geometry(vertexIndex);
-                Point3d intersectPt = originPt;
-                // behindThePoint
-                const Point3d dirVect = (originPt - _mp.CArr[cam]).normalize();
-
-#ifdef ALICEVISION_DEBUG_VOTE
-                IntersectionHistory history(_mp.CArr[cam], originPt, dirVect);
-#endif
-
-                Facet lastIntersectedFacet;
-                bool firstIteration = true;
-		        Point3d lastIntersectPt = originPt;
-
-                // While we are within the surface margin defined by maxDist (as long as we find a next geometry)
-                while ((lastIntersectPt - originPt).size() <= nsigmaBackSilentPart * maxDist)
                 {
-                    // Keep previous informations
-                    const GeometryIntersection previousGeometry = geometry;
-                    lastIntersectPt = intersectPt;
+                    // Initialisation
+                    GeometryIntersection geometry(vertexIndex);
+                    Point3d intersectPt = originPt;
+                    // behindThePoint
+                    const Point3d dirVect = (originPt - _mp.CArr[cam]).normalize();
 
 #ifdef ALICEVISION_DEBUG_VOTE
-                    history.append(geometry, intersectPt);
+                    IntersectionHistory history(_mp.CArr[cam], originPt, dirVect);
 #endif
-                    ++totalStepsBehind;
 
-                    geometry = intersectNextGeom(previousGeometry, originPt, dirVect, intersectPt, marginEpsilonFactor, lastIntersectPt);
+                    Facet lastIntersectedFacet;
+                    bool firstIteration = true;
+    		        Point3d lastIntersectPt = originPt;
 
-                    if(geometry.type == EGeometryType::None)
+                    // While we are within the surface margin defined by maxDist (as long as we find a next geometry)
+                    while ((lastIntersectPt - originPt).size() <= nsigmaBackSilentPart * maxDist)
                     {
-//                         // If we come from a facet, the next intersection must exist (even if the mirror facet is invalid, which is verified later) 
-//                         if (previousGeometry.type == EGeometryType::Facet)
-//                         {
-// #ifdef ALICEVISION_DEBUG_VOTE
-//                             // exportBackPropagationMesh("forceTedges_behindThePoint_NoneButPreviousIsFacet", history.geometries, originPt, _mp.CArr[cam]);
-// #endif
-//                             ALICEVISION_LOG_DEBUG("[Error]: forceTedges(behindThePoint) cause: None geometry but previous is Facet.");
-//                         }
-                        // Break if we reach the end of the tetrahedralization volume
-                        break;
-                    }
+                        // Keep previous informations
+                        const GeometryIntersection previousGeometry = geometry;
+                        lastIntersectPt = intersectPt;
 
-                    if((intersectPt - originPt).size() <= (lastIntersectPt - originPt).size())
-                    {
-                        // Inverse direction, stop
-                        break;
-                    }
-                    if(geometry.type == EGeometryType::Facet)
-                    {
-                        ++geometriesIntersectedBehindCount.facets;
-
-                        // Vote for the first cell found (only once)
-                        if (firstIteration)
-                        {
-                            midSilent = _cellsAttr[geometry.facet.cellIndex].emptinessScore;
-                            firstIteration = false;
-                        }
+#ifdef ALICEVISION_DEBUG_VOTE
+                        history.append(geometry, intersectPt);
+#endif
+                        ++totalStepsBehind;
 
-                        const GC_cellInfo& c = _cellsAttr[geometry.facet.cellIndex];
-                        // minSilent = std::min(minSilent, c.emptinessScore);
-                        maxSilent = std::max(maxSilent, c.emptinessScore);
+                        geometry = intersectNextGeom(previousGeometry, originPt, dirVect, intersectPt, marginEpsilonFactor, lastIntersectPt);
 
-                        // Take the mirror facet to iterate over the next cell
-                        const Facet mFacet = mirrorFacet(geometry.facet);
-                        lastIntersectedFacet = mFacet;
-                        geometry.facet = mFacet;
-                        if (isInvalidOrInfiniteCell(mFacet.cellIndex))
+                        if(geometry.type == EGeometryType::None)
                         {
-                            // Break if we reach the end of the tetrahedralization volume (mirror facet cannot be found)
+    //                         // If we come from a facet, the next intersection must exist (even if the mirror facet is invalid, which is verified later) 
+    //                         if (previousGeometry.type == EGeometryType::Facet)
+    //                         {
+    // #ifdef ALICEVISION_DEBUG_VOTE
+    //                             // exportBackPropagationMesh("forceTedges_behindThePoint_NoneButPreviousIsFacet", history.geometries, originPt, _mp.CArr[cam]);
+    // #endif
+    //                             ALICEVISION_LOG_DEBUG("[Error]: forceTedges(behindThePoint) cause: None geometry but previous is Facet.");
+    //                         }
+                            // Break if we reach the end of the tetrahedralization volume
                             break;
                         }
-                        if(previousGeometry.type == EGeometryType::Facet && geometriesIntersectedBehindCount.facets > 1000)
+
+                        if((intersectPt - originPt).size() <= (lastIntersectPt - originPt).size())
                         {
-                            ALICEVISION_LOG_WARNING("forceTedgesByGradient behind: loop on facets. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedBehindCount: " << geometriesIntersectedBehindCount);
+                            // Inverse direction, stop
                             break;
                         }
-                    }
-                    else
-                    {
-                        // Vote for the first cell found (only once)
-                        // if we come from an edge or vertex to an other we have to vote for the first intersected cell.
-                        if (firstIteration)
+                        if(geometry.type == EGeometryType::Facet)
                         {
-                            if (previousGeometry.type != EGeometryType::Vertex)
+                            ++geometriesIntersectedBehindCount.facets;
+
+                            // Vote for the first cell found (only once)
+                            if (firstIteration)
                             {
-                                ALICEVISION_LOG_ERROR("The firstIteration vote could only happen during for "
-                                                      "the first cell when we come from the first vertex.");
-                                // throw std::runtime_error("[error] The firstIteration vote could only happen during for the first cell when we come from the first vertex.");
+                                midSilent = _cellsAttr[geometry.facet.cellIndex].emptinessScore;
+                                firstIteration = false;
                             }
-                            // the information of first intersected cell can only be found by taking intersection of neighbouring cells for both geometries
-                            const std::vector<CellIndex> previousNeighbouring = getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
-                            const std::vector<CellIndex> currentNeigbouring = getNeighboringCellsByGeometry(geometry);
 
-                            std::vector<CellIndex> neighboringCells;
-                            std::set_intersection(previousNeighbouring.begin(), previousNeighbouring.end(), currentNeigbouring.begin(), currentNeigbouring.end(), std::back_inserter(neighboringCells));
+                            const GC_cellInfo& c = _cellsAttr[geometry.facet.cellIndex];
+                            // minSilent = std::min(minSilent, c.emptinessScore);
+                            maxSilent = std::max(maxSilent, c.emptinessScore);
 
-                            for (const CellIndex& ci : neighboringCells)
+                            // Take the mirror facet to iterate over the next cell
+                            const Facet mFacet = mirrorFacet(geometry.facet);
+                            lastIntersectedFacet = mFacet;
+                            geometry.facet = mFacet;
+                            if (isInvalidOrInfiniteCell(mFacet.cellIndex))
                             {
-                                midSilent = _cellsAttr[geometry.facet.cellIndex].emptinessScore;
+                                // Break if we reach the end of the tetrahedralization volume (mirror facet cannot be found)
+                                break;
                             }
-                            firstIteration = false;
-                        }
-
-                        if (geometry.type == EGeometryType::Vertex)
-                        {
-                            ++geometriesIntersectedBehindCount.vertices;
-                            if(previousGeometry.type == EGeometryType::Vertex && geometriesIntersectedBehindCount.vertices > 1000)
+                            if(previousGeometry.type == EGeometryType::Facet && geometriesIntersectedBehindCount.facets > 1000)
                             {
-                                ALICEVISION_LOG_WARNING("forceTedgesByGradient behind: loop on vertices. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedBehindCount: " << geometriesIntersectedBehindCount);
+                                ALICEVISION_LOG_WARNING("forceTedgesByGradient behind: loop on facets. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedBehindCount: " << geometriesIntersectedBehindCount);
                                 break;
                             }
                         }
-                        else if (geometry.type == EGeometryType::Edge)
+                        else
                         {
-                            ++geometriesIntersectedBehindCount.edges;
-                            if(previousGeometry.type == EGeometryType::Edge && geometriesIntersectedBehindCount.edges > 1000)
+                            // Vote for the first cell found (only once)
+                            // if we come from an edge or vertex to an other we have to vote for the first intersected cell.
+                            if (firstIteration)
                             {
-                                ALICEVISION_LOG_WARNING("forceTedgesByGradient behind: loop on edges. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedBehindCount: " << geometriesIntersectedBehindCount);
-                                break;
+                                if (previousGeometry.type != EGeometryType::Vertex)
+                                {
+                                    ALICEVISION_LOG_ERROR("The firstIteration vote could only happen during for "
+                                                          "the first cell when we come from the first vertex.");
+                                    // throw std::runtime_error("[error] The firstIteration vote could only happen during for the first cell when we come from the first vertex.");
+                                }
+                                // the information of first intersected cell can only be found by taking intersection of neighbouring cells for both geometries
+                                const std::vector<CellIndex> previousNeighbouring = getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
+                                const std::vector<CellIndex> currentNeigbouring = getNeighboringCellsByGeometry(geometry);
+
+                                std::vector<CellIndex> neighboringCells;
+                                std::set_intersection(previousNeighbouring.begin(), previousNeighbouring.end(), currentNeigbouring.begin(), currentNeigbouring.end(), std::back_inserter(neighboringCells));
+
+                                for (const CellIndex& ci : neighboringCells)
+                                {
+                                    midSilent = _cellsAttr[geometry.facet.cellIndex].emptinessScore;
+                                }
+                                firstIteration = false;
+                            }
+
+                            if (geometry.type == EGeometryType::Vertex)
+                            {
+                                ++geometriesIntersectedBehindCount.vertices;
+                                if(previousGeometry.type == EGeometryType::Vertex && geometriesIntersectedBehindCount.vertices > 1000)
+                                {
+                                    ALICEVISION_LOG_WARNING("forceTedgesByGradient behind: loop on vertices. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedBehindCount: " << geometriesIntersectedBehindCount);
+                                    break;
+                                }
+                            }
+                            else if (geometry.type == EGeometryType::Edge)
+                            {
+                                ++geometriesIntersectedBehindCount.edges;
+                                if(previousGeometry.type == EGeometryType::Edge && geometriesIntersectedBehindCount.edges > 1000)
+                                {
+                                    ALICEVISION_LOG_WARNING("forceTedgesByGradient behind: loop on edges. Current landmark index: " << vertexIndex << ", camera: " << cam << ", geometriesIntersectedBehindCount: " << geometriesIntersectedBehindCount);
+                                    break;
+                                }
                             }
                         }
                     }
-                }
 
-                if (lastIntersectedFacet.cellIndex != GEO::NO_CELL)
-                {
-                    // Equation 6 in paper
-                    //   (g / B) < k_rel
-                    //   (B - g) > k_abs
-                    //   g < k_outl
-
-                    // In the paper:
-                    // B (beta): max value before point p
-                    // g (gamma): mid-range score behind point p
-
-                    // In the code:
-                    // maxJump: max score of emptiness in all the tetrahedron along the line of sight between camera c and 2*sigma before p
-                    // midSilent: score of the next tetrahedron directly after p (called T1 in the paper)
-                    // maxSilent: max score of emptiness for the tetrahedron around the point p (+/- 2*sigma around p)
-
-                    if((midSilent / maxJump < forceTEdgeDelta) && // (g / B) < k_rel    //// k_rel=0.1
-                       (maxJump - midSilent > minJumpPartRange) && // (B - g) > k_abs   //// k_abs=10000 // 1000 in the paper
-                       (maxSilent < maxSilentPartRange)) // g < k_outl                  //// k_outl=100  // 400 in the paper
-                        //(maxSilent-minSilent<maxSilentPartRange))
+                    if (lastIntersectedFacet.cellIndex != GEO::NO_CELL)
                     {
-                        boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].on} += (maxJump - midSilent);
+                        // Equation 6 in paper
+                        //   (g / B) < k_rel
+                        //   (B - g) > k_abs
+                        //   g < k_outl
+
+                        // In the paper:
+                        // B (beta): max value before point p
+                        // g (gamma): mid-range score behind point p
+
+                        // In the code:
+                        // maxJump: max score of emptiness in all the tetrahedron along the line of sight between camera c and 2*sigma before p
+                        // midSilent: score of the next tetrahedron directly after p (called T1 in the paper)
+                        // maxSilent: max score of emptiness for the tetrahedron around the point p (+/- 2*sigma around p)
+
+                        if((midSilent / maxJump < forceTEdgeDelta) && // (g / B) < k_rel    //// k_rel=0.1
+                           (maxJump - midSilent > minJumpPartRange) && // (B - g) > k_abs   //// k_abs=10000 // 1000 in the paper
+                           (maxSilent < maxSilentPartRange)) // g < k_outl                  //// k_outl=100  // 400 in the paper
+                            //(maxSilent-minSilent<maxSilentPartRange))
+                        {
+                            boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].on} += (maxJump - midSilent);
+                        }
                     }
+                    ++totalRayBehind;
+                    batchGeometriesIntersectedBehindCount += geometriesIntersectedBehindCount;
                 }
-                ++totalRayBehind;
-                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.facets} += totalGeometriesIntersectedBehindCount.facets;
-                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.vertices} += totalGeometriesIntersectedBehindCount.vertices;
-                boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} += totalGeometriesIntersectedBehindCount.edges;
             }
+            totalCamHaveVisibilityOnVertex += v.cams.size();
+            totalOfVertex += 1;
         }
-        totalCamHaveVisibilityOnVertex += v.cams.size();
-        totalOfVertex += 1;
+
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.facets} += batchGeometriesIntersectedFrontCount.facets;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.vertices} += batchGeometriesIntersectedFrontCount.vertices;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedFrontCount.edges} += batchGeometriesIntersectedFrontCount.edges;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.facets} += batchGeometriesIntersectedBehindCount.facets;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.vertices} += batchGeometriesIntersectedBehindCount.vertices;
+        boost::atomic_ref<std::size_t>{totalGeometriesIntersectedBehindCount.edges} += batchGeometriesIntersectedBehindCount.edges;
     }
 
-    for(GC_cellInfo& c: _cellsAttr)
+#pragma omp parallel for
+    for(std::int64_t ci = 0; ci < _cellsAttr.size(); ++ci)
     {
+        GC_cellInfo& c = _cellsAttr[ci];
         const float w = std::max(1.0f, c.cellTWeight) * c.on;
 
         // cellTWeight = clamp(w, cellTWeight, 1000000.0f);
@@ -2716,7 +3024,9 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(float nPixelSizeBehind)
     ALICEVISION_LOG_DEBUG("Front per vertex: " << totalGeometriesIntersectedFrontCount);
     ALICEVISION_LOG_DEBUG("Behind per vertex: " << totalGeometriesIntersectedBehindCount);
 
-    mvsUtils::printfElapsedTime(t2, "t-edges forced: ");
+    const double elapsed = timer.elapsed();
+    ALICEVISION_LOG_INFO("t-edges forced: " << totalRayFront << " rays, " << (totalStepsFront + totalStepsBehind)
+                         << " steps in " << elapsed << " s (" << std::size_t(totalRayFront / std::max(elapsed, 1e-6)) << " rays/s).");
 }
 
 int DelaunayGraphCut::computeIsOnSurface(std::vector<bool>& vertexIsOnSurface) const
@@ -3174,16 +3484,12 @@ void DelaunayGraphCut::addToInfiniteSw(float sW)
     ALICEVISION_LOG_WARNING("DelaunayGraphCut::addToInfiniteSw nbInfinitCells: " << nbInfinitCells);
 }
 
-void DelaunayGraphCut::maxflow()
+template<typename MaxFlowGraph>
+void DelaunayGraphCut::maxflow(MaxFlowGraph& maxFlowGraph)
 {
     long t_maxflow = clock();
 
-    ALICEVISION_LOG_INFO("Maxflow: start allocation.");
     const std::size_t nbCells = _cellsAttr.size();
-    ALICEVISION_LOG_INFO("Number of cells: " << nbCells);
-
-    // MaxFlow_CSR maxFlowGraph(nbCells);
-    MaxFlow_AdjList maxFlowGraph(nbCells);
 
     ALICEVISION_LOG_INFO("Maxflow: add nodes.");
     // fill s-t edges
@@ -3271,12 +3577,38 @@ void DelaunayGraphCut::maxflow()
     ALICEVISION_LOG_INFO("Maxflow: done.");
 }
 
+void DelaunayGraphCut::maxflow()
+{
+    const EMaxFlowAlgorithm maxflowAlgorithm = EMaxFlowAlgorithm_stringToEnum(
+        _mp.userParams.get<std::string>("delaunaycut.maxflowAlgorithm", EMaxFlowAlgorithm_enumToString(EMaxFlowAlgorithm::BOYKOV_KOLMOGOROV)));
+
+    ALICEVISION_LOG_INFO("Maxflow: start allocation (algorithm: " << maxflowAlgorithm << ").");
+    const std::size_t nbCells = _cellsAttr.size();
+    ALICEVISION_LOG_INFO("Number of cells: " << nbCells);
+
+    switch(maxflowAlgorithm)
+    {
+        case EMaxFlowAlgorithm::BOYKOV_KOLMOGOROV:
+        {
+            MaxFlow_AdjList maxFlowGraph(nbCells);
+            maxflow(maxFlowGraph);
+            break;
+        }
+        case EMaxFlowAlgorithm::PARALLEL_PUSH_RELABEL:
+        {
+            MaxFlow_PushRelabel maxFlowGraph(nbCells);
+            maxflow(maxFlowGraph);
+            break;
+        }
+    }
+}
+
 void DelaunayGraphCut::voteFullEmptyScore(const StaticVector<int>& cams, const std::string& folderName)
 {
     ALICEVISION_LOG_INFO("DelaunayGraphCut::voteFullEmptyScore");
     const int maxint = std::numeric_limits<int>::max();
 
-    long t1;
+    const system::Timer timer;
 
     // TODO FACA: nPixelSizeBehind 2 or 4 by default?
     const double nPixelSizeBehind = _mp.userParams.get<double>("delaunaycut.nPixelSizeBehind", 4.0); // sigma value
@@ -3334,6 +3666,8 @@ void DelaunayGraphCut::voteFullEmptyScore(const StaticVector<int>& cams, const s
         if(saveTemporaryBinFiles)
             saveDhInfo(folderName + "delaunayTriangulationInfoInit.bin");
     }
+
+    ALICEVISION_LOG_INFO("Full/empty votes computed in " << timer.elapsed() << " s.");
 }
 
 void DelaunayGraphCut::filterLargeHelperPoints(std::vector<bool>& out_reliableVertices,
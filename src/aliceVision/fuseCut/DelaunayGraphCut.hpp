@@ -55,6 +55,9 @@ struct FuseParams
     float simGaussianSize = 10.0f;
     double minAngleThreshold = 0.1;
     bool refineFuse = true;
+    /// Fuse the depth maps points on the fly in a voxel hash instead of loading all of them before filtering (lower memory peak).
+    /// Off by default: the points are merged per voxel in a different order, so the fused points differ from the default path.
+    bool voxelHashFusion = false;
     // Weight for helper points from mask. Do not create helper points if zero.
     float maskHelperPointsWeight = 0.0;
     int maskBorderSize = 1;
@@ -321,36 +324,10 @@ public:
         return out;
     }
 
-    void updateVertexToCellsCache()
-    {
-        _neighboringCellsPerVertex.clear();
-
-        std::map<VertexIndex, std::set<CellIndex>> neighboringCellsPerVertexTmp;
-        int coutInvalidVertices = 0;
-        for (CellIndex ci = 0; ci < _tetrahedralization->nb_cells(); ++ci)
-        {
-            for(VertexIndex k = 0; k < 4; ++k)
-            {
-                const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
-                if(vi == GEO::NO_VERTEX || vi >= _verticesCoords.size())
-                {
-                    ++coutInvalidVertices;
-                    continue;
-                }
-                neighboringCellsPerVertexTmp[vi].insert(ci);
-            }
-        }
-        ALICEVISION_LOG_INFO("coutInvalidVertices: " << coutInvalidVertices);
-        ALICEVISION_LOG_INFO("neighboringCellsPerVertexTmp: " << neighboringCellsPerVertexTmp.size());
-        _neighboringCellsPerVertex.resize(_verticesCoords.size());
-        ALICEVISION_LOG_INFO("verticesCoords: " << _verticesCoords.size());
-        for(const auto& it: neighboringCellsPerVertexTmp)
-        {
-            const std::set<CellIndex>& input = it.second;
-            std::vector<CellIndex>& output = _neighboringCellsPerVertex[it.first];
-            output.assign(input.begin(), input.end());
-        }
-    }
+    /**
+     * @brief Build the sorted list of neighboring cells of each vertex from the tetrahedralization.
+     */
+    void updateVertexToCellsCache();
 
     /**
      * @brief vertexToCells
@@ -502,8 +479,20 @@ public:
 
     void addToInfiniteSw(float sW);
 
+    /**
+     * @brief Compute the cells full/empty status with a graph-cut.
+     * @note The max-flow algorithm is selected with the "delaunaycut.maxflowAlgorithm" user parameter.
+     */
     void maxflow();
 
+    /**
+     * @brief Fill the given max-flow graph from the cells and facets weights,
+     *        compute the minimum cut and update the cells full/empty status.
+     * @param[in,out] maxFlowGraph an empty max-flow graph with one node per cell
+     */
+    template<typename MaxFlowGraph>
+    void maxflow(MaxFlowGraph& maxFlowGraph);
+
     void voteFullEmptyScore(const StaticVector<int>& cams, const std::string& folderName);
 
     void createDensePointCloud(const Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData* sfmData, const FuseParams* depthMapsFuseParams);
@@ -7,6 +7,7 @@
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/multiview/NViewDataSet.hpp>
 #include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
+#include <aliceVision/fuseCut/MaxFlowAlgorithm.hpp>
 
 #include <boost/filesystem.hpp>
 
@@ -109,6 +110,55 @@ BOOST_AUTO_TEST_CASE(fuseCut_delaunayGraphCut)
     ALICEVISION_LOG_TRACE("CreateGraphCut Done.");
 }
 
+BOOST_AUTO_TEST_CASE(fuseCut_delaunayGraphCut_maxflowAlgorithms)
+{
+    makeRandomOperationsReproducible();
+
+    const NViewDatasetConfigurator config(1000, 1000, 500, 500, 1, 0);
+    SfMData sfmData = generateSfm(config, 6);
+
+    mvsUtils::MultiViewParams mp(sfmData, "", "", "", false);
+
+    mp.userParams.put("LargeScale.universePercentile", 0.999);
+    mp.userParams.put("delaunaycut.forceTEdgeDelta", 0.1f);
+    mp.userParams.put("delaunaycut.seed", 1);
+
+    std::array<Point3d, 8> hexah;
+
+    Fuser fs(mp);
+    fs.divideSpaceFromSfM(sfmData, &hexah[0], 2, 0.01f);
+
+    StaticVector<int> cams;
+    cams.resize(mp.getNbCameras());
+    for (int i = 0; i < cams.size(); ++i)
+        cams[i] = i;
+
+    const std::string tempDirPath = boost::filesystem::temp_directory_path().generic_string();
+
+    DelaunayGraphCut delaunayGC(mp);
+    const float minDist = (hexah[0] - hexah[1]).size() / 1000.0f;
+    delaunayGC.addPointsFromCameraCenters(cams, minDist);
+    delaunayGC.addPointsFromSfM(&hexah[0], cams, sfmData);
+
+    delaunayGC.computeDelaunay();
+    delaunayGC.voteFullEmptyScore(cams, tempDirPath + "/");
+
+    // maxflow clears the cells info, compute each algorithm on the same votes
+    const std::vector<GC_cellInfo> cellsAttr = delaunayGC._cellsAttr;
+
+    mp.userParams.put("delaunaycut.maxflowAlgorithm", EMaxFlowAlgorithm_enumToString(EMaxFlowAlgorithm::BOYKOV_KOLMOGOROV));
+    delaunayGC.maxflow();
+    const std::vector<bool> cellIsFullBK = delaunayGC._cellIsFull;
+
+    delaunayGC._cellsAttr = cellsAttr;
+    mp.userParams.put("delaunaycut.maxflowAlgorithm", EMaxFlowAlgorithm_enumToString(EMaxFlowAlgorithm::PARALLEL_PUSH_RELABEL));
+    delaunayGC.maxflow();
+    const std::vector<bool> cellIsFullPR = delaunayGC._cellIsFull;
+
+    BOOST_CHECK_EQUAL(cellIsFullBK.size(), cellsAttr.size());
+    BOOST_CHECK(cellIsFullBK == cellIsFullPR);
+}
+
 /**
  * @brief Generate syntesize dataset with succesion of n(size) alignaed regular thetraedron and two camera on the last thetrahedron.
  * 
@@ -0,0 +1,201 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthMapCache.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsData/Point2d.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+
+#include <algorithm>
+#include <queue>
+
+namespace aliceVision {
+namespace fuseCut {
+
+DepthMapCache::DepthMapCache(const mvsUtils::MultiViewParams& mp,
+                             std::size_t maxMemory,
+                             mvsUtils::EFileType depthMapType,
+                             mvsUtils::EFileType simMapType)
+  : _mp(mp)
+  , _maxMemory(maxMemory)
+  , _depthMapType(depthMapType)
+  , _simMapType(simMapType)
+{}
+
+std::shared_ptr<const CachedDepthMap> DepthMapCache::request(int camId)
+{
+    Entry entry;
+    std::promise<std::shared_ptr<const CachedDepthMap>> promise;
+    bool mustLoad = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _entries.find(camId);
+
+        if(it != _entries.end())
+        {
+            ++_nbHits;
+            entry = it->second.data;
+
+            // move to front (most recently used)
+            _lruCamIds.splice(_lruCamIds.begin(), _lruCamIds, it->second.lruPosition);
+        }
+        else
+        {
+            // add a pending entry, other requests of this camera wait for the loading
+            ++_nbLoads;
+            entry = promise.get_future().share();
+            _lruCamIds.push_front(camId);
+            _entries.emplace(camId, CacheEntry{entry, 0, _lruCamIds.begin()});
+            mustLoad = true;
+        }
+    }
+
+    if(mustLoad)
+    {
+        std::shared_ptr<const CachedDepthMap> data;
+
+        try
+        {
+            data = load(camId);
+        }
+        catch(...)
+        {
+            promise.set_exception(std::current_exception());
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(camId);
+            _lruCamIds.erase(it->second.lruPosition);
+            _entries.erase(it);
+            throw;
+        }
+
+        promise.set_value(data);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _entries.find(camId);
+
+        if(it != _entries.end())
+        {
+            it->second.memorySize = data->getMemorySize();
+            _memorySize += it->second.memorySize;
+        }
+
+        evict();
+    }
+
+    return entry.get();
+}
+
+std::shared_ptr<const CachedDepthMap> DepthMapCache::load(int camId) const
+{
+    ALICEVISION_LOG_TRACE("Add depth map on cache (id: " << camId << ", view id: " << _mp.getViewId(camId) << ").");
+
+    auto data = std::make_shared<CachedDepthMap>();
+
+    image::Image<float> simMap;
+    mvsUtils::readMap(camId, _mp, _depthMapType, data->depthMap);
+    mvsUtils::readMap(camId, _mp, _simMapType, simMap);
+
+    // only keep the weak support information of the similarity map
+    data->wspMask.resize(simMap.Width(), simMap.Height());
+    for(std::size_t i = 0; i < simMap.size(); ++i)
+        data->wspMask(i) = (simMap(i) >= 1.0f) ? 1 : 0;
+
+    const image::Image<float>& depthMap = data->depthMap;
+    const int nbDepthValues = std::count_if(depthMap.data(), depthMap.data() + depthMap.size(), [](float v) { return v > 0.0f; });
+
+    data->points.reserve(nbDepthValues);
+
+    for(int y = 0; y < depthMap.Height(); ++y)
+    {
+        for(int x = 0; x < depthMap.Width(); ++x)
+        {
+            const float depth = depthMap(y, x);
+
+            if(depth > 0.0f)
+            {
+                data->points.push_back(_mp.CArr[camId] + (_mp.iCamArr[camId] * Point2d((float)x, (float)y)).normalize() * depth);
+            }
+        }
+    }
+
+    return data;
+}
+
+void DepthMapCache::evict()
+{
+    auto it = _lruCamIds.end();
+
+    while(_memorySize > _maxMemory && it != _lruCamIds.begin())
+    {
+        --it;
+
+        auto entryIt = _entries.find(*it);
+
+        // pending entry, not loaded yet
+        if(entryIt->second.memorySize == 0)
+            continue;
+
+        _memorySize -= entryIt->second.memorySize;
+        _entries.erase(entryIt);
+        it = _lruCamIds.erase(it);
+    }
+}
+
+std::vector<int> getNeighbourAwareCamsOrder(const mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, int nNearestCams)
+{
+    std::vector<bool> toProcess(mp.ncams, false);
+    std::vector<bool> visited(mp.ncams, false);
+
+    for(int rc : cams)
+        toProcess.at(rc) = true;
+
+    std::vector<int> orderedCams;
+    orderedCams.reserve(cams.size());
+
+    // breadth-first traversal of the nearest cameras graph
+    // each connected component is seeded in the input order
+    for(int seed : cams)
+    {
+        if(visited.at(seed))
+            continue;
+
+        std::queue<int> queue;
+        queue.push(seed);
+        visited.at(seed) = true;
+
+        while(!queue.empty())
+        {
+            const int rc = queue.front();
+            queue.pop();
+            orderedCams.push_back(rc);
+
+            const StaticVector<int> tcams = mp.findNearestCamsFromLandmarks(rc, nNearestCams);
+
+            for(int c = 0; c < tcams.size(); ++c)
+            {
+                const int tc = tcams[c];
+
+                if(toProcess.at(tc) && !visited.at(tc))
+                {
+                    visited.at(tc) = true;
+                    queue.push(tc);
+                }
+            }
+        }
+    }
+
+    return orderedCams;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
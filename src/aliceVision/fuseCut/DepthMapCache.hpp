@@ -0,0 +1,131 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/// Default maximum memory of the depth maps cache in bytes
+constexpr std::size_t defaultDepthMapCacheMemory = std::size_t(2) * 1024 * 1024 * 1024;
+
+/**
+ * @brief Depth data of a camera used by the depth maps filtering.
+ */
+struct CachedDepthMap
+{
+    image::Image<float> depthMap;
+    /// weak support pixels mask (similarity >= 1), the similarity values are not used by the filtering
+    image::Image<unsigned char> wspMask;
+    /// 3d points of the valid depth map pixels, in row-major pixel order,
+    /// in double precision as the world coordinates can be large (georeferenced scenes)
+    std::vector<Point3d> points;
+
+    /// memory footprint in bytes
+    std::size_t getMemorySize() const
+    {
+        return depthMap.size() * sizeof(float) + wspMask.size() * sizeof(unsigned char) + points.size() * sizeof(Point3d);
+    }
+};
+
+/**
+ * @class DepthMapCache
+ * @brief LRU cache of fullsize depth maps data bounded in memory.
+ * @note Thread-safe: a camera requested by several threads at the same time is loaded once,
+ *       returned entries stay valid after their eviction from the cache.
+ */
+class DepthMapCache
+{
+public:
+
+    /**
+     * @param[in] mp the multi-view parameters
+     * @param[in] maxMemory the maximum memory used by the cached maps in bytes
+     * @param[in] depthMapType the depth map fileType enum
+     * @param[in] simMapType the similarity map fileType enum
+     */
+    DepthMapCache(const mvsUtils::MultiViewParams& mp,
+                  std::size_t maxMemory,
+                  mvsUtils::EFileType depthMapType = mvsUtils::EFileType::depthMap,
+                  mvsUtils::EFileType simMapType = mvsUtils::EFileType::simMap);
+
+    // no copy constructor
+    DepthMapCache(DepthMapCache const&) = delete;
+
+    // no copy operator
+    void operator=(DepthMapCache const&) = delete;
+
+    /**
+     * @brief Get the given camera depth data, load it if needed.
+     * @param[in] camId the camera index
+     * @return the camera depth data
+     */
+    std::shared_ptr<const CachedDepthMap> request(int camId);
+
+    /// number of requests served from memory
+    std::size_t getNbHits() const { return _nbHits; }
+
+    /// number of requests loaded from disk
+    std::size_t getNbLoads() const { return _nbLoads; }
+
+private:
+    using Entry = std::shared_future<std::shared_ptr<const CachedDepthMap>>;
+
+    struct CacheEntry
+    {
+        Entry data;
+        std::size_t memorySize = 0;          //< 0 while the entry is loading
+        std::list<int>::iterator lruPosition; //< position in the LRU list
+    };
+
+    /**
+     * @brief Read the given camera depth/similarity maps and compute the weak support mask and the 3d points.
+     */
+    std::shared_ptr<const CachedDepthMap> load(int camId) const;
+
+    /**
+     * @brief Remove the least recently used loaded entries until the memory limit is satisfied.
+     * @note Should be called with the cache mutex locked.
+     */
+    void evict();
+
+    const mvsUtils::MultiViewParams& _mp;
+    const std::size_t _maxMemory;
+    const mvsUtils::EFileType _depthMapType;
+    const mvsUtils::EFileType _simMapType;
+
+    std::mutex _mutex;
+    std::unordered_map<int, CacheEntry> _entries; //< camera index => cache entry
+    std::list<int> _lruCamIds;                    //< most recently used first
+    std::size_t _memorySize = 0;
+    std::size_t _nbHits = 0;
+    std::size_t _nbLoads = 0;
+};
+
+/**
+ * @brief Get a cameras processing order following the nearest cameras graph.
+ * @note Consecutive cameras share most of their nearest cameras, which maximizes cache reuse.
+ * @param[in] mp the multi-view parameters
+ * @param[in] cams the cameras to process
+ * @param[in] nNearestCams the number of nearest cameras
+ * @return the ordered list of cameras
+ */
+std::vector<int> getNeighbourAwareCamsOrder(const mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, int nNearestCams);
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,203 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/DepthMapCache.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutDepthMapCache
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+namespace fs = boost::filesystem;
+
+namespace {
+
+const int imageWidth = 40;
+const int imageHeight = 30;
+const int nbCameras = 4;
+
+/**
+ * @brief Scene of cameras along the X axis.
+ */
+sfmData::SfMData createScene()
+{
+    sfmData::SfMData sfmData;
+    sfmData.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(imageWidth, imageHeight, 50.0, 50.0, 0.0, 0.0));
+
+    for(IndexT viewId = 0; viewId < nbCameras; ++viewId)
+    {
+        sfmData.getViews().emplace(viewId, std::make_shared<sfmData::View>("", viewId, 0, viewId, imageWidth, imageHeight));
+        sfmData.setPose(sfmData.getView(viewId), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(viewId, 0.0, 0.0))));
+    }
+    return sfmData;
+}
+
+/**
+ * @brief Write depth/similarity maps of the same size for all the cameras.
+ */
+void writeMaps(const mvsUtils::MultiViewParams& mp)
+{
+    for(int c = 0; c < mp.getNbCameras(); ++c)
+    {
+        image::Image<float> depthMap(imageWidth, imageHeight);
+        image::Image<float> simMap(imageWidth, imageHeight);
+
+        for(int y = 0; y < imageHeight; ++y)
+        {
+            for(int x = 0; x < imageWidth; ++x)
+            {
+                depthMap(y, x) = (x % 7 == 0) ? -1.0f : 5.0f + 0.1f * c + 0.01f * x;
+                simMap(y, x) = (y % 5 == 0) ? 1.0f : -0.5f;
+            }
+        }
+        mvsUtils::writeMap(c, mp, mvsUtils::EFileType::depthMap, depthMap);
+        mvsUtils::writeMap(c, mp, mvsUtils::EFileType::simMap, simMap);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fuseCut_depthMapCache_load)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMapCache_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createScene();
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+    writeMaps(mp);
+
+    DepthMapCache cache(mp, std::numeric_limits<std::size_t>::max());
+
+    const int c = 2;
+    const std::shared_ptr<const CachedDepthMap> data = cache.request(c);
+
+    BOOST_CHECK_EQUAL(data->depthMap.Width(), imageWidth);
+    BOOST_CHECK_EQUAL(data->depthMap.Height(), imageHeight);
+    BOOST_CHECK_EQUAL(data->wspMask.Width(), imageWidth);
+    BOOST_CHECK_EQUAL(data->wspMask.Height(), imageHeight);
+
+    std::size_t i = 0;
+    for(int y = 0; y < imageHeight; ++y)
+    {
+        for(int x = 0; x < imageWidth; ++x)
+        {
+            BOOST_CHECK_EQUAL(int(data->wspMask(y, x)), (y % 5 == 0) ? 1 : 0);
+
+            const float depth = data->depthMap(y, x);
+            if(depth <= 0.0f)
+                continue;
+
+            // points are back-projected in row-major pixel order
+            BOOST_REQUIRE_LT(i, data->points.size());
+            const Point3d p = mp.backproject(c, Point2d(x, y), depth);
+            BOOST_CHECK_SMALL(data->points[i].x - p.x, 1e-9);
+            BOOST_CHECK_SMALL(data->points[i].y - p.y, 1e-9);
+            BOOST_CHECK_SMALL(data->points[i].z - p.z, 1e-9);
+            ++i;
+        }
+    }
+    BOOST_CHECK_EQUAL(i, data->points.size());
+
+    // second request is served from memory
+    BOOST_CHECK_EQUAL(cache.request(c).get(), data.get());
+    BOOST_CHECK_EQUAL(cache.getNbLoads(), 1);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_depthMapCache_eviction)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMapCache_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createScene();
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+    writeMaps(mp);
+
+    // all the cameras have the same memory footprint
+    std::size_t entrySize = 0;
+    {
+        DepthMapCache cache(mp, std::numeric_limits<std::size_t>::max());
+        entrySize = cache.request(0)->getMemorySize();
+    }
+    BOOST_REQUIRE_GT(entrySize, 0);
+
+    // room for 2 cameras
+    DepthMapCache cache(mp, 2 * entrySize + entrySize / 2);
+
+    const std::shared_ptr<const CachedDepthMap> data0 = cache.request(0);
+    cache.request(1);
+    cache.request(2); // evicts 0, the least recently used
+    BOOST_CHECK_EQUAL(cache.getNbLoads(), 3);
+
+    cache.request(1); // hit, 2 becomes the least recently used
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+
+    // evicted entries stay valid for their owners
+    BOOST_CHECK_EQUAL(data0->depthMap.Width(), imageWidth);
+
+    const std::shared_ptr<const CachedDepthMap> reloaded0 = cache.request(0); // reload, evicts 2
+    BOOST_CHECK_EQUAL(cache.getNbLoads(), 4);
+    BOOST_CHECK_NE(reloaded0.get(), data0.get());
+
+    cache.request(1); // hit
+    cache.request(0); // hit
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 3);
+
+    cache.request(2); // reload
+    BOOST_CHECK_EQUAL(cache.getNbLoads(), 5);
+
+    // memory limit smaller than a single camera: each request reloads
+    DepthMapCache smallCache(mp, entrySize / 2);
+    smallCache.request(3);
+    smallCache.request(3);
+    BOOST_CHECK_EQUAL(smallCache.getNbLoads(), 2);
+    BOOST_CHECK_EQUAL(smallCache.getNbHits(), 0);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_depthMapCache_concurrentRequests)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMapCache_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createScene();
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+    writeMaps(mp);
+
+    DepthMapCache cache(mp, std::numeric_limits<std::size_t>::max());
+
+    const int nbRequests = 64;
+    std::vector<const CachedDepthMap*> results(nbRequests, nullptr);
+
+    // concurrent requests of the same cameras wait for a single load
+    #pragma omp parallel for
+    for(int i = 0; i < nbRequests; ++i)
+        results[i] = cache.request(i % 2).get();
+
+    BOOST_CHECK_EQUAL(cache.getNbLoads(), 2);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), nbRequests - 2);
+
+    for(int i = 0; i < nbRequests; ++i)
+        BOOST_CHECK_EQUAL(results[i], results[i % 2]);
+
+    fs::remove_all(folder);
+}
@@ -61,12 +61,12 @@ Fuser::~Fuser()
  * @param[in]
  * @param[out] numOfPtsMap
  * @param[in] depthMap
- * @param[in] simMap
+ * @param[in] wspMask: weak support pixels mask
  * @param[in] scale
  */
-bool Fuser::updateInSurr(float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc,
+bool Fuser::updateInSurr(float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, const Point3d& p, int rc, int tc,
                          StaticVector<int>* numOfPtsMap,
-                         const image::Image<float>& depthMap, const image::Image<float>& simMap,
+                         const image::Image<float>& depthMap, const image::Image<unsigned char>& wspMask,
                            int scale)
 {
     int w =_mp.getWidth(rc) / scale;
@@ -87,8 +87,7 @@ bool Fuser::updateInSurr(float pixToleranceFactor, int pixSizeBall, int pixSizeB
 
     int d = pixSizeBall;
 
-    const float sim = simMap(cell.y, cell.x);
-    if(sim >= 1.0f)
+    if(wspMask(cell.y, cell.x))
     {
         d = pixSizeBallWSP;
     }
@@ -117,22 +116,30 @@ bool Fuser::updateInSurr(float pixToleranceFactor, int pixSizeBall, int pixSizeB
 }
 
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
-void Fuser::filterGroups(const std::vector<int>& cams, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams)
+void Fuser::filterGroups(const std::vector<int>& cams, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams, std::size_t maxCacheMemory)
 {
     ALICEVISION_LOG_INFO("Precomputing groups.");
     long t1 = clock();
-#pragma omp parallel for
-    for(int c = 0; c < cams.size(); c++)
+
+    // each depth map is used by the R camera and by its nearest cameras,
+    // process cameras following the nearest cameras graph to reuse cached depth maps
+    const std::vector<int> orderedCams = getNeighbourAwareCamsOrder(_mp, cams, nNearestCams);
+    DepthMapCache depthMapCache(_mp, maxCacheMemory);
+
+    // dynamic schedule: threads process neighbouring cameras at the same time
+#pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < orderedCams.size(); c++)
     {
-        int rc = cams[c];
-        filterGroupsRC(rc, pixToleranceFactor, pixSizeBall, pixSizeBallWSP, nNearestCams);
+        int rc = orderedCams[c];
+        filterGroupsRC(rc, pixToleranceFactor, pixSizeBall, pixSizeBallWSP, nNearestCams, depthMapCache);
     }
 
+    ALICEVISION_LOG_INFO("Depth maps cache: " << depthMapCache.getNbLoads() << " loads, " << depthMapCache.getNbHits() << " hits.");
     mvsUtils::printfElapsedTime(t1);
 }
 
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
-bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams)
+bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams, DepthMapCache& depthMapCache)
 {
     if (bfs::exists(getFileNameFromIndex(_mp, rc, mvsUtils::EFileType::nmodMap)))
     {
@@ -143,20 +150,18 @@ bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, in
     int w = _mp.getWidth(rc);
     int h = _mp.getHeight(rc);
 
-    image::Image<float> depthMap;
-    image::Image<float> simMap;
-
-    // read depth/sim maps from depthMapEstimation folder
-    mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::depthMap, depthMap);
-    mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::simMap, simMap);
+    // get depth map and weak support mask from depthMapEstimation folder
+    const std::shared_ptr<const CachedDepthMap> rcMaps = depthMapCache.request(rc);
+    const image::Image<float>& depthMap = rcMaps->depthMap;
+    const image::Image<unsigned char>& wspMask = rcMaps->wspMask;
 
     image::Image<unsigned char> numOfModalsMap(w, h, true, 0);
 
-    if ((depthMap.size() != w * h) || (simMap.size() != w * h))
+    if ((depthMap.size() != w * h) || (wspMask.size() != w * h))
     {
         std::stringstream s;
         s << "filterGroupsRC: bad image dimension for camera: " << _mp.getViewId(rc) << "\n";
-        s << "depthMap size: " << depthMap.size() << ", simMap size: " << simMap.size() << ", width: " << w << ", height: " << h;
+        s << "depthMap size: " << depthMap.size() << ", simMap size: " << wspMask.size() << ", width: " << w << ", height: " << h;
        throw std::runtime_error(s.str());
     }
 
@@ -171,25 +176,14 @@ bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, in
         numOfPtsMap->resize_with(w * h, 0);
         int tc = tcams[c];
 
-        image::Image<float> tcdepthMap;
-
-        // read Tc depth map from depthMapEstimation folder
-        mvsUtils::readMap(tc, _mp, mvsUtils::EFileType::depthMap, tcdepthMap);
+        // get Tc depth map 3d points from depthMapEstimation folder
+        const std::shared_ptr<const CachedDepthMap> tcMaps = depthMapCache.request(tc);
 
-        if (tcdepthMap.Height() > 0 && tcdepthMap.Width() > 0)
+        if (tcMaps->depthMap.Height() > 0 && tcMaps->depthMap.Width() > 0)
         {
-            for(int y = 0; y < tcdepthMap.Height(); ++y)
+            for(const Point3d& p : tcMaps->points)
             {
-                for(int x = 0; x < tcdepthMap.Width(); ++x)
-                {
-                    float depth = tcdepthMap(y, x);
-
-                    if(depth > 0.0f)
-                    {
-                      Point3d p = _mp.CArr[tc] + (_mp.iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
-                      updateInSurr(pixToleranceFactor, pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, depthMap, simMap, 1);
-                    }
-                }
+                updateInSurr(pixToleranceFactor, pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, depthMap, wspMask, 1);
             }
 
             for(int i = 0; i < w * h; i++)
@@ -509,6 +503,51 @@ void Fuser::divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize)
     ALICEVISION_LOG_INFO("Estimate space done.");
 }
 
+int Fuser::sampleDepthMapsPoints(const Point3d* hexah, std::size_t maxPoints, std::vector<Point3d>& out_points) const
+{
+    const unsigned long npset = computeNumberOfAllPoints(_mp, 0);
+    const int stepPts = std::max(1, static_cast<int>(npset / std::max(maxPoints, std::size_t(1))));
+
+    std::vector<std::vector<Point3d>> camsPoints(_mp.ncams);
+
+#pragma omp parallel for schedule(dynamic)
+    for(int rc = 0; rc < _mp.ncams; ++rc)
+    {
+        const int w = _mp.getWidth(rc);
+
+        image::Image<float> depthMap;
+        mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::depthMapFiltered, depthMap);
+
+        std::vector<Point3d>& camPoints = camsPoints[rc];
+
+        for(int i = 0; i < depthMap.size(); i += stepPts)
+        {
+            const float depth = depthMap(i);
+            if(depth <= 0.0f)
+                continue;
+
+            const int x = i % w;
+            const int y = i / w;
+            const Point3d p = _mp.CArr[rc] + (_mp.iCamArr[rc] * Point2d((float)x, (float)y)).normalize() * depth;
+
+            if(mvsUtils::isPointInHexahedron(p, hexah))
+                camPoints.push_back(p);
+        }
+    }
+
+    // concatenate in cameras order to be independent of the threads scheduling
+    out_points.clear();
+    for(std::vector<Point3d>& camPoints : camsPoints)
+    {
+        out_points.insert(out_points.end(), camPoints.begin(), camPoints.end());
+        std::vector<Point3d>().swap(camPoints);
+    }
+
+    ALICEVISION_LOG_INFO("Sampled " << out_points.size() << " depth map points (step: " << stepPts << ").");
+
+    return stepPts;
+}
+
 bool checkLandmarkMinObservationAngle(const sfmData::SfMData& sfmData, const sfmData::Landmark& landmark, float minObservationAngle)
 {
   for(const auto& observationPairI : landmark.observations)
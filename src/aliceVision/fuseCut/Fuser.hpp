@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/image/Image.hpp>
+#include <aliceVision/fuseCut/DepthMapCache.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
@@ -28,14 +29,24 @@ public:
 
     // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,... default 3
     // pixSizeBall = default 2
-    void filterGroups(const std::vector<int>& cams, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams);
-    bool filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams);
+    // maxCacheMemory: maximum memory in bytes of the depth/sim maps cache shared by the processed cameras
+    void filterGroups(const std::vector<int>& cams, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams, std::size_t maxCacheMemory = defaultDepthMapCacheMemory);
+    bool filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, int nNearestCams, DepthMapCache& depthMapCache);
     void filterDepthMaps(const std::vector<int>& cams, int minNumOfModals, int minNumOfModalsWSP2SSP);
     bool filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2SSP);
 
     void divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize);
     void divideSpaceFromSfM(const sfmData::SfMData& sfmData, Point3d* hexah, std::size_t minObservations = 0, float minObservationAngle = 0.0f) const;
 
+    /**
+     * @brief Sample the filtered depth maps points located inside the given hexahedron.
+     * @param[in] hexah the hexahedron
+     * @param[in] maxPoints the approximate maximum number of points sampled in all the depth maps
+     * @param[out] out_points the sampled points
+     * @return the sampling step: each sampled point stands for this number of depth map points
+     */
+    int sampleDepthMapsPoints(const Point3d* hexah, std::size_t maxPoints, std::vector<Point3d>& out_points) const;
+
     /// @brief Compute average pixel size in the given hexahedron
     float computeAveragePixelSizeInHexahedron(Point3d* hexah, int step, int scale);
     float computeAveragePixelSizeInHexahedron(Point3d* hexah, const sfmData::SfMData& sfmData);
@@ -43,8 +54,8 @@ public:
     Voxel estimateDimensions(Point3d* vox, Point3d* newSpace, int scale, int maxOcTreeDim, const sfmData::SfMData* sfmData = nullptr);
 
 private:
-    bool updateInSurr(float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, StaticVector<int>* numOfPtsMap,
-                      const image::Image<float>& depthMap, const image::Image<float>& simMap, int scale);
+    bool updateInSurr(float pixToleranceFactor, int pixSizeBall, int pixSizeBallWSP, const Point3d& p, int rc, int tc, StaticVector<int>* numOfPtsMap,
+                      const image::Image<float>& depthMap, const image::Image<unsigned char>& wspMask, int scale);
 };
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams& mp, int scale);
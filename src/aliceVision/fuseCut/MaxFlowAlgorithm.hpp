@@ -0,0 +1,60 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Max-flow / min-cut algorithm used for the graph-cut meshing.
+ */
+enum class EMaxFlowAlgorithm
+{
+  BOYKOV_KOLMOGOROV = 0,   //< sequential Boykov-Kolmogorov on adjacency lists (MaxFlow_AdjList)
+  PARALLEL_PUSH_RELABEL    //< multi-threaded push-relabel on a compressed sparse row graph (MaxFlow_PushRelabel)
+};
+
+inline std::string EMaxFlowAlgorithm_enumToString(EMaxFlowAlgorithm algorithm)
+{
+  switch(algorithm)
+  {
+    case EMaxFlowAlgorithm::BOYKOV_KOLMOGOROV:
+      return "boykovKolmogorov";
+    case EMaxFlowAlgorithm::PARALLEL_PUSH_RELABEL:
+      return "parallelPushRelabel";
+  }
+  throw std::out_of_range("Invalid max-flow algorithm enum");
+}
+
+inline EMaxFlowAlgorithm EMaxFlowAlgorithm_stringToEnum(const std::string& algorithm)
+{
+  if(algorithm == "boykovKolmogorov")
+    return EMaxFlowAlgorithm::BOYKOV_KOLMOGOROV;
+  if(algorithm == "parallelPushRelabel")
+    return EMaxFlowAlgorithm::PARALLEL_PUSH_RELABEL;
+  throw std::out_of_range("Invalid max-flow algorithm string " + algorithm);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EMaxFlowAlgorithm e)
+{
+    return os << EMaxFlowAlgorithm_enumToString(e);
+}
+
+inline std::istream& operator>>(std::istream& in, EMaxFlowAlgorithm& algorithm)
+{
+    std::string token;
+    in >> token;
+    algorithm = EMaxFlowAlgorithm_stringToEnum(token);
+    return in;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,433 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MaxFlow_PushRelabel.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/atomic/atomic_ref.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace {
+
+/// number of relabels (relative to the number of nodes) between two global relabels
+constexpr double globalRelabelFrequency = 0.5;
+
+template<typename T>
+inline T atomicLoad(T& value)
+{
+    return boost::atomic_ref<T>{value}.load(boost::memory_order_relaxed);
+}
+
+template<typename T>
+inline void atomicStore(T& value, T newValue)
+{
+    boost::atomic_ref<T>{value}.store(newValue, boost::memory_order_relaxed);
+}
+
+template<typename T>
+inline T atomicFetchAdd(T& value, T delta)
+{
+    return boost::atomic_ref<T>{value}.fetch_add(delta, boost::memory_order_relaxed);
+}
+
+template<typename T>
+inline T atomicFetchSub(T& value, T delta)
+{
+    return boost::atomic_ref<T>{value}.fetch_sub(delta, boost::memory_order_relaxed);
+}
+
+/**
+ * @brief Concatenate per-thread node lists.
+ */
+void mergeNodeLists(std::vector<std::vector<unsigned int>>& threadLists, std::vector<unsigned int>& out_nodes)
+{
+    std::size_t size = 0;
+    for(const auto& threadList : threadLists)
+        size += threadList.size();
+
+    out_nodes.clear();
+    out_nodes.reserve(size);
+
+    for(auto& threadList : threadLists)
+    {
+        out_nodes.insert(out_nodes.end(), threadList.begin(), threadList.end());
+        threadList.clear();
+    }
+}
+
+} // namespace
+
+MaxFlow_PushRelabel::MaxFlow_PushRelabel(std::size_t numNodes)
+  : _numNodes(numNodes)
+  , _maxHeight(static_cast<unsigned int>(numNodes + 1))
+  , _terminalCapacities(numNodes, 0.0f)
+{
+    if(numNodes >= std::numeric_limits<NodeType>::max())
+        throw std::out_of_range("MaxFlow_PushRelabel: too many nodes (" + std::to_string(numNodes) + ").");
+}
+
+void MaxFlow_PushRelabel::buildGraph()
+{
+    const std::int64_t numNodes = _numNodes;
+
+    // count arcs per node (each input edge gives one arc on each side)
+    std::vector<ArcIndex> inputOffsets(_numNodes + 1, 0);
+
+    for(const InputEdge& edge : _inputEdges)
+    {
+        ++inputOffsets[edge.n1 + 1];
+        ++inputOffsets[edge.n2 + 1];
+    }
+
+    for(std::size_t n = 0; n < _numNodes; ++n)
+        inputOffsets[n + 1] += inputOffsets[n];
+
+    // fill arcs (head, capacity)
+    std::vector<std::pair<NodeType, ValueType>> inputArcs(inputOffsets.back());
+
+    {
+        std::vector<ArcIndex> cursors(inputOffsets.begin(), inputOffsets.end() - 1);
+
+        for(const InputEdge& edge : _inputEdges)
+        {
+            inputArcs[cursors[edge.n1]++] = {edge.n2, edge.capacity};
+            inputArcs[cursors[edge.n2]++] = {edge.n1, edge.reverseCapacity};
+        }
+    }
+
+    // release input edges
+    std::vector<InputEdge>().swap(_inputEdges);
+
+    // sort arcs of each node by head and merge parallel arcs
+    std::vector<ArcIndex> degrees(_numNodes, 0);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(std::int64_t n = 0; n < numNodes; ++n)
+    {
+        const auto first = inputArcs.begin() + inputOffsets[n];
+        const auto last = inputArcs.begin() + inputOffsets[n + 1];
+
+        if(first == last)
+            continue;
+
+        std::sort(first, last, [](const std::pair<NodeType, ValueType>& a, const std::pair<NodeType, ValueType>& b) { return a.first < b.first; });
+
+        auto out = first;
+        for(auto it = first + 1; it != last; ++it)
+        {
+            if(it->first == out->first)
+                out->second += it->second;
+            else
+                *(++out) = *it;
+        }
+        degrees[n] = std::distance(first, out) + 1;
+    }
+
+    // compact arcs
+    _offsets.assign(_numNodes + 1, 0);
+
+    for(std::size_t n = 0; n < _numNodes; ++n)
+        _offsets[n + 1] = _offsets[n] + degrees[n];
+
+    const std::size_t numArcs = _offsets.back();
+
+    _heads.resize(numArcs);
+    _residuals.resize(numArcs);
+    _reverseArcs.resize(numArcs);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(std::int64_t n = 0; n < numNodes; ++n)
+    {
+        for(ArcIndex i = 0; i < degrees[n]; ++i)
+        {
+            _heads[_offsets[n] + i] = inputArcs[inputOffsets[n] + i].first;
+            _residuals[_offsets[n] + i] = inputArcs[inputOffsets[n] + i].second;
+        }
+    }
+
+    // release input arcs
+    std::vector<std::pair<NodeType, ValueType>>().swap(inputArcs);
+    std::vector<ArcIndex>().swap(inputOffsets);
+
+    // find reverse arcs, arcs of each node are sorted by head
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(std::int64_t n = 0; n < numNodes; ++n)
+    {
+        for(ArcIndex a = _offsets[n]; a < _offsets[n + 1]; ++a)
+        {
+            const NodeType v = _heads[a];
+            const auto first = _heads.begin() + _offsets[v];
+            const auto last = _heads.begin() + _offsets[v + 1];
+            const auto it = std::lower_bound(first, last, static_cast<NodeType>(n));
+
+            assert(it != last && *it == n);
+            _reverseArcs[a] = std::distance(_heads.begin(), it);
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Max-flow graph: " << _numNodes << " nodes, " << numArcs << " arcs.");
+}
+
+void MaxFlow_PushRelabel::globalRelabel()
+{
+    const std::int64_t numNodes = _numNodes;
+    const int nbThreads = omp_get_max_threads();
+
+    std::vector<NodeType> frontier;
+    std::vector<std::vector<NodeType>> threadFrontiers(nbThreads);
+
+    // nodes connected to the sink are at distance 1 (the sink is at height 0)
+#pragma omp parallel for
+    for(std::int64_t n = 0; n < numNodes; ++n)
+    {
+        if(_sinkResiduals[n] > 0.0f)
+        {
+            _heights[n] = 1;
+            threadFrontiers[omp_get_thread_num()].push_back(n);
+        }
+        else
+        {
+            _heights[n] = _maxHeight;
+        }
+    }
+
+    mergeNodeLists(threadFrontiers, frontier);
+
+    // level-synchronous breadth-first search from the sink on the reverse residual graph
+    unsigned int level = 1;
+
+    while(!frontier.empty())
+    {
+        const std::int64_t frontierSize = frontier.size();
+
+#pragma omp parallel for schedule(dynamic, 256)
+        for(std::int64_t i = 0; i < frontierSize; ++i)
+        {
+            const NodeType v = frontier[i];
+            std::vector<NodeType>& nextFrontier = threadFrontiers[omp_get_thread_num()];
+
+            for(ArcIndex a = _offsets[v]; a < _offsets[v + 1]; ++a)
+            {
+                const NodeType w = _heads[a];
+
+                // arc w -> v should have residual capacity
+                if(_residuals[_reverseArcs[a]] <= 0.0f)
+                    continue;
+
+                unsigned int expected = _maxHeight;
+                if(atomicLoad(_heights[w]) == expected &&
+                   boost::atomic_ref<unsigned int>{_heights[w]}.compare_exchange_strong(expected, level + 1, boost::memory_order_relaxed))
+                {
+                    nextFrontier.push_back(w);
+                }
+            }
+        }
+
+        mergeNodeLists(threadFrontiers, frontier);
+        ++level;
+    }
+}
+
+void MaxFlow_PushRelabel::getActiveNodes(std::vector<NodeType>& out_activeNodes)
+{
+    const std::int64_t numNodes = _numNodes;
+    std::vector<std::vector<NodeType>> threadActiveNodes(omp_get_max_threads());
+
+#pragma omp parallel for
+    for(std::int64_t n = 0; n < numNodes; ++n)
+    {
+        _isNextActive[n] = 0;
+
+        if(_excesses[n] > 0.0f && _heights[n] < _maxHeight)
+            threadActiveNodes[omp_get_thread_num()].push_back(n);
+    }
+
+    mergeNodeLists(threadActiveNodes, out_activeNodes);
+}
+
+int MaxFlow_PushRelabel::discharge(NodeType u, std::vector<NodeType>& nextActiveNodes)
+{
+    atomicStore(_isNextActive[u], static_cast<unsigned char>(0));
+
+    // only the thread discharging u writes its height and its sink residual
+    unsigned int hu = _heights[u];
+    int nbRelabels = 0;
+
+    while(hu < _maxHeight)
+    {
+        const ValueType excess = atomicLoad(_excesses[u]);
+
+        if(excess <= 0.0f)
+            break;
+
+        // find the lowest neighbour in the residual graph (the sink has height 0)
+        unsigned int hMin = _maxHeight;
+        ArcIndex bestArc = 0;
+        bool toSink = false;
+
+        if(_sinkResiduals[u] > 0.0f)
+        {
+            hMin = 0;
+            toSink = true;
+        }
+        else
+        {
+            for(ArcIndex a = _offsets[u]; a < _offsets[u + 1]; ++a)
+            {
+                if(atomicLoad(_residuals[a]) <= 0.0f)
+                    continue;
+
+                const unsigned int hv = atomicLoad(_heights[_heads[a]]);
+                if(hv < hMin)
+                {
+                    hMin = hv;
+                    bestArc = a;
+                }
+            }
+        }
+
+        if(hu > hMin)
+        {
+            // push
+            if(toSink)
+            {
+                const ValueType delta = std::min(excess, _sinkResiduals[u]);
+                _sinkResiduals[u] -= delta;
+                atomicFetchSub(_excesses[u], delta);
+            }
+            else
+            {
+                const NodeType v = _heads[bestArc];
+                const ValueType delta = std::min(excess, atomicLoad(_residuals[bestArc]));
+
+                atomicFetchSub(_residuals[bestArc], delta);
+                atomicFetchAdd(_residuals[_reverseArcs[bestArc]], delta);
+                atomicFetchSub(_excesses[u], delta);
+
+                const ValueType previousExcess = atomicFetchAdd(_excesses[v], delta);
+
+                if(previousExcess <= 0.0f && boost::atomic_ref<unsigned char>{_isNextActive[v]}.exchange(1, boost::memory_order_relaxed) == 0)
+                    nextActiveNodes.push_back(v);
+            }
+        }
+        else
+        {
+            // relabel, the node is discharged again at the next pass
+            hu = (hMin >= _maxHeight) ? _maxHeight : hMin + 1;
+            atomicStore(_heights[u], hu);
+            ++nbRelabels;
+            break;
+        }
+    }
+
+    if(hu < _maxHeight && atomicLoad(_excesses[u]) > 0.0f &&
+       boost::atomic_ref<unsigned char>{_isNextActive[u]}.exchange(1, boost::memory_order_relaxed) == 0)
+    {
+        nextActiveNodes.push_back(u);
+    }
+
+    return nbRelabels;
+}
+
+MaxFlow_PushRelabel::ValueType MaxFlow_PushRelabel::compute()
+{
+    buildGraph();
+
+    const std::int64_t numNodes = _numNodes;
+
+    // initial preflow: saturate all source edges
+    _excesses.resize(_numNodes);
+    _sinkResiduals.resize(_numNodes);
+    _heights.resize(_numNodes);
+    _isNextActive.resize(_numNodes);
+
+#pragma omp parallel for
+    for(std::int64_t n = 0; n < numNodes; ++n)
+    {
+        _excesses[n] = std::max(_terminalCapacities[n], 0.0f);
+        _sinkResiduals[n] = std::max(-_terminalCapacities[n], 0.0f);
+    }
+
+    globalRelabel();
+
+    std::vector<NodeType> activeNodes;
+    getActiveNodes(activeNodes);
+
+    std::vector<std::vector<NodeType>> threadActiveNodes(omp_get_max_threads());
+    const std::size_t maxRelabels = static_cast<std::size_t>(globalRelabelFrequency * _numNodes) + 1;
+    std::size_t nbRelabels = 0;
+    std::size_t nbPasses = 0;
+    std::size_t nbGlobalRelabels = 1;
+
+    while(!activeNodes.empty())
+    {
+        const std::int64_t nbActiveNodes = activeNodes.size();
+        std::size_t passRelabels = 0;
+
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:passRelabels)
+        for(std::int64_t i = 0; i < nbActiveNodes; ++i)
+        {
+            passRelabels += discharge(activeNodes[i], threadActiveNodes[omp_get_thread_num()]);
+        }
+
+        ++nbPasses;
+        nbRelabels += passRelabels;
+
+        if(nbRelabels > maxRelabels)
+        {
+            for(auto& threadList : threadActiveNodes)
+                threadList.clear();
+
+            globalRelabel();
+            getActiveNodes(activeNodes);
+            nbRelabels = 0;
+            ++nbGlobalRelabels;
+        }
+        else
+        {
+            mergeNodeLists(threadActiveNodes, activeNodes);
+        }
+    }
+
+    // minimum cut: nodes which can still reach the sink in the residual graph
+    globalRelabel();
+
+    _isTarget.resize(_numNodes);
+    double flow = 0.0;
+
+    for(std::size_t n = 0; n < _numNodes; ++n)
+    {
+        _isTarget[n] = (_heights[n] < _maxHeight);
+        flow += std::max(-_terminalCapacities[n], 0.0f) - _sinkResiduals[n];
+    }
+
+    ALICEVISION_LOG_INFO("Max-flow push-relabel: " << nbPasses << " passes, " << nbGlobalRelabels << " global relabels.");
+
+    // release memory
+    std::vector<ArcIndex>().swap(_offsets);
+    std::vector<NodeType>().swap(_heads);
+    std::vector<ArcIndex>().swap(_reverseArcs);
+    std::vector<ValueType>().swap(_residuals);
+    std::vector<ValueType>().swap(_excesses);
+    std::vector<ValueType>().swap(_sinkResiduals);
+    std::vector<unsigned int>().swap(_heights);
+    std::vector<unsigned char>().swap(_isNextActive);
+
+    return static_cast<ValueType>(flow);
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
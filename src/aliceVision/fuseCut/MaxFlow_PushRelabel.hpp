@@ -0,0 +1,130 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Maxflow computation based on a multi-threaded push-relabel algorithm.
+ *
+ * The graph is stored as a compressed sparse row graph: one residual capacity, one head node
+ * and one reverse arc index per arc, parallel arcs between the same nodes are merged.
+ * Source/sink edges are not stored as arcs: the source edges are saturated at initialization
+ * (initial excess) and the sink edges are stored as one residual capacity per node.
+ *
+ * Active nodes are discharged in parallel with the lock-free push-relabel of Hong (2008),
+ * with periodic parallel global relabeling (breadth-first search from the sink).
+ * Only the first phase of the push-relabel (maximum preflow) is computed, which is enough
+ * to get the minimum cut and the maximum flow value.
+ *
+ * @see MaxFlow_AdjList which uses the sequential Boykov-Kolmogorov algorithm.
+ */
+class MaxFlow_PushRelabel
+{
+public:
+    using NodeType = unsigned int;
+    using ValueType = float;
+    using ArcIndex = std::size_t;
+
+    explicit MaxFlow_PushRelabel(std::size_t numNodes);
+
+    inline void addNode(NodeType n, ValueType source, ValueType sink)
+    {
+        assert(source >= 0 && sink >= 0);
+        _terminalCapacities[n] = source - sink;
+    }
+
+    inline void addEdge(NodeType n1, NodeType n2, ValueType capacity, ValueType reverseCapacity)
+    {
+        assert(capacity >= 0 && reverseCapacity >= 0);
+
+        if(n1 == n2)
+            return; // self-loop, no impact on the cut
+
+        _inputEdges.push_back({n1, n2, capacity, reverseCapacity});
+    }
+
+    /**
+     * @brief Compute the maximum flow and the minimum cut.
+     * @return the maximum flow value
+     */
+    ValueType compute();
+
+    /// is empty
+    inline bool isSource(NodeType n) const
+    {
+        return !_isTarget[n];
+    }
+    /// is full
+    inline bool isTarget(NodeType n) const
+    {
+        return _isTarget[n];
+    }
+
+private:
+    struct InputEdge
+    {
+        NodeType n1;
+        NodeType n2;
+        ValueType capacity;
+        ValueType reverseCapacity;
+    };
+
+    /**
+     * @brief Build the compressed sparse row graph from the input edges.
+     */
+    void buildGraph();
+
+    /**
+     * @brief Set the exact distance to the sink of each node in the residual graph.
+     * @note Nodes which cannot reach the sink get the maximum height.
+     */
+    void globalRelabel();
+
+    /**
+     * @brief Get the list of active nodes: positive excess and sink reachable.
+     * @param[out] out_activeNodes the active nodes list
+     */
+    void getActiveNodes(std::vector<NodeType>& out_activeNodes);
+
+    /**
+     * @brief Push the excess of the given node until there is no more excess or the node is relabeled.
+     * @note Can be called concurrently on different nodes.
+     * @param[in] u the node to discharge
+     * @param[in,out] nextActiveNodes the nodes to discharge at the next pass
+     * @return the number of relabels (0 or 1)
+     */
+    int discharge(NodeType u, std::vector<NodeType>& nextActiveNodes);
+
+    const std::size_t _numNodes;
+    const unsigned int _maxHeight; //< height of nodes which cannot reach the sink
+
+    std::vector<InputEdge> _inputEdges;
+    std::vector<ValueType> _terminalCapacities; //< positive: source capacity, negative: sink capacity
+
+    // compressed sparse row graph
+    std::vector<ArcIndex> _offsets;      //< first arc of each node (size: numNodes + 1)
+    std::vector<NodeType> _heads;        //< arc head node
+    std::vector<ArcIndex> _reverseArcs;  //< arc reverse arc index
+    std::vector<ValueType> _residuals;   //< arc residual capacity
+
+    // push-relabel state
+    std::vector<ValueType> _excesses;
+    std::vector<ValueType> _sinkResiduals;
+    std::vector<unsigned int> _heights;
+    std::vector<unsigned char> _isNextActive;
+
+    std::vector<bool> _isTarget;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
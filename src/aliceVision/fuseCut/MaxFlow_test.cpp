@@ -0,0 +1,195 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutMaxFlow
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace {
+
+struct TestEdge
+{
+    unsigned int n1;
+    unsigned int n2;
+    float capacity;
+    float reverseCapacity;
+};
+
+struct TestGraph
+{
+    std::size_t nbNodes = 0;
+    std::vector<std::pair<float, float>> terminals; //< (source, sink) per node
+    std::vector<TestEdge> edges;
+};
+
+template<typename MaxFlowGraph>
+float computeMaxFlow(const TestGraph& graph, std::vector<bool>& out_isTarget)
+{
+    MaxFlowGraph maxFlowGraph(graph.nbNodes);
+
+    for(std::size_t n = 0; n < graph.nbNodes; ++n)
+        maxFlowGraph.addNode(n, graph.terminals[n].first, graph.terminals[n].second);
+
+    // each adjacency is added from both sides, as in DelaunayGraphCut::maxflow
+    for(const TestEdge& edge : graph.edges)
+    {
+        maxFlowGraph.addEdge(edge.n1, edge.n2, edge.capacity, edge.reverseCapacity);
+        maxFlowGraph.addEdge(edge.n2, edge.n1, edge.reverseCapacity, edge.capacity);
+    }
+
+    const float flow = maxFlowGraph.compute();
+
+    out_isTarget.resize(graph.nbNodes);
+    for(std::size_t n = 0; n < graph.nbNodes; ++n)
+        out_isTarget[n] = maxFlowGraph.isTarget(n);
+
+    return flow;
+}
+
+/**
+ * @brief Generate a 3d grid graph with 6-connectivity and integer capacities (exact float arithmetic).
+ */
+TestGraph generateGridGraph(int size, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> capacityDistribution(0, 20);
+    std::uniform_int_distribution<int> terminalDistribution(-30, 30);
+
+    TestGraph graph;
+    graph.nbNodes = size * size * size;
+    graph.terminals.resize(graph.nbNodes);
+
+    const auto index = [size](int x, int y, int z) { return static_cast<unsigned int>((z * size + y) * size + x); };
+
+    for(int z = 0; z < size; ++z)
+    {
+        for(int y = 0; y < size; ++y)
+        {
+            for(int x = 0; x < size; ++x)
+            {
+                const unsigned int n = index(x, y, z);
+                const int terminal = terminalDistribution(generator);
+                graph.terminals[n] = (terminal > 0) ? std::make_pair(float(terminal), 0.0f) : std::make_pair(0.0f, float(-terminal));
+
+                if(x + 1 < size)
+                    graph.edges.push_back({n, index(x + 1, y, z), float(capacityDistribution(generator)), float(capacityDistribution(generator))});
+                if(y + 1 < size)
+                    graph.edges.push_back({n, index(x, y + 1, z), float(capacityDistribution(generator)), float(capacityDistribution(generator))});
+                if(z + 1 < size)
+                    graph.edges.push_back({n, index(x, y, z + 1), float(capacityDistribution(generator)), float(capacityDistribution(generator))});
+            }
+        }
+    }
+
+    return graph;
+}
+
+/**
+ * @brief Generate a random graph of degree 4 (as tetrahedra adjacency) with sparse terminals.
+ */
+TestGraph generateRandomGraph(std::size_t nbNodes, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<unsigned int> nodeDistribution(0, nbNodes - 1);
+    std::uniform_int_distribution<int> capacityDistribution(0, 100);
+    std::uniform_int_distribution<int> terminalDistribution(-1000, 1000);
+    std::bernoulli_distribution hasTerminalDistribution(0.1);
+
+    TestGraph graph;
+    graph.nbNodes = nbNodes;
+    graph.terminals.resize(nbNodes, {0.0f, 0.0f});
+
+    for(std::size_t n = 0; n < nbNodes; ++n)
+    {
+        if(hasTerminalDistribution(generator))
+        {
+            const int terminal = terminalDistribution(generator);
+            graph.terminals[n] = (terminal > 0) ? std::make_pair(float(terminal), 0.0f) : std::make_pair(0.0f, float(-terminal));
+        }
+    }
+
+    for(std::size_t i = 0; i < 2 * nbNodes; ++i)
+    {
+        const unsigned int n1 = nodeDistribution(generator);
+        const unsigned int n2 = nodeDistribution(generator);
+
+        if(n1 != n2)
+            graph.edges.push_back({n1, n2, float(capacityDistribution(generator)), float(capacityDistribution(generator))});
+    }
+
+    return graph;
+}
+
+void checkSameMinCut(const TestGraph& graph)
+{
+    std::vector<bool> isTargetAdjList;
+    std::vector<bool> isTargetPushRelabel;
+
+    const float flowAdjList = computeMaxFlow<MaxFlow_AdjList>(graph, isTargetAdjList);
+    const float flowPushRelabel = computeMaxFlow<MaxFlow_PushRelabel>(graph, isTargetPushRelabel);
+
+    BOOST_CHECK_EQUAL(flowAdjList, flowPushRelabel);
+    BOOST_CHECK(isTargetAdjList == isTargetPushRelabel);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_simple)
+{
+    // S -> 0 (5), S -> 1 (3), 0 -> 1 (2), 0 -> 2 (2), 1 -> 2 (4), 2 -> T (7), 1 -> T (1)
+    MaxFlow_PushRelabel maxFlowGraph(3);
+
+    maxFlowGraph.addNode(0, 5.0f, 0.0f);
+    maxFlowGraph.addNode(1, 3.0f, 1.0f);
+    maxFlowGraph.addNode(2, 0.0f, 7.0f);
+    maxFlowGraph.addEdge(0, 1, 2.0f, 0.0f);
+    maxFlowGraph.addEdge(0, 2, 2.0f, 0.0f);
+    maxFlowGraph.addEdge(1, 2, 4.0f, 0.0f);
+
+    // node 1 source/sink capacities are merged: S -> 1 (2)
+    BOOST_CHECK_EQUAL(maxFlowGraph.compute(), 6.0f);
+
+    BOOST_CHECK(maxFlowGraph.isSource(0));
+    BOOST_CHECK(maxFlowGraph.isSource(1));
+    BOOST_CHECK(maxFlowGraph.isTarget(2));
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_isolatedNodes)
+{
+    MaxFlow_PushRelabel maxFlowGraph(4);
+
+    maxFlowGraph.addNode(0, 1.0f, 0.0f);
+    maxFlowGraph.addNode(1, 0.0f, 1.0f);
+    maxFlowGraph.addNode(3, 0.0f, 0.0f);
+
+    BOOST_CHECK_EQUAL(maxFlowGraph.compute(), 0.0f);
+
+    BOOST_CHECK(maxFlowGraph.isSource(0));
+    BOOST_CHECK(maxFlowGraph.isTarget(1));
+    BOOST_CHECK(maxFlowGraph.isSource(2));
+    BOOST_CHECK(maxFlowGraph.isSource(3));
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_gridGraph)
+{
+    for(unsigned int seed = 0; seed < 5; ++seed)
+        checkSameMinCut(generateGridGraph(20, seed));
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_randomGraph)
+{
+    for(unsigned int seed = 0; seed < 5; ++seed)
+        checkSameMinCut(generateRandomGraph(50000, seed));
+}
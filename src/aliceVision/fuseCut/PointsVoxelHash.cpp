@@ -0,0 +1,127 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PointsVoxelHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace aliceVision {
+namespace fuseCut {
+
+PointsVoxelHash::PointsVoxelHash(double pixSizeMarginCoef, std::size_t nbShards)
+  : _pixSizeMarginCoef(pixSizeMarginCoef)
+  , _nbShards(std::max(nbShards, std::size_t(1)))
+  , _shards(new Shard[_nbShards])
+{}
+
+PointsVoxelHash::VoxelKey PointsVoxelHash::getVoxelKey(const Point3d& p, double pixSize, float simScore) const
+{
+    // fusion radius, see filterByPixSize
+    const double radius = std::max(pixSize * std::sqrt(_pixSizeMarginCoef * simScore), std::numeric_limits<double>::min());
+
+    VoxelKey key;
+    key.level = std::ilogb(radius);
+
+    const double voxelSize = std::ldexp(1.0, key.level);
+    key.x = static_cast<std::int64_t>(std::floor(p.x / voxelSize));
+    key.y = static_cast<std::int64_t>(std::floor(p.y / voxelSize));
+    key.z = static_cast<std::int64_t>(std::floor(p.z / voxelSize));
+
+    return key;
+}
+
+void PointsVoxelHash::addPoint(const Point3d& p, double pixSize, float simScore, int cam)
+{
+    const VoxelKey key = getVoxelKey(p, pixSize, simScore);
+    Shard& shard = _shards[VoxelKeyHash()(key) % _nbShards];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.points.find(key);
+
+    if(it == shard.points.end())
+    {
+        FusedPoint& fusedPoint = shard.points[key];
+        fusedPoint.coords = p;
+        fusedPoint.pixSize = pixSize;
+        fusedPoint.simScore = simScore;
+        fusedPoint.bestCam = cam;
+        fusedPoint.cams.push_back(cam);
+        return;
+    }
+
+    FusedPoint& fusedPoint = it->second;
+    fusedPoint.cams.push_back_distinct(cam);
+
+    // keep the point with the smallest score, the camera index breaks ties to be independent of the insertion order
+    const double score = simScore * pixSize * pixSize;
+    const double fusedScore = fusedPoint.simScore * fusedPoint.pixSize * fusedPoint.pixSize;
+
+    if(score < fusedScore || (score == fusedScore && cam < fusedPoint.bestCam))
+    {
+        fusedPoint.coords = p;
+        fusedPoint.pixSize = pixSize;
+        fusedPoint.simScore = simScore;
+        fusedPoint.bestCam = cam;
+    }
+}
+
+std::size_t PointsVoxelHash::size() const
+{
+    std::size_t size = 0;
+
+    for(std::size_t i = 0; i < _nbShards; ++i)
+    {
+        std::lock_guard<std::mutex> lock(_shards[i].mutex);
+        size += _shards[i].points.size();
+    }
+
+    return size;
+}
+
+void PointsVoxelHash::extractPoints(std::vector<Point3d>& out_coords,
+                                    std::vector<double>& out_pixSize,
+                                    std::vector<float>& out_simScore,
+                                    std::vector<GC_vertexInfo>& out_verticesAttr)
+{
+    std::vector<std::pair<VoxelKey, FusedPoint>> points;
+    points.reserve(size());
+
+    for(std::size_t i = 0; i < _nbShards; ++i)
+    {
+        std::lock_guard<std::mutex> lock(_shards[i].mutex);
+
+        for(auto& it : _shards[i].points)
+            points.emplace_back(it.first, std::move(it.second));
+
+        std::unordered_map<VoxelKey, FusedPoint, VoxelKeyHash>().swap(_shards[i].points);
+    }
+
+    std::sort(points.begin(), points.end(), [](const std::pair<VoxelKey, FusedPoint>& a, const std::pair<VoxelKey, FusedPoint>& b) { return a.first < b.first; });
+
+    out_coords.resize(points.size());
+    out_pixSize.resize(points.size());
+    out_simScore.resize(points.size());
+    out_verticesAttr.resize(points.size());
+
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        FusedPoint& fusedPoint = points[i].second;
+        std::vector<int>& cams = fusedPoint.cams.getDataWritable();
+        std::sort(cams.begin(), cams.end());
+
+        out_coords[i] = fusedPoint.coords;
+        out_pixSize[i] = fusedPoint.pixSize;
+        out_simScore[i] = fusedPoint.simScore;
+        out_verticesAttr[i].cams = std::move(fusedPoint.cams);
+    }
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
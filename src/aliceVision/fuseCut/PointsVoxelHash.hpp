@@ -0,0 +1,130 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @class PointsVoxelHash
+ * @brief Concurrent spatial hash used to fuse depth map points on the fly.
+ *
+ * Each point is inserted in a voxel whose size depends on its fusion radius
+ * (pixSizeMarginCoef * simScore * pixSize^2, as in the pixel size filtering),
+ * rounded down to a power of two. Points falling in the same voxel are merged:
+ * the point with the best score (smallest simScore * pixSize^2) is kept and
+ * the cameras of all merged points are kept as visibilities.
+ *
+ * @note Thread-safe: the hash is split in independently locked shards.
+ */
+class PointsVoxelHash
+{
+public:
+    /**
+     * @param[in] pixSizeMarginCoef the pixel size margin coefficient used to define the fusion radius
+     * @param[in] nbShards the number of independently locked parts of the hash
+     */
+    explicit PointsVoxelHash(double pixSizeMarginCoef, std::size_t nbShards = 1024);
+
+    /**
+     * @brief Insert a point, merge it with the point of its voxel if any.
+     * @param[in] p the point coordinates
+     * @param[in] pixSize the point pixel size in the camera
+     * @param[in] simScore the point similarity score (lower is better)
+     * @param[in] cam the camera index
+     */
+    void addPoint(const Point3d& p, double pixSize, float simScore, int cam);
+
+    /**
+     * @brief Get the number of fused points.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Move the fused points out of the hash, the hash is empty afterwards.
+     * @note Points are sorted by voxel, so the output does not depend on the insertion order.
+     * @param[out] out_coords the points coordinates
+     * @param[out] out_pixSize the points pixel size
+     * @param[out] out_simScore the points similarity score
+     * @param[out] out_verticesAttr the points visibilities
+     */
+    void extractPoints(std::vector<Point3d>& out_coords,
+                       std::vector<double>& out_pixSize,
+                       std::vector<float>& out_simScore,
+                       std::vector<GC_vertexInfo>& out_verticesAttr);
+
+private:
+    struct VoxelKey
+    {
+        int level;
+        std::int64_t x;
+        std::int64_t y;
+        std::int64_t z;
+
+        bool operator==(const VoxelKey& other) const
+        {
+            return level == other.level && x == other.x && y == other.y && z == other.z;
+        }
+
+        bool operator<(const VoxelKey& other) const
+        {
+            if(level != other.level)
+                return level < other.level;
+            if(x != other.x)
+                return x < other.x;
+            if(y != other.y)
+                return y < other.y;
+            return z < other.z;
+        }
+    };
+
+    struct VoxelKeyHash
+    {
+        std::size_t operator()(const VoxelKey& key) const
+        {
+            std::uint64_t h = static_cast<std::uint64_t>(key.x) * 73856093ULL;
+            h ^= static_cast<std::uint64_t>(key.y) * 19349663ULL;
+            h ^= static_cast<std::uint64_t>(key.z) * 83492791ULL;
+            h ^= static_cast<std::uint64_t>(key.level) * 2654435761ULL;
+            return static_cast<std::size_t>(h ^ (h >> 29));
+        }
+    };
+
+    struct FusedPoint
+    {
+        Point3d coords;
+        double pixSize;
+        float simScore;
+        int bestCam;
+        StaticVector<int> cams;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<VoxelKey, FusedPoint, VoxelKeyHash> points;
+    };
+
+    VoxelKey getVoxelKey(const Point3d& p, double pixSize, float simScore) const;
+
+    const double _pixSizeMarginCoef;
+    const std::size_t _nbShards;
+    std::unique_ptr<Shard[]> _shards;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
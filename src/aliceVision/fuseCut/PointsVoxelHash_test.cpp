@@ -0,0 +1,137 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/PointsVoxelHash.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutPointsVoxelHash
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace {
+
+struct InputPoint
+{
+    Point3d p;
+    double pixSize;
+    float simScore;
+    int cam;
+};
+
+struct FusedPoints
+{
+    std::vector<Point3d> coords;
+    std::vector<double> pixSize;
+    std::vector<float> simScore;
+    std::vector<GC_vertexInfo> verticesAttr;
+};
+
+FusedPoints extract(PointsVoxelHash& pointsVoxelHash)
+{
+    FusedPoints fused;
+    pointsVoxelHash.extractPoints(fused.coords, fused.pixSize, fused.simScore, fused.verticesAttr);
+    return fused;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fuseCut_pointsVoxelHash_merge)
+{
+    // pixSizeMarginCoef * simScore = 1: the fusion radius is the pixel size
+    PointsVoxelHash pointsVoxelHash(1.0, 4);
+
+    // voxel (0, 0, 0) of size 1, score = simScore * pixSize^2
+    pointsVoxelHash.addPoint(Point3d(0.2, 0.3, 0.4), 1.0, 1.0f, 2);  // score 1
+    pointsVoxelHash.addPoint(Point3d(0.8, 0.9, 0.1), 1.2, 0.8f, 5);  // score 1.152, radius 1.07
+    pointsVoxelHash.addPoint(Point3d(0.5, 0.5, 0.5), 1.0, 1.0f, 0);  // score 1, wins the tie with a lower camera index
+    pointsVoxelHash.addPoint(Point3d(0.6, 0.6, 0.6), 1.0, 1.0f, 2);  // score 1, same camera
+    BOOST_CHECK_EQUAL(pointsVoxelHash.size(), 1);
+
+    // voxel (-1, 0, 0) of size 1
+    pointsVoxelHash.addPoint(Point3d(-0.2, 0.3, 0.4), 1.0, 1.0f, 1);
+    // voxel (0, 0, 0) of size 2, radius 3
+    pointsVoxelHash.addPoint(Point3d(0.3, 0.3, 0.3), 3.0, 1.0f, 3);
+    // voxel (0, 0, 0) of size 0.5, radius 0.9
+    pointsVoxelHash.addPoint(Point3d(0.3, 0.3, 0.3), 0.9, 1.0f, 4);
+    BOOST_CHECK_EQUAL(pointsVoxelHash.size(), 4);
+
+    const FusedPoints fused = extract(pointsVoxelHash);
+    BOOST_CHECK_EQUAL(pointsVoxelHash.size(), 0);
+    BOOST_REQUIRE_EQUAL(fused.coords.size(), 4);
+    BOOST_REQUIRE_EQUAL(fused.pixSize.size(), 4);
+    BOOST_REQUIRE_EQUAL(fused.simScore.size(), 4);
+    BOOST_REQUIRE_EQUAL(fused.verticesAttr.size(), 4);
+
+    // sorted by voxel level then coordinates
+    BOOST_CHECK_EQUAL(fused.coords[0], Point3d(0.3, 0.3, 0.3));
+    BOOST_CHECK_EQUAL(fused.pixSize[0], 0.9);
+    BOOST_CHECK(fused.verticesAttr[0].cams.getData() == std::vector<int>({4}));
+
+    BOOST_CHECK_EQUAL(fused.coords[1], Point3d(-0.2, 0.3, 0.4));
+    BOOST_CHECK(fused.verticesAttr[1].cams.getData() == std::vector<int>({1}));
+
+    BOOST_CHECK_EQUAL(fused.coords[2], Point3d(0.5, 0.5, 0.5));
+    BOOST_CHECK_EQUAL(fused.pixSize[2], 1.0);
+    BOOST_CHECK_EQUAL(fused.simScore[2], 1.0f);
+    BOOST_CHECK(fused.verticesAttr[2].cams.getData() == std::vector<int>({0, 2, 5}));
+
+    BOOST_CHECK_EQUAL(fused.coords[3], Point3d(0.3, 0.3, 0.3));
+    BOOST_CHECK_EQUAL(fused.pixSize[3], 3.0);
+    BOOST_CHECK(fused.verticesAttr[3].cams.getData() == std::vector<int>({3}));
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_pointsVoxelHash_insertionOrder)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordDistribution(-5.0, 5.0);
+    std::uniform_real_distribution<double> pixSizeDistribution(0.2, 2.0);
+    std::uniform_real_distribution<float> simScoreDistribution(0.5f, 2.0f);
+    std::uniform_int_distribution<int> camDistribution(0, 19);
+
+    std::vector<InputPoint> points(5000);
+    for(InputPoint& point : points)
+    {
+        point.p = Point3d(coordDistribution(generator), coordDistribution(generator), coordDistribution(generator));
+        point.pixSize = pixSizeDistribution(generator);
+        point.simScore = simScoreDistribution(generator);
+        point.cam = camDistribution(generator);
+    }
+
+    // sequential insertion in a single shard
+    PointsVoxelHash sequentialHash(1.0, 1);
+    for(const InputPoint& point : points)
+        sequentialHash.addPoint(point.p, point.pixSize, point.simScore, point.cam);
+
+    // concurrent insertion of the shuffled points
+    std::shuffle(points.begin(), points.end(), generator);
+    PointsVoxelHash parallelHash(1.0, 64);
+
+    #pragma omp parallel for
+    for(int i = 0; i < points.size(); ++i)
+        parallelHash.addPoint(points[i].p, points[i].pixSize, points[i].simScore, points[i].cam);
+
+    BOOST_CHECK_EQUAL(sequentialHash.size(), parallelHash.size());
+    BOOST_CHECK_LT(sequentialHash.size(), points.size());
+
+    const FusedPoints sequential = extract(sequentialHash);
+    const FusedPoints parallel = extract(parallelHash);
+
+    BOOST_REQUIRE_EQUAL(sequential.coords.size(), parallel.coords.size());
+    for(std::size_t i = 0; i < sequential.coords.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(sequential.coords[i], parallel.coords[i]);
+        BOOST_CHECK_EQUAL(sequential.pixSize[i], parallel.pixSize[i]);
+        BOOST_CHECK_EQUAL(sequential.simScore[i], parallel.simScore[i]);
+        BOOST_CHECK(sequential.verticesAttr[i].cams.getData() == parallel.verticesAttr[i].cams.getData());
+        BOOST_CHECK(std::is_sorted(parallel.verticesAttr[i].cams.getData().begin(), parallel.verticesAttr[i].cams.getData().end()));
+    }
+}
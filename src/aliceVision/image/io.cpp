@@ -907,6 +907,78 @@ void readImageNoFloat(const std::string& path,
   }
 }
 
+template<typename T>
+void readImageRegion(const std::string& path,
+                     int nchannels,
+                     Image<T>& image,
+                     const oiio::ROI& roi)
+{
+    std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+    if(!in)
+        throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+    const oiio::ImageSpec& spec = in->spec();
+
+    // check picture channels number
+    if(spec.nchannels < nchannels)
+        throw std::runtime_error("Can't load channels of image file '" + path + "'.");
+
+    image.resize(roi.width(), roi.height(), true, T(0.f));
+
+    // region part covered by the file data window
+    const oiio::ROI dataRoi = oiio::roi_intersection(roi, spec.roi());
+
+    if(dataRoi.width() <= 0 || dataRoi.height() <= 0)
+        return; // nothing to read
+
+    // file buffer covering the region
+    std::vector<float> buffer;
+    int bufferXBegin = spec.x;
+    int bufferYBegin = dataRoi.ybegin;
+    int bufferWidth = spec.width;
+    bool success = false;
+
+    if(spec.tile_width > 0 && spec.tile_height > 0)
+    {
+        // read the tiles overlapping the region
+        // tile reading bounds should be aligned on tiles or on the data window end
+        const int xBegin = spec.x + ((dataRoi.xbegin - spec.x) / spec.tile_width) * spec.tile_width;
+        const int yBegin = spec.y + ((dataRoi.ybegin - spec.y) / spec.tile_height) * spec.tile_height;
+        const int xEnd = std::min(spec.x + spec.width,  spec.x + ((dataRoi.xend - spec.x + spec.tile_width  - 1) / spec.tile_width)  * spec.tile_width);
+        const int yEnd = std::min(spec.y + spec.height, spec.y + ((dataRoi.yend - spec.y + spec.tile_height - 1) / spec.tile_height) * spec.tile_height);
+
+        bufferXBegin = xBegin;
+        bufferYBegin = yBegin;
+        bufferWidth = xEnd - xBegin;
+        buffer.resize(std::size_t(bufferWidth) * (yEnd - yBegin) * nchannels);
+
+        success = in->read_tiles(0, 0, xBegin, xEnd, yBegin, yEnd, 0, 1, 0, nchannels, oiio::TypeDesc::FLOAT, buffer.data());
+    }
+    else
+    {
+        // read the scanlines overlapping the region
+        buffer.resize(std::size_t(bufferWidth) * dataRoi.height() * nchannels);
+
+        success = in->read_scanlines(0, 0, dataRoi.ybegin, dataRoi.yend, 0, 0, nchannels, oiio::TypeDesc::FLOAT, buffer.data());
+    }
+
+    if(!success)
+        throw std::runtime_error("Can't read region of image file '" + path + "': " + in->geterror());
+
+    in->close();
+
+    // copy region pixels from the file buffer
+    for(int y = dataRoi.ybegin; y < dataRoi.yend; ++y)
+    {
+        for(int x = dataRoi.xbegin; x < dataRoi.xend; ++x)
+        {
+            const std::size_t bufferIndex = (std::size_t(y - bufferYBegin) * bufferWidth + (x - bufferXBegin)) * nchannels;
+            std::copy_n(buffer.data() + bufferIndex, nchannels, reinterpret_cast<float*>(&image(y - roi.ybegin, x - roi.xbegin)));
+        }
+    }
+}
+
 bool containsHalfFloatOverflow(const oiio::ImageBuf& image)
 {
     auto stats = oiio::ImageBufAlgo::computePixelStats(image);
@@ -924,6 +996,41 @@ bool containsHalfFloatOverflow(const oiio::ImageBuf& image)
     return false;
 }
 
+/**
+ * @brief Convert the source buffer pixels to another color space.
+ * @return false if no conversion is needed, the destination buffer is then untouched
+ */
+bool convertColorSpace(oiio::ImageBuf& dst, const oiio::ImageBuf& src,
+                       EImageColorSpace fromColorSpace, EImageColorSpace toColorSpace)
+{
+    if ((fromColorSpace == toColorSpace) || (toColorSpace == EImageColorSpace::NO_CONVERSION))
+    {
+        // Do nothing. Note that calling imageAlgo::colorconvert() will copy the source buffer
+        // even if no conversion is needed.
+        return false;
+    }
+    if ((toColorSpace == EImageColorSpace::ACES2065_1) || (toColorSpace == EImageColorSpace::ACEScg) ||
+        (fromColorSpace == EImageColorSpace::ACES2065_1) || (fromColorSpace == EImageColorSpace::ACEScg) ||
+        (fromColorSpace == EImageColorSpace::REC709))
+    {
+        const auto colorConfigPath = getAliceVisionOCIOConfig();
+        if (colorConfigPath.empty())
+        {
+            throw std::runtime_error("ALICEVISION_ROOT is not defined, OCIO config file cannot be accessed.");
+        }
+        oiio::ColorConfig colorConfig(colorConfigPath);
+        oiio::ImageBufAlgo::colorconvert(dst, src,
+                                         EImageColorSpace_enumToOIIOString(fromColorSpace),
+                                         EImageColorSpace_enumToOIIOString(toColorSpace), true, "", "",
+                                         &colorConfig);
+    }
+    else
+    {
+        oiio::ImageBufAlgo::colorconvert(dst, src, EImageColorSpace_enumToOIIOString(fromColorSpace), EImageColorSpace_enumToOIIOString(toColorSpace));
+    }
+    return true;
+}
+
 template<typename T>
 void writeImage(const std::string& path,
                 oiio::TypeDesc typeDesc,
@@ -1009,6 +1116,14 @@ void writeImage(const std::string& path,
         imageSpec.set_roi(pixelRoi);
     }
 
+    if(isEXR && options.getExrTileSize() > 0)
+    {
+        // tiled storage, allows partial reading of the image
+        imageSpec.tile_width  = options.getExrTileSize();
+        imageSpec.tile_height = options.getExrTileSize();
+        imageSpec.tile_depth  = 1;
+    }
+
     imageSpec.attribute("AliceVision:ColorSpace",
                         (toColorSpace == EImageColorSpace::NO_CONVERSION)
                             ? EImageColorSpace_enumToString(fromColorSpace) : EImageColorSpace_enumToString(toColorSpace));
@@ -1017,32 +1132,8 @@ void writeImage(const std::string& path,
     const oiio::ImageBuf* outBuf = &imgBuf;  // buffer to write
         
     oiio::ImageBuf colorspaceBuf = oiio::ImageBuf(imageSpec, const_cast<T*>(image.data())); // buffer for image colorspace modification
-    if ((fromColorSpace == toColorSpace) || (toColorSpace == EImageColorSpace::NO_CONVERSION))
-    {
-        // Do nothing. Note that calling imageAlgo::colorconvert() will copy the source buffer
-        // even if no conversion is needed.
-    }
-    else if ((toColorSpace == EImageColorSpace::ACES2065_1) || (toColorSpace == EImageColorSpace::ACEScg) ||
-             (fromColorSpace == EImageColorSpace::ACES2065_1) || (fromColorSpace == EImageColorSpace::ACEScg) ||
-             (fromColorSpace == EImageColorSpace::REC709))
-    {
-        const auto colorConfigPath = getAliceVisionOCIOConfig();
-        if (colorConfigPath.empty())
-        {
-            throw std::runtime_error("ALICEVISION_ROOT is not defined, OCIO config file cannot be accessed.");
-        }
-        oiio::ColorConfig colorConfig(colorConfigPath);
-        oiio::ImageBufAlgo::colorconvert(colorspaceBuf, *outBuf,
-                                         EImageColorSpace_enumToOIIOString(fromColorSpace),
-                                         EImageColorSpace_enumToOIIOString(toColorSpace), true, "", "",
-                                         &colorConfig);
-        outBuf = &colorspaceBuf;
-    }
-    else
-    {
-        oiio::ImageBufAlgo::colorconvert(colorspaceBuf, *outBuf, EImageColorSpace_enumToOIIOString(fromColorSpace), EImageColorSpace_enumToOIIOString(toColorSpace));
+    if(convertColorSpace(colorspaceBuf, *outBuf, fromColorSpace, toColorSpace))
         outBuf = &colorspaceBuf;
-    }
 
     oiio::ImageBuf formatBuf;  // buffer for image format modification
     if(isEXR)
@@ -1143,6 +1234,142 @@ void writeImageNoFloat(const std::string& path,
   fs::rename(tmpPath, path);
 }
 
+TiledImageWriter::TiledImageWriter(const std::string& path, int width, int height, int tileSize,
+                                   const ImageWriteOptions& options, const oiio::ParamValueList& metadata)
+  : _path(path)
+{
+    const fs::path bPath = fs::path(path);
+    const std::string extension = boost::to_lower_copy(bPath.extension().string());
+    const bool isEXR = (extension == ".exr");
+
+    if(!isEXR && extension != ".tif" && extension != ".tiff")
+        ALICEVISION_THROW_ERROR("Tiled image writing is only available for EXR and TIFF files: '" + path + "'.");
+
+    _tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + extension;
+    _fromColorSpace = options.getFromColorSpace();
+    _toColorSpace = (options.getToColorSpace() == EImageColorSpace::AUTO) ? EImageColorSpace::LINEAR : options.getToColorSpace();
+
+    // pixels are stored in half float if requested, the values are not known in advance for the Auto mode
+    // so it falls back to float
+    const EStorageDataType storageDataType = (options.getStorageDataType() == EStorageDataType::Undefined) ?
+                                              EStorageDataType::HalfFinite : options.getStorageDataType();
+    const bool isHalf = isEXR && (storageDataType == EStorageDataType::Half || storageDataType == EStorageDataType::HalfFinite);
+    _halfFinite = isEXR && (storageDataType == EStorageDataType::HalfFinite);
+
+    _spec = oiio::ImageSpec(width, height, 3, isHalf ? oiio::TypeDesc::HALF : oiio::TypeDesc::FLOAT);
+    _spec.extra_attribs = metadata;
+    if(isEXR && storageDataType != EStorageDataType::Auto)
+        _spec.attribute("AliceVision:storageDataType", EStorageDataType_enumToString(storageDataType));
+    _spec.tile_width = tileSize;
+    _spec.tile_height = tileSize;
+    _spec.tile_depth = 1;
+
+    if(isEXR)
+    {
+        std::string compressionMethod = "zips";
+        if(options.getExrCompressionMethod() != EImageExrCompression::Auto)
+            compressionMethod = EImageExrCompression_enumToString(options.getExrCompressionMethod());
+        _spec.attribute("compression", compressionMethod);
+        // bands of tiles are not written in the image order
+        _spec.attribute("openexr:lineOrder", "randomY");
+    }
+    else
+    {
+        _spec.attribute("compression", "zip");
+    }
+
+    _spec.attribute("AliceVision:ColorSpace",
+                    (_toColorSpace == EImageColorSpace::NO_CONVERSION)
+                        ? EImageColorSpace_enumToString(_fromColorSpace) : EImageColorSpace_enumToString(_toColorSpace));
+
+    ALICEVISION_LOG_DEBUG("[IO] Write tiled image: " << path << "\n"
+                        << "\t- width: " << width << "\n"
+                        << "\t- height: " << height << "\n"
+                        << "\t- tile size: " << tileSize);
+
+    _out = oiio::ImageOutput::create(_tmpPath);
+    if(!_out || !_out->supports("tiles") || !_out->open(_tmpPath, _spec))
+        ALICEVISION_THROW_ERROR("Can't open output tiled image file '" + path + "'.");
+}
+
+TiledImageWriter::~TiledImageWriter()
+{
+    if(_closed)
+        return;
+
+    // the image was not successfully closed, it may be incomplete: discard the temporary file
+    if(_out)
+        _out->close();
+    _out.reset();
+
+    boost::system::error_code ec;
+    fs::remove(_tmpPath, ec);
+    ALICEVISION_LOG_WARNING("Tiled image file '" << _path << "' not closed, it is discarded.");
+}
+
+void TiledImageWriter::writeRows(int y, const Image<RGBfColor>& rows)
+{
+    if(!_out)
+        ALICEVISION_THROW_ERROR("Tiled image file '" + _path + "' is already closed.");
+    if(rows.Width() != _spec.width || y % _spec.tile_height != 0 ||
+       (y + rows.Height() != _spec.height && rows.Height() % _spec.tile_height != 0))
+        ALICEVISION_THROW_ERROR("Rows band [" << y << ", " << y + rows.Height() << "[ is not aligned on the tiles of '" << _path << "'.");
+
+    const oiio::ImageSpec rowsSpec(rows.Width(), rows.Height(), 3, oiio::TypeDesc::FLOAT);
+    const oiio::ImageBuf rowsBuf(rowsSpec, const_cast<RGBfColor*>(rows.data()));
+    const oiio::ImageBuf* outBuf = &rowsBuf;
+
+    oiio::ImageBuf colorspaceBuf;
+    if(convertColorSpace(colorspaceBuf, *outBuf, _fromColorSpace, _toColorSpace))
+        outBuf = &colorspaceBuf;
+
+    oiio::ImageBuf clampBuf;
+    if(_halfFinite)
+    {
+        oiio::ImageBufAlgo::clamp(clampBuf, *outBuf, -HALF_MAX, HALF_MAX);
+        outBuf = &clampBuf;
+    }
+
+    // the buffer is converted to the file format by OIIO
+    const float* data = static_cast<const float*>(outBuf->localpixels());
+    if(!_out->write_tiles(0, _spec.width, y, y + rows.Height(), 0, 1, oiio::TypeDesc::FLOAT, data))
+        ALICEVISION_THROW_ERROR("Can't write rows band in tiled image file '" + _path + "': " + _out->geterror());
+}
+
+void TiledImageWriter::close(bool mipmaps)
+{
+    if(_closed)
+        return;
+    if(!_out)
+        ALICEVISION_THROW_ERROR("Tiled image file '" + _path + "' failed to close.");
+
+    const bool closed = _out->close();
+    _out.reset();
+    if(!closed)
+        ALICEVISION_THROW_ERROR("Can't write output tiled image file '" + _path + "'.");
+
+    if(mipmaps)
+    {
+        // rewrite the image with all the mip levels, keeping the tiles size and format
+        oiio::ImageSpec config;
+        config.tile_width = _spec.tile_width;
+        config.tile_height = _spec.tile_height;
+        config.tile_depth = 1;
+        config.format = _spec.format;
+        config.attribute("compression", _spec.get_string_attribute("compression"));
+        config.attribute("maketx:filtername", "box");
+        if(!oiio::ImageBufAlgo::make_texture(oiio::ImageBufAlgo::MakeTxTexture, _tmpPath, _path, config))
+            ALICEVISION_THROW_ERROR("Can't generate the mip levels of the tiled image file '" + _path + "': " + oiio::geterror());
+        fs::remove(_tmpPath);
+        _closed = true;
+        return;
+    }
+
+    // rename temporary filename
+    fs::rename(_tmpPath, _path);
+    _closed = true;
+}
+
 void readImage(const std::string& path, Image<float>& image, const ImageReadOptions & imageReadOptions)
 {
   readImage(path, oiio::TypeDesc::FLOAT, 1, image, imageReadOptions);
@@ -1163,6 +1390,16 @@ void readImageDirect(const std::string& path, Image<IndexT>& image)
   readImageNoFloat(path, oiio::TypeDesc::UINT32, image);
 }
 
+void readImageRegion(const std::string& path, Image<float>& image, const oiio::ROI& roi)
+{
+  readImageRegion(path, 1, image, roi);
+}
+
+void readImageRegion(const std::string& path, Image<RGBfColor>& image, const oiio::ROI& roi)
+{
+  readImageRegion(path, 3, image, roi);
+}
+
 void readImage(const std::string& path, Image<RGBAfColor>& image, const ImageReadOptions & imageReadOptions)
 {
   readImage(path, oiio::TypeDesc::FLOAT, 4, image, imageReadOptions);
@@ -15,8 +15,10 @@
 
 #include <OpenImageIO/paramlist.h>
 #include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imageio.h>
 #include <OpenImageIO/color.h>
 
+#include <memory>
 #include <string>
 
 
@@ -252,6 +254,7 @@ public:
     EStorageDataType getStorageDataType() const { return _storageDataType; }
     EImageExrCompression getExrCompressionMethod() const { return _exrCompressionMethod; }
     int getExrCompressionLevel() const { return _exrCompressionLevel; }
+    int getExrTileSize() const { return _exrTileSize; }
     bool getJpegCompress() const { return _jpegCompress; }
     int getJpegQuality() const { return _jpegQuality; }
 
@@ -285,6 +288,17 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Write EXR files as square tiles of the given size instead of scanlines.
+     *        A tiled file can be partially read (see readImageRegion).
+     * @param[in] tileSize the tile width and height in pixels, 0 for scanline storage
+     */
+    ImageWriteOptions& exrTileSize(int tileSize)
+    {
+        _exrTileSize = tileSize;
+        return *this;
+    }
+
     ImageWriteOptions& jpegCompress(bool compress)
     {
         _jpegCompress = compress;
@@ -303,6 +317,7 @@ private:
     EStorageDataType _storageDataType{EStorageDataType::Undefined};
     EImageExrCompression _exrCompressionMethod{EImageExrCompression::Auto};
     int _exrCompressionLevel{0};
+    int _exrTileSize{0};
     bool _jpegCompress{true};
     int _jpegQuality{90};
 };
@@ -394,6 +409,17 @@ void readImage(const std::string& path, Image<RGBColor>& image, const ImageReadO
 void readImageDirect(const std::string& path, Image<IndexT>& image);
 void readImageDirect(const std::string& path, Image<unsigned char>& image);
 
+/**
+ * @brief read a region of an image with a given path without any processing such as color conversion
+ * @note only the scanlines (or tiles for a tiled file) overlapping the region are read from the file,
+ *       pixels of the region outside of the file data window are set to zero
+ * @param[in] path The given path to the image
+ * @param[out] image The output image buffer, resized to the region size
+ * @param[in] roi The region to read, in the image display window coordinates
+ */
+void readImageRegion(const std::string& path, Image<float>& image, const oiio::ROI& roi);
+void readImageRegion(const std::string& path, Image<RGBfColor>& image, const oiio::ROI& roi);
+
 /**
  * @brief log information about the memory usage of the OIIO default shared image cache 
  */
@@ -443,6 +469,61 @@ void writeImage(const std::string& path,
 void writeImage(const std::string& path, const Image<RGBColor>& image, const ImageWriteOptions& options,
                 const oiio::ParamValueList& metadata = oiio::ParamValueList());
 
+/**
+ * @brief Write an image progressively by bands of rows, only the rows being written are in memory.
+ *        The image is stored as tiles (EXR or TIFF files), mip levels can be generated when closing the file.
+ */
+class TiledImageWriter
+{
+public:
+    /**
+     * @param[in] path The output image path (.exr or .tif)
+     * @param[in] width The image width
+     * @param[in] height The image height
+     * @param[in] tileSize The tile width and height in pixels
+     * @param[in] options The image writing options
+     * @param[in] metadata The image metadata
+     */
+    TiledImageWriter(const std::string& path, int width, int height, int tileSize,
+                     const ImageWriteOptions& options,
+                     const oiio::ParamValueList& metadata = oiio::ParamValueList());
+
+    TiledImageWriter(const TiledImageWriter&) = delete;
+    TiledImageWriter& operator=(const TiledImageWriter&) = delete;
+
+    /**
+     * @brief Discard the temporary file if the image was not successfully closed,
+     *        the output path is only written by close().
+     */
+    ~TiledImageWriter();
+
+    int getTileSize() const { return _spec.tile_height; }
+
+    /**
+     * @brief Write a band of rows, in any order.
+     * @param[in] y The first row of the band, a multiple of the tile size
+     * @param[in] rows The rows of the band (image width), the band height is a multiple of the tile size
+     *            except for the last band of the image
+     */
+    void writeRows(int y, const Image<RGBfColor>& rows);
+
+    /**
+     * @brief Finish writing the image file.
+     * @param[in] mipmaps Rewrite the file as a tiled texture with all the mip levels
+     */
+    void close(bool mipmaps = false);
+
+private:
+    std::string _path;
+    std::string _tmpPath;
+    oiio::ImageSpec _spec;
+    std::unique_ptr<oiio::ImageOutput> _out;
+    EImageColorSpace _fromColorSpace;
+    EImageColorSpace _toColorSpace;
+    bool _halfFinite = false;
+    bool _closed = false;
+};
+
 /**
  * @brief write an image with a given path and buffer, converting to float as necessary to perform
  * intermediate calculations.
@@ -13,7 +13,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 
+#include <boost/filesystem.hpp>
+
 #include <cstdio>
+#include <memory>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -21,6 +24,7 @@
 using namespace aliceVision;
 using namespace aliceVision::image;
 using std::string;
+namespace fs = boost::filesystem;
 
 // tested extensions
 static std::vector<std::string> extensions = { "jpg", "png", "pgm", "ppm", "tiff", "exr" };
@@ -263,3 +267,117 @@ BOOST_AUTO_TEST_CASE(read_write_from_grayscale_to_rgb) {
     remove(filename.c_str());
   }
 }
+
+namespace {
+
+Image<RGBfColor> createTiledImageTestImage(int width, int height)
+{
+  Image<RGBfColor> image(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = RGBfColor(0.01f * x, 0.02f * y, 0.5f + 0.001f * (x + y));
+  return image;
+}
+
+Image<RGBfColor> getRows(const Image<RGBfColor>& image, int y, int nbRows)
+{
+  Image<RGBfColor> rows(image.Width(), nbRows);
+  for(int j = 0; j < nbRows; ++j)
+    for(int x = 0; x < image.Width(); ++x)
+      rows(j, x) = image(y + j, x);
+  return rows;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(read_write_tiled) {
+  const int width = 70;
+  const int height = 50;
+  const int tileSize = 16;
+  const Image<RGBfColor> image = createTiledImageTestImage(width, height);
+
+  for(const std::string extension : {"exr", "tif"})
+  {
+    for(const bool mipmaps : {false, true})
+    {
+      const fs::path folder = fs::temp_directory_path() / fs::unique_path("tiledImage_test_%%%%%%%%");
+      fs::create_directories(folder);
+      const std::string filename = (folder / ("test_write_tiled." + extension)).string();
+
+      {
+        TiledImageWriter writer(filename, width, height, tileSize,
+                                image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::NO_CONVERSION)
+                                                          .storageDataType(image::EStorageDataType::Float));
+        BOOST_CHECK_EQUAL(writer.getTileSize(), tileSize);
+
+        // bands in any order, the last one is not a multiple of the tile size
+        writer.writeRows(2 * tileSize, getRows(image, 2 * tileSize, height - 2 * tileSize));
+        writer.writeRows(0, getRows(image, 0, 2 * tileSize));
+        BOOST_CHECK_THROW(writer.writeRows(tileSize / 2, getRows(image, 0, tileSize)), std::exception);
+
+        // nothing at the output path until the file is closed
+        BOOST_CHECK(!fs::exists(filename));
+        BOOST_CHECK_NO_THROW(writer.close(mipmaps));
+        BOOST_CHECK_THROW(writer.writeRows(0, getRows(image, 0, tileSize)), std::exception);
+      }
+
+      // only the output file remains
+      BOOST_CHECK(fs::exists(filename));
+      BOOST_CHECK_EQUAL(std::distance(fs::directory_iterator(folder), fs::directory_iterator()), 1);
+
+      Image<RGBfColor> read_image;
+      BOOST_CHECK_NO_THROW(readImage(filename, read_image, image::EImageColorSpace::NO_CONVERSION));
+      BOOST_REQUIRE_EQUAL(read_image.Width(), width);
+      BOOST_REQUIRE_EQUAL(read_image.Height(), height);
+      for(int y = 0; y < height; ++y)
+      {
+        for(int x = 0; x < width; ++x)
+        {
+          BOOST_CHECK_EQUAL(read_image(y, x).r(), image(y, x).r());
+          BOOST_CHECK_EQUAL(read_image(y, x).g(), image(y, x).g());
+          BOOST_CHECK_EQUAL(read_image(y, x).b(), image(y, x).b());
+        }
+      }
+
+      // the mip levels are written on request, halving the size down to 1x1: 70x50, 35x25, ..., 1x1
+      {
+        std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(filename));
+        BOOST_REQUIRE(in);
+        int nbMipLevels = 0;
+        while(in->seek_subimage(0, nbMipLevels))
+          ++nbMipLevels;
+        BOOST_CHECK_EQUAL(nbMipLevels, mipmaps ? 7 : 1);
+        if(mipmaps)
+        {
+          BOOST_REQUIRE(in->seek_subimage(0, 1));
+          BOOST_CHECK_EQUAL(in->spec().width, width / 2);
+          BOOST_CHECK_EQUAL(in->spec().height, height / 2);
+        }
+        in->close();
+      }
+      fs::remove_all(folder);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(write_tiled_not_closed) {
+  const int width = 40;
+  const int height = 40;
+  const int tileSize = 16;
+  const Image<RGBfColor> image = createTiledImageTestImage(width, height);
+
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("tiledImage_test_%%%%%%%%");
+  fs::create_directories(folder);
+  const std::string filename = (folder / "test_write_tiled_not_closed.exr").string();
+
+  {
+    TiledImageWriter writer(filename, width, height, tileSize, image::ImageWriteOptions());
+    writer.writeRows(0, getRows(image, 0, tileSize));
+  }
+
+  // the incomplete image and its temporary file are discarded
+  BOOST_CHECK(!fs::exists(filename));
+  BOOST_CHECK(fs::is_empty(folder));
+
+  fs::remove_all(folder);
+}
@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Mesh.hpp"
+#include "meshIO.hpp"
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mesh/meshVisibility.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -23,6 +24,7 @@
 #include <assimp/scene.h>
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <unordered_set>
@@ -87,10 +89,26 @@ std::istream& operator>>(std::istream& in, EFileType& meshFileType)
 void Mesh::save(const std::string& filepath)
 {
     const std::string fileTypeStr = boost::filesystem::path(filepath).extension().string().substr(1);
-    const EFileType fileType = mesh::EFileType_stringToEnum(fileTypeStr);
 
     ALICEVISION_LOG_INFO("Save " << fileTypeStr << " mesh file");
 
+    // native writers for the PLY and OBJ files, Assimp for the other formats
+    const std::string extension = boost::to_lower_copy(fileTypeStr);
+    if(extension == "ply" || extension == "obj")
+    {
+        if(extension == "ply")
+            savePly(filepath, *this);
+        else
+            saveObj(filepath, *this);
+
+        ALICEVISION_LOG_INFO("Save mesh to " << fileTypeStr << " done.");
+        ALICEVISION_LOG_DEBUG("Vertices: " << pts.size());
+        ALICEVISION_LOG_DEBUG("Triangles: " << tris.size());
+        return;
+    }
+
+    const EFileType fileType = mesh::EFileType_stringToEnum(fileTypeStr);
+
     aiScene scene;
 
     scene.mRootNode = new aiNode;
@@ -183,6 +201,7 @@ bool Mesh::loadFromBin(const std::string& binFilepath)
     fread(&tris[0], sizeof(Mesh::triangle), ntris, f);
 
     fclose(f);
+    invalidateTopology();
     return true;
 }
 
@@ -251,6 +270,8 @@ void Mesh::addMesh(const Mesh& mesh)
         trisUvIds.reserve(mesh.trisUvIds.size());
         std::copy(mesh.trisUvIds.begin(), mesh.trisUvIds.end(), std::back_inserter(trisUvIds.getDataWritable()));
     }
+
+    invalidateTopology();
 }
 
 Mesh::triangle_proj Mesh::getTriangleProjection(int triid, const mvsUtils::MultiViewParams& mp, int rc, int w, int h) const
@@ -558,57 +579,198 @@ bool Mesh::doesTriangleIntersectsRectangle(Mesh::triangle_proj& tp, Mesh::rectan
     */
 }
 
-void Mesh::getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const
+void Mesh::invalidateTopology()
 {
-    // array of tuples <x: vertexIndex, y: triangleIndex, z: numberOfNeighbors>
-    StaticVector<Voxel> vertexNeighborhoodPairs;
-    vertexNeighborhoodPairs.reserve(tris.size() * 3);
-    for(int i = 0; i < tris.size(); ++i)
+    std::lock_guard<std::mutex> lock(_topologyCache.mutex);
+    _topologyCache.ptsNeighTris.reset();
+    _topologyCache.ptsNeighPtsOrdered.reset();
+}
+
+const Mesh::Adjacency& Mesh::getPtsNeighTrisAdjacency() const
+{
+    std::lock_guard<std::mutex> lock(_topologyCache.mutex);
+
+    if(!_topologyCache.ptsNeighTris)
+        _topologyCache.ptsNeighTris = computePtsNeighTrisAdjacency();
+
+    return *_topologyCache.ptsNeighTris;
+}
+
+const Mesh::Adjacency& Mesh::getPtsNeighPtsOrderedAdjacency() const
+{
+    std::lock_guard<std::mutex> lock(_topologyCache.mutex);
+
+    if(!_topologyCache.ptsNeighTris)
+        _topologyCache.ptsNeighTris = computePtsNeighTrisAdjacency();
+
+    if(!_topologyCache.ptsNeighPtsOrdered)
+        _topologyCache.ptsNeighPtsOrdered = computePtsNeighPtsOrderedAdjacency(*_topologyCache.ptsNeighTris);
+
+    return *_topologyCache.ptsNeighPtsOrdered;
+}
+
+std::shared_ptr<const Mesh::Adjacency> Mesh::computePtsNeighTrisAdjacency() const
+{
+    const int nbPts = pts.size();
+    const int nbTris = tris.size();
+
+    auto ptsNeighTris = std::make_shared<Adjacency>();
+    std::vector<int>& offsets = ptsNeighTris->offsets;
+    std::vector<int>& values = ptsNeighTris->values;
+
+    // count the triangles of each vertex
+    offsets.assign(nbPts + 1, 0);
+#pragma omp parallel for
+    for(int i = 0; i < nbTris; ++i)
     {
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[0], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[1], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[2], i, 0));
+        for(int k = 0; k < 3; ++k)
+            ++boost::atomic_ref<int>{offsets[tris[i].v[k] + 1]};
     }
-    qsort(&vertexNeighborhoodPairs[0], vertexNeighborhoodPairs.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+    for(int i = 0; i < nbPts; ++i)
+        offsets[i + 1] += offsets[i];
 
-    int i = 0; // index of the unique pair of <vertex, neighborhood>
-    int j = 0; // index of the vertex
-    int k = 0; // number of neighbors
-    int firstid = 0;
-    while(i < vertexNeighborhoodPairs.size())
+    // fill and sort each vertex triangles
+    values.resize(offsets.back());
+    std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+#pragma omp parallel for
+    for(int i = 0; i < nbTris; ++i)
     {
-        ++k;
-        // (*vertexNeighborhoodPairs)[i].z = j;
-        if((i == vertexNeighborhoodPairs.size() - 1) || (vertexNeighborhoodPairs[i].x != vertexNeighborhoodPairs[i + 1].x))
-        {
-            vertexNeighborhoodPairs[firstid].z = k; // store the number of neighbors
-            ++j;
-            firstid = i + 1;
-            k = 0;
-        }
-        ++i;
+        for(int k = 0; k < 3; ++k)
+            values[boost::atomic_ref<int>{cursors[tris[i].v[k]]}++] = i;
     }
-    int npts = j;
+#pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+        std::sort(values.begin() + offsets[i], values.begin() + offsets[i + 1]);
 
-    out_ptsNeighTris.reserve(pts.size());
-    out_ptsNeighTris.resize(pts.size());
+    return ptsNeighTris;
+}
+
+std::shared_ptr<const Mesh::Adjacency> Mesh::computePtsNeighPtsOrderedAdjacency(const Adjacency& ptsNeighTris) const
+{
+    const int nbPts = pts.size();
+
+    // at most one more neighbor point than neighbor triangles (open fan)
+    std::vector<int> maxOffsets(nbPts + 1, 0);
+    for(int i = 0; i < nbPts; ++i)
+        maxOffsets[i + 1] = maxOffsets[i] + ptsNeighTris.size(i) + 1;
 
-    i = 0;
-    for(j = 0; j < npts; ++j)
+    std::vector<int> maxValues(maxOffsets.back());
+    std::vector<int> sizes(nbPts, 0);
+
+#pragma omp parallel
     {
-        int middlePtId = vertexNeighborhoodPairs[i].x;
-        int nbNeighbors = vertexNeighborhoodPairs[i].z;
-        int i0 = i;
-        int i1 = i + nbNeighbors;
-        i = i1;
+        std::vector<int> neighborTriangles;
 
-        StaticVector<int>& triTmp = out_ptsNeighTris[middlePtId];
-        triTmp.reserve(nbNeighbors);
-        for(int l = i0; l < i1; ++l)
+#pragma omp for
+        for(int middlePtId = 0; middlePtId < nbPts; ++middlePtId)
         {
-            triTmp.push_back(vertexNeighborhoodPairs[l].y); // index of triangle
+            if(ptsNeighTris.size(middlePtId) == 0)
+                continue;
+
+            neighborTriangles.assign(ptsNeighTris.begin(middlePtId), ptsNeighTris.end(middlePtId));
+
+            int* vhid = &maxValues[maxOffsets[middlePtId]];
+            int nbVhid = 0;
+
+            // start from the vertex following the middle point in a triangle,
+            // on the fan border if any so open fans are fully walked
+            const auto getNextPtId = [&](int triId)
+            {
+                const Mesh::triangle& t = tris[triId];
+                const int k = (t.v[0] == middlePtId) ? 0 : ((t.v[1] == middlePtId) ? 1 : 2);
+                return t.v[(k + 1) % 3];
+            };
+            int currentTriPtId = getNextPtId(neighborTriangles[0]);
+            for(int triId : neighborTriangles)
+            {
+                const int nextPtId = getNextPtId(triId);
+                int nbTrisWithNextPt = 0;
+                for(int otherTriId : neighborTriangles)
+                {
+                    const Mesh::triangle& t = tris[otherTriId];
+                    nbTrisWithNextPt += static_cast<int>(t.v[0] == nextPtId || t.v[1] == nextPtId || t.v[2] == nextPtId);
+                }
+                if(nbTrisWithNextPt == 1)
+                {
+                    currentTriPtId = nextPtId;
+                    break;
+                }
+            }
+            const int firstTriPtId = currentTriPtId;
+            vhid[nbVhid++] = currentTriPtId;
+
+            bool isThereTWithCurrentTriPtId = true;
+            while(!neighborTriangles.empty() && isThereTWithCurrentTriPtId)
+            {
+                isThereTWithCurrentTriPtId = false;
+
+                // find triangle with middlePtId and currentTriPtId and get remaining point id
+                for(int n = 0; n < neighborTriangles.size(); ++n)
+                {
+                    bool ok_middlePtId = false;
+                    bool ok_actTriPtId = false;
+                    int remainingPtId = -1; // remaining pt id
+                    for(int k = 0; k < 3; ++k)
+                    {
+                        const int triPtId = tris[neighborTriangles[n]].v[k];
+                        const double length = (pts[middlePtId] - pts[triPtId]).size();
+                        if((triPtId != middlePtId) && (triPtId != currentTriPtId) && (length > 0.0) && (!std::isnan(length)))
+                            remainingPtId = triPtId;
+                        if(triPtId == middlePtId)
+                            ok_middlePtId = true;
+                        if(triPtId == currentTriPtId)
+                            ok_actTriPtId = true;
+                    }
+
+                    if(ok_middlePtId && ok_actTriPtId && (remainingPtId > -1))
+                    {
+                        currentTriPtId = remainingPtId;
+                        neighborTriangles.erase(neighborTriangles.begin() + n);
+                        vhid[nbVhid++] = currentTriPtId;
+                        isThereTWithCurrentTriPtId = true; // we removed one, so we try again
+                        break;
+                    }
+                }
+            }
+
+            if(currentTriPtId == firstTriPtId)
+                --nbVhid; // remove last ... which is first
+
+            // remove duplicates
+            int nbUnique = 0;
+            for(int k = 0; k < nbVhid; ++k)
+            {
+                if(std::find(vhid, vhid + nbUnique, vhid[k]) == vhid + nbUnique)
+                    vhid[nbUnique++] = vhid[k];
+            }
+            sizes[middlePtId] = nbUnique;
         }
     }
+
+    // compact
+    auto ptsNeighPtsOrdered = std::make_shared<Adjacency>();
+    std::vector<int>& offsets = ptsNeighPtsOrdered->offsets;
+    offsets.assign(nbPts + 1, 0);
+    for(int i = 0; i < nbPts; ++i)
+        offsets[i + 1] = offsets[i] + sizes[i];
+
+    std::vector<int>& values = ptsNeighPtsOrdered->values;
+    values.resize(offsets.back());
+#pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+        std::copy_n(maxValues.begin() + maxOffsets[i], sizes[i], values.begin() + offsets[i]);
+
+    return ptsNeighPtsOrdered;
+}
+
+void Mesh::getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const
+{
+    const Adjacency& ptsNeighTris = getPtsNeighTrisAdjacency();
+
+    out_ptsNeighTris.resize(pts.size());
+#pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+        out_ptsNeighTris[i].getDataWritable().assign(ptsNeighTris.begin(i), ptsNeighTris.end(i));
 }
 
 void Mesh::getPtsNeighbors(std::vector<std::vector<int>>& out_ptsNeigh) const
@@ -632,81 +794,53 @@ void Mesh::getPtsNeighbors(std::vector<std::vector<int>>& out_ptsNeigh) const
 
 void Mesh::getPtsNeighPtsOrdered(StaticVector<StaticVector<int>>& out_ptsNeighPts) const
 {
-    StaticVector<StaticVector<int>> ptsNeighborTriangles;
-    getPtsNeighborTriangles(ptsNeighborTriangles);
+    const Adjacency& ptsNeighPts = getPtsNeighPtsOrderedAdjacency();
 
     out_ptsNeighPts.resize(pts.size());
+#pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+        out_ptsNeighPts[i].getDataWritable().assign(ptsNeighPts.begin(i), ptsNeighPts.end(i));
+}
 
-    for(int middlePtId = 0; middlePtId < pts.size(); ++middlePtId)
-    {
-        StaticVector<int>& neighborTriangles = ptsNeighborTriangles[middlePtId];
-        if(neighborTriangles.empty())
-            continue;
-
-        StaticVector<int> vhid;
-        vhid.reserve(neighborTriangles.size() * 2);
-        int currentTriPtId = tris[neighborTriangles[0]].v[0];
-        int firstTriPtId = currentTriPtId;
-        vhid.push_back(currentTriPtId);
+void Mesh::getSortedTrianglesEdges(bool firstIsMax, StaticVector<Voxel>& out_edges) const
+{
+    const Adjacency& ptsNeighTris = getPtsNeighTrisAdjacency();
+    const int nbPts = pts.size();
 
-        bool isThereTWithCurrentTriPtId = true;
-        while(!neighborTriangles.empty() && isThereTWithCurrentTriPtId)
+    // emit each triangle edge from its first vertex, only once per triangle
+    const auto forEachEdge = [&](int ptId, auto&& f)
+    {
+        for(const int* it = ptsNeighTris.begin(ptId); it != ptsNeighTris.end(ptId); ++it)
         {
-            isThereTWithCurrentTriPtId = false;
-
-            // find triangle with middlePtId and currentTriPtId and get remaining point id
-            for(int n = 0; n < neighborTriangles.size(); ++n)
+            if(it != ptsNeighTris.begin(ptId) && *it == *(it - 1))
+                continue; // degenerated triangle listed several times
+            const Mesh::triangle& t = tris[*it];
+            for(int k = 0; k < 3; ++k)
             {
-                bool ok_middlePtId = false;
-                bool ok_actTriPtId = false;
-                int remainingPtId = -1; // remaining pt id
-                for(int k = 0; k < 3; ++k)
-                {
-                    int triPtId = tris[neighborTriangles[n]].v[k];
-                    double length = (pts[middlePtId] - pts[triPtId]).size();
-                    if((triPtId != middlePtId) && (triPtId != currentTriPtId) && (length > 0.0) && (!std::isnan(length)))
-                    {
-                        remainingPtId = triPtId;
-                    }
-                    if(triPtId == middlePtId)
-                    {
-                        ok_middlePtId = true;
-                    }
-                    if(triPtId == currentTriPtId)
-                    {
-                        ok_actTriPtId = true;
-                    }
-                }
-
-                if(ok_middlePtId && ok_actTriPtId && (remainingPtId > -1))
-                {
-                    currentTriPtId = remainingPtId;
-                    neighborTriangles.remove(n);
-                    vhid.push_back(currentTriPtId);
-                    isThereTWithCurrentTriPtId = true; // we removed one, so we try again
-                    break;
-                }
+                const int a = t.v[k];
+                const int b = t.v[(k + 1) % 3];
+                const int first = firstIsMax ? std::max(a, b) : std::min(a, b);
+                if(first == ptId)
+                    f(firstIsMax ? std::min(a, b) : std::max(a, b), *it);
             }
         }
+    };
 
-        if(!vhid.empty())
-        {
-            if(currentTriPtId == firstTriPtId)
-            {
-                vhid.pop(); // remove last ... which is first
-            }
+    std::vector<int> offsets(nbPts + 1, 0);
+#pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+        forEachEdge(i, [&](int, int) { ++offsets[i + 1]; });
+    for(int i = 0; i < nbPts; ++i)
+        offsets[i + 1] += offsets[i];
 
-            // remove duplicates
-            StaticVector<int>& vhid1 = out_ptsNeighPts[middlePtId];
-            vhid1.reserve(vhid.size());
-            for(int k1 = 0; k1 < vhid.size(); ++k1)
-            {
-                if(vhid1.indexOf(vhid[k1]) == -1)
-                {
-                    vhid1.push_back(vhid[k1]);
-                }
-            }
-        }
+    out_edges.resize(offsets.back());
+#pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+    {
+        int e = offsets[i];
+        forEachEdge(i, [&](int other, int triId) { out_edges[e++] = Voxel(i, other, triId); });
+        std::sort(out_edges.begin() + offsets[i], out_edges.begin() + offsets[i + 1],
+                  [](const Voxel& a, const Voxel& b) { return (a.y < b.y) || (a.y == b.y && a.z < b.z); });
     }
 }
 
@@ -1148,125 +1282,110 @@ void Mesh::generateMeshFromTrianglesSubset(const StaticVector<int>& visTris, Mes
         t.v[2] = out_ptIdToNewPtId[tris[idTri].v[2]];
         outMesh.tris.push_back(t);
     }
+    outMesh.invalidateTopology();
 }
 
-void Mesh::getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Pixel>& edgesPointsPairs)
+void Mesh::getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Pixel>& edgesPointsPairs) const
 {
     StaticVector<Voxel> edges;
-    edges.reserve(tris.size() * 3);
-
-    for(int i = 0; i < tris.size(); ++i)
-    {
-        int a = tris[i].v[0];
-        int b = tris[i].v[1];
-        int c = tris[i].v[2];
-        edges.push_back(Voxel(std::min(a, b), std::max(a, b), i));
-        edges.push_back(Voxel(std::min(b, c), std::max(b, c), i));
-        edges.push_back(Voxel(std::min(c, a), std::max(c, a), i));
-    }
-
-    qsort(&edges[0], edges.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+    getSortedTrianglesEdges(false, edges);
 
     edgesNeighTris.reserve(tris.size() * 3);
     edgesPointsPairs.reserve(tris.size() * 3);
-    // remove duplicities
-    int i0 = 0;
-    long t1 = mvsUtils::initEstimate();
-    for(int i = 0; i < edges.size(); ++i)
+
+    // group the triangles of each edge
+    int j0 = 0;
+    for(int j = 0; j < edges.size(); ++j)
     {
-        if((i == edges.size() - 1) || (edges[i].x != edges[i + 1].x))
+        if((j == edges.size() - 1) || (edges[j].x != edges[j + 1].x) || (edges[j].y != edges[j + 1].y))
         {
-            StaticVector<Voxel> edges1;
-            edges1.reserve(i - i0 + 1);
-            edges1.getDataWritable().insert(edges1.begin(), edges.begin()+i0, edges.begin()+i+1);
-            qsort(&edges1[0], edges1.size(), sizeof(Voxel), qSortCompareVoxelByYAsc);
-
-            int j0 = 0;
-            for(int j = 0; j < edges1.size(); ++j)
+            edgesPointsPairs.push_back(Pixel(edges[j].x, edges[j].y));
+            edgesNeighTris.resize(edgesNeighTris.size() + 1);
+            StaticVector<int>& neighTris = edgesNeighTris.back();
+            neighTris.reserve(j - j0 + 1);
+            for(int k = j0; k <= j; ++k)
             {
-                if((j == edges1.size() - 1) || (edges1[j].y != edges1[j + 1].y))
-                {
-                    edgesPointsPairs.push_back(Pixel(edges1[j].x, edges1[j].y));
-                    edgesNeighTris.resize(edgesNeighTris.size() + 1);
-                    StaticVector<int>& neighTris = edgesNeighTris.back();
-                    neighTris.reserve(j - j0 + 1);
-                    for(int k = j0; k <= j; ++k)
-                    {
-                        neighTris.push_back(edges1[k].z);
-                    }
-                    j0 = j + 1;
-                }
+                neighTris.push_back(edges[k].z);
             }
-            i0 = i + 1;
+            j0 = j + 1;
         }
-        mvsUtils::printfEstimate(i, edges.size(), t1);
     }
-    mvsUtils::finishEstimate();
 }
 
-void Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVector<int>>& ptsNeighPts, StaticVector<Point3d>& out_nms,
-                                        double maximalNeighDist)
+Point3d Mesh::computeLaplacianSmoothingVector(int ptId, const int* neighPtsBegin, const int* neighPtsEnd, double maximalNeighDist) const
 {
-    out_nms.reserve(pts.size());
+    const int nneighs = static_cast<int>(neighPtsEnd - neighPtsBegin);
+    if(nneighs == 0)
+        return Point3d(0.0, 0.0, 0.0);
 
-    for(int i = 0; i < pts.size(); ++i)
+    const Point3d& p = pts[ptId];
+    double maxNeighDist = 0.0f;
+    // laplacian smoothing vector
+    Point3d n = Point3d(0.0, 0.0, 0.0);
+    for(const int* it = neighPtsBegin; it != neighPtsEnd; ++it)
     {
-        Point3d& p = pts[i];
-        StaticVector<int>& nei = ptsNeighPts[i];
-        int nneighs = 0;
-        if(!nei.empty())
-        {
-            nneighs = nei.size();
-        }
+        n = n + pts[*it];
+        maxNeighDist = std::max(maxNeighDist, (p - pts[*it]).size());
+    }
+    n = (n / (float)nneighs) - p;
 
-        if(nneighs == 0)
-        {
-            out_nms.push_back(Point3d(0.0, 0.0, 0.0));
-        }
-        else
-        {
-            double maxNeighDist = 0.0f;
-            // laplacian smoothing vector
-            Point3d n = Point3d(0.0, 0.0, 0.0);
-            for(int j = 0; j < nneighs; ++j)
-            {
-                n = n + pts[nei[j]];
-                maxNeighDist = std::max(maxNeighDist, (p - pts[nei[j]]).size());
-            }
-            n = (n / (float)nneighs) - p;
+    float d = n.size();
+    n = n.normalize();
 
-            float d = n.size();
-            n = n.normalize();
+    if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
+    {
+        n = Point3d(0.0, 0.0, 0.0);
+    }
+    else
+    {
+        n = n * d;
+    }
 
-            if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
-            {
-                n = Point3d(0.0, 0.0, 0.0);
-            }
-            else
-            {
-                n = n * d;
-            }
+    if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
+    {
+        n = Point3d(0.0, 0.0, 0.0);
+    }
 
-            if(std::isnan(d) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
-            {
-                n = Point3d(0.0, 0.0, 0.0);
-            }
+    if((maximalNeighDist > 0.0f) && (maxNeighDist > maximalNeighDist))
+    {
+        n = Point3d(0.0, 0.0, 0.0);
+    }
 
-            if((maximalNeighDist > 0.0f) && (maxNeighDist > maximalNeighDist))
-            {
-                n = Point3d(0.0, 0.0, 0.0);
-            }
+    return n;
+}
 
-            out_nms.push_back(n);
-        }
+void Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVector<int>>& ptsNeighPts, StaticVector<Point3d>& out_nms,
+                                        double maximalNeighDist)
+{
+    out_nms.resize(pts.size());
+
+#pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+    {
+        const StaticVector<int>& nei = ptsNeighPts[i];
+        out_nms[i] = computeLaplacianSmoothingVector(i, nei.getData().data(), nei.getData().data() + nei.size(), maximalNeighDist);
     }
 }
 
+void Mesh::getLaplacianSmoothingVectors(const Adjacency& ptsNeighPts, StaticVector<Point3d>& out_nms, double maximalNeighDist) const
+{
+    out_nms.resize(pts.size());
+
+#pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+        out_nms[i] = computeLaplacianSmoothingVector(i, ptsNeighPts.begin(i), ptsNeighPts.end(i), maximalNeighDist);
+}
+
 void Mesh::laplacianSmoothPts(float maximalNeighDist)
 {
-    StaticVector<StaticVector<int>> ptsNei;
-    getPtsNeighPtsOrdered(ptsNei);
-    laplacianSmoothPts(ptsNei, maximalNeighDist);
+    StaticVector<Point3d> nms;
+    getLaplacianSmoothingVectors(getPtsNeighPtsOrderedAdjacency(), nms, maximalNeighDist);
+
+    // smooth
+    for(int i = 0; i < pts.size(); ++i)
+    {
+        pts[i] = pts[i] + nms[i];
+    }
 }
 
 void Mesh::laplacianSmoothPts(StaticVector<StaticVector<int>>& ptsNeighPts, double maximalNeighDist)
@@ -1311,45 +1430,52 @@ double Mesh::computeTriangleMinEdgeLength(int idTri) const
                      (pts[t.v[2]] - pts[t.v[0]]).size()});
 }
 
+Point3d Mesh::computeNormalForPt(const int* neighTrisBegin, const int* neighTrisEnd) const
+{
+    if(neighTrisBegin == neighTrisEnd)
+        return Point3d(0.0f, 0.0f, 0.0f);
+
+    Point3d n = Point3d(0.0f, 0.0f, 0.0f);
+    float nn = 0.0f;
+    for(const int* it = neighTrisBegin; it != neighTrisEnd; ++it)
+    {
+        const Point3d n1 = computeTriangleNormal(*it);
+        if(!std::isnan(n1.x) && !std::isnan(n1.y) && !std::isnan(n1.z)) // check if is not NaN
+        {
+            n = n + n1;
+            nn += 1.0f;
+        }
+    }
+    n = n / nn;
+
+    n = n.normalize();
+    if(std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
+    {
+        n = Point3d(0.0f, 0.0f, 0.0f);
+    }
+    return n;
+}
+
 void Mesh::computeNormalsForPts(StaticVector<Point3d>& out_nms) const
 {
-    StaticVector<StaticVector<int>> ptsNeighTris;
-    getPtsNeighborTriangles(ptsNeighTris);
-    computeNormalsForPts(ptsNeighTris, out_nms);
+    const Adjacency& ptsNeighTris = getPtsNeighTrisAdjacency();
+
+    out_nms.resize(pts.size());
+
+#pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+        out_nms[i] = computeNormalForPt(ptsNeighTris.begin(i), ptsNeighTris.end(i));
 }
 
 void Mesh::computeNormalsForPts(StaticVector<StaticVector<int>>& ptsNeighTris, StaticVector<Point3d>& out_nms) const
 {
-    out_nms.reserve(pts.size());
-    out_nms.resize_with(pts.size(), Point3d(0.0f, 0.0f, 0.0f));
+    out_nms.resize(pts.size());
 
+#pragma omp parallel for
     for(int i = 0; i < pts.size(); ++i)
     {
-        StaticVector<int>& triTmp = ptsNeighTris[i];
-        if(!triTmp.empty())
-        {
-            Point3d n = Point3d(0.0f, 0.0f, 0.0f);
-            float nn = 0.0f;
-            for(int j = 0; j < triTmp.size(); ++j)
-            {
-                Point3d n1 = computeTriangleNormal(triTmp[j]);
-                n1 = n1.normalize();
-                if(!std::isnan(n1.x) && !std::isnan(n1.y) && !std::isnan(n1.z)) // check if is not NaN
-                {
-                    n = n + computeTriangleNormal(triTmp[j]);
-                    nn += 1.0f;
-                }
-            }
-            n = n / nn;
-
-            n = n.normalize();
-            if(std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z)) // check if is not NaN
-            {
-                n = Point3d(0.0f, 0.0f, 0.0f);
-            }
-
-            out_nms[i] = n;
-        }
+        const StaticVector<int>& triTmp = ptsNeighTris[i];
+        out_nms[i] = computeNormalForPt(triTmp.getData().data(), triTmp.getData().data() + triTmp.size());
     }
 }
 
@@ -1378,20 +1504,54 @@ void Mesh::removeFreePointsFromMesh(StaticVector<int>& out_ptIdToNewPtId)
 {
     ALICEVISION_LOG_INFO("remove free points from mesh.");
 
-    // declare all triangles as used
-    StaticVector<int> visTris;
-    visTris.reserve(tris.size());
+    const int nbPts = pts.size();
+    out_ptIdToNewPtId.resize(nbPts);
+
+    // flag the points used by the triangles (0), the others are unused (-1)
+    #pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+        out_ptIdToNewPtId[i] = -1;
+
+    #pragma omp parallel for
     for(int i = 0; i < tris.size(); ++i)
     {
-        visTris.push_back(i);
+        for(int k = 0; k < 3; ++k)
+            boost::atomic_ref<int>{out_ptIdToNewPtId[tris[i].v[k]]} = 0;
+    }
+
+    // compact the points and their attributes in place, the new index is never above the old one
+    const bool updateColors = (_colors.size() == nbPts);
+    const bool updateVisibilities = (pointsVisibilities.size() == nbPts);
+    int j = 0;
+    for(int i = 0; i < nbPts; ++i)
+    {
+        if(out_ptIdToNewPtId[i] == -1)
+            continue;
+
+        out_ptIdToNewPtId[i] = j;
+        if(j != i)
+        {
+            pts[j] = pts[i];
+            if(updateColors)
+                _colors[j] = _colors[i];
+            if(updateVisibilities)
+                pointsVisibilities[j].swap(pointsVisibilities[i]);
+        }
+        ++j;
     }
-    // generate a new mesh from all triangles so all unused points will be removed
-    Mesh cleanedMesh;
-    generateMeshFromTrianglesSubset(visTris, cleanedMesh, out_ptIdToNewPtId);
+    pts.resize(j);
+    if(updateColors)
+        _colors.resize(j);
+    if(updateVisibilities)
+        pointsVisibilities.resize(j);
 
-    std::swap(cleanedMesh.pts, pts);
-    std::swap(cleanedMesh.tris, tris);
-    std::swap(cleanedMesh._colors, _colors);
+    #pragma omp parallel for
+    for(int i = 0; i < tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            tris[i].v[k] = out_ptIdToNewPtId[tris[i].v[k]];
+    }
+    invalidateTopology();
 }
 
 double Mesh::computeTriangleProjectionArea(const triangle_proj& tp) const
@@ -1841,6 +2001,7 @@ int Mesh::subdivideMeshOnce(const Mesh& refMesh, const GEO::AdaptiveKdTree& refM
 
     pts.swap(new_pts);
     tris.swap(new_tris);
+    invalidateTopology();
     uvCoords.swap(new_uvCoords);
     trisUvIds.swap(new_trisUvIds);
     _trisMtlIds.swap(new_trisMtlIds);
@@ -1850,19 +2011,19 @@ int Mesh::subdivideMeshOnce(const Mesh& refMesh, const GEO::AdaptiveKdTree& refM
 
 double Mesh::computeAverageEdgeLength() const
 {
+    if(tris.empty())
+    {
+        return 0.0;
+    }
+
     double s = 0.0;
-    double n = 0.0;
+    #pragma omp parallel for reduction(+ : s)
     for(int i = 0; i < tris.size(); ++i)
     {
         s += computeTriangleMaxEdgeLength(i);
-        n += 1.0;
-    }
-    if(n == 0.0)
-    {
-        return 0.0;
     }
 
-    return (s / n);
+    return (s / tris.size());
 }
 
 double Mesh::computeLocalAverageEdgeLength(const std::vector<std::vector<int>>& ptsNeighbors, int ptId) const
@@ -1896,23 +2057,44 @@ void Mesh::letJustTringlesIdsInMesh(StaticVector<int>& trisIdsToStay)
         trisTmp.push_back(tris[trisIdsToStay[i]]);
     }
     tris.swap(trisTmp);
+    invalidateTopology();
 }
 
 void Mesh::letJustTringlesIdsInMesh(const StaticVectorBool& trisToStay)
 {
-    int nbTris = 0;
-    for(int i = 0; i < trisToStay.size(); ++i)
-        if(trisToStay[i])
-            ++nbTris;
-
-    StaticVector<Mesh::triangle> trisTmp;
-    trisTmp.reserve(nbTris);
+    // compact the triangles and their attributes in place, the new index is never above the old one
+    const int nbTris = tris.size();
+    const bool updateMtlIds = (_trisMtlIds.size() == nbTris);
+    const bool updateUvIds = (trisUvIds.size() == nbTris);
+    const bool updateNormalsIds = (trisNormalsIds.size() == nbTris);
 
+    int j = 0;
     for(int i = 0; i < trisToStay.size(); ++i)
-        if(trisToStay[i])
-            trisTmp.push_back(tris[i]);
+    {
+        if(!trisToStay[i])
+            continue;
 
-    tris.swap(trisTmp);
+        if(j != i)
+        {
+            tris[j] = tris[i];
+            if(updateMtlIds)
+                _trisMtlIds[j] = _trisMtlIds[i];
+            if(updateUvIds)
+                trisUvIds[j] = trisUvIds[i];
+            if(updateNormalsIds)
+                trisNormalsIds[j] = trisNormalsIds[i];
+        }
+        ++j;
+    }
+    tris.resize(j);
+    if(updateMtlIds)
+        _trisMtlIds.resize(j);
+    if(updateUvIds)
+        trisUvIds.resize(j);
+    if(updateNormalsIds)
+        trisNormalsIds.resize(j);
+
+    invalidateTopology();
 }
 
 void Mesh::computeTrisCams(StaticVector<StaticVector<int>>& trisCams, const mvsUtils::MultiViewParams& mp, const std::string tmpDir)
@@ -2199,6 +2381,7 @@ void Mesh::invertTriangleOrientations()
         Mesh::triangle& t = tris[i];
         std::swap(t.v[1], t.v[2]);
     }
+    invalidateTopology();
 }
 
 void Mesh::changeTriPtId(int triId, int oldPtId, int newPtId)
@@ -2210,6 +2393,7 @@ void Mesh::changeTriPtId(int triId, int oldPtId, int newPtId)
             tris[triId].v[k] = newPtId;
         }
     }
+    invalidateTopology();
 }
 
 int Mesh::getTriPtIndex(int triId, int ptId, bool failIfDoesNotExists) const
@@ -2351,26 +2535,10 @@ void Mesh::getLargestConnectedComponentTrisIds(StaticVector<int>& out) const
     }
 }
 
-void Mesh::load(const std::string& filepath, bool mergeCoincidentVerts, Material* material)
+void Mesh::loadWithAssimp(const std::string& filepath, Material* material)
 {
     Assimp::Importer importer;
 
-    pts.clear();
-    tris.clear();
-    trisNormalsIds.clear();
-    trisUvIds.clear();
-    _trisMtlIds.clear();
-    _colors.clear();
-    nmtls = 0;
-    uvCoords.clear();
-    normals.clear();
-    pointsVisibilities.clear();
-
-    if(!boost::filesystem::exists(filepath))
-    {
-        ALICEVISION_THROW_ERROR("Mesh::load: no such file: " << filepath);
-    }
-
     // see https://github.com/assimp/assimp/blob/master/include/assimp/postprocess.h#L85
     const unsigned int pFlags =
         // If this flag is not specified, no vertices are referenced by more than one face
@@ -2536,36 +2704,6 @@ void Mesh::load(const std::string& filepath, bool mergeCoincidentVerts, Material
         }
     }
 
-    // merge coincident verts and update triangle ids
-    // keep uvs and normals as is to allow for face varying data
-    if (mergeCoincidentVerts)
-    {
-        std::map<int, int> oldToNewMap;
-        StaticVector<Point3d> uniquePoints;
-        for(int i = 0; i < pts.size(); ++i)
-        {
-            const Point3d& p = pts[i];
-            const auto it = std::find(uniquePoints.begin(), uniquePoints.end(), p);
-            if(it == uniquePoints.end())
-            {
-                oldToNewMap[i] = uniquePoints.size();
-                uniquePoints.push_back(p);
-            }
-            else
-            {
-                oldToNewMap[i] = static_cast<int>(std::distance(uniquePoints.begin(), it));
-            }
-        }
-
-        pts = uniquePoints;
-        for(triangle& f : tris)
-        {
-            f.v[0] = oldToNewMap[f.v[0]];
-            f.v[1] = oldToNewMap[f.v[1]];
-            f.v[2] = oldToNewMap[f.v[2]];
-        }
-    }
-
     // set number of materials used
     const std::unordered_set<int> materialIds = std::unordered_set<int>(_trisMtlIds.begin(), _trisMtlIds.end());
     nmtls = static_cast<int>(materialIds.size());
@@ -2606,6 +2744,67 @@ void Mesh::load(const std::string& filepath, bool mergeCoincidentVerts, Material
             }
         }
     }
+}
+
+void Mesh::load(const std::string& filepath, bool mergeCoincidentVerts, Material* material)
+{
+    pts.clear();
+    tris.clear();
+    trisNormalsIds.clear();
+    trisUvIds.clear();
+    _trisMtlIds.clear();
+    _colors.clear();
+    nmtls = 0;
+    uvCoords.clear();
+    normals.clear();
+    pointsVisibilities.clear();
+
+    if(!boost::filesystem::exists(filepath))
+    {
+        ALICEVISION_THROW_ERROR("Mesh::load: no such file: " << filepath);
+    }
+
+    // native readers for the PLY and OBJ files without materials, they fall back to Assimp otherwise
+    const std::string extension = boost::to_lower_copy(boost::filesystem::path(filepath).extension().string());
+    const bool nativeLoaded = (material == nullptr) &&
+                              ((extension == ".ply" && loadPly(filepath, *this)) ||
+                               (extension == ".obj" && loadObj(filepath, *this)));
+    if(!nativeLoaded)
+    {
+        loadWithAssimp(filepath, material);
+    }
+
+    // merge coincident verts and update triangle ids
+    // keep uvs and normals as is to allow for face varying data
+    if (mergeCoincidentVerts)
+    {
+        std::map<int, int> oldToNewMap;
+        StaticVector<Point3d> uniquePoints;
+        for(int i = 0; i < pts.size(); ++i)
+        {
+            const Point3d& p = pts[i];
+            const auto it = std::find(uniquePoints.begin(), uniquePoints.end(), p);
+            if(it == uniquePoints.end())
+            {
+                oldToNewMap[i] = uniquePoints.size();
+                uniquePoints.push_back(p);
+            }
+            else
+            {
+                oldToNewMap[i] = static_cast<int>(std::distance(uniquePoints.begin(), it));
+            }
+        }
+
+        pts = uniquePoints;
+        for(triangle& f : tris)
+        {
+            f.v[0] = oldToNewMap[f.v[0]];
+            f.v[1] = oldToNewMap[f.v[1]];
+            f.v[2] = oldToNewMap[f.v[2]];
+        }
+    }
+
+    invalidateTopology();
 
     ALICEVISION_LOG_DEBUG("Vertices: " << pts.size());
     ALICEVISION_LOG_DEBUG("Triangles: " << tris.size());
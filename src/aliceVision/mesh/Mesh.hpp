@@ -16,6 +16,11 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/stl/bitmask.hpp>
 
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 namespace GEO {
     class AdaptiveKdTree;
 }
@@ -145,12 +150,78 @@ public:
         }
     };
 
+    /**
+     * @brief Compressed sparse row (CSR) adjacency:
+     *        the neighbors of the element i are values[offsets[i]] to values[offsets[i+1]-1].
+     */
+    struct Adjacency
+    {
+        std::vector<int> offsets;
+        std::vector<int> values;
+
+        std::size_t nbElements() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+        int size(int i) const { return offsets[i + 1] - offsets[i]; }
+        const int* begin(int i) const { return values.data() + offsets[i]; }
+        const int* end(int i) const { return values.data() + offsets[i + 1]; }
+    };
+
 protected:
     /// Per-vertex color data
     std::vector<rgb> _colors;
     /// Per triangle material id
     std::vector<int> _trisMtlIds;
 
+    /**
+     * @brief Cached connectivity, shared between copies of the same topology.
+     * @note Built under the mutex by the first caller, copies get their own mutex.
+     *       A moved-from cache is left empty, as the moved-from mesh.
+     */
+    struct TopologyCache
+    {
+        mutable std::mutex mutex;
+        std::shared_ptr<const Adjacency> ptsNeighTris;
+        std::shared_ptr<const Adjacency> ptsNeighPtsOrdered;
+
+        TopologyCache() = default;
+
+        TopologyCache(const TopologyCache& other)
+        {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            ptsNeighTris = other.ptsNeighTris;
+            ptsNeighPtsOrdered = other.ptsNeighPtsOrdered;
+        }
+
+        TopologyCache& operator=(const TopologyCache& other)
+        {
+            if(this != &other)
+            {
+                std::scoped_lock lock(mutex, other.mutex);
+                ptsNeighTris = other.ptsNeighTris;
+                ptsNeighPtsOrdered = other.ptsNeighPtsOrdered;
+            }
+            return *this;
+        }
+
+        TopologyCache(TopologyCache&& other)
+        {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            ptsNeighTris = std::move(other.ptsNeighTris);
+            ptsNeighPtsOrdered = std::move(other.ptsNeighPtsOrdered);
+        }
+
+        TopologyCache& operator=(TopologyCache&& other)
+        {
+            if(this != &other)
+            {
+                std::scoped_lock lock(mutex, other.mutex);
+                ptsNeighTris = std::move(other.ptsNeighTris);
+                ptsNeighPtsOrdered = std::move(other.ptsNeighPtsOrdered);
+            }
+            return *this;
+        }
+    };
+    mutable TopologyCache _topologyCache;
+
 public:
     StaticVector<Point3d> pts;
     StaticVector<Mesh::triangle> tris;
@@ -165,11 +236,22 @@ public:
     Mesh();
     ~Mesh();
 
+    Mesh(const Mesh&) = default;
+    Mesh& operator=(const Mesh&) = default;
+    Mesh(Mesh&&) = default;
+    Mesh& operator=(Mesh&&) = default;
+
     void save(const std::string& filepath);
 
     bool loadFromBin(const std::string& binFilepath);
     void saveToBin(const std::string& binFilepath);
     void load(const std::string& filepath, bool mergeCoincidentVerts=false, Material* material=nullptr);
+    /**
+     * @brief Load any file format supported by Assimp, with its materials.
+     * @note Called by load for the files not handled by the native PLY/OBJ readers (see meshIO.hpp),
+     *       the mesh should be empty.
+     */
+    void loadWithAssimp(const std::string& filepath, Material* material=nullptr);
 
     void addMesh(const Mesh& mesh);
 
@@ -193,6 +275,36 @@ public:
     void getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const;
     void getPtsNeighPtsOrdered(StaticVector<StaticVector<int>>& out_ptsNeighTris) const;
 
+    /**
+     * @brief Get the triangles around each vertex, sorted by ascending triangle index.
+     * @note Built in parallel on first use and cached until invalidateTopology() is called.
+     *       Thread-safe, the returned reference is valid until the next invalidation.
+     */
+    const Adjacency& getPtsNeighTrisAdjacency() const;
+
+    /**
+     * @brief Get the neighbor vertices of each vertex, ordered around the vertex.
+     * @note The walk around each vertex starts from a fan border vertex if any,
+     *       otherwise from the vertex following it in its lowest index triangle.
+     *       Built in parallel on first use and cached until invalidateTopology() is called.
+     *       Thread-safe, the returned reference is valid until the next invalidation.
+     */
+    const Adjacency& getPtsNeighPtsOrderedAdjacency() const;
+
+    /**
+     * @brief Invalidate the cached connectivity.
+     * @note Mesh methods changing the triangles or the number of points call it,
+     *       it must be called after editing pts or tris directly.
+     */
+    void invalidateTopology();
+
+    /**
+     * @brief Get all the triangles edges as Voxel(vertex, other vertex, triangle id), sorted in lexicographic order.
+     * @param[in] firstIsMax if true the first vertex of each edge is its max vertex index, otherwise its min vertex index
+     * @param[out] out_edges one entry per triangle edge
+     */
+    void getSortedTrianglesEdges(bool firstIsMax, StaticVector<Voxel>& out_edges) const;
+
     void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::string& tmpDir, const mvsUtils::MultiViewParams& mp, int rc, int w, int h);
     void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::string& depthMapFilepath, const std::string& trisMapFilepath,
                                                   const mvsUtils::MultiViewParams& mp, int rc, int w, int h);
@@ -204,11 +316,12 @@ public:
 
     void generateMeshFromTrianglesSubset(const StaticVector<int>& visTris, Mesh& outMesh, StaticVector<int>& out_ptIdToNewPtId) const;
 
-    void getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Pixel>& edgesPointsPairs);
+    void getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Pixel>& edgesPointsPairs) const;
     void getTrianglesEdgesIds(const StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Voxel>& out) const;
 
     void getLaplacianSmoothingVectors(StaticVector<StaticVector<int>>& ptsNeighPts, StaticVector<Point3d>& out_nms,
                                       double maximalNeighDist = -1.0f);
+    void getLaplacianSmoothingVectors(const Adjacency& ptsNeighPts, StaticVector<Point3d>& out_nms, double maximalNeighDist = -1.0f) const;
     void laplacianSmoothPts(float maximalNeighDist = -1.0f);
     void laplacianSmoothPts(StaticVector<StaticVector<int>>& ptsNeighPts, double maximalNeighDist = -1.0f);
     void computeNormalsForPts(StaticVector<Point3d>& out_nms) const;
@@ -219,9 +332,20 @@ public:
     double computeTriangleMaxEdgeLength(int idTri) const;
     double computeTriangleMinEdgeLength(int idTri) const;
 
+    /**
+     * @brief Remove in place the points not used by any triangle.
+     * @note The colors and the points visibilities are compacted with the points.
+     * @param[out] out_ptIdToNewPtId the new index of each point, -1 if removed
+     */
     void removeFreePointsFromMesh(StaticVector<int>& out_ptIdToNewPtId);
 
     void letJustTringlesIdsInMesh(StaticVector<int>& trisIdsToStay);
+
+    /**
+     * @brief Keep in place the flagged triangles only.
+     * @note The material, UV and normal ids of the triangles are compacted with them,
+     *       the points are kept (see removeFreePointsFromMesh).
+     */
     void letJustTringlesIdsInMesh(const StaticVectorBool& trisToStay);
 
     double computeAverageEdgeLength() const;
@@ -244,6 +368,16 @@ public:
 
     Point2d getTrianglePixelInternalPoint(Mesh::triangle_proj& tp, Mesh::rectangle& re);
 
+private:
+    Point3d computeLaplacianSmoothingVector(int ptId, const int* neighPtsBegin, const int* neighPtsEnd, double maximalNeighDist) const;
+    Point3d computeNormalForPt(const int* neighTrisBegin, const int* neighTrisEnd) const;
+    /// Build the triangles around each vertex
+    std::shared_ptr<const Adjacency> computePtsNeighTrisAdjacency() const;
+    /// Build the ordered neighbor vertices of each vertex from the triangles around each vertex
+    std::shared_ptr<const Adjacency> computePtsNeighPtsOrderedAdjacency(const Adjacency& ptsNeighTris) const;
+
+public:
+
     int subdivideMesh(const Mesh& refMesh, float ratioSubdiv, bool remapVisibilities);
     int subdivideMeshOnce(const Mesh& refMesh, const GEO::AdaptiveKdTree& refMesh_kdTree, float ratioSubdiv);
 
@@ -14,6 +14,10 @@ MeshAnalyze::MeshAnalyze(mvsUtils::MultiViewParams* _mp)
     : MeshClean(_mp)
 {}
 
+MeshAnalyze::MeshAnalyze(mvsUtils::MultiViewParams* _mp, Mesh&& mesh)
+    : MeshClean(_mp, std::move(mesh))
+{}
+
 MeshAnalyze::~MeshAnalyze() = default;
 
 double MeshAnalyze::getCotanOfAngle(Point3d& vo, Point3d& v1, Point3d& v2)
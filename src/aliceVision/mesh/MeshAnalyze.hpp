@@ -18,6 +18,7 @@ class MeshAnalyze : public MeshClean
 {
 public:
     MeshAnalyze(mvsUtils::MultiViewParams* _mp);
+    MeshAnalyze(mvsUtils::MultiViewParams* _mp, Mesh&& mesh);
     ~MeshAnalyze();
 
     double getCotanOfAngle(Point3d& vo, Point3d& v1, Point3d& v2);
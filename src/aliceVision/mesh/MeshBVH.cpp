@@ -0,0 +1,617 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshBVH.hpp"
+#include "Mesh.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+constexpr int nbBins = 12;
+constexpr int maxStackSize = 128;
+constexpr int maxSahDepth = 48;                 //< median splits below, to bound the tree depth
+constexpr int minParallelSubtreeSize = 1 << 14; //< smallest subtree built by a single thread
+constexpr float traversalCost = 1.0f;           //< relative to the triangle intersection cost
+
+struct BBox
+{
+    float min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+    void add(const float p[3])
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            min[k] = std::min(min[k], p[k]);
+            max[k] = std::max(max[k], p[k]);
+        }
+    }
+
+    void add(const BBox& b)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            min[k] = std::min(min[k], b.min[k]);
+            max[k] = std::max(max[k], b.max[k]);
+        }
+    }
+
+    float halfArea() const
+    {
+        const float dx = max[0] - min[0];
+        const float dy = max[1] - min[1];
+        const float dz = max[2] - min[2];
+        return (dx < 0.0f) ? 0.0f : dx * dy + dy * dz + dz * dx;
+    }
+};
+
+/**
+ * @brief Ray in the BVH coordinates (relative to the mesh center) with the inverse direction for the slab tests.
+ */
+struct Ray
+{
+    float o[3];
+    float d[3];
+    float invD[3];
+};
+
+inline void setRay(const Point3d& origin, const Point3d& direction, const Point3d& center, float out_o[3], float out_d[3], float out_invD[3])
+{
+    out_o[0] = static_cast<float>(origin.x - center.x);
+    out_o[1] = static_cast<float>(origin.y - center.y);
+    out_o[2] = static_cast<float>(origin.z - center.z);
+    out_d[0] = static_cast<float>(direction.x);
+    out_d[1] = static_cast<float>(direction.y);
+    out_d[2] = static_cast<float>(direction.z);
+    for(int k = 0; k < 3; ++k)
+        out_invD[k] = 1.0f / out_d[k];
+}
+
+} // namespace
+
+/**
+ * @brief Top-down builder of the node hierarchy over a range of primitives.
+ */
+class MeshBVHBuilder
+{
+public:
+    struct Subtree
+    {
+        int nodeIndex;
+        int begin;
+        int end;
+        int depth;
+    };
+
+    using Node = MeshBVH::Node;
+
+    MeshBVHBuilder(const std::vector<BBox>& primBoxes, const std::vector<std::array<float, 3>>& centroids, std::vector<int>& primIds,
+                   int maxLeafSize)
+      : _primBoxes(primBoxes), _centroids(centroids), _primIds(primIds), _maxLeafSize(maxLeafSize)
+    {}
+
+    /**
+     * @brief Build the subtree of the node on the primitives [begin, end).
+     * @param[in,out] nodes the nodes array, nodes[nodeIndex] should exist
+     * @param[out] out_pending if not null, the subtrees smaller than minParallelSubtreeSize are not built but added to this list
+     */
+    void build(std::vector<Node>& nodes, int nodeIndex, int begin, int end, int depth, std::vector<Subtree>* out_pending) const
+    {
+        BBox bounds;
+        BBox centroidBounds;
+        for(int i = begin; i < end; ++i)
+        {
+            const int primId = _primIds[i];
+            bounds.add(_primBoxes[primId]);
+            centroidBounds.add(_centroids[primId].data());
+        }
+        std::copy(bounds.min, bounds.min + 3, nodes[nodeIndex].bmin);
+        std::copy(bounds.max, bounds.max + 3, nodes[nodeIndex].bmax);
+
+        const int n = end - begin;
+        if(out_pending != nullptr && n <= minParallelSubtreeSize)
+        {
+            out_pending->push_back({nodeIndex, begin, end, depth});
+            return;
+        }
+
+        const auto setLeaf = [&]() {
+            nodes[nodeIndex].leftOrFirst = begin;
+            nodes[nodeIndex].count = n;
+        };
+
+        if(n <= 1)
+        {
+            setLeaf();
+            return;
+        }
+
+        int axis = 0;
+        for(int k = 1; k < 3; ++k)
+        {
+            if(centroidBounds.max[k] - centroidBounds.min[k] > centroidBounds.max[axis] - centroidBounds.min[axis])
+                axis = k;
+        }
+        if(centroidBounds.max[axis] <= centroidBounds.min[axis])
+        {
+            // all centroids at the same position, no possible split
+            setLeaf();
+            return;
+        }
+
+        int mid = begin;
+        if(depth < maxSahDepth)
+        {
+            // binned SAH on each axis
+            float bestCost = std::numeric_limits<float>::max();
+            int bestAxis = -1;
+            int bestBin = -1;
+
+            for(int k = 0; k < 3; ++k)
+            {
+                const float extent = centroidBounds.max[k] - centroidBounds.min[k];
+                if(extent <= 0.0f)
+                    continue;
+                const float binScale = nbBins / extent;
+
+                BBox binBoxes[nbBins];
+                int binCounts[nbBins] = {0};
+                for(int i = begin; i < end; ++i)
+                {
+                    const int primId = _primIds[i];
+                    const int b = getBin(_centroids[primId][k], centroidBounds.min[k], binScale);
+                    binBoxes[b].add(_primBoxes[primId]);
+                    ++binCounts[b];
+                }
+
+                // sweep from the right to get the right side costs, then from the left
+                float rightAreas[nbBins];
+                int rightCounts[nbBins];
+                BBox rightBox;
+                int rightCount = 0;
+                for(int b = nbBins - 1; b > 0; --b)
+                {
+                    rightBox.add(binBoxes[b]);
+                    rightCount += binCounts[b];
+                    rightAreas[b] = rightBox.halfArea();
+                    rightCounts[b] = rightCount;
+                }
+                BBox leftBox;
+                int leftCount = 0;
+                for(int b = 0; b < nbBins - 1; ++b)
+                {
+                    leftBox.add(binBoxes[b]);
+                    leftCount += binCounts[b];
+                    if(leftCount == 0 || rightCounts[b + 1] == 0)
+                        continue;
+                    const float cost = leftCount * leftBox.halfArea() + rightCounts[b + 1] * rightAreas[b + 1];
+                    if(cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = k;
+                        bestBin = b;
+                    }
+                }
+            }
+
+            const float leafCost = static_cast<float>(n);
+            const float splitCost = (bounds.halfArea() > 0.0f) ? traversalCost + bestCost / bounds.halfArea() : leafCost;
+            if(n <= _maxLeafSize && (bestAxis < 0 || splitCost >= leafCost))
+            {
+                setLeaf();
+                return;
+            }
+
+            if(bestAxis >= 0)
+            {
+                axis = bestAxis;
+                const float minCentroid = centroidBounds.min[axis];
+                const float binScale = nbBins / (centroidBounds.max[axis] - minCentroid);
+                mid = static_cast<int>(std::partition(_primIds.begin() + begin, _primIds.begin() + end,
+                                                      [&](int primId) { return getBin(_centroids[primId][axis], minCentroid, binScale) <= bestBin; }) -
+                                       _primIds.begin());
+            }
+        }
+        else if(n <= _maxLeafSize)
+        {
+            setLeaf();
+            return;
+        }
+
+        if(mid <= begin || mid >= end)
+        {
+            // median split on the largest centroid extent
+            mid = begin + n / 2;
+            std::nth_element(_primIds.begin() + begin, _primIds.begin() + mid, _primIds.begin() + end, [&](int a, int b) {
+                return (_centroids[a][axis] < _centroids[b][axis]) || (_centroids[a][axis] == _centroids[b][axis] && a < b);
+            });
+        }
+
+        const int left = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+        nodes.emplace_back();
+        nodes[nodeIndex].leftOrFirst = left;
+        nodes[nodeIndex].count = -axis;
+
+        build(nodes, left, begin, mid, depth + 1, out_pending);
+        build(nodes, left + 1, mid, end, depth + 1, out_pending);
+    }
+
+private:
+    static int getBin(float centroid, float minCentroid, float binScale)
+    {
+        return std::min(nbBins - 1, static_cast<int>((centroid - minCentroid) * binScale));
+    }
+
+    const std::vector<BBox>& _primBoxes;
+    const std::vector<std::array<float, 3>>& _centroids;
+    std::vector<int>& _primIds;
+    const int _maxLeafSize;
+};
+
+MeshBVH::MeshBVH(const Mesh& mesh, int maxLeafSize)
+{
+    const int nbTris = mesh.tris.size();
+    if(nbTris == 0)
+        return;
+
+    // center of the mesh bounding box, to keep the single precision coordinates small
+    Point3d bmin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bmax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        const Point3d& p = mesh.pts[i];
+        bmin = Point3d(std::min(bmin.x, p.x), std::min(bmin.y, p.y), std::min(bmin.z, p.z));
+        bmax = Point3d(std::max(bmax.x, p.x), std::max(bmax.y, p.y), std::max(bmax.z, p.z));
+    }
+    _center = (bmin + bmax) * 0.5;
+
+    std::vector<BBox> primBoxes(nbTris);
+    std::vector<std::array<float, 3>> centroids(nbTris);
+    std::vector<int> primIds(nbTris);
+
+#pragma omp parallel for
+    for(int i = 0; i < nbTris; ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            const Point3d p = mesh.pts[mesh.tris[i].v[k]] - _center;
+            const float pf[3] = {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)};
+            primBoxes[i].add(pf);
+        }
+        for(int k = 0; k < 3; ++k)
+            centroids[i][k] = (primBoxes[i].min[k] + primBoxes[i].max[k]) * 0.5f;
+        primIds[i] = i;
+    }
+
+    const MeshBVHBuilder builder(primBoxes, centroids, primIds, std::max(1, maxLeafSize));
+
+    // top levels first, then the remaining subtrees in parallel
+    _nodes.resize(1);
+    std::vector<MeshBVHBuilder::Subtree> subtrees;
+    builder.build(_nodes, 0, 0, nbTris, 0, &subtrees);
+
+    std::vector<std::vector<Node>> subtreesNodes(subtrees.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for(int s = 0; s < static_cast<int>(subtrees.size()); ++s)
+    {
+        const MeshBVHBuilder::Subtree& subtree = subtrees[s];
+        subtreesNodes[s].resize(1);
+        builder.build(subtreesNodes[s], 0, subtree.begin, subtree.end, subtree.depth, nullptr);
+    }
+
+    // concatenate the subtrees, in order so the layout does not depend on the threads
+    int offset = static_cast<int>(_nodes.size());
+    std::size_t nbNodes = _nodes.size();
+    for(const auto& subtreeNodes : subtreesNodes)
+        nbNodes += subtreeNodes.size() - 1;
+    _nodes.resize(nbNodes);
+
+    for(std::size_t s = 0; s < subtrees.size(); ++s)
+    {
+        // local node j > 0 is moved to offset + j - 1, the local root replaces the pending node
+        const std::vector<Node>& subtreeNodes = subtreesNodes[s];
+        for(std::size_t j = 0; j < subtreeNodes.size(); ++j)
+        {
+            Node& node = _nodes[(j == 0) ? subtrees[s].nodeIndex : offset + j - 1];
+            node = subtreeNodes[j];
+            if(node.count <= 0)
+                node.leftOrFirst += offset - 1;
+        }
+        offset += static_cast<int>(subtreeNodes.size()) - 1;
+    }
+
+    // triangles in leaves order
+    _triangles.resize(nbTris);
+    _trisIds.resize(nbTris);
+
+#pragma omp parallel for
+    for(int i = 0; i < nbTris; ++i)
+    {
+        const int triId = primIds[i];
+        const Mesh::triangle& t = mesh.tris[triId];
+        const Point3d v0 = mesh.pts[t.v[0]] - _center;
+        const Point3d e1 = mesh.pts[t.v[1]] - mesh.pts[t.v[0]];
+        const Point3d e2 = mesh.pts[t.v[2]] - mesh.pts[t.v[0]];
+
+        Triangle& tri = _triangles[i];
+        tri.v0[0] = static_cast<float>(v0.x);
+        tri.v0[1] = static_cast<float>(v0.y);
+        tri.v0[2] = static_cast<float>(v0.z);
+        tri.e1[0] = static_cast<float>(e1.x);
+        tri.e1[1] = static_cast<float>(e1.y);
+        tri.e1[2] = static_cast<float>(e1.z);
+        tri.e2[0] = static_cast<float>(e2.x);
+        tri.e2[1] = static_cast<float>(e2.y);
+        tri.e2[2] = static_cast<float>(e2.z);
+        _trisIds[i] = triId;
+    }
+
+    ALICEVISION_LOG_DEBUG("MeshBVH: " << nbTris << " triangles, " << _nodes.size() << " nodes.");
+}
+
+namespace {
+
+/**
+ * @brief Slab test of the ray against the node box.
+ */
+template <typename NodeT>
+inline bool intersectBox(const NodeT& node, const Ray& ray, float tMax, float& out_tNear)
+{
+    float t0 = 0.0f;
+    float t1 = tMax;
+    for(int k = 0; k < 3; ++k)
+    {
+        float tA = (node.bmin[k] - ray.o[k]) * ray.invD[k];
+        float tB = (node.bmax[k] - ray.o[k]) * ray.invD[k];
+        if(tA > tB)
+            std::swap(tA, tB);
+        t0 = std::max(t0, tA);
+        t1 = std::min(t1, tB);
+    }
+    out_tNear = t0;
+    return t0 <= t1;
+}
+
+/**
+ * @brief Möller-Trumbore ray/triangle intersection, both sides.
+ */
+template <typename TriangleT>
+inline bool intersectTriangle(const TriangleT& tri, const Ray& ray, float tMax, float& out_t)
+{
+    const float* d = ray.d;
+    const float px = d[1] * tri.e2[2] - d[2] * tri.e2[1];
+    const float py = d[2] * tri.e2[0] - d[0] * tri.e2[2];
+    const float pz = d[0] * tri.e2[1] - d[1] * tri.e2[0];
+    const float det = tri.e1[0] * px + tri.e1[1] * py + tri.e1[2] * pz;
+    if(det == 0.0f)
+        return false;
+    const float invDet = 1.0f / det;
+
+    const float sx = ray.o[0] - tri.v0[0];
+    const float sy = ray.o[1] - tri.v0[1];
+    const float sz = ray.o[2] - tri.v0[2];
+    const float u = (sx * px + sy * py + sz * pz) * invDet;
+    if(u < 0.0f || u > 1.0f)
+        return false;
+
+    const float qx = sy * tri.e1[2] - sz * tri.e1[1];
+    const float qy = sz * tri.e1[0] - sx * tri.e1[2];
+    const float qz = sx * tri.e1[1] - sy * tri.e1[0];
+    const float v = (d[0] * qx + d[1] * qy + d[2] * qz) * invDet;
+    if(v < 0.0f || u + v > 1.0f)
+        return false;
+
+    const float t = (tri.e2[0] * qx + tri.e2[1] * qy + tri.e2[2] * qz) * invDet;
+    if(t <= 0.0f || t >= tMax)
+        return false;
+    out_t = t;
+    return true;
+}
+
+} // namespace
+
+bool MeshBVH::intersect(const Point3d& origin, const Point3d& direction, double tMax, Hit& out_hit) const
+{
+    out_hit = Hit();
+    if(_nodes.empty())
+        return false;
+
+    Ray ray;
+    setRay(origin, direction, _center, ray.o, ray.d, ray.invD);
+
+    float tBest = static_cast<float>(tMax);
+    int bestIndex = -1;
+
+    int stack[maxStackSize];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const Node& node = _nodes[stack[--stackSize]];
+        float tNear;
+        if(!intersectBox(node, ray, tBest, tNear))
+            continue;
+
+        if(node.count > 0)
+        {
+            for(int i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                float t;
+                if(intersectTriangle(_triangles[i], ray, tBest, t))
+                {
+                    tBest = t;
+                    bestIndex = i;
+                }
+            }
+            continue;
+        }
+
+        // visit the near child first
+        const int axis = -node.count;
+        const bool leftFirst = ray.d[axis] >= 0.0f;
+        stack[stackSize++] = leftFirst ? node.leftOrFirst + 1 : node.leftOrFirst;
+        stack[stackSize++] = leftFirst ? node.leftOrFirst : node.leftOrFirst + 1;
+    }
+
+    if(bestIndex < 0)
+        return false;
+
+    out_hit.distance = tBest;
+    out_hit.triId = _trisIds[bestIndex];
+    return true;
+}
+
+bool MeshBVH::isOccluded(const Point3d& origin, const Point3d& direction, double tMax) const
+{
+    if(_nodes.empty())
+        return false;
+
+    Ray ray;
+    setRay(origin, direction, _center, ray.o, ray.d, ray.invD);
+    const float tMaxf = static_cast<float>(tMax);
+
+    int stack[maxStackSize];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const Node& node = _nodes[stack[--stackSize]];
+        float tNear;
+        if(!intersectBox(node, ray, tMaxf, tNear))
+            continue;
+
+        if(node.count > 0)
+        {
+            for(int i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                float t;
+                if(intersectTriangle(_triangles[i], ray, tMaxf, t))
+                    return true;
+            }
+            continue;
+        }
+
+        stack[stackSize++] = node.leftOrFirst + 1;
+        stack[stackSize++] = node.leftOrFirst;
+    }
+    return false;
+}
+
+void MeshBVH::intersect(const RayPacket& packet, std::array<Hit, packetSize>& out_hits) const
+{
+    // structure of arrays, so the per-ray loops below are vectorized by the compiler
+    float o[3][packetSize];
+    float d[3][packetSize];
+    float invD[3][packetSize];
+    float tBest[packetSize];
+    int bestIndex[packetSize];
+    int firstActive = -1;
+
+    for(int r = 0; r < packetSize; ++r)
+    {
+        float ro[3], rd[3], rinvD[3];
+        setRay(packet.origins[r], packet.directions[r], _center, ro, rd, rinvD);
+        for(int k = 0; k < 3; ++k)
+        {
+            o[k][r] = ro[k];
+            d[k][r] = rd[k];
+            invD[k][r] = rinvD[k];
+        }
+        // inactive rays have a negative tMax: no box is intersected
+        tBest[r] = static_cast<float>(packet.tMax[r]);
+        bestIndex[r] = -1;
+        if(firstActive < 0 && packet.tMax[r] >= 0.0)
+            firstActive = r;
+    }
+
+    out_hits.fill(Hit());
+    if(_nodes.empty() || firstActive < 0)
+        return;
+
+    int stack[maxStackSize];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const Node& node = _nodes[stack[--stackSize]];
+
+        bool anyHit = false;
+        for(int r = 0; r < packetSize; ++r)
+        {
+            float t0 = 0.0f;
+            float t1 = tBest[r];
+            for(int k = 0; k < 3; ++k)
+            {
+                const float tA = (node.bmin[k] - o[k][r]) * invD[k][r];
+                const float tB = (node.bmax[k] - o[k][r]) * invD[k][r];
+                t0 = std::max(t0, std::min(tA, tB));
+                t1 = std::min(t1, std::max(tA, tB));
+            }
+            anyHit |= (t0 <= t1);
+        }
+        if(!anyHit)
+            continue;
+
+        if(node.count > 0)
+        {
+            for(int i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                const Triangle& tri = _triangles[i];
+                for(int r = 0; r < packetSize; ++r)
+                {
+                    const float px = d[1][r] * tri.e2[2] - d[2][r] * tri.e2[1];
+                    const float py = d[2][r] * tri.e2[0] - d[0][r] * tri.e2[2];
+                    const float pz = d[0][r] * tri.e2[1] - d[1][r] * tri.e2[0];
+                    const float det = tri.e1[0] * px + tri.e1[1] * py + tri.e1[2] * pz;
+                    const float invDet = 1.0f / det;
+                    const float sx = o[0][r] - tri.v0[0];
+                    const float sy = o[1][r] - tri.v0[1];
+                    const float sz = o[2][r] - tri.v0[2];
+                    const float u = (sx * px + sy * py + sz * pz) * invDet;
+                    const float qx = sy * tri.e1[2] - sz * tri.e1[1];
+                    const float qy = sz * tri.e1[0] - sx * tri.e1[2];
+                    const float qz = sx * tri.e1[1] - sy * tri.e1[0];
+                    const float v = (d[0][r] * qx + d[1][r] * qy + d[2][r] * qz) * invDet;
+                    const float t = (tri.e2[0] * qx + tri.e2[1] * qy + tri.e2[2] * qz) * invDet;
+                    const bool hit = (det != 0.0f) && (u >= 0.0f) && (u <= 1.0f) && (v >= 0.0f) && (u + v <= 1.0f) && (t > 0.0f) && (t < tBest[r]);
+                    tBest[r] = hit ? t : tBest[r];
+                    bestIndex[r] = hit ? i : bestIndex[r];
+                }
+            }
+            continue;
+        }
+
+        // visit the near child first, according to the first active ray
+        const int axis = -node.count;
+        const bool leftFirst = d[axis][firstActive] >= 0.0f;
+        stack[stackSize++] = leftFirst ? node.leftOrFirst + 1 : node.leftOrFirst;
+        stack[stackSize++] = leftFirst ? node.leftOrFirst : node.leftOrFirst + 1;
+    }
+
+    for(int r = 0; r < packetSize; ++r)
+    {
+        if(bestIndex[r] < 0)
+            continue;
+        out_hits[r].distance = tBest[r];
+        out_hits[r].triId = _trisIds[bestIndex[r]];
+    }
+}
+
+} // namespace mesh
+} // namespace aliceVision
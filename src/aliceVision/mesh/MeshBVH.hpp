@@ -0,0 +1,104 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <array>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+/**
+ * @class MeshBVH
+ * @brief Bounding volume hierarchy over the mesh triangles for CPU ray casting.
+ *
+ * The hierarchy is built with a binned surface area heuristic, large subtrees are built in parallel.
+ * Coordinates are stored in single precision relative to the center of the mesh bounding box.
+ * The BVH is not updated with the mesh: it should be built again if the mesh changes.
+ */
+class MeshBVH
+{
+public:
+    /// Number of rays traversing the hierarchy together in a packet
+    static constexpr int packetSize = 4;
+
+    struct Hit
+    {
+        double distance = -1.0; //< distance from the ray origin, -1 if no hit
+        int triId = -1;         //< mesh triangle index, -1 if no hit
+    };
+
+    /**
+     * @brief Coherent rays traversing the hierarchy together (e.g. neighbor pixels of a camera).
+     * @note Directions should be normalized, rays with a negative tMax are inactive.
+     */
+    struct RayPacket
+    {
+        std::array<Point3d, packetSize> origins;
+        std::array<Point3d, packetSize> directions;
+        std::array<double, packetSize> tMax;
+    };
+
+    /**
+     * @param[in] mesh the mesh
+     * @param[in] maxLeafSize the maximum number of triangles in a leaf
+     */
+    explicit MeshBVH(const Mesh& mesh, int maxLeafSize = 4);
+
+    std::size_t getNbNodes() const { return _nodes.size(); }
+
+    /**
+     * @brief Get the closest intersection of the ray with the mesh.
+     * @param[in] origin the ray origin
+     * @param[in] direction the normalized ray direction
+     * @param[in] tMax the maximum distance from the origin
+     * @param[out] out_hit the closest hit
+     * @return true if the ray intersects the mesh
+     */
+    bool intersect(const Point3d& origin, const Point3d& direction, double tMax, Hit& out_hit) const;
+
+    /**
+     * @brief Whether the ray intersects any triangle before tMax.
+     * @note Stops at the first intersection found, faster than intersect for visibility tests.
+     */
+    bool isOccluded(const Point3d& origin, const Point3d& direction, double tMax) const;
+
+    /**
+     * @brief Get the closest intersection of each ray of the packet with the mesh.
+     */
+    void intersect(const RayPacket& packet, std::array<Hit, packetSize>& out_hits) const;
+
+private:
+    friend class MeshBVHBuilder;
+
+    struct Node
+    {
+        float bmin[3];
+        float bmax[3];
+        int leftOrFirst; //< first child index (second child follows) or first triangle index for leaves
+        int count;       //< number of triangles for leaves, minus the split axis for inner nodes
+    };
+
+    struct Triangle
+    {
+        float v0[3];
+        float e1[3];
+        float e2[3];
+    };
+
+    std::vector<Node> _nodes;
+    std::vector<Triangle> _triangles; //< triangles in leaves order
+    std::vector<int> _trisIds;        //< mesh triangle index of each triangle in leaves order
+    Point3d _center;
+};
+
+} // namespace mesh
+} // namespace aliceVision
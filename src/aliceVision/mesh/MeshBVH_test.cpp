@@ -0,0 +1,207 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshBVH.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/meshVisibility.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/camera.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshBVH
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+namespace fs = boost::filesystem;
+
+namespace {
+
+/**
+ * @brief Add a grid of n x n vertices on the plane z, facing -z (towards the cameras).
+ */
+void addGridPlane(Mesh& mesh, double x0, double x1, double y0, double y1, double z, int n)
+{
+    const int first = mesh.pts.size();
+    for(int j = 0; j < n; ++j)
+    {
+        for(int i = 0; i < n; ++i)
+            mesh.pts.push_back(Point3d(x0 + (x1 - x0) * i / (n - 1), y0 + (y1 - y0) * j / (n - 1), z));
+    }
+    for(int j = 0; j < n - 1; ++j)
+    {
+        for(int i = 0; i < n - 1; ++i)
+        {
+            const int v = first + j * n + i;
+            mesh.tris.push_back(Mesh::triangle(v, v + n + 1, v + 1));
+            mesh.tris.push_back(Mesh::triangle(v, v + n, v + n + 1));
+        }
+    }
+}
+
+/**
+ * @brief Background plane partially hidden by a smaller plane, not aligned on the background grid.
+ */
+Mesh createScene()
+{
+    Mesh mesh;
+    addGridPlane(mesh, -3.0, 5.0, -4.0, 4.0, 10.0, 17);
+    addGridPlane(mesh, 0.13, 2.37, -1.21, 1.43, 5.0, 6);
+    return mesh;
+}
+
+/**
+ * @brief Closest intersection of the ray with all the triangles (Moller-Trumbore).
+ */
+MeshBVH::Hit intersectBruteForce(const Mesh& mesh, const Point3d& origin, const Point3d& direction, double tMax)
+{
+    MeshBVH::Hit hit;
+    for(int triId = 0; triId < mesh.tris.size(); ++triId)
+    {
+        const Mesh::triangle& t = mesh.tris[triId];
+        const Point3d e1 = mesh.pts[t.v[1]] - mesh.pts[t.v[0]];
+        const Point3d e2 = mesh.pts[t.v[2]] - mesh.pts[t.v[0]];
+        const Point3d p = cross(direction, e2);
+        const double det = dot(e1, p);
+        if(std::abs(det) < 1e-12)
+            continue;
+        const Point3d s = origin - mesh.pts[t.v[0]];
+        const double u = dot(s, p) / det;
+        if(u < 0.0 || u > 1.0)
+            continue;
+        const Point3d q = cross(s, e1);
+        const double v = dot(direction, q) / det;
+        if(v < 0.0 || u + v > 1.0)
+            continue;
+        const double distance = dot(e2, q) / det;
+        if(distance > 0.0 && distance < tMax && (hit.triId < 0 || distance < hit.distance))
+        {
+            hit.distance = distance;
+            hit.triId = triId;
+        }
+    }
+    return hit;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshBVH_intersect)
+{
+    const Mesh mesh = createScene();
+    const MeshBVH bvh(mesh);
+    BOOST_CHECK_GT(bvh.getNbNodes(), 1);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> originDistribution(-1.0, 1.0);
+    std::uniform_real_distribution<double> targetDistribution(-4.0, 6.0);
+    std::uniform_real_distribution<double> tMaxDistribution(3.0, 15.0);
+
+    const int nbRays = 2000;
+    std::vector<Point3d> origins(nbRays);
+    std::vector<Point3d> directions(nbRays);
+    std::vector<double> tMax(nbRays);
+    std::vector<MeshBVH::Hit> hits(nbRays);
+    int nbHits = 0;
+
+    for(int i = 0; i < nbRays; ++i)
+    {
+        origins[i] = Point3d(originDistribution(generator), originDistribution(generator), originDistribution(generator));
+        const Point3d target(targetDistribution(generator), targetDistribution(generator), 10.0 * (i % 3));
+        directions[i] = (target - origins[i]).normalize();
+        tMax[i] = tMaxDistribution(generator);
+
+        const MeshBVH::Hit expected = intersectBruteForce(mesh, origins[i], directions[i], tMax[i]);
+        BOOST_CHECK_EQUAL(bvh.intersect(origins[i], directions[i], tMax[i], hits[i]), expected.triId >= 0);
+        BOOST_CHECK_EQUAL(hits[i].triId, expected.triId);
+        if(expected.triId >= 0)
+        {
+            BOOST_CHECK_CLOSE(hits[i].distance, expected.distance, 1e-3);
+            ++nbHits;
+        }
+        BOOST_CHECK_EQUAL(bvh.isOccluded(origins[i], directions[i], tMax[i]), expected.triId >= 0);
+    }
+    // both hits and misses are tested
+    BOOST_CHECK_GT(nbHits, nbRays / 10);
+    BOOST_CHECK_LT(nbHits, nbRays - nbRays / 10);
+
+    // packets give the same hits as single rays, with inactive rays
+    for(int i = 0; i + MeshBVH::packetSize <= nbRays; i += MeshBVH::packetSize)
+    {
+        MeshBVH::RayPacket packet;
+        for(int r = 0; r < MeshBVH::packetSize; ++r)
+        {
+            packet.origins[r] = origins[i + r];
+            packet.directions[r] = directions[i + r];
+            packet.tMax[r] = ((i / MeshBVH::packetSize) % 5 == r) ? -1.0 : tMax[i + r];
+        }
+
+        std::array<MeshBVH::Hit, MeshBVH::packetSize> packetHits;
+        bvh.intersect(packet, packetHits);
+
+        for(int r = 0; r < MeshBVH::packetSize; ++r)
+        {
+            if(packet.tMax[r] < 0.0)
+            {
+                BOOST_CHECK_EQUAL(packetHits[r].triId, -1);
+                continue;
+            }
+            BOOST_CHECK_EQUAL(packetHits[r].triId, hits[i + r].triId);
+            BOOST_CHECK_CLOSE(packetHits[r].distance, hits[i + r].distance, 1e-4);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshBVH_visibilitiesMeshItself)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("meshBVH_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    // cameras along the X axis looking towards +Z
+    const int imageWidth = 64;
+    const int imageHeight = 48;
+    sfmData::SfMData sfmData;
+    sfmData.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(imageWidth, imageHeight, 30.0, 30.0, 0.0, 0.0));
+    for(IndexT viewId = 0; viewId < 4; ++viewId)
+    {
+        sfmData.getViews().emplace(viewId, std::make_shared<sfmData::View>("", viewId, 0, viewId, imageWidth, imageHeight));
+        sfmData.setPose(sfmData.getView(viewId), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(viewId, 0.0, 0.0))));
+    }
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+
+    Mesh meshBVH = createScene();
+    Mesh meshGeogram = createScene();
+    remapMeshVisibilities_meshItself(mp, meshBVH, true);
+    remapMeshVisibilities_meshItself(mp, meshGeogram, false);
+
+    BOOST_REQUIRE_EQUAL(meshBVH.pointsVisibilities.size(), meshBVH.pts.size());
+    BOOST_REQUIRE_EQUAL(meshGeogram.pointsVisibilities.size(), meshGeogram.pts.size());
+
+    int nbVisibilities = 0;
+    int nbOccluded = 0;
+    for(int i = 0; i < meshBVH.pts.size(); ++i)
+    {
+        const PointVisibility& visBVH = meshBVH.pointsVisibilities[i];
+        const PointVisibility& visGeogram = meshGeogram.pointsVisibilities[i];
+        BOOST_CHECK(visBVH.getData() == visGeogram.getData());
+        nbVisibilities += visBVH.size();
+        nbOccluded += 4 - visBVH.size();
+    }
+    // the background is partially hidden from each camera
+    BOOST_CHECK_GT(nbVisibilities, 0);
+    BOOST_CHECK_GT(nbOccluded, 0);
+
+    fs::remove_all(folder);
+}
@@ -562,11 +562,23 @@ MeshClean::MeshClean(mvsUtils::MultiViewParams* _mp)
     mp = _mp;
 }
 
+MeshClean::MeshClean(mvsUtils::MultiViewParams* _mp, Mesh&& mesh)
+    : Mesh(std::move(mesh))
+{
+    mp = _mp;
+}
+
 MeshClean::~MeshClean()
 {
     deallocateCleaningAttributes();
 }
 
+Mesh MeshClean::releaseMesh()
+{
+    deallocateCleaningAttributes();
+    return std::move(static_cast<Mesh&>(*this));
+}
+
 void MeshClean::deallocateCleaningAttributes()
 {
     if(!edgesNeigTris.empty())
@@ -635,15 +647,8 @@ void MeshClean::init()
 {
     deallocateCleaningAttributes();
 
+    // triangles are sorted by ascending index in the mesh adjacency
     getPtsNeighborTriangles(ptsNeighTrisSortedAsc);
-    for(int i = 0; i < pts.size(); i++)
-    {
-        StaticVector<int>& ptNeigTris = ptsNeighTrisSortedAsc[i];
-        if(sizeOfStaticVector<int>(ptNeigTris) > 1)
-        {
-            qsort(&ptNeigTris[0], ptNeigTris.size(), sizeof(int), qSortCompareIntAsc);
-        }
-    }
 
     ptsNeighPtsOrdered.reserve(pts.size());
     ptsNeighPtsOrdered.resize(pts.size());
@@ -654,38 +659,18 @@ void MeshClean::init()
     newPtsOldPtId.reserve(pts.size());
     nPtsInit = pts.size();
 
-    edgesNeigTrisAlive.reserve(tris.size() * 3);
-    edgesNeigTris.reserve(tris.size() * 3);
     edgesXStat.reserve(pts.size());
     edgesXYStat.reserve(tris.size() * 3);
 
-    for(int i = 0; i < tris.size(); i++)
-    {
-        int a = tris[i].v[0];
-        int b = tris[i].v[1];
-        int c = tris[i].v[2];
-        edgesNeigTris.push_back(Voxel(std::max(a, b), std::min(a, b), i));
-        edgesNeigTris.push_back(Voxel(std::max(b, c), std::min(b, c), i));
-        edgesNeigTris.push_back(Voxel(std::max(c, a), std::min(c, a), i));
-
-        edgesNeigTrisAlive.push_back(true);
-        edgesNeigTrisAlive.push_back(true);
-        edgesNeigTrisAlive.push_back(true);
-    }
+    // edges sorted by max point id, min point id and triangle id
+    getSortedTrianglesEdges(true, edgesNeigTris);
+    edgesNeigTrisAlive.resize_with(edgesNeigTris.size(), true);
 
-    qsort(&edgesNeigTris[0], edgesNeigTris.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
-
-    // sort
     int i0 = 0;
-    long t1 = mvsUtils::initEstimate();
     for(int i = 0; i < edgesNeigTris.size(); i++)
     {
-
         if((i == edgesNeigTris.size() - 1) || (edgesNeigTris[i].x != edgesNeigTris[i + 1].x))
         {
-            if(i - i0 + 1 > 1)
-                qsort(&edgesNeigTris[i0], i - i0 + 1, sizeof(Voxel), qSortCompareVoxelByYAsc);
-
             int xyI0 = edgesXYStat.size();
 
             int j0 = i0;
@@ -693,9 +678,6 @@ void MeshClean::init()
             {
                 if((j == i) || (edgesNeigTris[j].y != edgesNeigTris[j + 1].y))
                 {
-                    if(j - j0 + 1 > 1)
-                        qsort(&edgesNeigTris[j0], j - j0 + 1, sizeof(Voxel), qSortCompareVoxelByZAsc);
-
                     edgesXYStat.push_back(Voxel(edgesNeigTris[j].y, j0, j));
                     j0 = j + 1;
                 }
@@ -703,15 +685,11 @@ void MeshClean::init()
 
             int xyI = edgesXYStat.size() - 1;
 
-            // printf("%i of %i\n",edgesXStat->size(),edgesXStat->reserved());
             edgesXStat.push_back(Voxel(edgesNeigTris[i].x, xyI0, xyI));
 
             i0 = i + 1;
         }
-
-        mvsUtils::printfEstimate(i, edgesNeigTris.size(), t1);
     }
-    mvsUtils::finishEstimate();
 }
 
 void MeshClean::testPtsNeighTrisSortedAsc()
@@ -865,6 +843,7 @@ int MeshClean::cleanMesh()
         }
         std::swap(_colors, newColors);
     }
+    invalidateTopology();
 
     ALICEVISION_LOG_INFO("cleanMesh:" << std::endl
                       << "\t- # wrong points: " << nWrongPts << std::endl
@@ -85,8 +85,18 @@ public:
     int nPtsInit;
 
     explicit MeshClean(mvsUtils::MultiViewParams* _mp);
+    /**
+     * @brief Take over the geometry of the mesh, without copy.
+     */
+    MeshClean(mvsUtils::MultiViewParams* _mp, Mesh&& mesh);
     ~MeshClean();
 
+    /**
+     * @brief Give back the cleaned mesh, without copy, and release the cleaning attributes.
+     * @note This object is left empty.
+     */
+    Mesh releaseMesh();
+
     bool getEdgeNeighTrisInterval(Pixel& itr, int ptId1, int ptId2);
     bool isIsBoundaryPt(int ptId);
 
@@ -0,0 +1,650 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshDecimation.hpp"
+#include "Mesh.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+using Triangle = std::array<int, 3>;
+
+/**
+ * @brief Quadric error, symmetric 4x4 matrix of the sum of squared distances to planes.
+ */
+struct Quadric
+{
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+
+    Quadric() = default;
+
+    /// Weighted squared distance to the plane dot(n, x) + d = 0, n being normalized
+    Quadric(const Point3d& n, double d, double weight)
+        : a2(weight * n.x * n.x), ab(weight * n.x * n.y), ac(weight * n.x * n.z), ad(weight * n.x * d)
+        , b2(weight * n.y * n.y), bc(weight * n.y * n.z), bd(weight * n.y * d)
+        , c2(weight * n.z * n.z), cd(weight * n.z * d)
+        , d2(weight * d * d)
+    {}
+
+    Quadric& operator+=(const Quadric& q)
+    {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        return *this;
+    }
+
+    Quadric operator+(const Quadric& q) const
+    {
+        Quadric sum = *this;
+        sum += q;
+        return sum;
+    }
+
+    double evaluate(const Point3d& p) const
+    {
+        return a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+               b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+               c2 * p.z * p.z + 2.0 * cd * p.z + d2;
+    }
+
+    /// Get the position of minimal error, false if it is not well defined
+    bool getMinimum(Point3d& out) const
+    {
+        Eigen::Matrix3d A;
+        A << a2, ab, ac,
+             ab, b2, bc,
+             ac, bc, c2;
+        const double scale = A.cwiseAbs().maxCoeff();
+        if(scale <= 0.0 || std::abs(A.determinant()) <= 1e-9 * scale * scale * scale)
+            return false;
+        const Eigen::Vector3d x = A.inverse() * Eigen::Vector3d(-ad, -bd, -cd);
+        out = Point3d(x(0), x(1), x(2));
+        return true;
+    }
+};
+
+struct EdgeCollapse
+{
+    double cost;
+    int u;
+    int v;
+    unsigned int stampU;
+    unsigned int stampV;
+    Point3d position;
+
+    bool operator>(const EdgeCollapse& other) const { return cost > other.cost; }
+};
+
+/**
+ * @brief Greedy decimation of an indexed triangle mesh by the edge collapses of lowest quadric error.
+ *
+ * Vertices are removed by collapsing them into one of their neighbors, triangles are removed by
+ * marking their first vertex with -1. The locked vertices are never removed nor moved.
+ * The boundary vertices only collapse along the boundary into one another, at their original position,
+ * so that the open boundaries are kept in place.
+ */
+class QuadricDecimator
+{
+public:
+    QuadricDecimator(std::vector<Point3d>& pts, std::vector<Quadric>& quadrics, std::vector<Triangle>& tris,
+                     const std::vector<char>& locked)
+        : _pts(pts)
+        , _quadrics(quadrics)
+        , _tris(tris)
+        , _locked(locked)
+        , _ptsTris(pts.size())
+        , _isBoundary(pts.size(), 0)
+        , _stamps(pts.size(), 0)
+    {
+        for(int t = 0; t < _tris.size(); ++t)
+        {
+            for(int k = 0; k < 3; ++k)
+                _ptsTris[_tris[t][k]].push_back(t);
+        }
+        // the valid collapses keep the boundary vertices on the boundary
+        for(int v = 0; v < _pts.size(); ++v)
+        {
+            if(_ptsTris[v].empty())
+                continue;
+            ++_nbVertices;
+            getRing(v, _ringU);
+            _isBoundary[v] = isBoundaryRing(_ringU);
+        }
+    }
+
+    /**
+     * @brief Collapse the edges by increasing error until the target number of vertices is reached
+     *        or no valid collapse remains.
+     */
+    void decimate(int targetNbVertices)
+    {
+        for(int v = 0; v < _pts.size(); ++v)
+        {
+            if(!_locked[v])
+                pushEdges(v, true);
+        }
+
+        while(_nbVertices > targetNbVertices && !_queue.empty())
+        {
+            const EdgeCollapse c = _queue.top();
+            _queue.pop();
+
+            // outdated by a previous collapse
+            if(c.stampU != _stamps[c.u] || c.stampV != _stamps[c.v])
+                continue;
+
+            // keep the boundary vertex, otherwise remove the vertex with fewer triangles, both end at the same position
+            const bool removeU = (_isBoundary[c.u] != _isBoundary[c.v]) ? !_isBoundary[c.u]
+                                                                          : _ptsTris[c.u].size() <= _ptsTris[c.v].size();
+            const int removed = removeU ? c.u : c.v;
+            const int kept = removeU ? c.v : c.u;
+
+            if(!isCollapseValid(removed, kept, c.position))
+                continue;
+
+            collapse(removed, kept, c.position);
+            pushEdges(kept, false);
+        }
+    }
+
+private:
+    bool isAlive(int t) const { return _tris[t][0] >= 0; }
+
+    static bool contains(const Triangle& tri, int v) { return tri[0] == v || tri[1] == v || tri[2] == v; }
+
+    /// Get the vertices of the triangles around v (excluding v), each edge of v appears twice unless on a boundary
+    void getRing(int v, std::vector<int>& out_ring) const
+    {
+        out_ring.clear();
+        for(const int t : _ptsTris[v])
+        {
+            if(!isAlive(t))
+                continue;
+            for(const int w : _tris[t])
+            {
+                if(w != v)
+                    out_ring.push_back(w);
+            }
+        }
+        std::sort(out_ring.begin(), out_ring.end());
+    }
+
+    /// Whether a sorted ring has a vertex appearing once, i.e. a boundary edge
+    static bool isBoundaryRing(const std::vector<int>& ring)
+    {
+        for(std::size_t i = 0; i < ring.size();)
+        {
+            std::size_t j = i + 1;
+            while(j < ring.size() && ring[j] == ring[i])
+                ++j;
+            if(j - i == 1)
+                return true;
+            i = j;
+        }
+        return false;
+    }
+
+    EdgeCollapse computeCollapse(int u, int v) const
+    {
+        const Quadric q = _quadrics[u] + _quadrics[v];
+        const Point3d& pu = _pts[u];
+        const Point3d& pv = _pts[v];
+        const Point3d middle = (pu + pv) * 0.5;
+
+        Point3d position;
+        double cost = std::numeric_limits<double>::max();
+        if(_isBoundary[u] != _isBoundary[v])
+        {
+            // the boundary vertex does not move
+            position = _isBoundary[u] ? pu : pv;
+            cost = q.evaluate(position);
+        }
+        else if(_isBoundary[u])
+        {
+            // collapse along the boundary into one of the vertices
+            for(const Point3d& candidate : {pu, pv})
+            {
+                const double candidateCost = q.evaluate(candidate);
+                if(candidateCost < cost)
+                {
+                    cost = candidateCost;
+                    position = candidate;
+                }
+            }
+        }
+        // the optimal position, unless it is far from the edge (nearly singular quadric)
+        else if(q.getMinimum(position) && (position - middle).size2() <= (pu - pv).size2())
+        {
+            cost = q.evaluate(position);
+        }
+        else
+        {
+            for(const Point3d& candidate : {pu, pv, middle})
+            {
+                const double candidateCost = q.evaluate(candidate);
+                if(candidateCost < cost)
+                {
+                    cost = candidateCost;
+                    position = candidate;
+                }
+            }
+        }
+
+        return {std::max(cost, 0.0), u, v, _stamps[u], _stamps[v], position};
+    }
+
+    /// Push the collapses of the edges of v (only to the neighbors of higher index if onlyHigher)
+    void pushEdges(int v, bool onlyHigher)
+    {
+        getRing(v, _ringU);
+        _ringU.erase(std::unique(_ringU.begin(), _ringU.end()), _ringU.end());
+        for(const int w : _ringU)
+        {
+            if(_locked[w] || (onlyHigher && w < v))
+                continue;
+            _queue.push(computeCollapse(v, w));
+        }
+    }
+
+    bool isCollapseValid(int removed, int kept, const Point3d& position)
+    {
+        // link condition: the common neighbors are the opposite vertices of the edge triangles
+        getRing(removed, _ringU);
+        getRing(kept, _ringV);
+
+        int nbEdgeTriangles = 0;
+        for(const int t : _ptsTris[removed])
+        {
+            if(isAlive(t) && contains(_tris[t], kept))
+                ++nbEdgeTriangles;
+        }
+        if(nbEdgeTriangles == 0)
+            return false;
+
+        // an inner edge between two boundary vertices would pinch the mesh
+        if(nbEdgeTriangles == 2 && isBoundaryRing(_ringU) && isBoundaryRing(_ringV))
+            return false;
+
+        _ringU.erase(std::unique(_ringU.begin(), _ringU.end()), _ringU.end());
+        _ringV.erase(std::unique(_ringV.begin(), _ringV.end()), _ringV.end());
+        _common.clear();
+        std::set_intersection(_ringU.begin(), _ringU.end(), _ringV.begin(), _ringV.end(), std::back_inserter(_common));
+        if(_common.size() != nbEdgeTriangles)
+            return false;
+
+        // no flipped or degenerate triangle
+        for(const int v : {removed, kept})
+        {
+            for(const int t : _ptsTris[v])
+            {
+                const Triangle& tri = _tris[t];
+                if(!isAlive(t) || (contains(tri, removed) && contains(tri, kept)))
+                    continue;
+
+                const Point3d& p0 = _pts[tri[0]];
+                const Point3d& p1 = _pts[tri[1]];
+                const Point3d& p2 = _pts[tri[2]];
+                const Point3d before = cross(p1 - p0, p2 - p0);
+
+                const Point3d& q0 = (tri[0] == v) ? position : p0;
+                const Point3d& q1 = (tri[1] == v) ? position : p1;
+                const Point3d& q2 = (tri[2] == v) ? position : p2;
+                const Point3d after = cross(q1 - q0, q2 - q0);
+
+                if(dot(before, after) <= 0.0)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void collapse(int removed, int kept, const Point3d& position)
+    {
+        for(const int t : _ptsTris[removed])
+        {
+            if(!isAlive(t))
+                continue;
+            Triangle& tri = _tris[t];
+            if(contains(tri, kept))
+            {
+                tri[0] = -1;
+                continue;
+            }
+            for(int& w : tri)
+            {
+                if(w == removed)
+                    w = kept;
+            }
+            _ptsTris[kept].push_back(t);
+        }
+
+        std::vector<int>& keptTris = _ptsTris[kept];
+        keptTris.erase(std::remove_if(keptTris.begin(), keptTris.end(), [this](int t) { return !isAlive(t); }), keptTris.end());
+        std::vector<int>().swap(_ptsTris[removed]);
+
+        _pts[kept] = position;
+        _quadrics[kept] += _quadrics[removed];
+        ++_stamps[removed];
+        ++_stamps[kept];
+        --_nbVertices;
+    }
+
+    std::vector<Point3d>& _pts;
+    std::vector<Quadric>& _quadrics;
+    std::vector<Triangle>& _tris;
+    const std::vector<char>& _locked;
+    std::vector<std::vector<int>> _ptsTris;
+    std::vector<char> _isBoundary;
+    std::vector<unsigned int> _stamps;
+    int _nbVertices = 0;
+    std::priority_queue<EdgeCollapse, std::vector<EdgeCollapse>, std::greater<EdgeCollapse>> _queue;
+    std::vector<int> _ringU;
+    std::vector<int> _ringV;
+    std::vector<int> _common;
+};
+
+/**
+ * @brief Remove the deleted triangles and the vertices they do not reference anymore.
+ */
+void removeUnreferencedVertices(std::vector<Point3d>& pts, std::vector<Quadric>& quadrics, std::vector<Triangle>& tris)
+{
+    tris.erase(std::remove_if(tris.begin(), tris.end(), [](const Triangle& tri) { return tri[0] < 0; }), tris.end());
+
+    std::vector<int> newIndexes(pts.size(), -1);
+    std::vector<Point3d> newPts;
+    std::vector<Quadric> newQuadrics;
+    for(Triangle& tri : tris)
+    {
+        for(int& v : tri)
+        {
+            if(newIndexes[v] < 0)
+            {
+                newIndexes[v] = static_cast<int>(newPts.size());
+                newPts.push_back(pts[v]);
+                if(!quadrics.empty())
+                    newQuadrics.push_back(quadrics[v]);
+            }
+            v = newIndexes[v];
+        }
+    }
+    pts.swap(newPts);
+    quadrics.swap(newQuadrics);
+}
+
+/**
+ * @brief Compute the quadric of each vertex from the planes of its triangles, weighted by their area,
+ *        and the planes orthogonal to its boundary edges.
+ */
+void computeQuadrics(const Mesh& mesh, const Mesh::Adjacency& ptsNeighTris, double boundaryWeight, std::vector<Quadric>& out_quadrics)
+{
+    out_quadrics.assign(mesh.pts.size(), Quadric());
+
+    #pragma omp parallel for
+    for(int v = 0; v < mesh.pts.size(); ++v)
+    {
+        Quadric& q = out_quadrics[v];
+        for(const int* it = ptsNeighTris.begin(v); it != ptsNeighTris.end(v); ++it)
+        {
+            const Mesh::triangle& tri = mesh.tris[*it];
+            const Point3d& p0 = mesh.pts[tri.v[0]];
+            const Point3d n = cross(mesh.pts[tri.v[1]] - p0, mesh.pts[tri.v[2]] - p0);
+            const double doubleArea = n.size();
+            if(doubleArea <= 0.0)
+                continue;
+            const Point3d normal = n / doubleArea;
+            q += Quadric(normal, -dot(normal, p0), 0.5 * doubleArea);
+
+            // boundary edges from v: no other triangle of v contains the edge
+            for(int k = 0; k < 3; ++k)
+            {
+                const int a = tri.v[k];
+                const int b = tri.v[(k + 1) % 3];
+                if(a != v && b != v)
+                    continue;
+                const int other = (a == v) ? b : a;
+                const bool isBoundary = std::none_of(ptsNeighTris.begin(v), ptsNeighTris.end(v), [&](int t) {
+                    const Mesh::triangle& neighTri = mesh.tris[t];
+                    return t != *it && (neighTri.v[0] == other || neighTri.v[1] == other || neighTri.v[2] == other);
+                });
+                if(!isBoundary)
+                    continue;
+                const Point3d edge = mesh.pts[b] - mesh.pts[a];
+                const Point3d edgeNormal = cross(edge, normal).normalize();
+                q += Quadric(edgeNormal, -dot(edgeNormal, mesh.pts[a]), boundaryWeight * edge.size2());
+            }
+        }
+    }
+}
+
+/**
+ * @brief Decimate the regular grid partitions of the triangles concurrently, the vertices shared by
+ *        several partitions being locked.
+ * @param[in,out] pts the vertices positions
+ * @param[in,out] quadrics the vertices quadrics
+ * @param[in,out] tris the triangles, replaced by the decimated triangles
+ * @param[in] ptsNeighTris the triangles around each vertex
+ * @param[in] nbPartitions the expected number of non-empty partitions
+ * @param[in] ratio the ratio of unlocked vertices to keep in each partition
+ */
+void decimatePartitions(std::vector<Point3d>& pts, std::vector<Quadric>& quadrics, std::vector<Triangle>& tris,
+                        const Mesh::Adjacency& ptsNeighTris, int nbPartitions, double ratio)
+{
+    // a surface mostly crosses n^2 cells out of n^3
+    const int nbCellsPerAxis = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nbPartitions)))));
+
+    Point3d bmin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bmax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    for(int v = 0; v < pts.size(); ++v)
+    {
+        if(ptsNeighTris.size(v) == 0)
+            continue;
+        bmin = Point3d(std::min(bmin.x, pts[v].x), std::min(bmin.y, pts[v].y), std::min(bmin.z, pts[v].z));
+        bmax = Point3d(std::max(bmax.x, pts[v].x), std::max(bmax.y, pts[v].y), std::max(bmax.z, pts[v].z));
+    }
+    const double extent = std::max({bmax.x - bmin.x, bmax.y - bmin.y, bmax.z - bmin.z});
+    const double cellSize = std::max(extent / nbCellsPerAxis, std::numeric_limits<double>::min());
+
+    // partition of each triangle from its centroid
+    std::vector<int> triCells(tris.size());
+    #pragma omp parallel for
+    for(int t = 0; t < tris.size(); ++t)
+    {
+        const Point3d centroid = (pts[tris[t][0]] + pts[tris[t][1]] + pts[tris[t][2]]) / 3.0;
+        const auto cellCoord = [&](double value, double minValue) {
+            return std::min(nbCellsPerAxis - 1, std::max(0, static_cast<int>((value - minValue) / cellSize)));
+        };
+        triCells[t] = (cellCoord(centroid.x, bmin.x) * nbCellsPerAxis + cellCoord(centroid.y, bmin.y)) * nbCellsPerAxis +
+                      cellCoord(centroid.z, bmin.z);
+    }
+
+    // triangles of each partition
+    const int nbCells = nbCellsPerAxis * nbCellsPerAxis * nbCellsPerAxis;
+    std::vector<int> cellOffsets(nbCells + 1, 0);
+    for(const int cell : triCells)
+        ++cellOffsets[cell + 1];
+    for(int c = 0; c < nbCells; ++c)
+        cellOffsets[c + 1] += cellOffsets[c];
+    std::vector<int> cellTris(tris.size());
+    {
+        std::vector<int> cellFill(cellOffsets.begin(), cellOffsets.end() - 1);
+        for(int t = 0; t < tris.size(); ++t)
+            cellTris[cellFill[triCells[t]]++] = t;
+    }
+
+    // vertices on the partitions borders
+    std::vector<char> locked(pts.size(), 0);
+    #pragma omp parallel for
+    for(int v = 0; v < pts.size(); ++v)
+    {
+        const int* begin = ptsNeighTris.begin(v);
+        const int* end = ptsNeighTris.end(v);
+        locked[v] = std::any_of(begin, end, [&](int t) { return triCells[t] != triCells[*begin]; });
+    }
+
+    // largest partitions first for the load balancing
+    std::vector<int> cells;
+    for(int c = 0; c < nbCells; ++c)
+    {
+        if(cellOffsets[c + 1] > cellOffsets[c])
+            cells.push_back(c);
+    }
+    std::sort(cells.begin(), cells.end(), [&](int a, int b) {
+        return cellOffsets[a + 1] - cellOffsets[a] > cellOffsets[b + 1] - cellOffsets[b];
+    });
+
+    ALICEVISION_LOG_INFO("Decimate " << cells.size() << " partitions.");
+
+    std::vector<std::vector<Triangle>> decimatedCellTris(nbCells);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < cells.size(); ++i)
+    {
+        const int cell = cells[i];
+
+        // local copy of the partition
+        std::vector<int> localToGlobal;
+        for(int j = cellOffsets[cell]; j < cellOffsets[cell + 1]; ++j)
+            localToGlobal.insert(localToGlobal.end(), tris[cellTris[j]].begin(), tris[cellTris[j]].end());
+        std::sort(localToGlobal.begin(), localToGlobal.end());
+        localToGlobal.erase(std::unique(localToGlobal.begin(), localToGlobal.end()), localToGlobal.end());
+
+        const auto toLocal = [&](int v) {
+            return static_cast<int>(std::lower_bound(localToGlobal.begin(), localToGlobal.end(), v) - localToGlobal.begin());
+        };
+
+        std::vector<Point3d> localPts(localToGlobal.size());
+        std::vector<Quadric> localQuadrics(localToGlobal.size());
+        std::vector<char> localLocked(localToGlobal.size());
+        int nbLocked = 0;
+        for(int l = 0; l < localToGlobal.size(); ++l)
+        {
+            localPts[l] = pts[localToGlobal[l]];
+            localQuadrics[l] = quadrics[localToGlobal[l]];
+            localLocked[l] = locked[localToGlobal[l]];
+            nbLocked += localLocked[l];
+        }
+        std::vector<Triangle> localTris;
+        localTris.reserve(cellOffsets[cell + 1] - cellOffsets[cell]);
+        for(int j = cellOffsets[cell]; j < cellOffsets[cell + 1]; ++j)
+        {
+            const Triangle& tri = tris[cellTris[j]];
+            localTris.push_back({toLocal(tri[0]), toLocal(tri[1]), toLocal(tri[2])});
+        }
+
+        QuadricDecimator decimator(localPts, localQuadrics, localTris, localLocked);
+        // the locked vertices are decimated by the final pass
+        const int nbUnlocked = static_cast<int>(localToGlobal.size()) - nbLocked;
+        const int localTarget = nbLocked + static_cast<int>(std::lround(ratio * nbUnlocked));
+        decimator.decimate(localTarget);
+
+        // each unlocked vertex belongs to a single partition
+        for(int l = 0; l < localToGlobal.size(); ++l)
+        {
+            if(localLocked[l])
+                continue;
+            pts[localToGlobal[l]] = localPts[l];
+            quadrics[localToGlobal[l]] = localQuadrics[l];
+        }
+        std::vector<Triangle>& decimatedTris = decimatedCellTris[cell];
+        for(const Triangle& tri : localTris)
+        {
+            if(tri[0] >= 0)
+                decimatedTris.push_back({localToGlobal[tri[0]], localToGlobal[tri[1]], localToGlobal[tri[2]]});
+        }
+    }
+
+    tris.clear();
+    for(const std::vector<Triangle>& decimatedTris : decimatedCellTris)
+        tris.insert(tris.end(), decimatedTris.begin(), decimatedTris.end());
+}
+
+} // namespace
+
+void decimateMesh(Mesh& mesh, int targetNbVertices, const MeshDecimationParams& params)
+{
+    system::Timer timer;
+
+    const Mesh::Adjacency& ptsNeighTris = mesh.getPtsNeighTrisAdjacency();
+    int nbVertices = 0;
+    for(int v = 0; v < mesh.pts.size(); ++v)
+    {
+        if(ptsNeighTris.size(v) > 0)
+            ++nbVertices;
+    }
+
+    ALICEVISION_LOG_INFO("Decimate mesh from " << nbVertices << " to " << targetNbVertices << " vertices.");
+
+    std::vector<Point3d> pts(mesh.pts.begin(), mesh.pts.end());
+    std::vector<Triangle> tris(mesh.tris.size());
+    for(int t = 0; t < mesh.tris.size(); ++t)
+        tris[t] = {mesh.tris[t].v[0], mesh.tris[t].v[1], mesh.tris[t].v[2]};
+
+    if(targetNbVertices < nbVertices)
+    {
+        std::vector<Quadric> quadrics;
+        computeQuadrics(mesh, ptsNeighTris, params.boundaryWeight, quadrics);
+
+        // partitions decimated in parallel, their borders being locked
+        const int nbPartitions = std::min(params.nbPartitions > 0 ? params.nbPartitions : omp_get_max_threads() * 8,
+                                          static_cast<int>(tris.size()) / std::max(1, params.minPartitionSize));
+        if(nbPartitions > 1)
+        {
+            decimatePartitions(pts, quadrics, tris, ptsNeighTris, nbPartitions, static_cast<double>(targetNbVertices) / nbVertices);
+            ALICEVISION_LOG_INFO("Partitions decimated (" << timer.elapsed() << " s).");
+        }
+
+        // final pass on the whole mesh, collapsing the partitions borders
+        removeUnreferencedVertices(pts, quadrics, tris);
+        const std::vector<char> locked(pts.size(), 0);
+        QuadricDecimator decimator(pts, quadrics, tris, locked);
+        decimator.decimate(targetNbVertices);
+    }
+
+    std::vector<Quadric> noQuadrics;
+    removeUnreferencedVertices(pts, noQuadrics, tris);
+
+    mesh.pts.resize(pts.size());
+    std::copy(pts.begin(), pts.end(), mesh.pts.begin());
+    mesh.tris.resize(tris.size());
+    for(int t = 0; t < tris.size(); ++t)
+        mesh.tris[t] = Mesh::triangle(tris[t][0], tris[t][1], tris[t][2]);
+    mesh.invalidateTopology();
+    mesh.colors().clear();
+    mesh.trisMtlIds().clear();
+    mesh.nmtls = 0;
+    mesh.uvCoords.clear();
+    mesh.trisUvIds.clear();
+    mesh.normals.clear();
+    mesh.trisNormalsIds.clear();
+    mesh.pointsVisibilities.clear();
+
+    ALICEVISION_LOG_INFO("Mesh decimated to " << mesh.pts.size() << " vertices and " << mesh.tris.size() << " triangles ("
+                         << timer.elapsed() << " s).");
+}
+
+} // namespace mesh
+} // namespace aliceVision
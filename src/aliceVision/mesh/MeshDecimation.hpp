@@ -0,0 +1,38 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+struct MeshDecimationParams
+{
+    int nbPartitions = 0;          //< number of spatial partitions decimated in parallel (0: 8 per thread)
+    int minPartitionSize = 20000;  //< minimal average number of triangles per partition, fewer partitions are used below
+    double boundaryWeight = 1000.; //< weight of the quadrics keeping the mesh boundaries in place
+};
+
+/**
+ * @brief Simplify the mesh to a number of vertices by quadric error edge collapses.
+ *
+ * The triangles are first split into a regular grid of spatial partitions, decimated concurrently
+ * while the vertices on the partitions borders are locked. A final pass on the whole mesh
+ * collapses the borders down to the target number of vertices, keeping the quadrics accumulated
+ * in the partitions.
+ * The collapses keep the mesh manifold and are rejected if they flip a triangle.
+ * The boundary vertices only collapse along the boundary and do not move, so the open boundaries are kept.
+ *
+ * @param[in,out] mesh the mesh to decimate, only its vertices and triangles are kept
+ * @param[in] targetNbVertices the number of vertices of the decimated mesh
+ * @param[in] params the decimation parameters
+ */
+void decimateMesh(Mesh& mesh, int targetNbVertices, const MeshDecimationParams& params = MeshDecimationParams());
+
+} // namespace mesh
+} // namespace aliceVision
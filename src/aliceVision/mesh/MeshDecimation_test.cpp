@@ -0,0 +1,375 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshDecimation.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshDecimation
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/**
+ * @brief Unit sphere by subdivision of an icosahedron, triangles oriented outwards.
+ */
+Mesh createSphere(int nbSubdivisions)
+{
+    const double t = (1.0 + std::sqrt(5.0)) / 2.0;
+    std::vector<Point3d> pts = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    std::vector<std::array<int, 3>> tris = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+        {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+    for(Point3d& p : pts)
+        p = p.normalize();
+
+    for(int s = 0; s < nbSubdivisions; ++s)
+    {
+        std::map<std::pair<int, int>, int> middles;
+        const auto getMiddle = [&](int a, int b) {
+            const std::pair<int, int> edge(std::min(a, b), std::max(a, b));
+            const auto it = middles.find(edge);
+            if(it != middles.end())
+                return it->second;
+            pts.push_back(((pts[a] + pts[b]) * 0.5).normalize());
+            middles.emplace(edge, static_cast<int>(pts.size()) - 1);
+            return static_cast<int>(pts.size()) - 1;
+        };
+        std::vector<std::array<int, 3>> subdividedTris;
+        for(const std::array<int, 3>& tri : tris)
+        {
+            const int ab = getMiddle(tri[0], tri[1]);
+            const int bc = getMiddle(tri[1], tri[2]);
+            const int ca = getMiddle(tri[2], tri[0]);
+            subdividedTris.push_back({tri[0], ab, ca});
+            subdividedTris.push_back({tri[1], bc, ab});
+            subdividedTris.push_back({tri[2], ca, bc});
+            subdividedTris.push_back({ab, bc, ca});
+        }
+        tris.swap(subdividedTris);
+    }
+
+    Mesh mesh;
+    for(const Point3d& p : pts)
+        mesh.pts.push_back(p);
+    for(const std::array<int, 3>& tri : tris)
+        mesh.tris.push_back(Mesh::triangle(tri[0], tri[1], tri[2]));
+    return mesh;
+}
+
+/// Height of the open grid surface
+double gridHeight(double x, double y)
+{
+    return 0.1 * std::sin(3.0 * x) * std::cos(2.0 * y);
+}
+
+/**
+ * @brief Open square grid [0, 1]^2 of n x n vertices on a smooth height field, triangles oriented upwards.
+ */
+Mesh createGrid(int n)
+{
+    Mesh mesh;
+    for(int j = 0; j < n; ++j)
+    {
+        for(int i = 0; i < n; ++i)
+        {
+            const double x = double(i) / (n - 1);
+            const double y = double(j) / (n - 1);
+            mesh.pts.push_back(Point3d(x, y, gridHeight(x, y)));
+        }
+    }
+    for(int j = 0; j < n - 1; ++j)
+    {
+        for(int i = 0; i < n - 1; ++i)
+        {
+            const int v = j * n + i;
+            mesh.tris.push_back(Mesh::triangle(v, v + 1, v + n + 1));
+            mesh.tris.push_back(Mesh::triangle(v, v + n + 1, v + n));
+        }
+    }
+    return mesh;
+}
+
+Point3d triangleNormal(const Mesh& mesh, int triId)
+{
+    const Mesh::triangle& tri = mesh.tris[triId];
+    return cross(mesh.pts[tri.v[1]] - mesh.pts[tri.v[0]], mesh.pts[tri.v[2]] - mesh.pts[tri.v[0]]);
+}
+
+/**
+ * @brief Check that every vertex is used, the triangles are not degenerate and the mesh is manifold
+ *        with consistent orientations.
+ * @return the boundary edges (used by a single triangle), oriented as in their triangle
+ */
+std::vector<std::pair<int, int>> checkManifold(const Mesh& mesh)
+{
+    std::vector<int> nbVertexTris(mesh.pts.size(), 0);
+    std::map<std::pair<int, int>, int> directedEdges;
+    for(int t = 0; t < mesh.tris.size(); ++t)
+    {
+        const Mesh::triangle& tri = mesh.tris[t];
+        BOOST_CHECK_MESSAGE(tri.v[0] != tri.v[1] && tri.v[1] != tri.v[2] && tri.v[2] != tri.v[0], "degenerate triangle " << t);
+        BOOST_CHECK_GT(triangleNormal(mesh, t).size(), 0.0);
+        for(int k = 0; k < 3; ++k)
+        {
+            BOOST_REQUIRE(tri.v[k] >= 0 && tri.v[k] < mesh.pts.size());
+            ++nbVertexTris[tri.v[k]];
+            ++directedEdges[std::make_pair(tri.v[k], tri.v[(k + 1) % 3])];
+        }
+    }
+    for(int v = 0; v < mesh.pts.size(); ++v)
+        BOOST_CHECK_MESSAGE(nbVertexTris[v] > 0, "unreferenced vertex " << v);
+
+    // each directed edge once (no non-manifold edge, consistent orientations), boundary edges have no opposite
+    std::vector<std::pair<int, int>> boundaryEdges;
+    for(const auto& edge : directedEdges)
+    {
+        BOOST_CHECK_MESSAGE(edge.second == 1, "non-manifold edge " << edge.first.first << " " << edge.first.second);
+        if(directedEdges.count(std::make_pair(edge.first.second, edge.first.first)) == 0)
+            boundaryEdges.push_back(edge.first);
+    }
+
+    // manifold vertices: a single fan of triangles
+    std::vector<std::vector<int>> vertexTris(mesh.pts.size());
+    for(int t = 0; t < mesh.tris.size(); ++t)
+    {
+        for(int k = 0; k < 3; ++k)
+            vertexTris[mesh.tris[t].v[k]].push_back(t);
+    }
+    std::vector<int> nbBoundaryEdges(mesh.pts.size(), 0);
+    for(const auto& edge : boundaryEdges)
+    {
+        ++nbBoundaryEdges[edge.first];
+        ++nbBoundaryEdges[edge.second];
+    }
+    for(int v = 0; v < mesh.pts.size(); ++v)
+    {
+        // V - E + F of the fan: 1 for a disk (open fan), 0 for a closed fan
+        std::map<std::pair<int, int>, int> fanEdges;
+        for(const int t : vertexTris[v])
+        {
+            const Mesh::triangle& tri = mesh.tris[t];
+            for(int k = 0; k < 3; ++k)
+            {
+                const int a = tri.v[k];
+                const int b = tri.v[(k + 1) % 3];
+                if(a == v || b == v)
+                    fanEdges[std::make_pair(std::min(a, b), std::max(a, b))];
+            }
+        }
+        const int nbFanEdges = fanEdges.size();
+        const int nbFanTris = vertexTris[v].size();
+        BOOST_CHECK_MESSAGE(nbBoundaryEdges[v] == 0 || nbBoundaryEdges[v] == 2, "non-manifold boundary vertex " << v);
+        BOOST_CHECK_MESSAGE(nbFanEdges - nbFanTris == (nbBoundaryEdges[v] ? 1 : 0), "non-manifold vertex " << v);
+    }
+    return boundaryEdges;
+}
+
+int eulerCharacteristic(const Mesh& mesh)
+{
+    std::map<std::pair<int, int>, int> edges;
+    for(int t = 0; t < mesh.tris.size(); ++t)
+    {
+        const Mesh::triangle& tri = mesh.tris[t];
+        for(int k = 0; k < 3; ++k)
+            edges[std::make_pair(std::min(tri.v[k], tri.v[(k + 1) % 3]), std::max(tri.v[k], tri.v[(k + 1) % 3]))];
+    }
+    return static_cast<int>(mesh.pts.size()) - static_cast<int>(edges.size()) + static_cast<int>(mesh.tris.size());
+}
+
+/// Distance from a point to a triangle
+double pointTriangleDistance(const Point3d& p, const Point3d& a, const Point3d& b, const Point3d& c)
+{
+    // closest point by the regions of the triangle (Ericson, Real-Time Collision Detection)
+    const Point3d ab = b - a;
+    const Point3d ac = c - a;
+    const Point3d ap = p - a;
+    const double d1 = dot(ab, ap);
+    const double d2 = dot(ac, ap);
+    if(d1 <= 0.0 && d2 <= 0.0)
+        return (p - a).size();
+
+    const Point3d bp = p - b;
+    const double d3 = dot(ab, bp);
+    const double d4 = dot(ac, bp);
+    if(d3 >= 0.0 && d4 <= d3)
+        return (p - b).size();
+
+    const double vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+        return (p - (a + ab * (d1 / (d1 - d3)))).size();
+
+    const Point3d cp = p - c;
+    const double d5 = dot(ab, cp);
+    const double d6 = dot(ac, cp);
+    if(d6 >= 0.0 && d5 <= d6)
+        return (p - c).size();
+
+    const double vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+        return (p - (a + ac * (d2 / (d2 - d6)))).size();
+
+    const double va = d3 * d6 - d5 * d4;
+    if(va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+        return (p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))))).size();
+
+    const double denom = 1.0 / (va + vb + vc);
+    return (p - (a + ab * (vb * denom) + ac * (vc * denom))).size();
+}
+
+/**
+ * @brief Mean distance from the vertices of the reference mesh to the decimated mesh.
+ */
+double meanDistance(const Mesh& refMesh, const Mesh& mesh)
+{
+    double sum = 0.0;
+    for(int v = 0; v < refMesh.pts.size(); ++v)
+    {
+        double distance = std::numeric_limits<double>::max();
+        for(int t = 0; t < mesh.tris.size(); ++t)
+        {
+            const Mesh::triangle& tri = mesh.tris[t];
+            distance = std::min(distance, pointTriangleDistance(refMesh.pts[v], mesh.pts[tri.v[0]], mesh.pts[tri.v[1]], mesh.pts[tri.v[2]]));
+        }
+        sum += distance;
+    }
+    return sum / refMesh.pts.size();
+}
+
+MeshDecimationParams getParams(int nbPartitions)
+{
+    MeshDecimationParams params;
+    params.nbPartitions = nbPartitions;
+    params.minPartitionSize = 100;
+    return params;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshDecimation_closedSphere)
+{
+    const Mesh refMesh = createSphere(4);
+    const int targetNbVertices = refMesh.pts.size() / 8;
+
+    std::vector<double> errors;
+    for(const int nbPartitions : {1, 8, 27})
+    {
+        BOOST_TEST_MESSAGE("partitions " << nbPartitions);
+        Mesh mesh = refMesh;
+        decimateMesh(mesh, targetNbVertices, getParams(nbPartitions));
+
+        // closed genus 0 mesh: F = 2V - 4, no boundary even along the partitions borders
+        BOOST_CHECK_EQUAL(mesh.pts.size(), targetNbVertices);
+        BOOST_CHECK_EQUAL(mesh.tris.size(), 2 * targetNbVertices - 4);
+        BOOST_CHECK(checkManifold(mesh).empty());
+        BOOST_CHECK_EQUAL(eulerCharacteristic(mesh), 2);
+
+        // normals still outwards
+        for(int t = 0; t < mesh.tris.size(); ++t)
+        {
+            const Mesh::triangle& tri = mesh.tris[t];
+            const Point3d centroid = (mesh.pts[tri.v[0]] + mesh.pts[tri.v[1]] + mesh.pts[tri.v[2]]) / 3.0;
+            BOOST_CHECK_MESSAGE(dot(triangleNormal(mesh, t), centroid) > 0.0, "flipped triangle " << t);
+        }
+        for(int v = 0; v < mesh.pts.size(); ++v)
+            BOOST_CHECK_SMALL(mesh.pts[v].size() - 1.0, 0.05);
+
+        errors.push_back(meanDistance(refMesh, mesh));
+    }
+
+    // the partitions do not degrade the approximation much
+    BOOST_TEST_MESSAGE("mean errors " << errors[0] << " " << errors[1] << " " << errors[2]);
+    BOOST_CHECK_LT(errors[0], 0.01);
+    BOOST_CHECK_LT(errors[1], 1.5 * errors[0]);
+    BOOST_CHECK_LT(errors[2], 1.5 * errors[0]);
+}
+
+BOOST_AUTO_TEST_CASE(meshDecimation_openGrid)
+{
+    const int n = 60;
+    const Mesh refMesh = createGrid(n);
+    const int targetNbVertices = refMesh.pts.size() / 10;
+
+    std::vector<double> errors;
+    for(const int nbPartitions : {1, 4, 16})
+    {
+        BOOST_TEST_MESSAGE("partitions " << nbPartitions);
+        Mesh mesh = refMesh;
+        decimateMesh(mesh, targetNbVertices, getParams(nbPartitions));
+
+        BOOST_CHECK_EQUAL(mesh.pts.size(), targetNbVertices);
+        const std::vector<std::pair<int, int>> boundaryEdges = checkManifold(mesh);
+        // a single disk: F = 2V - B - 2 with B boundary vertices
+        BOOST_CHECK_EQUAL(eulerCharacteristic(mesh), 1);
+        BOOST_CHECK_EQUAL(mesh.tris.size(), 2 * targetNbVertices - boundaryEdges.size() - 2);
+
+        // normals still upwards
+        for(int t = 0; t < mesh.tris.size(); ++t)
+            BOOST_CHECK_MESSAGE(triangleNormal(mesh, t).z > 0.0, "flipped triangle " << t);
+
+        // the boundary stays on the square sides and keeps its corners
+        const auto sideOf = [](const Point3d& p) {
+            const double eps = 1e-9;
+            return (std::abs(p.x) < eps ? 1 : 0) | (std::abs(p.x - 1.0) < eps ? 2 : 0) |
+                   (std::abs(p.y) < eps ? 4 : 0) | (std::abs(p.y - 1.0) < eps ? 8 : 0);
+        };
+        for(const auto& edge : boundaryEdges)
+        {
+            const Point3d& a = mesh.pts[edge.first];
+            const Point3d& b = mesh.pts[edge.second];
+            BOOST_CHECK_MESSAGE(sideOf(a) & sideOf(b), "boundary edge (" << a.x << ", " << a.y << ") (" << b.x << ", " << b.y << ") leaves the sides");
+            BOOST_CHECK_SMALL(a.z - gridHeight(a.x, a.y), 1e-9);
+        }
+        int nbCorners = 0;
+        for(int v = 0; v < mesh.pts.size(); ++v)
+        {
+            const int side = sideOf(mesh.pts[v]);
+            if(side == 5 || side == 6 || side == 9 || side == 10)
+                ++nbCorners;
+        }
+        BOOST_CHECK_EQUAL(nbCorners, 4);
+
+        errors.push_back(meanDistance(refMesh, mesh));
+    }
+
+    BOOST_TEST_MESSAGE("mean errors " << errors[0] << " " << errors[1] << " " << errors[2]);
+    BOOST_CHECK_LT(errors[0], 0.005);
+    BOOST_CHECK_LT(errors[1], 1.5 * errors[0]);
+    BOOST_CHECK_LT(errors[2], 1.5 * errors[0]);
+}
+
+BOOST_AUTO_TEST_CASE(meshDecimation_target)
+{
+    // nothing to do above the number of vertices, except removing the free vertices
+    Mesh mesh = createGrid(10);
+    const Mesh refMesh = mesh;
+    mesh.pts.push_back(Point3d(5.0, 5.0, 5.0));
+    decimateMesh(mesh, refMesh.pts.size());
+
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), refMesh.pts.size());
+    BOOST_REQUIRE_EQUAL(mesh.tris.size(), refMesh.tris.size());
+    for(int t = 0; t < mesh.tris.size(); ++t)
+    {
+        for(int k = 0; k < 3; ++k)
+            BOOST_CHECK(mesh.pts[mesh.tris[t].v[k]] == refMesh.pts[refMesh.tris[t].v[k]]);
+    }
+}
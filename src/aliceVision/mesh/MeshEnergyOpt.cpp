@@ -6,14 +6,191 @@
 
 #include "MeshEnergyOpt.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 namespace aliceVision {
 namespace mesh {
 
 namespace bfs = boost::filesystem;
 
+std::string ESmoothingMethod_enumToString(ESmoothingMethod method)
+{
+    switch(method)
+    {
+        case ESmoothingMethod::Explicit: return "explicit";
+        case ESmoothingMethod::Implicit: return "implicit";
+    }
+    throw std::out_of_range("Invalid smoothing method enum: " + std::to_string(int(method)));
+}
+
+ESmoothingMethod ESmoothingMethod_stringToEnum(const std::string& method)
+{
+    const std::string m = boost::to_lower_copy(method);
+
+    if(m == "explicit")
+        return ESmoothingMethod::Explicit;
+    if(m == "implicit")
+        return ESmoothingMethod::Implicit;
+    throw std::out_of_range("Invalid smoothing method: " + method);
+}
+
+std::ostream& operator<<(std::ostream& os, ESmoothingMethod method)
+{
+    return os << ESmoothingMethod_enumToString(method);
+}
+
+std::istream& operator>>(std::istream& in, ESmoothingMethod& method)
+{
+    std::string token;
+    in >> token;
+    method = ESmoothingMethod_stringToEnum(token);
+    return in;
+}
+
+namespace {
+
+/**
+ * @brief Cotangent Laplacian L in CSR format with the lumped (barycentric) vertex areas M.
+ *        (L.x)_i = diagonal_i * x_i - sum_j weights_ij * x_j
+ */
+struct CotanLaplacian
+{
+    std::vector<int> offsets;
+    std::vector<int> neighbors;
+    std::vector<double> weights;
+    std::vector<double> diagonal;
+    std::vector<double> masses;
+
+    template <typename T>
+    T applyRow(int i, const std::vector<T>& x) const
+    {
+        T sum = x[i] * diagonal[i];
+        for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+            sum = sum - x[neighbors[k]] * weights[k];
+        return sum;
+    }
+};
+
+/// cotangents are clamped to keep the system well conditioned on almost degenerate triangles
+constexpr double maxCotan = 1e3;
+
+/**
+ * @brief Get the cotangent weights of the edges around a vertex, sorted by neighbor, and its area.
+ */
+void getCotanRow(const Mesh& mesh, const Mesh::Adjacency& ptsNeighTris, int ptId,
+                 std::vector<std::pair<int, double>>& out_row, double& out_mass)
+{
+    out_row.clear();
+    out_mass = 0.0;
+
+    for(const int* it = ptsNeighTris.begin(ptId); it != ptsNeighTris.end(ptId); ++it)
+    {
+        const int* v = mesh.tris[*it].v;
+        const int k = (v[0] == ptId) ? 0 : ((v[1] == ptId) ? 1 : 2);
+        const int j = v[(k + 1) % 3];
+        const int l = v[(k + 2) % 3];
+
+        const Point3d& pi = mesh.pts[ptId];
+        const Point3d& pj = mesh.pts[j];
+        const Point3d& pl = mesh.pts[l];
+
+        // twice the triangle area
+        const double area2 = cross(pj - pi, pl - pi).size();
+        if(!(area2 > 0.0))
+            continue;
+
+        // the edge (i, j) is opposite to the angle at l, the edge (i, l) to the angle at j
+        const double cotL = std::clamp(dot(pi - pl, pj - pl) / area2, -maxCotan, maxCotan);
+        const double cotJ = std::clamp(dot(pi - pj, pl - pj) / area2, -maxCotan, maxCotan);
+        out_row.emplace_back(j, 0.5 * cotL);
+        out_row.emplace_back(l, 0.5 * cotJ);
+        out_mass += area2 / 6.0;
+    }
+
+    std::sort(out_row.begin(), out_row.end());
+    std::size_t n = 0;
+    for(std::size_t k = 0; k < out_row.size(); ++k)
+    {
+        if(n > 0 && out_row[n - 1].first == out_row[k].first)
+            out_row[n - 1].second += out_row[k].second;
+        else
+            out_row[n++] = out_row[k];
+    }
+    out_row.resize(n);
+}
+
+void buildCotanLaplacian(const Mesh& mesh, CotanLaplacian& out)
+{
+    const Mesh::Adjacency& ptsNeighTris = mesh.getPtsNeighTrisAdjacency();
+    const int nbPts = mesh.pts.size();
+
+    out.offsets.assign(nbPts + 1, 0);
+    out.diagonal.assign(nbPts, 0.0);
+    out.masses.assign(nbPts, 0.0);
+
+#pragma omp parallel
+    {
+        std::vector<std::pair<int, double>> row;
+        double mass;
+
+#pragma omp for
+        for(int i = 0; i < nbPts; ++i)
+        {
+            getCotanRow(mesh, ptsNeighTris, i, row, mass);
+            out.offsets[i + 1] = row.size();
+        }
+
+#pragma omp single
+        {
+            for(int i = 0; i < nbPts; ++i)
+                out.offsets[i + 1] += out.offsets[i];
+            out.neighbors.resize(out.offsets[nbPts]);
+            out.weights.resize(out.offsets[nbPts]);
+        }
+
+#pragma omp for
+        for(int i = 0; i < nbPts; ++i)
+        {
+            getCotanRow(mesh, ptsNeighTris, i, row, mass);
+            double sum = 0.0;
+            for(std::size_t k = 0; k < row.size(); ++k)
+            {
+                out.neighbors[out.offsets[i] + k] = row[k].first;
+                out.weights[out.offsets[i] + k] = row[k].second;
+                sum += row[k].second;
+            }
+            out.diagonal[i] = sum;
+            out.masses[i] = mass;
+        }
+    }
+}
+
+/// component-wise product and sum of the products of two vectors of points
+Point3d dotPerAxis(const std::vector<Point3d>& a, const std::vector<Point3d>& b)
+{
+    double x = 0.0, y = 0.0, z = 0.0;
+#pragma omp parallel for reduction(+ : x, y, z)
+    for(int i = 0; i < static_cast<int>(a.size()); ++i)
+    {
+        x += a[i].x * b[i].x;
+        y += a[i].y * b[i].y;
+        z += a[i].z * b[i].z;
+    }
+    return Point3d(x, y, z);
+}
+
+} // namespace
+
+
 MeshEnergyOpt::MeshEnergyOpt(mvsUtils::MultiViewParams* _mp)
     : MeshAnalyze(_mp)
 {
@@ -21,40 +198,35 @@ MeshEnergyOpt::MeshEnergyOpt(mvsUtils::MultiViewParams* _mp)
 //    bfs::create_directory(tmpDir);
 }
 
+MeshEnergyOpt::MeshEnergyOpt(mvsUtils::MultiViewParams* _mp, Mesh&& mesh)
+    : MeshAnalyze(_mp, std::move(mesh))
+{}
+
 MeshEnergyOpt::~MeshEnergyOpt() = default;
 
 void MeshEnergyOpt::computeLaplacianPtsParallel(StaticVector<Point3d>& out_lapPts)
 {
-    out_lapPts.reserve(pts.size());
-    out_lapPts.resize_with(pts.size(), Point3d(0.0f, 0.0f, 0.f));
-    int nlabpts = 0;
+    out_lapPts.resize(pts.size());
 
 #pragma omp parallel for
     for(int i = 0; i < pts.size(); i++)
     {
         Point3d lapPt;
-        if(getLaplacianSmoothingVector(i, lapPt))
-        {
-            out_lapPts[i] = lapPt;
-            nlabpts++;
-        }
+        out_lapPts[i] = getLaplacianSmoothingVector(i, lapPt) ? lapPt : Point3d(0.0f, 0.0f, 0.0f);
     }
 }
 
-void MeshEnergyOpt::updateGradientParallel(float lambda, const Point3d& LU,
-                                                const Point3d& RD, StaticVectorBool& ptsCanMove)
+void MeshEnergyOpt::updateGradientParallel(float lambda, const Point3d& LU, const Point3d& RD, StaticVectorBool& ptsCanMove,
+                                           StaticVector<Point3d>& lapPts, StaticVector<Point3d>& newPts)
 {
-    // printf("nlabpts %i of %i\n",nlabpts,pts->size());
-    StaticVector<Point3d> lapPts;
     computeLaplacianPtsParallel(lapPts);
 
-    StaticVector<Point3d> newPts;
-    newPts.reserve(pts.size());
-    newPts.push_back_arr(&pts);
+    newPts.resize(pts.size());
 
 #pragma omp parallel for
     for(int i = 0; i < pts.size(); ++i)
     {
+        newPts[i] = pts[i];
         if( ptsCanMove.empty() || ptsCanMove[i] )
         {
             Point3d n;
@@ -70,11 +242,154 @@ void MeshEnergyOpt::updateGradientParallel(float lambda, const Point3d& LU,
         }
     }
 
-    pts.clear();
     pts.swap(newPts);
 }
 
-bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove)
+void MeshEnergyOpt::solveImplicitSmoothing(double timeStep, const Point3d& LU, const Point3d& RD,
+                                           const StaticVectorBool& ptsCanMove)
+{
+    constexpr int maxIterations = 1000;
+    constexpr double tolerance = 1e-3;
+
+    system::Timer timer;
+    const int nbPts = pts.size();
+
+    CotanLaplacian laplacian;
+    buildCotanLaplacian(*this, laplacian);
+
+    // isolated vertices do not move, the almost zero areas are raised to keep M invertible
+    std::vector<char> isFree(nbPts);
+    double meanMass = 0.0;
+    int nbMasses = 0;
+    for(int i = 0; i < nbPts; ++i)
+    {
+        isFree[i] = (laplacian.masses[i] > 0.0) && (ptsCanMove.empty() || ptsCanMove[i]);
+        if(laplacian.masses[i] > 0.0)
+        {
+            meanMass += laplacian.masses[i];
+            ++nbMasses;
+        }
+    }
+    if(nbMasses == 0 || timeStep <= 0.0)
+        return;
+    meanMass /= nbMasses;
+
+    // The bi-Laplacian scales as 1 / area^2, so the time step of each vertex is relative to its own squared area
+    // (h_i = timeStep.m_i^2) to smooth each region relatively to its resolution, like the explicit iterations.
+    // Scaling the rows of (M + H.K) by H^-1 keeps the system symmetric: (W + K).D = -K.P with W_i = 1 / (timeStep.m_i).
+    std::vector<double> invMasses(nbPts);
+    std::vector<double> stepWeights(nbPts);
+    for(int i = 0; i < nbPts; ++i)
+    {
+        const double mass = std::max(laplacian.masses[i], 1e-6 * meanMass);
+        invMasses[i] = 1.0 / mass;
+        stepWeights[i] = invMasses[i] / timeStep;
+    }
+
+    // K.x = L.M^-1.L.x
+    std::vector<Point3d> tmp(nbPts);
+    const auto applyBiLaplacian = [&](const std::vector<Point3d>& x, std::vector<Point3d>& out_x)
+    {
+#pragma omp parallel for
+        for(int i = 0; i < nbPts; ++i)
+            tmp[i] = laplacian.applyRow(i, x) * invMasses[i];
+#pragma omp parallel for
+        for(int i = 0; i < nbPts; ++i)
+            out_x[i] = laplacian.applyRow(i, tmp);
+    };
+
+    // solve (W + K).D = -K.P for the displacements D of the free vertices
+    std::vector<Point3d> positions(pts.getData().begin(), pts.getData().end());
+    std::vector<Point3d> displacements(nbPts, Point3d(0.0, 0.0, 0.0));
+    std::vector<Point3d> residual(nbPts);
+    std::vector<Point3d> preconditioned(nbPts);
+    std::vector<Point3d> direction(nbPts);
+    std::vector<Point3d> product(nbPts);
+    std::vector<double> invDiagonal(nbPts, 0.0);
+
+    applyBiLaplacian(positions, residual);
+
+#pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+    {
+        if(!isFree[i])
+        {
+            residual[i] = Point3d(0.0, 0.0, 0.0);
+            continue;
+        }
+        residual[i] = -residual[i];
+
+        // Jacobi preconditioner: diagonal of W + K
+        double diagonalK = laplacian.diagonal[i] * laplacian.diagonal[i] * invMasses[i];
+        for(int k = laplacian.offsets[i]; k < laplacian.offsets[i + 1]; ++k)
+            diagonalK += laplacian.weights[k] * laplacian.weights[k] * invMasses[laplacian.neighbors[k]];
+        invDiagonal[i] = 1.0 / (stepWeights[i] + diagonalK);
+        preconditioned[i] = residual[i] * invDiagonal[i];
+        direction[i] = preconditioned[i];
+    }
+
+    const Point3d rhsNorm2 = dotPerAxis(residual, residual);
+    Point3d rz = dotPerAxis(residual, preconditioned);
+    Point3d residualNorm2 = rhsNorm2;
+
+    const auto isConverged = [&](const Point3d& r2)
+    {
+        return (r2.x <= tolerance * tolerance * rhsNorm2.x) &&
+               (r2.y <= tolerance * tolerance * rhsNorm2.y) &&
+               (r2.z <= tolerance * tolerance * rhsNorm2.z);
+    };
+
+    int iteration = 0;
+    for(; iteration < maxIterations && !isConverged(residualNorm2); ++iteration)
+    {
+        applyBiLaplacian(direction, product);
+#pragma omp parallel for
+        for(int i = 0; i < nbPts; ++i)
+            product[i] = isFree[i] ? direction[i] * stepWeights[i] + product[i] : Point3d(0.0, 0.0, 0.0);
+
+        const Point3d pAp = dotPerAxis(direction, product);
+        const Point3d alpha(pAp.x > 0.0 ? rz.x / pAp.x : 0.0,
+                            pAp.y > 0.0 ? rz.y / pAp.y : 0.0,
+                            pAp.z > 0.0 ? rz.z / pAp.z : 0.0);
+
+#pragma omp parallel for
+        for(int i = 0; i < nbPts; ++i)
+        {
+            displacements[i] = displacements[i] + Point3d(alpha.x * direction[i].x, alpha.y * direction[i].y, alpha.z * direction[i].z);
+            residual[i] = residual[i] - Point3d(alpha.x * product[i].x, alpha.y * product[i].y, alpha.z * product[i].z);
+            preconditioned[i] = residual[i] * invDiagonal[i];
+        }
+
+        const Point3d rzNew = dotPerAxis(residual, preconditioned);
+        const Point3d beta(rz.x > 0.0 ? rzNew.x / rz.x : 0.0,
+                           rz.y > 0.0 ? rzNew.y / rz.y : 0.0,
+                           rz.z > 0.0 ? rzNew.z / rz.z : 0.0);
+        rz = rzNew;
+        residualNorm2 = dotPerAxis(residual, residual);
+
+#pragma omp parallel for
+        for(int i = 0; i < nbPts; ++i)
+            direction[i] = preconditioned[i] + Point3d(beta.x * direction[i].x, beta.y * direction[i].y, beta.z * direction[i].z);
+    }
+
+#pragma omp parallel for
+    for(int i = 0; i < nbPts; ++i)
+    {
+        const Point3d p = positions[i] + displacements[i];
+        if((p.x > LU.x) && (p.y > LU.y) && (p.z > LU.z) && (p.x < RD.x) && (p.y < RD.y) && (p.z < RD.z))
+        {
+            pts[i] = p;
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Implicit smoothing solved in " << iteration << " conjugate gradient iterations, relative residual: "
+                         << std::sqrt(std::max({residualNorm2.x / std::max(rhsNorm2.x, 1e-300),
+                                                residualNorm2.y / std::max(rhsNorm2.y, 1e-300),
+                                                residualNorm2.z / std::max(rhsNorm2.z, 1e-300)}))
+                         << " (" << timer.elapsed() << " s).");
+}
+
+bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove, ESmoothingMethod method)
 {
     if(pts.size() <= 4)
     {
@@ -97,13 +412,33 @@ bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& pt
     }
 
     ALICEVISION_LOG_INFO("Optimizing mesh smooth: " << std::endl
+                         << "\t- method: " << ESmoothingMethod_enumToString(method) << std::endl
                          << "\t- lamda: " << lambda << std::endl
                          << "\t- niters: " << niter << std::endl);
 
+    if(method == ESmoothingMethod::Implicit)
+    {
+        // Same smoothing time as niter explicit iterations, on a regular mesh of edge length e (valence 6):
+        // - the umbrella operator U is about e^2/4 times the continuous Laplacian, the explicit iteration
+        //   moves the vertices by lambda.U^2/v with v = 1 + 1/6, i.e. lambda * (6/7) * (e^4/16) times the bi-Laplacian
+        // - M^-1.L is the continuous Laplacian and the vertex area is sqrt(3)/2.e^2, so the implicit time step
+        //   relative to the squared vertex area is (3/4).e^4 times the bi-Laplacian
+        // which gives a time step of lambda * niter / (16 * 7/6 * 3/4) = lambda * niter / 14.
+        // MeshEnergyOpt_test checks that both methods give the same roughness reduction.
+        constexpr double explicitToImplicitTimeStep = 1.0 / 14.0;
+        if(niter > 0)
+            solveImplicitSmoothing(lambda * niter * explicitToImplicitTimeStep, LU, RD, ptsCanMove);
+        return true;
+    }
+
+    // buffers reused by all the iterations
+    StaticVector<Point3d> lapPts;
+    StaticVector<Point3d> newPts;
+
     for(int i = 0; i < niter; i++)
     {
         ALICEVISION_LOG_INFO("Optimizing mesh smooth: iteration " << i);
-        updateGradientParallel(lambda, LU, RD, ptsCanMove);
+        updateGradientParallel(lambda, LU, RD, ptsCanMove, lapPts, newPts);
         //if(saveDebug)
         //    save(folder + "mesh_smoothed_" + std::to_string(i));
     }
@@ -10,20 +10,63 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mesh/MeshAnalyze.hpp>
 
+#include <iostream>
+#include <string>
+
 namespace aliceVision {
 namespace mesh {
 
+/**
+ * @brief Smoothing scheme used by MeshEnergyOpt::optimizeSmooth.
+ */
+enum class ESmoothingMethod
+{
+    Explicit = 0, //< iterative bi-Laplacian updates of the vertices
+    Implicit      //< one implicit cotangent bi-Laplacian step, solved by conjugate gradient
+};
+
+std::string ESmoothingMethod_enumToString(ESmoothingMethod method);
+ESmoothingMethod ESmoothingMethod_stringToEnum(const std::string& method);
+std::ostream& operator<<(std::ostream& os, ESmoothingMethod method);
+std::istream& operator>>(std::istream& in, ESmoothingMethod& method);
+
 class MeshEnergyOpt : public MeshAnalyze
 {
 public:
     explicit MeshEnergyOpt(mvsUtils::MultiViewParams* _mp);
+    /**
+     * @brief Smooth the mesh without copy, see MeshClean::releaseMesh to get it back.
+     */
+    MeshEnergyOpt(mvsUtils::MultiViewParams* _mp, Mesh&& mesh);
     ~MeshEnergyOpt();
 
-    bool optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove);
+    /**
+     * @brief Smooth the mesh vertices.
+     * @param[in] lambda the smoothing step
+     * @param[in] niter the number of explicit iterations, the implicit step covers the same smoothing time
+     * @param[in] ptsCanMove the vertices allowed to move (all of them if empty)
+     * @param[in] method the smoothing scheme
+     * @return false if the mesh is too small to be smoothed
+     */
+    bool optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove,
+                        ESmoothingMethod method = ESmoothingMethod::Explicit);
 
 private:
     void computeLaplacianPtsParallel(StaticVector<Point3d>& out_lapPts);
-    void updateGradientParallel(float lambda, const Point3d& LU, const Point3d& RD, StaticVectorBool& ptsCanMove);
+    void updateGradientParallel(float lambda, const Point3d& LU, const Point3d& RD, StaticVectorBool& ptsCanMove,
+                                StaticVector<Point3d>& lapPts, StaticVector<Point3d>& newPts);
+
+    /**
+     * @brief Apply one backward Euler step of the bi-Laplacian flow (M + H.L.M^-1.L) P' = M.P,
+     *        with L the cotangent Laplacian, M the lumped mass matrix and H the per-vertex time steps,
+     *        solved by conjugate gradient.
+     * @param[in] timeStep the time step relative to the squared area of each vertex, so that dense
+     *            and sparse regions are smoothed relatively to their own resolution
+     * @param[in] LU the lower corner of the box the vertices should stay in
+     * @param[in] RD the upper corner of the box the vertices should stay in
+     * @param[in] ptsCanMove the vertices allowed to move (all of them if empty)
+     */
+    void solveImplicitSmoothing(double timeStep, const Point3d& LU, const Point3d& RD, const StaticVectorBool& ptsCanMove);
 };
 
 } // namespace mesh
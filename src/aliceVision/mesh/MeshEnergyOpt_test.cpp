@@ -0,0 +1,257 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshEnergyOpt.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshEnergyOpt
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/**
+ * @brief Unit icosphere with a deterministic radial noise of relative amplitude noise.
+ */
+Mesh createNoisySphere(int nbSubdivisions, double noise)
+{
+    Mesh mesh;
+    const double a = (1.0 + std::sqrt(5.0)) / 2.0;
+    for(const Point3d& p : {Point3d(-1, a, 0), Point3d(1, a, 0), Point3d(-1, -a, 0), Point3d(1, -a, 0),
+                            Point3d(0, -1, a), Point3d(0, 1, a), Point3d(0, -1, -a), Point3d(0, 1, -a),
+                            Point3d(a, 0, -1), Point3d(a, 0, 1), Point3d(-a, 0, -1), Point3d(-a, 0, 1)})
+        mesh.pts.push_back(p.normalize());
+
+    std::vector<Mesh::triangle> triangles = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9}, {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+
+    for(int s = 0; s < nbSubdivisions; ++s)
+    {
+        std::map<std::pair<int, int>, int> middles;
+        const auto getMiddle = [&](int i, int j) {
+            const std::pair<int, int> edge(std::min(i, j), std::max(i, j));
+            const auto it = middles.find(edge);
+            if(it != middles.end())
+                return it->second;
+            mesh.pts.push_back(((mesh.pts[i] + mesh.pts[j]) * 0.5).normalize());
+            return middles[edge] = mesh.pts.size() - 1;
+        };
+
+        std::vector<Mesh::triangle> subdivided;
+        for(const Mesh::triangle& t : triangles)
+        {
+            const int a = getMiddle(t.v[0], t.v[1]);
+            const int b = getMiddle(t.v[1], t.v[2]);
+            const int c = getMiddle(t.v[2], t.v[0]);
+            subdivided.emplace_back(t.v[0], a, c);
+            subdivided.emplace_back(t.v[1], b, a);
+            subdivided.emplace_back(t.v[2], c, b);
+            subdivided.emplace_back(a, b, c);
+        }
+        triangles.swap(subdivided);
+    }
+    for(const Mesh::triangle& t : triangles)
+        mesh.tris.push_back(t);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> noiseDistribution(-noise, noise);
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        mesh.pts[i] = mesh.pts[i] * (1.0 + noiseDistribution(generator));
+    return mesh;
+}
+
+/**
+ * @brief Move the vertices of the unit sphere along the meridians, the density decreases from the north pole
+ *        (z = 1) to the south pole with a vertex spacing ratio of about 7.
+ */
+void warpSphereDensity(Mesh& mesh)
+{
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        const Point3d& p = mesh.pts[i];
+        const double radius = p.size();
+        const double s = std::acos(std::max(-1.0, std::min(1.0, p.z / radius))) / M_PI;
+        const double theta = M_PI * (0.25 * s + 0.75 * s * s);
+        const double phi = std::atan2(p.y, p.x);
+        mesh.pts[i] = Point3d(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)) * radius;
+    }
+}
+
+/// Standard deviation of the distance to the center of the selected vertices (all of them if empty)
+double getRoughness(const Mesh& mesh, const std::vector<int>& ptIds = std::vector<int>())
+{
+    std::vector<int> ids = ptIds;
+    if(ids.empty())
+    {
+        for(int i = 0; i < mesh.pts.size(); ++i)
+            ids.push_back(i);
+    }
+
+    double mean = 0.0;
+    for(const int i : ids)
+        mean += mesh.pts[i].size();
+    mean /= ids.size();
+
+    double variance = 0.0;
+    for(const int i : ids)
+        variance += (mesh.pts[i].size() - mean) * (mesh.pts[i].size() - mean);
+    return std::sqrt(variance / ids.size());
+}
+
+/// Root mean square distance between the vertices of two meshes
+double getRmsDistance(const Mesh& a, const Mesh& b)
+{
+    double sum = 0.0;
+    for(int i = 0; i < a.pts.size(); ++i)
+        sum += (a.pts[i] - b.pts[i]).size() * (a.pts[i] - b.pts[i]).size();
+    return std::sqrt(sum / a.pts.size());
+}
+
+/**
+ * @brief Smooth a copy of the mesh as the meshFiltering does, returns the computation time.
+ */
+double smooth(const Mesh& mesh, float lambda, int niter, ESmoothingMethod method, StaticVectorBool& ptsCanMove, Mesh& out_mesh)
+{
+    MeshEnergyOpt meOpt(nullptr, Mesh(mesh));
+    meOpt.init();
+    meOpt.cleanMesh(10);
+    BOOST_REQUIRE_EQUAL(meOpt.pts.size(), mesh.pts.size());
+
+    system::Timer timer;
+    BOOST_CHECK(meOpt.optimizeSmooth(lambda, niter, ptsCanMove, method));
+    const double elapsed = timer.elapsed();
+
+    out_mesh = meOpt.releaseMesh();
+    BOOST_CHECK(meOpt.pts.empty());
+    return elapsed;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshEnergyOpt_explicitVsImplicit)
+{
+    // 2562 vertices
+    const Mesh mesh = createNoisySphere(4, 0.01);
+    const double initialRoughness = getRoughness(mesh);
+    StaticVectorBool ptsCanMove;
+
+    for(const auto& [lambda, niter] : std::vector<std::pair<float, int>>{{0.1f, 1}, {1.0f, 10}, {1.0f, 100}})
+    {
+        Mesh explicitMesh;
+        Mesh implicitMesh;
+        const double explicitTime = smooth(mesh, lambda, niter, ESmoothingMethod::Explicit, ptsCanMove, explicitMesh);
+        const double implicitTime = smooth(mesh, lambda, niter, ESmoothingMethod::Implicit, ptsCanMove, implicitMesh);
+
+        const double explicitRoughness = getRoughness(explicitMesh);
+        const double implicitRoughness = getRoughness(implicitMesh);
+        BOOST_TEST_MESSAGE("lambda " << lambda << ", niter " << niter << ": roughness " << initialRoughness
+                           << " -> explicit " << explicitRoughness << " (" << explicitTime << " s), implicit "
+                           << implicitRoughness << " (" << implicitTime << " s)");
+
+        BOOST_CHECK_LT(explicitRoughness, initialRoughness);
+        BOOST_CHECK_LT(implicitRoughness, initialRoughness);
+
+        // the implicit time step matches the explicit iterations
+        BOOST_CHECK_GT(implicitRoughness / explicitRoughness, 0.75);
+        BOOST_CHECK_LT(implicitRoughness / explicitRoughness, 1.33);
+
+        // both move the vertices by the same amount for small steps
+        if(lambda * niter < 1.0f)
+        {
+            const double ratio = getRmsDistance(implicitMesh, mesh) / getRmsDistance(explicitMesh, mesh);
+            BOOST_CHECK_GT(ratio, 0.6);
+            BOOST_CHECK_LT(ratio, 1.4);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshEnergyOpt_densityGradient)
+{
+    // the noise amplitude does not depend on the density
+    Mesh mesh = createNoisySphere(4, 0.0);
+    warpSphereDensity(mesh);
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> noiseDistribution(-0.01, 0.01);
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        mesh.pts[i] = mesh.pts[i] * (1.0 + noiseDistribution(generator));
+
+    // dense north cap and sparse south cap
+    std::vector<int> denseIds;
+    std::vector<int> sparseIds;
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        const double z = mesh.pts[i].z / mesh.pts[i].size();
+        if(z > 0.7)
+            denseIds.push_back(i);
+        else if(z < -0.7)
+            sparseIds.push_back(i);
+    }
+    BOOST_REQUIRE_GT(denseIds.size(), 4 * sparseIds.size());
+    BOOST_REQUIRE_GT(sparseIds.size(), 20);
+
+    StaticVectorBool ptsCanMove;
+    for(const auto& [lambda, niter] : std::vector<std::pair<float, int>>{{1.0f, 10}, {1.0f, 50}})
+    {
+        Mesh explicitMesh;
+        Mesh implicitMesh;
+        smooth(mesh, lambda, niter, ESmoothingMethod::Explicit, ptsCanMove, explicitMesh);
+        smooth(mesh, lambda, niter, ESmoothingMethod::Implicit, ptsCanMove, implicitMesh);
+
+        // the explicit iterations smooth each region relatively to its own resolution,
+        // the implicit time step is normalized by the local vertex area to do the same
+        for(const std::vector<int>* ids : {&denseIds, &sparseIds})
+        {
+            const double initialRoughness = getRoughness(mesh, *ids);
+            const double explicitRoughness = getRoughness(explicitMesh, *ids);
+            const double implicitRoughness = getRoughness(implicitMesh, *ids);
+            BOOST_TEST_MESSAGE("lambda " << lambda << ", niter " << niter << ", " << (ids == &denseIds ? "dense" : "sparse")
+                               << " region: roughness " << initialRoughness << " -> explicit " << explicitRoughness
+                               << ", implicit " << implicitRoughness);
+
+            BOOST_CHECK_LT(explicitRoughness, initialRoughness);
+            BOOST_CHECK_LT(implicitRoughness, initialRoughness);
+            BOOST_CHECK_GT(implicitRoughness / explicitRoughness, 0.67);
+            BOOST_CHECK_LT(implicitRoughness / explicitRoughness, 1.5);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshEnergyOpt_lockedVertices)
+{
+    const Mesh mesh = createNoisySphere(3, 0.01);
+
+    StaticVectorBool ptsCanMove;
+    ptsCanMove.resize(mesh.pts.size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        ptsCanMove[i] = (i % 3 != 0);
+
+    for(const ESmoothingMethod method : {ESmoothingMethod::Explicit, ESmoothingMethod::Implicit})
+    {
+        Mesh smoothedMesh;
+        smooth(mesh, 1.0f, 10, method, ptsCanMove, smoothedMesh);
+
+        int nbMoved = 0;
+        for(int i = 0; i < mesh.pts.size(); ++i)
+        {
+            if(!ptsCanMove[i])
+                BOOST_CHECK(smoothedMesh.pts[i] == mesh.pts[i]);
+            else
+                nbMoved += static_cast<int>(!(smoothedMesh.pts[i] == mesh.pts[i]));
+        }
+        BOOST_CHECK_GT(nbMoved, 0);
+    }
+}
@@ -0,0 +1,261 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshKdTree.hpp"
+#include "Mesh.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// Number of Morton sorted queries searched by a single thread, each starting from the previous result
+constexpr int queriesBlockSize = 256;
+constexpr int maxStackSize = 64;
+
+/// Spread the 21 lower bits of the value to every third bit
+std::uint64_t spreadBits(std::uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x1f00000000ffffULL;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+    v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+    v = (v | (v << 2)) & 0x1249249249249249ULL;
+    return v;
+}
+
+using Cell = std::array<std::array<float, 3>, 2>; //< min and max corners
+
+} // namespace
+
+void getMortonSortedPoints(const StaticVector<Point3d>& pts, std::vector<int>& out_sortedPoints)
+{
+    Point3d bmin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bmax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    for(int i = 0; i < pts.size(); ++i)
+    {
+        bmin = Point3d(std::min(bmin.x, pts[i].x), std::min(bmin.y, pts[i].y), std::min(bmin.z, pts[i].z));
+        bmax = Point3d(std::max(bmax.x, pts[i].x), std::max(bmax.y, pts[i].y), std::max(bmax.z, pts[i].z));
+    }
+    const double extent = std::max({bmax.x - bmin.x, bmax.y - bmin.y, bmax.z - bmin.z, std::numeric_limits<double>::min()});
+    const double scale = double((1 << 21) - 1) / extent;
+
+    std::vector<std::pair<std::uint64_t, int>> codes(pts.size());
+    #pragma omp parallel for
+    for(int i = 0; i < pts.size(); ++i)
+    {
+        const Point3d p = (pts[i] - bmin) * scale;
+        codes[i] = {spreadBits(std::uint64_t(p.x)) | (spreadBits(std::uint64_t(p.y)) << 1) | (spreadBits(std::uint64_t(p.z)) << 2), i};
+    }
+    std::sort(codes.begin(), codes.end());
+
+    out_sortedPoints.resize(pts.size());
+    for(int i = 0; i < pts.size(); ++i)
+        out_sortedPoints[i] = codes[i].second;
+}
+
+MeshKdTree::MeshKdTree(const StaticVector<Point3d>& pts, int maxLeafSize)
+{
+    build(pts, maxLeafSize);
+}
+
+MeshKdTree::MeshKdTree(const Mesh& mesh, int maxLeafSize)
+{
+    build(mesh.pts, maxLeafSize);
+}
+
+void MeshKdTree::build(const StaticVector<Point3d>& pts, int maxLeafSize)
+{
+    system::Timer timer;
+    const int nbPoints = pts.size();
+    if(nbPoints == 0)
+        return;
+
+    // center of the points bounding box, to keep the single precision coordinates small
+    Point3d bmin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bmax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    for(int i = 0; i < nbPoints; ++i)
+    {
+        const Point3d& p = pts[i];
+        bmin = Point3d(std::min(bmin.x, p.x), std::min(bmin.y, p.y), std::min(bmin.z, p.z));
+        bmax = Point3d(std::max(bmax.x, p.x), std::max(bmax.y, p.y), std::max(bmax.z, p.z));
+    }
+    _center = (bmin + bmax) * 0.5;
+
+    _points.resize(nbPoints);
+
+#pragma omp parallel for
+    for(int i = 0; i < nbPoints; ++i)
+    {
+        const Point3d p = pts[i] - _center;
+        _points[i] = {{static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)}, i};
+    }
+
+    // all the leaves at the same depth, with at least 2 points per leaf so none is empty
+    maxLeafSize = std::max(2, maxLeafSize);
+    _depth = 0;
+    while(((static_cast<std::int64_t>(nbPoints) + (std::int64_t(1) << _depth) - 1) >> _depth) > maxLeafSize)
+        ++_depth;
+
+    _nodes.resize((std::size_t(1) << _depth) - 1);
+
+    // split the nodes level by level, the nodes of a level in parallel
+    std::vector<int> levelBegins = {0, nbPoints};
+    std::vector<Cell> levelCells(1);
+    for(int k = 0; k < 3; ++k)
+    {
+        levelCells[0][0][k] = static_cast<float>((&bmin.x)[k] - (&_center.x)[k]);
+        levelCells[0][1][k] = static_cast<float>((&bmax.x)[k] - (&_center.x)[k]);
+    }
+
+    for(int level = 0; level < _depth; ++level)
+    {
+        const int nbLevelNodes = 1 << level;
+        std::vector<int> nextBegins(2 * nbLevelNodes + 1);
+        std::vector<Cell> nextCells(2 * nbLevelNodes);
+        nextBegins.back() = nbPoints;
+
+#pragma omp parallel for schedule(dynamic)
+        for(int i = 0; i < nbLevelNodes; ++i)
+        {
+            const int begin = levelBegins[i];
+            const int end = levelBegins[i + 1];
+            const int middle = begin + (end - begin) / 2;
+            const Cell& cell = levelCells[i];
+
+            // split the largest dimension of the cell at the median point
+            int axis = 0;
+            for(int k = 1; k < 3; ++k)
+            {
+                if(cell[1][k] - cell[0][k] > cell[1][axis] - cell[0][axis])
+                    axis = k;
+            }
+            std::nth_element(_points.begin() + begin, _points.begin() + middle, _points.begin() + end,
+                             [axis](const Point& a, const Point& b) { return a.p[axis] < b.p[axis]; });
+            const float split = _points[middle].p[axis];
+
+            _nodes[nbLevelNodes - 1 + i] = {split, axis};
+
+            nextBegins[2 * i] = begin;
+            nextBegins[2 * i + 1] = middle;
+            nextCells[2 * i] = cell;
+            nextCells[2 * i][1][axis] = split;
+            nextCells[2 * i + 1] = cell;
+            nextCells[2 * i + 1][0][axis] = split;
+        }
+
+        levelBegins.swap(nextBegins);
+        levelCells.swap(nextCells);
+    }
+    _leavesOffsets.swap(levelBegins);
+
+    ALICEVISION_LOG_INFO("Kd-tree of " << nbPoints << " points built in " << timer.elapsed() << " s ("
+                         << static_cast<double>(getMemorySize()) / (1024.0 * 1024.0) << " MB).");
+}
+
+std::size_t MeshKdTree::getMemorySize() const
+{
+    return _nodes.size() * sizeof(Node) + _leavesOffsets.size() * sizeof(int) + _points.size() * sizeof(Point);
+}
+
+int MeshKdTree::searchNearest(const float query[3], int hint) const
+{
+    const auto squaredDistance = [query](const float p[3])
+    {
+        const float dx = p[0] - query[0];
+        const float dy = p[1] - query[1];
+        const float dz = p[2] - query[2];
+        return dx * dx + dy * dy + dz * dz;
+    };
+
+    int bestIndex = hint;
+    float bestDist2 = (hint < 0) ? std::numeric_limits<float>::max() : squaredDistance(_points[hint].p);
+
+    // far children with the squared distance to their split plane
+    std::pair<int, float> stack[maxStackSize];
+    int stackSize = 0;
+    stack[stackSize++] = {0, 0.0f};
+
+    const int firstLeaf = (1 << _depth) - 1;
+    while(stackSize > 0)
+    {
+        const std::pair<int, float> entry = stack[--stackSize];
+        if(entry.second >= bestDist2)
+            continue;
+
+        int node = entry.first;
+
+        while(node < firstLeaf)
+        {
+            const Node& n = _nodes[node];
+            const float d = query[n.axis] - n.split;
+            const int left = 2 * node + 1;
+            stack[stackSize++] = {(d < 0.0f) ? left + 1 : left, d * d};
+            node = (d < 0.0f) ? left : left + 1;
+        }
+
+        const int leaf = node - firstLeaf;
+        for(int i = _leavesOffsets[leaf]; i < _leavesOffsets[leaf + 1]; ++i)
+        {
+            const float dist2 = squaredDistance(_points[i].p);
+            if(dist2 < bestDist2)
+            {
+                bestDist2 = dist2;
+                bestIndex = i;
+            }
+        }
+    }
+    return bestIndex;
+}
+
+int MeshKdTree::getNearestPoint(const Point3d& point) const
+{
+    if(_points.empty())
+        return -1;
+
+    const Point3d p = point - _center;
+    const float query[3] = {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)};
+    return _points[searchNearest(query, -1)].id;
+}
+
+void MeshKdTree::getNearestPoints(const StaticVector<Point3d>& points, StaticVector<int>& out_nearestPoints) const
+{
+    out_nearestPoints.resize(points.size(), -1);
+    if(_points.empty() || points.empty())
+        return;
+
+    std::vector<int> sortedPoints;
+    getMortonSortedPoints(points, sortedPoints);
+
+    const int nbBlocks = (points.size() + queriesBlockSize - 1) / queriesBlockSize;
+
+#pragma omp parallel for schedule(dynamic)
+    for(int b = 0; b < nbBlocks; ++b)
+    {
+        const int end = std::min(points.size(), (b + 1) * queriesBlockSize);
+        int nearest = -1;
+        for(int i = b * queriesBlockSize; i < end; ++i)
+        {
+            const Point3d p = points[sortedPoints[i]] - _center;
+            const float query[3] = {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)};
+            nearest = searchNearest(query, nearest);
+            out_nearestPoints[sortedPoints[i]] = _points[nearest].id;
+        }
+    }
+}
+
+} // namespace mesh
+} // namespace aliceVision
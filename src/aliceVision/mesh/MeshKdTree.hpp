@@ -0,0 +1,100 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+/**
+ * @brief Get the points indexes sorted along a Morton curve, so that consecutive points are spatially close.
+ */
+void getMortonSortedPoints(const StaticVector<Point3d>& pts, std::vector<int>& out_sortedPoints);
+
+/**
+ * @class MeshKdTree
+ * @brief Kd-tree over the mesh vertices for nearest vertex queries.
+ *
+ * The tree is balanced (median splits) and stored implicitly, leaves hold between maxLeafSize / 2 and
+ * maxLeafSize points. Coordinates are stored in single precision relative to the center of the points
+ * bounding box, so the memory is about 16 bytes per point.
+ * It is built once per reference mesh and can be shared by all the queries on it,
+ * but it is not updated with the mesh: it should be built again if the vertices change.
+ */
+class MeshKdTree
+{
+public:
+    /**
+     * @param[in] pts the points
+     * @param[in] maxLeafSize the maximum number of points in a leaf
+     */
+    explicit MeshKdTree(const StaticVector<Point3d>& pts, int maxLeafSize = 8);
+
+    /**
+     * @param[in] mesh the mesh, only its vertices are used
+     * @param[in] maxLeafSize the maximum number of points in a leaf
+     */
+    explicit MeshKdTree(const Mesh& mesh, int maxLeafSize = 8);
+
+    int getNbPoints() const { return static_cast<int>(_points.size()); }
+
+    /// Memory used by the tree in bytes
+    std::size_t getMemorySize() const;
+
+    /**
+     * @brief Get the index of the nearest point, -1 if the tree is empty.
+     */
+    int getNearestPoint(const Point3d& point) const;
+
+    /**
+     * @brief Get the index of the nearest point of each query point.
+     * @note The queries are sorted along a Morton curve and processed in parallel by blocks,
+     *       each query starting from the result of the previous one in its block.
+     * @param[in] points the query points
+     * @param[out] out_nearestPoints the index of the nearest point for each query point, -1 if the tree is empty
+     */
+    void getNearestPoints(const StaticVector<Point3d>& points, StaticVector<int>& out_nearestPoints) const;
+
+private:
+    void build(const StaticVector<Point3d>& pts, int maxLeafSize);
+
+    /**
+     * @brief Search the nearest point, starting from the point at index hint in leaves order (-1 if none).
+     * @return the index in leaves order of the nearest point
+     */
+    int searchNearest(const float query[3], int hint) const;
+
+    struct Node
+    {
+        float split; //< split coordinate
+        int axis;    //< split axis
+    };
+
+    struct Point
+    {
+        float p[3];
+        int id; //< index of the point in the input points
+    };
+
+    /// inner nodes in heap order: the children of node i are 2i+1 and 2i+2
+    std::vector<Node> _nodes;
+    /// first point of each leaf (and the number of points at the end)
+    std::vector<int> _leavesOffsets;
+    /// points in leaves order
+    std::vector<Point> _points;
+    int _depth = 0;
+    Point3d _center;
+};
+
+} // namespace mesh
+} // namespace aliceVision
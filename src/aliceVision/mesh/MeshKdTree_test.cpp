@@ -0,0 +1,168 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshKdTree.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshKdTree
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+StaticVector<Point3d> createRandomPoints(int nbPoints, double extent, std::mt19937& generator)
+{
+    std::uniform_real_distribution<double> distribution(-extent, extent);
+    StaticVector<Point3d> pts;
+    for(int i = 0; i < nbPoints; ++i)
+        pts.push_back(Point3d(distribution(generator), distribution(generator), distribution(generator)));
+    return pts;
+}
+
+double squaredDistance(const Point3d& a, const Point3d& b)
+{
+    return (a - b).size2();
+}
+
+/**
+ * @brief Check the nearest points given by the tree against a brute force search.
+ *        With ties any of the nearest points is accepted, so the distances are compared.
+ * @param[in] tolerance the tolerance on the squared distances, the tree stores single precision coordinates
+ */
+void checkNearestPoints(const MeshKdTree& kdTree, const StaticVector<Point3d>& pts, const StaticVector<Point3d>& queries, double tolerance)
+{
+    StaticVector<int> nearestPoints;
+    kdTree.getNearestPoints(queries, nearestPoints);
+    BOOST_REQUIRE_EQUAL(nearestPoints.size(), queries.size());
+
+    for(int i = 0; i < queries.size(); ++i)
+    {
+        double expectedDist2 = std::numeric_limits<double>::max();
+        for(int j = 0; j < pts.size(); ++j)
+            expectedDist2 = std::min(expectedDist2, squaredDistance(pts[j], queries[i]));
+
+        const int nearestPoint = kdTree.getNearestPoint(queries[i]);
+        BOOST_REQUIRE(nearestPoint >= 0 && nearestPoint < pts.size());
+        BOOST_CHECK_SMALL(squaredDistance(pts[nearestPoint], queries[i]) - expectedDist2, tolerance);
+
+        // the blocks of queries start from the previous result, which can be another point among the ties
+        BOOST_REQUIRE(nearestPoints[i] >= 0 && nearestPoints[i] < pts.size());
+        BOOST_CHECK_SMALL(squaredDistance(pts[nearestPoints[i]], queries[i]) - expectedDist2, tolerance);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshKdTree_empty)
+{
+    const StaticVector<Point3d> pts;
+    const MeshKdTree kdTree(pts);
+    BOOST_CHECK_EQUAL(kdTree.getNbPoints(), 0);
+    BOOST_CHECK_EQUAL(kdTree.getNearestPoint(Point3d(1.0, 2.0, 3.0)), -1);
+
+    StaticVector<Point3d> queries;
+    queries.push_back(Point3d(1.0, 2.0, 3.0));
+    StaticVector<int> nearestPoints;
+    kdTree.getNearestPoints(queries, nearestPoints);
+    BOOST_REQUIRE_EQUAL(nearestPoints.size(), 1);
+    BOOST_CHECK_EQUAL(nearestPoints[0], -1);
+}
+
+BOOST_AUTO_TEST_CASE(meshKdTree_random)
+{
+    std::mt19937 generator(42);
+
+    for(const int nbPoints : {1, 2, 3, 17, 1000, 5000})
+    {
+        const StaticVector<Point3d> pts = createRandomPoints(nbPoints, 10.0, generator);
+        // queries inside and around the points bounding box
+        const StaticVector<Point3d> queries = createRandomPoints(2000, 15.0, generator);
+
+        for(const int maxLeafSize : {1, 8, 64})
+        {
+            BOOST_TEST_MESSAGE("points " << nbPoints << ", max leaf size " << maxLeafSize);
+            const MeshKdTree kdTree(pts, maxLeafSize);
+            BOOST_CHECK_EQUAL(kdTree.getNbPoints(), nbPoints);
+            BOOST_CHECK_GT(kdTree.getMemorySize(), 0);
+            checkNearestPoints(kdTree, pts, queries, 1e-4);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshKdTree_tiesAndDuplicates)
+{
+    // integer grid with each point repeated, the coordinates are exact in single precision
+    const int n = 6;
+    StaticVector<Point3d> pts;
+    for(int z = 0; z < n; ++z)
+    {
+        for(int y = 0; y < n; ++y)
+        {
+            for(int x = 0; x < n; ++x)
+            {
+                for(int copy = 0; copy <= (x + y + z) % 3; ++copy)
+                    pts.push_back(Point3d(x, y, z));
+            }
+        }
+    }
+    // many copies of a single point, more than a leaf
+    for(int copy = 0; copy < 50; ++copy)
+        pts.push_back(Point3d(2.0, 3.0, 4.0));
+
+    // queries on the points, at the middle of the edges and at the center of the cells: equidistant to several points
+    StaticVector<Point3d> queries;
+    for(int z = 0; z < 2 * n; ++z)
+    {
+        for(int y = 0; y < 2 * n; ++y)
+        {
+            for(int x = 0; x < 2 * n; ++x)
+                queries.push_back(Point3d(0.5 * x, 0.5 * y, 0.5 * z));
+        }
+    }
+
+    for(const int maxLeafSize : {2, 8, 64})
+    {
+        const MeshKdTree kdTree(pts, maxLeafSize);
+        checkNearestPoints(kdTree, pts, queries, 0.0);
+
+        // the duplicates of the point are returned
+        const int nearestPoint = kdTree.getNearestPoint(Point3d(2.0, 3.0, 4.0));
+        BOOST_REQUIRE_GE(nearestPoint, 0);
+        BOOST_CHECK(pts[nearestPoint] == Point3d(2.0, 3.0, 4.0));
+    }
+
+    // all the points at the same position
+    StaticVector<Point3d> samePts;
+    for(int i = 0; i < 100; ++i)
+        samePts.push_back(Point3d(-1.0, 0.5, 2.0));
+    const MeshKdTree sameKdTree(samePts);
+    checkNearestPoints(sameKdTree, samePts, queries, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(meshKdTree_meshVertices)
+{
+    std::mt19937 generator(7);
+    Mesh mesh;
+    mesh.pts = createRandomPoints(300, 1.0, generator);
+
+    // large offset, the tree coordinates are relative to the center of the points
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        mesh.pts[i] = mesh.pts[i] + Point3d(1000.0, -2000.0, 500.0);
+
+    const MeshKdTree kdTree(mesh);
+    BOOST_CHECK_EQUAL(kdTree.getNbPoints(), mesh.pts.size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        BOOST_CHECK(mesh.pts[kdTree.getNearestPoint(mesh.pts[i])] == mesh.pts[i]);
+    checkNearestPoints(kdTree, mesh.pts, mesh.pts, 1e-6);
+}
@@ -0,0 +1,419 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshMasking.hpp"
+#include "Mesh.hpp"
+#include "MeshKdTree.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/camera/cameraUndistortImage.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// Number of spatially sorted vertices sharing the same cameras culling
+constexpr int verticesBlockSize = 256;
+
+/**
+ * @brief Whether the box is entirely outside of the camera image, with a margin of one pixel.
+ * @note each test is a half-space, so the box is outside if all its corners are outside of the same half-space
+ */
+bool isBoxOutsideCamera(const mvsUtils::MultiViewParams& mp, int camId, const Point3d& bmin, const Point3d& bmax)
+{
+    const double w = mp.getWidth(camId);
+    const double h = mp.getHeight(camId);
+    std::array<bool, 5> allOutside = {true, true, true, true, true};
+    for(int c = 0; c < 8; ++c)
+    {
+        const Point3d corner((c & 1) ? bmax.x : bmin.x, (c & 2) ? bmax.y : bmin.y, (c & 4) ? bmax.z : bmin.z);
+        const Point3d XT = mp.camArr[camId] * corner;
+        allOutside[0] = allOutside[0] && (XT.z <= 0.0);                    // behind the camera
+        allOutside[1] = allOutside[1] && (XT.x + 1.5 * XT.z < 0.0);        // left of the image
+        allOutside[2] = allOutside[2] && (XT.x - (w + 0.5) * XT.z >= 0.0); // right of the image
+        allOutside[3] = allOutside[3] && (XT.y + 1.5 * XT.z < 0.0);        // above the image
+        allOutside[4] = allOutside[4] && (XT.y - (h + 0.5) * XT.z >= 0.0); // below the image
+    }
+    return std::any_of(allOutside.begin(), allOutside.end(), [](bool outside) { return outside; });
+}
+
+/**
+ * @brief Whether the camera sees the point out of the masks.
+ */
+bool isVisibleOutOfMask(const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks, int camId, const Point3d& point)
+{
+    Pixel projectedPixel;
+    mp.getPixelFor3DPoint(&projectedPixel, point, camId);
+    if(projectedPixel.x < 0 || projectedPixel.x >= mp.getWidth(camId) ||
+       projectedPixel.y < 0 || projectedPixel.y >= mp.getHeight(camId))
+        return false;
+    return masks.isVisible(camId, projectedPixel.x, projectedPixel.y);
+}
+
+StaticVector<int> computeDiffVisibilities(const StaticVector<int>& A, const StaticVector<int>& B)
+{
+    assert(std::is_sorted(A.begin(), A.end()));
+    assert(std::is_sorted(B.begin(), B.end()));
+    StaticVector<int> diff;
+    std::set_symmetric_difference(A.begin(), A.end(), B.begin(), B.end(), std::back_inserter(diff.getDataWritable()));
+    return diff;
+}
+
+/**
+ * @brief Binary search of the masks boundary along the edge from a visible vertex to a hidden one.
+ */
+Point3d findBoundaryVertex(const Mesh& mesh, int visibleVertexId, int hiddenVertexId,
+                           const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks, int threshold)
+{
+    // find the cameras that make a difference, we only need to sample those
+    const auto& visibleVertexVisibilities = mesh.pointsVisibilities[visibleVertexId];
+    const auto& hiddenVertexVisibilities = mesh.pointsVisibilities[hiddenVertexId];
+    assert(visibleVertexVisibilities.size() > hiddenVertexVisibilities.size());
+    assert(hiddenVertexVisibilities.size() < threshold);
+
+    const auto diffVisibilities = computeDiffVisibilities(visibleVertexVisibilities, hiddenVertexVisibilities);
+    assert(diffVisibilities.size() > 0);
+    assert(std::is_sorted(diffVisibilities.begin(), diffVisibilities.end()));
+
+    // compute the visibility that is already acquired and that does not change along the edge.
+    // <=> is in hiddenVertexVisibilities but not in diffVisibilities
+    const int baseVisibility = std::count_if(hiddenVertexVisibilities.begin(), hiddenVertexVisibilities.end(),
+        [&diffVisibilities] (int camId) { return diffVisibilities.indexOfSorted(camId) == -1; });
+
+    // compute the minimal distance according to the mask resolution (it is our search stop condition)
+    const Point3d leftPoint = mesh.pts[visibleVertexId];
+    const Point3d rightPoint = mesh.pts[hiddenVertexId];
+    const float minDistance = [&]
+    {
+        const int camId = diffVisibilities[0];  // use a single mask, supposing they are all equivalent
+        Pixel leftPixel, rightPixel;
+        mp.getPixelFor3DPoint(&leftPixel, leftPoint, camId);
+        mp.getPixelFor3DPoint(&rightPixel, rightPoint, camId);
+        const int manhattanDistance = std::abs(rightPixel.x - leftPixel.x) + std::abs(rightPixel.y - leftPixel.y);
+        return 1.f / float(manhattanDistance);
+    }();
+
+    // binary search in continuous space along the edge
+    float left = 0.f;  // is the visible area
+    float right = 1.f;  // is the hidden area
+    while (true)
+    {
+        const float mid = (left + right) * 0.5f;
+        const Point3d midPoint = leftPoint + (rightPoint - leftPoint) * mid;
+
+        if (mid - left < minDistance)
+            return midPoint;  // stop the search
+
+        int diffVisibility = 0;
+        for (const int camId : diffVisibilities)
+        {
+            Pixel projectedPixel;
+            mp.getPixelFor3DPoint(&projectedPixel, midPoint, camId);
+            if (mp.isPixelInImage(projectedPixel, camId) && masks.isVisible(camId, projectedPixel.x, projectedPixel.y))
+                ++diffVisibility;
+        }
+
+        const bool isVisible = (baseVisibility + diffVisibility) >= threshold;
+        float& newBoundary = isVisible ? left : right;
+        newBoundary = mid;
+    }
+}
+
+} // namespace
+
+MaskBitmaskCache::MaskBitmaskCache(const mvsUtils::MultiViewParams& mp, const std::vector<std::string>& masksFolders,
+                                   const std::string& maskExtension, bool undistortMasks, bool invert)
+{
+    _masks.resize(mp.getNbCameras());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int camId = 0; camId < mp.getNbCameras(); ++camId)
+    {
+        const IndexT viewId = mp.getViewId(camId);
+        image::Image<unsigned char> mask;
+        if(!image::tryLoadMask(&mask, masksFolders, viewId, mp.getImagePath(camId), maskExtension))
+            continue;
+
+        if(undistortMasks)
+        {
+            const auto& sfm = mp.getInputSfMData();
+            const IndexT intrinsicId = sfm.getView(viewId).getIntrinsicId();
+            const auto intrinsicIt = sfm.intrinsics.find(intrinsicId);
+            if(intrinsicIt != sfm.intrinsics.end())
+            {
+                const auto& intrinsic = intrinsicIt->second;
+                if(intrinsic->isValid() && intrinsic->hasDistortion())
+                {
+                    image::Image<unsigned char> mask_ud;
+                    camera::UndistortImage(mask, intrinsic.get(), mask_ud, (unsigned char)0);
+                    mask.swap(mask_ud);
+                }
+            }
+        }
+
+        if(mp.getWidth(camId) != mask.Width() || mp.getHeight(camId) != mask.Height())
+        {
+            ALICEVISION_LOG_WARNING("Invalid mask size for view " << viewId << ": mask is ignored.");
+            continue;
+        }
+
+        Bitmask& bitmask = _masks[camId];
+        bitmask.width = mask.Width();
+        bitmask.bits.assign((std::size_t(mask.Width()) * mask.Height() + 63) / 64, 0);
+        for(int y = 0; y < mask.Height(); ++y)
+        {
+            for(int x = 0; x < mask.Width(); ++x)
+            {
+                // a zero value is masked, unless the mask is inverted
+                if((mask(y, x) != 0) != invert)
+                {
+                    const std::size_t bit = std::size_t(y) * bitmask.width + x;
+                    bitmask.bits[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+                }
+            }
+        }
+    }
+
+    ALICEVISION_LOG_INFO(getNbMasks() << " masks loaded (" << getMemorySize() / (1024 * 1024) << " MB).");
+}
+
+int MaskBitmaskCache::getNbMasks() const
+{
+    return std::count_if(_masks.begin(), _masks.end(), [](const Bitmask& mask) { return !mask.bits.empty(); });
+}
+
+std::size_t MaskBitmaskCache::getMemorySize() const
+{
+    std::size_t size = 0;
+    for(const Bitmask& mask : _masks)
+        size += mask.bits.size() * sizeof(std::uint64_t);
+    return size;
+}
+
+void computeVerticesMaskVisibilities(const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks,
+                                     bool usePointsVisibilities, Mesh& mesh,
+                                     StaticVector<int>& out_vertexVisibilityCounters)
+{
+    out_vertexVisibilityCounters.resize_with(mesh.pts.size(), 0);
+
+    if(usePointsVisibilities)
+    {
+        // only keep the cameras seeing the vertex out of the masks
+        #pragma omp parallel for
+        for(int vertexId = 0; vertexId < mesh.pts.size(); ++vertexId)
+        {
+            auto& pointVisibilities = mesh.pointsVisibilities[vertexId];
+            auto& visibilities = pointVisibilities.getDataWritable();
+            visibilities.erase(std::remove_if(visibilities.begin(), visibilities.end(), [&](int camId) {
+                return !masks.hasMask(camId) || !isVisibleOutOfMask(mp, masks, camId, mesh.pts[vertexId]);
+            }), visibilities.end());
+            out_vertexVisibilityCounters[vertexId] = pointVisibilities.size();
+        }
+        return;
+    }
+
+    // the mesh file may already contain visibilities, they are replaced by the masks visibilities
+    mesh.pointsVisibilities.resize(mesh.pts.size());
+    #pragma omp parallel for
+    for(int vertexId = 0; vertexId < mesh.pts.size(); ++vertexId)
+        mesh.pointsVisibilities[vertexId].clear();
+
+    std::vector<int> maskedCamIds;
+    for(int camId = 0; camId < mp.getNbCameras(); ++camId)
+    {
+        if(masks.hasMask(camId))
+            maskedCamIds.push_back(camId);
+    }
+
+    std::vector<int> sortedVertices;
+    getMortonSortedPoints(mesh.pts, sortedVertices);
+
+    const int nbBlocks = (static_cast<int>(sortedVertices.size()) + verticesBlockSize - 1) / verticesBlockSize;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int block = 0; block < nbBlocks; ++block)
+    {
+        const int begin = block * verticesBlockSize;
+        const int end = std::min(begin + verticesBlockSize, static_cast<int>(sortedVertices.size()));
+
+        Point3d bmin = mesh.pts[sortedVertices[begin]];
+        Point3d bmax = bmin;
+        for(int i = begin + 1; i < end; ++i)
+        {
+            const Point3d& p = mesh.pts[sortedVertices[i]];
+            bmin = Point3d(std::min(bmin.x, p.x), std::min(bmin.y, p.y), std::min(bmin.z, p.z));
+            bmax = Point3d(std::max(bmax.x, p.x), std::max(bmax.y, p.y), std::max(bmax.z, p.z));
+        }
+
+        // cameras in increasing order, so the points visibilities are sorted
+        for(const int camId : maskedCamIds)
+        {
+            if(isBoxOutsideCamera(mp, camId, bmin, bmax))
+                continue;
+
+            for(int i = begin; i < end; ++i)
+            {
+                const int vertexId = sortedVertices[i];
+                if(!isVisibleOutOfMask(mp, masks, camId, mesh.pts[vertexId]))
+                    continue;
+                mesh.pointsVisibilities[vertexId].push_back(camId);
+                ++out_vertexVisibilityCounters[vertexId];
+            }
+        }
+    }
+}
+
+void smoothenMaskBoundary(Mesh& mesh, const StaticVector<int>& vertexVisibilityCounters,
+                          const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks, int threshold)
+{
+    const auto isVertexVisible = [&vertexVisibilityCounters, threshold](const int vertexId)
+    {
+        return vertexVisibilityCounters[vertexId] >= threshold;
+    };
+
+    // select the edge of each hidden vertex of the boundary triangles, in the triangles order:
+    // the visible vertices do not move and each hidden vertex is moved once, so the searches are independent
+    std::vector<std::pair<int, int>> hiddenVisibleVertexIds;
+    std::vector<bool> isMoved(mesh.pts.size(), false);
+    for (int triangleId = 0; triangleId < mesh.tris.size(); ++triangleId)
+    {
+        const auto& triangle = mesh.tris[triangleId];
+        const auto visibleCount = std::count_if(std::begin(triangle.v), std::end(triangle.v), isVertexVisible);
+        if (visibleCount == 3)
+        {
+            // do nothing
+        }
+        else if (visibleCount == 2)
+        {
+            // 2 out of 3 are visible: we need to move the 3rd vertex o the border.
+            // we move it toward the farthest visible vertex so the triangle has little chance to be degenerate.
+            const auto hiddenIdx = std::find_if_not(std::begin(triangle.v), std::end(triangle.v), isVertexVisible) - std::begin(triangle.v);
+            const auto hiddenVertexId = triangle.v[hiddenIdx];
+            if (isMoved[hiddenVertexId])
+                continue;
+
+            // move along the longest edge to avoid degenerate triangles
+            const auto visibleVertexId = [&]
+            {
+                const auto visibleVertexId1 = triangle.v[(hiddenIdx + 1) % 3];
+                const double length1 = (mesh.pts[visibleVertexId1] - mesh.pts[hiddenVertexId]).size();
+
+                const auto visibleVertexId2 = triangle.v[(hiddenIdx + 2) % 3];
+                const double length2 = (mesh.pts[visibleVertexId2] - mesh.pts[hiddenVertexId]).size();
+
+                return length1 > length2 ? visibleVertexId1 : visibleVertexId2;
+            }();
+
+            hiddenVisibleVertexIds.emplace_back(hiddenVertexId, visibleVertexId);
+            isMoved[hiddenVertexId] = true;
+        }
+        else if (visibleCount == 1)
+        {
+            // only 1 vertex is visible: we move the other 2 in its direction.
+            const auto visibleIdx = std::find_if(std::begin(triangle.v), std::end(triangle.v), isVertexVisible) - std::begin(triangle.v);
+            const auto visibleVertexId = triangle.v[visibleIdx];
+            for (int i : {1, 2})
+            {
+                const auto hiddenVertexId = triangle.v[(visibleIdx + i) % 3];
+                if (isMoved[hiddenVertexId])
+                    continue;
+                hiddenVisibleVertexIds.emplace_back(hiddenVertexId, visibleVertexId);
+                isMoved[hiddenVertexId] = true;
+            }
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("A triangle was visible but is not visible anymore.");
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Moving " << hiddenVisibleVertexIds.size() << " boundary vertices.");
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < hiddenVisibleVertexIds.size(); ++i)
+    {
+        const int hiddenVertexId = hiddenVisibleVertexIds[i].first;
+        const int visibleVertexId = hiddenVisibleVertexIds[i].second;
+        mesh.pts[hiddenVertexId] = findBoundaryVertex(mesh, visibleVertexId, hiddenVertexId, mp, masks, threshold);
+    }
+}
+
+void meshMasking(const mvsUtils::MultiViewParams& mp, Mesh& inputMesh, const MaskBitmaskCache& masks,
+                 const MeshMaskingParams& params, Mesh& out_filteredMesh)
+{
+    // compute visibility for every vertex
+    // also update inputMesh.pointsVisibilities according to the masks
+    ALICEVISION_LOG_INFO("Compute vertex visibilities");
+    StaticVector<int> vertexVisibilityCounters;
+    computeVerticesMaskVisibilities(mp, masks, params.usePointsVisibilities, inputMesh, vertexVisibilityCounters);
+
+    // filter masked vertex (remove adjacent triangles)
+    ALICEVISION_LOG_INFO("Filter triangles");
+    StaticVector<int> inputPtIdToFilteredPtId;
+    {
+        const auto isVertexVisible = [&vertexVisibilityCounters, &params] (const int vertexId)
+        {
+            return vertexVisibilityCounters[vertexId] >= params.threshold;
+        };
+
+        StaticVector<int> visibleTriangles;
+        visibleTriangles.reserve(inputMesh.tris.size() / 2);  // arbitrary size initial buffer
+        for (int triangleId = 0; triangleId < inputMesh.tris.size(); ++triangleId)
+        {
+            const auto& triangle = inputMesh.tris[triangleId];
+            const bool visible = params.smoothBoundary ?
+                std::any_of(std::begin(triangle.v), std::end(triangle.v), isVertexVisible) :
+                std::all_of(std::begin(triangle.v), std::end(triangle.v), isVertexVisible);
+            if (visible)
+            {
+                visibleTriangles.push_back(triangleId);
+            }
+        }
+
+        inputMesh.generateMeshFromTrianglesSubset(visibleTriangles, out_filteredMesh, inputPtIdToFilteredPtId);
+    }
+
+    if (params.smoothBoundary)
+    {
+        ALICEVISION_LOG_INFO("Smoothen boundary triangles");
+        // build visibility counters + cameraId/point visibilities for the filtered mesh
+        StaticVector<int> filteredVertexVisibilityCounters;
+        filteredVertexVisibilityCounters.resize_with(out_filteredMesh.pts.size(), 0);
+        out_filteredMesh.pointsVisibilities.resize(out_filteredMesh.pts.size());
+
+        #pragma omp parallel for
+        for (int inputPtId = 0; inputPtId < inputMesh.pts.size(); ++inputPtId)
+        {
+            const int filteredPtId = inputPtIdToFilteredPtId[inputPtId];
+            if (filteredPtId >= 0)
+            {
+                filteredVertexVisibilityCounters[filteredPtId] = vertexVisibilityCounters[inputPtId];
+
+                // fill visibilities and ensure they are sorted (we rely on it in findBoundaryVertex)
+                auto& pointVisibilities = out_filteredMesh.pointsVisibilities[filteredPtId];
+                pointVisibilities = inputMesh.pointsVisibilities[inputPtId];
+                if (!std::is_sorted(pointVisibilities.begin(), pointVisibilities.end()))
+                {
+                    std::sort(pointVisibilities.begin(), pointVisibilities.end());
+                }
+            }
+        }
+
+        smoothenMaskBoundary(out_filteredMesh, filteredVertexVisibilityCounters, mp, masks, params.threshold);
+    }
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,124 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/StaticVector.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+
+namespace mvsUtils {
+class MultiViewParams;
+} // namespace mvsUtils
+
+namespace mesh {
+
+class Mesh;
+
+struct MeshMaskingParams
+{
+    int threshold = 1;                  //< minimum number of cameras seeing a vertex out of the masks to keep it
+    bool smoothBoundary = false;        //< move the boundary vertices along the edges to fit the masks
+    bool usePointsVisibilities = false; //< only test the cameras of the mesh points visibilities
+};
+
+/**
+ * @class MaskBitmaskCache
+ * @brief Masks of all the cameras, loaded once and stored with one bit per pixel.
+ *
+ * A set bit means the pixel is visible (not masked), the inversion is applied at loading.
+ * Missing masks and masks with a size different from their camera are ignored.
+ */
+class MaskBitmaskCache
+{
+public:
+    /**
+     * @brief Load the masks of all the cameras concurrently.
+     * @param[in] mp the multi-view parameters
+     * @param[in] masksFolders the folders containing the masks (named by view id or image name)
+     * @param[in] maskExtension the masks file extension
+     * @param[in] undistortMasks undistort the masks with the camera intrinsics
+     * @param[in] invert invert the masks
+     */
+    MaskBitmaskCache(const mvsUtils::MultiViewParams& mp, const std::vector<std::string>& masksFolders,
+                     const std::string& maskExtension, bool undistortMasks, bool invert);
+
+    bool hasMask(int camId) const { return !_masks[camId].bits.empty(); }
+
+    int getNbMasks() const;
+
+    std::size_t getMemorySize() const;
+
+    /**
+     * @brief Whether the pixel is visible (not masked).
+     * @note the camera should have a mask and the pixel should be in the image
+     */
+    bool isVisible(int camId, int x, int y) const
+    {
+        const Bitmask& mask = _masks[camId];
+        const std::size_t bit = std::size_t(y) * mask.width + x;
+        return (mask.bits[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+private:
+    struct Bitmask
+    {
+        int width = 0;
+        std::vector<std::uint64_t> bits;
+    };
+
+    std::vector<Bitmask> _masks;
+};
+
+/**
+ * @brief Count for each vertex the cameras seeing it out of the masks.
+ *
+ * Vertices are processed by spatially coherent blocks: the cameras whose frustum does not intersect
+ * the block bounding box are skipped, the block vertices are projected in the other cameras.
+ *
+ * @param[in] mp the multi-view parameters
+ * @param[in] masks the cameras masks
+ * @param[in] usePointsVisibilities only test the cameras of the mesh points visibilities
+ * @param[in,out] mesh the mesh, its points visibilities are filtered by the masks (usePointsVisibilities)
+ *                or filled with the cameras seeing the vertices out of the masks
+ * @param[out] out_vertexVisibilityCounters per vertex, the number of cameras seeing it out of the masks
+ */
+void computeVerticesMaskVisibilities(const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks,
+                                     bool usePointsVisibilities, Mesh& mesh,
+                                     StaticVector<int>& out_vertexVisibilityCounters);
+
+/**
+ * @brief Move the hidden vertices of the boundary triangles along their edges to the masks boundary.
+ *
+ * The edge to search is selected for each hidden vertex in the triangles order, then the binary searches
+ * along the edges are done in parallel.
+ *
+ * @param[in,out] mesh the filtered mesh, with sorted points visibilities
+ * @param[in] vertexVisibilityCounters per vertex, the number of cameras seeing it out of the masks
+ * @param[in] mp the multi-view parameters
+ * @param[in] masks the cameras masks
+ * @param[in] threshold minimum number of visibilities of a visible vertex
+ */
+void smoothenMaskBoundary(Mesh& mesh, const StaticVector<int>& vertexVisibilityCounters,
+                          const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks, int threshold);
+
+/**
+ * @brief Remove the parts of the mesh hidden by the masks.
+ * @param[in] mp the multi-view parameters
+ * @param[in,out] inputMesh the input mesh, its points visibilities are updated according to the masks
+ * @param[in] masks the cameras masks
+ * @param[in] params the masking parameters
+ * @param[out] out_filteredMesh the masked mesh
+ */
+void meshMasking(const mvsUtils::MultiViewParams& mp, Mesh& inputMesh, const MaskBitmaskCache& masks,
+                 const MeshMaskingParams& params, Mesh& out_filteredMesh);
+
+} // namespace mesh
+} // namespace aliceVision
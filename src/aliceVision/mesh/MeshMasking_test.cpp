@@ -0,0 +1,295 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshMasking.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/image/all.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshMasking
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Synthetic scene: cameras translated along the X axis looking towards +Z, the pixel size is 0.1 at depth 10.
+
+const int imageWidth = 200;
+const int imageHeight = 150;
+const double focal = 100.0;
+
+/**
+ * @brief Temporary folder with the masks of the cameras, removed at the end of the test.
+ */
+struct MasksFolder
+{
+    MasksFolder()
+        : path(fs::temp_directory_path() / fs::unique_path("meshMasking_test_%%%%%%%%"))
+    {
+        fs::create_directories(path);
+    }
+    ~MasksFolder() { fs::remove_all(path); }
+
+    /// Write the mask of the view, pixels with a true predicate are visible
+    image::Image<unsigned char> write(IndexT viewId, int width, int height, const std::function<bool(int, int)>& isVisible) const
+    {
+        image::Image<unsigned char> mask(width, height, true, 0);
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+                mask(y, x) = isVisible(x, y) ? 255 : 0;
+        }
+        image::writeImage((path / (std::to_string(viewId) + ".png")).string(), mask, image::ImageWriteOptions());
+        return mask;
+    }
+
+    fs::path path;
+};
+
+sfmData::SfMData createCameras(const std::vector<double>& camerasX)
+{
+    sfmData::SfMData sfmData;
+    sfmData.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(imageWidth, imageHeight, focal, focal, 0.0, 0.0));
+    for(IndexT viewId = 0; viewId < camerasX.size(); ++viewId)
+    {
+        sfmData.getViews().emplace(viewId, std::make_shared<sfmData::View>("", viewId, 0, viewId, imageWidth, imageHeight));
+        sfmData.setPose(sfmData.getView(viewId), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(camerasX[viewId], 0.0, 0.0))));
+    }
+    return sfmData;
+}
+
+/**
+ * @brief Add a grid of nx x ny vertices on the plane z.
+ */
+void addGridPlane(Mesh& mesh, double x0, double x1, double y0, double y1, double z, int nx, int ny)
+{
+    const int first = mesh.pts.size();
+    for(int j = 0; j < ny; ++j)
+    {
+        for(int i = 0; i < nx; ++i)
+            mesh.pts.push_back(Point3d(x0 + (x1 - x0) * i / (nx - 1), y0 + (y1 - y0) * j / (ny - 1), z));
+    }
+    for(int j = 0; j < ny - 1; ++j)
+    {
+        for(int i = 0; i < nx - 1; ++i)
+        {
+            const int v = first + j * nx + i;
+            mesh.tris.push_back(Mesh::triangle(v, v + nx + 1, v + 1));
+            mesh.tris.push_back(Mesh::triangle(v, v + nx, v + nx + 1));
+        }
+    }
+}
+
+/**
+ * @brief Cameras seeing the vertex out of the masks, by projecting it in every camera.
+ */
+std::vector<int> getVisibilitiesBruteForce(const mvsUtils::MultiViewParams& mp, const MaskBitmaskCache& masks,
+                                           const Point3d& point, const std::vector<int>& camIds)
+{
+    std::vector<int> visibilities;
+    for(const int camId : camIds)
+    {
+        if(!masks.hasMask(camId))
+            continue;
+        Pixel pixel;
+        mp.getPixelFor3DPoint(&pixel, point, camId);
+        if(pixel.x < 0 || pixel.x >= mp.getWidth(camId) || pixel.y < 0 || pixel.y >= mp.getHeight(camId))
+            continue;
+        if(masks.isVisible(camId, pixel.x, pixel.y))
+            visibilities.push_back(camId);
+    }
+    return visibilities;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshMasking_bitmaskCache)
+{
+    const MasksFolder folder;
+    const sfmData::SfMData sfmData = createCameras({0.0, 1.0, 2.0, 3.0});
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.path.string(), folder.path.string(), false);
+
+    // camera 2 has no mask, the mask of camera 3 does not have the camera size
+    std::vector<image::Image<unsigned char>> maskImages;
+    for(IndexT viewId = 0; viewId < 2; ++viewId)
+        maskImages.push_back(folder.write(viewId, imageWidth, imageHeight, [viewId](int x, int y) { return (x / 5 + y / 7 + viewId) % 3 != 0; }));
+    folder.write(3, imageWidth / 2, imageHeight, [](int, int) { return true; });
+
+    for(const bool invert : {false, true})
+    {
+        const MaskBitmaskCache masks(mp, {folder.path.string()}, ".png", false, invert);
+        BOOST_CHECK_EQUAL(masks.getNbMasks(), 2);
+        BOOST_CHECK_GT(masks.getMemorySize(), 0);
+
+        for(int camId = 0; camId < mp.getNbCameras(); ++camId)
+        {
+            const IndexT viewId = mp.getViewId(camId);
+            BOOST_REQUIRE_EQUAL(masks.hasMask(camId), viewId < 2);
+            if(!masks.hasMask(camId))
+                continue;
+
+            int nbErrors = 0;
+            for(int y = 0; y < imageHeight; ++y)
+            {
+                for(int x = 0; x < imageWidth; ++x)
+                    nbErrors += masks.isVisible(camId, x, y) != ((maskImages[viewId](y, x) != 0) != invert);
+            }
+            BOOST_CHECK_EQUAL(nbErrors, 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshMasking_verticesVisibilities)
+{
+    const MasksFolder folder;
+    const sfmData::SfMData sfmData = createCameras({-2.0, -0.5, 0.0, 1.0, 2.5});
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.path.string(), folder.path.string(), false);
+
+    // the last view has no mask
+    for(IndexT viewId = 0; viewId < 4; ++viewId)
+        folder.write(viewId, imageWidth, imageHeight, [viewId](int x, int y) { return (x / 9 + y / 4 + viewId) % 4 != 0; });
+    const MaskBitmaskCache masks(mp, {folder.path.string()}, ".png", false, false);
+
+    std::vector<int> camIds(mp.getNbCameras());
+    for(int camId = 0; camId < mp.getNbCameras(); ++camId)
+        camIds[camId] = camId;
+
+    // a plane larger than the cameras frustums and points around and behind the cameras, in many blocks
+    Mesh mesh;
+    addGridPlane(mesh, -30.0, 30.0, -20.0, 20.0, 10.0, 61, 41);
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> xyDistribution(-30.0, 30.0);
+    std::uniform_real_distribution<double> zDistribution(-10.0, 30.0);
+    for(int i = 0; i < 3000; ++i)
+        mesh.pts.push_back(Point3d(xyDistribution(generator), xyDistribution(generator), zDistribution(generator)));
+
+    // visibilities from the block culling and the brute force projection of every vertex
+    {
+        StaticVector<int> counters;
+        computeVerticesMaskVisibilities(mp, masks, false, mesh, counters);
+        BOOST_REQUIRE_EQUAL(counters.size(), mesh.pts.size());
+        BOOST_REQUIRE_EQUAL(mesh.pointsVisibilities.size(), mesh.pts.size());
+
+        int nbVisible = 0;
+        int nbHidden = 0;
+        for(int vertexId = 0; vertexId < mesh.pts.size(); ++vertexId)
+        {
+            const std::vector<int> expected = getVisibilitiesBruteForce(mp, masks, mesh.pts[vertexId], camIds);
+            BOOST_CHECK_MESSAGE(mesh.pointsVisibilities[vertexId].getData() == expected, "vertex " << vertexId);
+            BOOST_CHECK_EQUAL(counters[vertexId], expected.size());
+            (expected.empty() ? nbHidden : nbVisible) += 1;
+        }
+        BOOST_CHECK_GT(nbVisible, mesh.pts.size() / 10);
+        BOOST_CHECK_GT(nbHidden, mesh.pts.size() / 10);
+    }
+
+    // input visibilities: only the input cameras seeing the vertex out of the masks are kept
+    {
+        std::vector<std::vector<int>> inputVisibilities(mesh.pts.size());
+        for(int vertexId = 0; vertexId < mesh.pts.size(); ++vertexId)
+        {
+            auto& pointVisibilities = mesh.pointsVisibilities[vertexId];
+            pointVisibilities.clear();
+            for(const int camId : camIds)
+            {
+                if((vertexId + camId) % 3 != 0)
+                {
+                    pointVisibilities.push_back(camId);
+                    inputVisibilities[vertexId].push_back(camId);
+                }
+            }
+        }
+
+        StaticVector<int> counters;
+        computeVerticesMaskVisibilities(mp, masks, true, mesh, counters);
+        BOOST_REQUIRE_EQUAL(counters.size(), mesh.pts.size());
+        for(int vertexId = 0; vertexId < mesh.pts.size(); ++vertexId)
+        {
+            const std::vector<int> expected = getVisibilitiesBruteForce(mp, masks, mesh.pts[vertexId], inputVisibilities[vertexId]);
+            BOOST_CHECK_MESSAGE(mesh.pointsVisibilities[vertexId].getData() == expected, "vertex " << vertexId);
+            BOOST_CHECK_EQUAL(counters[vertexId], expected.size());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(meshMasking_smoothBoundary)
+{
+    const MasksFolder folder;
+    const std::vector<double> camerasX = {0.0, 0.5, 1.0};
+    const sfmData::SfMData sfmData = createCameras(camerasX);
+    const mvsUtils::MultiViewParams mp(sfmData, "", folder.path.string(), folder.path.string(), false);
+
+    // the masks hide the same half-plane x > boundaryX at depth 10 in all the cameras
+    const double pixelSize = 10.0 / focal;
+    const int boundaryPixel = 112;
+    const double boundaryX = (boundaryPixel - 0.5 - imageWidth * 0.5) * pixelSize;
+    for(IndexT viewId = 0; viewId < camerasX.size(); ++viewId)
+    {
+        const int cameraBoundaryPixel = boundaryPixel - static_cast<int>(std::round(camerasX[viewId] / pixelSize));
+        folder.write(viewId, imageWidth, imageHeight, [cameraBoundaryPixel](int x, int) { return x < cameraBoundaryPixel; });
+    }
+    const MaskBitmaskCache masks(mp, {folder.path.string()}, ".png", false, false);
+
+    // the grid vertices are not on the boundary
+    Mesh inputMesh;
+    addGridPlane(inputMesh, -3.0, 3.0, -2.0, 2.0, 10.0, 25, 17);
+    const Mesh refMesh = inputMesh;
+
+    MeshMaskingParams params;
+    params.threshold = 2;
+
+    // without smoothing, the triangles with a hidden vertex are removed
+    {
+        Mesh mesh = refMesh;
+        Mesh filteredMesh;
+        meshMasking(mp, mesh, masks, params, filteredMesh);
+        BOOST_REQUIRE_GT(filteredMesh.tris.size(), 0);
+        BOOST_REQUIRE_LT(filteredMesh.tris.size(), refMesh.tris.size());
+        for(int i = 0; i < filteredMesh.pts.size(); ++i)
+            BOOST_CHECK_LT(filteredMesh.pts[i].x, boundaryX);
+    }
+
+    // with smoothing, the boundary triangles are kept and their hidden vertices moved on the masks boundary
+    params.smoothBoundary = true;
+    Mesh filteredMesh;
+    meshMasking(mp, inputMesh, masks, params, filteredMesh);
+    BOOST_REQUIRE_GT(filteredMesh.tris.size(), 0);
+
+    int nbMoved = 0;
+    for(int i = 0; i < filteredMesh.pts.size(); ++i)
+    {
+        const Point3d& p = filteredMesh.pts[i];
+        BOOST_CHECK_CLOSE(p.z, 10.0, 1e-6);
+        BOOST_CHECK_LT(p.x, boundaryX + pixelSize);
+
+        // the vertex is either an unchanged visible vertex or a moved hidden one, close to the boundary
+        bool isInputVertex = false;
+        for(int j = 0; j < refMesh.pts.size() && !isInputVertex; ++j)
+            isInputVertex = (refMesh.pts[j] - p).size() < 1e-9 && refMesh.pts[j].x < boundaryX;
+        if(!isInputVertex)
+        {
+            BOOST_CHECK_SMALL(p.x - boundaryX, 1.5 * pixelSize);
+            ++nbMoved;
+        }
+    }
+    // one column of hidden vertices is moved
+    BOOST_CHECK_EQUAL(nbMoved, 17);
+}
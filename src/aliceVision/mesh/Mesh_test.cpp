@@ -0,0 +1,379 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE mesh
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/**
+ * @brief Regular grid of n x n vertices on the plane z=0, 2 triangles per cell.
+ */
+Mesh createGrid(int n)
+{
+    Mesh mesh;
+    for(int y = 0; y < n; ++y)
+    {
+        for(int x = 0; x < n; ++x)
+            mesh.pts.push_back(Point3d(x, y, 0.0));
+    }
+    for(int y = 0; y < n - 1; ++y)
+    {
+        for(int x = 0; x < n - 1; ++x)
+        {
+            const int v = y * n + x;
+            mesh.tris.push_back(Mesh::triangle(v, v + 1, v + n + 1));
+            mesh.tris.push_back(Mesh::triangle(v, v + n + 1, v + n));
+        }
+    }
+    return mesh;
+}
+
+/**
+ * @brief Closed octahedron.
+ */
+Mesh createOctahedron()
+{
+    Mesh mesh;
+    mesh.pts.push_back(Point3d(1.0, 0.0, 0.0));
+    mesh.pts.push_back(Point3d(0.0, 1.0, 0.0));
+    mesh.pts.push_back(Point3d(-1.0, 0.0, 0.0));
+    mesh.pts.push_back(Point3d(0.0, -1.0, 0.0));
+    mesh.pts.push_back(Point3d(0.0, 0.0, 1.0));
+    mesh.pts.push_back(Point3d(0.0, 0.0, -1.0));
+    for(int i = 0; i < 4; ++i)
+    {
+        mesh.tris.push_back(Mesh::triangle(i, (i + 1) % 4, 4));
+        mesh.tris.push_back(Mesh::triangle((i + 1) % 4, i, 5));
+    }
+    return mesh;
+}
+
+bool triangleHasPt(const Mesh::triangle& t, int ptId)
+{
+    return t.v[0] == ptId || t.v[1] == ptId || t.v[2] == ptId;
+}
+
+/**
+ * @brief Flip the diagonal of a cell of the grid, keeps the mesh manifold
+ *        with the same number of points and triangles.
+ */
+void flipGridCellDiagonal(Mesh& mesh, int n, int x, int y)
+{
+    const int v = y * n + x;
+    const int triId = 2 * (y * (n - 1) + x);
+    mesh.changeTriPtId(triId, v + n + 1, v + n);
+    mesh.changeTriPtId(triId + 1, v, v + 1);
+}
+
+/**
+ * @brief Check the cached adjacencies against a brute force computation.
+ */
+void checkTopology(const Mesh& mesh)
+{
+    const Mesh::Adjacency& ptsNeighTris = mesh.getPtsNeighTrisAdjacency();
+    const Mesh::Adjacency& ptsNeighPts = mesh.getPtsNeighPtsOrderedAdjacency();
+
+    BOOST_REQUIRE_EQUAL(ptsNeighTris.nbElements(), mesh.pts.size());
+    BOOST_REQUIRE_EQUAL(ptsNeighPts.nbElements(), mesh.pts.size());
+
+    for(int ptId = 0; ptId < mesh.pts.size(); ++ptId)
+    {
+        std::vector<int> expectedTris;
+        std::set<int> expectedPts;
+        for(int triId = 0; triId < mesh.tris.size(); ++triId)
+        {
+            const Mesh::triangle& t = mesh.tris[triId];
+            if(!triangleHasPt(t, ptId))
+                continue;
+            expectedTris.push_back(triId);
+            for(int k = 0; k < 3; ++k)
+            {
+                if(t.v[k] != ptId)
+                    expectedPts.insert(t.v[k]);
+            }
+        }
+
+        // triangles sorted by ascending index
+        const std::vector<int> neighTris(ptsNeighTris.begin(ptId), ptsNeighTris.end(ptId));
+        BOOST_CHECK(neighTris == expectedTris);
+
+        // each neighbor vertex listed once
+        const std::vector<int> neighPts(ptsNeighPts.begin(ptId), ptsNeighPts.end(ptId));
+        BOOST_CHECK(std::set<int>(neighPts.begin(), neighPts.end()) == expectedPts);
+        BOOST_CHECK_EQUAL(neighPts.size(), expectedPts.size());
+
+        // consecutive neighbors share a triangle with the vertex
+        const auto shareTriangle = [&](int a, int b) {
+            return std::any_of(expectedTris.begin(), expectedTris.end(), [&](int triId) {
+                return triangleHasPt(mesh.tris[triId], a) && triangleHasPt(mesh.tris[triId], b);
+            });
+        };
+        for(std::size_t i = 0; i + 1 < neighPts.size(); ++i)
+            BOOST_CHECK_MESSAGE(shareTriangle(neighPts[i], neighPts[i + 1]), "vertex " << ptId << ", neighbors " << neighPts[i] << " " << neighPts[i + 1]);
+
+        // closed fans loop, open fans start and end on the border
+        const bool isClosedFan = (neighPts.size() == expectedTris.size());
+        if(neighPts.size() > 2)
+            BOOST_CHECK_EQUAL(shareTriangle(neighPts.front(), neighPts.back()), isClosedFan);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(mesh_topology_grid)
+{
+    checkTopology(createGrid(5));
+}
+
+BOOST_AUTO_TEST_CASE(mesh_topology_closed)
+{
+    checkTopology(createOctahedron());
+}
+
+BOOST_AUTO_TEST_CASE(mesh_topology_invalidation)
+{
+    const int n = 4;
+    Mesh mesh = createGrid(n);
+    checkTopology(mesh);
+
+    // same number of points and triangles, other topology
+    flipGridCellDiagonal(mesh, n, 0, 0);
+    BOOST_CHECK(!triangleHasPt(mesh.tris[0], n + 1));
+    checkTopology(mesh);
+
+    mesh.invertTriangleOrientations();
+    checkTopology(mesh);
+
+    // direct edit followed by an explicit invalidation
+    const int v = 1;
+    mesh.tris[2] = Mesh::triangle(v, v + n, v + 1);
+    mesh.tris[3] = Mesh::triangle(v + 1, v + n, v + n + 1);
+    mesh.invalidateTopology();
+    checkTopology(mesh);
+
+    // keep the first 2 rows of cells
+    StaticVector<int> trisIdsToStay;
+    for(int i = 0; i < 4 * (n - 1); ++i)
+        trisIdsToStay.push_back(i);
+    mesh.letJustTringlesIdsInMesh(trisIdsToStay);
+    checkTopology(mesh);
+    BOOST_CHECK_EQUAL(mesh.getPtsNeighTrisAdjacency().size(n * n - 1), 0);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_topology_copy)
+{
+    const int n = 4;
+    Mesh mesh = createGrid(n);
+    const Mesh::Adjacency* ptsNeighTris = &mesh.getPtsNeighTrisAdjacency();
+
+    // copies share the cached topology until one of them changes
+    Mesh meshCopy = mesh;
+    BOOST_CHECK_EQUAL(&meshCopy.getPtsNeighTrisAdjacency(), ptsNeighTris);
+
+    meshCopy.invertTriangleOrientations();
+    flipGridCellDiagonal(meshCopy, n, 1, 2);
+    checkTopology(meshCopy);
+
+    BOOST_CHECK_EQUAL(&mesh.getPtsNeighTrisAdjacency(), ptsNeighTris);
+    checkTopology(mesh);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_topology_move)
+{
+    Mesh mesh = createGrid(4);
+    const Mesh::Adjacency* ptsNeighTris = &mesh.getPtsNeighTrisAdjacency();
+
+    // the moved mesh keeps its cached topology, the moved-from one is left without it
+    Mesh movedMesh = std::move(mesh);
+    BOOST_CHECK_EQUAL(&movedMesh.getPtsNeighTrisAdjacency(), ptsNeighTris);
+    checkTopology(movedMesh);
+
+    mesh = createOctahedron();
+    checkTopology(mesh);
+
+    mesh = std::move(movedMesh);
+    BOOST_CHECK_EQUAL(&mesh.getPtsNeighTrisAdjacency(), ptsNeighTris);
+    BOOST_CHECK(movedMesh.pts.empty());
+    checkTopology(movedMesh);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_topology_concurrentAccess)
+{
+    const Mesh mesh = createGrid(64);
+
+    const int nbRequests = 32;
+    std::vector<const Mesh::Adjacency*> ptsNeighTris(nbRequests, nullptr);
+    std::vector<const Mesh::Adjacency*> ptsNeighPts(nbRequests, nullptr);
+
+    // the first calls build the cache once, the other ones wait for it
+    #pragma omp parallel for
+    for(int i = 0; i < nbRequests; ++i)
+    {
+        if(i % 2)
+            ptsNeighPts[i] = &mesh.getPtsNeighPtsOrderedAdjacency();
+        ptsNeighTris[i] = &mesh.getPtsNeighTrisAdjacency();
+    }
+
+    for(int i = 0; i < nbRequests; ++i)
+    {
+        BOOST_CHECK_EQUAL(ptsNeighTris[i], ptsNeighTris[0]);
+        if(i % 2)
+            BOOST_CHECK_EQUAL(ptsNeighPts[i], ptsNeighPts[1]);
+    }
+    checkTopology(mesh);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_letJustTrianglesIds)
+{
+    const int n = 4;
+    Mesh mesh = createGrid(n);
+    const int nbTris = mesh.tris.size();
+
+    // per-triangle attributes identifying the triangle, the UV coordinates and normals are only referenced
+    for(int triId = 0; triId < nbTris; ++triId)
+    {
+        mesh.trisMtlIds().push_back(triId % 3);
+        mesh.trisUvIds.push_back(Voxel(3 * triId, 3 * triId + 1, 3 * triId + 2));
+        mesh.trisNormalsIds.push_back(Voxel(triId, triId + nbTris, triId + 2 * nbTris));
+        for(int k = 0; k < 3; ++k)
+            mesh.uvCoords.push_back(Point2d(triId, k));
+        mesh.normals.push_back(Point3d(0.0, 0.0, 1.0));
+    }
+    const Mesh initialMesh = mesh;
+    checkTopology(mesh);
+
+    // drop the first and last triangles and one out of three in between
+    StaticVectorBool trisToStay;
+    trisToStay.resize(nbTris);
+    std::vector<int> keptTriIds;
+    for(int triId = 0; triId < nbTris; ++triId)
+    {
+        trisToStay[triId] = (triId != 0) && (triId != nbTris - 1) && (triId % 3 != 1);
+        if(trisToStay[triId])
+            keptTriIds.push_back(triId);
+    }
+    mesh.letJustTringlesIdsInMesh(trisToStay);
+
+    BOOST_REQUIRE_EQUAL(mesh.tris.size(), keptTriIds.size());
+    BOOST_REQUIRE_EQUAL(mesh.trisMtlIds().size(), keptTriIds.size());
+    BOOST_REQUIRE_EQUAL(mesh.trisUvIds.size(), keptTriIds.size());
+    BOOST_REQUIRE_EQUAL(mesh.trisNormalsIds.size(), keptTriIds.size());
+    for(int triId = 0; triId < keptTriIds.size(); ++triId)
+    {
+        const int oldTriId = keptTriIds[triId];
+        for(int k = 0; k < 3; ++k)
+            BOOST_CHECK_EQUAL(mesh.tris[triId].v[k], initialMesh.tris[oldTriId].v[k]);
+        BOOST_CHECK_EQUAL(mesh.trisMtlIds()[triId], initialMesh.trisMtlIds()[oldTriId]);
+        BOOST_CHECK(mesh.trisUvIds[triId] == initialMesh.trisUvIds[oldTriId]);
+        BOOST_CHECK(mesh.trisNormalsIds[triId] == initialMesh.trisNormalsIds[oldTriId]);
+    }
+
+    // the points, UV coordinates and normals are kept
+    BOOST_CHECK_EQUAL(mesh.pts.size(), initialMesh.pts.size());
+    BOOST_CHECK_EQUAL(mesh.uvCoords.size(), initialMesh.uvCoords.size());
+    BOOST_CHECK_EQUAL(mesh.normals.size(), initialMesh.normals.size());
+    checkTopology(mesh);
+
+    // missing attributes stay empty
+    Mesh meshWithoutAttributes = createGrid(n);
+    meshWithoutAttributes.letJustTringlesIdsInMesh(trisToStay);
+    BOOST_CHECK_EQUAL(meshWithoutAttributes.tris.size(), keptTriIds.size());
+    BOOST_CHECK(meshWithoutAttributes.trisMtlIds().empty());
+    BOOST_CHECK(meshWithoutAttributes.trisUvIds.empty());
+    BOOST_CHECK(meshWithoutAttributes.trisNormalsIds.empty());
+}
+
+BOOST_AUTO_TEST_CASE(mesh_removeFreePoints)
+{
+    const int n = 4;
+    Mesh mesh = createGrid(n);
+
+    // free the first corner (used by the first 2 triangles only) and add free points at the end
+    StaticVectorBool trisToStay;
+    trisToStay.resize(mesh.tris.size());
+    for(int triId = 0; triId < mesh.tris.size(); ++triId)
+        trisToStay[triId] = (triId > 1);
+    mesh.letJustTringlesIdsInMesh(trisToStay);
+    mesh.pts.push_back(Point3d(-1.0, -1.0, 0.0));
+    mesh.pts.push_back(Point3d(-2.0, -1.0, 0.0));
+
+    // per-vertex attributes identifying the vertex
+    for(int ptId = 0; ptId < mesh.pts.size(); ++ptId)
+    {
+        mesh.colors().push_back(rgb(ptId, 2 * ptId, 3 * ptId));
+        PointVisibility visibility;
+        visibility.push_back(ptId);
+        visibility.push_back(ptId + 100);
+        mesh.pointsVisibilities.push_back(visibility);
+    }
+    const Mesh initialMesh = mesh;
+
+    // expected new index of each point: its rank among the used points
+    std::vector<char> isUsed(initialMesh.pts.size(), 0);
+    for(int triId = 0; triId < initialMesh.tris.size(); ++triId)
+    {
+        for(int k = 0; k < 3; ++k)
+            isUsed[initialMesh.tris[triId].v[k]] = 1;
+    }
+    std::vector<int> expectedPtIdToNewPtId(initialMesh.pts.size(), -1);
+    int nbUsedPts = 0;
+    for(int ptId = 0; ptId < initialMesh.pts.size(); ++ptId)
+    {
+        if(isUsed[ptId])
+            expectedPtIdToNewPtId[ptId] = nbUsedPts++;
+    }
+    BOOST_REQUIRE_EQUAL(nbUsedPts, n * n - 1);
+
+    StaticVector<int> ptIdToNewPtId;
+    mesh.removeFreePointsFromMesh(ptIdToNewPtId);
+
+    BOOST_REQUIRE_EQUAL(ptIdToNewPtId.size(), initialMesh.pts.size());
+    for(int ptId = 0; ptId < initialMesh.pts.size(); ++ptId)
+        BOOST_CHECK_EQUAL(ptIdToNewPtId[ptId], expectedPtIdToNewPtId[ptId]);
+
+    // the points and their attributes are compacted together
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), nbUsedPts);
+    BOOST_REQUIRE_EQUAL(mesh.colors().size(), nbUsedPts);
+    BOOST_REQUIRE_EQUAL(mesh.pointsVisibilities.size(), nbUsedPts);
+    for(int ptId = 0; ptId < initialMesh.pts.size(); ++ptId)
+    {
+        const int newPtId = ptIdToNewPtId[ptId];
+        if(newPtId < 0)
+            continue;
+        BOOST_CHECK(mesh.pts[newPtId] == initialMesh.pts[ptId]);
+        BOOST_CHECK_EQUAL(mesh.colors()[newPtId].r, initialMesh.colors()[ptId].r);
+        BOOST_CHECK_EQUAL(mesh.colors()[newPtId].g, initialMesh.colors()[ptId].g);
+        BOOST_CHECK_EQUAL(mesh.colors()[newPtId].b, initialMesh.colors()[ptId].b);
+        BOOST_REQUIRE_EQUAL(mesh.pointsVisibilities[newPtId].size(), 2);
+        BOOST_CHECK_EQUAL(mesh.pointsVisibilities[newPtId][0], ptId);
+        BOOST_CHECK_EQUAL(mesh.pointsVisibilities[newPtId][1], ptId + 100);
+    }
+
+    // the triangles are remapped on the same positions
+    BOOST_REQUIRE_EQUAL(mesh.tris.size(), initialMesh.tris.size());
+    for(int triId = 0; triId < mesh.tris.size(); ++triId)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            const int oldPtId = initialMesh.tris[triId].v[k];
+            BOOST_CHECK_EQUAL(mesh.tris[triId].v[k], expectedPtIdToNewPtId[oldPtId]);
+            BOOST_CHECK(mesh.pts[mesh.tris[triId].v[k]] == initialMesh.pts[oldPtId]);
+        }
+    }
+    checkTopology(mesh);
+}
@@ -0,0 +1,188 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "SkylinePacker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace mesh {
+
+SkylinePacker::SkylinePacker(int side)
+    : _side(side)
+{
+    _skyline.push_back({0, 0, side});
+}
+
+bool SkylinePacker::insert(int width, int height, Pixel& out_LU)
+{
+    int bestIndex = -1;
+    int bestY = 0;
+    int bestTop = std::numeric_limits<int>::max();
+    for(int i = 0; i < _skyline.size(); ++i)
+    {
+        int y;
+        if(!fits(i, width, height, y))
+            continue;
+        if(y + height < bestTop)
+        {
+            bestIndex = i;
+            bestY = y;
+            bestTop = y + height;
+        }
+    }
+    if(bestIndex < 0)
+        return false;
+
+    out_LU = Pixel(_skyline[bestIndex].x, bestY);
+    addSegment(bestIndex, {out_LU.x, bestTop, width});
+    return true;
+}
+
+bool SkylinePacker::fits(int index, int width, int height, int& out_y) const
+{
+    if(_skyline[index].x + width > _side)
+        return false;
+    int y = 0;
+    for(int i = index, remaining = width; remaining > 0; ++i)
+    {
+        // the segments cover the whole width of the atlas
+        y = std::max(y, _skyline[i].y);
+        if(y + height > _side)
+            return false;
+        remaining -= _skyline[i].width;
+    }
+    out_y = y;
+    return true;
+}
+
+void SkylinePacker::addSegment(int index, const Segment& segment)
+{
+    _skyline.insert(_skyline.begin() + index, segment);
+
+    // shrink or remove the segments covered by the new one
+    const int segmentEnd = segment.x + segment.width;
+    for(int i = index + 1; i < _skyline.size();)
+    {
+        Segment& next = _skyline[i];
+        if(next.x >= segmentEnd)
+            break;
+        const int shrink = segmentEnd - next.x;
+        if(shrink < next.width)
+        {
+            next.x += shrink;
+            next.width -= shrink;
+            break;
+        }
+        _skyline.erase(_skyline.begin() + i);
+    }
+
+    // merge the neighbor segments at the same height
+    for(int i = 0; i + 1 < _skyline.size();)
+    {
+        if(_skyline[i].y == _skyline[i + 1].y)
+        {
+            _skyline[i].width += _skyline[i + 1].width;
+            _skyline.erase(_skyline.begin() + i + 1);
+        }
+        else
+            ++i;
+    }
+}
+
+std::vector<std::vector<int>> packSkyline(const std::vector<Pixel>& rectSizes, int side, double expectedOccupancy,
+                                          std::vector<Pixel>& out_positions)
+{
+    out_positions.assign(rectSizes.size(), Pixel(-1, -1));
+
+    // sort rectangles by height then width, descending
+    std::vector<int> sortedRectIds(rectSizes.size());
+    std::iota(sortedRectIds.begin(), sortedRectIds.end(), 0);
+    std::sort(sortedRectIds.begin(), sortedRectIds.end(), [&](int a, int b)
+    {
+        if(rectSizes[a].y != rectSizes[b].y)
+            return rectSizes[a].y > rectSizes[b].y;
+        if(rectSizes[a].x != rectSizes[b].x)
+            return rectSizes[a].x > rectSizes[b].x;
+        return a < b;
+    });
+    std::vector<int> rectRanks(rectSizes.size());
+    for(int r = 0; r < sortedRectIds.size(); ++r)
+        rectRanks[sortedRectIds[r]] = r;
+
+    std::vector<SkylinePacker> packers;
+    std::vector<std::vector<int>> atlasesRectIds;
+
+    const auto insertRect = [&](int atlasId, int rectId) -> bool
+    {
+        if(!packers[atlasId].insert(rectSizes[rectId].x, rectSizes[rectId].y, out_positions[rectId]))
+            return false;
+        atlasesRectIds[atlasId].push_back(rectId);
+        return true;
+    };
+
+    std::vector<int> remainingRectIds = sortedRectIds;
+    while(!remainingRectIds.empty())
+    {
+        // the rectangles rejected by the previous round first fill the existing atlases
+        if(!packers.empty())
+        {
+            std::vector<int> rejectedRectIds;
+            for(const int rectId : remainingRectIds)
+            {
+                bool inserted = false;
+                for(int atlasId = 0; atlasId < packers.size() && !inserted; ++atlasId)
+                    inserted = insertRect(atlasId, rectId);
+                if(!inserted)
+                    rejectedRectIds.push_back(rectId);
+            }
+            remainingRectIds.swap(rejectedRectIds);
+            if(remainingRectIds.empty())
+                break;
+        }
+
+        // estimate the number of new atlases from the remaining rectangles area
+        double rectsArea = 0.0;
+        for(const int rectId : remainingRectIds)
+            rectsArea += double(rectSizes[rectId].x) * rectSizes[rectId].y;
+        int nbNewAtlases = static_cast<int>(std::ceil(rectsArea / (double(side) * side * expectedOccupancy)));
+        nbNewAtlases = std::min(std::max(nbNewAtlases, 1), static_cast<int>(remainingRectIds.size()));
+
+        // deal the sorted rectangles to the new atlases so that they get similar sizes, and fill them concurrently
+        const int firstAtlasId = packers.size();
+        packers.resize(firstAtlasId + nbNewAtlases, SkylinePacker(side));
+        atlasesRectIds.resize(firstAtlasId + nbNewAtlases);
+
+        std::vector<std::vector<int>> rejectedRectIds(nbNewAtlases);
+        #pragma omp parallel for schedule(dynamic)
+        for(int n = 0; n < nbNewAtlases; ++n)
+        {
+            for(int i = n; i < remainingRectIds.size(); i += nbNewAtlases)
+            {
+                if(!insertRect(firstAtlasId + n, remainingRectIds[i]))
+                    rejectedRectIds[n].push_back(remainingRectIds[i]);
+            }
+        }
+
+        remainingRectIds.clear();
+        for(int n = 0; n < nbNewAtlases; ++n)
+        {
+            if(atlasesRectIds[firstAtlasId + n].empty())
+                throw std::runtime_error("Unable to add any chart to this atlas");
+            remainingRectIds.insert(remainingRectIds.end(), rejectedRectIds[n].begin(), rejectedRectIds[n].end());
+        }
+        std::sort(remainingRectIds.begin(), remainingRectIds.end(), [&](int a, int b) { return rectRanks[a] < rectRanks[b]; });
+    }
+
+    return atlasesRectIds;
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,69 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Pixel.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @class SkylinePacker
+ * @brief Bottom-left skyline packer: the free space of the atlas is above a list of horizontal segments.
+ * @note Used by UVAtlas for the Skyline chart packing.
+ */
+class SkylinePacker
+{
+public:
+    explicit SkylinePacker(int side);
+
+    /**
+     * @brief Insert a rectangle at the lowest position where it fits.
+     * @param[in] width the rectangle width
+     * @param[in] height the rectangle height
+     * @param[out] out_LU the rectangle left-up corner
+     * @return false if the rectangle does not fit
+     */
+    bool insert(int width, int height, Pixel& out_LU);
+
+private:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    /// Whether the rectangle fits with its left side at the segment start, and the lowest position where it fits
+    bool fits(int index, int width, int height, int& out_y) const;
+
+    void addSegment(int index, const Segment& segment);
+
+    int _side;
+    std::vector<Segment> _skyline;
+};
+
+/**
+ * @brief Pack rectangles in square atlases with skyline packers.
+ *
+ * The rectangles are sorted by height then width. The rectangles rejected by the previous atlases first fill them,
+ * then the remaining ones are dealt to new atlases filled concurrently, their number estimated from the rectangles area.
+ *
+ * @param[in] rectSizes the size of each rectangle (x: width, y: height)
+ * @param[in] side the atlases side
+ * @param[in] expectedOccupancy the expected ratio of an atlas area covered by the rectangles
+ * @param[out] out_positions the left-up corner of each rectangle in its atlas
+ * @return the indexes of the rectangles of each atlas
+ * @throw std::runtime_error if a rectangle does not fit in an empty atlas
+ */
+std::vector<std::vector<int>> packSkyline(const std::vector<Pixel>& rectSizes, int side, double expectedOccupancy,
+                                          std::vector<Pixel>& out_positions);
+
+} // namespace mesh
+} // namespace aliceVision
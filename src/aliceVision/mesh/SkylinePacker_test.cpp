@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/SkylinePacker.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#define BOOST_TEST_MODULE skylinePacker
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+struct Rect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+bool overlap(const Rect& a, const Rect& b)
+{
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+/**
+ * @brief Check that the placed rectangles are inside the atlas and do not overlap.
+ */
+void checkRects(const std::vector<Rect>& rects, int side)
+{
+    for(std::size_t i = 0; i < rects.size(); ++i)
+    {
+        const Rect& r = rects[i];
+        BOOST_CHECK_MESSAGE(r.x >= 0 && r.y >= 0 && r.x + r.width <= side && r.y + r.height <= side,
+                            "rectangle " << i << " at (" << r.x << ", " << r.y << ") is out of the atlas");
+        for(std::size_t j = i + 1; j < rects.size(); ++j)
+            BOOST_CHECK_MESSAGE(!overlap(r, rects[j]), "rectangles " << i << " and " << j << " overlap");
+    }
+}
+
+/**
+ * @brief Random charts sizes, from thin strips to large blocks.
+ */
+std::vector<Pixel> createRandomSizes(int nbRects, int maxSize, std::mt19937& generator)
+{
+    std::uniform_int_distribution<int> sizeDistribution(1, maxSize);
+    std::uniform_int_distribution<int> shapeDistribution(0, 3);
+    std::vector<Pixel> sizes;
+    for(int i = 0; i < nbRects; ++i)
+    {
+        Pixel size(sizeDistribution(generator), sizeDistribution(generator));
+        if(shapeDistribution(generator) == 0)
+            size.y = std::max(1, size.y / 8);
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(skylinePacker_single)
+{
+    const int side = 64;
+    SkylinePacker packer(side);
+
+    Pixel LU;
+    BOOST_CHECK(!packer.insert(side + 1, 1, LU));
+    BOOST_CHECK(!packer.insert(1, side + 1, LU));
+
+    // fill the atlas with squares, then it is full
+    std::vector<Rect> rects;
+    for(int i = 0; i < 16; ++i)
+    {
+        BOOST_REQUIRE(packer.insert(16, 16, LU));
+        rects.push_back({LU.x, LU.y, 16, 16});
+    }
+    BOOST_CHECK(!packer.insert(1, 1, LU));
+    checkRects(rects, side);
+}
+
+BOOST_AUTO_TEST_CASE(skylinePacker_random)
+{
+    std::mt19937 generator(42);
+    const int side = 512;
+
+    SkylinePacker packer(side);
+    std::vector<Rect> rects;
+    int nbRejected = 0;
+    for(const Pixel& size : createRandomSizes(2000, 64, generator))
+    {
+        Pixel LU;
+        if(packer.insert(size.x, size.y, LU))
+            rects.push_back({LU.x, LU.y, size.x, size.y});
+        else
+            ++nbRejected;
+    }
+    BOOST_CHECK_GT(rects.size(), 0);
+    BOOST_CHECK_GT(nbRejected, 0);
+    checkRects(rects, side);
+}
+
+BOOST_AUTO_TEST_CASE(skylinePacker_atlases)
+{
+    std::mt19937 generator(7);
+    const int side = 255;
+    const int gutter = 2;
+
+    for(const int nbCharts : {1, 10, 500, 3000})
+    {
+        BOOST_TEST_MESSAGE("charts " << nbCharts);
+
+        // charts with their gutter, as packed by UVAtlas
+        const std::vector<Pixel> chartSizes = createRandomSizes(nbCharts, 80, generator);
+        std::vector<Pixel> rectSizes;
+        for(const Pixel& size : chartSizes)
+            rectSizes.emplace_back(size.x + 2 * gutter, size.y + 2 * gutter);
+
+        std::vector<Pixel> positions;
+        const std::vector<std::vector<int>> atlasesRectIds = packSkyline(rectSizes, side, 0.85, positions);
+        BOOST_REQUIRE_EQUAL(positions.size(), rectSizes.size());
+
+        // every chart is placed in a single atlas
+        std::vector<int> nbPlacements(nbCharts, 0);
+        for(const std::vector<int>& rectIds : atlasesRectIds)
+        {
+            BOOST_CHECK(!rectIds.empty());
+            std::vector<Rect> rects;
+            for(const int rectId : rectIds)
+            {
+                BOOST_REQUIRE(rectId >= 0 && rectId < nbCharts);
+                ++nbPlacements[rectId];
+                rects.push_back({positions[rectId].x, positions[rectId].y, rectSizes[rectId].x, rectSizes[rectId].y});
+            }
+            // the charts and their gutter do not overlap and fit in the atlas
+            checkRects(rects, side);
+        }
+        for(int i = 0; i < nbCharts; ++i)
+            BOOST_CHECK_EQUAL(nbPlacements[i], 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(skylinePacker_tooLarge)
+{
+    std::vector<Pixel> positions;
+    const std::vector<Pixel> rectSizes = {Pixel(10, 10), Pixel(300, 20)};
+    BOOST_CHECK_THROW(packSkyline(rectSizes, 255, 0.85, positions), std::runtime_error);
+}
@@ -36,7 +36,10 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <fstream>
+#include <future>
 #include <map>
+#include <memory>
 #include <set>
 
 // Debug mode: save atlases decomposition in frequency bands and
@@ -169,6 +172,326 @@ Point3d barycentricToCartesian(const Point3d* triangle, const Point2d& coords)
     return triangle[0] + (triangle[2] - triangle[0]) * coords.x + (triangle[1] - triangle[0]) * coords.y;
 }
 
+namespace {
+
+/// Number of texture rows per tile, the tiles of the atlases are accumulated concurrently
+constexpr int textureTileRows = 128;
+
+/**
+ * @brief Camera image and its laplacian pyramid, possibly cropped to a region of the camera.
+ */
+struct CameraPyramid
+{
+    std::vector<image::Image<image::RGBfColor>> levels; //< camera image then the frequency bands
+    std::vector<Pixel> offsets;                         //< position of each level crop in the full level
+    std::vector<int> scales;                            //< downscale of each level relative to the camera image
+
+    void build(const image::Image<image::RGBfColor>& camImg, int nbBand, unsigned int downscale)
+    {
+        std::vector<image::Image<image::RGBfColor>> pyramidL; //laplacian pyramid
+        imageAlgo::laplacianPyramid(pyramidL, camImg, nbBand, downscale);
+
+        levels.resize(pyramidL.size() + 1);
+        offsets.assign(levels.size(), Pixel(0, 0));
+        scales.resize(levels.size());
+        levels[0] = camImg;
+        scales[0] = 1;
+        for(std::size_t band = 0; band < pyramidL.size(); ++band)
+        {
+            levels[band + 1].swap(pyramidL[band]);
+            scales[band + 1] = static_cast<int>(std::pow(downscale, band));
+        }
+    }
+
+    /**
+     * @brief Crop each level to the region, with a margin for the bilinear interpolation.
+     * @param[in] region [xMin, yMin, xMax, yMax) in the camera image
+     */
+    void crop(const std::array<int, 4>& region, CameraPyramid& out) const
+    {
+        out.levels.resize(levels.size());
+        out.offsets.resize(levels.size());
+        out.scales = scales;
+        for(std::size_t level = 0; level < levels.size(); ++level)
+        {
+            const image::Image<image::RGBfColor>& img = levels[level];
+            const int scale = scales[level];
+            const int xMin = std::max(0, region[0] / scale - 1);
+            const int yMin = std::max(0, region[1] / scale - 1);
+            const int xMax = std::min(img.Width(), divideRoundUp(region[2], scale) + 2);
+            const int yMax = std::min(img.Height(), divideRoundUp(region[3], scale) + 2);
+
+            out.offsets[level] = Pixel(xMin, yMin) + offsets[level];
+            out.levels[level] = image::Image<image::RGBfColor>::Base(img.block(yMin, xMin, std::max(0, yMax - yMin), std::max(0, xMax - xMin)));
+        }
+    }
+
+    /**
+     * @brief Get the interpolated color of the level at the given camera image coordinates.
+     */
+    inline image::RGBfColor getColor(std::size_t level, const Point2d& pix) const
+    {
+        const Point2d pixLevel = pix / scales[level];
+        return getInterpolateColor(levels[level], pixLevel.y - offsets[level].y, pixLevel.x - offsets[level].x);
+    }
+
+    void save(const std::string& filepath) const
+    {
+        std::ofstream file(filepath, std::ios::binary);
+        if(!file.is_open())
+            throw std::runtime_error("Unable to open file " + filepath + " to write the camera pyramid.");
+
+        const int nbLevels = static_cast<int>(levels.size());
+        file.write(reinterpret_cast<const char*>(&nbLevels), sizeof(int));
+        for(std::size_t level = 0; level < levels.size(); ++level)
+        {
+            const int header[5] = {scales[level], offsets[level].x, offsets[level].y, levels[level].Width(), levels[level].Height()};
+            file.write(reinterpret_cast<const char*>(header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(levels[level].data()), levels[level].size() * sizeof(image::RGBfColor));
+        }
+        if(!file.good())
+            throw std::runtime_error("Unable to write the camera pyramid in file " + filepath);
+    }
+
+    void load(const std::string& filepath)
+    {
+        std::ifstream file(filepath, std::ios::binary);
+        if(!file.is_open())
+            throw std::runtime_error("Unable to open camera pyramid file " + filepath);
+
+        int nbLevels = 0;
+        file.read(reinterpret_cast<char*>(&nbLevels), sizeof(int));
+        levels.resize(nbLevels);
+        offsets.resize(nbLevels);
+        scales.resize(nbLevels);
+        for(int level = 0; level < nbLevels; ++level)
+        {
+            int header[5];
+            file.read(reinterpret_cast<char*>(header), sizeof(header));
+            scales[level] = header[0];
+            offsets[level] = Pixel(header[1], header[2]);
+            levels[level].resize(header[3], header[4], false);
+            file.read(reinterpret_cast<char*>(levels[level].data()), levels[level].size() * sizeof(image::RGBfColor));
+        }
+        if(!file.good())
+            throw std::runtime_error("Invalid camera pyramid file " + filepath);
+    }
+};
+
+/**
+ * @brief Extend the region [xMin, yMin, xMax, yMax) of the camera image to the projection of the contributing triangles.
+ */
+void extendCameraRegion(const Mesh& mesh, const mvsUtils::MultiViewParams& mp, int camId,
+                        const Texturing::CameraContributions& cameraContributions, std::array<int, 4>& region)
+{
+    const int w = mp.getWidth(camId);
+    const int h = mp.getHeight(camId);
+    const std::array<int, 4> fullRegion = {0, 0, w, h};
+    if(region[2] <= region[0])
+        region = {w, h, 0, 0};
+
+    for(const auto& atlasContributions : cameraContributions)
+    {
+        for(const Texturing::ScorePerTriangle& bandContributions : atlasContributions.second)
+        {
+            for(const auto& triangleScore : bandContributions)
+            {
+                for(int k = 0; k < 3; ++k)
+                {
+                    const Point3d& p = mesh.pts[mesh.tris[triangleScore.first].v[k]];
+                    if(!mp.is3DPointInFrontOfCam(&p, camId))
+                    {
+                        // the triangle projection is not bounded by its vertices projections
+                        region = fullRegion;
+                        return;
+                    }
+                    Point2d pix;
+                    mp.getPixelFor3DPoint(&pix, p, camId);
+                    region[0] = std::min(region[0], static_cast<int>(std::floor(pix.x)));
+                    region[1] = std::min(region[1], static_cast<int>(std::floor(pix.y)));
+                    region[2] = std::max(region[2], static_cast<int>(std::ceil(pix.x)) + 1);
+                    region[3] = std::max(region[3], static_cast<int>(std::ceil(pix.y)) + 1);
+                }
+            }
+        }
+    }
+
+    region[0] = clamp(region[0], 0, w);
+    region[1] = clamp(region[1], 0, h);
+    region[2] = clamp(region[2], 0, w);
+    region[3] = clamp(region[3], 0, h);
+}
+
+/**
+ * @brief Get the range [firstTile, lastTile] of the rows tiles overlapped by the texture rows [LU.y, RD.y).
+ * @note tiles are indexed in the image rows order (inverted Y axis)
+ * @return false if the range is empty
+ */
+bool getTilesRange(const Pixel& LU, const Pixel& RD, int textureSide, int& firstTile, int& lastTile)
+{
+    if(RD.y <= LU.y)
+        return false;
+    firstTile = (textureSide - RD.y) / textureTileRows;
+    lastTile = (textureSide - 1 - LU.y) / textureTileRows;
+    return true;
+}
+
+/**
+ * @brief Average the accumulated colors of each frequency band.
+ */
+void averageAccuPyramid(Texturing::AccuPyramid& accuPyramid)
+{
+    Texturing::AccuImage& atlasTexture = accuPyramid.pyramid[0];
+    for(std::size_t xyoffset = 0; xyoffset < atlasTexture.imgCount.size(); ++xyoffset)
+    {
+        // If the imgCount is valid on the first band, it will be valid on all the other bands
+        if(atlasTexture.imgCount[xyoffset] == 0)
+            continue;
+
+        atlasTexture.img(xyoffset) /= atlasTexture.imgCount[xyoffset];
+        atlasTexture.imgCount[xyoffset] = 1;
+
+        for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
+        {
+            Texturing::AccuImage& atlasLevelTexture = accuPyramid.pyramid[level];
+            atlasLevelTexture.img(xyoffset) /= atlasLevelTexture.imgCount[xyoffset];
+        }
+    }
+}
+
+/**
+ * @brief Fuse the averaged frequency bands into the first level of the pyramid.
+ */
+void fuseAccuPyramidBands(Texturing::AccuPyramid& accuPyramid)
+{
+    Texturing::AccuImage& atlasTexture = accuPyramid.pyramid[0];
+    for(std::size_t xyoffset = 0; xyoffset < atlasTexture.imgCount.size(); ++xyoffset)
+    {
+        for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
+        {
+            Texturing::AccuImage& atlasLevelTexture = accuPyramid.pyramid[level];
+            atlasTexture.img(xyoffset) += atlasLevelTexture.img(xyoffset);
+        }
+    }
+}
+
+/**
+ * @brief Dilate the charts of the texture in the gutter, up to the padding distance.
+ * @warning the "imgCount" of the texture is modified to propagate the padding
+ * @note the first and last rows and columns are not padded, the padding of a rows window only depends on
+ *       the rows at less than 2 * padding + 2 rows of it
+ */
+void edgePadding(Texturing::AccuImage& atlasTexture, unsigned int width, unsigned int height, unsigned int padding)
+{
+    // Init valid values to 1
+    for(unsigned int y = 0; y < height; ++y)
+    {
+        unsigned int yoffset = y * width;
+        for(unsigned int x = 0; x < width; ++x)
+        {
+            unsigned int xyoffset = yoffset + x;
+            if(atlasTexture.imgCount[xyoffset] > 0)
+                atlasTexture.imgCount[xyoffset] = 1;
+        }
+    }
+
+    //up-left to bottom-right
+    for(unsigned int y = 1; y + 1 < height; ++y)
+    {
+        unsigned int yoffset = y * width;
+        for(unsigned int x = 1; x + 1 < width; ++x)
+        {
+            unsigned int xyoffset = yoffset + x;
+            if(atlasTexture.imgCount[xyoffset] > 0)
+                continue;
+
+            const int upCount = atlasTexture.imgCount[xyoffset - width];
+            const int leftCount = atlasTexture.imgCount[xyoffset - 1];
+            //if pixel on the edge of a chart
+            if(leftCount > 0)
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - 1);
+                atlasTexture.imgCount[xyoffset] = - 1;
+            }
+            else if(upCount > 0)
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - width);
+                atlasTexture.imgCount[xyoffset] = - 1;
+            }
+            //
+            else if (leftCount < 0 && - leftCount < padding && (upCount == 0 || leftCount > upCount))
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - 1);
+                atlasTexture.imgCount[xyoffset] = leftCount - 1;
+            }
+            else if (upCount < 0 && - upCount < padding)
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - width);
+                atlasTexture.imgCount[xyoffset] = upCount - 1;
+            }
+        }
+    }
+
+    //bottom-right to up-left
+    for(unsigned int y = 1; y + 1 < height; ++y)
+    {
+        unsigned int yoffset = (height - 1 - y) * width;
+        for(unsigned int x = 1; x + 1 < width; ++x)
+        {
+            unsigned int xyoffset = yoffset + (width - 1 - x);
+            if(atlasTexture.imgCount[xyoffset] > 0)
+                continue;
+
+            const int upCount = atlasTexture.imgCount[xyoffset - width];
+            const int downCount = atlasTexture.imgCount[xyoffset + width];
+            const int rightCount = atlasTexture.imgCount[xyoffset + 1];
+            const int leftCount = atlasTexture.imgCount[xyoffset - 1];
+            if(rightCount > 0)
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + 1);
+                atlasTexture.imgCount[xyoffset] = - 1;
+            }
+            else if(downCount > 0)
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + width);
+                atlasTexture.imgCount[xyoffset] = - 1;
+            }
+            else if ((rightCount < 0 && - rightCount < padding) &&
+                     (leftCount == 0 || rightCount > leftCount) &&
+                     (downCount == 0 || rightCount >= downCount)
+                     )
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + 1);
+                atlasTexture.imgCount[xyoffset] = rightCount - 1;
+            }
+            else if ((downCount < 0 && - downCount < padding) &&
+                     (upCount == 0 || downCount > upCount)
+                     )
+            {
+                atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + width);
+                atlasTexture.imgCount[xyoffset] = downCount - 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Atlas texture accumulated by rows tiles: a tile is fused as soon as its last contributing camera
+ *        has been splatted, and written once the tiles needed by its edge padding are fused.
+ */
+struct TiledAtlas
+{
+    std::vector<int> lastCamIds;                   //< per tile, the last contributing camera or -1
+    std::vector<Texturing::AccuPyramid> accuTiles; //< per tile, frequency bands being accumulated (allocated on first use)
+    std::vector<Texturing::AccuImage> fusedTiles;  //< per tile, final colors kept until the neighbor tiles are written
+    std::vector<bool> isFused;
+    std::vector<bool> isWritten;
+    int nbWritten = 0;
+    std::unique_ptr<image::TiledImageWriter> writer;
+};
+
+} // namespace
+
 void Texturing::generateUVsBasicMethod(mvsUtils::MultiViewParams& mp)
 {
     if(!mesh)
@@ -178,7 +501,7 @@ void Texturing::generateUVsBasicMethod(mvsUtils::MultiViewParams& mp)
 
     // automatic uv atlasing
     ALICEVISION_LOG_INFO("Generating UVs (textureSide: " << texParams.textureSide << "; padding: " << texParams.padding << ").");
-    UVAtlas mua(*mesh, mp, texParams.textureSide, texParams.padding);
+    UVAtlas mua(*mesh, mp, texParams.textureSide, texParams.padding, texParams.chartPackingMethod);
 
     // create a new mesh to store data
     mesh->trisUvIds.reserve(mesh->tris.size());
@@ -308,7 +631,8 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     mvsUtils::ImagesCache<image::Image<image::RGBfColor>> imageCache(
                 mp, texParams.workingColorSpace, texParams.correctEV);
 
-    imageCache.setCacheSize(2);
+    // the camera pyramids own a copy of their image, so the cache only holds the image being loaded
+    imageCache.setCacheSize(1);
     ALICEVISION_LOG_INFO("Images loaded from cache with: " + ECorrectEV_enumToString(texParams.correctEV));
 
     //calculate the maximum number of atlases in memory in MB
@@ -320,9 +644,64 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     const std::size_t atlasPyramidMaxMemSize = texParams.nbBand * atlasContribMemSize;
 
     const int availableRam = int(memoryAvailable / std::pow(2,20));
-    const int availableMem = availableRam - 2 * (imagePyramidMaxMemSize + imageMaxMemSize); // keep some memory for the 2 input images in cache and one laplacian pyramid
+    const int availableMem = availableRam - imageMaxMemSize - 2 * (imagePyramidMaxMemSize + imageMaxMemSize); // keep some memory for the input image in cache, the current and the prefetched camera pyramids
 
     const int nbAtlas = _atlases.size();
+
+    if(texParams.tiledOutput && !isTiledOutputAvailable(textureFileType))
+    {
+        ALICEVISION_LOG_WARNING("Tiled texture output is only available for EXR and TIFF files, without holes filling and downscaling.");
+        if(texParams.mipmaps)
+            ALICEVISION_LOG_WARNING("The mip levels are not written without the tiled texture output.");
+    }
+
+    if(isTiledOutputAvailable(textureFileType))
+    {
+        // only the tiles between their first and last contributing cameras are in memory,
+        // process all the atlases at once if the maximum number of active tiles fits in memory
+        std::vector<size_t> allAtlasIDs(nbAtlas);
+        std::iota(allAtlasIDs.begin(), allAtlasIDs.end(), 0);
+        std::vector<CameraContributions> contributionsPerCamera;
+        computeContributionsPerCamera(mp, allAtlasIDs, contributionsPerCamera);
+
+        std::map<std::size_t, std::vector<std::pair<int, int>>> tilesCamerasRange;
+        computeTilesCamerasRange(contributionsPerCamera, tilesCamerasRange);
+
+        std::vector<int> nbTilesStarting(mp.ncams, 0);
+        std::vector<int> nbTilesEnding(mp.ncams, 0);
+        for(const auto& atlasTilesCamerasRange : tilesCamerasRange)
+        {
+            for(const auto& camerasRange : atlasTilesCamerasRange.second)
+            {
+                if(camerasRange.first < 0)
+                    continue;
+                ++nbTilesStarting[camerasRange.first];
+                ++nbTilesEnding[camerasRange.second];
+            }
+        }
+        int nbActiveTiles = 0;
+        int nbActiveTilesMax = 0;
+        for(int camId = 0; camId < mp.ncams; ++camId)
+        {
+            nbActiveTiles += nbTilesStarting[camId];
+            nbActiveTilesMax = std::max(nbActiveTilesMax, nbActiveTiles);
+            nbActiveTiles -= nbTilesEnding[camId];
+        }
+
+        const double tilePyramidMemSize =
+                texParams.nbBand * textureTileRows * texParams.textureSide * (sizeof(image::RGBfColor)+sizeof(float)) / std::pow(2,20); //MB
+        const double tiledMemSize = nbActiveTilesMax * tilePyramidMemSize;
+        ALICEVISION_LOG_INFO("Tiled output: at most " << nbActiveTilesMax << " tiles accumulated at the same time (" << int(tiledMemSize) << " MB).");
+
+        if(tiledMemSize < availableMem)
+        {
+            ALICEVISION_LOG_INFO("Processing the " << nbAtlas << " atlases at once by tiles.");
+            generateTexturesSubSet(mp, allAtlasIDs, contributionsPerCamera, imageCache, nullptr, outPath, textureFileType);
+            return;
+        }
+        ALICEVISION_LOG_WARNING("Not enough memory to accumulate the tiles of all the atlases at once, processing by chunks.");
+    }
+
     // Memory needed to process each attlas = input + input pyramid + output atlas pyramid
     const int memoryPerAtlas = (imageMaxMemSize + imagePyramidMaxMemSize) + atlasPyramidMaxMemSize;
     int nbAtlasMax = std::floor(availableMem / double(memoryPerAtlas)); //maximum number of textures laplacian pyramid in RAM
@@ -353,21 +732,91 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
 
     //generateTexture for the maximum number of atlases, and iterate
     const std::div_t divresult = div(nbAtlas, nbAtlasMax);
-    std::vector<size_t> atlasIDs;
-    atlasIDs.reserve(nbAtlasMax);
+    std::vector<std::vector<size_t>> chunksAtlasIDs;
     for(int n = 0; n <= divresult.quot; ++n)
     {
-        atlasIDs.clear();
         int imax = (n < divresult.quot ? nbAtlasMax : divresult.rem);
         if(!imax)
             continue;
+        std::vector<size_t> atlasIDs;
         for(int i = 0; i < imax; ++i)
         {
             size_t atlasID = size_t(n*nbAtlasMax + i);
             atlasIDs.push_back(atlasID);
         }
-        ALICEVISION_LOG_INFO("Generating texture for atlases " << n*nbAtlasMax + 1 << " to " << n*nbAtlasMax+imax );
-        generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType);
+        chunksAtlasIDs.push_back(atlasIDs);
+    }
+
+    // select the contributions of all the chunks first, to know which cameras are used again by the next chunks
+    std::vector<std::vector<CameraContributions>> chunksContributions(chunksAtlasIDs.size());
+    for(std::size_t n = 0; n < chunksAtlasIDs.size(); ++n)
+        computeContributionsPerCamera(mp, chunksAtlasIDs[n], chunksContributions[n]);
+
+    std::unique_ptr<PyramidsDiskCache> pyramidsCache;
+    if(chunksAtlasIDs.size() > 1)
+    {
+        pyramidsCache.reset(new PyramidsDiskCache(outPath / ("pyramidsCache_" + bfs::unique_path().string())));
+        pyramidsCache->regions.resize(mp.ncams, {0, 0, 0, 0});
+        pyramidsCache->isStored.resize(mp.ncams, false);
+
+        // the first chunk using a camera decomposes the whole image,
+        // only the region of the triangles of the next chunks is stored
+        std::vector<bool> isUsed(mp.ncams, false);
+        std::size_t nbCachedCameras = 0;
+        for(const std::vector<CameraContributions>& contributionsPerCamera : chunksContributions)
+        {
+            for(int camId = 0; camId < mp.ncams; ++camId)
+            {
+                if(contributionsPerCamera[camId].empty())
+                    continue;
+                if(!isUsed[camId])
+                {
+                    isUsed[camId] = true;
+                    continue;
+                }
+                std::array<int, 4>& region = pyramidsCache->regions[camId];
+                if(region[2] <= region[0])
+                    ++nbCachedCameras;
+                extendCameraRegion(*mesh, mp, camId, contributionsPerCamera[camId], region);
+            }
+        }
+
+        // the cache should not fill the disk: keep half of the free space for the output textures,
+        // the cameras over the budget are decomposed again by the next chunks
+        const double maxCacheSize = 0.5 * static_cast<double>(bfs::space(pyramidsCache->folder).available);
+        double pyramidSizeFactor = 1.0; // camera image and frequency bands relative to the image size
+        for(unsigned int band = 0; band < texParams.nbBand; ++band)
+            pyramidSizeFactor += 1.0 / std::pow(double(texParams.multiBandDownscale), 2.0 * band);
+
+        double cacheSize = 0.0;
+        std::size_t nbSkippedCameras = 0;
+        for(int camId = 0; camId < mp.ncams; ++camId)
+        {
+            std::array<int, 4>& region = pyramidsCache->regions[camId];
+            if(region[2] <= region[0] || region[3] <= region[1])
+                continue;
+            const double pyramidSize = double(region[2] - region[0]) * double(region[3] - region[1]) * sizeof(image::RGBfColor) * pyramidSizeFactor;
+            if(cacheSize + pyramidSize > maxCacheSize)
+            {
+                region = {0, 0, 0, 0};
+                --nbCachedCameras;
+                ++nbSkippedCameras;
+                continue;
+            }
+            cacheSize += pyramidSize;
+        }
+        ALICEVISION_LOG_INFO(nbCachedCameras << " camera pyramids will be reused from disk by the next chunks ("
+                             << int(cacheSize / std::pow(2, 20)) << " MB).");
+        if(nbSkippedCameras > 0)
+            ALICEVISION_LOG_WARNING(nbSkippedCameras << " camera pyramids not cached: not enough free disk space in " << outPath.string() << ".");
+    }
+
+    for(std::size_t n = 0; n < chunksAtlasIDs.size(); ++n)
+    {
+        ALICEVISION_LOG_INFO("Generating texture for atlases " << chunksAtlasIDs[n].front() + 1 << " to " << chunksAtlasIDs[n].back() + 1);
+        generateTexturesSubSet(mp, chunksAtlasIDs[n], chunksContributions[n], imageCache, pyramidsCache.get(), outPath, textureFileType);
+        // release the contributions of the chunk
+        std::vector<CameraContributions>().swap(chunksContributions[n]);
     }
 }
 
@@ -376,17 +825,106 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                                        mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
                                        const bfs::path& outPath,
                                        image::EImageFileType textureFileType)
+{
+    std::vector<CameraContributions> contributionsPerCamera;
+    computeContributionsPerCamera(mp, atlasIDs, contributionsPerCamera);
+    generateTexturesSubSet(mp, atlasIDs, contributionsPerCamera, imageCache, nullptr, outPath, textureFileType);
+}
+
+bool Texturing::isTiledOutputAvailable(image::EImageFileType textureFileType) const
+{
+    return texParams.tiledOutput &&
+           (textureFileType == image::EImageFileType::EXR || textureFileType == image::EImageFileType::TIFF) &&
+           !texParams.fillHoles && texParams.downscale == 1;
+}
+
+void Texturing::getTriangleUVBox(unsigned int triangleId, Point2d triPixs[3], Pixel& LU, Pixel& RD) const
+{
+    const int texSide = static_cast<int>(texParams.textureSide);
+    auto& triangleUvIds = mesh->trisUvIds[triangleId];
+    // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
+    Point2d udimBL;
+    const StaticVector<Point2d>& uvCoords = mesh->uvCoords;
+    udimBL.x = std::floor(std::min({uvCoords[triangleUvIds[0]].x,
+                                    uvCoords[triangleUvIds[1]].x,
+                                    uvCoords[triangleUvIds[2]].x}));
+    udimBL.y = std::floor(std::min({uvCoords[triangleUvIds[0]].y,
+                                    uvCoords[triangleUvIds[1]].y,
+                                    uvCoords[triangleUvIds[2]].y}));
+
+    for(int k = 0; k < 3; ++k)
+    {
+       const int uvPointIndex = triangleUvIds.m[k];
+       Point2d uv = uvCoords[uvPointIndex];
+       // UDIM: remap coordinates between [0,1]
+       uv = uv - udimBL;
+
+       triPixs[k] = uv * texParams.textureSide;   // UV coordinates
+    }
+
+    // compute triangle bounding box in pixel indexes
+    // min values: floor(value)
+    // max values: ceil(value)
+    LU.x = static_cast<int>(std::floor(std::min({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
+    LU.y = static_cast<int>(std::floor(std::min({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
+    RD.x = static_cast<int>(std::ceil(std::max({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
+    RD.y = static_cast<int>(std::ceil(std::max({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
+
+    // sanity check: clamp values to [0; textureSide]
+    LU.x = clamp(LU.x, 0, texSide);
+    LU.y = clamp(LU.y, 0, texSide);
+    RD.x = clamp(RD.x, 0, texSide);
+    RD.y = clamp(RD.y, 0, texSide);
+}
+
+void Texturing::computeTilesCamerasRange(const std::vector<CameraContributions>& contributionsPerCamera,
+                                         std::map<std::size_t, std::vector<std::pair<int, int>>>& out_tilesCamerasRange) const
+{
+    const int texSide = static_cast<int>(texParams.textureSide);
+    const int nbTilesPerAtlas = divideRoundUp(texSide, textureTileRows);
+
+    out_tilesCamerasRange.clear();
+    for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+    {
+        for(const auto& atlasContributions : contributionsPerCamera[camId])
+        {
+            auto& tilesCamerasRange = out_tilesCamerasRange[atlasContributions.first];
+            if(tilesCamerasRange.empty())
+                tilesCamerasRange.resize(nbTilesPerAtlas, {-1, -1});
+
+            for(const ScorePerTriangle& bandContributions : atlasContributions.second)
+            {
+                for(const auto& triangleScore : bandContributions)
+                {
+                    Point2d triPixs[3];
+                    Pixel LU, RD;
+                    int firstTile, lastTile;
+                    getTriangleUVBox(triangleScore.first, triPixs, LU, RD);
+                    if(!getTilesRange(LU, RD, texSide, firstTile, lastTile))
+                        continue;
+                    for(int tile = firstTile; tile <= lastTile; ++tile)
+                    {
+                        // cameras are processed in increasing order
+                        if(tilesCamerasRange[tile].first < 0)
+                            tilesCamerasRange[tile].first = camId;
+                        tilesCamerasRange[tile].second = camId;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Texturing::computeContributionsPerCamera(const mvsUtils::MultiViewParams& mp, const std::vector<size_t>& atlasIDs,
+                                              std::vector<CameraContributions>& out_contributionsPerCamera) const
 {
     if(atlasIDs.size() > _atlases.size())
         throw std::runtime_error("Invalid atlas IDs ");
 
-    unsigned int textureSize = texParams.textureSide * texParams.textureSide;
-
     // We select the best cameras for each triangle and store it per camera for each output texture files.
     // Triangles contributions are stored per frequency bands for multi-band blending.
-    using AtlasIndex = size_t;
-    using ScorePerTriangle = std::vector<std::pair<unsigned int, float>>; //list of <triangleId, score>
-    std::vector<std::map<AtlasIndex, std::vector<ScorePerTriangle>>> contributionsPerCamera(mp.ncams);
+    std::vector<CameraContributions>& contributionsPerCamera = out_contributionsPerCamera;
+    contributionsPerCamera.assign(mp.ncams, CameraContributions());
 
     //for each atlasID, calculate contributionPerCamera
     for(const size_t atlasID : atlasIDs)
@@ -515,94 +1053,314 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         }
     }
 
+}
+
+void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
+                                       const std::vector<size_t>& atlasIDs,
+                                       const std::vector<CameraContributions>& contributionsPerCamera,
+                                       mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
+                                       PyramidsDiskCache* pyramidsCache,
+                                       const bfs::path& outPath,
+                                       image::EImageFileType textureFileType)
+{
+    using AtlasIndex = size_t;
+    unsigned int textureSize = texParams.textureSide * texParams.textureSide;
+
     ALICEVISION_LOG_INFO("Reading pixel color.");
 
+    const bool tiledOutput = isTiledOutputAvailable(textureFileType);
+    const int texSide = static_cast<int>(texParams.textureSide);
+    const int nbTilesPerAtlas = divideRoundUp(texSide, textureTileRows);
+    const auto getTileHeight = [&](int tile) { return std::min(textureTileRows, texSide - tile * textureTileRows); };
+
     //pyramid of atlases frequency bands
     std::map<AtlasIndex, AccuPyramid> accuPyramids;
-    for(std::size_t atlasID: atlasIDs)
-        accuPyramids[atlasID].init(texParams.nbBand, texParams.textureSide, texParams.textureSide);
+    //or atlases accumulated by rows tiles in tiled output mode
+    std::map<AtlasIndex, TiledAtlas> tiledAtlases;
+    if(tiledOutput)
+    {
+        std::map<std::size_t, std::vector<std::pair<int, int>>> tilesCamerasRange;
+        computeTilesCamerasRange(contributionsPerCamera, tilesCamerasRange);
 
-    //for each camera, for each texture, iterate over triangles and fill the accuPyramids map
-    for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+        for(std::size_t atlasID: atlasIDs)
+        {
+            TiledAtlas& tiledAtlas = tiledAtlases[atlasID];
+            tiledAtlas.lastCamIds.assign(nbTilesPerAtlas, -1);
+            const auto rangeIt = tilesCamerasRange.find(atlasID);
+            if(rangeIt != tilesCamerasRange.end())
+            {
+                for(int tile = 0; tile < nbTilesPerAtlas; ++tile)
+                    tiledAtlas.lastCamIds[tile] = rangeIt->second[tile].second;
+            }
+            tiledAtlas.accuTiles.resize(nbTilesPerAtlas);
+            tiledAtlas.fusedTiles.resize(nbTilesPerAtlas);
+            tiledAtlas.isFused.assign(nbTilesPerAtlas, false);
+            tiledAtlas.isWritten.assign(nbTilesPerAtlas, false);
+
+            material.diffuseType = textureFileType;
+            const std::string textureName = material.textureName(Material::TextureType::DIFFUSE, static_cast<int>(atlasID));
+            material.addTexture(Material::TextureType::DIFFUSE, textureName);
+
+            const bfs::path texturePath = outPath / textureName;
+            ALICEVISION_LOG_INFO("Writing texture file by tiles: " << texturePath.string());
+            tiledAtlas.writer.reset(new image::TiledImageWriter(texturePath.string(), texSide, texSide, textureTileRows,
+                                        image::ImageWriteOptions().fromColorSpace(texParams.workingColorSpace)
+                                                                  .toColorSpace(texParams.outputColorSpace)
+                                                                  .storageDataType(image::EStorageDataType::Half)));
+        }
+    }
+    else
     {
-        const std::map<AtlasIndex, std::vector<ScorePerTriangle>>& cameraContributions = contributionsPerCamera[camId];
+        for(std::size_t atlasID: atlasIDs)
+            accuPyramids[atlasID].init(texParams.nbBand, texParams.textureSide, texParams.textureSide);
+    }
+
+    // Fuse the frequency bands of a tile once all its contributions are accumulated
+    const auto fuseTile = [&](TiledAtlas& tiledAtlas, int tile) {
+        AccuPyramid& accuTile = tiledAtlas.accuTiles[tile];
+        if(accuTile.pyramid.empty())
+        {
+            // no contribution
+            tiledAtlas.fusedTiles[tile].resize(texSide, getTileHeight(tile));
+        }
+        else
+        {
+            averageAccuPyramid(accuTile);
+            fuseAccuPyramidBands(accuTile);
+            tiledAtlas.fusedTiles[tile] = std::move(accuTile.pyramid[0]);
+            accuTile = AccuPyramid();
+        }
+        tiledAtlas.isFused[tile] = true;
+    };
+
+    // The edge padding of a tile depends on the neighbor rows up to the padding halo
+    const unsigned int padding = texParams.padding * 3;
+    const int paddingHalo = (padding > 0) ? 2 * padding + 2 : 0;
+    const int haloTiles = divideRoundUp(paddingHalo, textureTileRows);
+
+    // Write the tiles whose neighbors are fused, release the fused tiles no longer needed by the edge padding
+    const auto writeReadyTiles = [&](TiledAtlas& tiledAtlas) {
+        const auto isRangeDone = [&](const std::vector<bool>& isDone, int tile) {
+            for(int t = std::max(0, tile - haloTiles); t <= std::min(nbTilesPerAtlas - 1, tile + haloTiles); ++t)
+                if(!isDone[t])
+                    return false;
+            return true;
+        };
+
+        for(int tile = 0; tile < nbTilesPerAtlas; ++tile)
+        {
+            if(tiledAtlas.isWritten[tile] || !isRangeDone(tiledAtlas.isFused, tile))
+                continue;
+
+            const int rowBegin = tile * textureTileRows;
+            const int rowEnd = rowBegin + getTileHeight(tile);
+            const int windowBegin = std::max(0, rowBegin - paddingHalo);
+            const int windowEnd = std::min(texSide, rowEnd + paddingHalo);
 
-        if(cameraContributions.empty())
+            // copy the tile and its halo rows
+            AccuImage window;
+            window.resize(texSide, windowEnd - windowBegin);
+            for(int y = windowBegin; y < windowEnd; ++y)
+            {
+                const AccuImage& fusedTile = tiledAtlas.fusedTiles[y / textureTileRows];
+                const std::size_t srcOffset = std::size_t(y % textureTileRows) * texSide;
+                const std::size_t dstOffset = std::size_t(y - windowBegin) * texSide;
+                std::copy_n(fusedTile.img.data() + srcOffset, texSide, window.img.data() + dstOffset);
+                std::copy_n(fusedTile.imgCount.data() + srcOffset, texSide, window.imgCount.data() + dstOffset);
+            }
+
+            if(padding > 0)
+                edgePadding(window, texSide, windowEnd - windowBegin, padding);
+
+            image::Image<image::RGBfColor> rows(texSide, rowEnd - rowBegin, false);
+            std::copy_n(window.img.data() + std::size_t(rowBegin - windowBegin) * texSide, rows.size(), rows.data());
+            tiledAtlas.writer->writeRows(rowBegin, rows);
+
+            tiledAtlas.isWritten[tile] = true;
+            ++tiledAtlas.nbWritten;
+        }
+
+        for(int tile = 0; tile < nbTilesPerAtlas; ++tile)
+        {
+            if(!tiledAtlas.fusedTiles[tile].imgCount.empty() && isRangeDone(tiledAtlas.isWritten, tile))
+                tiledAtlas.fusedTiles[tile] = AccuImage();
+        }
+
+        if(tiledAtlas.writer && tiledAtlas.nbWritten == nbTilesPerAtlas)
         {
+            tiledAtlas.writer->close(texParams.mipmaps);
+            tiledAtlas.writer.reset();
+        }
+    };
+
+    // tiles without contribution are ready from the start
+    for(auto& tiledAtlasIt : tiledAtlases)
+    {
+        TiledAtlas& tiledAtlas = tiledAtlasIt.second;
+        for(int tile = 0; tile < nbTilesPerAtlas; ++tile)
+        {
+            if(tiledAtlas.lastCamIds[tile] < 0)
+                fuseTile(tiledAtlas, tile);
+        }
+        writeReadyTiles(tiledAtlas);
+    }
+
+    std::vector<int> usedCamIds;
+    for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+    {
+        if(contributionsPerCamera[camId].empty())
             ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") unused.");
-            continue;
+        else
+            usedCamIds.push_back(camId);
+    }
+
+    // Load the camera image (from the pyramids cache if available) and calculate its laplacian pyramid
+    const auto loadCameraPyramid = [&](int camId) {
+        std::shared_ptr<CameraPyramid> camPyramid = std::make_shared<CameraPyramid>();
+        const std::string pyramidPath = pyramidsCache ? (pyramidsCache->folder / (std::to_string(camId) + ".bin")).string() : "";
+
+        if(pyramidsCache && pyramidsCache->isStored[camId])
+        {
+            camPyramid->load(pyramidPath);
+            return camPyramid;
         }
-        ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") with contributions to " << cameraContributions.size() << " texture files:");
 
-        // Load camera image from cache
-        auto imgPtr = imageCache.getImg_sync(camId);
-        const image::Image<image::RGBfColor>& camImg = *imgPtr;
+        {
+            auto imgPtr = imageCache.getImg_sync(camId);
+            camPyramid->build(*imgPtr, texParams.nbBand, texParams.multiBandDownscale);
+        }
 
-        // Calculate laplacianPyramid
-        std::vector<image::Image<image::RGBfColor>> pyramidL; //laplacian pyramid
-        imageAlgo::laplacianPyramid(pyramidL, camImg, texParams.nbBand, texParams.multiBandDownscale);
+        if(pyramidsCache)
+        {
+            const std::array<int, 4>& region = pyramidsCache->regions[camId];
+            if(region[2] > region[0] && region[3] > region[1])
+            {
+                CameraPyramid croppedPyramid;
+                camPyramid->crop(region, croppedPyramid);
+                croppedPyramid.save(pyramidPath);
+                pyramidsCache->isStored[camId] = true;
+            }
+        }
+        return camPyramid;
+    };
+
+    // the next camera is prepared while the current one is splatted
+    std::future<std::shared_ptr<CameraPyramid>> nextCamPyramid;
+    if(!usedCamIds.empty())
+        nextCamPyramid = std::async(std::launch::async, loadCameraPyramid, usedCamIds.front());
+
+    //for each camera, for each texture, iterate over triangles and fill the accuPyramids map
+    for(std::size_t i = 0; i < usedCamIds.size(); ++i)
+    {
+        const int camId = usedCamIds[i];
+        const CameraContributions& cameraContributions = contributionsPerCamera[camId];
+
+        const std::shared_ptr<const CameraPyramid> camPyramid = nextCamPyramid.get();
+        if(i + 1 < usedCamIds.size())
+            nextCamPyramid = std::async(std::launch::async, loadCameraPyramid, usedCamIds[i + 1]);
+
+        ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") with contributions to " << cameraContributions.size() << " texture files:");
 
-        // for each output texture file
         for(const auto& c : cameraContributions)
         {
-            AtlasIndex atlasID = c.first;
-            ALICEVISION_LOG_INFO("  - Texture file: " << atlasID + 1);
-            //for each frequency band
+            ALICEVISION_LOG_INFO("  - Texture file: " << c.first + 1);
             for(int band = 0; band < c.second.size(); ++band)
-            {
-                const ScorePerTriangle& trianglesId = c.second[band];
-                ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << trianglesId.size() << " triangles.");
+                ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << c.second[band].size() << " triangles.");
+        }
 
-                // for each triangle
-                #pragma omp parallel for
+        // The atlases textured by this camera are split in rows tiles (in image rows order), processed concurrently:
+        // each tile is accumulated by a single thread, in the triangles order.
+        std::vector<AtlasIndex> cameraAtlasIDs;
+        for(const auto& c : cameraContributions)
+            cameraAtlasIDs.push_back(c.first);
+
+        // per atlas, per band, per tile: indexes of the contributions overlapping the tile rows
+        std::vector<std::vector<std::vector<std::vector<int>>>> atlasesTilesTriangles(cameraAtlasIDs.size());
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int a = 0; a < cameraAtlasIDs.size(); ++a)
+        {
+            const std::vector<ScorePerTriangle>& atlasContributions = cameraContributions.at(cameraAtlasIDs[a]);
+            auto& bandsTilesTriangles = atlasesTilesTriangles[a];
+            bandsTilesTriangles.resize(atlasContributions.size(), std::vector<std::vector<int>>(nbTilesPerAtlas));
+
+            for(int band = 0; band < atlasContributions.size(); ++band)
+            {
+                const ScorePerTriangle& trianglesId = atlasContributions[band];
                 for(int ti = 0; ti < trianglesId.size(); ++ti)
+                {
+                    Point2d triPixs[3];
+                    Pixel LU, RD;
+                    int firstTile, lastTile;
+                    getTriangleUVBox(std::get<0>(trianglesId[ti]), triPixs, LU, RD);
+                    if(!getTilesRange(LU, RD, texSide, firstTile, lastTile))
+                        continue;
+                    for(int tile = firstTile; tile <= lastTile; ++tile)
+                        bandsTilesTriangles[band][tile].push_back(ti);
+                }
+            }
+        }
+
+        // allocate the tiles accumulated by this camera
+        if(tiledOutput)
+        {
+            for(int a = 0; a < cameraAtlasIDs.size(); ++a)
+            {
+                TiledAtlas& tiledAtlas = tiledAtlases.at(cameraAtlasIDs[a]);
+                for(int tile = 0; tile < nbTilesPerAtlas; ++tile)
+                {
+                    AccuPyramid& accuTile = tiledAtlas.accuTiles[tile];
+                    if(!accuTile.pyramid.empty())
+                        continue;
+                    for(const std::vector<std::vector<int>>& tilesTriangles : atlasesTilesTriangles[a])
+                    {
+                        if(!tilesTriangles[tile].empty())
+                        {
+                            accuTile.init(texParams.nbBand, texSide, getTileHeight(tile));
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        const int nbTiles = static_cast<int>(cameraAtlasIDs.size()) * nbTilesPerAtlas;
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int workId = 0; workId < nbTiles; ++workId)
+        {
+            const int a = workId / nbTilesPerAtlas;
+            const int tile = workId % nbTilesPerAtlas;
+            const AtlasIndex atlasID = cameraAtlasIDs[a];
+            const std::vector<ScorePerTriangle>& atlasContributions = cameraContributions.at(atlasID);
+            AccuPyramid& accuPyramid = tiledOutput ? tiledAtlases.at(atlasID).accuTiles[tile] : accuPyramids.at(atlasID);
+            // first image row of the accumulation buffer
+            const unsigned int rowOffset = tiledOutput ? tile * textureTileRows : 0;
+
+            // texture rows of the tile (inverted Y axis)
+            const int tileMinY = texSide - (tile * textureTileRows + getTileHeight(tile));
+            const int tileMaxY = texSide - tile * textureTileRows;
+
+            //for each frequency band
+            for(int band = 0; band < atlasContributions.size(); ++band)
+            {
+                const ScorePerTriangle& trianglesId = atlasContributions[band];
+
+                // for each triangle overlapping the tile
+                for(const int ti : atlasesTilesTriangles[a][band][tile])
                 {
                     const unsigned int triangleId = std::get<0>(trianglesId[ti]);
                     const float triangleScore = texParams.useScore ? std::get<1>(trianglesId[ti]) : 1.0f;
                     // retrieve triangle 3D and UV coordinates
                     Point2d triPixs[3];
                     Point3d triPts[3];
-                    auto& triangleUvIds = mesh->trisUvIds[triangleId];
-                    // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
-                    Point2d udimBL;
-                    StaticVector<Point2d>& uvCoords = mesh->uvCoords;
-                    udimBL.x = std::floor(std::min({uvCoords[triangleUvIds[0]].x,
-                                                    uvCoords[triangleUvIds[1]].x,
-                                                    uvCoords[triangleUvIds[2]].x}));
-                    udimBL.y = std::floor(std::min({uvCoords[triangleUvIds[0]].y,
-                                                    uvCoords[triangleUvIds[1]].y,
-                                                    uvCoords[triangleUvIds[2]].y}));
-
+                    Pixel LU, RD;
+                    getTriangleUVBox(triangleId, triPixs, LU, RD);
                     for(int k = 0; k < 3; ++k)
-                    {
-                       const int pointIndex = mesh->tris[triangleId].v[k];
-                       triPts[k] = mesh->pts[pointIndex];                               // 3D coordinates
-                       const int uvPointIndex = triangleUvIds.m[k];
-                       Point2d uv = uvCoords[uvPointIndex];
-                       // UDIM: remap coordinates between [0,1]
-                       uv = uv - udimBL;
-
-                       triPixs[k] = uv * texParams.textureSide;   // UV coordinates
-                    }
+                        triPts[k] = mesh->pts[mesh->tris[triangleId].v[k]]; // 3D coordinates
 
-                    // compute triangle bounding box in pixel indexes
-                    // min values: floor(value)
-                    // max values: ceil(value)
-                    Pixel LU, RD;
-                    LU.x = static_cast<int>(std::floor(std::min({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
-                    LU.y = static_cast<int>(std::floor(std::min({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
-                    RD.x = static_cast<int>(std::ceil(std::max({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
-                    RD.y = static_cast<int>(std::ceil(std::max({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
-
-                    // sanity check: clamp values to [0; textureSide]
-                    int texSide = static_cast<int>(texParams.textureSide);
-                    LU.x = clamp(LU.x, 0, texSide);
-                    LU.y = clamp(LU.y, 0, texSide);
-                    RD.x = clamp(RD.x, 0, texSide);
-                    RD.y = clamp(RD.y, 0, texSide);
-
-                    // iterate over pixels of the triangle's bounding box
-                    for(int y = LU.y; y < RD.y; ++y)
+                    // iterate over pixels of the triangle's bounding box in the tile
+                    for(int y = std::max(LU.y, tileMinY); y < std::min(RD.y, tileMaxY); ++y)
                     {
                        for(int x = LU.x; x < RD.x; ++x)
                        {
@@ -619,7 +1377,7 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                            // remap 'y' to image coordinates system (inverted Y axis)
                            const unsigned int y_ = (texParams.textureSide - 1) - y;
                            // 1D pixel index
-                           unsigned int xyoffset = y_ * texParams.textureSide + x;
+                           unsigned int xyoffset = (y_ - rowOffset) * texParams.textureSide + x;
                            // get 3D coordinates
                            Point3d pt3d = barycentricToCartesian(triPts, barycCoords);
                            // get 2D coordinates in source image
@@ -630,20 +1388,17 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                                continue;
 
                            // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
-                           if (getInterpolateColor(camImg, pixRC.y, pixRC.x) == image::RGBfColor(0.f, 0.f, 0.f))
+                           if (camPyramid->getColor(0, pixRC) == image::RGBfColor(0.f, 0.f, 0.f))
                                continue;
 
                            // Fill the accumulated pyramid for this pixel
                            // each frequency band also contributes to lower frequencies (higher band indexes)
-                           AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
-                           for(std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
+                           for(std::size_t bandContrib = band; bandContrib < texParams.nbBand; ++bandContrib)
                            {
-                               int downscaleCoef = std::pow(texParams.multiBandDownscale, bandContrib);
                                AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
 
                                // fill the accumulated color map for this pixel
-                               const auto pixDownscaled = pixRC / downscaleCoef;
-                               accuImage.img(xyoffset) += getInterpolateColor(pyramidL[bandContrib], pixDownscaled.y, pixDownscaled.x) * triangleScore;
+                               accuImage.img(xyoffset) += camPyramid->getColor(bandContrib + 1, pixRC) * triangleScore;
                                accuImage.imgCount[xyoffset] += triangleScore;
                            }
                        }
@@ -651,6 +1406,31 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                 }
             }
         }
+
+        // fuse and write the tiles completed by this camera
+        if(tiledOutput)
+        {
+            for(const AtlasIndex atlasID : cameraAtlasIDs)
+            {
+                TiledAtlas& tiledAtlas = tiledAtlases.at(atlasID);
+                for(int tile = 0; tile < nbTilesPerAtlas; ++tile)
+                {
+                    if(tiledAtlas.lastCamIds[tile] == camId)
+                        fuseTile(tiledAtlas, tile);
+                }
+                writeReadyTiles(tiledAtlas);
+            }
+        }
+    }
+
+    if(tiledOutput)
+    {
+        for(const auto& tiledAtlasIt : tiledAtlases)
+        {
+            if(tiledAtlasIt.second.writer)
+                ALICEVISION_THROW_ERROR("Texture " << tiledAtlasIt.first + 1 << ": " << tiledAtlasIt.second.nbWritten << "/" << nbTilesPerAtlas << " tiles written.");
+        }
+        return;
     }
 
     //calculate atlas texture in the first level of the pyramid (avoid creating a new buffer)
@@ -697,27 +1477,7 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 #endif
 
         ALICEVISION_LOG_INFO("  - Computing final (average) color.");
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
-        {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
-            {
-                unsigned int xyoffset = yoffset + xp;
-
-                // If the imgCount is valid on the first band, it will be valid on all the other bands
-                if(atlasTexture.imgCount[xyoffset] == 0)
-                    continue;
-
-                atlasTexture.img(xyoffset) /= atlasTexture.imgCount[xyoffset];
-                atlasTexture.imgCount[xyoffset] = 1;
-
-                for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasLevelTexture.img(xyoffset) /= atlasLevelTexture.imgCount[xyoffset];
-                }
-            }
-        }
+        averageAccuPyramid(accuPyramid);
 
 #if TEXTURING_MBB_DEBUG
         {
@@ -732,19 +1492,7 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 #endif
 
         // Fuse frequency bands into the first buffer, calculate final texture
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
-        {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
-            {
-                unsigned int xyoffset = yoffset + xp;
-                for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasTexture.img(xyoffset) += atlasLevelTexture.img(xyoffset);
-                }
-            }
-        }
+        fuseAccuPyramidBands(accuPyramid);
         writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
     }
 }
@@ -779,97 +1527,7 @@ void Texturing::writeTexture(AccuImage& atlasTexture, const std::size_t atlasID,
     {
         const unsigned int padding = texParams.padding * 3;
         ALICEVISION_LOG_INFO("  - Edge padding (" << padding << " pixels).");
-
-        // Init valid values to 1
-        for(unsigned int y = 0; y < outTextureSide; ++y)
-        {
-            unsigned int yoffset = y * outTextureSide;
-            for(unsigned int x = 0; x < outTextureSide; ++x)
-            {
-                unsigned int xyoffset = yoffset + x;
-                if(atlasTexture.imgCount[xyoffset] > 0)
-                    atlasTexture.imgCount[xyoffset] = 1;
-            }
-        }
-
-        //up-left to bottom-right
-        for(unsigned int y = 1; y < outTextureSide-1; ++y)
-        {
-            unsigned int yoffset = y * outTextureSide;
-            for(unsigned int x = 1; x < outTextureSide-1; ++x)
-            {
-                unsigned int xyoffset = yoffset + x;
-                if(atlasTexture.imgCount[xyoffset] > 0)
-                    continue;
-
-                const int upCount = atlasTexture.imgCount[xyoffset - outTextureSide];
-                const int leftCount = atlasTexture.imgCount[xyoffset - 1];
-                //if pixel on the edge of a chart
-                if(leftCount > 0)
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - 1);
-                    atlasTexture.imgCount[xyoffset] = - 1;
-                }
-                else if(upCount > 0)
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - outTextureSide);
-                    atlasTexture.imgCount[xyoffset] = - 1;
-                }
-                //
-                else if (leftCount < 0 && - leftCount < padding && (upCount == 0 || leftCount > upCount))
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - 1);
-                    atlasTexture.imgCount[xyoffset] = leftCount - 1;
-                }
-                else if (upCount < 0 && - upCount < padding)
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset - outTextureSide);
-                    atlasTexture.imgCount[xyoffset] = upCount - 1;
-                }
-            }
-        }
-
-        //bottom-right to up-left
-        for(unsigned int y = 1; y < outTextureSide-1; ++y)
-        {
-            unsigned int yoffset = (outTextureSide - 1 - y) * outTextureSide;
-            for(unsigned int x = 1; x < outTextureSide-1; ++x)
-            {
-                unsigned int xyoffset = yoffset + (outTextureSide - 1 - x);
-                if(atlasTexture.imgCount[xyoffset] > 0)
-                    continue;
-
-                const int upCount = atlasTexture.imgCount[xyoffset - outTextureSide];
-                const int downCount = atlasTexture.imgCount[xyoffset + outTextureSide];
-                const int rightCount = atlasTexture.imgCount[xyoffset + 1];
-                const int leftCount = atlasTexture.imgCount[xyoffset - 1];
-                if(rightCount > 0)
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + 1);
-                    atlasTexture.imgCount[xyoffset] = - 1;
-                }
-                else if(downCount > 0)
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + outTextureSide);
-                    atlasTexture.imgCount[xyoffset] = - 1;
-                }
-                else if ((rightCount < 0 && - rightCount < padding) &&
-                         (leftCount == 0 || rightCount > leftCount) &&
-                         (downCount == 0 || rightCount >= downCount)
-                         )
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + 1);
-                    atlasTexture.imgCount[xyoffset] = rightCount - 1;
-                }
-                else if ((downCount < 0 && - downCount < padding) &&
-                         (upCount == 0 || downCount > upCount)
-                         )
-                {
-                    atlasTexture.img(xyoffset) = atlasTexture.img(xyoffset + outTextureSide);
-                    atlasTexture.imgCount[xyoffset] = downCount - 1;
-                }
-            }
-        }
+        edgePadding(atlasTexture, outTextureSide, outTextureSide, padding);
     }
 
     // texture holes filling
@@ -964,7 +1622,8 @@ void Texturing::loadWithMaterial(const std::string& filepath, bool flipNormals)
 }
 
 void Texturing::remapVisibilities(EVisibilityRemappingMethod remappingMethod,
-                                  const mvsUtils::MultiViewParams& mp, const Mesh& refMesh)
+                                  const mvsUtils::MultiViewParams& mp, const Mesh& refMesh,
+                                  const MeshKdTree* refKdTree)
 {
     if(refMesh.pointsVisibilities.empty() &&
        (remappingMethod & mesh::EVisibilityRemappingMethod::Pull ||
@@ -976,7 +1635,10 @@ void Texturing::remapVisibilities(EVisibilityRemappingMethod remappingMethod,
     // remap visibilities from the reference onto the mesh
     if(remappingMethod & mesh::EVisibilityRemappingMethod::Pull)
     {
-        remapMeshVisibilities_pullVerticesVisibility(refMesh, *mesh);
+        if(refKdTree)
+            remapMeshVisibilities_pullVerticesVisibility(refMesh, *refKdTree, *mesh);
+        else
+            remapMeshVisibilities_pullVerticesVisibility(refMesh, *mesh);
     }
     if(remappingMethod & mesh::EVisibilityRemappingMethod::Push)
     {
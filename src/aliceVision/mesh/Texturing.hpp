@@ -8,6 +8,7 @@
 
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/image/io.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
@@ -16,10 +17,14 @@
 #include <aliceVision/mesh/Material.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 #include <aliceVision/mesh/meshVisibility.hpp>
+#include <aliceVision/mesh/UVAtlas.hpp>
 #include <aliceVision/stl/bitmask.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include <array>
+#include <map>
+
 namespace bfs = boost::filesystem;
 
 namespace GEO {
@@ -79,6 +84,7 @@ struct TexturingParams
     bool useUDIM = true;
     bool fillHoles = false;
     unsigned int padding = 5;
+    EChartPackingMethod chartPackingMethod = EChartPackingMethod::BinaryTree; //< charts packing for the Basic unwrap method
 
     // Multi-band blending
     unsigned int nbBand = 4;
@@ -90,6 +96,8 @@ struct TexturingParams
     double angleHardThreshold = 90.0; //< 0.0 to disable angle hard threshold filtering
 
     image::EImageFileType textureFileType = image::EImageFileType::NONE;
+    bool tiledOutput = false; //< accumulate and write the textures by tiles (EXR/TIFF only), only the active tiles are in memory
+    bool mipmaps = false;     //< write the mip levels in the tiled textures
     image::EImageColorSpace workingColorSpace = image::EImageColorSpace::SRGB; // color space for the texturing internal computation
     image::EImageColorSpace outputColorSpace = image::EImageColorSpace::AUTO; // output file color space
     mvsUtils::ECorrectEV correctEV{mvsUtils::ECorrectEV::NO_CORRECTION};
@@ -133,10 +141,10 @@ public:
      * @param[in] remappingMethod the remapping method
      * @param[in] mp multiview scene params
      * @param[in] refMesh the reference mesh
-     * @param[in] refPointsVisibilities the reference visibilities
+     * @param[in] refKdTree the kd-tree of the reference mesh vertices to reuse, built if null and needed
      */
     void remapVisibilities(EVisibilityRemappingMethod remappingMethod, const mvsUtils::MultiViewParams& mp,
-                           const Mesh& refMesh);
+                           const Mesh& refMesh, const MeshKdTree* refKdTree = nullptr);
 
     /**
      * @brief Replace inner mesh with the mesh loaded from 'otherMeshPath'
@@ -197,6 +205,56 @@ public:
         }
     };
 
+    /// list of <triangleId, score>
+    using ScorePerTriangle = std::vector<std::pair<unsigned int, float>>;
+    /// per atlas, the triangles contributions of a camera per frequency band
+    using CameraContributions = std::map<std::size_t, std::vector<ScorePerTriangle>>;
+
+    /**
+     * @brief Cameras pyramids stored on disk between the atlases chunks, cropped to the regions used by the next chunks.
+     * @note The folder is removed with the cache, also when the texturing throws.
+     */
+    struct PyramidsDiskCache
+    {
+        bfs::path folder;
+        std::vector<std::array<int, 4>> regions; //< per camera, region [xMin, yMin, xMax, yMax) used by the next chunks
+        std::vector<bool> isStored;              //< per camera, whether its pyramid is stored in the folder
+
+        explicit PyramidsDiskCache(const bfs::path& cacheFolder)
+            : folder(cacheFolder)
+        {
+            bfs::create_directories(folder);
+        }
+
+        ~PyramidsDiskCache()
+        {
+            boost::system::error_code ec;
+            bfs::remove_all(folder, ec);
+        }
+
+        PyramidsDiskCache(const PyramidsDiskCache&) = delete;
+        PyramidsDiskCache& operator=(const PyramidsDiskCache&) = delete;
+    };
+
+    /// Whether the textures can be accumulated and written by tiles with the current parameters
+    bool isTiledOutputAvailable(image::EImageFileType textureFileType) const;
+
+    /// Get the triangle pixel coordinates in its atlas texture and its bounding box [LU, RD) clamped to the texture
+    void getTriangleUVBox(unsigned int triangleId, Point2d triPixs[3], Pixel& LU, Pixel& RD) const;
+
+    /**
+     * @brief Get the range of cameras contributing to each rows tile of the atlases.
+     * @param[in] contributionsPerCamera the selected contributions per camera
+     * @param[out] out_tilesCamerasRange per atlas, per tile (in image rows order), the first and last camera indexes
+     *             contributing to the tile or (-1, -1)
+     */
+    void computeTilesCamerasRange(const std::vector<CameraContributions>& contributionsPerCamera,
+                                  std::map<std::size_t, std::vector<std::pair<int, int>>>& out_tilesCamerasRange) const;
+
+    /// Select the best cameras for the triangles of the given atlases, stored per camera
+    void computeContributionsPerCamera(const mvsUtils::MultiViewParams& mp, const std::vector<size_t>& atlasIDs,
+                                       std::vector<CameraContributions>& out_contributionsPerCamera) const;
+
     /// Generate texture files for all texture atlases
     void generateTextures(const mvsUtils::MultiViewParams& mp,
                           const bfs::path &outPath,
@@ -210,6 +268,24 @@ public:
                                 const bfs::path &outPath,
                                 image::EImageFileType textureFileType = image::EImageFileType::PNG);
 
+    /**
+     * @brief Generate texture files for the given sub-set of texture atlases from the selected contributions.
+     *
+     * The next camera is loaded and decomposed in frequency bands by a prefetch thread while the current one is splatted.
+     * With the tiled output, each rows tile of the atlases is fused and written as soon as its last contributing
+     * camera has been splatted, so only the active tiles are in memory.
+     *
+     * @param[in,out] pyramidsCache if not null, the pyramids of the cameras used by the next chunks are stored in it
+     *                and the stored pyramids are used instead of loading the images again
+     */
+    void generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
+                                const std::vector<size_t>& atlasIDs,
+                                const std::vector<CameraContributions>& contributionsPerCamera,
+                                mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
+                                PyramidsDiskCache* pyramidsCache,
+                                const bfs::path& outPath,
+                                image::EImageFileType textureFileType);
+
     void generateNormalAndHeightMaps(const mvsUtils::MultiViewParams& mp, const Mesh& denseMesh,
                                      const bfs::path& outPath, const mesh::BumpMappingParams& bumpMappingParams);
 
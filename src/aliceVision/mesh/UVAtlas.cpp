@@ -5,17 +5,79 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "UVAtlas.hpp"
+#include "SkylinePacker.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/algorithm/string/case_conv.hpp>
 
 #include <iostream>
+#include <limits>
+#include <tuple>
 
 namespace aliceVision {
 namespace mesh {
 
+EChartPackingMethod EChartPackingMethod_stringToEnum(const std::string& method)
+{
+    std::string m = method;
+    boost::to_lower(m);
+
+    if(m == "binarytree")
+        return EChartPackingMethod::BinaryTree;
+    if(m == "skyline")
+        return EChartPackingMethod::Skyline;
+    throw std::out_of_range("Invalid chart packing method " + method);
+}
+
+std::string EChartPackingMethod_enumToString(EChartPackingMethod method)
+{
+    switch(method)
+    {
+    case EChartPackingMethod::BinaryTree:
+        return "BinaryTree";
+    case EChartPackingMethod::Skyline:
+        return "Skyline";
+    }
+    throw std::out_of_range("Unrecognized EChartPackingMethod");
+}
+
+std::ostream& operator<<(std::ostream& os, EChartPackingMethod method)
+{
+    return os << EChartPackingMethod_enumToString(method);
+}
+
+std::istream& operator>>(std::istream& in, EChartPackingMethod& method)
+{
+    std::string token;
+    in >> token;
+    method = EChartPackingMethod_stringToEnum(token);
+    return in;
+}
+
+namespace {
+
+/// Mesh edge (sorted vertex indexes) of a triangle
+struct TriangleEdge
+{
+    int a;
+    int b;
+    int triangleID;
+    bool operator<(const TriangleEdge& other) const
+    {
+        return std::tie(a, b, triangleID) < std::tie(other.a, other.b, other.triangleID);
+    }
+    bool sameEdge(const TriangleEdge& other) const { return a == other.a && b == other.b; }
+};
+
+} // namespace
+
 UVAtlas::UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
-                                 unsigned int textureSide, unsigned int gutterSize)
+                                 unsigned int textureSide, unsigned int gutterSize,
+                                 EChartPackingMethod packingMethod)
     : _textureSide(textureSide)
     , _gutterSize(gutterSize)
+    , _packingMethod(packingMethod)
     , _mesh(mesh)
 {
     std::vector<Chart> charts;
@@ -50,7 +112,7 @@ void UVAtlas::createCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams
         std::vector<std::pair<float, int>> commonCameraIDs;
 
         // project triangle in all cams
-        auto cameras = trisCams[i];
+        const auto& cameras = trisCams[i];
         for(int c = 0; c < cameras.size(); ++c)
         {
             int cameraID = cameras[c];
@@ -64,7 +126,7 @@ void UVAtlas::createCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams
             commonCameraIDs.emplace_back(area, cameraID);
         }
         // sort cameras by score
-        std::sort(commonCameraIDs.begin(), commonCameraIDs.end(), std::greater<std::pair<int, int>>());
+        std::sort(commonCameraIDs.begin(), commonCameraIDs.end(), std::greater<std::pair<float, int>>());
 
         // Declare into the charts only the best ones
         Chart& chart = charts[i];
@@ -102,52 +164,34 @@ void UVAtlas::packCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams&
         return cid;
     };
 
-    // list mesh edges (with duplicates)
-    std::vector<Edge> alledges;
+    // list mesh edges (with duplicates), sorted by vertices then triangle
+    std::vector<TriangleEdge> alledges(_mesh.tris.size() * 3);
+    #pragma omp parallel for
     for(int i = 0; i < _mesh.tris.size(); ++i)
     {
-        int a = _mesh.tris[i].v[0];
-        int b = _mesh.tris[i].v[1];
-        int c = _mesh.tris[i].v[2];
-        Edge e1;
-        e1.pointIDs = std::make_pair(std::min(a, b), std::max(a, b));
-        e1.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e1);
-        Edge e2;
-        e2.pointIDs = std::make_pair(std::min(b, c), std::max(b, c));
-        e2.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e2);
-        Edge e3;
-        e3.pointIDs = std::make_pair(std::min(c, a), std::max(c, a));
-        e3.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e3);
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = _mesh.tris[i].v[k];
+            const int b = _mesh.tris[i].v[(k + 1) % 3];
+            alledges[i * 3 + k] = {std::min(a, b), std::max(a, b), i};
+        }
     }
     std::sort(alledges.begin(), alledges.end());
 
-    // merge edges (no duplicate)
-    std::vector<Edge> edges;
-    auto eit = alledges.begin() + 1;
-    while(eit != alledges.end())
+    // pairs of triangles sharing an edge
+    std::vector<std::pair<int, int>> edges;
+    for(std::size_t i = 1; i < alledges.size(); ++i)
     {
-        auto& a = *(eit-1);
-        auto& b = *eit;
-        if(a == b)
-        {
-            a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
-            sort(a.triangleIDs.begin(), a.triangleIDs.end());
-            edges.push_back(a);
-        }
-        ++eit;
+        if(alledges[i - 1].sameEdge(alledges[i]))
+            edges.emplace_back(alledges[i - 1].triangleID, alledges[i].triangleID);
     }
-    alledges.clear();
+    std::vector<TriangleEdge>().swap(alledges);
 
     // merge charts
-    for(auto& e : edges)
+    for(const auto& e : edges)
     {
-        if(e.triangleIDs.size() != 2)
-            continue;
-        int chartIDA = findChart(e.triangleIDs[0]);
-        int chartIDB = findChart(e.triangleIDs[1]);
+        int chartIDA = findChart(e.first);
+        int chartIDB = findChart(e.second);
         if(chartIDA == chartIDB)
             continue;
         Chart& a = charts[chartIDA];
@@ -187,7 +231,8 @@ void UVAtlas::finalizeCharts(std::vector<Chart>& charts, mvsUtils::MultiViewPara
 {
     ALICEVISION_LOG_INFO("Finalize packed charts (" <<  charts.size() << " charts).");
 
-    #pragma omp parallel for
+    // charts sizes are very unbalanced after merging
+    #pragma omp parallel for schedule(dynamic)
     for(int i = 0; i < charts.size(); ++i)
     {
         auto& chart = charts[i];
@@ -236,8 +281,33 @@ void UVAtlas::finalizeCharts(std::vector<Chart>& charts, mvsUtils::MultiViewPara
 
 void UVAtlas::createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
 {
-    ALICEVISION_LOG_INFO("Creating texture atlases.");
+    ALICEVISION_LOG_INFO("Creating texture atlases (" << EChartPackingMethod_enumToString(_packingMethod) << " packing).");
+    const system::Timer timer;
+
+    if(_packingMethod == EChartPackingMethod::Skyline)
+        createTextureAtlasesSkyline(charts);
+    else
+        createTextureAtlasesBinaryTree(charts);
 
+    const double elapsed = timer.elapsed();
+
+    // ratio of the atlases area covered by the charts (without gutter)
+    const double atlasArea = double(_textureSide) * _textureSide;
+    double totalOccupancy = 0.0;
+    for(std::size_t a = 0; a < _atlases.size(); ++a)
+    {
+        double chartsArea = 0.0;
+        for(const Chart& chart : _atlases[a])
+            chartsArea += double(chart.targetWidth()) * chart.targetHeight();
+        ALICEVISION_LOG_DEBUG("\t- texture atlas " << a + 1 << ": " << _atlases[a].size() << " charts, occupancy: " << chartsArea / atlasArea);
+        totalOccupancy += chartsArea / atlasArea;
+    }
+    ALICEVISION_LOG_INFO(charts.size() << " charts packed in " << _atlases.size() << " texture atlases in " << elapsed << " s, "
+                         << "mean occupancy: " << (_atlases.empty() ? 0.0 : totalOccupancy / _atlases.size()) << ".");
+}
+
+void UVAtlas::createTextureAtlasesBinaryTree(std::vector<Chart>& charts)
+{
     // sort charts by size, descending
     std::sort(charts.begin(), charts.end(), [](const Chart& a, const Chart& b)
     {
@@ -299,6 +369,41 @@ void UVAtlas::createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiVi
     }
 }
 
+void UVAtlas::createTextureAtlasesSkyline(std::vector<Chart>& charts)
+{
+    // usable atlas side, as for the binary tree packing
+    const int packingSide = _textureSide - 1;
+    const double expectedOccupancy = 0.85;
+
+    // pack the charts with their gutter
+    std::vector<Pixel> rectSizes;
+    rectSizes.reserve(charts.size());
+    for(const Chart& chart : charts)
+        rectSizes.emplace_back(chart.targetWidth() + _gutterSize * 2, chart.targetHeight() + _gutterSize * 2);
+
+    std::vector<Pixel> positions;
+    const std::vector<std::vector<int>> atlasesChartIds = packSkyline(rectSizes, packingSide, expectedOccupancy, positions);
+
+    // store the final positions
+    for(std::size_t chartId = 0; chartId < charts.size(); ++chartId)
+    {
+        charts[chartId].targetLU = positions[chartId];
+        charts[chartId].targetLU.x += _gutterSize;
+        charts[chartId].targetLU.y += _gutterSize;
+    }
+
+    // store the texture atlases
+    for(std::size_t atlasId = 0; atlasId < atlasesChartIds.size(); ++atlasId)
+    {
+        std::vector<Chart> atlas;
+        atlas.reserve(atlasesChartIds[atlasId].size());
+        for(const int chartId : atlasesChartIds[atlasId])
+            atlas.emplace_back(charts[chartId]);
+        ALICEVISION_LOG_INFO("\t- texture atlas " << atlasId + 1 << ": filled with " << atlas.size() << " charts.");
+        _atlases.emplace_back(std::move(atlas));
+    }
+}
+
 void UVAtlas::ChartRect::clear()
 {
     if(child[0])
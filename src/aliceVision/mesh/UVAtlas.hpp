@@ -9,22 +9,42 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 
+#include <iostream>
+#include <string>
 #include <vector>
 
 namespace aliceVision {
 namespace mesh {
 
+/**
+ * @brief Available methods to pack the charts in the texture atlases
+ */
+enum class EChartPackingMethod
+{
+    BinaryTree = 0, //< charts inserted one by one in a binary tree of free rectangles
+    Skyline = 1     //< charts sorted by height, atlases filled concurrently with a skyline packer
+};
+
+/**
+ * @brief returns the EChartPackingMethod enum from a string.
+ * @param[in] method the input string.
+ * @return the associated EChartPackingMethod enum.
+ */
+EChartPackingMethod EChartPackingMethod_stringToEnum(const std::string& method);
+
+/**
+ * @brief converts an EChartPackingMethod enum to a string.
+ * @param[in] method the EChartPackingMethod enum to convert.
+ * @return the string associated to the EChartPackingMethod enum.
+ */
+std::string EChartPackingMethod_enumToString(EChartPackingMethod method);
+
+std::istream& operator>>(std::istream& in, EChartPackingMethod& method);
+std::ostream& operator<<(std::ostream& os, EChartPackingMethod method);
+
 class UVAtlas
 {
 public:
-    struct Edge
-    {
-        std::pair<int, int> pointIDs;
-        std::vector<int> triangleIDs;
-        bool operator<(const Edge& other) const { return pointIDs < other.pointIDs; }
-        bool operator==(const Edge& other) const { return pointIDs == other.pointIDs; }
-    };
-
     struct Chart
     {
         int refCameraID = -1;                                   // refCamera, used to project all contained triangles
@@ -58,7 +78,8 @@ public:
 
 public:
     UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
-                    unsigned int textureSide, unsigned int gutterSize);
+                    unsigned int textureSide, unsigned int gutterSize,
+                    EChartPackingMethod packingMethod = EChartPackingMethod::BinaryTree);
 
 public:
     const std::vector<std::vector<Chart>>& atlases() const { return _atlases; }
@@ -72,12 +93,15 @@ private:
     void packCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
     void finalizeCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
     void createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
+    void createTextureAtlasesBinaryTree(std::vector<Chart>& charts);
+    void createTextureAtlasesSkyline(std::vector<Chart>& charts);
 
 private:
     std::vector<std::vector<Chart>> _atlases;
     std::vector<std::vector<int>> _triangleCameraIDs;
     int _textureSide;
     int _gutterSize;
+    EChartPackingMethod _packingMethod;
     const Mesh& _mesh;
 };
 
@@ -0,0 +1,904 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "meshIO.hpp"
+#include "Mesh.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// Size of the blocks read from or written to the files
+constexpr std::size_t ioBlockSize = 16 * 1024 * 1024;
+
+/// Number of lines formatted or parsed by a thread at once in the OBJ files
+constexpr int objLinesBlockSize = 1 << 16;
+
+bool isHostLittleEndian()
+{
+    const std::uint16_t value = 1;
+    unsigned char firstByte;
+    std::memcpy(&firstByte, &value, 1);
+    return firstByte == 1;
+}
+
+/// Drop the vertex indices of the degenerate triangles and set the per-triangle attributes expected from a loaded mesh
+void finalizeLoadedTriangles(const std::vector<Mesh::triangle>& triangles, Mesh& mesh)
+{
+    const int nbPts = mesh.pts.size();
+
+    mesh.tris.reserve(triangles.size());
+    for(const Mesh::triangle& triangle : triangles)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            if(triangle.v[k] < 0 || triangle.v[k] >= nbPts)
+                ALICEVISION_THROW_ERROR("Invalid vertex index " << triangle.v[k] << " in a face, the mesh has " << nbPts << " vertices.");
+        }
+        if(triangle.v[0] == triangle.v[1] || triangle.v[1] == triangle.v[2] || triangle.v[0] == triangle.v[2])
+            continue;
+        mesh.tris.push_back(triangle);
+    }
+
+    // single material and no texture coordinates, as set by the Assimp import
+    mesh.trisMtlIds().assign(mesh.tris.size(), 0);
+    mesh.trisUvIds.resize(mesh.tris.size());
+    mesh.nmtls = mesh.tris.empty() ? 0 : 1;
+}
+
+/// Triangulate a polygon as a fan
+void addPolygon(const std::vector<int>& polygon, std::vector<Mesh::triangle>& triangles)
+{
+    for(std::size_t i = 1; i + 1 < polygon.size(); ++i)
+        triangles.emplace_back(polygon[0], polygon[i], polygon[i + 1]);
+}
+
+// PLY
+
+enum class EPlyType
+{
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64
+};
+
+EPlyType plyTypeFromString(const std::string& type)
+{
+    if(type == "char" || type == "int8")
+        return EPlyType::Int8;
+    if(type == "uchar" || type == "uint8")
+        return EPlyType::UInt8;
+    if(type == "short" || type == "int16")
+        return EPlyType::Int16;
+    if(type == "ushort" || type == "uint16")
+        return EPlyType::UInt16;
+    if(type == "int" || type == "int32")
+        return EPlyType::Int32;
+    if(type == "uint" || type == "uint32")
+        return EPlyType::UInt32;
+    if(type == "float" || type == "float32")
+        return EPlyType::Float32;
+    if(type == "double" || type == "float64")
+        return EPlyType::Float64;
+    ALICEVISION_THROW_ERROR("Unknown PLY property type: " << type);
+}
+
+std::size_t plyTypeSize(EPlyType type)
+{
+    switch(type)
+    {
+        case EPlyType::Int8:
+        case EPlyType::UInt8:
+            return 1;
+        case EPlyType::Int16:
+        case EPlyType::UInt16:
+            return 2;
+        case EPlyType::Int32:
+        case EPlyType::UInt32:
+        case EPlyType::Float32:
+            return 4;
+        case EPlyType::Float64:
+            return 8;
+    }
+    return 0;
+}
+
+bool isPlyTypeFloatingPoint(EPlyType type)
+{
+    return type == EPlyType::Float32 || type == EPlyType::Float64;
+}
+
+template <typename S>
+S fromBytes(const char* bytes)
+{
+    S value;
+    std::memcpy(&value, bytes, sizeof(S));
+    return value;
+}
+
+/// Convert a PLY value to T, swapping its bytes if the file endianness differs from the host one
+template <typename T>
+T readPlyValue(const char* data, EPlyType type, bool swapBytes)
+{
+    char bytes[8];
+    const std::size_t size = plyTypeSize(type);
+    std::memcpy(bytes, data, size);
+    if(swapBytes)
+        std::reverse(bytes, bytes + size);
+
+    switch(type)
+    {
+        case EPlyType::Int8:    return static_cast<T>(fromBytes<std::int8_t>(bytes));
+        case EPlyType::UInt8:   return static_cast<T>(fromBytes<std::uint8_t>(bytes));
+        case EPlyType::Int16:   return static_cast<T>(fromBytes<std::int16_t>(bytes));
+        case EPlyType::UInt16:  return static_cast<T>(fromBytes<std::uint16_t>(bytes));
+        case EPlyType::Int32:   return static_cast<T>(fromBytes<std::int32_t>(bytes));
+        case EPlyType::UInt32:  return static_cast<T>(fromBytes<std::uint32_t>(bytes));
+        case EPlyType::Float32: return static_cast<T>(fromBytes<float>(bytes));
+        case EPlyType::Float64: return static_cast<T>(fromBytes<double>(bytes));
+    }
+    return T();
+}
+
+struct PlyProperty
+{
+    std::string name;
+    EPlyType type = EPlyType::Float32;
+    bool isList = false;
+    EPlyType countType = EPlyType::UInt8;
+};
+
+struct PlyElement
+{
+    std::string name;
+    std::size_t count = 0;
+    std::vector<PlyProperty> properties;
+
+    int findProperty(const std::string& propertyName) const
+    {
+        for(int i = 0; i < properties.size(); ++i)
+        {
+            if(properties[i].name == propertyName)
+                return i;
+        }
+        return -1;
+    }
+
+    bool hasLists() const
+    {
+        return std::any_of(properties.begin(), properties.end(), [](const PlyProperty& p) { return p.isList; });
+    }
+
+    /// Size of an item, only valid without list properties
+    std::size_t itemSize() const
+    {
+        std::size_t size = 0;
+        for(const PlyProperty& p : properties)
+            size += plyTypeSize(p.type);
+        return size;
+    }
+};
+
+/// Whether a vertex property is a texture coordinate or a normal component
+bool isPlyUvOrNormalProperty(const std::string& name)
+{
+    static const std::array<const char*, 11> names = {"s", "t", "u", "v", "texture_s", "texture_t", "texture_u", "texture_v", "nx", "ny", "nz"};
+    return std::any_of(names.begin(), names.end(), [&name](const char* n) { return name == n; });
+}
+
+/**
+ * @brief Buffered reader of the binary part of a PLY file.
+ */
+class PlyStreamReader
+{
+public:
+    PlyStreamReader(std::istream& in, bool swapBytes)
+        : _in(in)
+        , _swapBytes(swapBytes)
+    {}
+
+    bool swapBytes() const { return _swapBytes; }
+
+    /// Get the next n bytes of the file, the pointer is valid until the next call
+    const char* next(std::size_t n)
+    {
+        if(_end - _begin < n)
+        {
+            std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+            _end -= _begin;
+            _begin = 0;
+            if(_buffer.size() < std::max(n, ioBlockSize))
+                _buffer.resize(std::max(n, ioBlockSize));
+            _in.read(_buffer.data() + _end, _buffer.size() - _end);
+            _end += static_cast<std::size_t>(_in.gcount());
+            if(_end < n)
+                ALICEVISION_THROW_ERROR("Unexpected end of PLY file.");
+        }
+        const char* data = _buffer.data() + _begin;
+        _begin += n;
+        return data;
+    }
+
+    template <typename T>
+    T read(EPlyType type)
+    {
+        return readPlyValue<T>(next(plyTypeSize(type)), type, _swapBytes);
+    }
+
+    /// Read the number of values of a list property
+    std::size_t readListCount(const PlyProperty& property)
+    {
+        const std::int64_t count = read<std::int64_t>(property.countType);
+        if(count < 0)
+            ALICEVISION_THROW_ERROR("Invalid PLY list size: " << count);
+        return static_cast<std::size_t>(count);
+    }
+
+    void skip(const PlyProperty& property)
+    {
+        const std::size_t count = property.isList ? readListCount(property) : 1;
+        next(count * plyTypeSize(property.type));
+    }
+
+private:
+    std::istream& _in;
+    bool _swapBytes;
+    std::vector<char> _buffer;
+    std::size_t _begin = 0;
+    std::size_t _end = 0;
+};
+
+/**
+ * @brief Indexes of the vertex properties used by the mesh, -1 if missing.
+ */
+struct PlyVertexLayout
+{
+    int x = -1, y = -1, z = -1;
+    int red = -1, green = -1, blue = -1;
+    int visibilities = -1;
+
+    explicit PlyVertexLayout(const PlyElement& element)
+        : x(element.findProperty("x"))
+        , y(element.findProperty("y"))
+        , z(element.findProperty("z"))
+        , red(element.findProperty("red"))
+        , green(element.findProperty("green"))
+        , blue(element.findProperty("blue"))
+        , visibilities(element.findProperty("visibilities"))
+    {
+        if(x < 0 || y < 0 || z < 0 || element.properties[x].isList || element.properties[y].isList || element.properties[z].isList)
+            ALICEVISION_THROW_ERROR("PLY vertices have no x, y, z coordinates.");
+        if(red < 0 || green < 0 || blue < 0 ||
+           element.properties[red].isList || element.properties[green].isList || element.properties[blue].isList)
+            red = green = blue = -1;
+        if(visibilities >= 0 && !element.properties[visibilities].isList)
+            visibilities = -1;
+    }
+
+    bool hasColors() const { return red >= 0; }
+    bool hasVisibilities() const { return visibilities >= 0; }
+};
+
+/// Set a vertex of the mesh, getValue(i) returns the scalar property i of the vertex as a double
+template <typename GetValue>
+void setPlyVertex(const PlyElement& element, const PlyVertexLayout& layout, int vertexId, const GetValue& getValue, Mesh& mesh)
+{
+    mesh.pts[vertexId] = Point3d(getValue(layout.x), -getValue(layout.y), -getValue(layout.z));
+
+    if(layout.hasColors())
+    {
+        const auto toColor = [&](int i) {
+            const double value = isPlyTypeFloatingPoint(element.properties[i].type) ? getValue(i) * 255.0 : getValue(i);
+            return static_cast<unsigned char>(std::min(std::max(value, 0.0), 255.0));
+        };
+        mesh.colors()[vertexId] = rgb(toColor(layout.red), toColor(layout.green), toColor(layout.blue));
+    }
+}
+
+void readPlyVertices(PlyStreamReader& reader, const PlyElement& element, Mesh& mesh)
+{
+    const PlyVertexLayout layout(element);
+    const bool swapBytes = reader.swapBytes();
+
+    mesh.pts.resize(element.count);
+    if(layout.hasColors())
+        mesh.colors().resize(element.count);
+    if(layout.hasVisibilities())
+        mesh.pointsVisibilities.resize(element.count);
+
+    if(!element.hasLists())
+    {
+        // fixed size vertices: decode blocks of vertices in parallel
+        std::vector<std::size_t> offsets(element.properties.size(), 0);
+        for(std::size_t i = 1; i < offsets.size(); ++i)
+            offsets[i] = offsets[i - 1] + plyTypeSize(element.properties[i - 1].type);
+        const std::size_t itemSize = element.itemSize();
+        const std::size_t blockCount = std::max<std::size_t>(1, ioBlockSize / itemSize);
+
+        for(std::size_t blockBegin = 0; blockBegin < element.count; blockBegin += blockCount)
+        {
+            const int nbVertices = static_cast<int>(std::min(blockCount, element.count - blockBegin));
+            const char* data = reader.next(nbVertices * itemSize);
+
+            #pragma omp parallel for
+            for(int i = 0; i < nbVertices; ++i)
+            {
+                const char* item = data + i * itemSize;
+                const auto getValue = [&](int p) {
+                    return readPlyValue<double>(item + offsets[p], element.properties[p].type, swapBytes);
+                };
+                setPlyVertex(element, layout, static_cast<int>(blockBegin) + i, getValue, mesh);
+            }
+        }
+        return;
+    }
+
+    std::vector<double> values(element.properties.size(), 0.0);
+    const auto getValue = [&values](int p) { return values[p]; };
+    for(std::size_t vertexId = 0; vertexId < element.count; ++vertexId)
+    {
+        for(int p = 0; p < element.properties.size(); ++p)
+        {
+            const PlyProperty& property = element.properties[p];
+            if(p == layout.visibilities)
+            {
+                PointVisibility& visibilities = mesh.pointsVisibilities[vertexId];
+                const std::size_t count = reader.readListCount(property);
+                visibilities.resize(count);
+                for(std::size_t j = 0; j < count; ++j)
+                    visibilities[j] = reader.read<int>(property.type);
+            }
+            else if(property.isList)
+            {
+                reader.skip(property);
+            }
+            else
+            {
+                values[p] = reader.read<double>(property.type);
+            }
+        }
+        setPlyVertex(element, layout, vertexId, getValue, mesh);
+    }
+}
+
+void readPlyFaces(PlyStreamReader& reader, const PlyElement& element, std::vector<Mesh::triangle>& triangles)
+{
+    int indicesProperty = element.findProperty("vertex_indices");
+    if(indicesProperty < 0)
+        indicesProperty = element.findProperty("vertex_index");
+    if(indicesProperty < 0 || !element.properties[indicesProperty].isList)
+        ALICEVISION_THROW_ERROR("PLY faces have no vertex_indices list.");
+
+    triangles.reserve(triangles.size() + element.count);
+
+    std::vector<int> polygon;
+    for(std::size_t faceId = 0; faceId < element.count; ++faceId)
+    {
+        for(int p = 0; p < element.properties.size(); ++p)
+        {
+            const PlyProperty& property = element.properties[p];
+            if(p != indicesProperty)
+            {
+                reader.skip(property);
+                continue;
+            }
+
+            const std::size_t count = reader.readListCount(property);
+            const std::size_t valueSize = plyTypeSize(property.type);
+            const char* data = reader.next(count * valueSize);
+            polygon.resize(count);
+            for(std::size_t j = 0; j < count; ++j)
+                polygon[j] = readPlyValue<int>(data + j * valueSize, property.type, reader.swapBytes());
+            addPolygon(polygon, triangles);
+        }
+    }
+}
+
+/// Buffered writer of binary data
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(std::ostream& out)
+        : _out(out)
+    {
+        _buffer.reserve(ioBlockSize);
+    }
+
+    ~BinaryWriter() { flush(); }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+        if(_buffer.size() >= ioBlockSize)
+            flush();
+    }
+
+    void flush()
+    {
+        _out.write(_buffer.data(), _buffer.size());
+        _buffer.clear();
+    }
+
+private:
+    std::ostream& _out;
+    std::vector<char> _buffer;
+};
+
+// OBJ
+
+/**
+ * @brief Vertices and triangles parsed from a range of lines of an OBJ file.
+ */
+struct ObjRange
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    /// Number of vertices before the range, to resolve the relative indices
+    std::size_t vertexOffset = 0;
+
+    std::vector<Point3d> pts;
+    std::vector<rgb> colors;
+    std::size_t nbColoredPts = 0;
+    std::vector<Mesh::triangle> triangles;
+    /// uses texture coordinates, normals or materials
+    bool unsupported = false;
+    bool invalid = false;
+};
+
+inline const char* skipBlanks(const char* p, const char* lineEnd)
+{
+    while(p < lineEnd && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+inline bool isEndOfData(const char* p, const char* lineEnd)
+{
+    return p >= lineEnd || *p == '\r' || *p == '#';
+}
+
+inline bool isKeyword(const char* p, const char* lineEnd, const char* keyword)
+{
+    const std::size_t length = std::strlen(keyword);
+    return (lineEnd - p) > static_cast<std::ptrdiff_t>(length) && std::strncmp(p, keyword, length) == 0 &&
+           (p[length] == ' ' || p[length] == '\t');
+}
+
+inline const char* getLineEnd(const char* p, const char* end)
+{
+    const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return lineEnd ? lineEnd : end;
+}
+
+std::size_t countObjVertices(const char* begin, const char* end)
+{
+    std::size_t count = 0;
+    for(const char* p = begin; p < end;)
+    {
+        const char* lineEnd = getLineEnd(p, end);
+        if(isKeyword(skipBlanks(p, lineEnd), lineEnd, "v"))
+            ++count;
+        p = lineEnd + 1;
+    }
+    return count;
+}
+
+void parseObjRange(ObjRange& range)
+{
+    std::vector<int> polygon;
+    for(const char* p = range.begin; p < range.end;)
+    {
+        const char* lineEnd = getLineEnd(p, range.end);
+        const char* line = skipBlanks(p, lineEnd);
+        p = lineEnd + 1;
+
+        if(isKeyword(line, lineEnd, "v"))
+        {
+            // position, optionally followed by a color
+            double values[6];
+            int nbValues = 0;
+            const char* c = skipBlanks(line + 1, lineEnd);
+            while(nbValues < 6 && !isEndOfData(c, lineEnd))
+            {
+                char* numberEnd;
+                values[nbValues] = std::strtod(c, &numberEnd);
+                if(numberEnd == c)
+                    break;
+                ++nbValues;
+                c = skipBlanks(numberEnd, lineEnd);
+            }
+            if(nbValues < 3)
+            {
+                range.invalid = true;
+                return;
+            }
+            range.pts.emplace_back(values[0], -values[1], -values[2]);
+            if(nbValues == 6)
+            {
+                const auto toColor = [](double v) { return static_cast<unsigned char>(std::min(std::max(v * 255.0, 0.0), 255.0)); };
+                range.colors.emplace_back(toColor(values[3]), toColor(values[4]), toColor(values[5]));
+                ++range.nbColoredPts;
+            }
+            else
+            {
+                range.colors.emplace_back();
+            }
+        }
+        else if(isKeyword(line, lineEnd, "f"))
+        {
+            // vertex indices, 1-based or relative when negative, texture and normal indices are ignored
+            polygon.clear();
+            const char* c = skipBlanks(line + 1, lineEnd);
+            while(!isEndOfData(c, lineEnd))
+            {
+                char* numberEnd;
+                const long index = std::strtol(c, &numberEnd, 10);
+                if(numberEnd == c || index == 0)
+                {
+                    range.invalid = true;
+                    return;
+                }
+                const long vertexId = index > 0 ? index - 1 : static_cast<long>(range.vertexOffset + range.pts.size()) + index;
+                polygon.push_back(static_cast<int>(vertexId));
+
+                c = numberEnd;
+                while(c < lineEnd && *c != ' ' && *c != '\t' && *c != '\r')
+                    ++c;
+                c = skipBlanks(c, lineEnd);
+            }
+            addPolygon(polygon, range.triangles);
+        }
+        else if(isKeyword(line, lineEnd, "vt") || isKeyword(line, lineEnd, "vn") || isKeyword(line, lineEnd, "vp") ||
+                isKeyword(line, lineEnd, "usemtl") || isKeyword(line, lineEnd, "mtllib"))
+        {
+            range.unsupported = true;
+            return;
+        }
+        // other statements (comments, groups, smoothing, lines and points) are ignored
+    }
+}
+
+/**
+ * @brief Parse the complete lines [begin, end) of an OBJ file by ranges in parallel and append them to the mesh.
+ * @return false if the lines use features that are not supported
+ */
+bool parseObjLines(const char* begin, const char* end, Mesh& mesh, std::vector<Mesh::triangle>& triangles, std::size_t& nbColoredPts)
+{
+    // split at line boundaries
+    const int nbRanges = std::max(1, omp_get_max_threads() * 4);
+    const std::size_t rangeSize = (end - begin) / nbRanges + 1;
+    std::vector<ObjRange> ranges(nbRanges);
+    const char* rangeBegin = begin;
+    for(ObjRange& range : ranges)
+    {
+        range.begin = rangeBegin;
+        range.end = std::min(end, rangeBegin + rangeSize);
+        if(range.end < end)
+            range.end = getLineEnd(range.end, end) + 1;
+        range.end = std::min(end, range.end);
+        rangeBegin = range.end;
+    }
+
+    // count the vertices of each range to resolve the relative indices
+    std::vector<std::size_t> nbVertices(nbRanges);
+    #pragma omp parallel for
+    for(int i = 0; i < nbRanges; ++i)
+        nbVertices[i] = countObjVertices(ranges[i].begin, ranges[i].end);
+
+    ranges[0].vertexOffset = mesh.pts.size();
+    for(int i = 1; i < nbRanges; ++i)
+        ranges[i].vertexOffset = ranges[i - 1].vertexOffset + nbVertices[i - 1];
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < nbRanges; ++i)
+        parseObjRange(ranges[i]);
+
+    for(ObjRange& range : ranges)
+    {
+        if(range.unsupported)
+            return false;
+        if(range.invalid)
+            ALICEVISION_THROW_ERROR("Invalid vertex or face statement in OBJ file.");
+
+        std::copy(range.pts.begin(), range.pts.end(), std::back_inserter(mesh.pts.getDataWritable()));
+        std::copy(range.colors.begin(), range.colors.end(), std::back_inserter(mesh.colors()));
+        nbColoredPts += range.nbColoredPts;
+        std::copy(range.triangles.begin(), range.triangles.end(), std::back_inserter(triangles));
+    }
+    return true;
+}
+
+} // namespace
+
+bool loadPly(const std::string& filepath, Mesh& mesh)
+{
+    std::ifstream in(filepath, std::ios::binary);
+    if(!in)
+        ALICEVISION_THROW_ERROR("Cannot open PLY file: " << filepath);
+
+    // header
+    std::vector<PlyElement> elements;
+    bool swapBytes = false;
+    {
+        std::string line;
+        std::getline(in, line);
+        if(line.compare(0, 3, "ply") != 0)
+            ALICEVISION_THROW_ERROR("Invalid PLY file: " << filepath);
+
+        bool endOfHeader = false;
+        while(!endOfHeader && std::getline(in, line))
+        {
+            std::istringstream iss(line);
+            std::string keyword;
+            iss >> keyword;
+            if(keyword == "format")
+            {
+                std::string format;
+                iss >> format;
+                if(format == "binary_little_endian")
+                    swapBytes = !isHostLittleEndian();
+                else if(format == "binary_big_endian")
+                    swapBytes = isHostLittleEndian();
+                else
+                    return false;
+            }
+            else if(keyword == "element")
+            {
+                PlyElement element;
+                iss >> element.name >> element.count;
+                elements.push_back(element);
+            }
+            else if(keyword == "property")
+            {
+                if(elements.empty())
+                    ALICEVISION_THROW_ERROR("PLY property declared before any element: " << filepath);
+                PlyProperty property;
+                std::string type;
+                iss >> type;
+                if(type == "list")
+                {
+                    std::string countType;
+                    iss >> countType >> type;
+                    property.isList = true;
+                    property.countType = plyTypeFromString(countType);
+                }
+                property.type = plyTypeFromString(type);
+                iss >> property.name;
+                elements.back().properties.push_back(property);
+            }
+            else if(keyword == "end_header")
+            {
+                endOfHeader = true;
+            }
+        }
+        if(!endOfHeader)
+            ALICEVISION_THROW_ERROR("Invalid PLY header: " << filepath);
+    }
+
+    // texture coordinates and normals are handled by Assimp
+    for(const PlyElement& element : elements)
+    {
+        if(element.name == "vertex" && std::any_of(element.properties.begin(), element.properties.end(), [](const PlyProperty& p) {
+               return isPlyUvOrNormalProperty(p.name);
+           }))
+            return false;
+        if(element.name == "face" && element.findProperty("texcoord") >= 0)
+            return false;
+    }
+
+    // data
+    PlyStreamReader reader(in, swapBytes);
+    std::vector<Mesh::triangle> triangles;
+    bool hasVertices = false;
+    for(const PlyElement& element : elements)
+    {
+        if(element.name == "vertex" && !hasVertices)
+        {
+            readPlyVertices(reader, element, mesh);
+            hasVertices = true;
+        }
+        else if(element.name == "face")
+        {
+            readPlyFaces(reader, element, triangles);
+        }
+        else
+        {
+            for(std::size_t i = 0; i < element.count; ++i)
+            {
+                for(const PlyProperty& property : element.properties)
+                    reader.skip(property);
+            }
+        }
+    }
+    if(!hasVertices)
+        ALICEVISION_THROW_ERROR("No vertex in PLY file: " << filepath);
+
+    finalizeLoadedTriangles(triangles, mesh);
+    return true;
+}
+
+void savePly(const std::string& filepath, const Mesh& mesh)
+{
+    std::ofstream out(filepath, std::ios::binary);
+    if(!out)
+        ALICEVISION_THROW_ERROR("Cannot create PLY file: " << filepath);
+
+    const bool hasColors = !mesh.pts.empty() && mesh.colors().size() == mesh.pts.size();
+    const bool hasVisibilities = !mesh.pts.empty() && mesh.pointsVisibilities.size() == mesh.pts.size();
+
+    out << "ply\n"
+        << "format " << (isHostLittleEndian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+        << "comment Created by AliceVision\n"
+        << "element vertex " << mesh.pts.size() << "\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n";
+    if(hasColors)
+    {
+        out << "property uchar red\n"
+            << "property uchar green\n"
+            << "property uchar blue\n";
+    }
+    if(hasVisibilities)
+        out << "property list int int visibilities\n";
+    out << "element face " << mesh.tris.size() << "\n"
+        << "property list uchar int vertex_indices\n"
+        << "end_header\n";
+
+    BinaryWriter writer(out);
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        const Point3d& p = mesh.pts[i];
+        writer.write(static_cast<float>(p.x));
+        writer.write(static_cast<float>(-p.y));
+        writer.write(static_cast<float>(-p.z));
+        if(hasColors)
+        {
+            const rgb& color = mesh.colors()[i];
+            writer.write(color.r);
+            writer.write(color.g);
+            writer.write(color.b);
+        }
+        if(hasVisibilities)
+        {
+            const PointVisibility& visibilities = mesh.pointsVisibilities[i];
+            writer.write(static_cast<std::int32_t>(visibilities.size()));
+            for(const int camId : visibilities)
+                writer.write(static_cast<std::int32_t>(camId));
+        }
+    }
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        writer.write(static_cast<std::uint8_t>(3));
+        for(int k = 0; k < 3; ++k)
+            writer.write(static_cast<std::int32_t>(mesh.tris[i].v[k]));
+    }
+    writer.flush();
+
+    if(!out)
+        ALICEVISION_THROW_ERROR("Failed to write PLY file: " << filepath);
+}
+
+bool loadObj(const std::string& filepath, Mesh& mesh)
+{
+    std::ifstream in(filepath, std::ios::binary);
+    if(!in)
+        ALICEVISION_THROW_ERROR("Cannot open OBJ file: " << filepath);
+
+    Mesh objMesh;
+    std::vector<Mesh::triangle> triangles;
+    std::size_t nbColoredPts = 0;
+
+    // read by blocks, keeping the incomplete last line for the next block
+    std::vector<char> buffer;
+    std::size_t leftover = 0;
+    while(true)
+    {
+        buffer.resize(leftover + ioBlockSize);
+        in.read(buffer.data() + leftover, ioBlockSize);
+        const std::size_t nbRead = static_cast<std::size_t>(in.gcount());
+        const std::size_t size = leftover + nbRead;
+        const bool lastBlock = nbRead < ioBlockSize;
+        if(lastBlock)
+            buffer[size] = '\0';  // the last line may have no end of line, stop the numbers parsing
+
+        std::size_t linesSize = size;
+        if(!lastBlock)
+        {
+            const auto lastLineEnd = std::find(buffer.rbegin() + (buffer.size() - size), buffer.rend(), '\n');
+            if(lastLineEnd == buffer.rend())
+            {
+                // no complete line in the block
+                leftover = size;
+                continue;
+            }
+            linesSize = buffer.rend() - lastLineEnd;
+        }
+
+        if(!parseObjLines(buffer.data(), buffer.data() + linesSize, objMesh, triangles, nbColoredPts))
+            return false;
+
+        leftover = size - linesSize;
+        std::memmove(buffer.data(), buffer.data() + linesSize, leftover);
+        if(lastBlock)
+            break;
+    }
+
+    mesh.pts.swap(objMesh.pts);
+    if(nbColoredPts == mesh.pts.size() && !mesh.pts.empty())
+        mesh.colors().swap(objMesh.colors());
+    finalizeLoadedTriangles(triangles, mesh);
+    return true;
+}
+
+void saveObj(const std::string& filepath, const Mesh& mesh)
+{
+    std::ofstream out(filepath, std::ios::binary);
+    if(!out)
+        ALICEVISION_THROW_ERROR("Cannot create OBJ file: " << filepath);
+
+    out << "# Created by AliceVision\n";
+
+    // format blocks of lines in parallel and write them in order
+    const int nbBlocksPerBatch = std::max(1, omp_get_max_threads() * 2);
+    std::vector<std::string> blocks(nbBlocksPerBatch);
+
+    const auto writeLines = [&](int nbLines, const auto& formatLine) {
+        for(int batchBegin = 0; batchBegin < nbLines; batchBegin += nbBlocksPerBatch * objLinesBlockSize)
+        {
+            #pragma omp parallel for
+            for(int b = 0; b < nbBlocksPerBatch; ++b)
+            {
+                std::string& block = blocks[b];
+                block.clear();
+                const int begin = batchBegin + b * objLinesBlockSize;
+                const int end = std::min(begin + objLinesBlockSize, nbLines);
+                char line[128];
+                for(int i = begin; i < end; ++i)
+                    block.append(line, formatLine(i, line, sizeof(line)));
+            }
+            for(const std::string& block : blocks)
+                out.write(block.data(), block.size());
+        }
+    };
+
+    // same precision as the Assimp export
+    writeLines(mesh.pts.size(), [&](int i, char* line, std::size_t lineSize) {
+        const Point3d& p = mesh.pts[i];
+        return std::snprintf(line, lineSize, "v %.9g %.9g %.9g\n", static_cast<float>(p.x), static_cast<float>(-p.y), static_cast<float>(-p.z));
+    });
+    writeLines(mesh.tris.size(), [&](int i, char* line, std::size_t lineSize) {
+        const Mesh::triangle& t = mesh.tris[i];
+        return std::snprintf(line, lineSize, "f %d %d %d\n", t.v[0] + 1, t.v[1] + 1, t.v[2] + 1);
+    });
+
+    if(!out)
+        ALICEVISION_THROW_ERROR("Failed to write OBJ file: " << filepath);
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,80 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <string>
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+/*
+ * Native mesh readers and writers, used by Mesh::load and Mesh::save for the PLY and OBJ
+ * files without materials, in place of Assimp.
+ *
+ * They follow the same axis convention as the Assimp import/export: the Y and Z coordinates
+ * are negated in the files.
+ *
+ * Differences with the Assimp import:
+ * - vertices are kept in the file order, identical vertices are not joined
+ *   (no aiProcess_JoinIdenticalVertices) and unreferenced vertices are kept,
+ *   so vertex indices match the file (e.g. for per-vertex data computed on the saved mesh)
+ * - only the triangles with repeated vertex indices are dropped as degenerate,
+ *   distinct vertices with the same position are kept
+ * - PLY visibilities are loaded
+ * A mesh saved by savePly/saveObj without duplicated or unreferenced vertices is loaded
+ * with the same triangles by both.
+ */
+
+/**
+ * @brief Load a binary PLY file (little or big endian) into the mesh.
+ *
+ * Reads the vertex positions, the optional vertex colors (red, green, blue) and visibilities
+ * (a list of camera ids written by savePly), and the faces (triangulated as fans).
+ * Degenerate triangles are skipped, unknown elements and properties are ignored.
+ *
+ * @param[in] filepath the PLY file path
+ * @param[out] mesh the loaded mesh, it should be empty
+ * @return false if the file is not a binary PLY or has texture coordinates (vertex s, t, u, v,
+ *         texture_s, texture_t, texture_u, texture_v or face texcoord) or normals (nx, ny, nz),
+ *         which are handled by Assimp, the mesh is not modified in this case
+ */
+bool loadPly(const std::string& filepath, Mesh& mesh);
+
+/**
+ * @brief Save the mesh to a binary PLY file, with the host endianness.
+ *
+ * The vertex colors and visibilities are written if they are defined for all the vertices.
+ *
+ * @param[in] filepath the PLY file path
+ * @param[in] mesh the mesh to save
+ */
+void savePly(const std::string& filepath, const Mesh& mesh);
+
+/**
+ * @brief Load an OBJ file into the mesh, parsing it by large chunks in parallel.
+ *
+ * Reads the vertex positions, the optional vertex colors and the faces (triangulated as fans).
+ * Degenerate triangles are skipped.
+ *
+ * @param[in] filepath the OBJ file path
+ * @param[out] mesh the loaded mesh, it should be empty
+ * @return false if the file uses texture coordinates, normals or materials, which are handled
+ *         by Assimp, the mesh is not modified in this case
+ */
+bool loadObj(const std::string& filepath, Mesh& mesh);
+
+/**
+ * @brief Save the mesh vertices and triangles to an OBJ file, formatting the lines in parallel.
+ * @param[in] filepath the OBJ file path
+ * @param[in] mesh the mesh to save
+ */
+void saveObj(const std::string& filepath, const Mesh& mesh);
+
+} // namespace mesh
+} // namespace aliceVision
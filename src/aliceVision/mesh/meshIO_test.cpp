@@ -0,0 +1,280 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/meshIO.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshIO
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+namespace fs = boost::filesystem;
+
+namespace {
+
+using TrianglePositions = std::array<std::array<float, 3>, 3>;
+
+/**
+ * @brief Curved grid of n x n vertices with colors and visibilities.
+ */
+Mesh createMesh(int n)
+{
+    Mesh mesh;
+    for(int y = 0; y < n; ++y)
+    {
+        for(int x = 0; x < n; ++x)
+        {
+            mesh.pts.push_back(Point3d(0.1 * x, 0.2 * y - 0.5, 0.01 * x * y + 0.123));
+            mesh.colors().push_back(rgb(10 * x, 10 * y, 255 - x - y));
+
+            PointVisibility visibility;
+            for(int c = 0; c < (x + y) % 4; ++c)
+                visibility.push_back(x + c);
+            mesh.pointsVisibilities.push_back(visibility);
+        }
+    }
+    for(int y = 0; y < n - 1; ++y)
+    {
+        for(int x = 0; x < n - 1; ++x)
+        {
+            const int v = y * n + x;
+            mesh.tris.push_back(Mesh::triangle(v, v + 1, v + n + 1));
+            mesh.tris.push_back(Mesh::triangle(v, v + n + 1, v + n));
+        }
+    }
+    return mesh;
+}
+
+/**
+ * @brief Triangles as single precision positions independent of the vertices order,
+ *        each triangle starting from its smallest vertex to keep its orientation.
+ */
+std::vector<TrianglePositions> getTrianglePositions(const Mesh& mesh)
+{
+    std::vector<TrianglePositions> triangles;
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        TrianglePositions t;
+        for(int k = 0; k < 3; ++k)
+        {
+            const Point3d& p = mesh.pts[mesh.tris[i].v[k]];
+            t[k] = {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)};
+        }
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+/**
+ * @brief Check a mesh loaded by the native readers against the saved mesh.
+ */
+void checkNativeLoad(const Mesh& loaded, const Mesh& mesh, bool withColors, bool withVisibilities)
+{
+    BOOST_REQUIRE_EQUAL(loaded.pts.size(), mesh.pts.size());
+    BOOST_REQUIRE_EQUAL(loaded.tris.size(), mesh.tris.size());
+
+    // same vertex order, positions stored in single precision
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(static_cast<float>(loaded.pts[i].x), static_cast<float>(mesh.pts[i].x));
+        BOOST_CHECK_EQUAL(static_cast<float>(loaded.pts[i].y), static_cast<float>(mesh.pts[i].y));
+        BOOST_CHECK_EQUAL(static_cast<float>(loaded.pts[i].z), static_cast<float>(mesh.pts[i].z));
+    }
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            BOOST_CHECK_EQUAL(loaded.tris[i].v[k], mesh.tris[i].v[k]);
+    }
+
+    BOOST_REQUIRE_EQUAL(loaded.colors().size(), withColors ? mesh.pts.size() : 0);
+    for(std::size_t i = 0; i < loaded.colors().size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(int(loaded.colors()[i].r), int(mesh.colors()[i].r));
+        BOOST_CHECK_EQUAL(int(loaded.colors()[i].g), int(mesh.colors()[i].g));
+        BOOST_CHECK_EQUAL(int(loaded.colors()[i].b), int(mesh.colors()[i].b));
+    }
+
+    BOOST_REQUIRE_EQUAL(loaded.pointsVisibilities.size(), withVisibilities ? mesh.pts.size() : 0);
+    for(int i = 0; i < loaded.pointsVisibilities.size(); ++i)
+        BOOST_CHECK(loaded.pointsVisibilities[i].getData() == mesh.pointsVisibilities[i].getData());
+
+    // single material and no texture coordinates, as set by the Assimp import
+    BOOST_CHECK_EQUAL(loaded.nmtls, 1);
+    BOOST_CHECK_EQUAL(loaded.trisMtlIds().size(), mesh.tris.size());
+    BOOST_CHECK(loaded.uvCoords.empty());
+}
+
+/**
+ * @brief Load the file with the native reader and with Assimp, both should give the triangles of the saved mesh.
+ */
+void checkAssimpLoad(const std::string& filepath, const Mesh& mesh)
+{
+    Mesh nativeMesh;
+    nativeMesh.load(filepath);
+
+    Mesh assimpMesh;
+    assimpMesh.loadWithAssimp(filepath);
+
+    const std::vector<TrianglePositions> expected = getTrianglePositions(mesh);
+    BOOST_CHECK(getTrianglePositions(nativeMesh) == expected);
+    BOOST_CHECK(getTrianglePositions(assimpMesh) == expected);
+    BOOST_CHECK_EQUAL(nativeMesh.pts.size(), assimpMesh.pts.size());
+    BOOST_CHECK_EQUAL(nativeMesh.nmtls, assimpMesh.nmtls);
+}
+
+/**
+ * @brief Write a binary PLY file of a single triangle with extra vertex and face properties, with the host endianness.
+ */
+void writePly(const std::string& filepath, const std::vector<std::string>& vertexFloatProperties, bool faceTexcoords)
+{
+    const std::uint16_t one = 1;
+    const bool isLittleEndian = (*reinterpret_cast<const unsigned char*>(&one) == 1);
+
+    std::ofstream out(filepath, std::ios::binary);
+    out << "ply\n"
+        << "format " << (isLittleEndian ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+        << "element vertex 3\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n";
+    for(const std::string& name : vertexFloatProperties)
+        out << "property float " << name << "\n";
+    out << "element face 1\n"
+        << "property list uchar int vertex_indices\n";
+    if(faceTexcoords)
+        out << "property list uchar float texcoord\n";
+    out << "end_header\n";
+
+    const auto writeValue = [&out](auto value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    for(int i = 0; i < 3; ++i)
+    {
+        writeValue(static_cast<float>(i == 1));
+        writeValue(static_cast<float>(i == 2));
+        writeValue(0.0f);
+        for(std::size_t p = 0; p < vertexFloatProperties.size(); ++p)
+            writeValue(0.5f);
+    }
+    writeValue(std::uint8_t(3));
+    for(int i = 0; i < 3; ++i)
+        writeValue(std::int32_t(i));
+    if(faceTexcoords)
+    {
+        writeValue(std::uint8_t(6));
+        for(int i = 0; i < 6; ++i)
+            writeValue(0.25f * i);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshIO_plyRoundTrip)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("meshIO_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    Mesh mesh = createMesh(12);
+
+    const std::string filepath = (folder / "mesh.ply").string();
+    mesh.save(filepath);
+
+    Mesh loaded;
+    loaded.load(filepath);
+    checkNativeLoad(loaded, mesh, true, true);
+
+    // Assimp ignores the visibilities, compared on a file without them
+    mesh.pointsVisibilities.clear();
+    const std::string filepathNoVis = (folder / "mesh_noVisibilities.ply").string();
+    mesh.save(filepathNoVis);
+
+    Mesh loadedNoVis;
+    loadedNoVis.load(filepathNoVis);
+    checkNativeLoad(loadedNoVis, mesh, true, false);
+    checkAssimpLoad(filepathNoVis, mesh);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(meshIO_objRoundTrip)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("meshIO_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    Mesh mesh = createMesh(12);
+
+    const std::string filepath = (folder / "mesh.obj").string();
+    mesh.save(filepath);
+
+    // only the positions and triangles are written in OBJ
+    Mesh loaded;
+    loaded.load(filepath);
+    checkNativeLoad(loaded, mesh, false, false);
+    checkAssimpLoad(filepath, mesh);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(meshIO_plyFallbackToAssimp)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("meshIO_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const std::string filepath = (folder / "triangle.ply").string();
+
+    // supported by the native reader, unknown properties are ignored
+    writePly(filepath, {"quality"}, false);
+    {
+        Mesh mesh;
+        BOOST_CHECK(loadPly(filepath, mesh));
+        BOOST_CHECK_EQUAL(mesh.pts.size(), 3);
+        BOOST_CHECK_EQUAL(mesh.tris.size(), 1);
+    }
+
+    // texture coordinates and normals are left to Assimp, the mesh is not modified
+    const std::vector<std::vector<std::string>> vertexProperties = {
+        {"nx", "ny", "nz"}, {"s", "t"}, {"u", "v"}, {"texture_u", "texture_v"}, {"texture_s", "texture_t"}};
+    for(const std::vector<std::string>& properties : vertexProperties)
+    {
+        writePly(filepath, properties, false);
+        Mesh mesh;
+        BOOST_CHECK_MESSAGE(!loadPly(filepath, mesh), "vertex property " << properties.front());
+        BOOST_CHECK(mesh.pts.empty());
+        BOOST_CHECK(mesh.tris.empty());
+    }
+
+    writePly(filepath, {}, true);
+    {
+        Mesh mesh;
+        BOOST_CHECK(!loadPly(filepath, mesh));
+        BOOST_CHECK(mesh.pts.empty());
+    }
+
+    // ASCII files are left to Assimp
+    {
+        std::ofstream out(filepath);
+        out << "ply\nformat ascii 1.0\nelement vertex 0\nproperty float x\nproperty float y\nproperty float z\nend_header\n";
+    }
+    {
+        Mesh mesh;
+        BOOST_CHECK(!loadPly(filepath, mesh));
+    }
+
+    fs::remove_all(folder);
+}
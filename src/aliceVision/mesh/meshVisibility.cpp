@@ -6,46 +6,51 @@
 
 #include "meshVisibility.hpp"
 #include "geoMesh.hpp"
+#include "MeshBVH.hpp"
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 
 #include <geogram/basic/permutation.h>
 #include <geogram/basic/attributes.h>
-#include <geogram/points/kd_tree.h>
 #include <geogram/mesh/mesh_AABB.h>
 #include <geogram/mesh/mesh_reorder.h>
 
+#include <memory>
+
 
 namespace aliceVision {
 namespace mesh {
 
 void getNearestVertices(const Mesh& refMesh, const Mesh& mesh, StaticVector<int>& out_nearestVertex)
 {
-    ALICEVISION_LOG_DEBUG("getNearestVertices start.");
-    out_nearestVertex.resize(mesh.pts.size(), -1);
-
-    GEO::AdaptiveKdTree refMesh_kdTree(3);
-    refMesh_kdTree.set_points(refMesh.pts.size(), refMesh.pts.front().m);
+    const MeshKdTree refKdTree(refMesh);
+    getNearestVertices(refKdTree, mesh, out_nearestVertex);
+}
 
-    #pragma omp parallel for
-    for(int i = 0; i < mesh.pts.size(); ++i)
-    {
-        out_nearestVertex[i] = refMesh_kdTree.get_nearest_neighbor(mesh.pts[i].m);
-    }
+void getNearestVertices(const MeshKdTree& refKdTree, const Mesh& mesh, StaticVector<int>& out_nearestVertex)
+{
+    ALICEVISION_LOG_DEBUG("getNearestVertices start.");
+    refKdTree.getNearestPoints(mesh.pts, out_nearestVertex);
     ALICEVISION_LOG_DEBUG("getNearestVertices done.");
 }
 
 
 void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh& mesh)
+{
+    const MeshKdTree refKdTree(refMesh);
+    remapMeshVisibilities_pullVerticesVisibility(refMesh, refKdTree, mesh);
+}
+
+void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, const MeshKdTree& refKdTree, Mesh& mesh)
 {
     ALICEVISION_LOG_DEBUG("remapMeshVisibility based on closest vertex start.");
 
     const PointsVisibility& refPtsVisibilities = refMesh.pointsVisibilities;
     PointsVisibility& out_ptsVisibilities = mesh.pointsVisibilities;
 
-    GEO::AdaptiveKdTree refMesh_kdTree(3);
-    refMesh_kdTree.set_points(refMesh.pts.size(), refMesh.pts.front().m);
+    StaticVector<int> nearestVertices;
+    getNearestVertices(refKdTree, mesh, nearestVertices);
 
     out_ptsVisibilities.resize(mesh.pts.size());
 
@@ -54,7 +59,7 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh& mes
     {
         PointVisibility& pOut = out_ptsVisibilities[i];
 
-        int iRef = refMesh_kdTree.get_nearest_neighbor(mesh.pts[i].m);
+        const int iRef = nearestVertices[i];
         if(iRef == -1)
             continue;
         const PointVisibility& pRef = refPtsVisibilities[iRef];
@@ -139,24 +144,26 @@ void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh
     ALICEVISION_LOG_INFO("remapMeshVisibility done.");
 }
 
-void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh)
+void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh, bool useBVH)
 {
     ALICEVISION_LOG_INFO("remapMeshVisibility based on triangles normals start.");
 
     PointsVisibility& out_ptsVisibilities = mesh.pointsVisibilities;
 
-    GEO::initialize();
+    // occlusion queries in the BVH of the mesh, or in the geogram AABB tree of a copy of the mesh
+    std::unique_ptr<MeshBVH> bvh;
     GEO::Mesh meshG;
-    toGeoMesh(mesh, meshG);
-
-    // MeshFacetAABB will reorder the mesh, so we need to keep indices
-    GEO::Attribute<GEO::index_t> reorderedVerticesAttr(meshG.vertices.attributes(), "reorder");
-    for(int i = 0; i < meshG.vertices.nb(); ++i)
-        reorderedVerticesAttr[i] = i;
-
-    GEO::MeshFacetsAABB meshAABB(meshG); // warning: mesh_reorder called inside
-
-    GEO::vector<GEO::index_t> reorderedVertices = reorderedVerticesAttr.get_vector();
+    std::unique_ptr<GEO::MeshFacetsAABB> meshAABB;
+    if(useBVH)
+    {
+        bvh.reset(new MeshBVH(mesh));
+    }
+    else
+    {
+        GEO::initialize();
+        toGeoMesh(mesh, meshG);
+        meshAABB.reset(new GEO::MeshFacetsAABB(meshG)); // warning: mesh_reorder called inside, only the copy is reordered
+    }
 
     if(out_ptsVisibilities.size() != mesh.pts.size())
     {
@@ -184,11 +191,20 @@ void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh&
             if(angle > 90.0)
                 continue;
 
-            const GEO::vec3 gv(v.x, v.y, v.z);
-            const GEO::vec3 gc(c.x, c.y, c.z);
-            const GEO::vec3 vc = gc - gv;
+            const Point3d vc = c - v;
             // check if there is an occlusion on the segment between the current mesh vertex and the camera
-            const bool occlusion = meshAABB.ray_intersection(GEO::Ray(gv + (vc * 0.00001), vc), 1.0);
+            bool occlusion = false;
+            if(useBVH)
+            {
+                const double distance = vc.size();
+                occlusion = bvh->isOccluded(v + vc * 0.00001, vc / distance, distance * (1.0 - 0.00001));
+            }
+            else
+            {
+                const GEO::vec3 gv(v.x, v.y, v.z);
+                const GEO::vec3 gvc(vc.x, vc.y, vc.z);
+                occlusion = meshAABB->ray_intersection(GEO::Ray(gv + (gvc * 0.00001), gvc), 1.0);
+            }
             if(occlusion)
                 continue;
 
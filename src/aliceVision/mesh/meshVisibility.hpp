@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshKdTree.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 
 namespace aliceVision {
@@ -21,6 +22,14 @@ namespace mesh {
  */
 void getNearestVertices(const Mesh& refMesh, const Mesh& mesh, StaticVector<int>& out_nearestVertex);
 
+/**
+ * @brief Retrieve the nearest neighbor vertex in the reference mesh for each vertex in @p mesh.
+ * @param[in] refKdTree the kd-tree of the reference mesh vertices, reused across calls
+ * @param[in] mesh input target mesh
+ * @param[out] out_nearestVertex index of the nearest vertex in the reference mesh for each vertex in @p mesh
+ */
+void getNearestVertices(const MeshKdTree& refKdTree, const Mesh& mesh, StaticVector<int>& out_nearestVertex);
+
 /**
  * @brief Transfer the visibility per vertex from one mesh to another.
  * For each vertex of the @p mesh, we search the nearest neighbor vertex in the @p refMesh and copy its visibility information.
@@ -31,6 +40,15 @@ void getNearestVertices(const Mesh& refMesh, const Mesh& mesh, StaticVector<int>
  */
 void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh &mesh);
 
+/**
+ * @brief Transfer the visibility per vertex from one mesh to another, reusing the kd-tree of the @p refMesh vertices.
+ *
+ * @param[in] refMesh input reference mesh
+ * @param[in] refKdTree the kd-tree of the @p refMesh vertices
+ * @param[in] mesh input target mesh
+ */
+void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, const MeshKdTree& refKdTree, Mesh& mesh);
+
 /**
 * @brief Transfer the visibility per vertex from one mesh to another.
 * For each vertex of the @p refMesh, we search the closest triangle in the @p mesh and copy its visibility information to each vertex of the triangle.
@@ -41,7 +59,15 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh &mes
 */
 void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh, Mesh& mesh);
 
-void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh);
+/**
+ * @brief Compute the visibility per vertex from the cameras of the mesh itself.
+ * A camera sees a vertex if it is in front of the vertex normal and the segment between them is not occluded by the mesh.
+ *
+ * @param[in] mp the multi-view parameters
+ * @param[in,out] mesh the mesh, its vertices visibilities are completed
+ * @param[in] useBVH occlusion queries in a MeshBVH, otherwise in a geogram AABB tree (same visibilities up to rays grazing the triangles edges)
+ */
+void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh, bool useBVH = true);
 
 } // namespace mesh
 } // namespace aliceVision
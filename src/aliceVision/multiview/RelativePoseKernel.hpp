@@ -11,6 +11,7 @@
 #include <aliceVision/robustEstimation/conditioning.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 #include <aliceVision/robustEstimation/PointFittingRansacKernel.hpp>
+#include <aliceVision/multiview/batchedResiduals.hpp>
 
 namespace aliceVision {
 namespace multiview {
@@ -69,6 +70,11 @@ public:
     }
   }
 
+  void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    computeErrors(PFRansacKernel::PFKernel::_errorEstimator, model, _x1n, _x2n, errors);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // Unnormalize model from the computed conditioning.
@@ -154,6 +160,15 @@ public:
     return _errorEstimator.error(modelF, PFRansacKernel::PFKernel::_x1.col(sample), PFRansacKernel::PFKernel::_x2.col(sample));
   }
 
+  void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    // convert the essential matrix once for all the samples
+    Mat3 F;
+    fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+    const ModelT_ modelF(F);
+    computeErrors(_errorEstimator, modelF, PFRansacKernel::PFKernel::_x1, PFRansacKernel::PFKernel::_x2, errors);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // do nothing, no normalization in this case
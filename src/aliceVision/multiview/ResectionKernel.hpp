@@ -11,6 +11,7 @@
 #include <aliceVision/robustEstimation/conditioning.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 #include <aliceVision/robustEstimation/PointFittingRansacKernel.hpp>
+#include <aliceVision/multiview/batchedResiduals.hpp>
 
 namespace aliceVision {
 namespace multiview {
@@ -48,6 +49,11 @@ public:
     robustEstimation::normalizePointsFromImageSize(x2d, &_x2d, &_N1, w, h);
   }
 
+  void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    computeErrors(KernelBase::PFKernel::_errorEstimator, model, _x2d, KernelBase::PFKernel::_x2, errors);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // unnormalize model from the computed conditioning.
@@ -115,6 +121,11 @@ public:
     robustEstimation::applyTransformationToPoints(x2d, _N1, &_x2d);
   }
 
+  void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    computeErrors(KernelBase::PFKernel::_errorEstimator, model, _x2d, KernelBase::PFKernel::_x2, errors);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // unnormalize model from the computed conditioning.
@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace multiview {
+
+/// Number of correspondences evaluated together by the batched residual kernels
+constexpr int BATCHED_RESIDUALS_TILE_SIZE = 64;
+
+/// One residual (or one coordinate) per correspondence of a tile
+using ResidualTile = Eigen::Array<double, 1, BATCHED_RESIDUALS_TILE_SIZE>;
+
+/**
+ * @brief Evaluate a residual function for one model against all the correspondences.
+ *
+ * Correspondences are processed by tiles of BATCHED_RESIDUALS_TILE_SIZE columns.
+ * Each tile is transposed into a structure-of-arrays layout (one contiguous row per coordinate),
+ * so the residual function can be written with coefficient-wise Eigen array operations that are
+ * compiled to the widest SIMD packets available (SSE2, AVX/AVX2, AVX512, NEON).
+ *
+ * @note The trailing columns of the last tile hold values from the previous tile and their
+ *       residuals are discarded.
+ *
+ * @tparam Rows1 number of coordinates of the first data
+ * @tparam Rows2 number of coordinates of the second data
+ * @param[in] x1 first data, one point per column
+ * @param[in] x2 second data, one point per column
+ * @param[in] residualFunction callable as f(tile1, tile2, residuals) where tile1 and tile2 are
+ *            row-major arrays of Rows1 (Rows2) x BATCHED_RESIDUALS_TILE_SIZE and residuals a ResidualTile
+ * @param[out] errors one residual per correspondence
+ */
+template <int Rows1, int Rows2, typename ResidualFunctionT>
+void evaluateBatchedResiduals(const Mat& x1, const Mat& x2, ResidualFunctionT&& residualFunction, std::vector<double>& errors)
+{
+  using Tile1 = Eigen::Array<double, Rows1, BATCHED_RESIDUALS_TILE_SIZE, Eigen::RowMajor>;
+  using Tile2 = Eigen::Array<double, Rows2, BATCHED_RESIDUALS_TILE_SIZE, Eigen::RowMajor>;
+
+  assert(x1.rows() == Rows1);
+  assert(x2.rows() == Rows2);
+  assert(x1.cols() == x2.cols());
+
+  const Eigen::Index nbPoints = x1.cols();
+  errors.resize(nbPoints);
+
+  Tile1 tile1 = Tile1::Zero();
+  Tile2 tile2 = Tile2::Zero();
+  ResidualTile residuals;
+
+  for(Eigen::Index start = 0; start < nbPoints; start += BATCHED_RESIDUALS_TILE_SIZE)
+  {
+    const Eigen::Index n = std::min<Eigen::Index>(BATCHED_RESIDUALS_TILE_SIZE, nbPoints - start);
+
+    tile1.leftCols(n) = x1.middleCols(start, n).array();
+    tile2.leftCols(n) = x2.middleCols(start, n).array();
+
+    residualFunction(tile1, tile2, residuals);
+
+    Eigen::Map<Eigen::ArrayXd>(errors.data() + start, n) = residuals.head(n).transpose();
+  }
+}
+
+/**
+ * @brief Detect whether an error functor exposes a batched errors(model, x1, x2, errors) method.
+ */
+template <typename ErrorT, typename ModelT, typename = void>
+struct HasBatchedErrors : std::false_type {};
+
+template <typename ErrorT, typename ModelT>
+struct HasBatchedErrors<ErrorT, ModelT,
+                        std::void_t<decltype(std::declval<const ErrorT&>().errors(std::declval<const ModelT&>(),
+                                                                                  std::declval<const Mat&>(),
+                                                                                  std::declval<const Mat&>(),
+                                                                                  std::declval<std::vector<double>&>()))>>
+  : std::true_type {};
+
+/**
+ * @brief Compute the errors of all the correspondences with respect to a model,
+ *        in one batched call when the error functor supports it.
+ * @param[in] errorEstimator error functor
+ * @param[in] model the model to consider
+ * @param[in] x1 first data, one point per column
+ * @param[in] x2 second data, one point per column
+ * @param[out] errors one error per correspondence
+ */
+template <typename ErrorT, typename ModelT>
+void computeErrors(const ErrorT& errorEstimator, const ModelT& model, const Mat& x1, const Mat& x2, std::vector<double>& errors)
+{
+  if constexpr(HasBatchedErrors<ErrorT, ModelT>::value)
+  {
+    errorEstimator.errors(model, x1, x2, errors);
+  }
+  else
+  {
+    errors.resize(x1.cols());
+    for(Eigen::Index i = 0; i < x1.cols(); ++i)
+      errors[i] = errorEstimator.error(model, x1.col(i), x2.col(i));
+  }
+}
+
+}  // namespace multiview
+}  // namespace aliceVision
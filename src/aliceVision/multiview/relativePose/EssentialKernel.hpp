@@ -14,6 +14,7 @@
 #include <aliceVision/multiview/relativePose/Essential8PSolver.hpp>
 #include <aliceVision/multiview/relativePose/FundamentalError.hpp>
 #include <aliceVision/multiview/essential.hpp>
+#include <aliceVision/multiview/batchedResiduals.hpp>
 #include <aliceVision/multiview/Unnormalizer.hpp>
 
 namespace aliceVision {
@@ -70,6 +71,15 @@ public:
     return KernelBase::_errorEstimator.error(modelF, KernelBase::_x1.col(sample), KernelBase::_x2.col(sample));
   }
 
+  void errors(const ModelT& model, std::vector<double>& errors) const override
+  {
+    // convert the essential matrix once for all the samples
+    Mat3 F;
+    fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+    const robustEstimation::Mat3Model modelF(F);
+    computeErrors(KernelBase::_errorEstimator, modelF, KernelBase::_x1, KernelBase::_x2, errors);
+  }
+
 protected:
 
   // The two camera calibrated camera matrix
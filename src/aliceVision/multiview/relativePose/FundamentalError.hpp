@@ -9,12 +9,36 @@
 #pragma once
 
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/multiview/batchedResiduals.hpp>
 #include <aliceVision/multiview/relativePose/ISolverErrorRelativePose.hpp>
 
 namespace aliceVision {
 namespace multiview {
 namespace relativePose {
 
+/**
+ * @brief Epipolar lines of a tile of correspondences, in structure-of-arrays layout.
+ *        Fx is the line of x1 in the second image, Fty the line of x2 in the first image
+ *        (only its first two coefficients are needed) and yFx the algebraic error y^T F x.
+ */
+struct EpipolarLinesTile
+{
+  template <typename Tile1T, typename Tile2T>
+  EpipolarLinesTile(const Mat3& F, const Tile1T& x1, const Tile2T& x2)
+  {
+    Fx0 = F(0, 0) * x1.row(0) + F(0, 1) * x1.row(1) + F(0, 2);
+    Fx1 = F(1, 0) * x1.row(0) + F(1, 1) * x1.row(1) + F(1, 2);
+    Fx2 = F(2, 0) * x1.row(0) + F(2, 1) * x1.row(1) + F(2, 2);
+    Fty0 = F(0, 0) * x2.row(0) + F(1, 0) * x2.row(1) + F(2, 0);
+    Fty1 = F(0, 1) * x2.row(0) + F(1, 1) * x2.row(1) + F(2, 1);
+    yFx = x2.row(0) * Fx0 + x2.row(1) * Fx1 + Fx2;
+  }
+
+  ResidualTile Fx0, Fx1, Fx2;
+  ResidualTile Fty0, Fty1;
+  ResidualTile yFx;
+};
+
 /**
  * @brief Compute FundamentalSampsonError related to the Fundamental matrix and 2 correspondences
  */
@@ -31,6 +55,15 @@ struct FundamentalSampsonError : public ISolverErrorRelativePose<robustEstimatio
 
     return Square(y.dot(F_x)) / (  F_x.head<2>().squaredNorm() + Ft_y.head<2>().squaredNorm());
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+  {
+    evaluateBatchedResiduals<2, 2>(x1, x2, [&F](const auto& t1, const auto& t2, ResidualTile& r)
+    {
+      const EpipolarLinesTile l(F.getMatrix(), t1, t2);
+      r = l.yFx.square() / (l.Fx0.square() + l.Fx1.square() + l.Fty0.square() + l.Fty1.square());
+    }, errors);
+  }
 };
 
 struct FundamentalSymmetricEpipolarDistanceError: public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -47,6 +80,15 @@ struct FundamentalSymmetricEpipolarDistanceError: public ISolverErrorRelativePos
     // @note the divide by 4 is to make this match the Sampson distance.
     return Square(y.dot(F_x)) * ( 1.0 / F_x.head<2>().squaredNorm() + 1.0 / Ft_y.head<2>().squaredNorm()) / 4.0;
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+  {
+    evaluateBatchedResiduals<2, 2>(x1, x2, [&F](const auto& t1, const auto& t2, ResidualTile& r)
+    {
+      const EpipolarLinesTile l(F.getMatrix(), t1, t2);
+      r = l.yFx.square() * ((l.Fx0.square() + l.Fx1.square()).inverse() + (l.Fty0.square() + l.Fty1.square()).inverse()) / 4.0;
+    }, errors);
+  }
 };
 
 struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -61,6 +103,15 @@ struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robust
 
     return Square(F_x.dot(y)) /  F_x.head<2>().squaredNorm();
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+  {
+    evaluateBatchedResiduals<2, 2>(x1, x2, [&F](const auto& t1, const auto& t2, ResidualTile& r)
+    {
+      const EpipolarLinesTile l(F.getMatrix(), t1, t2);
+      r = l.yFx.square() / (l.Fx0.square() + l.Fx1.square());
+    }, errors);
+  }
 };
 
 
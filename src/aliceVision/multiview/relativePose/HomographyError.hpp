@@ -10,6 +10,7 @@
 
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/multiview/batchedResiduals.hpp>
 #include <aliceVision/multiview/relativePose/ISolverErrorRelativePose.hpp>
 
 namespace aliceVision {
@@ -28,6 +29,18 @@ struct HomographyAsymmetricError : ISolverErrorRelativePose<robustEstimation::Ma
         const Vec2 x2_est = x2h_est.head<2>() / x2h_est[2];
         return (x2 - x2_est).squaredNorm();
     }
+
+    void errors(const robustEstimation::Mat3Model& H, const Mat& x1, const Mat& x2, std::vector<double>& errors) const override
+    {
+        const Mat3& h = H.getMatrix();
+        evaluateBatchedResiduals<2, 2>(x1, x2, [&h](const auto& t1, const auto& t2, ResidualTile& r)
+        {
+            const ResidualTile invW = (h(2, 0) * t1.row(0) + h(2, 1) * t1.row(1) + h(2, 2)).inverse();
+            const ResidualTile du = t2.row(0) - (h(0, 0) * t1.row(0) + h(0, 1) * t1.row(1) + h(0, 2)) * invW;
+            const ResidualTile dv = t2.row(1) - (h(1, 0) * t1.row(0) + h(1, 1) * t1.row(1) + h(1, 2)) * invW;
+            r = du.square() + dv.square();
+        }, errors);
+    }
 };
 
 }  // namespace relativePose
@@ -8,6 +8,8 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <vector>
+
 
 namespace aliceVision {
 namespace multiview {
@@ -20,6 +22,21 @@ template <typename ModelT>
 struct ISolverErrorRelativePose
 {
   virtual double error(const ModelT& model, const Vec2& x1, const Vec2& x2) const = 0;
+
+  /**
+   * @brief Compute the error of all the correspondences with respect to one model.
+   * @note Specializations evaluate the correspondences in batch.
+   * @param[in] model the model to consider
+   * @param[in] x1 points in the first image, one per column
+   * @param[in] x2 corresponding points in the second image, one per column
+   * @param[out] errors one error per correspondence
+   */
+  virtual void errors(const ModelT& model, const Mat& x1, const Mat& x2, std::vector<double>& errors) const
+  {
+    errors.resize(x1.cols());
+    for(Mat::Index i = 0; i < x1.cols(); ++i)
+      errors[i] = error(model, x1.col(i), x2.col(i));
+  }
 };
 
 }  // namespace relativePose
@@ -133,3 +133,36 @@ BOOST_AUTO_TEST_CASE(NormalizedFundamental8PKernel_EasyCase)
 
   BOOST_CHECK(expectKernelProperties<relativePose::NormalizedFundamental8PKernel>(x1, x2));
 }
+
+template<typename ErrorT>
+void checkBatchedErrors(const Mat3& F, const Mat& x1, const Mat& x2)
+{
+  const ErrorT errorEstimator;
+  const robustEstimation::Mat3Model model(F);
+
+  std::vector<double> errors;
+  errorEstimator.errors(model, x1, x2, errors);
+
+  BOOST_CHECK_EQUAL(errors.size(), x1.cols());
+  for(Mat::Index i = 0; i < x1.cols(); ++i)
+  {
+    const double expected = errorEstimator.error(model, x1.col(i), x2.col(i));
+    BOOST_CHECK_SMALL(errors[i] - expected, 1e-9 * std::max(1.0, expected));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FundamentalError_Batched)
+{
+  // a number of correspondences which is not a multiple of the tile size
+  const int nbPoints = 3 * BATCHED_RESIDUALS_TILE_SIZE + 7;
+  const Mat x1 = Mat::Random(2, nbPoints) * 500.0;
+  const Mat x2 = Mat::Random(2, nbPoints) * 500.0;
+  const Mat3 F = Mat3::Random();
+
+  checkBatchedErrors<relativePose::FundamentalSampsonError>(F, x1, x2);
+  checkBatchedErrors<relativePose::FundamentalSymmetricEpipolarDistanceError>(F, x1, x2);
+  checkBatchedErrors<relativePose::FundamentalEpipolarDistanceError>(F, x1, x2);
+
+  // fewer correspondences than one tile
+  checkBatchedErrors<relativePose::FundamentalSampsonError>(F, x1.leftCols(5), x2.leftCols(5));
+}
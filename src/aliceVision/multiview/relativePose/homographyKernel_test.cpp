@@ -100,3 +100,29 @@ BOOST_AUTO_TEST_CASE(Homography4PKernel_Fitting)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(HomographyAsymmetricError_Batched)
+{
+  // a number of correspondences which is not a multiple of the tile size
+  const int nbPoints = 2 * BATCHED_RESIDUALS_TILE_SIZE + 13;
+  const Mat x1 = Mat::Random(2, nbPoints) * 100.0;
+  const Mat x2 = Mat::Random(2, nbPoints) * 100.0;
+
+  Mat3 H;
+  H << 1, -2,  3,
+       4,  5, -6,
+      -7,  8,  1;
+
+  const relativePose::HomographyAsymmetricError errorEstimator;
+  const robustEstimation::Mat3Model model(H);
+
+  std::vector<double> errors;
+  errorEstimator.errors(model, x1, x2, errors);
+
+  BOOST_CHECK_EQUAL(errors.size(), nbPoints);
+  for(int i = 0; i < nbPoints; ++i)
+  {
+    const double expected = errorEstimator.error(model, x1.col(i), x2.col(i));
+    BOOST_CHECK_SMALL(errors[i] - expected, 1e-9 * std::max(1.0, expected));
+  }
+}
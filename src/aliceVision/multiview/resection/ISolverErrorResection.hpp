@@ -6,6 +6,10 @@
 
 #pragma once
 
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <vector>
+
 namespace aliceVision {
 namespace multiview {
 namespace resection {
@@ -17,6 +21,21 @@ template <typename ModelT>
 struct ISolverErrorResection
 {
   virtual double error(const ModelT& model, const Vec2& x2d, const Vec3& x3d) const = 0;
+
+  /**
+   * @brief Compute the error of all the 2d-3d correspondences with respect to one model.
+   * @note Specializations evaluate the correspondences in batch.
+   * @param[in] model the model to consider
+   * @param[in] x2d 2d points, one per column
+   * @param[in] x3d corresponding 3d points, one per column
+   * @param[out] errors one error per correspondence
+   */
+  virtual void errors(const ModelT& model, const Mat& x2d, const Mat& x3d, std::vector<double>& errors) const
+  {
+    errors.resize(x2d.cols());
+    for(Mat::Index i = 0; i < x2d.cols(); ++i)
+      errors[i] = error(model, x2d.col(i), x3d.col(i));
+  }
 };
 
 }  // namespace resection
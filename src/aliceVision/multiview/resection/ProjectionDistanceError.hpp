@@ -9,6 +9,7 @@
 
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/multiview/batchedResiduals.hpp>
 #include <aliceVision/multiview/resection/ISolverErrorResection.hpp>
 
 
@@ -16,6 +17,19 @@ namespace aliceVision {
 namespace multiview {
 namespace resection {
 
+/**
+ * @brief Compute the squared reprojection errors of a tile of 2d-3d correspondences
+ *        in structure-of-arrays layout.
+ */
+template <typename Tile2dT, typename Tile3dT>
+inline void projectionSquaredErrorsTile(const Mat34& P, const Tile2dT& p2d, const Tile3dT& p3d, ResidualTile& r)
+{
+  const ResidualTile invZ = (P(2, 0) * p3d.row(0) + P(2, 1) * p3d.row(1) + P(2, 2) * p3d.row(2) + P(2, 3)).inverse();
+  const ResidualTile du = (P(0, 0) * p3d.row(0) + P(0, 1) * p3d.row(1) + P(0, 2) * p3d.row(2) + P(0, 3)) * invZ - p2d.row(0);
+  const ResidualTile dv = (P(1, 0) * p3d.row(0) + P(1, 1) * p3d.row(1) + P(1, 2) * p3d.row(2) + P(1, 3)) * invZ - p2d.row(1);
+  r = du.square() + dv.square();
+}
+
 /**
  * @brief Compute the residual of the projection distance
  *        (pt2D, project(P,pt3D))
@@ -26,6 +40,15 @@ struct ProjectionDistanceError : public ISolverErrorResection<robustEstimation::
   {
     return (project(P.getMatrix(), p3d) - p2d).norm();
   }
+
+  void errors(const robustEstimation::Mat34Model& P, const Mat& p2d, const Mat& p3d, std::vector<double>& errors) const override
+  {
+    evaluateBatchedResiduals<2, 3>(p2d, p3d, [&P](const auto& t2d, const auto& t3d, ResidualTile& r)
+    {
+      projectionSquaredErrorsTile(P.getMatrix(), t2d, t3d, r);
+      r = r.sqrt();
+    }, errors);
+  }
 };
 
 /**
@@ -38,6 +61,14 @@ struct ProjectionDistanceSquaredError : public ISolverErrorResection<robustEstim
   {
     return (project(P.getMatrix(), p3d) - p2d).squaredNorm();
   }
+
+  void errors(const robustEstimation::Mat34Model& P, const Mat& p2d, const Mat& p3d, std::vector<double>& errors) const override
+  {
+    evaluateBatchedResiduals<2, 3>(p2d, p3d, [&P](const auto& t2d, const auto& t3d, ResidualTile& r)
+    {
+      projectionSquaredErrorsTile(P.getMatrix(), t2d, t3d, r);
+    }, errors);
+  }
 };
 
 }  // namespace resection
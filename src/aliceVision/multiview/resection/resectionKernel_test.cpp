@@ -213,3 +213,31 @@ BOOST_AUTO_TEST_CASE(EuclideanResection_Points6AllRandomInput) {
   }
 
 }
+
+BOOST_AUTO_TEST_CASE(ProjectionDistanceError_Batched)
+{
+  const int nViews = 1;
+  const int nbPoints = BATCHED_RESIDUALS_TILE_SIZE + 21;
+  const NViewDataSet d = NRealisticCamerasRing(nViews, nbPoints, NViewDatasetConfigurator(1000, 1000, 500, 500, 5, 0));
+
+  // perturb the observations to get non-zero residuals
+  const Mat x2d = d._x[0] + Mat::Random(2, nbPoints) * 3.0;
+  const Mat x3d = d._X;
+  const robustEstimation::Mat34Model model(d.P(0));
+
+  const resection::ProjectionDistanceError distanceError;
+  const resection::ProjectionDistanceSquaredError squaredError;
+
+  std::vector<double> distances;
+  std::vector<double> squaredDistances;
+  distanceError.errors(model, x2d, x3d, distances);
+  squaredError.errors(model, x2d, x3d, squaredDistances);
+
+  BOOST_CHECK_EQUAL(distances.size(), nbPoints);
+  BOOST_CHECK_EQUAL(squaredDistances.size(), nbPoints);
+  for(int i = 0; i < nbPoints; ++i)
+  {
+    BOOST_CHECK_SMALL(distances[i] - distanceError.error(model, x2d.col(i), x3d.col(i)), 1e-9);
+    BOOST_CHECK_SMALL(squaredDistances[i] - squaredError.error(model, x2d.col(i), x3d.col(i)), 1e-8);
+  }
+}
@@ -103,6 +103,55 @@ void getTileParamsFromMetadata(const std::string& mapTilePath, TileParams& out_t
     }
 }
 
+/**
+ * @brief Get the map file write options for the given fileType.
+ * @note Storage options are read from the user parameters ("mapStorage" section):
+ *       - depthDataType: depth map storage data type (default: float)
+ *       - exrCompression: EXR compression method, auto for a lossless method chosen per map type (default: auto)
+ *       - exrTileSize: EXR tile size in pixels, 0 for scanline storage (default: 0)
+ * @param[in] mp the multi-view parameters
+ * @param[in] fileType the map fileType enum
+ * @return map file write options
+ */
+image::ImageWriteOptions getMapWriteOptions(const MultiViewParams& mp, EFileType fileType)
+{
+    const bool isDepthMap = (fileType == EFileType::depthMap) || (fileType == EFileType::depthMapFiltered);
+    const bool isNoisyMap = (fileType == EFileType::simMap) || (fileType == EFileType::simMapFiltered) ||
+                            (fileType == EFileType::normalMap) || (fileType == EFileType::normalMapFiltered);
+
+    image::ImageWriteOptions mapWriteOptions;
+
+    // set colorspace
+    mapWriteOptions.toColorSpace(image::EImageColorSpace::NO_CONVERSION);
+
+    // set storage type
+    if(isDepthMap)
+    {
+        const std::string depthDataType = mp.userParams.get<std::string>("mapStorage.depthDataType", image::EStorageDataType_enumToString(image::EStorageDataType::Float));
+        mapWriteOptions.storageDataType(image::EStorageDataType_stringToEnum(depthDataType));
+    }
+    else
+    {
+        mapWriteOptions.storageDataType(image::EStorageDataType::Half);
+    }
+
+    // set compression method
+    // default lossless methods:
+    //  - zip (16 scanlines blocks) for smooth depth/thickness/pixSize maps
+    //  - piz (wavelet) for noisy similarity/normal maps
+    image::EImageExrCompression compression = image::EImageExrCompression_stringToEnum(mp.userParams.get<std::string>("mapStorage.exrCompression", image::EImageExrCompression_enumToString(image::EImageExrCompression::Auto)));
+
+    if(compression == image::EImageExrCompression::Auto)
+        compression = isNoisyMap ? image::EImageExrCompression::PIZ : image::EImageExrCompression::ZIP;
+
+    mapWriteOptions.exrCompressionMethod(compression);
+
+    // set tile size
+    mapWriteOptions.exrTileSize(mp.userParams.get<int>("mapStorage.exrTileSize", 0));
+
+    return mapWriteOptions;
+}
+
 /**
  * @brief Get the tile map path list for a R camera et a given scale / stepXY.
  * @param[in] rc the related R camera index
@@ -193,7 +242,8 @@ void weightTileBorder(int a, int b, int c, int d,
  * @param[in] roi the 2d region of interest without any downscale apply
  * @param[in] downscale the map downscale factor
  * @param[in] in_tileMap the tile map to add
- * @param[in,out] inout_map the full output map
+ * @param[in,out] inout_map the full output map, or the output map region if outputRoi is given
+ * @param[in] outputRoi the downscaled 2d region of interest covered by the output map, empty for the full map
  */
 template <typename T>
 void addSingleTileMapWeighted(int rc,
@@ -202,11 +252,15 @@ void addSingleTileMapWeighted(int rc,
                               const ROI& roi,
                               int downscale,
                               image::Image<T>& in_tileMap,
-                              image::Image<T>& inout_map)
+                              image::Image<T>& inout_map,
+                              const ROI& outputRoi = ROI())
 {
     // get downscaled ROI
     const ROI downscaledRoi = downscaleROI(roi, downscale);
 
+    // get output map ROI
+    const ROI mapRoi = outputRoi.isEmpty() ? ROI(0, inout_map.Width(), 0, inout_map.Height()) : outputRoi;
+
     // get tile border size
     const int tileWidth = downscaledRoi.width();
     const int tileHeight = downscaledRoi.height();
@@ -283,14 +337,16 @@ void addSingleTileMapWeighted(int rc,
     }
 
     // add weighted tile to the depth/sim map
-    for(int x = downscaledRoi.x.begin; x < downscaledRoi.x.end; ++x)
+    const ROI addRoi = intersect(downscaledRoi, mapRoi);
+
+    for(int x = addRoi.x.begin; x < addRoi.x.end; ++x)
     {
-        for(int y = downscaledRoi.y.begin; y < downscaledRoi.y.end; ++y)
+        for(int y = addRoi.y.begin; y < addRoi.y.end; ++y)
         {
             const int tx = x - downscaledRoi.x.begin;
             const int ty = y - downscaledRoi.y.begin;
 
-            inout_map(y, x) += in_tileMap(ty, tx);
+            inout_map(y - mapRoi.y.begin, x - mapRoi.x.begin) += in_tileMap(ty, tx);
         }
     }
 }
@@ -299,6 +355,7 @@ template <typename T>
 void readMapFromFileOrTiles(int rc,
                             const MultiViewParams& mp,
                             EFileType fileType,
+                            const ROI& roi,
                             image::Image<T>& out_map,
                             int scale,
                             int step,
@@ -308,28 +365,39 @@ void readMapFromFileOrTiles(int rc,
     assert(scale > 0);
     assert(step  > 0);
 
+    const int scaleStep = scale * step;
+
+    // requested ROI, clamped to the R camera image
+    const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
+    const ROI mapRoi = intersect(roi, imageRoi);
+    const ROI downscaledMapRoi = downscaleROI(mapRoi, scaleStep);
+    const bool isFullMap = (mapRoi.width() == imageRoi.width() && mapRoi.height() == imageRoi.height());
+
     // single file fullsize map path
     const std::string mapPath = getFileNameFromIndex(mp, rc, fileType, customSuffix);
 
     // check single file fullsize map exists
     if(fs::exists(mapPath))
     {
-        ALICEVISION_LOG_TRACE("Load depth map (full image): " << mapPath << ", scale: " << scale << ", step: " << step);
-        // read single file fullsize map
-        image::readImage(mapPath, out_map, image::EImageColorSpace::NO_CONVERSION);
+        if(isFullMap)
+        {
+            ALICEVISION_LOG_TRACE("Load depth map (full image): " << mapPath << ", scale: " << scale << ", step: " << step);
+            // read single file fullsize map
+            image::readImage(mapPath, out_map, image::EImageColorSpace::NO_CONVERSION);
+        }
+        else
+        {
+            ALICEVISION_LOG_TRACE("Load depth map (image region " << mapRoi << "): " << mapPath << ", scale: " << scale << ", step: " << step);
+            // read only the requested region of the single file fullsize map
+            const oiio::ROI regionRoi(downscaledMapRoi.x.begin, downscaledMapRoi.x.end, downscaledMapRoi.y.begin, downscaledMapRoi.y.end);
+            image::readImageRegion(mapPath, out_map, regionRoi);
+        }
         return;
     }
     ALICEVISION_LOG_TRACE("No full image depth map: " << mapPath << ", scale: " << scale << ", step: " << step << ". Looking for tiles.");
 
-    // read map from tiles
-    const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
-
-    const int scaleStep = scale * step;
-    const int width  = divideRoundUp(mp.getWidth(rc) , scaleStep);
-    const int height = divideRoundUp(mp.getHeight(rc), scaleStep);
-
-    // the output full map
-    out_map.resize(width, height, true, T(0.f)); // should be initialized, additive process
+    // the output map
+    out_map.resize(downscaledMapRoi.width(), downscaledMapRoi.height(), true, T(0.f)); // should be initialized, additive process
 
     // get tile map path list for the given R camera
     std::vector<std::string> mapTilePathList;
@@ -358,13 +426,13 @@ void readMapFromFileOrTiles(int rc,
         getRoiFromMetadata(mapTilePathList.at(i), tileRoiList.at(i));
     }
 
-    // read and add each tile to the full map
+    // read and add each tile overlapping the requested ROI to the output map
     for(size_t i = 0; i < tileRoiList.size(); ++i)
     {
-        const ROI roi = intersect(tileRoiList.at(i), imageRoi);
-        const std::string mapTilePath = getFileNameFromIndex(mp, rc, fileType, customSuffix, roi.x.begin, roi.y.begin);
+        const ROI tileRoi = intersect(tileRoiList.at(i), imageRoi);
+        const std::string mapTilePath = getFileNameFromIndex(mp, rc, fileType, customSuffix, tileRoi.x.begin, tileRoi.y.begin);
 
-        if(roi.isEmpty())
+        if(tileRoi.isEmpty() || intersect(tileRoi, mapRoi).isEmpty())
             continue;
 
         try
@@ -373,8 +441,8 @@ void readMapFromFileOrTiles(int rc,
             image::Image<T> tileMap;
             image::readImage(mapTilePath, tileMap, image::EImageColorSpace::NO_CONVERSION);
 
-            // add tile to the full map
-            addSingleTileMapWeighted(rc, mp, tileParams, roi, scaleStep, tileMap, out_map);
+            // add tile to the output map
+            addSingleTileMapWeighted(rc, mp, tileParams, tileRoi, scaleStep, tileMap, out_map, downscaledMapRoi);
         }
         catch(const std::exception& e)
         {
@@ -506,24 +574,10 @@ void writeMapToFileOrTile(int rc,
     }
 
 
-    // set colorspace
-    image::ImageWriteOptions mapWriteOptions;
-    mapWriteOptions.toColorSpace(image::EImageColorSpace::NO_CONVERSION);
-
-    // set storage type
-    if((fileType == EFileType::depthMap) || (fileType == EFileType::depthMapFiltered))
-    {
-        mapWriteOptions.storageDataType(image::EStorageDataType::Float);
-    }
-    else
-    {
-        mapWriteOptions.storageDataType(image::EStorageDataType::Half);
-    }
-
     // write map
     image::writeImage(mapPath,
                       in_map,
-                      mapWriteOptions,
+                      getMapWriteOptions(mp, fileType),
                       metadata,
                       displayRoi,
                       pixelRoi);
@@ -541,25 +595,51 @@ void addTileMapWeighted(int rc,
 }
 
 void readMap(int rc,
-              const MultiViewParams& mp,
-              const EFileType fileType,
-              image::Image<float>& out_map,
-              int scale,
-              int step,
-              const std::string& customSuffix)
+             const MultiViewParams& mp,
+             const EFileType fileType,
+             image::Image<float>& out_map,
+             int scale,
+             int step,
+             const std::string& customSuffix)
 {
-    readMapFromFileOrTiles(rc, mp, fileType, out_map, scale, step, customSuffix);
+    const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
+    readMapFromFileOrTiles(rc, mp, fileType, imageRoi, out_map, scale, step, customSuffix);
 }
 
 void readMap(int rc,
-              const MultiViewParams& mp,
-              const EFileType fileType,
-              image::Image<image::RGBfColor>& out_map,
-              int scale,
-              int step,
-              const std::string& customSuffix)
+             const MultiViewParams& mp,
+             const EFileType fileType,
+             image::Image<image::RGBfColor>& out_map,
+             int scale,
+             int step,
+             const std::string& customSuffix)
+{
+    const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
+    readMapFromFileOrTiles(rc, mp, fileType, imageRoi, out_map, scale, step, customSuffix);
+}
+
+void readMap(int rc,
+             const MultiViewParams& mp,
+             const EFileType fileType,
+             const ROI& roi,
+             image::Image<float>& out_map,
+             int scale,
+             int step,
+             const std::string& customSuffix)
+{
+    readMapFromFileOrTiles(rc, mp, fileType, roi, out_map, scale, step, customSuffix);
+}
+
+void readMap(int rc,
+             const MultiViewParams& mp,
+             const EFileType fileType,
+             const ROI& roi,
+             image::Image<image::RGBfColor>& out_map,
+             int scale,
+             int step,
+             const std::string& customSuffix)
 {
-    readMapFromFileOrTiles(rc, mp, fileType, out_map, scale, step, customSuffix);
+    readMapFromFileOrTiles(rc, mp, fileType, roi, out_map, scale, step, customSuffix);
 }
 
 void writeMap(int rc,
@@ -59,6 +59,37 @@ void readMap(int rc,
              int step = 1,
              const std::string& customSuffix = "");
 
+/**
+ * @brief Read a map region from file(s).
+ * @note Only the file data overlapping the region is read:
+ *       scanlines or EXR tiles of a single file map, overlapping tile files of a tiled map.
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] fileType the map fileType enum
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[out] out_map the output map region read from file(s)
+ * @param[in] scale the map downscale factor
+ * @param[in] step the map step factor
+ * @param[in] customSuffix the map filename custom suffix
+ */
+void readMap(int rc,
+             const MultiViewParams& mp,
+             const EFileType fileType,
+             const ROI& roi,
+             image::Image<float>& out_map,
+             int scale = 1,
+             int step = 1,
+             const std::string& customSuffix = "");
+
+void readMap(int rc,
+             const MultiViewParams& mp,
+             const EFileType fileType,
+             const ROI& roi,
+             image::Image<image::RGBfColor>& out_map,
+             int scale = 1,
+             int step = 1,
+             const std::string& customSuffix = "");
+
 /**
  * @brief Write a fullsize or tile map in a file.
  * @param[in] rc the related R camera index
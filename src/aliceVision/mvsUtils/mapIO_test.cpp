@@ -0,0 +1,182 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/image/all.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE mapIO
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+namespace fs = boost::filesystem;
+
+namespace {
+
+const int imageWidth = 96;
+const int imageHeight = 80;
+
+/**
+ * @brief Single view scene with an identity pose.
+ */
+sfmData::SfMData createScene()
+{
+    sfmData::SfMData sfmData;
+    sfmData.getViews().emplace(0, std::make_shared<sfmData::View>("", 0, 0, 0, imageWidth, imageHeight));
+    sfmData.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(imageWidth, imageHeight, 100.0, 100.0, 0.0, 0.0));
+    sfmData.setPose(sfmData.getView(0), sfmData::CameraPose(geometry::Pose3()));
+    return sfmData;
+}
+
+/**
+ * @brief Smooth synthetic depth map with a few invalid pixels.
+ */
+image::Image<float> createDepthMap()
+{
+    image::Image<float> depthMap(imageWidth, imageHeight);
+    for(int y = 0; y < imageHeight; ++y)
+    {
+        for(int x = 0; x < imageWidth; ++x)
+            depthMap(y, x) = ((x + y) % 17 == 0) ? -1.0f : 2.0f + 0.01f * x + 0.02f * y;
+    }
+    return depthMap;
+}
+
+/**
+ * @brief Check a map read from file(s) against the expected region of the reference map.
+ */
+void checkMap(const image::Image<float>& map, const image::Image<float>& reference, const ROI& roi, double tolerancePercent)
+{
+    BOOST_REQUIRE_EQUAL(map.Width(), roi.width());
+    BOOST_REQUIRE_EQUAL(map.Height(), roi.height());
+
+    for(int y = 0; y < map.Height(); ++y)
+    {
+        for(int x = 0; x < map.Width(); ++x)
+            BOOST_CHECK_CLOSE(map(y, x), reference(roi.y.begin + y, roi.x.begin + x), tolerancePercent);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(mapIO_halfFloatDepthMap)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("mapIO_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createScene();
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+    mp.userParams.put("mapStorage.depthDataType", image::EStorageDataType_enumToString(image::EStorageDataType::Half));
+
+    const image::Image<float> depthMap = createDepthMap();
+    mvsUtils::writeMap(0, mp, mvsUtils::EFileType::depthMap, depthMap);
+
+    const ROI imageRoi(0, imageWidth, 0, imageHeight);
+    image::Image<float> readDepthMap;
+    mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, readDepthMap);
+
+    // half float relative precision is 2^-11
+    checkMap(readDepthMap, depthMap, imageRoi, 0.05);
+
+    // region of the half float map
+    const ROI roi(13, 57, 7, 61);
+    image::Image<float> readDepthMapRegion;
+    mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, roi, readDepthMapRegion);
+    checkMap(readDepthMapRegion, depthMap, roi, 0.05);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(mapIO_tiledExrDepthMap)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("mapIO_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createScene();
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+    mp.userParams.put("mapStorage.exrTileSize", 16);
+
+    const image::Image<float> depthMap = createDepthMap();
+    mvsUtils::writeMap(0, mp, mvsUtils::EFileType::depthMap, depthMap);
+
+    const ROI imageRoi(0, imageWidth, 0, imageHeight);
+    image::Image<float> readDepthMap;
+    mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, readDepthMap);
+    checkMap(readDepthMap, depthMap, imageRoi, 1e-4);
+
+    // regions aligned and not aligned on the EXR tiles
+    for(const ROI& roi : {ROI(16, 48, 32, 64), ROI(5, 91, 3, 30), ROI(0, imageWidth, 70, imageHeight)})
+    {
+        image::Image<float> readDepthMapRegion;
+        mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, roi, readDepthMapRegion);
+        checkMap(readDepthMapRegion, depthMap, roi, 1e-4);
+    }
+
+    // region partially outside of the image is clamped
+    image::Image<float> readDepthMapClamped;
+    mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, ROI(80, 200, 60, 200), readDepthMapClamped);
+    checkMap(readDepthMapClamped, depthMap, ROI(80, imageWidth, 60, imageHeight), 1e-4);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(mapIO_tileFilesDepthMap)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("mapIO_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    const sfmData::SfMData sfmData = createScene();
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), folder.string(), false);
+
+    mvsUtils::TileParams tileParams;
+    tileParams.bufferWidth = 48;
+    tileParams.bufferHeight = 48;
+    tileParams.padding = 8;
+
+    std::vector<ROI> tileRoiList;
+    mvsUtils::getTileRoiList(tileParams, imageWidth, imageHeight, 1, tileRoiList);
+    BOOST_REQUIRE_GT(tileRoiList.size(), 1);
+
+    // write each tile of the depth map in its own file
+    const image::Image<float> depthMap = createDepthMap();
+    for(const ROI& tileRoi : tileRoiList)
+    {
+        image::Image<float> tileMap(tileRoi.width(), tileRoi.height());
+        for(int y = 0; y < tileMap.Height(); ++y)
+        {
+            for(int x = 0; x < tileMap.Width(); ++x)
+                tileMap(y, x) = depthMap(tileRoi.y.begin + y, tileRoi.x.begin + x);
+        }
+        mvsUtils::writeMap(0, mp, mvsUtils::EFileType::depthMap, tileParams, tileRoi, tileMap, 1, 1);
+    }
+
+    // tiles are blended in their padding, the weights sum to one
+    const ROI imageRoi(0, imageWidth, 0, imageHeight);
+    image::Image<float> readDepthMap;
+    mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, readDepthMap);
+    checkMap(readDepthMap, depthMap, imageRoi, 1e-3);
+
+    // regions inside a tile and across the tiles padding
+    for(const ROI& roi : {ROI(2, 20, 2, 20), ROI(30, 70, 25, 55), ROI(0, imageWidth, 40, 41)})
+    {
+        image::Image<float> readDepthMapRegion;
+        mvsUtils::readMap(0, mp, mvsUtils::EFileType::depthMap, roi, readDepthMapRegion);
+        checkMap(readDepthMapRegion, depthMap, roi, 1e-3);
+    }
+
+    fs::remove_all(folder);
+}
@@ -11,6 +11,7 @@
 
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <algorithm>
 #include <cmath>
@@ -107,6 +108,241 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
 }
 
 
+/**
+ * @brief Strategy used to evaluate the best NFA of a model from its residuals
+ */
+enum class ENFAEvaluation
+{
+  /// sort all the residuals
+  SORT,
+  /// bound the NFA per bin of a log-spaced residuals histogram and only sort the bins that can contain the best NFA
+  HISTOGRAM
+};
+
+/**
+ * @brief Buffers used by bestNFAHistogram, to avoid allocations for each evaluated model
+ */
+struct NFAHistogram
+{
+  explicit NFAHistogram(std::size_t nbBins = 64)
+    : counts(nbBins)
+    , binsMin(nbBins)
+    , binsMax(nbBins)
+    , binsLowerBound(nbBins)
+    , candidateBins(nbBins)
+  {}
+
+  std::size_t nbBins() const
+  {
+    return counts.size();
+  }
+
+  /// upper edges of the bins (except the last one)
+  std::vector<double> edges;
+  /// bin of each residual (-1 if above the admissible threshold)
+  std::vector<int> residualsBin;
+  std::vector<std::size_t> counts;
+  std::vector<double> binsMin;
+  std::vector<double> binsMax;
+  std::vector<double> binsLowerBound;
+  std::vector<char> candidateBins;
+  std::vector<double> candidates;
+  std::vector<ErrorIndex> sorted;
+};
+
+/**
+ * @brief Find best NFA and its index wrt square error threshold from unsorted residuals.
+ *
+ * The admissible residuals are binned in a log-spaced histogram. For each bin, the NFA of
+ * the ranks it contains is bounded using the minimal and maximal residual of the bin.
+ * Only the residuals of the bins whose lower bound can beat the best upper bound
+ * (and \p nfaToBeat) are sorted to compute the exact NFA, which gives the same result
+ * as bestNFA on the sorted residuals.
+ *
+ * @param[in] nfaToBeat the NFA to improve, models that cannot beat it are not evaluated
+ * @param[in,out] histogram buffers
+ * @param[out] errorMax the residual of the last inlier of the best NFA
+ * @return the best NFA and its index, (infinity, startIndex) if \p nfaToBeat cannot be improved
+ */
+inline ErrorIndex bestNFAHistogram(int startIndex, //number of point required for estimation
+                                   double logalpha0,
+                                   const std::vector<double>& residuals,
+                                   double loge0,
+                                   double maxThreshold,
+                                   const std::vector<float> &logc_n,
+                                   const std::vector<float> &logc_k,
+                                   double multError,
+                                   double nfaToBeat,
+                                   NFAHistogram& histogram,
+                                   double& errorMax)
+{
+  const ErrorIndex noImprovement(std::numeric_limits<double>::infinity(), startIndex);
+  const std::size_t n = residuals.size();
+  const std::size_t nbBins = histogram.nbBins();
+
+  // admissible residuals range
+  double minResidual = std::numeric_limits<double>::infinity();
+  double maxResidual = 0.0;
+  std::size_t nbAdmissible = 0;
+  for(const double r : residuals)
+  {
+    if(r <= maxThreshold)
+    {
+      minResidual = std::min(minResidual, r);
+      maxResidual = std::max(maxResidual, r);
+      ++nbAdmissible;
+    }
+  }
+
+  if(nbAdmissible <= static_cast<std::size_t>(startIndex))
+    return noImprovement;
+
+  // too few residuals to benefit from the histogram: sort them all
+  if(nbAdmissible < 4 * nbBins || maxResidual <= minResidual)
+  {
+    histogram.sorted.resize(n);
+    for(std::size_t i = 0; i < n; ++i)
+      histogram.sorted[i] = ErrorIndex(residuals[i], i);
+    std::sort(histogram.sorted.begin(), histogram.sorted.end());
+
+    const ErrorIndex best = bestNFA(startIndex, logalpha0, histogram.sorted, loge0, maxThreshold, logc_n, logc_k, multError);
+    if(best.first >= nfaToBeat)
+      return noImprovement;
+    errorMax = histogram.sorted[best.second - 1].first;
+    return best;
+  }
+
+  // log-spaced bins between the smallest (non-zero) and the biggest admissible residuals
+  // the bin of a residual is found by comparison with the edges so that bins are ordered by values
+  const double logLowEdge = std::log(std::max(minResidual, maxResidual * 1e-12));
+  const double logBinSize = (std::log(maxResidual) - logLowEdge) / nbBins;
+  histogram.edges.resize(nbBins - 1);
+  for(std::size_t b = 0; b < nbBins - 1; ++b)
+    histogram.edges[b] = std::exp(logLowEdge + (b + 1) * logBinSize);
+
+  std::fill(histogram.counts.begin(), histogram.counts.end(), 0);
+  std::fill(histogram.binsMin.begin(), histogram.binsMin.end(), std::numeric_limits<double>::infinity());
+  std::fill(histogram.binsMax.begin(), histogram.binsMax.end(), 0.0);
+  histogram.residualsBin.resize(n);
+
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    const double r = residuals[i];
+    if(r > maxThreshold)
+    {
+      histogram.residualsBin[i] = -1;
+      continue;
+    }
+    const int bin = std::upper_bound(histogram.edges.begin(), histogram.edges.end(), r) - histogram.edges.begin();
+    histogram.residualsBin[i] = bin;
+    ++histogram.counts[bin];
+    histogram.binsMin[bin] = std::min(histogram.binsMin[bin], r);
+    histogram.binsMax[bin] = std::max(histogram.binsMax[bin], r);
+  }
+
+  // NFA bounds of each bin, the bins are ordered by residuals values
+  std::vector<double>& binsLowerBound = histogram.binsLowerBound;
+  std::fill(binsLowerBound.begin(), binsLowerBound.end(), std::numeric_limits<double>::infinity());
+  double bestUpperBound = std::numeric_limits<double>::infinity();
+  double bestLowerBound = std::numeric_limits<double>::infinity();
+  {
+    std::size_t rankEnd = 0;
+    for(std::size_t b = 0; b < nbBins; ++b)
+    {
+      const std::size_t rankBegin = rankEnd;
+      rankEnd += histogram.counts[b];
+
+      const std::size_t kBegin = std::max(rankBegin + 1, static_cast<std::size_t>(startIndex) + 1);
+      if(kBegin > rankEnd)
+        continue;
+
+      const double logalphaLow = logalpha0 + multError * log10(histogram.binsMin[b] + std::numeric_limits<float>::epsilon());
+      const double logalphaHigh = logalpha0 + multError * log10(histogram.binsMax[b] + std::numeric_limits<float>::epsilon());
+
+      for(std::size_t k = kBegin; k <= rankEnd; ++k)
+      {
+        const double logc = loge0 + logc_n[k] + logc_k[k];
+        const double nbInliers = static_cast<double>(k - startIndex);
+        binsLowerBound[b] = std::min(binsLowerBound[b], logc + logalphaLow * nbInliers);
+        bestUpperBound = std::min(bestUpperBound, logc + logalphaHigh * nbInliers);
+      }
+      bestLowerBound = std::min(bestLowerBound, binsLowerBound[b]);
+    }
+  }
+
+  if(bestLowerBound >= nfaToBeat)
+    return noImprovement;
+
+  // gather and sort the residuals of the bins that can contain the best NFA
+  const double bound = std::min(nfaToBeat, bestUpperBound);
+  for(std::size_t b = 0; b < nbBins; ++b)
+    histogram.candidateBins[b] = (binsLowerBound[b] <= bound);
+
+  histogram.candidates.clear();
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    const int bin = histogram.residualsBin[i];
+    if(bin >= 0 && histogram.candidateBins[bin])
+      histogram.candidates.push_back(residuals[i]);
+  }
+  std::sort(histogram.candidates.begin(), histogram.candidates.end());
+
+  // exact NFA evaluation on the candidate ranks
+  ErrorIndex bestIndex = noImprovement;
+  std::size_t rankEnd = 0;
+  std::size_t candidateIndex = 0;
+  for(std::size_t b = 0; b < nbBins; ++b)
+  {
+    const std::size_t rankBegin = rankEnd;
+    rankEnd += histogram.counts[b];
+    if(!histogram.candidateBins[b])
+      continue;
+
+    for(std::size_t k = rankBegin + 1; k <= rankEnd; ++k, ++candidateIndex)
+    {
+      if(k <= static_cast<std::size_t>(startIndex))
+        continue;
+
+      const double error = histogram.candidates[candidateIndex];
+      const double logalpha = logalpha0 + multError * log10(error + std::numeric_limits<float>::epsilon());
+      const double nfa = loge0 + logalpha * (double) (k - startIndex) + logc_n[k] + logc_k[k];
+
+      if(nfa < bestIndex.first)
+      {
+        bestIndex = ErrorIndex(nfa, k);
+        errorMax = error;
+      }
+    }
+  }
+
+  if(bestIndex.first >= nfaToBeat)
+    return noImprovement;
+  return bestIndex;
+}
+
+/**
+ * @brief Sort the residuals lower or equal to \p errorMax and return the \p nbInliers smallest ones,
+ * with the same order as a full sort of the residuals.
+ */
+inline void sortedInliers(const std::vector<double>& residuals,
+                          double errorMax,
+                          std::size_t nbInliers,
+                          std::vector<ErrorIndex>& buffer,
+                          std::vector<std::size_t>& inliers)
+{
+  buffer.clear();
+  for(std::size_t i = 0; i < residuals.size(); ++i)
+  {
+    if(residuals[i] <= errorMax)
+      buffer.emplace_back(residuals[i], i);
+  }
+  std::sort(buffer.begin(), buffer.end());
+
+  inliers.resize(nbInliers);
+  for(std::size_t i = 0; i < nbInliers; ++i)
+    inliers[i] = buffer[i].second;
+}
+
 /**
  * @brief An implementation of the "Random Sample Consensus" algorithm based on a-contrario estimator
  * to automatically estimate the error threshold.
@@ -135,6 +371,7 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] nfaEvaluation strategy used to evaluate the NFA of each model
  *
  * @return (errorMax, minNFA)
  */
@@ -144,7 +381,8 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                    std::vector<size_t>& vec_inliers,
                                    std::size_t nIter = 1024,
                                    typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+                                   double precision = std::numeric_limits<double>::infinity(),
+                                   ENFAEvaluation nfaEvaluation = ENFAEvaluation::HISTOGRAM)
 {
   vec_inliers.clear();
 
@@ -159,6 +397,7 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
 
   std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
   std::vector<double> vec_residuals_(nData);
+  NFAHistogram histogram;
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
   std::vector<size_t> vec_index(nData);
@@ -209,8 +448,44 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
         if (nInlier > 2.5 * sizeSample) // does the model is meaningful
           bACRansacMode = true;
       }
-      if (bACRansacMode)
+      if (bACRansacMode && nfaEvaluation == ENFAEvaluation::HISTOGRAM)
+      {
+        // Most meaningful discrimination inliers/outliers, only if it can beat the current best model
+        double modelErrorMax = 0.0;
+        const ErrorIndex best = bestNFAHistogram(
+          sizeSample,
+          kernel.logalpha0(),
+          vec_residuals_,
+          loge0,
+          maxThreshold,
+          vec_logc_n,
+          vec_logc_k,
+          kernel.multError(),
+          minNFA,
+          histogram,
+          modelErrorMax);
+
+        if (best.first < minNFA)
+        {
+          // A better model was found
+          better = true;
+          minNFA = best.first;
+          sortedInliers(vec_residuals_, modelErrorMax, best.second, vec_residuals, vec_inliers);
+          errorMax = modelErrorMax; // Error threshold
+          if(model) *model = vec_models[k];
+
+          ALICEVISION_LOG_TRACE("  nfa=" << minNFA
+            << " inliers=" << best.second << "/" << nData
+            << " precisionNormalized=" << errorMax
+            << " precision=" << kernel.unormalizeError(errorMax)
+            << " (iter=" << iter
+            << ",sample=" << vec_sample
+            << ")");
+        }
+      }
+      else if (bACRansacMode)
       {
+        vec_residuals.resize(nData);
         for (size_t i = 0; i < nData; ++i)
         {
           const double error = vec_residuals_[i];
@@ -290,5 +565,267 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
   return std::make_pair(errorMax, minNFA);
 }
 
+/**
+ * @brief Parallel version of ACRANSAC: hypotheses are generated and scored
+ * by batches of \p batchSize across threads and the best model of each batch is merged.
+ *
+ * Each hypothesis uses its own random generator seeded from \p randomNumberGenerator
+ * and the batches are merged in order, so the result only depends on the input generator
+ * and the batch size, not on the thread scheduling.
+ * The AC-RANSAC focused sampling is applied between batches.
+ *
+ * @note Kernel::fit and Kernel::errors are called concurrently and must be thread-safe.
+ *
+ * @param[in] kernel model and metric object
+ * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] nIter maximum number of consecutive iterations
+ * @param[out] model returned model if found
+ * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] nbThreads number of threads (0: use all the available threads)
+ * @param[in] batchSize number of hypotheses evaluated concurrently
+ * @param[in] nfaEvaluation strategy used to evaluate the NFA of each model
+ *
+ * @return (errorMax, minNFA)
+ */
+template<typename Kernel>
+std::pair<double, double> ACRANSAC_parallel(const Kernel& kernel,
+                                            std::mt19937 &randomNumberGenerator,
+                                            std::vector<size_t>& vec_inliers,
+                                            std::size_t nIter = 1024,
+                                            typename Kernel::ModelT* model = nullptr,
+                                            double precision = std::numeric_limits<double>::infinity(),
+                                            int nbThreads = 0,
+                                            std::size_t batchSize = 32,
+                                            ENFAEvaluation nfaEvaluation = ENFAEvaluation::HISTOGRAM)
+{
+  vec_inliers.clear();
+
+  const std::size_t sizeSample = kernel.getMinimumNbRequiredSamples();
+  const std::size_t nData = kernel.nbSamples();
+  if (nData <= (std::size_t)sizeSample)
+    return std::make_pair(0.0,0.0);
+
+  const double maxThreshold = (precision==std::numeric_limits<double>::infinity()) ?
+    std::numeric_limits<double>::infinity() :
+    precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
+
+  const int nbWorkers = (nbThreads > 0) ? nbThreads : omp_get_max_threads();
+  batchSize = std::max(batchSize, std::size_t(1));
+
+  // Possible sampling indices [0,..,nData] (will change in the optimization phase)
+  std::vector<size_t> vec_index(nData);
+  std::iota(vec_index.begin(), vec_index.end(), 0);
+
+  // Precompute log combi
+  const double loge0 = log10((double)kernel.getMaximumNbModels() * (nData-sizeSample));
+  std::vector<float> vec_logc_n, vec_logc_k;
+  makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
+
+  // Output parameters
+  double minNFA = std::numeric_limits<double>::infinity();
+  double errorMax = std::numeric_limits<double>::infinity();
+
+  // Reserve 10% of iterations for focused sampling
+  size_t nIterReserve = nIter/10;
+  nIter -= nIterReserve;
+
+  bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
+
+  // Best model found by each hypothesis of the current batch
+  struct Hypothesis
+  {
+    ErrorIndex best;
+    double errorMax;
+    bool meaningful;
+    typename Kernel::ModelT model;
+    std::vector<std::size_t> inliers;
+  };
+
+  std::vector<Hypothesis> hypotheses(batchSize);
+  std::vector<std::mt19937::result_type> seeds(batchSize);
+
+  // Per-thread residuals buffers
+  std::vector<std::vector<double>> residualsPerThread(nbWorkers, std::vector<double>(nData));
+  std::vector<std::vector<ErrorIndex>> sortedResidualsPerThread(nbWorkers, std::vector<ErrorIndex>(nData));
+  std::vector<NFAHistogram> histogramPerThread(nbWorkers);
+
+  // Main estimation loop, one batch of hypotheses at a time.
+  for(std::size_t iter = 0; iter < nIter;)
+  {
+    const std::size_t nbHypotheses = std::min(batchSize, nIter - iter);
+    for(std::size_t h = 0; h < nbHypotheses; ++h)
+      seeds[h] = randomNumberGenerator();
+
+    const bool batchACRansacMode = bACRansacMode;
+    const double batchMinNFA = minNFA;
+
+    #pragma omp parallel for num_threads(nbWorkers) schedule(dynamic)
+    for(int h = 0; h < static_cast<int>(nbHypotheses); ++h)
+    {
+      Hypothesis& hypothesis = hypotheses[h];
+      hypothesis.best = ErrorIndex(std::numeric_limits<double>::infinity(), sizeSample);
+      hypothesis.meaningful = false;
+      hypothesis.inliers.clear();
+
+      std::vector<double>& residuals = residualsPerThread[omp_get_thread_num()];
+      std::vector<ErrorIndex>& sortedResiduals = sortedResidualsPerThread[omp_get_thread_num()];
+
+      std::mt19937 hypothesisGenerator(seeds[h]);
+
+      std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
+      if (batchACRansacMode)
+        uniformSample(hypothesisGenerator, sizeSample, vec_index, vec_sample); // Get random sample
+      else
+        uniformSample(hypothesisGenerator, sizeSample, nData, vec_sample); // Get random sample
+
+      std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+      kernel.fit(vec_sample, vec_models);
+
+      bool hypothesisACRansacMode = batchACRansacMode;
+
+      // Evaluate models
+      for (std::size_t k = 0; k < vec_models.size(); ++k)
+      {
+        kernel.errors(vec_models[k], residuals);
+
+        if (!hypothesisACRansacMode)
+        {
+          unsigned int nInlier = 0;
+          for (std::size_t i = 0; i < nData; ++i)
+          {
+            if (residuals[i] <= maxThreshold)
+              ++nInlier;
+          }
+          if (nInlier > 2.5 * sizeSample) // does the model is meaningful
+          {
+            hypothesisACRansacMode = true;
+            hypothesis.meaningful = true;
+          }
+        }
+        if (!hypothesisACRansacMode)
+          continue;
+
+        if (nfaEvaluation == ENFAEvaluation::HISTOGRAM)
+        {
+          // only evaluate the models that can beat the best one of the previous batches
+          double modelErrorMax = 0.0;
+          const ErrorIndex best = bestNFAHistogram(
+            sizeSample,
+            kernel.logalpha0(),
+            residuals,
+            loge0,
+            maxThreshold,
+            vec_logc_n,
+            vec_logc_k,
+            kernel.multError(),
+            std::min(batchMinNFA, hypothesis.best.first),
+            histogramPerThread[omp_get_thread_num()],
+            modelErrorMax);
+
+          if (best.first < hypothesis.best.first)
+          {
+            hypothesis.best = best;
+            sortedInliers(residuals, modelErrorMax, best.second, sortedResiduals, hypothesis.inliers);
+            hypothesis.errorMax = modelErrorMax;
+            hypothesis.model = vec_models[k];
+          }
+          continue;
+        }
+
+        sortedResiduals.resize(nData);
+        for (size_t i = 0; i < nData; ++i)
+          sortedResiduals[i] = ErrorIndex(residuals[i], i);
+        std::sort(sortedResiduals.begin(), sortedResiduals.end());
+
+        // Most meaningful discrimination inliers/outliers
+        const ErrorIndex best = bestNFA(
+          sizeSample,
+          kernel.logalpha0(),
+          sortedResiduals,
+          loge0,
+          maxThreshold,
+          vec_logc_n,
+          vec_logc_k,
+          kernel.multError());
+
+        if (best.first < hypothesis.best.first)
+        {
+          hypothesis.best = best;
+          hypothesis.inliers.resize(best.second);
+          for (size_t i = 0; i < best.second; ++i)
+            hypothesis.inliers[i] = sortedResiduals[i].second;
+          hypothesis.errorMax = sortedResiduals[best.second-1].first;
+          hypothesis.model = vec_models[k];
+        }
+      }
+    }
+
+    // Merge the batch in hypotheses order
+    bool better = false;
+    for (std::size_t h = 0; h < nbHypotheses; ++h)
+    {
+      Hypothesis& hypothesis = hypotheses[h];
+      if (hypothesis.meaningful)
+        bACRansacMode = true;
+
+      if (hypothesis.best.first < minNFA)
+      {
+        // A better model was found
+        better = true;
+        minNFA = hypothesis.best.first;
+        vec_inliers.swap(hypothesis.inliers);
+        errorMax = hypothesis.errorMax; // Error threshold
+        if(model) *model = hypothesis.model;
+
+        ALICEVISION_LOG_TRACE("  nfa=" << minNFA
+          << " inliers=" << vec_inliers.size() << "/" << nData
+          << " precisionNormalized=" << errorMax
+          << " precision=" << kernel.unormalizeError(errorMax)
+          << " (iter=" << iter + h << ")");
+      }
+    }
+    iter += nbHypotheses;
+
+    // Early exit test -> no meaningful model found after nIterReserve*2 iterations
+    if (!bACRansacMode && iter > nIterReserve*2)
+      break;
+
+    // ACRANSAC optimization: draw samples among best set of inliers so far
+    if (bACRansacMode && ((better && minNFA<0) || (iter==nIter && nIterReserve)))
+    {
+      if (vec_inliers.empty())
+      {
+        // No model found at all so far
+        // Continue to look for any model, even not meaningful
+        const std::size_t nbExtraIter = std::min(nIterReserve, batchSize);
+        nIter += nbExtraIter;
+        nIterReserve -= nbExtraIter;
+      }
+      else
+      {
+        // ACRANSAC optimization: draw samples among best set of inliers so far
+        vec_index = vec_inliers;
+        if(nIterReserve)
+        {
+          nIter = iter + nIterReserve;
+          nIterReserve = 0;
+        }
+      }
+    }
+  }
+
+  if(minNFA >= 0)
+    vec_inliers.clear();
+
+  if (!vec_inliers.empty())
+  {
+    if (model)
+      kernel.unnormalize(*model);
+    errorMax = kernel.unormalizeError(errorMax);
+  }
+
+  return std::make_pair(errorMax, minNFA);
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
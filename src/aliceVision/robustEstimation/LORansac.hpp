@@ -10,6 +10,7 @@
 #include <aliceVision/robustEstimation/ACRansac.hpp>
 #include <aliceVision/robustEstimation/ransacTools.hpp>
 #include <aliceVision/robustEstimation/IRansacKernel.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <limits>
 #include <numeric>
 #include <iostream>
@@ -422,5 +423,173 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
   return bestModel;  
 }
 
+/**
+ * @brief Parallel version of LO_RANSAC: minimal hypotheses are generated and scored
+ * by batches of \p batchSize across threads, then the local optimization is run
+ * on the best hypothesis of each batch.
+ *
+ * Each hypothesis uses its own random generator seeded from \p randomNumberGenerator
+ * and the batches are merged in order, so the result only depends on the input generator
+ * and the batch size, not on the thread scheduling.
+ *
+ * @note Kernel::fit and Scorer::score are called concurrently and must be thread-safe.
+ *
+ * @param[in] kernel The kernel containing the problem to solve.
+ * @param[in] scorer The scorer used to asses the model quality.
+ * @param[out] best_inliers The indices of the samples supporting the best model.
+ * @param[out] best_score The score of the best model, ie the number of inliers
+ * supporting the best model.
+ * @param[in] bVerbose Enable/Disable log messages
+ * @param[in] max_iterations Maximum number of iterations for the ransac part.
+ * @param[in] outliers_probability The wanted probability of picking outliers.
+ * @param[in] nbThreads number of threads (0: use all the available threads)
+ * @param[in] batchSize number of hypotheses evaluated concurrently
+ * @return The best model found.
+ */
+template<typename Kernel, typename Scorer>
+typename Kernel::ModelT LO_RANSAC_parallel(const Kernel& kernel,
+                                           const Scorer& scorer,
+                                           std::mt19937 & randomNumberGenerator,
+                                           std::vector<std::size_t>* best_inliers = NULL,
+                                           double* best_score = NULL,
+                                           bool bVerbose = false,
+                                           std::size_t max_iterations = 100,
+                                           double outliers_probability = 1e-2,
+                                           int nbThreads = 0,
+                                           std::size_t batchSize = 32)
+{
+  assert(outliers_probability < 1.0);
+  assert(outliers_probability > 0.0);
+  const std::size_t min_samples = kernel.getMinimumNbRequiredSamples();
+  const std::size_t total_samples = kernel.nbSamples();
+
+  const std::size_t really_max_iterations = 4096;
+
+  std::size_t bestNumInliers = 0;
+  typename Kernel::ModelT bestModel;
+
+  // Test if we have sufficient points for the kernel.
+  if (total_samples < min_samples)
+  {
+    if (best_inliers) {
+      best_inliers->clear();
+    }
+    return bestModel;
+  }
+
+  const int nbWorkers = (nbThreads > 0) ? nbThreads : omp_get_max_threads();
+  batchSize = std::max(batchSize, std::size_t(1));
+
+  // In this robust estimator, the scorer always works on all the data points
+  // at once. So precompute the list ahead of time [0,..,total_samples].
+  std::vector<std::size_t> all_samples(total_samples);
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+
+  // Best model found by each hypothesis of the current batch
+  struct Hypothesis
+  {
+    bool valid;
+    typename Kernel::ModelT model;
+    std::vector<std::size_t> inliers;
+  };
+
+  std::vector<Hypothesis> hypotheses(batchSize);
+  std::vector<std::mt19937::result_type> seeds(batchSize);
+
+  for(std::size_t iteration = 0; iteration < max_iterations;)
+  {
+    const std::size_t nbHypotheses = std::min(batchSize, max_iterations - iteration);
+    for(std::size_t h = 0; h < nbHypotheses; ++h)
+      seeds[h] = randomNumberGenerator();
+
+    #pragma omp parallel for num_threads(nbWorkers) schedule(dynamic)
+    for(int h = 0; h < static_cast<int>(nbHypotheses); ++h)
+    {
+      Hypothesis& hypothesis = hypotheses[h];
+      hypothesis.valid = false;
+      hypothesis.inliers.clear();
+
+      std::mt19937 hypothesisGenerator(seeds[h]);
+
+      std::vector<std::size_t> sample;
+      uniformSample(hypothesisGenerator, min_samples, total_samples, sample);
+
+      std::vector<typename Kernel::ModelT> models;
+      kernel.fit(sample, models);
+
+      // Keep the model with the biggest inliers set
+      for(std::size_t i = 0; i < models.size(); ++i)
+      {
+        std::vector<std::size_t> inliers;
+        scorer.score(kernel, models.at(i), all_samples, inliers);
+
+        if(!hypothesis.valid || hypothesis.inliers.size() <= inliers.size())
+        {
+          hypothesis.valid = true;
+          hypothesis.model = models[i];
+          hypothesis.inliers.swap(inliers);
+        }
+      }
+    }
+    iteration += nbHypotheses;
+
+    // Select the best hypothesis of the batch (first one in case of equality)
+    int bestHypothesis = -1;
+    for(std::size_t h = 0; h < nbHypotheses; ++h)
+    {
+      if(hypotheses[h].valid &&
+         (bestHypothesis < 0 || hypotheses[h].inliers.size() > hypotheses[bestHypothesis].inliers.size()))
+        bestHypothesis = h;
+    }
+
+    if(bestHypothesis < 0 || bestNumInliers > hypotheses[bestHypothesis].inliers.size())
+      continue;
+
+    Hypothesis& hypothesis = hypotheses[bestHypothesis];
+    bestModel = hypothesis.model;
+    std::vector<std::size_t>& inliers = hypothesis.inliers;
+
+    //** LOCAL OPTIMIZATION
+    double score = 0.0;
+    if(inliers.size() > kernel.getMinimumNbRequiredSamplesLS())
+    {
+      score = localOptimization(kernel, scorer, randomNumberGenerator, bestModel, inliers);
+    }
+
+    bestNumInliers = inliers.size();
+    const double bestInlierRatio = inliers.size() / double(total_samples);
+
+    if (best_inliers)
+    {
+      best_inliers->swap(inliers);
+    }
+
+    if(bVerbose)
+    {
+      ALICEVISION_LOG_DEBUG(" inliers=" << bestNumInliers << "/" << total_samples
+                << " (iter=" << iteration
+                << " ,score=" << score
+                << ")");
+    }
+    if (bestInlierRatio)
+    {
+      max_iterations = iterationsRequired(min_samples,
+                                          outliers_probability,
+                                          bestInlierRatio);
+      // safeguard to not get stuck in a big number of iterations
+      max_iterations = std::min(max_iterations, really_max_iterations);
+      if(bVerbose)
+        ALICEVISION_LOG_DEBUG("New max_iteration: " << max_iterations);
+    }
+  }
+  if (best_score)
+    *best_score = bestNumInliers;
+
+  if(bestNumInliers)
+    kernel.unnormalize(bestModel);
+
+  return bestModel;
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace aliceVision {
 namespace robustEstimation{
 
@@ -28,10 +30,17 @@ public:
                std::vector<T>& inliers,
                double threshold) const
   {
+    // when scoring against all the samples, evaluate the residuals in one batched call
+    // instead of one virtual call per sample
+    std::vector<double> residuals;
+    const bool batched = (samples.size() == kernel.nbSamples());
+    if(batched)
+      kernel.errors(model, residuals);
+
     double cost = 0.0;
     for(std::size_t j = 0; j < samples.size(); ++j)
     {
-      double error = kernel.error(samples.at(j), model);
+      const double error = batched ? residuals[samples[j]] : kernel.error(samples.at(j), model);
       if (error < threshold) 
       {
         cost += error;
@@ -18,6 +18,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 
+#include <chrono>
 #include <iterator>
 #include <random>
 
@@ -159,6 +160,53 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase)
   BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 1e-9);
 }
 
+// test the parallel ACRANSAC on the realistic case and its reproducibility wrt the number of threads
+BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase_Parallel)
+{
+  const int NbPoints = 100;
+  const float outlierRatio = .3;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 6.3 x + (-2.0)
+  GTModel << -2.0, 6.3;
+
+  for(Mat::Index i = 0; i < NbPoints; ++i)
+  {
+    xy.col(i) << i, (double) i * GTModel[1] + GTModel[0];
+  }
+
+  std::mt19937 gen;
+  std::normal_distribution<> d(0, 5);
+
+  const int nbPtToNoise = (int) NbPoints * outlierRatio;
+  for(int i = 0; i < nbPtToNoise; ++i)
+  {
+    xy.col(i) << d(gen), d(gen);
+  }
+
+  LineKernel lineKernel(xy, 12, 12);
+
+  std::vector<std::vector<std::size_t>> inliersPerRun;
+  for(const int nbThreads : {1, 2, 4})
+  {
+    std::mt19937 randomNumberGenerator;
+    std::vector<std::size_t> inliers;
+    robustEstimation::MatrixModel<Vec2> model;
+
+    ACRANSAC_parallel(lineKernel, randomNumberGenerator, inliers, 300, &model,
+                      std::numeric_limits<double>::infinity(), nbThreads, 16);
+
+    BOOST_CHECK_EQUAL(NbPoints - nbPtToNoise, inliers.size());
+    BOOST_CHECK_SMALL(GTModel(0) - model.getMatrix()[0], 1e-9);
+    BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 1e-9);
+    inliersPerRun.push_back(inliers);
+  }
+
+  // same random generator and batch size give the same result whatever the number of threads
+  for(const auto& inliers : inliersPerRun)
+    BOOST_CHECK(inliers == inliersPerRun.front());
+}
+
 // generate nbPoints along a line and add gaussian noise.
 // move some point in the dataset to create outlier contamined data
 void generateLine(Mat & points, std::size_t nbPoints, int W, int H, float noise, float outlierRatio)
@@ -271,3 +319,49 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
 
   }
 }
+
+// compare the histogram based NFA evaluation with the full sort on a large noisy dataset
+BOOST_AUTO_TEST_CASE(RansacLineFitter_NFAEvaluation)
+{
+  const int S = 2000;
+  const float outlierRatio = .3f;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+  std::mt19937 gen;
+
+  for(const double gaussianNoiseLevel : {0.0, 0.5, 2.0, 5.0})
+  {
+    const std::size_t numPoints = 2.0 * S * sqrt(2.0);
+
+    Mat2X points(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, points, vec_inliersGT);
+
+    LineKernel lineKernel(points, S, S);
+
+    std::vector<std::pair<double, double>> results;
+    std::vector<std::vector<std::size_t>> inliers;
+    for(const ENFAEvaluation nfaEvaluation : {ENFAEvaluation::SORT, ENFAEvaluation::HISTOGRAM})
+    {
+      std::mt19937 randomNumberGenerator;
+      std::vector<std::size_t> vec_inliers;
+      robustEstimation::MatrixModel<Vec2> model;
+
+      const auto start = std::chrono::steady_clock::now();
+      results.push_back(ACRANSAC(lineKernel, randomNumberGenerator, vec_inliers, 1000, &model,
+                                 std::numeric_limits<double>::infinity(), nfaEvaluation));
+      const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+      ALICEVISION_LOG_INFO("noise: " << gaussianNoiseLevel
+                           << ", NFA evaluation " << (nfaEvaluation == ENFAEvaluation::SORT ? "sort" : "histogram")
+                           << ": " << elapsed << " ms, NFA: " << results.back().second
+                           << ", inliers: " << vec_inliers.size());
+      inliers.push_back(vec_inliers);
+    }
+
+    // same best model
+    BOOST_CHECK_CLOSE(results[0].second, results[1].second, 1e-6);
+    BOOST_CHECK_CLOSE(results[0].first, results[1].first, 1e-6);
+    BOOST_CHECK(inliers[0] == inliers[1]);
+  }
+}
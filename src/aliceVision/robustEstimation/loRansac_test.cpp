@@ -113,3 +113,37 @@ BOOST_AUTO_TEST_CASE(LoRansacLineFitter_RealCaseLoRansac)
     BOOST_CHECK_EQUAL(expectedInliers, inliers.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(LoRansacLineFitter_RealCaseLoRansac_Parallel)
+{
+  const std::size_t numPoints = 300;
+  const double outlierRatio = .3;
+  const double gaussianNoiseLevel = 0.01;
+  const std::size_t expectedInliers = numPoints - (std::size_t) numPoints * outlierRatio;
+
+  Vec2 GTModel;
+  GTModel << -2, .3;
+
+  std::mt19937 gen;
+  Mat2X xy(2, numPoints);
+  std::vector<std::size_t> vec_inliersGT;
+  generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, xy, vec_inliersGT);
+
+  const LineKernel kernel(xy);
+  const ScoreEvaluator<LineKernel> scorer(3 * gaussianNoiseLevel);
+
+  std::vector<std::vector<std::size_t>> inliersPerRun;
+  for(const int nbThreads : {1, 2, 4})
+  {
+    std::mt19937 randomNumberGenerator;
+    std::vector<std::size_t> inliers;
+    LO_RANSAC_parallel(kernel, scorer, randomNumberGenerator, &inliers, nullptr, false, 100, 1e-2, nbThreads, 16);
+
+    BOOST_CHECK_EQUAL(expectedInliers, inliers.size());
+    inliersPerRun.push_back(inliers);
+  }
+
+  // same random generator and batch size give the same result whatever the number of threads
+  for(const auto& inliers : inliersPerRun)
+    BOOST_CHECK(inliers == inliersPerRun.front());
+}
@@ -8,12 +8,17 @@
 #include <aliceVision/sfm/FrustumFilter.hpp>
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/types.hpp>
 #include <aliceVision/geometry/HalfPlane.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
+#include <Eigen/Geometry>
+
+#include <algorithm>
 #include <fstream>
 
 namespace aliceVision {
@@ -58,15 +63,173 @@ void FrustumFilter::initFrustum(const sfmData::SfMData& sfmData)
   }
 }
 
-PairSet FrustumFilter::getFrustumIntersectionPairs() const
+std::string EFrustumPairGenerator_enumToString(EFrustumPairGenerator generator)
+{
+  switch(generator)
+  {
+    case EFrustumPairGenerator::EXHAUSTIVE: return "Exhaustive";
+    case EFrustumPairGenerator::BVH:        return "BVH";
+  }
+  throw std::out_of_range("Invalid EFrustumPairGenerator enum: " + std::to_string(int(generator)));
+}
+
+EFrustumPairGenerator EFrustumPairGenerator_stringToEnum(const std::string& generator)
+{
+  std::string g = generator;
+  std::transform(g.begin(), g.end(), g.begin(), ::tolower);
+
+  if(g == "exhaustive")
+    return EFrustumPairGenerator::EXHAUSTIVE;
+  if(g == "bvh")
+    return EFrustumPairGenerator::BVH;
+
+  throw std::out_of_range("Invalid EFrustumPairGenerator: " + generator);
+}
+
+std::ostream& operator<<(std::ostream& os, EFrustumPairGenerator generator)
+{
+  return os << EFrustumPairGenerator_enumToString(generator);
+}
+
+std::istream& operator>>(std::istream& in, EFrustumPairGenerator& generator)
+{
+  std::string token;
+  in >> token;
+  generator = EFrustumPairGenerator_stringToEnum(token);
+  return in;
+}
+
+namespace {
+
+using AABB = Eigen::AlignedBox3d;
+
+/**
+ * @brief Bounding volume hierarchy over a set of axis-aligned bounding boxes.
+ *        Nodes are stored in a flat array, leaves reference a contiguous range of items.
+ */
+class BoxBVH
+{
+public:
+  BoxBVH(const std::vector<AABB>& boxes, const std::vector<int>& items)
+    : _boxes(boxes)
+    , _items(items)
+  {
+    if(!_items.empty())
+    {
+      _nodes.reserve(2 * _items.size() / _leafSize + 1);
+      build(0, _items.size());
+    }
+  }
+
+  std::size_t nbNodes() const
+  {
+    return _nodes.size();
+  }
+
+  /**
+   * @brief Call visitor(item) for each item whose box intersects the query box
+   */
+  template <typename Visitor>
+  void query(const AABB& box, Visitor&& visitor) const
+  {
+    if(_nodes.empty())
+      return;
+
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+
+    while(!stack.empty())
+    {
+      const Node& node = _nodes[stack.back()];
+      stack.pop_back();
+
+      if(!node.box.intersects(box))
+        continue;
+
+      if(node.left < 0) // leaf
+      {
+        for(int k = node.begin; k < node.end; ++k)
+        {
+          const int item = _items[k];
+          if(_boxes[item].intersects(box))
+            visitor(item);
+        }
+        continue;
+      }
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+  }
+
+private:
+  struct Node
+  {
+    AABB box;
+    int left = -1;
+    int right = -1;
+    int begin = 0;
+    int end = 0;
+  };
+
+  int build(int begin, int end)
+  {
+    const int nodeIndex = _nodes.size();
+    _nodes.emplace_back();
+
+    AABB box;
+    for(int k = begin; k < end; ++k)
+      box.extend(_boxes[_items[k]]);
+
+    _nodes[nodeIndex].box = box;
+    _nodes[nodeIndex].begin = begin;
+    _nodes[nodeIndex].end = end;
+
+    if(end - begin <= _leafSize)
+      return nodeIndex;
+
+    // median split along the largest axis of the node box
+    int axis;
+    box.sizes().maxCoeff(&axis);
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(_items.begin() + begin, _items.begin() + middle, _items.begin() + end,
+                     [&](int a, int b) { return _boxes[a].center()(axis) < _boxes[b].center()(axis); });
+
+    const int left = build(begin, middle);
+    const int right = build(middle, end);
+    _nodes[nodeIndex].left = left;
+    _nodes[nodeIndex].right = right;
+    return nodeIndex;
+  }
+
+  static constexpr int _leafSize = 4;
+  const std::vector<AABB>& _boxes;
+  std::vector<int> _items;
+  std::vector<Node> _nodes;
+};
+
+} // namespace
+
+PairSet FrustumFilter::getFrustumIntersectionPairs(EFrustumPairGenerator generator) const
 {
-  PairSet pairs;
   // List active view Id
   std::vector<IndexT> viewIds;
   viewIds.reserve(z_near_z_far_perView.size());
   std::transform(z_near_z_far_perView.begin(), z_near_z_far_perView.end(),
     std::back_inserter(viewIds), stl::RetrieveKey());
 
+  switch(generator)
+  {
+    case EFrustumPairGenerator::EXHAUSTIVE: return getFrustumIntersectionPairsExhaustive(viewIds);
+    case EFrustumPairGenerator::BVH:        return getFrustumIntersectionPairsBVH(viewIds);
+  }
+  throw std::out_of_range("Invalid EFrustumPairGenerator enum: " + std::to_string(int(generator)));
+}
+
+PairSet FrustumFilter::getFrustumIntersectionPairsExhaustive(const std::vector<IndexT>& viewIds) const
+{
+  PairSet pairs;
+
   auto progressDisplay = system::createConsoleProgressDisplay(viewIds.size() * (viewIds.size()-1)/2,
                                                               std::cout, "\nCompute frustum intersection\n");
 
@@ -89,6 +252,84 @@ PairSet FrustumFilter::getFrustumIntersectionPairs() const
   return pairs;
 }
 
+PairSet FrustumFilter::getFrustumIntersectionPairsBVH(const std::vector<IndexT>& viewIds) const
+{
+  const int nbViews = viewIds.size();
+
+  // Only truncated frustums have a finite bounding box,
+  // the other ones have to be tested against all the views.
+  std::vector<const Frustum*> frustums(nbViews);
+  std::vector<AABB> boxes(nbViews);
+  std::vector<int> boundedIndexes;
+  std::vector<int> unboundedIndexes;
+
+  for(int i = 0; i < nbViews; ++i)
+  {
+    frustums[i] = &frustum_perView.at(viewIds[i]);
+    if(frustums[i]->isTruncated())
+    {
+      for(const Vec3& point : frustums[i]->frustum_points())
+        boxes[i].extend(point);
+      boundedIndexes.push_back(i);
+    }
+    else
+    {
+      unboundedIndexes.push_back(i);
+    }
+  }
+
+  const BoxBVH bvh(boxes, boundedIndexes);
+
+  ALICEVISION_LOG_INFO("Frustum intersection BVH: " << boundedIndexes.size() << " bounded frustums ("
+                       << bvh.nbNodes() << " nodes), " << unboundedIndexes.size() << " unbounded frustums.");
+  if(!unboundedIndexes.empty())
+    ALICEVISION_LOG_WARNING("Frustums without near and far planes cannot be culled by the BVH.");
+
+  // each thread accumulates its own pairs, merged at the end
+  std::vector<PairVec> pairsPerThread(omp_get_max_threads());
+  std::size_t nbTestedPairs = 0;
+
+  auto progressDisplay = system::createConsoleProgressDisplay(nbViews, std::cout, "\nCompute frustum intersection\n");
+
+  // Each unordered pair {i, j} is only tested from its smallest index
+  #pragma omp parallel for schedule(dynamic) reduction(+:nbTestedPairs)
+  for(int i = 0; i < nbViews; ++i)
+  {
+    PairVec& threadPairs = pairsPerThread[omp_get_thread_num()];
+
+    const auto testPair = [&](int j)
+    {
+      if(j <= i)
+        return;
+      ++nbTestedPairs;
+      if(frustums[i]->intersect(*frustums[j]))
+        threadPairs.emplace_back(viewIds[i], viewIds[j]);
+    };
+
+    if(frustums[i]->isTruncated())
+    {
+      bvh.query(boxes[i], testPair);
+      for(int j : unboundedIndexes)
+        testPair(j);
+    }
+    else
+    {
+      for(int j = i + 1; j < nbViews; ++j)
+        testPair(j);
+    }
+    ++progressDisplay;
+  }
+
+  PairSet pairs;
+  for(const PairVec& threadPairs : pairsPerThread)
+    pairs.insert(threadPairs.begin(), threadPairs.end());
+
+  ALICEVISION_LOG_INFO("Frustum intersection BVH: " << nbTestedPairs << " exact tests instead of "
+                       << std::size_t(nbViews) * (nbViews - 1) / 2 << ", " << pairs.size() << " intersecting pairs.");
+
+  return pairs;
+}
+
 // Export defined frustum in PLY file for viewing
 bool FrustumFilter::export_Ply(const std::string & filename) const
 {
@@ -10,6 +10,9 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/geometry/Frustum.hpp>
 
+#include <iostream>
+#include <string>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -18,6 +21,23 @@ class SfMData;
 
 namespace sfm {
 
+/**
+ * @brief Strategy used to generate the view pairs to test for frustum intersection
+ */
+enum class EFrustumPairGenerator
+{
+  /// test all the N(N-1)/2 view pairs
+  EXHAUSTIVE = 0,
+  /// cull candidate pairs with a bounding volume hierarchy over the frustum bounding boxes
+  BVH = 1
+};
+
+std::string EFrustumPairGenerator_enumToString(EFrustumPairGenerator generator);
+EFrustumPairGenerator EFrustumPairGenerator_stringToEnum(const std::string& generator);
+
+std::ostream& operator<<(std::ostream& os, EFrustumPairGenerator generator);
+std::istream& operator>>(std::istream& in, EFrustumPairGenerator& generator);
+
 class FrustumFilter
 {
 public:
@@ -29,14 +49,24 @@ public:
   /// init a frustum for each valid views of the SfM scene
   void initFrustum(const sfmData::SfMData& sfmData);
 
-  /// return intersecting View frustum pairs
-  PairSet getFrustumIntersectionPairs() const;
+  /**
+   * @brief Return intersecting View frustum pairs
+   * @param[in] generator the strategy used to select the candidate pairs before the exact intersection test
+   * @return the set of view pairs (viewIdA, viewIdB)
+   */
+  PairSet getFrustumIntersectionPairs(EFrustumPairGenerator generator = EFrustumPairGenerator::EXHAUSTIVE) const;
 
   /// export defined frustum in PLY file for viewing
   bool export_Ply(const std::string& filename) const;
 
 private:
 
+  /// test all the view pairs
+  PairSet getFrustumIntersectionPairsExhaustive(const std::vector<IndexT>& viewIds) const;
+
+  /// only test the view pairs with overlapping frustum bounding boxes, found through a BVH
+  PairSet getFrustumIntersectionPairsBVH(const std::vector<IndexT>& viewIds) const;
+
   /// Init near and far plane depth from SfMData structure or defined value
   void init_z_near_z_far_depth(const sfmData::SfMData& sfmData, const double zNear = -1., const double zFar = -1.);
 
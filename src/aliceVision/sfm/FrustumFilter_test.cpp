@@ -0,0 +1,53 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2023 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/FrustumFilter.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#define BOOST_TEST_MODULE frustumFilter
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+BOOST_AUTO_TEST_CASE(FrustumFilter_BVH_vs_Exhaustive)
+{
+  const int nviews = 64;
+  const int npoints = 32;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // near/far planes computed from the structure
+  {
+    const FrustumFilter filter(sfmData);
+    const PairSet exhaustivePairs = filter.getFrustumIntersectionPairs(EFrustumPairGenerator::EXHAUSTIVE);
+    const PairSet bvhPairs = filter.getFrustumIntersectionPairs(EFrustumPairGenerator::BVH);
+    BOOST_CHECK(!exhaustivePairs.empty());
+    BOOST_CHECK(exhaustivePairs == bvhPairs);
+  }
+
+  // user defined near/far planes
+  {
+    const FrustumFilter filter(sfmData, 0.1, 1.0);
+    const PairSet exhaustivePairs = filter.getFrustumIntersectionPairs(EFrustumPairGenerator::EXHAUSTIVE);
+    const PairSet bvhPairs = filter.getFrustumIntersectionPairs(EFrustumPairGenerator::BVH);
+    BOOST_CHECK(exhaustivePairs == bvhPairs);
+  }
+
+  // infinite frustums cannot be culled but must give the same result
+  {
+    const FrustumFilter filter(sfmData, 0.01);
+    const PairSet exhaustivePairs = filter.getFrustumIntersectionPairs(EFrustumPairGenerator::EXHAUSTIVE);
+    const PairSet bvhPairs = filter.getFrustumIntersectionPairs(EFrustumPairGenerator::BVH);
+    BOOST_CHECK(exhaustivePairs == bvhPairs);
+  }
+}
@@ -89,7 +89,10 @@ namespace sfm {
     ImageLocalizerMatchData resectionData;
 
     if(resectionDataPtr)
+    {
       resectionData.error_max = resectionDataPtr->error_max;
+      resectionData.robustEstimationNbThreads = resectionDataPtr->robustEstimationNbThreads;
+    }
 
     resectionData.pt3D.resize(3, putativeMatches.size());
     resectionData.pt2D.resize(2, putativeMatches.size());
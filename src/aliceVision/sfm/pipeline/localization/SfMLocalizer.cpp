@@ -56,7 +56,9 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
 
     // robust estimation of the Projection matrix and its precision
     robustEstimation::Mat34Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, resectionData.vec_inliers, resectionData.max_iteration, &model, precision);
+    const std::pair<double,double> ACRansacOut = (resectionData.robustEstimationNbThreads == 1) ?
+      robustEstimation::ACRANSAC(kernel, randomNumberGenerator, resectionData.vec_inliers, resectionData.max_iteration, &model, precision) :
+      robustEstimation::ACRANSAC_parallel(kernel, randomNumberGenerator, resectionData.vec_inliers, resectionData.max_iteration, &model, precision, resectionData.robustEstimationNbThreads);
     P = model.getMatrix();
     // update the upper bound precision of the model found by AC-RANSAC
     resectionData.error_max = ACRansacOut.first;
@@ -91,7 +93,9 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
 
         // robust estimation of the Projection matrix and its precision
         robustEstimation::Mat34Model model;
-        const std::pair<double, double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, resectionData.vec_inliers, resectionData.max_iteration, &model, precision);
+        const std::pair<double, double> ACRansacOut = (resectionData.robustEstimationNbThreads == 1) ?
+          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, resectionData.vec_inliers, resectionData.max_iteration, &model, precision) :
+          robustEstimation::ACRANSAC_parallel(kernel, randomNumberGenerator, resectionData.vec_inliers, resectionData.max_iteration, &model, precision, resectionData.robustEstimationNbThreads);
 
         P = model.getMatrix();
 
@@ -131,7 +135,9 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
         const double threshold = resectionData.error_max * resectionData.error_max * (kernel.normalizer2()(0, 0) * kernel.normalizer2()(0, 0));
         robustEstimation::ScoreEvaluator<KernelT> scorer(threshold);
 
-        const robustEstimation::Mat34Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &resectionData.vec_inliers);
+        const robustEstimation::Mat34Model model = (resectionData.robustEstimationNbThreads == 1) ?
+          robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &resectionData.vec_inliers) :
+          robustEstimation::LO_RANSAC_parallel(kernel, scorer, randomNumberGenerator, &resectionData.vec_inliers, nullptr, false, 100, 1e-2, resectionData.robustEstimationNbThreads);
         P = model.getMatrix();
 
         break;
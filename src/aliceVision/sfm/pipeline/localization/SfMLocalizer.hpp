@@ -42,6 +42,9 @@ struct ImageLocalizerMatchData
   /// Upper bound pixel(s) tolerance for residual errors
   double error_max = std::numeric_limits<double>::infinity();
   size_t max_iteration = 4096;
+  /// Number of threads used to evaluate the robust estimation hypotheses
+  /// (1: sequential estimation, 0: use all the available threads)
+  int robustEstimationNbThreads = 1;
 };
 
 class SfMLocalizer
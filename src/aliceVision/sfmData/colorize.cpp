@@ -11,12 +11,18 @@
 #include <aliceVision/stl/indexedSort.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/image/io.hpp>
+#include <aliceVision/image/ImageCache.hpp>
+#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 
 #include <map>
 #include <random>
 #include <vector>
 #include <functional>
+#include <numeric>
+#include <unordered_map>
+
 namespace aliceVision {
 namespace sfmData {
 
@@ -124,5 +130,150 @@ void colorizeTracks(SfMData& sfmData)
   }
 }
 
+void colorizeTracks(SfMData& sfmData, const ColorizeTracksOptions& options)
+{
+  const int downscale = std::max(1, options.downscale);
+  const std::size_t maxObservations = std::max(1, options.maxObservationsPerLandmark);
+
+  std::vector<Landmark*> landmarks;
+  landmarks.reserve(sfmData.getLandmarks().size());
+  for(auto& landmarkPair : sfmData.getLandmarks())
+    landmarks.push_back(&landmarkPair.second);
+
+  // dense view indexes and number of observations per view
+  std::vector<IndexT> viewIds;
+  std::unordered_map<IndexT, int> viewIndexes;
+  std::vector<std::size_t> viewsCardinal;
+  for(const Landmark* landmark : landmarks)
+  {
+    for(const auto& observationPair : landmark->observations)
+    {
+      const auto it = viewIndexes.emplace(observationPair.first, int(viewIds.size()));
+      if(it.second)
+      {
+        viewIds.push_back(observationPair.first);
+        viewsCardinal.push_back(0);
+      }
+      ++viewsCardinal[it.first->second];
+    }
+  }
+
+  // select the observations used for each landmark, views with the biggest cardinality first
+  // to minimize the number of images to load.
+  // selected observations of landmark i are in [landmarksOffsets[i], landmarksOffsets[i+1])
+  std::vector<std::size_t> landmarksOffsets(landmarks.size() + 1, 0);
+  for(std::size_t i = 0; i < landmarks.size(); ++i)
+    landmarksOffsets[i + 1] = landmarksOffsets[i] + std::min(maxObservations, landmarks[i]->observations.size());
+
+  std::vector<int> selectedViews(landmarksOffsets.back());
+
+#pragma omp parallel for
+  for(int i = 0; i < landmarks.size(); ++i)
+  {
+    std::vector<int> candidates;
+    candidates.reserve(landmarks[i]->observations.size());
+    for(const auto& observationPair : landmarks[i]->observations)
+      candidates.push_back(viewIndexes.at(observationPair.first));
+
+    const std::size_t nbSelected = landmarksOffsets[i + 1] - landmarksOffsets[i];
+    std::partial_sort(candidates.begin(), candidates.begin() + nbSelected, candidates.end(),
+                      [&](int l, int r) { return viewsCardinal[l] > viewsCardinal[r] || (viewsCardinal[l] == viewsCardinal[r] && l < r); });
+    std::copy(candidates.begin(), candidates.begin() + nbSelected, selectedViews.begin() + landmarksOffsets[i]);
+  }
+
+  // per-view list (CSR) of the selected observations
+  // selected observations of view v are viewsSamples[viewsOffsets[v] .. viewsOffsets[v+1]]
+  std::vector<std::size_t> viewsOffsets(viewIds.size() + 1, 0);
+  for(int viewIndex : selectedViews)
+    ++viewsOffsets[viewIndex + 1];
+  std::partial_sum(viewsOffsets.begin(), viewsOffsets.end(), viewsOffsets.begin());
+
+  struct Sample
+  {
+    std::size_t landmarkIndex;
+    std::size_t selectionIndex;
+  };
+
+  std::vector<Sample> viewsSamples(selectedViews.size());
+  {
+    std::vector<std::size_t> fillOffsets(viewsOffsets.begin(), viewsOffsets.end() - 1);
+    for(std::size_t i = 0; i < landmarks.size(); ++i)
+    {
+      for(std::size_t s = landmarksOffsets[i]; s < landmarksOffsets[i + 1]; ++s)
+        viewsSamples[fillOffsets[selectedViews[s]]++] = {i, s};
+    }
+  }
+
+  // process views with the most samples first
+  std::vector<int> viewsOrder(viewIds.size());
+  std::iota(viewsOrder.begin(), viewsOrder.end(), 0);
+  std::sort(viewsOrder.begin(), viewsOrder.end(), [&](int l, int r) {
+    return (viewsOffsets[l + 1] - viewsOffsets[l]) > (viewsOffsets[r + 1] - viewsOffsets[r]);
+  });
+
+  ALICEVISION_LOG_INFO("Colorize " << landmarks.size() << " landmarks from " << selectedViews.size()
+                       << " observations in " << viewIds.size() << " views (downscale: " << downscale << ").");
+
+  auto progressDisplay = system::createConsoleProgressDisplay(viewIds.size(), std::cout,
+                                                              "\nCompute scene structure color\n");
+
+  image::ImageCache imageCache(options.cacheCapacityMiB, options.cacheMaxSizeMiB,
+                               image::ImageReadOptions(image::EImageColorSpace::SRGB));
+  const image::Sampler2d<image::SamplerLinear> sampler;
+
+  // one color per selected observation, each one is written by a single view
+  std::vector<image::RGBfColor> samplesColors(selectedViews.size(), image::RGBfColor(0.f));
+
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < viewsOrder.size(); ++i)
+  {
+    const int viewIndex = viewsOrder[i];
+    if(viewsOffsets[viewIndex] == viewsOffsets[viewIndex + 1])
+      continue;
+
+    const View& view = sfmData.getView(viewIds[viewIndex]);
+    const std::shared_ptr<image::Image<image::RGBfColor>> image =
+      imageCache.get<image::RGBfColor>(view.getImage().getImagePath(), downscale);
+
+    const double maxX = static_cast<double>(image->Width() - 1);
+    const double maxY = static_cast<double>(image->Height() - 1);
+
+    for(std::size_t k = viewsOffsets[viewIndex]; k < viewsOffsets[viewIndex + 1]; ++k)
+    {
+      const Sample& sample = viewsSamples[k];
+      const Vec2& pt = landmarks[sample.landmarkIndex]->observations.at(view.getViewId()).x;
+
+      // pixel center in the downscaled image,
+      // clamped if the feature/marker center is outside the image.
+      const double x = clamp((pt.x() + 0.5) / downscale - 0.5, 0.0, maxX);
+      const double y = clamp((pt.y() + 0.5) / downscale - 0.5, 0.0, maxY);
+
+      samplesColors[sample.selectionIndex] = sampler(*image, y, x);
+    }
+    ++progressDisplay;
+  }
+
+  // average the colors of the selected observations
+#pragma omp parallel for
+  for(int i = 0; i < landmarks.size(); ++i)
+  {
+    const std::size_t begin = landmarksOffsets[i];
+    const std::size_t end = landmarksOffsets[i + 1];
+    if(begin == end)
+      continue;
+
+    image::RGBfColor color(0.f);
+    for(std::size_t s = begin; s < end; ++s)
+      color += samplesColors[s];
+    color /= static_cast<float>(end - begin);
+
+    landmarks[i]->rgb = image::RGBColor(static_cast<unsigned char>(clamp(color.r() * 255.f + 0.5f, 0.f, 255.f)),
+                                        static_cast<unsigned char>(clamp(color.g() * 255.f + 0.5f, 0.f, 255.f)),
+                                        static_cast<unsigned char>(clamp(color.b() * 255.f + 0.5f, 0.f, 255.f)));
+  }
+
+  ALICEVISION_LOG_DEBUG("Colorization image cache: " << imageCache.toString());
+}
+
 } // namespace sfm
 } // namespace aliceVision
@@ -20,5 +20,31 @@ class SfMData;
  */
 void colorizeTracks(SfMData& sfmData);
 
+/**
+ * @brief Options of the parallel landmarks colorization
+ */
+struct ColorizeTracksOptions
+{
+  /// downscale factor applied to the images before sampling the colors
+  int downscale = 1;
+  /// maximum number of observations averaged to compute the color of a landmark
+  int maxObservationsPerLandmark = 1;
+  /// image cache capacity (in MiB)
+  float cacheCapacityMiB = 1024.f;
+  /// image cache maximal size (in MiB)
+  float cacheMaxSizeMiB = 2048.f;
+};
+
+/**
+ * @brief colorizeTracks Add the associated color to each 3D point of
+ * the sfmData, using several views per track if requested.
+ * Landmarks are grouped per view (views with the most observations first)
+ * and the images are loaded concurrently through an image cache.
+ * Colors are sampled with bilinear interpolation.
+ * @param[in,out] sfmData The container of the data
+ * @param[in] options The colorization options
+ */
+void colorizeTracks(SfMData& sfmData, const ColorizeTracksOptions& options);
+
 } // namespace sfmData
 } // namespace aliceVision
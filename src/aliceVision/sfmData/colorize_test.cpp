@@ -0,0 +1,126 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/colorize.hpp>
+#include <aliceVision/image/all.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE colorize
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+namespace fs = boost::filesystem;
+
+namespace {
+
+/**
+ * @brief Scene with 3 views of distinct colors and landmarks observed at integer pixel positions.
+ *        The views have distinct numbers of observations so the view selection is not ambiguous.
+ */
+sfmData::SfMData createScene(const fs::path& folder)
+{
+    const int width = 16;
+    const int height = 12;
+
+    sfmData::SfMData sfmData;
+    for(IndexT viewId = 0; viewId < 3; ++viewId)
+    {
+        image::Image<image::RGBColor> image(width, height);
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                image(y, x) = image::RGBColor((x * 13 + viewId * 7) % 256,
+                                              (y * 17 + viewId * 29) % 256,
+                                              (x * y + viewId * 53) % 256);
+            }
+        }
+
+        const std::string imagePath = (folder / ("view" + std::to_string(viewId) + ".png")).string();
+        image::writeImage(imagePath, image, image::ImageWriteOptions());
+        sfmData.getViews().emplace(viewId, std::make_shared<sfmData::View>(imagePath, viewId, 0, viewId, width, height));
+    }
+
+    // observations (view, x, y) of each landmark
+    const std::vector<std::vector<std::array<int, 3>>> landmarksObservations = {
+        {{0, 1, 2}, {1, 3, 4}},
+        {{0, 15, 11}, {2, 0, 0}},
+        {{0, 7, 5}},
+        {{1, 2, 9}, {2, 10, 3}},
+        {{0, 4, 4}, {1, 5, 5}, {2, 6, 6}},
+        {{2, -2, 100}}, // outside of the image
+        {{0, 9, 1}},
+    };
+
+    for(IndexT landmarkId = 0; landmarkId < landmarksObservations.size(); ++landmarkId)
+    {
+        sfmData::Landmark landmark(Vec3(0.0, 0.0, 1.0), feature::EImageDescriberType::SIFT);
+        for(const auto& obs : landmarksObservations[landmarkId])
+            landmark.observations[obs[0]] = sfmData::Observation(Vec2(obs[1], obs[2]), landmarkId, 1.0);
+        landmark.rgb = image::BLACK;
+        sfmData.getLandmarks().emplace(landmarkId, landmark);
+    }
+    return sfmData;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(colorizeTracks_parallelMatchesSequential)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("colorize_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    sfmData::SfMData sequentialSfmData = createScene(folder);
+    sfmData::SfMData parallelSfmData = createScene(folder);
+
+    sfmData::colorizeTracks(sequentialSfmData);
+
+    sfmData::ColorizeTracksOptions options;
+    options.downscale = 1;
+    options.maxObservationsPerLandmark = 1;
+    sfmData::colorizeTracks(parallelSfmData, options);
+
+    BOOST_CHECK_EQUAL(sequentialSfmData.getLandmarks().size(), parallelSfmData.getLandmarks().size());
+    for(const auto& landmarkPair : sequentialSfmData.getLandmarks())
+    {
+        const image::RGBColor& expected = landmarkPair.second.rgb;
+        const image::RGBColor& color = parallelSfmData.getLandmarks().at(landmarkPair.first).rgb;
+        BOOST_CHECK_MESSAGE(expected == color, "landmark " << landmarkPair.first << ": " << int(color.r()) << " "
+                                                 << int(color.g()) << " " << int(color.b()) << " instead of "
+                                                 << int(expected.r()) << " " << int(expected.g()) << " "
+                                                 << int(expected.b()));
+    }
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(colorizeTracks_averageObservations)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("colorize_test_%%%%%%%%");
+    fs::create_directories(folder);
+
+    sfmData::SfMData sfmData = createScene(folder);
+
+    sfmData::ColorizeTracksOptions options;
+    options.maxObservationsPerLandmark = 3;
+    sfmData::colorizeTracks(sfmData, options);
+
+    // landmark 4 is seen by all the views, at (4, 4), (5, 5) and (6, 6)
+    const image::RGBColor& color = sfmData.getLandmarks().at(4).rgb;
+    // r: (52 + 72 + 92) / 3, g: (68 + 114 + 160) / 3, b: (16 + 78 + 142) / 3 rounded
+    BOOST_CHECK_EQUAL(int(color.r()), 72);
+    BOOST_CHECK_EQUAL(int(color.g()), 114);
+    BOOST_CHECK_EQUAL(int(color.b()), 79);
+
+    fs::remove_all(folder);
+}
@@ -19,6 +19,7 @@
 
 #include <boost/program_options.hpp>
 
+#include <chrono>
 #include <string>
 #include <iostream>
 
@@ -178,6 +179,23 @@ int main(int argc, char **argv)
         
         const double & thresholdF = ACRansacOut.first;
 
+        // Compare the NFA evaluation strategies on the same correspondences
+        for(const ENFAEvaluation nfaEvaluation : {ENFAEvaluation::SORT, ENFAEvaluation::HISTOGRAM})
+        {
+            std::mt19937 benchmarkGenerator;
+            std::vector<size_t> benchmarkInliers;
+            robustEstimation::Mat3Model benchmarkF;
+            const auto start = std::chrono::steady_clock::now();
+            const std::pair<double,double> benchmarkOut = ACRANSAC(kernel, benchmarkGenerator, benchmarkInliers, 1024, &benchmarkF,
+                                                                   Square(4.0), nfaEvaluation);
+            const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "NFA evaluation " << (nfaEvaluation == ENFAEvaluation::SORT ? "sort" : "histogram")
+                      << ": " << elapsed << " ms, NFA: " << benchmarkOut.second
+                      << ", threshold: " << benchmarkOut.first
+                      << ", inliers: " << benchmarkInliers.size() << std::endl;
+        }
+
         // Check the fundamental support some point to be considered as valid
         if (vec_inliers.size() > kernel.getMinimumNbRequiredSamples() *2.5)
         {
@@ -21,7 +21,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -35,6 +35,7 @@ int aliceVision_main(int argc, char **argv)
   std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
   std::string sfmDataFilename;
   std::string outputSfMDataFilename;
+  sfmData::ColorizeTracksOptions colorizeOptions;
 
   po::options_description allParams("AliceVision exportColoredPointCloud");
 
@@ -45,9 +46,20 @@ int aliceVision_main(int argc, char **argv)
     ("output,o", po::value<std::string>(&outputSfMDataFilename)->required(),
       "Output point cloud with visibilities as SfMData file.");
 
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("downscale", po::value<int>(&colorizeOptions.downscale)->default_value(colorizeOptions.downscale),
+      "Downscale factor applied to the images before sampling the colors.")
+    ("maxObservationsPerLandmark", po::value<int>(&colorizeOptions.maxObservationsPerLandmark)->default_value(colorizeOptions.maxObservationsPerLandmark),
+      "Maximum number of observations averaged to compute the color of each landmark.")
+    ("cacheCapacity", po::value<float>(&colorizeOptions.cacheCapacityMiB)->default_value(colorizeOptions.cacheCapacityMiB),
+      "Images cache capacity (in MiB).")
+    ("cacheMaxSize", po::value<float>(&colorizeOptions.cacheMaxSizeMiB)->default_value(colorizeOptions.cacheMaxSizeMiB),
+      "Images cache maximal size (in MiB), must be higher than the capacity.");
 
   CmdLine cmdline("AliceVision exportColoredPointCloud");
   cmdline.add(requiredParams);
+  cmdline.add(optionalParams);
   if (!cmdline.execute(argc, argv))
   {
       return EXIT_FAILURE;
@@ -69,7 +81,7 @@ int aliceVision_main(int argc, char **argv)
   }
 
   // compute the scene structure color
-  sfmData::colorizeTracks(sfmData);
+  sfmData::colorizeTracks(sfmData, colorizeOptions);
 
   // export the SfMData scene in the expected format
   ALICEVISION_LOG_INFO("Saving output result to " << outputSfMDataFilename << "...");
@@ -4,26 +4,33 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/cmdline/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
-#include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
-#include <aliceVision/depthMap/DepthMapEstimator.hpp>
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/depthMap/ComputeBackend.hpp>
+#include <aliceVision/depthMap/cpu/DepthMapEstimatorCpu.hpp>
 #include <aliceVision/depthMap/DepthMapParams.hpp>
 #include <aliceVision/depthMap/SgmParams.hpp>
 #include <aliceVision/depthMap/RefineParams.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
+#include <aliceVision/depthMap/DepthMapEstimator.hpp>
+#endif
+
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -90,6 +97,14 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // compute backend
+    depthMap::EDepthMapComputeBackend computeBackend = depthMap::EDepthMapComputeBackend::AUTO;
+
+    // map files storage
+    image::EStorageDataType mapStorageDepthDataType = image::EStorageDataType::Float;
+    image::EImageExrCompression mapStorageExrCompression = image::EImageExrCompression::Auto;
+    int mapStorageExrTileSize = 0;
+
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
@@ -215,7 +230,18 @@ int aliceVision_main(int argc, char* argv[])
         ("exportTilePattern", po::value<bool>(&depthMapParams.exportTilePattern)->default_value(depthMapParams.exportTilePattern),
             "Export workflow tile pattern.")
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
-            "Number of GPUs to use (0 means use all GPUs).");
+            "Number of GPUs to use (0 means use all GPUs).")
+        ("computeBackend", po::value<depthMap::EDepthMapComputeBackend>(&computeBackend)->default_value(computeBackend),
+            "Compute backend:\n"
+            "* auto: CUDA if a compatible GPU is available, CPU otherwise\n"
+            "* cuda: CUDA only\n"
+            "* cpu: CPU only (slower, for nodes without GPU)")
+        ("mapStorageDepthDataType", po::value<image::EStorageDataType>(&mapStorageDepthDataType)->default_value(mapStorageDepthDataType),
+            ("Depth map storage data type: " + image::EStorageDataType_informations()).c_str())
+        ("mapStorageExrCompression", po::value<image::EImageExrCompression>(&mapStorageExrCompression)->default_value(mapStorageExrCompression),
+            "Map EXR compression method, auto uses a lossless method chosen per map type (zip for depth maps, piz for similarity/normal maps).")
+        ("mapStorageExrTileSize", po::value<int>(&mapStorageExrTileSize)->default_value(mapStorageExrTileSize),
+            "Map EXR tile size in pixels (0 for scanline storage). Tiled maps can be partially read.");
 
     CmdLine cmdline("Dense Reconstruction.\n"
                     "This program estimate a depth map for each input calibrated camera using Plane Sweeping, a multi-view stereo algorithm notable for its efficiency on modern graphics hardware (GPU).\n"
@@ -241,14 +267,26 @@ int aliceVision_main(int argc, char* argv[])
     refineParams.exportIntermediateTopographicCutVolumes = exportIntermediateTopographicCutVolumes;
     refineParams.exportIntermediateVolume9pCsv = exportIntermediateVolume9pCsv;
 
-    // print GPU Information
-    ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+    // choose the compute backend
+    bool useCpuBackend = (computeBackend == depthMap::EDepthMapComputeBackend::CPU);
 
-    // check if the gpu suppport CUDA compute capability 2.0
-    if(!gpu::gpuSupportCUDA(2,0))
+    if(!useCpuBackend)
     {
-      ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
-      return EXIT_FAILURE;
+      // print GPU Information
+      ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+      // check if the gpu suppport CUDA compute capability 2.0
+      if(!gpu::gpuSupportCUDA(2,0))
+      {
+        if(computeBackend == depthMap::EDepthMapComputeBackend::CUDA)
+        {
+          ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+          return EXIT_FAILURE;
+        }
+
+        ALICEVISION_LOG_WARNING("No CUDA-Enabled GPU (with at least compute capability 2.0) found, use the CPU compute backend.");
+        useCpuBackend = true;
+      }
     }
 
     // check if the scale is correct
@@ -301,6 +339,11 @@ int aliceVision_main(int argc, char* argv[])
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
 
+    // set map files storage user parameters
+    mp.userParams.put("mapStorage.depthDataType", image::EStorageDataType_enumToString(mapStorageDepthDataType));
+    mp.userParams.put("mapStorage.exrCompression", image::EImageExrCompression_enumToString(mapStorageExrCompression));
+    mp.userParams.put("mapStorage.exrTileSize", mapStorageExrTileSize);
+
     // set undefined tile dimensions
     if(tileParams.bufferWidth <= 0 || tileParams.bufferHeight <= 0)
     {
@@ -424,11 +467,24 @@ int aliceVision_main(int argc, char* argv[])
       }
     }
 
-    // initialize depth map estimator
-    depthMap::DepthMapEstimator depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
+    if(useCpuBackend)
+    {
+      // initialize depth map estimator on CPU
+      depthMap::DepthMapEstimatorCpu depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
+
+      // estimate depth maps
+      depthMapEstimator.compute(cams);
+    }
+    else
+    {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+      // initialize depth map estimator
+      depthMap::DepthMapEstimator depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
 
-    // estimate depth maps
-    depthMap::computeOnMultiGPUs(cams, depthMapEstimator, nbGPUs);
+      // estimate depth maps
+      depthMap::computeOnMultiGPUs(cams, depthMapEstimator, nbGPUs);
+#endif
+    }
 
     ALICEVISION_COMMANDLINE_END
 }
@@ -4,19 +4,24 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/fuseCut/Fuser.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/image/io.hpp>
 #include <aliceVision/cmdline/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
 #include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
 #include <aliceVision/depthMap/NormalMapEstimator.hpp>
+#endif
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -24,7 +29,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -54,6 +59,11 @@ int aliceVision_main(int argc, char* argv[])
     int nNearestCams = 10;
     bool computeNormalMaps = false;
 
+    // map files storage
+    image::EStorageDataType mapStorageDepthDataType = image::EStorageDataType::Float;
+    image::EImageExrCompression mapStorageExrCompression = image::EImageExrCompression::Auto;
+    int mapStorageExrTileSize = 0;
+
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
@@ -86,7 +96,13 @@ int aliceVision_main(int argc, char* argv[])
         ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
             "Number of nearest cameras.")
         ("computeNormalMaps", po::value<bool>(&computeNormalMaps)->default_value(computeNormalMaps),
-            "Compute normal maps per depth map");
+            "Compute normal maps per depth map")
+        ("mapStorageDepthDataType", po::value<image::EStorageDataType>(&mapStorageDepthDataType)->default_value(mapStorageDepthDataType),
+            ("Depth map storage data type: " + image::EStorageDataType_informations()).c_str())
+        ("mapStorageExrCompression", po::value<image::EImageExrCompression>(&mapStorageExrCompression)->default_value(mapStorageExrCompression),
+            "Map EXR compression method, auto uses a lossless method chosen per map type (zip for depth maps, piz for similarity/normal maps).")
+        ("mapStorageExrTileSize", po::value<int>(&mapStorageExrTileSize)->default_value(mapStorageExrTileSize),
+            "Map EXR tile size in pixels (0 for scanline storage). Tiled maps can be partially read.");
 
     CmdLine cmdline("This program filters depth maps to remove values that are not consistent with other depth maps.\n"
                     "AliceVision depthMapFiltering");
@@ -97,6 +113,17 @@ int aliceVision_main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
+#if !ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    if(computeNormalMaps)
+    {
+        ALICEVISION_LOG_ERROR("Normal maps computation needs a CUDA build of AliceVision.");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    HardwareContext hwc = cmdline.getHardwareContext();
+    omp_set_num_threads(hwc.getMaxThreads());
+
     // read the input SfM scene
     sfmData::SfMData sfmData;
     if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::ALL))
@@ -111,6 +138,11 @@ int aliceVision_main(int argc, char* argv[])
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
 
+    // set map files storage user parameters
+    mp.userParams.put("mapStorage.depthDataType", image::EStorageDataType_enumToString(mapStorageDepthDataType));
+    mp.userParams.put("mapStorage.exrCompression", image::EImageExrCompression_enumToString(mapStorageExrCompression));
+    mp.userParams.put("mapStorage.exrTileSize", mapStorageExrTileSize);
+
     std::vector<int> cams;
     cams.reserve(mp.ncams);
 
@@ -139,10 +171,13 @@ int aliceVision_main(int argc, char* argv[])
 
     {
         fuseCut::Fuser fs(mp);
-        fs.filterGroups(cams, pixToleranceFactor, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams);
+        // half of the available memory for the shared depth maps cache
+        const std::size_t maxCacheMemory = hwc.getMaxMemory() / 2;
+        fs.filterGroups(cams, pixToleranceFactor, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams, maxCacheMemory);
         fs.filterDepthMaps(cams, minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity);
     }
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
     if(computeNormalMaps)
     {
         int nbGPUs = 0;
@@ -153,6 +188,7 @@ int aliceVision_main(int argc, char* argv[])
         // estimate normal maps
         depthMap::computeOnMultiGPUs(cams, normalMapEstimator, nbGPUs);
     }
+#endif
 
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
@@ -30,7 +30,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::voctree;
@@ -65,6 +65,10 @@ int aliceVision_main(int argc, char** argv)
   std::string weightsFilepath;
   /// flag for the optional weights file
   bool withWeights = false;
+  /// the strategy to generate the candidate pairs in Frustum Mode
+  sfm::EFrustumPairGenerator frustumPairGenerator = sfm::EFrustumPairGenerator::EXHAUSTIVE;
+  /// the far plane distance of the cameras frustum in Frustum Mode
+  double frustumZFar = -1.0;
 
 
   // multiple SfM parameters
@@ -109,7 +113,13 @@ int aliceVision_main(int argc, char** argv)
       "Input file path of the vocabulary tree. This file can be generated by 'createVoctree'. "
       "This software is intended to be used with a generic, pre-trained vocabulary tree.")
     ("weights,w", po::value<std::string>(&weightsFilepath)->default_value(weightsFilepath),
-      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.");
+      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.")
+    ("frustumPairGenerator", po::value<sfm::EFrustumPairGenerator>(&frustumPairGenerator)->default_value(frustumPairGenerator),
+      "Strategy used to select the candidate pairs in Frustum mode:\n"
+      " * Exhaustive: test all the camera pairs\n"
+      " * BVH: only test the cameras with overlapping frustum bounding boxes (requires a frustum far plane)\n")
+    ("frustumZFar", po::value<double>(&frustumZFar)->default_value(frustumZFar),
+      "Far plane distance of the camera frustums in Frustum mode (if negative, frustums are infinite).");
 
   po::options_description multiSfMParams("Multiple SfM");
   multiSfMParams.add_options()
@@ -233,7 +243,7 @@ int aliceVision_main(int argc, char** argv)
       }
       // For all cameras with valid extrinsic/intrinsic, we select the camera with common visibilities based on cameras' frustum.
       // We use an epsilon near value for the frustum, to ensure that mulitple images with a pure rotation will not intersect at the nodal point.
-      PairSet pairs = sfm::FrustumFilter(sfmDataA, 0.01).getFrustumIntersectionPairs();
+      PairSet pairs = sfm::FrustumFilter(sfmDataA, 0.01, frustumZFar).getFrustumIntersectionPairs(frustumPairGenerator);
       for(const auto& p: pairs)
       {
           selectedPairs[p.first].insert(p.second);
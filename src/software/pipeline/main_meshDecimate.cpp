@@ -8,29 +8,87 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
-#include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshDecimation.hpp>
+#include <aliceVision/config.hpp>
 
-#include <OpenMesh/Core/IO/reader/OBJReader.hh>
-#include <OpenMesh/Core/IO/writer/OBJWriter.hh>
-#include <OpenMesh/Core/IO/MeshIO.hh>
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MESHSDFILTER)
 #include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
-#include <OpenMesh/Core/Geometry/VectorT.hh>
 #include <OpenMesh/Tools/Decimater/DecimaterT.hh>
 #include <OpenMesh/Tools/Decimater/ModQuadricT.hh>
+#endif
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <string>
+#include <vector>
+
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
 namespace bfs = boost::filesystem;
 namespace po = boost::program_options;
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MESHSDFILTER)
+/**
+ * @brief Decimate the mesh with the OpenMesh quadric decimater (previous backend).
+ * @param[in,out] mesh the mesh to decimate, only its vertices and triangles are kept
+ * @param[in] targetNbVertices the number of vertices of the decimated mesh
+ */
+void decimateMeshOpenMesh(mesh::Mesh& mesh, int targetNbVertices)
+{
+    using OMesh = OpenMesh::TriMesh_ArrayKernelT<>;
+    using Decimater = OpenMesh::Decimater::DecimaterT<OMesh>;
+    using HModQuadric = OpenMesh::Decimater::ModQuadricT<OMesh>::Handle;
+
+    OMesh omesh;
+    std::vector<OMesh::VertexHandle> vertices;
+    vertices.reserve(mesh.pts.size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+        vertices.push_back(omesh.add_vertex(OMesh::Point(mesh.pts[i].x, mesh.pts[i].y, mesh.pts[i].z)));
+    // the non-manifold triangles are rejected, as by the OpenMesh readers
+    for(int i = 0; i < mesh.tris.size(); ++i)
+        omesh.add_face(vertices[mesh.tris[i].v[0]], vertices[mesh.tris[i].v[1]], vertices[mesh.tris[i].v[2]]);
+
+    {
+        // a decimater object, connected to a mesh
+        Decimater decimater(omesh);
+        // use a quadric module
+        HModQuadric hModQuadric;
+        // register module at the decimater
+        decimater.add(hModQuadric);
+        // we need exactly one non-binary priority module, unset_max_err() calls set_binary(false) internally
+        decimater.module(hModQuadric).unset_max_err();
+        // let the decimater initialize the mesh and the modules
+        decimater.initialize();
+        decimater.decimate_to(targetNbVertices);
+    }
+    omesh.garbage_collection();
+
+    mesh::Mesh decimatedMesh;
+    for(OMesh::VertexIter vIt = omesh.vertices_begin(); vIt != omesh.vertices_end(); ++vIt)
+    {
+        const OMesh::Point& p = omesh.point(*vIt);
+        decimatedMesh.pts.push_back(Point3d(p[0], p[1], p[2]));
+    }
+    // the vertices indexes are contiguous after the garbage collection
+    for(OMesh::FaceIter fIt = omesh.faces_begin(); fIt != omesh.faces_end(); ++fIt)
+    {
+        int v[3];
+        int k = 0;
+        for(OMesh::FaceVertexIter fvIt = omesh.fv_iter(*fIt); fvIt.is_valid() && k < 3; ++fvIt)
+            v[k++] = fvIt->idx();
+        decimatedMesh.tris.push_back(mesh::Mesh::triangle(v[0], v[1], v[2]));
+    }
+    mesh = std::move(decimatedMesh);
+}
+#endif
+
 int aliceVision_main(int argc, char* argv[])
 {
     system::Timer timer;
@@ -42,6 +100,7 @@ int aliceVision_main(int argc, char* argv[])
     int minVertices = 0;
     int maxVertices = 0;
     bool flipNormals = false;
+    std::string backend = "AliceVision";
 
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
@@ -61,7 +120,11 @@ int aliceVision_main(int argc, char* argv[])
         ("maxVertices", po::value<int>(&maxVertices)->default_value(maxVertices),
             "Max number of output vertices.")
         ("flipNormals", po::value<bool>(&flipNormals)->default_value(flipNormals),
-            "Option to flip face normals. It can be needed as it depends on the vertices order in triangles and the convention change from one software to another.");
+            "Option to flip face normals. It can be needed as it depends on the vertices order in triangles and the convention change from one software to another.")
+        ("backend", po::value<std::string>(&backend)->default_value(backend),
+            "Decimation backend:\n"
+            "* AliceVision: parallel decimation by spatial partitions, keeps the open boundaries in place\n"
+            "* OpenMesh: previous sequential OpenMesh quadric decimater (only if built with MeshSDFilter)");
 
     CmdLine cmdline("AliceVision meshDecimate");
                   
@@ -72,28 +135,35 @@ int aliceVision_main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MESHSDFILTER)
+    if(backend != "AliceVision" && backend != "OpenMesh")
+#else
+    if(backend != "AliceVision")
+#endif
+    {
+        ALICEVISION_LOG_ERROR("Unsupported decimation backend: " << backend);
+        return EXIT_FAILURE;
+    }
+
 
     bfs::path outDirectory = bfs::path(outputMeshPath).parent_path();
     if(!bfs::is_directory(outDirectory))
         bfs::create_directory(outDirectory);
 
-    // Mesh type
-    typedef OpenMesh::TriMesh_ArrayKernelT<>                      Mesh;
-    // Decimater type
-    typedef OpenMesh::Decimater::DecimaterT< Mesh >               Decimater;
-    // Decimation Module Handle type
-    typedef OpenMesh::Decimater::ModQuadricT< Mesh >::Handle HModQuadric;
-
-    Mesh mesh;
-    if(!OpenMesh::IO::read_mesh(mesh, inputMeshPath))
+    mesh::Mesh mesh;
+    try
+    {
+        mesh.load(inputMeshPath);
+    }
+    catch(const std::exception& e)
     {
-        ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath);
+        ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath << "\n" << e.what());
         return EXIT_FAILURE;
     }
 
     ALICEVISION_LOG_INFO("Mesh file: \"" << inputMeshPath << "\" loaded.");
 
-    int nbInputPoints = mesh.n_vertices();
+    int nbInputPoints = mesh.pts.size();
     int nbOutputPoints = 0;
     if(fixedNbVertices != 0)
     {
@@ -117,35 +187,19 @@ int aliceVision_main(int argc, char* argv[])
         }
     }
 
-    ALICEVISION_LOG_INFO("Input mesh: " << nbInputPoints << " vertices and " << mesh.n_faces() << " facets.");
+    ALICEVISION_LOG_INFO("Input mesh: " << nbInputPoints << " vertices and " << mesh.tris.size() << " facets.");
     ALICEVISION_LOG_INFO("Target output mesh: " << nbOutputPoints << " vertices.");
 
-    {
-        // a decimater object, connected to a mesh
-        Decimater   decimater(mesh);
-        // use a quadric module
-        HModQuadric hModQuadric;
-        // register module at the decimater
-        decimater.add(hModQuadric);
-
-        // the way to access the module
-        std::cout << decimater.module(hModQuadric).name() << std::endl;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MESHSDFILTER)
+    if(backend == "OpenMesh")
+        decimateMeshOpenMesh(mesh, nbOutputPoints);
+    else
+#endif
+        mesh::decimateMesh(mesh, nbOutputPoints);
 
-        /*
-         * since we need exactly one priority module (non-binary)
-         * we have to call set_binary(false) for our priority module
-         * in the case of HModQuadric, unset_max_err() calls set_binary(false) internally
-         */
-        decimater.module(hModQuadric).unset_max_err();
-        // let the decimater initialize the mesh and the modules
-        decimater.initialize();
-        // do decimation
-        size_t removedVertices = decimater.decimate_to(nbOutputPoints);
-        decimater.mesh().garbage_collection();
-    }
-    ALICEVISION_LOG_INFO("Output mesh: " << mesh.n_vertices() << " vertices and " << mesh.n_faces() << " facets.");
+    ALICEVISION_LOG_INFO("Output mesh: " << mesh.pts.size() << " vertices and " << mesh.tris.size() << " facets.");
 
-    if(mesh.n_faces() == 0)
+    if(mesh.tris.empty())
     {
         ALICEVISION_LOG_ERROR("Failed: the output mesh is empty.");
         return EXIT_FAILURE;
@@ -153,9 +207,13 @@ int aliceVision_main(int argc, char* argv[])
 
     ALICEVISION_LOG_INFO("Save mesh.");
     // Save output mesh
-    if(!OpenMesh::IO::write_mesh(mesh, outputMeshPath))
+    try
+    {
+        mesh.save(outputMeshPath);
+    }
+    catch(const std::exception& e)
     {
-        ALICEVISION_LOG_ERROR("Failed to save mesh \"" << outputMeshPath << "\".");
+        ALICEVISION_LOG_ERROR("Failed to save mesh \"" << outputMeshPath << "\".\n" << e.what());
         return EXIT_FAILURE;
     }
     ALICEVISION_LOG_INFO("Mesh file: \"" << outputMeshPath << "\" saved.");
@@ -18,7 +18,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -108,6 +108,7 @@ int aliceVision_main(int argc, char* argv[])
     int smoothingBoundariesNeighbours = 0;
     int smoothNIter = 10;
     float lambda = 1.0f;
+    mesh::ESmoothingMethod smoothingMethod = mesh::ESmoothingMethod::Explicit;
 
     // command-line filtering parameters
 
@@ -135,6 +136,10 @@ int aliceVision_main(int argc, char* argv[])
             "Number of smoothing iterations.")
         ("smoothingLambda", po::value<float>(&lambda)->default_value(lambda),
             "Smoothing size.")
+        ("smoothingMethod", po::value<mesh::ESmoothingMethod>(&smoothingMethod)->default_value(smoothingMethod),
+            "Smoothing scheme:\n"
+            "* explicit: iterative bi-Laplacian updates.\n"
+            "* implicit: a single implicit step over the same number of iterations, solved by conjugate gradient. Faster for many iterations.")
         ("filteringSubset",po::value<std::string>(&filteringSubsetTypeName)->default_value(filteringSubsetTypeName),
             ESubsetType_informations().c_str())
         ("filteringIterations", po::value<int>(&filteringIterations)->default_value(filteringIterations),
@@ -236,38 +241,48 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     // smoothing
-    mesh::MeshEnergyOpt meOpt(nullptr);
+    // the mesh is moved into the smoothing object and back, the filtering above compacts the triangles
+    // at each iteration as the next one works on the remaining surface: the free points are removed once at the end
+    mesh::Mesh& outMesh = *mesh;
     {
         ALICEVISION_LOG_INFO("Start mesh smoothing.");
-        meOpt.addMesh(*mesh);
+        mesh::MeshEnergyOpt meOpt(nullptr, std::move(*mesh));
         meOpt.init();
         meOpt.cleanMesh(10);
-        meOpt.optimizeSmooth(lambda, smoothNIter, ptsCanMove);
+
+        // points added by the cleaning keep the lock of the point they are split from
+        if(!ptsCanMove.empty())
+        {
+            ptsCanMove.reserveAdd(meOpt.newPtsOldPtId.size());
+            for(int i = 0; i < meOpt.newPtsOldPtId.size(); ++i)
+                ptsCanMove.push_back(ptsCanMove[meOpt.newPtsOldPtId[i]]);
+        }
+
+        meOpt.optimizeSmooth(lambda, smoothNIter, ptsCanMove, smoothingMethod);
         ALICEVISION_LOG_INFO("Mesh smoothing done: " << meOpt.pts.size() << " vertices and " << meOpt.tris.size() << " facets.");
+        outMesh = meOpt.releaseMesh();
     }
+    // the cleaning does not update the points visibilities
+    outMesh.pointsVisibilities.clear();
 
     if(keepLargestMeshOnly)
     {
         StaticVector<int> trisIdsToStay;
-        meOpt.getLargestConnectedComponentTrisIds(trisIdsToStay);
-        meOpt.letJustTringlesIdsInMesh(trisIdsToStay);
-        ALICEVISION_LOG_INFO("Mesh after keepLargestMeshOnly: " << meOpt.pts.size() << " vertices and " << meOpt.tris.size() << " facets.");
+        outMesh.getLargestConnectedComponentTrisIds(trisIdsToStay);
+        outMesh.letJustTringlesIdsInMesh(trisIdsToStay);
+        ALICEVISION_LOG_INFO("Mesh after keepLargestMeshOnly: " << outMesh.pts.size() << " vertices and " << outMesh.tris.size() << " facets.");
     }
-    
-    // clear potential free points created by triangles removal in previous cleaning operations 
+
+    // clear potential free points created by triangles removal in previous cleaning operations
     StaticVector<int> ptIdToNewPtId;
-    meOpt.removeFreePointsFromMesh(ptIdToNewPtId);
+    outMesh.removeFreePointsFromMesh(ptIdToNewPtId);
     ptIdToNewPtId.clear();
 
-    mesh::Mesh outMesh;
-    outMesh.addMesh(meOpt);
-
-    ALICEVISION_COUT("Output mesh: " << mesh->pts.size() << " vertices and " << mesh->tris.size() << " facets.");
+    ALICEVISION_LOG_INFO("Output mesh: " << outMesh.pts.size() << " vertices and " << outMesh.tris.size() << " facets.");
 
     if(outMesh.pts.empty() || outMesh.tris.empty())
     {
         ALICEVISION_CERR("Failed: the output mesh is empty.");
-        ALICEVISION_LOG_INFO("Output mesh: " << outMesh.pts.size() << " vertices and " << outMesh.tris.size() << " facets.");
         return EXIT_FAILURE;
     }
 
@@ -8,9 +8,12 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmData/colorize.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/fuseCut/BlockPartition.hpp>
+#include <aliceVision/fuseCut/Fuser.hpp>
 #include <aliceVision/fuseCut/LargeScale.hpp>
 #include <aliceVision/fuseCut/ReconstructionPlan.hpp>
 #include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
+#include <aliceVision/fuseCut/MaxFlowAlgorithm.hpp>
 #include <aliceVision/mesh/meshPostProcessing.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
@@ -27,12 +30,14 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 4
 
 using namespace aliceVision;
 
@@ -285,6 +290,90 @@ inline std::istream& operator>>(std::istream& in, BoundingBox& out_bbox)
     return in;
 }
 
+/// Estimate the reconstruction space \p out_hexah and save it as bounding box in \p outDirectory
+void estimateReconstructionSpace(const mvsUtils::MultiViewParams& mp,
+                                 const sfmData::SfMData& sfmData,
+                                 const BoundingBox& boundingBox,
+                                 bool meshingFromDepthMaps,
+                                 bool estimateSpaceFromSfM,
+                                 std::size_t estimateSpaceMinObservations,
+                                 float estimateSpaceMinObservationAngle,
+                                 const fs::path& outDirectory,
+                                 Point3d* out_hexah)
+{
+    float minPixSize;
+    fuseCut::Fuser fuser(mp);
+
+    if (boundingBox.isInitialized())
+        boundingBox.toHexahedron(out_hexah);
+    else if(meshingFromDepthMaps && (!estimateSpaceFromSfM || sfmData.getLandmarks().empty()))
+      fuser.divideSpaceFromDepthMaps(out_hexah, minPixSize);
+    else
+      fuser.divideSpaceFromSfM(sfmData, out_hexah, estimateSpaceMinObservations, estimateSpaceMinObservationAngle);
+
+    const double length = out_hexah[0].x - out_hexah[1].x;
+    const double width = out_hexah[0].y - out_hexah[3].y;
+    const double height = out_hexah[0].z - out_hexah[4].z;
+
+    ALICEVISION_LOG_INFO("bounding Box : length: " << length << ", width: " << width << ", height: " << height);
+
+    // Save bounding box
+    BoundingBox bbox = BoundingBox::fromHexahedron(out_hexah);
+    std::string filename = (outDirectory / "boundingBox.txt").string();
+    std::ofstream bboxFile(filename, std::ios::out);
+    if(!bboxFile.is_open())
+    {
+        ALICEVISION_LOG_WARNING("Unable to create the bounding box file " << filename);
+    }
+    bboxFile << bbox.translation << std::endl;
+    bboxFile << bbox.rotation << std::endl;
+    bboxFile << bbox.scale << std::endl;
+    bboxFile.close();
+}
+
+/// Reconstruct the mesh of the hexahedron \p hexah from the cameras \p cams,
+/// intermediate files are written in \p outFolder
+mesh::Mesh* reconstructHexahedron(mvsUtils::MultiViewParams& mp,
+                                  sfmData::SfMData& sfmData,
+                                  Point3d* hexah,
+                                  const StaticVector<int>& cams,
+                                  const fuseCut::FuseParams* fuseParams,
+                                  bool addLandmarksToTheDensePointCloud,
+                                  bool saveRawDensePointCloud,
+                                  bool colorizeOutput,
+                                  bool exportDebugTetrahedralization,
+                                  int maxNbConnectedHelperPoints,
+                                  const fs::path& outFolder,
+                                  StaticVector<StaticVector<int>>& out_ptsCams)
+{
+    fuseCut::DelaunayGraphCut delaunayGC(mp);
+    delaunayGC.createDensePointCloud(hexah, cams, addLandmarksToTheDensePointCloud ? &sfmData : nullptr, fuseParams);
+    if(saveRawDensePointCloud)
+    {
+      ALICEVISION_LOG_INFO("Save dense point cloud before cut and filtering.");
+      StaticVector<StaticVector<int>> ptsCams;
+      delaunayGC.createPtsCams(ptsCams);
+      sfmData::SfMData densePointCloud;
+      createDenseSfMData(sfmData, mp, delaunayGC._verticesCoords, ptsCams, densePointCloud);
+      removeLandmarksWithoutObservations(densePointCloud);
+      if(colorizeOutput)
+        sfmData::colorizeTracks(densePointCloud);
+      sfmDataIO::Save(densePointCloud, (outFolder/"densePointCloud_raw.abc").string(), sfmDataIO::ESfMData::ALL_DENSE);
+    }
+
+    delaunayGC.createGraphCut(hexah, cams, outFolder.string() + "/",
+                              outFolder.string() + "/SpaceCamsTracks/", false,
+                              exportDebugTetrahedralization);
+
+    delaunayGC.graphCutPostProcessing(hexah, outFolder.string()+"/");
+
+    mesh::Mesh* mesh = delaunayGC.createMesh(maxNbConnectedHelperPoints);
+    delaunayGC.createPtsCams(out_ptsCams);
+    mesh::meshPostProcessing(mesh, out_ptsCams, mp, outFolder.string()+"/", nullptr, hexah);
+
+    return mesh;
+}
+
 
 int aliceVision_main(int argc, char* argv[])
 {
@@ -321,7 +410,12 @@ int aliceVision_main(int argc, char* argv[])
     double nPixelSizeBehind = 4.0;
     double fullWeight = 1.0;
     bool exportDebugTetrahedralization = false;
+    double blockOverlap = 0.1;
+    int rangeStart = -1;
+    int rangeSize = -1;
     int maxNbConnectedHelperPoints = 50;
+    bool parallelTetrahedralization = false;
+    fuseCut::EMaxFlowAlgorithm maxflowAlgorithm = fuseCut::EMaxFlowAlgorithm::BOYKOV_KOLMOGOROV;
 
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
@@ -354,7 +448,15 @@ int aliceVision_main(int argc, char* argv[])
         ("minVis", po::value<int>(&fuseParams.minVis)->default_value(fuseParams.minVis),
             "Filter points based on their number of observations")
         ("partitioning", po::value<EPartitioningMode>(&partitioningMode)->default_value(partitioningMode),
-            "Partitioning: 'singleBlock' or 'auto'.")
+            "Partitioning:\n"
+            "* singleBlock: reconstruct the whole space at once\n"
+            "* auto: split the space in blocks of bounded number of depth map points, reconstructed independently and stitched.")
+        ("blockOverlap", po::value<double>(&blockOverlap)->default_value(blockOverlap),
+            "Overlap of the blocks on each side, relative to the block size (partitioning 'auto' only).")
+        ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
+            "Compute only a sub-range of blocks from index rangeStart to rangeStart+rangeSize (partitioning 'auto' only).")
+        ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
+            "Compute only a sub-range of N blocks (N=rangeSize), the final mesh is created when all blocks are computed.")
         ("repartition", po::value<ERepartitionMode>(&repartitionMode)->default_value(repartitionMode),
             "Repartition: 'multiResolution' or 'regularGrid'.")
         ("estimateSpaceFromSfM", po::value<bool>(&estimateSpaceFromSfM)->default_value(estimateSpaceFromSfM),
@@ -388,6 +490,8 @@ int aliceVision_main(int argc, char* argv[])
             "minAngleThreshold")
         ("refineFuse", po::value<bool>(&fuseParams.refineFuse)->default_value(fuseParams.refineFuse),
             "refineFuse")
+        ("voxelHashFusion", po::value<bool>(&fuseParams.voxelHashFusion)->default_value(fuseParams.voxelHashFusion),
+            "Fuse the depth maps points on the fly in a voxel hash to reduce the memory peak on large datasets.")
         ("helperPointsGridSize", po::value<int>(&helperPointsGridSize)->default_value(helperPointsGridSize),
             "Helper points grid size.")
         ("densifyNbFront", po::value<int>(&densifyNbFront)->default_value(densifyNbFront),
@@ -418,6 +522,13 @@ int aliceVision_main(int argc, char* argv[])
             "Maximum number of connected helper points before we remove them.")
         ("exportDebugTetrahedralization", po::value<bool>(&exportDebugTetrahedralization)->default_value(exportDebugTetrahedralization),
             "Export debug cells score as tetrahedral mesh. WARNING: could create huge meshes, only use on very small datasets.")        
+        ("parallelTetrahedralization", po::value<bool>(&parallelTetrahedralization)->default_value(parallelTetrahedralization),
+            "Use the multi-threaded Delaunay tetrahedralization on large point sets (fallback on the sequential one if not available). "
+            "The cells order is not reproducible from one run to the next, so it is ignored when a seed is set.")
+        ("maxflowAlgorithm", po::value<fuseCut::EMaxFlowAlgorithm>(&maxflowAlgorithm)->default_value(maxflowAlgorithm),
+            "Max-flow algorithm used for the graph-cut:\n"
+            "* boykovKolmogorov: sequential Boykov-Kolmogorov\n"
+            "* parallelPushRelabel: multi-threaded push-relabel, faster and lighter in memory on large tetrahedralizations.")
         ("seed", po::value<unsigned int>(&seed)->default_value(seed),
             "Seed used in random processes. (0 to use a random seed).");
 
@@ -467,6 +578,8 @@ int aliceVision_main(int argc, char* argv[])
     mp.userParams.put("LargeScale.densifyScale", densifyScale);
 
     mp.userParams.put("delaunaycut.seed", seed);
+    mp.userParams.put("delaunaycut.parallelTetrahedralization", parallelTetrahedralization);
+    mp.userParams.put("delaunaycut.maxflowAlgorithm", fuseCut::EMaxFlowAlgorithm_enumToString(maxflowAlgorithm));
     mp.userParams.put("delaunaycut.nPixelSizeBehind", nPixelSizeBehind);
     mp.userParams.put("delaunaycut.fullWeight", fullWeight);
     mp.userParams.put("delaunaycut.voteFilteringForWeaklySupportedSurfaces", voteFilteringForWeaklySupportedSurfaces);
@@ -497,44 +610,112 @@ int aliceVision_main(int argc, char* argv[])
             {
                 case ePartitioningAuto:
                 {
-                    throw std::invalid_argument("Meshing mode: 'multiResolution', partitioning: 'auto' is not yet implemented.");
-                }
-                case ePartitioningSingleBlock:
-                {
-                    ALICEVISION_LOG_INFO("Meshing mode: multi-resolution, partitioning: single block.");
-                    std::array<Point3d, 8> hexah;
+                    ALICEVISION_LOG_INFO("Meshing mode: multi-resolution, partitioning: auto.");
 
-                    float minPixSize;
-                    fuseCut::Fuser fs(mp);
+                    // the partition is saved to keep the same blocks between the sub-range processes
+                    fuseCut::BlockPartition partition;
+                    const std::string partitionFilepath = (outDirectory / "blockPartition.txt").string();
 
-                    if (boundingBox.isInitialized())
-                        boundingBox.toHexahedron(&hexah[0]);
-                    else if(meshingFromDepthMaps && (!estimateSpaceFromSfM || sfmData.getLandmarks().empty()))
-                      fs.divideSpaceFromDepthMaps(&hexah[0], minPixSize);
+                    if(fs::exists(partitionFilepath))
+                    {
+                        ALICEVISION_LOG_INFO("Load blocks partition: " << partitionFilepath);
+                        partition.load(partitionFilepath);
+                    }
                     else
-                      fs.divideSpaceFromSfM(sfmData, &hexah[0], estimateSpaceMinObservations, estimateSpaceMinObservationAngle);
+                    {
+                        std::array<Point3d, 8> hexah;
+                        estimateReconstructionSpace(mp, sfmData, boundingBox, meshingFromDepthMaps, estimateSpaceFromSfM,
+                                                    estimateSpaceMinObservations, estimateSpaceMinObservationAngle, outDirectory, &hexah[0]);
+
+                        // each sample represents samplingStep depth map pixels
+                        std::vector<Point3d> samples;
+                        const fuseCut::Fuser fuser(mp);
+                        const int samplingStep = fuser.sampleDepthMapsPoints(&hexah[0], 1000000, samples);
+
+                        partition = fuseCut::BlockPartition(&hexah[0], blockOverlap);
+                        partition.compute(samples, std::max(1, fuseParams.maxInputPoints / samplingStep));
+                        partition.save(partitionFilepath);
+                    }
+
+                    const int nbBlocks = static_cast<int>(partition.getNbBlocks());
+                    ALICEVISION_LOG_INFO("Number of blocks: " << nbBlocks);
 
+                    std::vector<std::string> blocksFolders(nbBlocks);
+                    for(int b = 0; b < nbBlocks; ++b)
+                        blocksFolders[b] = (outDirectory / "blocks" / ("block" + mvsUtils::num2strFourDecimal(b))).string() + "/";
+
+                    int blocksBegin = 0;
+                    int blocksEnd = nbBlocks;
+                    if(rangeSize != -1)
+                    {
+                        if(rangeStart < 0)
+                        {
+                            ALICEVISION_LOG_ERROR("invalid subrange of blocks to process.");
+                            return EXIT_FAILURE;
+                        }
+                        blocksBegin = std::min(rangeStart, nbBlocks);
+                        blocksEnd = std::min(rangeStart + rangeSize, nbBlocks);
+                    }
+
+                    for(int b = blocksBegin; b < blocksEnd; ++b)
                     {
-                        const double length = hexah[0].x - hexah[1].x;
-                        const double width = hexah[0].y - hexah[3].y;
-                        const double height = hexah[0].z - hexah[4].z;
+                        const std::string& blockFolder = blocksFolders[b];
+                        if(fs::exists(blockFolder + "mesh.bin") && fs::exists(blockFolder + "meshPtsCamsFromDGC.bin"))
+                        {
+                            ALICEVISION_LOG_INFO("Block " << b << " already computed.");
+                            continue;
+                        }
 
-                        ALICEVISION_LOG_INFO("bounding Box : length: " << length << ", width: " << width << ", height: " << height);
+                        ALICEVISION_LOG_INFO("Reconstruct block " << b << " / " << nbBlocks << ".");
+                        fs::create_directories(blockFolder);
 
-                        // Save bounding box
-                        BoundingBox bbox = BoundingBox::fromHexahedron(&hexah[0]);
-                        std::string filename = (outDirectory / "boundingBox.txt").string();
-                        std::ofstream fs(filename, std::ios::out);
-                        if(!fs.is_open())
+                        Point3d blockHexah[8];
+                        partition.getBlockOverlapHexah(b, blockHexah);
+
+                        // the fusion step is computed from all the input images,
+                        // so the input points budget is scaled to the part of the depth map points in the block
+                        fuseCut::FuseParams blockFuseParams = fuseParams;
+                        blockFuseParams.maxInputPoints = static_cast<int>(std::min<double>(std::numeric_limits<int>::max(),
+                            fuseParams.maxInputPoints / std::max(partition.getBlockPointsRatio(b), 1e-6)));
+
+                        mesh::Mesh* blockMesh = nullptr;
+                        StaticVector<StaticVector<int>> blockPtsCams;
+
+                        const StaticVector<int> cams = mp.findCamsWhichIntersectsHexahedron(blockHexah);
+                        if(cams.empty())
                         {
-                            ALICEVISION_LOG_WARNING("Unable to create the bounding box file " << filename);
+                            ALICEVISION_LOG_INFO("No camera to reconstruct block " << b << ".");
+                            blockMesh = new mesh::Mesh();
                         }
-                        fs << bbox.translation << std::endl;
-                        fs << bbox.rotation << std::endl;
-                        fs << bbox.scale << std::endl;
-                        fs.close();
+                        else
+                        {
+                            blockMesh = reconstructHexahedron(mp, sfmData, blockHexah, cams, &blockFuseParams, addLandmarksToTheDensePointCloud,
+                                                              saveRawDensePointCloud, colorizeOutput, exportDebugTetrahedralization,
+                                                              maxNbConnectedHelperPoints, blockFolder, blockPtsCams);
+                        }
+
+                        // points visibilities first, the mesh file marks the block as done
+                        saveArrayOfArraysToFile<int>(blockFolder + "meshPtsCamsFromDGC.bin", blockPtsCams);
+                        blockMesh->saveToBin(blockFolder + "mesh.bin");
+                        delete blockMesh;
                     }
 
+                    if(rangeSize != -1)
+                    {
+                        ALICEVISION_LOG_INFO("Blocks " << blocksBegin << " to " << blocksEnd << " done in (s): " + std::to_string(timer.elapsed()));
+                        return EXIT_SUCCESS;
+                    }
+
+                    mesh = partition.joinBlockMeshes(blocksFolders, ptsCams);
+                    break;
+                }
+                case ePartitioningSingleBlock:
+                {
+                    ALICEVISION_LOG_INFO("Meshing mode: multi-resolution, partitioning: single block.");
+                    std::array<Point3d, 8> hexah;
+                    estimateReconstructionSpace(mp, sfmData, boundingBox, meshingFromDepthMaps, estimateSpaceFromSfM,
+                                                estimateSpaceMinObservations, estimateSpaceMinObservationAngle, outDirectory, &hexah[0]);
+
                     StaticVector<int> cams;
                     if(meshingFromDepthMaps)
                     {
@@ -549,32 +730,10 @@ int aliceVision_main(int argc, char* argv[])
 
                     if(cams.empty())
                         throw std::logic_error("No camera to make the reconstruction");
-                    
-                    fuseCut::DelaunayGraphCut delaunayGC(mp);
-                    delaunayGC.createDensePointCloud(&hexah[0], cams, addLandmarksToTheDensePointCloud ? &sfmData : nullptr, meshingFromDepthMaps ? &fuseParams : nullptr);
-                    if(saveRawDensePointCloud)
-                    {
-                      ALICEVISION_LOG_INFO("Save dense point cloud before cut and filtering.");
-                      StaticVector<StaticVector<int>> ptsCams;
-                      delaunayGC.createPtsCams(ptsCams);
-                      sfmData::SfMData densePointCloud;
-                      createDenseSfMData(sfmData, mp, delaunayGC._verticesCoords, ptsCams, densePointCloud);
-                      removeLandmarksWithoutObservations(densePointCloud);
-                      if(colorizeOutput)
-                        sfmData::colorizeTracks(densePointCloud);
-                      sfmDataIO::Save(densePointCloud, (outDirectory/"densePointCloud_raw.abc").string(), sfmDataIO::ESfMData::ALL_DENSE);
-                    }
-
-                    delaunayGC.createGraphCut(&hexah[0], cams, outDirectory.string() + "/",
-                                              outDirectory.string() + "/SpaceCamsTracks/", false,
-                                              exportDebugTetrahedralization);
-
-                    delaunayGC.graphCutPostProcessing(&hexah[0], outDirectory.string()+"/");
-
-                    mesh = delaunayGC.createMesh(maxNbConnectedHelperPoints);
-                    delaunayGC.createPtsCams(ptsCams);
-                    mesh::meshPostProcessing(mesh, ptsCams, mp, outDirectory.string()+"/", nullptr, &hexah[0]);
 
+                    mesh = reconstructHexahedron(mp, sfmData, &hexah[0], cams, meshingFromDepthMaps ? &fuseParams : nullptr,
+                                                 addLandmarksToTheDensePointCloud, saveRawDensePointCloud, colorizeOutput,
+                                                 exportDebugTetrahedralization, maxNbConnectedHelperPoints, outDirectory, ptsCams);
                     break;
                 }
                 case ePartitioningUndefined:
@@ -25,10 +25,12 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <memory>
+
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -102,12 +104,20 @@ int aliceVision_main(int argc, char* argv[])
             " * Basic (> 600k faces) fast and simple. Can generate multiple atlases.\n"
             " * LSCM (<= 600k faces): optimize space. Generates one atlas.\n"
             " * ABF (<= 300k faces): optimize space and stretch. Generates one atlas.'")
+        ("chartPackingMethod", po::value<mesh::EChartPackingMethod>(&texParams.chartPackingMethod)->default_value(texParams.chartPackingMethod),
+            "Method to pack the charts in the texture atlases with the Basic unwrap method.\n"
+            " * BinaryTree: charts inserted one by one in a binary tree of free rectangles.\n"
+            " * Skyline: charts sorted by height, atlases filled concurrently (faster on large meshes).")
         ("useUDIM", po::value<bool>(&texParams.useUDIM)->default_value(texParams.useUDIM),
             "Use UDIM UV mapping.")
         ("fillHoles", po::value<bool>(&texParams.fillHoles)->default_value(texParams.fillHoles),
             "Fill texture holes with plausible values.")
         ("padding", po::value<unsigned int>(&texParams.padding)->default_value(texParams.padding),
             "Texture edge padding size in pixel")
+        ("tiledOutput", po::value<bool>(&texParams.tiledOutput)->default_value(texParams.tiledOutput),
+            "Accumulate and write the textures by tiles, keeping only the active tiles in memory (EXR or TIFF output, without fillHoles and downscale).")
+        ("mipmaps", po::value<bool>(&texParams.mipmaps)->default_value(texParams.mipmaps),
+            "Write the mip levels in the tiled textures (requires tiledOutput).")
         ("multiBandDownscale", po::value<unsigned int>(&texParams.multiBandDownscale)->default_value(texParams.multiBandDownscale),
             "Width of frequency bands.")
         ("multiBandNbContrib", po::value<std::vector<int>>(&texParams.multiBandNbContrib)->default_value(texParams.multiBandNbContrib)->multitoken(),
@@ -145,6 +155,12 @@ int aliceVision_main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
+    if(texParams.mipmaps && !texParams.tiledOutput)
+    {
+        ALICEVISION_LOG_ERROR("The mip levels are only written with the tiled output, use mipmaps with tiledOutput.");
+        return EXIT_FAILURE;
+    }
+
     // set maxThreads
     HardwareContext hwc = cmdline.getHardwareContext();
     omp_set_num_threads(hwc.getMaxThreads());
@@ -193,11 +209,20 @@ int aliceVision_main(int argc, char* argv[])
     mesh::Mesh refMesh;
     mvsUtils::createRefMeshFromDenseSfMData(refMesh, sfmData, mp);
 
+    // nearest vertex queries on the reference mesh, shared by the visibility remappings,
+    // built on the first Pull remapping and released after the last one
+    std::unique_ptr<mesh::MeshKdTree> refKdTree;
+    const auto getRefKdTree = [&]() -> const mesh::MeshKdTree* {
+        if(!refKdTree && (texParams.visibilityRemappingMethod & mesh::EVisibilityRemappingMethod::Pull))
+            refKdTree = std::make_unique<mesh::MeshKdTree>(refMesh);
+        return refKdTree.get();
+    };
+
     // generate UVs if necessary
     if(!mesh.hasUVs())
     {
         // Need visibilities to compute unwrap
-        mesh.remapVisibilities(texParams.visibilityRemappingMethod, mp, refMesh);
+        mesh.remapVisibilities(texParams.visibilityRemappingMethod, mp, refMesh, getRefKdTree());
         ALICEVISION_LOG_INFO("Input mesh has no UV coordinates, start unwrapping (" + unwrapMethod + ")");
         mesh.unwrap(mp, mesh::EUnwrapMethod_stringToEnum(unwrapMethod));
         ALICEVISION_LOG_INFO("Unwrapping done.");
@@ -217,12 +242,15 @@ int aliceVision_main(int argc, char* argv[])
 
     if(mesh.mesh->pointsVisibilities.empty())
     {
-        mesh.remapVisibilities(texParams.visibilityRemappingMethod, mp, refMesh);
+        mesh.remapVisibilities(texParams.visibilityRemappingMethod, mp, refMesh, getRefKdTree());
 
         // DEBUG: export subdivided mesh
         // mesh.saveAsOBJ(outputFolder, "subdividedMesh", outputTextureFileType);
     }
 
+    // no more nearest vertex queries
+    refKdTree.reset();
+
     // generate diffuse textures
     if(!inputMeshFilepath.empty() && !sfmDataFilename.empty() && texParams.textureFileType != image::EImageFileType::NONE)
     {
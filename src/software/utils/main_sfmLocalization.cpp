@@ -24,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -47,6 +47,7 @@ int aliceVision_main(int argc, char **argv)
   // user optional parameters
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   double maxResidualError = std::numeric_limits<double>::infinity();
+  int robustEstimationNbThreads = 1;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -64,7 +65,9 @@ int aliceVision_main(int argc, char **argv)
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
       feature::EImageDescriberType_informations().c_str())
     ("maxResidualError", po::value<double>(&maxResidualError)->default_value(maxResidualError),
-      "Upper bound of the residual error tolerance.");
+      "Upper bound of the residual error tolerance.")
+    ("robustEstimationNbThreads", po::value<int>(&robustEstimationNbThreads)->default_value(robustEstimationNbThreads),
+      "Number of threads used to evaluate the robust estimation hypotheses (1: sequential, 0: all available threads).");
 
   CmdLine cmdline("Image localization in an existing SfM reconstruction.\n"
                   "AliceVision sfmLocalization");
@@ -155,6 +158,7 @@ int aliceVision_main(int argc, char **argv)
   geometry::Pose3 pose;
   sfm::ImageLocalizerMatchData matching_data;
   matching_data.error_max = maxResidualError;
+  matching_data.robustEstimationNbThreads = robustEstimationNbThreads;
 
   // Try to localize the image in the database thanks to its regions
   if (!localizer.Localize(